@@ -1,123 +1,181 @@
 #include "Anonymity.h"
 #include "MySerial.h"
 #include "MPU6050.h" // 引入MPU6050相关函数头文件
+#include "Battery.h"
+#include "tinyOS.h"
+#if ANO_TELEMETRY_COMPACT == 1
+#include "DeltaCodec.h"
+#endif
 
-#define BYTE0(dwTemp)  (*(char*)(&dwTemp))
-#define BYTE1(dwTemp)  (*((char*)(&dwTemp) + 1))
 // 外部变量声明
 //extern float Roll, Pitch, Yaw;
 //extern quaternion q;
 //extern volatile float q0, q1, q2, q3;
 
+// 各帧数据部分的长度，帧总长为数据长度加帧头2字节、功能字、长度及两个校验字节
+#define ANO_LEN_SENSOR      13
+#define ANO_LEN_ATTITUDE    7
+#define ANO_LEN_QUATERNION  9
+#define ANO_LEN_BATTERY     4
+#define ANO_FRAME_SIZE(dataLen) ((dataLen) + 6)
+
+/**
+ * @brief 开始向缓冲区打包帧
+ * @param builder 帧打包器
+ * @param buf 目标缓冲区
+ * @param size 缓冲区字节数
+ */
+void AnoFrame_Init(AnoFrameBuilder *builder, uint8_t *buf, uint32_t size) {
+    builder->buf = buf;
+    builder->len = 0;
+    builder->size = size;
+    builder->frameEnd = 0;
+}
+
+// 写入1字节并累计校验：和校验为各字节之和，附加校验为每次累加后和校验之和
+static __inline void AnoFrame_Put(AnoFrameBuilder *builder, uint8_t value) {
+    builder->buf[builder->len++] = value;
+    builder->sumcheck += value;
+    builder->addcheck += builder->sumcheck;
+}
+
+/**
+ * @brief 开始一帧，写入帧头、功能字及数据长度
+ * @param builder 帧打包器
+ * @param id 功能字
+ * @param dataLen 数据部分的字节数
+ * @return 1，剩余空间放不下整帧时为0且不写入
+ */
+uint32_t AnoFrame_Begin(AnoFrameBuilder *builder, uint8_t id, uint8_t dataLen) {
+    if (builder->size - builder->len < ANO_FRAME_SIZE(dataLen)) {
+        return 0;
+    }
+    builder->sumcheck = 0;
+    builder->addcheck = 0;
+    AnoFrame_Put(builder, 0xAA); // 帧头
+    AnoFrame_Put(builder, 0xFF);
+    AnoFrame_Put(builder, id);   // 功能字
+    AnoFrame_Put(builder, dataLen); // 数据长度
+    builder->frameEnd = builder->len + dataLen;
+    return 1;
+}
+
+/**
+ * @brief 写入1字节数据
+ * @param builder 帧打包器
+ * @param value 数据
+ */
+void AnoFrame_PutU8(AnoFrameBuilder *builder, uint8_t value) {
+    AnoFrame_Put(builder, value);
+}
+
+/**
+ * @brief 写入2字节数据，低字节在前高字节在后
+ * @param builder 帧打包器
+ * @param value 数据
+ */
+void AnoFrame_PutS16(AnoFrameBuilder *builder, int16_t value) {
+    AnoFrame_Put(builder, (uint8_t)value);
+    AnoFrame_Put(builder, (uint8_t)((uint16_t)value >> 8));
+}
+
+/**
+ * @brief 结束一帧，数据不足声明的长度时补0，再写入和校验及附加校验
+ * @param builder 帧打包器
+ */
+void AnoFrame_End(AnoFrameBuilder *builder) {
+    uint8_t addcheck;
+
+    while (builder->len < builder->frameEnd) {
+        AnoFrame_Put(builder, 0);
+    }
+    addcheck = builder->addcheck;
+    builder->buf[builder->len++] = builder->sumcheck;
+    builder->buf[builder->len++] = addcheck;
+}
+
+// 六轴数据帧，放大1000倍
+static void Ano_Pack01(AnoFrameBuilder *builder, float ax, float ay, float az, float gx, float gy, float gz) {
+    const int rate = 1000;
+
+    if (!AnoFrame_Begin(builder, 0x01, ANO_LEN_SENSOR)) {
+        return;
+    }
+    AnoFrame_PutS16(builder, (int16_t)(ax * rate));
+    AnoFrame_PutS16(builder, (int16_t)(ay * rate));
+    AnoFrame_PutS16(builder, (int16_t)(az * rate));
+    AnoFrame_PutS16(builder, (int16_t)(gx * rate));
+    AnoFrame_PutS16(builder, (int16_t)(gy * rate));
+    AnoFrame_PutS16(builder, (int16_t)(gz * rate));
+    AnoFrame_PutU8(builder, 0x01); // 震动状态（占位）
+    AnoFrame_End(builder);
+}
+
+// 姿态角帧，单位为°，放大100倍
+static void Ano_Pack03(AnoFrameBuilder *builder, float Roll, float Pitch, float Yaw) {
+    const int rate = 100;
+
+    if (!AnoFrame_Begin(builder, 0x03, ANO_LEN_ATTITUDE)) {
+        return;
+    }
+    AnoFrame_PutS16(builder, (int16_t)(Roll * rate));
+    AnoFrame_PutS16(builder, (int16_t)(Pitch * rate));
+    AnoFrame_PutS16(builder, (int16_t)(Yaw * rate));
+    AnoFrame_PutU8(builder, 0x01); // 融合姿态标志（占位）
+    AnoFrame_End(builder);
+}
+
+// 四元数帧，放大10000倍
+static void Ano_Pack04(AnoFrameBuilder *builder, float q0, float q1, float q2, float q3) {
+    const int rate = 10000;
+
+    if (!AnoFrame_Begin(builder, 0x04, ANO_LEN_QUATERNION)) {
+        return;
+    }
+    AnoFrame_PutS16(builder, (int16_t)(q0 * rate));
+    AnoFrame_PutS16(builder, (int16_t)(q1 * rate));
+    AnoFrame_PutS16(builder, (int16_t)(q2 * rate));
+    AnoFrame_PutS16(builder, (int16_t)(q3 * rate));
+    AnoFrame_PutU8(builder, 0x01); // 融合姿态标志（占位）
+    AnoFrame_End(builder);
+}
+
 /**
  * @brief 发送六个轴数据 (ID: 0x01, 19字节)
- * @param ax 加速度计 X 轴数据指针
- * @param ay 加速度计 Y 轴数据指针
- * @param az 加速度计 Z 轴数据指针
- * @param gx 陀螺仪 X 轴数据指针
- * @param gy 陀螺仪 Y 轴数据指针
- * @param gz 陀螺仪 Z 轴数据指针
+ * @param ax 加速度计 X 轴数据
+ * @param ay 加速度计 Y 轴数据
+ * @param az 加速度计 Z 轴数据
+ * @param gx 陀螺仪 X 轴数据
+ * @param gy 陀螺仪 Y 轴数据
+ * @param gz 陀螺仪 Z 轴数据
  */
 void SendToAno01(float ax, float ay, float az, float gx, float gy, float gz) {
-    unsigned char ANO_BUFF[19];
-    int rate = 1000;
-    // 转换为整数格式发送，使用 rate 做倍率放大
-    int16_t AccX = (int16_t)(ax * rate);
-    int16_t AccY = (int16_t)(ay * rate);
-    int16_t AccZ = (int16_t)(az * rate);
-    int16_t GyroX = (int16_t)(gx * rate);
-    int16_t GyroY = (int16_t)(gy * rate);
-    int16_t GyroZ = (int16_t)(gz * rate);
-
-    ANO_BUFF[0] = 0xAA; // 帧头
-    ANO_BUFF[1] = 0xFF;
-    ANO_BUFF[2] = 0x01; // 功能字
-    ANO_BUFF[3] = 13;   // 数据长度
-
-    // 数据部分
-    ANO_BUFF[4] = BYTE0(AccX);
-    ANO_BUFF[5] = BYTE1(AccX);
-    ANO_BUFF[6] = BYTE0(AccY);
-    ANO_BUFF[7] = BYTE1(AccY);
-    ANO_BUFF[8] = BYTE0(AccZ);
-    ANO_BUFF[9] = BYTE1(AccZ);
-    ANO_BUFF[10] = BYTE0(GyroX);
-    ANO_BUFF[11] = BYTE1(GyroX);
-    ANO_BUFF[12] = BYTE0(GyroY);
-    ANO_BUFF[13] = BYTE1(GyroY);
-    ANO_BUFF[14] = BYTE0(GyroZ);
-    ANO_BUFF[15] = BYTE1(GyroZ);
-    ANO_BUFF[16] = 0x01; // 震动状态（占位）
-
-    // 校验部分
-    int8_t sumcheck = 0;
-    int8_t addcheck = 0;
-    for (int i = 0; i < ANO_BUFF[3] + 4; i++) {
-        sumcheck += ANO_BUFF[i];
-        addcheck += sumcheck;
-    }
-    ANO_BUFF[17] = sumcheck;
-    ANO_BUFF[18] = addcheck;
-
-    // 逐个发送
-    for (int i = 0; i < 19; i++) {
-        printf("%c", ANO_BUFF[i]);
-    }
+    uint8_t ANO_BUFF[ANO_FRAME_SIZE(ANO_LEN_SENSOR)];
+    AnoFrameBuilder builder;
+
+    AnoFrame_Init(&builder, ANO_BUFF, sizeof(ANO_BUFF));
+    Ano_Pack01(&builder, ax, ay, az, gx, gy, gz);
+
+    // 整帧写入串口
+    MySerial_Write(ANO_BUFF, builder.len);
 }
 
 
 /**
 * @brief 发送姿态角数据 (ID: 0x03, 13字节) 单位为°
- * @param Roll 指向 Roll 角数据的指针
- * @param Pitch 指向 Pitch 角数据的指针
- * @param Yaw 指向 Yaw 角数据的指针
+ * @param Roll Roll 角
+ * @param Pitch Pitch 角
+ * @param Yaw Yaw 角
  */
 void SendToAno03(float Roll, float Pitch, float Yaw) {
-    unsigned char ANO_BUFF[13];
-		int rate = 100;
-    // 转换为整数格式发送（放大100倍）
-    int16_t RollM = (int16_t)(Roll * rate);
-    int16_t PitchM = (int16_t)(Pitch * rate);
-    int16_t YawM = (int16_t)(Yaw * rate);
-	
-    ANO_BUFF[0] = 0xAA; // 帧头
-    ANO_BUFF[1] = 0xFF;
-    ANO_BUFF[2] = 0x03; // 功能字
-    ANO_BUFF[3] = 7;    // 数据长度
-
-    // 数据部分 低字节在前高字节在后
-
-		ANO_BUFF[4] = BYTE0(RollM);
-		ANO_BUFF[5] = BYTE1(RollM);
-		ANO_BUFF[6] = BYTE0(PitchM);
-		ANO_BUFF[7] = BYTE1(PitchM);    
-		ANO_BUFF[8] = BYTE0(YawM);
-		ANO_BUFF[9] = BYTE1(YawM);
-
-//    ANO_BUFF[4] = RollM & 0xff;
-//    ANO_BUFF[5] = (RollM >> 8) & 0xff;
-//    ANO_BUFF[6] = PitchM & 0xff;    
-//    ANO_BUFF[7] = (PitchM >> 8) & 0xff;
-//    ANO_BUFF[8] = YawM & 0xff;
-//    ANO_BUFF[9] = (YawM >> 8) & 0xff;
-
-		
-    ANO_BUFF[10] = 0x01; // 融合姿态标志（占位）
-
-    // 校验部分
-    int8_t sumcheck = 0;
-    int8_t addcheck = 0;
-    for (int i = 0; i < ANO_BUFF[3] + 4; i++) {
-        sumcheck += ANO_BUFF[i];
-        addcheck += sumcheck;
-    }
-    ANO_BUFF[11] = sumcheck;
-    ANO_BUFF[12] = addcheck;
-
-    // 逐个发送
-    for (int i = 0; i < 13; i++) {
-        printf("%c", ANO_BUFF[i]);
-    }
+    uint8_t ANO_BUFF[ANO_FRAME_SIZE(ANO_LEN_ATTITUDE)];
+    AnoFrameBuilder builder;
+
+    AnoFrame_Init(&builder, ANO_BUFF, sizeof(ANO_BUFF));
+    Ano_Pack03(&builder, Roll, Pitch, Yaw);
+
+    // 整帧写入串口
+    MySerial_Write(ANO_BUFF, builder.len);
 }
 
 
@@ -129,47 +187,589 @@ void SendToAno03(float Roll, float Pitch, float Yaw) {
  * @param q3 四元数的第3个分量
  */
 void SendToAno04(float q0, float q1, float q2, float q3) {
-    printf("q0: %.2f, q1: %.2f, q2: %.2f, q3: %.2f\n", q0, q1, q2, q3);
-    unsigned char ANO_BUFF[15];
-		int rate = 10000;
-    // 转换为整数格式发送，使用 rate 做倍率放大
-    int16_t Q0 = (int16_t)(q0 * rate);
-    int16_t Q1 = (int16_t)(q1 * rate);
-    int16_t Q2 = (int16_t)(q2 * rate);
-    int16_t Q3 = (int16_t)(q3 * rate);
-
-    printf("Q0: %d, Q1: %d, Q2: %d, Q3: %d\n", Q0, Q1, Q2, Q3);
-    ANO_BUFF[0] = 0xAA; // 帧头
-    ANO_BUFF[1] = 0xFF;
-    ANO_BUFF[2] = 0x04; // 功能字
-    ANO_BUFF[3] = 9;    // 数据长度
-
-    // 数据部分
-    ANO_BUFF[4] = BYTE0(Q0);
-    ANO_BUFF[5] = BYTE1(Q0);
-    ANO_BUFF[6] = BYTE0(Q1);
-    ANO_BUFF[7] = BYTE1(Q1);
-    ANO_BUFF[8] = BYTE0(Q2);
-    ANO_BUFF[9] = BYTE1(Q2);
-    ANO_BUFF[10] = BYTE0(Q3);
-    ANO_BUFF[11] = BYTE1(Q3);
-
-    ANO_BUFF[12] = 0x01; // 融合姿态标志（占位）
-
-    // 校验部分
-    int8_t sumcheck = 0;
-    int8_t addcheck = 0;
-    for (int i = 0; i < ANO_BUFF[3] + 4; i++) {
-        sumcheck += ANO_BUFF[i];
-        addcheck += sumcheck;
-    }
-    ANO_BUFF[13] = sumcheck;
-    ANO_BUFF[14] = addcheck;
-
-    // 逐个发送
-    for (int i = 0; i < 15; i++) {
-        printf("%c", ANO_BUFF[i]);
+    uint8_t ANO_BUFF[ANO_FRAME_SIZE(ANO_LEN_QUATERNION)];
+    AnoFrameBuilder builder;
+
+    // 文本输出会混入二进制帧，改用日志记录
+    tLogDebug("q0: %.2f, q1: %.2f, q2: %.2f, q3: %.2f", tLogFloat(q0), tLogFloat(q1), tLogFloat(q2), tLogFloat(q3));
+    AnoFrame_Init(&builder, ANO_BUFF, sizeof(ANO_BUFF));
+    Ano_Pack04(&builder, q0, q1, q2, q3);
+
+    // 整帧写入串口
+    MySerial_Write(ANO_BUFF, builder.len);
+}
+
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+#if (ANO_TELEMETRY_BUF_SIZE % 4) != 0
+#error "ANO_TELEMETRY_BUF_SIZE must be a multiple of 4"
+#endif
+
+// 控制回路发布的最新数据，单个写者，遥测任务优先级更低，用顺序锁读取一致的快照
+typedef struct _AnoTelemetryData {
+    float ax, ay, az, gx, gy, gz;
+    float Roll, Pitch, Yaw;
+    float q[4];
+    uint32_t valid;     // 已发布过的帧，ANO_FRAME_xxx的组合
+} AnoTelemetryData;
+
+static AnoTelemetryData anoData;
+static tSeqLock anoDataLock;
+static volatile uint32_t anoFrames; // 可由其它任务改变，见Ano_TelemetrySetFrames
+static AnoTelemetryStat anoStat;
+
+static uint32_t anoTxMem[ANO_TELEMETRY_BUF_COUNT][ANO_TELEMETRY_BUF_SIZE / 4];
+static tMemBlock anoTxPool;
+
+static tTask anoTask;
+static tTaskStack anoTaskStack[ANO_TELEMETRY_STACK_SIZE];
+
+/**
+ * @brief 发布六轴数据
+ */
+void Ano_PublishSensor(float ax, float ay, float az, float gx, float gy, float gz) {
+    tSeqLockWriteBegin(&anoDataLock);
+    anoData.ax = ax;
+    anoData.ay = ay;
+    anoData.az = az;
+    anoData.gx = gx;
+    anoData.gy = gy;
+    anoData.gz = gz;
+    anoData.valid |= ANO_FRAME_SENSOR;
+    tSeqLockWriteEnd(&anoDataLock);
+}
+
+/**
+ * @brief 发布姿态角，单位为°
+ */
+void Ano_PublishAttitude(float Roll, float Pitch, float Yaw) {
+    tSeqLockWriteBegin(&anoDataLock);
+    anoData.Roll = Roll;
+    anoData.Pitch = Pitch;
+    anoData.Yaw = Yaw;
+    anoData.valid |= ANO_FRAME_ATTITUDE;
+    tSeqLockWriteEnd(&anoDataLock);
+}
+
+/**
+ * @brief 发布四元数
+ */
+void Ano_PublishQuaternion(float q0, float q1, float q2, float q3) {
+    tSeqLockWriteBegin(&anoDataLock);
+    anoData.q[0] = q0;
+    anoData.q[1] = q1;
+    anoData.q[2] = q2;
+    anoData.q[3] = q3;
+    anoData.valid |= ANO_FRAME_QUATERNION;
+    tSeqLockWriteEnd(&anoDataLock);
+}
+
+// DMA发完一批后在串口中断中归还缓冲区
+static void Ano_TelemetryDone(void *param, const uint8_t *buf) {
+    tMemBlockNotifyFromISR(&anoTxPool, (uint8_t *)buf);
+}
+
+// 各流的帧总长，按ANO_FRAME_xxx的位序排列；紧凑遥测时帧长随数据变化，改为最近各帧长度的滑动平均
+#if ANO_TELEMETRY_COMPACT == 1
+static uint8_t anoStreamSize[ANO_STREAM_COUNT] = {
+#else
+static const uint8_t anoStreamSize[ANO_STREAM_COUNT] = {
+#endif
+    ANO_FRAME_SIZE(ANO_LEN_SENSOR), ANO_FRAME_SIZE(ANO_LEN_ATTITUDE), ANO_FRAME_SIZE(ANO_LEN_QUATERNION),
+};
+
+#if ANO_TELEMETRY_COMPACT == 1
+#define ANO_COMPACT_MAX_FIELDS  6
+
+// 各流的字段数及预测器，按ANO_FRAME_xxx的位序排列
+static const uint8_t anoCompactFields[ANO_STREAM_COUNT] = { 6, 3, 4 };
+static const uint8_t anoCompactPredictor[ANO_STREAM_COUNT] = {
+    DELTA_PREDICT_PREVIOUS, DELTA_PREDICT_LINEAR, DELTA_PREDICT_LINEAR,
+};
+
+// 编码状态，只由遥测任务访问
+static DeltaCodec anoCodec[ANO_STREAM_COUNT];
+static uint8_t anoCompactSeq[ANO_STREAM_COUNT];
+static uint8_t anoCompactCount[ANO_STREAM_COUNT];   // 距上一个关键帧的帧数
+
+/**
+ * @brief 把一路流的字段编码为紧凑帧
+ *
+ * 先编码到临时缓冲区，按实际长度开始一帧；放不下时编码状态已前进，复位为关键帧以免与接收端失去同步。
+ * @param builder 帧打包器
+ * @param stream 流序号
+ * @param values 各字段放大后的整数值
+ */
+static void Ano_PackCompact(AnoFrameBuilder *builder, uint32_t stream, const int32_t *values) {
+    DeltaCodec *codec = &anoCodec[stream];
+    uint8_t data[1 + DELTA_CODEC_MAX_BYTES(ANO_COMPACT_MAX_FIELDS)];
+    uint32_t len, i;
+
+    if (++anoCompactCount[stream] >= ANO_COMPACT_KEY_INTERVAL) {
+        DeltaCodec_Reset(codec);
+    }
+    if (DeltaCodec_IsKeyFrame(codec)) {
+        anoCompactCount[stream] = 0;
+    }
+    data[0] = (uint8_t)((DeltaCodec_IsKeyFrame(codec) ? 0x80 : 0) | (anoCompactSeq[stream] & 0x7F));
+    len = 1 + DeltaCodec_Encode(codec, values, data + 1);
+    if (!AnoFrame_Begin(builder, (uint8_t)(ANO_COMPACT_ID_BASE + stream), (uint8_t)len)) {
+        DeltaCodec_Reset(codec);
+        return;
+    }
+    for (i = 0; i < len; i++) {
+        AnoFrame_PutU8(builder, data[i]);
+    }
+    AnoFrame_End(builder);
+    anoCompactSeq[stream]++;
+    // 帧长的滑动平均(1/4)，供按divider估算发送量
+    anoStreamSize[stream] = (uint8_t)((anoStreamSize[stream] * 3 + ANO_FRAME_SIZE(len) + 3) / 4);
+}
+
+// 按原帧的放大倍数取整后编码，int16截断与原帧一致
+static void Ano_PackCompactData(AnoFrameBuilder *builder, uint32_t due, const AnoTelemetryData *data) {
+    int32_t values[ANO_COMPACT_MAX_FIELDS];
+
+    if (due & ANO_FRAME_SENSOR) {
+        values[0] = (int16_t)(data->ax * 1000);
+        values[1] = (int16_t)(data->ay * 1000);
+        values[2] = (int16_t)(data->az * 1000);
+        values[3] = (int16_t)(data->gx * 1000);
+        values[4] = (int16_t)(data->gy * 1000);
+        values[5] = (int16_t)(data->gz * 1000);
+        Ano_PackCompact(builder, 0, values);
+    }
+    if (due & ANO_FRAME_ATTITUDE) {
+        values[0] = (int16_t)(data->Roll * 100);
+        values[1] = (int16_t)(data->Pitch * 100);
+        values[2] = (int16_t)(data->Yaw * 100);
+        Ano_PackCompact(builder, 1, values);
+    }
+    if (due & ANO_FRAME_QUATERNION) {
+        values[0] = (int16_t)(data->q[0] * 10000);
+        values[1] = (int16_t)(data->q[1] * 10000);
+        values[2] = (int16_t)(data->q[2] * 10000);
+        values[3] = (int16_t)(data->q[3] * 10000);
+        Ano_PackCompact(builder, 2, values);
+    }
+}
+#endif
+
+// 降速控制的状态，只由遥测任务访问
+static uint32_t anoStreamPhase[ANO_STREAM_COUNT];
+static uint32_t anoCalmCycles;
+static uint32_t anoWindowTicks;
+static uint32_t anoWindowSent;
+static uint32_t anoWindowBusy;      // 本窗口内每个周期都有积压，吞吐量即为链路容量
+
+// 按当前的divider估算遥测每秒的发送量
+static uint32_t Ano_TelemetryDemand(void) {
+    uint32_t i, demand = 0;
+
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        if (anoFrames & (1 << i)) {
+            demand += anoStreamSize[i] * TICKS_PER_SEC / (ANO_TELEMETRY_PERIOD_TICKS * anoStat.stream[i].divider);
+        }
     }
+    return demand;
 }
 
+// 低优先级流的divider加倍(shift为1)或减半(shift为-1)，已到极限时返回0
+static uint32_t Ano_TelemetryScale(int shift) {
+    uint32_t i, changed = 0;
 
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        AnoStreamStat *stream = &anoStat.stream[i];
+        if ((1 << i) & ANO_TELEMETRY_HIGH_PRIO) {
+            continue;
+        }
+        if ((shift > 0) && (stream->divider < ANO_DIVIDER_MAX)) {
+            stream->divider <<= 1;
+            changed = 1;
+        } else if ((shift < 0) && (stream->divider > 1)) {
+            stream->divider >>= 1;
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+// 根据发送积压及实测吞吐量调整低优先级流的divider，返回积压字节数
+static uint32_t Ano_TelemetryAdapt(void) {
+    MySerialTxStatus txStatus;
+    uint32_t backlog;
+
+    MySerial_TxGetStatus(&txStatus);
+    backlog = txStatus.ringCount + txStatus.directBytes;
+    anoStat.backlog = backlog;
+
+    // 窗口内一直有积压时，期间发出的字节数就是链路能达到的吞吐量
+    if (anoWindowTicks == 0) {
+        anoWindowSent = txStatus.sentBytes;
+        anoWindowBusy = 1;
+    }
+    anoWindowBusy &= (backlog > 0);
+    anoWindowTicks += ANO_TELEMETRY_PERIOD_TICKS;
+    if (anoWindowTicks >= ANO_RATE_WINDOW_TICKS) {
+        uint32_t rate = (txStatus.sentBytes - anoWindowSent) * TICKS_PER_SEC / anoWindowTicks;
+        if (anoWindowBusy) {
+            anoStat.linkBytesPerSec = rate;
+        } else if (anoStat.linkBytesPerSec != 0) {
+            // 链路未饱和，容量只能确定不低于实测值；每个窗口放宽1/8，使之后可以试探着恢复，
+            // 试探过头时积压重新出现，容量再次被测定
+            anoStat.linkBytesPerSec += anoStat.linkBytesPerSec / 8;
+            if (anoStat.linkBytesPerSec < rate) {
+                anoStat.linkBytesPerSec = rate;
+            }
+        }
+        anoWindowTicks = 0;
+        if ((anoStat.linkBytesPerSec != 0) &&
+            (Ano_TelemetryDemand() * 100 > anoStat.linkBytesPerSec * ANO_LINK_USAGE)) {
+            Ano_TelemetryScale(1);
+            anoCalmCycles = 0;
+        }
+    }
+
+    if (backlog > ANO_BACKLOG_HIGH) {
+        Ano_TelemetryScale(1);
+        anoCalmCycles = 0;
+    } else if ((backlog <= ANO_BACKLOG_LOW) && (++anoCalmCycles >= ANO_RECOVER_CYCLES)) {
+        anoCalmCycles = 0;
+        // 恢复前按实测容量检查，避免在两个级别之间来回振荡
+        if (Ano_TelemetryScale(-1) && (anoStat.linkBytesPerSec != 0) &&
+            (Ano_TelemetryDemand() * 100 > anoStat.linkBytesPerSec * ANO_LINK_USAGE)) {
+            Ano_TelemetryScale(1);
+        }
+    }
+    return backlog;
+}
+
+// 统计本周期到期的帧，到期的帧中没能发出的计入dropped；紧凑遥测时这些流的下一帧改为关键帧
+static void Ano_TelemetryDrop(uint32_t due) {
+    uint32_t i;
+
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        if (due & (1 << i)) {
+            anoStat.stream[i].dropped++;
+#if ANO_TELEMETRY_COMPACT == 1
+            DeltaCodec_Reset(&anoCodec[i]);
+#endif
+        }
+    }
+}
+
+// 取一块空闲缓冲区，把本周期到期的各帧依次打包进去，整块交给DMA发送；任何情况下都不等待
+static void Ano_TelemetrySend(void) {
+    AnoTelemetryData data;
+    AnoFrameBuilder builder;
+    uint8_t *buf;
+    uint32_t seq, i, backlog, due = 0;
+
+    do {
+        seq = tSeqLockReadBegin(&anoDataLock);
+        data = anoData;
+    } while (tSeqLockReadRetry(&anoDataLock, seq));
+
+    backlog = Ano_TelemetryAdapt();
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        AnoStreamStat *stream = &anoStat.stream[i];
+        if (!(anoFrames & data.valid & (1 << i))) {
+            continue;
+        }
+        if (++anoStreamPhase[i] < stream->divider) {
+            stream->shed++;
+            continue;
+        }
+        anoStreamPhase[i] = 0;
+        // 已降到最低频率仍然拥塞，低优先级流本周期整帧丢弃
+        if ((backlog > ANO_BACKLOG_HIGH) && !((1 << i) & ANO_TELEMETRY_HIGH_PRIO) && (stream->divider >= ANO_DIVIDER_MAX)) {
+            stream->dropped++;
+            continue;
+        }
+        due |= 1 << i;
+    }
+    if (due == 0) {
+        return;
+    }
+
+    if (tMemBlockNoWaitGet(&anoTxPool, &buf, 0) != tErrorNoError) {
+        anoStat.noBuffer++;
+        Ano_TelemetryDrop(due);
+        return;
+    }
+
+    AnoFrame_Init(&builder, buf, ANO_TELEMETRY_BUF_SIZE);
+#if ANO_TELEMETRY_COMPACT == 1
+    Ano_PackCompactData(&builder, due, &data);
+#else
+    if (due & ANO_FRAME_SENSOR) {
+        Ano_Pack01(&builder, data.ax, data.ay, data.az, data.gx, data.gy, data.gz);
+    }
+    if (due & ANO_FRAME_ATTITUDE) {
+        Ano_Pack03(&builder, data.Roll, data.Pitch, data.Yaw);
+    }
+    if (due & ANO_FRAME_QUATERNION) {
+        Ano_Pack04(&builder, data.q[0], data.q[1], data.q[2], data.q[3]);
+    }
+#endif
+
+    if (MySerial_WriteDirect(buf, builder.len, Ano_TelemetryDone, (void *)0) != tErrorNoError) {
+        tMemBlockNotify(&anoTxPool, buf);
+        anoStat.queueFull++;
+        Ano_TelemetryDrop(due);
+        return;
+    }
+    anoStat.batches++;
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        if (due & (1 << i)) {
+            anoStat.stream[i].sent++;
+            anoStat.frames++;
+        }
+    }
+}
+
+#define ANO_LEN_KERNEL      (7 + 1 + 4 * ANO_KERNEL_MAX_TASKS + 1 + 2 * ANO_KERNEL_MAX_QUEUES)
+
+#if ANO_FRAME_SIZE(ANO_LEN_KERNEL) > ANO_TELEMETRY_BUF_SIZE
+#error "ANO_TELEMETRY_BUF_SIZE must hold the kernel status frame"
+#endif
+#if (TINYOS_ENABLE_REGISTRY == 1) && (TINYOS_ENABLE_TASK_INFO == 0)
+#error "the kernel status frame reads each task with tTaskGetInfo, enable TINYOS_ENABLE_TASK_INFO"
+#endif
+
+// 上一帧内核状态时各任务的运行周期数，用于得出本周期内的占用，只由遥测任务访问
+#if (TINYOS_ENABLE_REGISTRY == 1) && (TINYOS_ENABLE_CPUUSAGE_STATE == 1)
+static tTask *anoKernelTask[ANO_KERNEL_MAX_TASKS];
+static uint64_t anoKernelCycles[ANO_KERNEL_MAX_TASKS];
+#endif
+static uint32_t anoKernelPhase;
+
+static __inline uint16_t Ano_Saturate16(uint32_t value) {
+    return (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+}
+
+#if TINYOS_ENABLE_REGISTRY == 1
+// 在临界区内取出第index个登记对象，找到第一个类型相符的为止，没有时返回0
+static tObject *Ano_KernelNextObject(uint32_t *index, tObjectType type, uint32_t eventType) {
+    tObject *object;
+    uint32_t status = tTaskEnterCritical();
+
+    while ((object = tRegistryAt((*index)++)) != (tObject *)0) {
+        tEvent *event = tNodeParent(object, tEvent, object);
+
+        if ((object->type == (uint32_t)type) && ((type != tObjectTypeEvent) || (event->type == (tEventType)eventType))) {
+            break;
+        }
+    }
+    tTaskExitCritical(status);
+    return object;
+}
+#endif
+
+// 打包内核状态帧，统计项的读取都不等待，耗时主要在栈水位(未开启STACK_MONITOR时需扫描栈)
+static void Ano_PackKernel(AnoFrameBuilder *builder) {
+    uint32_t overruns = 0;
+    uint32_t latency = 0;
+    uint32_t tasks = 0, queues = 0;
+    uint8_t prio[ANO_KERNEL_MAX_TASKS];
+    uint8_t load[ANO_KERNEL_MAX_TASKS];
+    uint16_t stackFree[ANO_KERNEL_MAX_TASKS];
+    uint8_t queuePeak[ANO_KERNEL_MAX_QUEUES];
+    uint8_t queueSize[ANO_KERNEL_MAX_QUEUES];
+    uint32_t i;
+#if TINYOS_ENABLE_REGISTRY == 1
+    tObject *object;
+    tTaskInfo info;
+    uint32_t index = 0;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    uint64_t delta[ANO_KERNEL_MAX_TASKS];
+    uint64_t total = 0;
+#endif
+
+    while ((tasks < ANO_KERNEL_MAX_TASKS) && ((object = Ano_KernelNextObject(&index, tObjectTypeTask, 0)) != (tObject *)0)) {
+        tTask *task = tNodeParent(object, tTask, object);
+
+        tTaskGetInfo(task, &info);
+        prio[tasks] = (uint8_t)info.prio;
+        stackFree[tasks] = Ano_Saturate16(info.stackFree / 4);
+        overruns += info.overrunCount;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+        // 新出现的任务从本帧开始统计
+        delta[tasks] = (anoKernelTask[tasks] == task) ? (info.runCycles - anoKernelCycles[tasks]) : 0;
+        anoKernelTask[tasks] = task;
+        anoKernelCycles[tasks] = info.runCycles;
+        total += delta[tasks];
+#endif
+        tasks++;
+    }
+    for (i = 0; i < tasks; i++) {
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+        load[i] = (total > 0) ? (uint8_t)(delta[i] * 100 / total) : 0;
+#else
+        load[i] = 0xFF;
+#endif
+    }
+
+#if TINYOS_ENABLE_QUEUE == 1
+    index = 0;
+    while ((queues < ANO_KERNEL_MAX_QUEUES) && ((object = Ano_KernelNextObject(&index, tObjectTypeEvent, tEventTypeQueue)) != (tObject *)0)) {
+        tEvent *event = tNodeParent(object, tEvent, object);
+        tQueueInfo queueInfo;
+
+        tQueueGetInfo(tNodeParent(event, tQueue, event), &queueInfo);
+        queuePeak[queues] = (uint8_t)((queueInfo.peakCount > 0xFF) ? 0xFF : queueInfo.peakCount);
+        queueSize[queues] = (uint8_t)((queueInfo.maxCount > 0xFF) ? 0xFF : queueInfo.maxCount);
+        queues++;
+    }
+#endif
+#endif
+
+#if TINYOS_ENABLE_PROFILING == 1
+    {
+        tProfileInfo profile;
+
+        tProfileGetInfo(tProfilePathSysTickLatency, &profile);
+        latency = profile.maxCycles;
+    }
+#endif
+
+    if (!AnoFrame_Begin(builder, ANO_KERNEL_ID, (uint8_t)(7 + 1 + 4 * tasks + 1 + 2 * queues))) {
+        return;
+    }
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    AnoFrame_PutS16(builder, (int16_t)Ano_Saturate16((uint32_t)(tCpuUsageGet() * 100.0f)));
+#else
+    AnoFrame_PutS16(builder, 0);
+#endif
+    AnoFrame_PutS16(builder, (int16_t)Ano_Saturate16(latency));
+    AnoFrame_PutS16(builder, (int16_t)Ano_Saturate16(overruns));
+    AnoFrame_PutU8(builder, (uint8_t)tasks);
+    for (i = 0; i < tasks; i++) {
+        AnoFrame_PutU8(builder, prio[i]);
+        AnoFrame_PutU8(builder, load[i]);
+        AnoFrame_PutS16(builder, (int16_t)stackFree[i]);
+    }
+    AnoFrame_PutU8(builder, (uint8_t)queues);
+    for (i = 0; i < queues; i++) {
+        AnoFrame_PutU8(builder, queuePeak[i]);
+        AnoFrame_PutU8(builder, queueSize[i]);
+    }
+    AnoFrame_End(builder);
+}
+
+// 内核状态帧单独占用一块缓冲区，发不出时等下一个周期，不影响数据流
+static void Ano_KernelSend(void) {
+    AnoFrameBuilder builder;
+    uint8_t *buf;
+
+    if (tMemBlockNoWaitGet(&anoTxPool, &buf, 0) != tErrorNoError) {
+        anoStat.noBuffer++;
+        return;
+    }
+    AnoFrame_Init(&builder, buf, ANO_TELEMETRY_BUF_SIZE);
+    Ano_PackKernel(&builder);
+    if (MySerial_WriteDirect(buf, builder.len, Ano_TelemetryDone, (void *)0) != tErrorNoError) {
+        tMemBlockNotify(&anoTxPool, buf);
+        anoStat.queueFull++;
+        return;
+    }
+    anoStat.kernelFrames++;
+}
+
+// 电池帧同样单独占用一块缓冲区
+static uint32_t anoBatteryPhase;
+
+static void Ano_BatterySend(void) {
+    AnoFrameBuilder builder;
+    BatteryState battery;
+    uint8_t *buf;
+
+    Battery_Get(&battery);
+    if (!battery.valid) {
+        return;
+    }
+    if (tMemBlockNoWaitGet(&anoTxPool, &buf, 0) != tErrorNoError) {
+        anoStat.noBuffer++;
+        return;
+    }
+    AnoFrame_Init(&builder, buf, ANO_TELEMETRY_BUF_SIZE);
+    if (AnoFrame_Begin(&builder, ANO_BATTERY_ID, ANO_LEN_BATTERY)) {
+        AnoFrame_PutS16(&builder, (int16_t)Ano_Saturate16((uint32_t)(battery.voltage * 100.0f + 0.5f)));
+        AnoFrame_PutS16(&builder, (int16_t)Ano_Saturate16((battery.current > 0.0f) ? (uint32_t)(battery.current * 100.0f + 0.5f) : 0));
+        AnoFrame_End(&builder);
+    }
+    if (MySerial_WriteDirect(buf, builder.len, Ano_TelemetryDone, (void *)0) != tErrorNoError) {
+        tMemBlockNotify(&anoTxPool, buf);
+        anoStat.queueFull++;
+        return;
+    }
+    anoStat.batteryFrames++;
+}
+
+static void Ano_TelemetryEntry(void *param) {
+    uint32_t lastWakeTick = tTaskTickGet();
+
+    for (;;) {
+        tTaskDelayUntil(&lastWakeTick, ANO_TELEMETRY_PERIOD_TICKS);
+        Ano_TelemetrySend();
+        if ((anoFrames & ANO_FRAME_KERNEL) &&
+            (++anoKernelPhase >= ANO_KERNEL_PERIOD_TICKS / ANO_TELEMETRY_PERIOD_TICKS)) {
+            anoKernelPhase = 0;
+            Ano_KernelSend();
+        }
+        if ((anoFrames & ANO_FRAME_BATTERY) &&
+            (++anoBatteryPhase >= ANO_BATTERY_PERIOD_TICKS / ANO_TELEMETRY_PERIOD_TICKS)) {
+            anoBatteryPhase = 0;
+            Ano_BatterySend();
+        }
+    }
+}
+
+/**
+ * @brief 创建遥测任务，需在MySerial_Init之后调用
+ *
+ * 遥测任务只做不等待的操作：缓冲区或发送队列不够时丢弃本周期的帧，链路拥塞时降低低优先级流的频率，
+ * 不会阻塞控制回路，也不会因串口积压而延迟。
+ * @param frames 每个周期发送的帧，ANO_FRAME_xxx的组合，尚未发布过的帧不发送
+ */
+void Ano_TelemetryInit(uint32_t frames) {
+    uint32_t i;
+
+    tSeqLockInit(&anoDataLock);
+    anoData.valid = 0;
+    anoFrames = frames;
+    for (i = 0; i < ANO_STREAM_COUNT; i++) {
+        anoStat.stream[i].divider = 1;
+        anoStreamPhase[i] = 0;
+#if ANO_TELEMETRY_COMPACT == 1
+        DeltaCodec_Init(&anoCodec[i], anoCompactFields[i], anoCompactPredictor[i]);
+        anoCompactSeq[i] = 0;
+        anoCompactCount[i] = 0;
+#endif
+    }
+    tMemBlockInit(&anoTxPool, (uint8_t *)anoTxMem, ANO_TELEMETRY_BUF_SIZE, ANO_TELEMETRY_BUF_COUNT);
+    tTaskInit(&anoTask, Ano_TelemetryEntry, (void *)0, ANO_TELEMETRY_PRIO, anoTaskStack, sizeof(anoTaskStack));
+    tObjectSetName(&anoTask.object, "telemetry");
+}
+
+/**
+ * @brief 读取遥测统计
+ * @param stat 统计信息
+ */
+void Ano_TelemetryGetStat(AnoTelemetryStat *stat) {
+    uint32_t status = tTaskEnterCritical();
+    *stat = anoStat;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 改变每个周期发送的帧，可在任意任务中调用，遥测任务下一个周期按新的组合发送
+ * @param frames ANO_FRAME_xxx的组合，为0时停止发送
+ */
+void Ano_TelemetrySetFrames(uint32_t frames) {
+    anoFrames = frames;
+}
+
+uint32_t Ano_TelemetryGetFrames(void) {
+    return anoFrames;
+}
+#endif
@@ -3,9 +3,107 @@
 
 #include <stdint.h> // 包含标准整数类型
 #include "main.h"
+
+// 遥测任务配置：控制回路发布最新数据，遥测任务按固定周期把各类帧打包进存储池的一块缓冲区，
+// 整块经DMA一次发出，发送速率与控制回路解耦；需开启TINYOS_ENABLE_MEMBLOCK及MYSERIAL_TX_USE_DMA
+#define ANO_TELEMETRY_PERIOD_TICKS  2   // 遥测发送周期(节拍)
+#define ANO_TELEMETRY_BUF_SIZE      64  // 每块发送缓冲区的字节数，需放得下一个周期的所有帧，4的倍数
+#define ANO_TELEMETRY_BUF_COUNT     3   // 发送缓冲区块数，DMA发送中的块归还前不能再用
+#define ANO_TELEMETRY_STACK_SIZE    256 // 遥测任务栈(字)
+#define ANO_TELEMETRY_PRIO          (TINYOS_PRIO_COUNT - 3) // 低于控制任务，高于命令行及日志任务
+
+// 每个周期发送的帧，每种帧为一路数据流
+#define ANO_FRAME_SENSOR            (1 << 0) // 0x01 六轴数据
+#define ANO_FRAME_ATTITUDE          (1 << 1) // 0x03 姿态角
+#define ANO_FRAME_QUATERNION        (1 << 2) // 0x04 四元数
+#define ANO_STREAM_COUNT            3
+#define ANO_FRAME_KERNEL            (1 << 3) // 内核状态帧，不属于按周期发送的数据流，见下
+#define ANO_FRAME_BATTERY           (1 << 4) // 0x0D 电压电流，同样单独低速发送
+#define ANO_FRAME_ALL               (ANO_FRAME_SENSOR | ANO_FRAME_ATTITUDE | ANO_FRAME_QUATERNION | ANO_FRAME_KERNEL | ANO_FRAME_BATTERY)
+
+// 内核状态帧：每ANO_KERNEL_PERIOD_TICKS个节拍单独发送一帧用户自定义帧ANO_KERNEL_ID，数据部分(小端)为
+//   CPU占用(u16，0.01%) 最大SysTick中断延迟(u16，CPU周期) 周期任务错过释放时刻的总次数(u16)
+//   任务数(u8) 每个任务[优先级(u8) 本周期内的CPU占用(u8，%) 栈剩余(u16，字)]
+//   队列数(u8) 每个队列[最高水位(u8) 容量(u8)]
+// 任务及队列经对象登记表遍历(需TINYOS_ENABLE_REGISTRY)，超过上限的不发送；未开启的统计项为0，CPU占用未知时为0xFF
+#define ANO_KERNEL_ID               0xF4
+#define ANO_KERNEL_PERIOD_TICKS     500
+#define ANO_KERNEL_MAX_TASKS        8
+#define ANO_KERNEL_MAX_QUEUES       4
+
+// 电池帧：每ANO_BATTERY_PERIOD_TICKS个节拍发送一帧0x0D，数据为电压(u16，0.01V)、电流(u16，0.01A)，
+// 直接读取Battery.c发布的状态，尚未测得(或未开启BATTERY_ENABLE)时不发送
+#define ANO_BATTERY_ID              0x0D
+#define ANO_BATTERY_PERIOD_TICKS    100
+
+// 链路拥塞时的降速：高优先级的流始终按遥测周期发送，其余的流降低发送频率(每divider个周期发一次)
+// 发送积压(串口发送环形缓冲区与直接发送队列中的字节数)超过高水位，或按实测链路容量估算的发送量超出
+// ANO_LINK_USAGE%时，低优先级流的divider加倍；积压连续ANO_RECOVER_CYCLES个周期低于低水位且容量允许时减半
+#define ANO_TELEMETRY_HIGH_PRIO     ANO_FRAME_ATTITUDE
+#define ANO_BACKLOG_HIGH            128 // 积压高水位(字节)
+#define ANO_BACKLOG_LOW             32  // 积压低水位(字节)
+#define ANO_RECOVER_CYCLES          25  // 恢复一级发送频率所需的连续空闲周期数
+#define ANO_DIVIDER_MAX             16  // 低优先级流最多降到每16个周期发一次，再拥塞时整帧丢弃
+#define ANO_RATE_WINDOW_TICKS       50  // 统计链路吞吐量的窗口(节拍)
+#define ANO_LINK_USAGE              80  // 遥测最多占用的实测链路容量百分比
+
+// 紧凑遥测：为1时周期遥测的三种帧改用用户自定义帧发送(功能字ANO_COMPACT_ID_BASE + 流序号)，数据部分为
+// 1字节标志(最高位为关键帧，低7位为该流的帧序号) + 各字段相对预测值的残差(DeltaCodec编码)，字段及放大倍数与原帧相同；
+// 六轴数据按上一帧预测，姿态角与四元数按线性外推预测。每ANO_COMPACT_KEY_INTERVAL帧及每次未能发出之后发一个关键帧，
+// 接收端发现序号不连续或校验错误时丢弃到下一个关键帧。上位机不能直接显示，需用Tools/deltadecode.py还原
+#define ANO_TELEMETRY_COMPACT       0
+#define ANO_COMPACT_ID_BASE         0xF1    // 六轴0xF1，姿态角0xF2，四元数0xF3
+#define ANO_COMPACT_KEY_INTERVAL    50      // 关键帧间隔(帧)
+
+// 帧打包器：数据直接写入目标缓冲区，和校验与附加校验随写入逐字节累计
+typedef struct _AnoFrameBuilder {
+    uint8_t *buf;
+    uint32_t len;
+    uint32_t size;
+    uint32_t frameEnd;  // 当前帧数据部分应结束的位置
+    uint8_t sumcheck;
+    uint8_t addcheck;
+} AnoFrameBuilder;
+
+// 每路数据流的统计
+typedef struct _AnoStreamStat {
+    uint32_t divider;   // 当前每几个周期发送一次
+    uint32_t sent;      // 发送的帧数
+    uint32_t shed;      // 降速而跳过的帧数
+    uint32_t dropped;   // 到了发送周期但没有缓冲区或积压超过高水位而丢弃的帧数
+} AnoStreamStat;
+
+// 遥测统计
+typedef struct _AnoTelemetryStat {
+    uint32_t batches;   // DMA发送的批数
+    uint32_t frames;    // 发送的帧数
+    uint32_t noBuffer;  // 发送缓冲区都在DMA发送中而跳过的周期数
+    uint32_t queueFull; // 串口直接发送队列已满而跳过的周期数
+    uint32_t backlog;   // 最近一个周期的发送积压(字节)
+    uint32_t linkBytesPerSec; // 链路容量估计：积压期间实测，未饱和时逐窗口放宽，尚未测得时为0
+    uint32_t kernelFrames;  // 发送的内核状态帧数
+    uint32_t batteryFrames; // 发送的电池帧数
+    AnoStreamStat stream[ANO_STREAM_COUNT]; // 按ANO_FRAME_xxx的位序排列
+} AnoTelemetryStat;
+
+void AnoFrame_Init(AnoFrameBuilder *builder, uint8_t *buf, uint32_t size); // 开始向buf打包
+uint32_t AnoFrame_Begin(AnoFrameBuilder *builder, uint8_t id, uint8_t dataLen); // 开始一帧，空间不足时返回0
+void AnoFrame_PutU8(AnoFrameBuilder *builder, uint8_t value); // 写入1字节数据
+void AnoFrame_PutS16(AnoFrameBuilder *builder, int16_t value); // 写入2字节数据，低字节在前
+void AnoFrame_End(AnoFrameBuilder *builder); // 结束一帧，写入校验
+
 // 上位机通信函数声明
 void SendToAno03(float Roll, float Pitch, float Yaw); // 发送姿态角数据
 void SendToAno01(float ax, float ay, float az, float gx, float gy, float gz); // 发送六个轴数据
 void SendToAno04(float q0,float q1,float q2,float q3); // 发送姿态四元数数据
 
+// 周期遥测，发布函数只能由同一个任务(控制回路)调用
+void Ano_TelemetryInit(uint32_t frames); // 创建遥测任务，frames为ANO_FRAME_xxx的组合
+void Ano_PublishSensor(float ax, float ay, float az, float gx, float gy, float gz); // 发布六轴数据
+void Ano_PublishAttitude(float Roll, float Pitch, float Yaw); // 发布姿态角
+void Ano_PublishQuaternion(float q0, float q1, float q2, float q3); // 发布四元数
+void Ano_TelemetryGetStat(AnoTelemetryStat *stat); // 读取遥测统计
+void Ano_TelemetrySetFrames(uint32_t frames); // 改变发送的帧，下一个周期生效
+uint32_t Ano_TelemetryGetFrames(void);
+
 #endif // ANONYMITY_H
@@ -0,0 +1,271 @@
+#include "AttitudeEstimator.h"
+
+#if ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_EKF
+
+#include "AttitudeQuat.h"
+#include "tSeqLock.h"
+
+// 误差状态扩展卡尔曼滤波：名义状态为四元数q与陀螺仪零偏b，误差状态为机体系下的小角度δθ与零偏误差δb，共6维
+// 预测：q ← q ⊗ [1, (ω - b)dt / 2]，P ← F P F^T + Q，F = [I - [(ω - b)dt]×, -I dt; 0, I]，每个陀螺仪样本一次
+// 更新：量测为加速度计的重力方向，h = R^T [0 0 1]，对δθ的雅可比为[h]×，对δb为0，
+// 修正量δx = K(a - h)注入名义状态后清零；只有重力量测时偏航及z轴零偏不可观，其协方差随时间增长
+// 量测更新每ATTITUDE_EKF_UPDATE_DIV次预测做一次，使用其间加速度的均值
+//
+// P对称，只保存上三角的21个元素，按3x3分块：Paa(姿态，对称)、Pab(姿态-零偏)、Pbb(零偏，对称)：
+//   预测：Paa ← A Paa A^T - dt(A Pab + (A Pab)^T) + dt² Pbb + Qa，Pab ← A Pab - dt Pbb，Pbb ← Pbb + Qb
+//   更新：H只有姿态块非零，P H^T、S只涉及Paa及Pab；协方差按Joseph形式(I - KH)P(I - KH)^T + K R K^T展开，
+//         即P - K(PH^T)^T - (PH^T)K^T + K S K^T，舍入误差下仍保持半正定，不需要事后对称化
+// 单精度下预测约100次乘加，更新约400次乘加及一次除法，F401(84MHz)上两者合计约30us，可用于500Hz
+
+#define EKF_N   6
+#define EKF_PACKED  (EKF_N * (EKF_N + 1) / 2)
+
+// 上三角(i <= j)按行压缩存放的下标
+#define EKF_IDX(i, j)   ((i) * EKF_N - ((i) * ((i) - 1)) / 2 + ((j) - (i)))
+
+static AttitudeQuat ekfQ = {1.0f, 0.0f, 0.0f, 0.0f};
+static float ekfBias[3];
+static float ekfP[EKF_PACKED];
+static float ekfAccel[3];       // 两次量测更新之间的加速度之和
+static uint32_t ekfAccelCount;
+
+static float ekfSnapshot[2][4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch ekfLatch = {{0}, {ekfSnapshot[0], ekfSnapshot[1]}, sizeof(ekfSnapshot[0])};
+
+// 对称矩阵的任一元素
+static __inline float AttitudeEKF_P(int i, int j) {
+    return (i <= j) ? ekfP[EKF_IDX(i, j)] : ekfP[EKF_IDX(j, i)];
+}
+
+// q ← q ⊗ [1, v / 2]并归一化，v为机体系下的小转角(rad)
+static void AttitudeEKF_Rotate(float vx, float vy, float vz) {
+    ekfQ = AttitudeQuat_IntegrateNormalize(ekfQ, AttitudeVec3_Make(vx, vy, vz));
+}
+
+/**
+ * @brief 协方差预测 P ← F P F^T + Q，按F的分块结构展开，只计算上三角
+ *        F = [A, -dt I; 0, I]，A = I - [u]×，u = (ω - b)dt
+ *
+ * @param ux, uy, uz 本步转角(rad)
+ * @param dt 步长(s)
+ *
+ * @return void
+ */
+static void AttitudeEKF_PredictCovariance(float ux, float uy, float uz, float dt) {
+    float A[3][3];
+    float AP[3][3];     // A Paa
+    float AB[3][3];     // A Pab
+    float gyroVar = ATTITUDE_EKF_GYRO_NOISE * ATTITUDE_EKF_GYRO_NOISE * dt * dt;
+    float biasVar = ATTITUDE_EKF_BIAS_NOISE * ATTITUDE_EKF_BIAS_NOISE * dt;
+    float dt2 = dt * dt;
+    int i, j, k;
+
+    A[0][0] = 1.0f; A[0][1] = uz;   A[0][2] = -uy;
+    A[1][0] = -uz;  A[1][1] = 1.0f; A[1][2] = ux;
+    A[2][0] = uy;   A[2][1] = -ux;  A[2][2] = 1.0f;
+
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            float sa = 0.0f, sb = 0.0f;
+            for (k = 0; k < 3; k++) {
+                sa += A[i][k] * AttitudeEKF_P(k, j);
+                sb += A[i][k] * ekfP[EKF_IDX(k, j + 3)];
+            }
+            AP[i][j] = sa;
+            AB[i][j] = sb;
+        }
+    }
+
+    // Paa的上三角，Pbb此时还是旧值
+    for (i = 0; i < 3; i++) {
+        for (j = i; j < 3; j++) {
+            float sum = dt2 * ekfP[EKF_IDX(i + 3, j + 3)] - dt * (AB[i][j] + AB[j][i]);
+            for (k = 0; k < 3; k++) {
+                sum += AP[i][k] * A[j][k];
+            }
+            ekfP[EKF_IDX(i, j)] = sum;
+        }
+        ekfP[EKF_IDX(i, i)] += gyroVar;
+    }
+
+    // Pab为整块，再更新Pbb的对角线
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            ekfP[EKF_IDX(i, j + 3)] = AB[i][j] - dt * AttitudeEKF_P(i + 3, j + 3);
+        }
+    }
+    for (i = 3; i < EKF_N; i++) {
+        ekfP[EKF_IDX(i, i)] += biasVar;
+    }
+}
+
+/**
+ * @brief 以归一化后的加速度计方向做一次量测更新
+ *
+ * @param ax, ay, az 归一化的加速度方向
+ *
+ * @return void
+ */
+static void AttitudeEKF_Correct(float ax, float ay, float az) {
+    AttitudeVec3 g = AttitudeQuat_Gravity(ekfQ);
+    float h[3], H[3][3], r[3];
+    float PHt[EKF_N][3];    // P H^T，H只有前三列非零
+    float S[3][3], Si[3][3];
+    float K[EKF_N][3];
+    float KS[EKF_N][3];     // K S，Joseph形式中K S K^T的左半部分
+    float dx[EKF_N];
+    float det;
+    int i, j, k;
+
+    // 预测的重力方向及残差
+    h[0] = g.x;
+    h[1] = g.y;
+    h[2] = g.z;
+    r[0] = ax - h[0];
+    r[1] = ay - h[1];
+    r[2] = az - h[2];
+
+    // H = [h]×
+    H[0][0] = 0.0f;  H[0][1] = -h[2]; H[0][2] = h[1];
+    H[1][0] = h[2];  H[1][1] = 0.0f;  H[1][2] = -h[0];
+    H[2][0] = -h[1]; H[2][1] = h[0];  H[2][2] = 0.0f;
+
+    // P H^T只用到P的前三列，即Paa及Pab^T
+    for (i = 0; i < EKF_N; i++) {
+        float p0 = AttitudeEKF_P(i, 0), p1 = AttitudeEKF_P(i, 1), p2 = AttitudeEKF_P(i, 2);
+        for (j = 0; j < 3; j++) {
+            PHt[i][j] = p0 * H[j][0] + p1 * H[j][1] + p2 * H[j][2];
+        }
+    }
+
+    // S = H P H^T + R，对称，只算上三角
+    for (i = 0; i < 3; i++) {
+        for (j = i; j < 3; j++) {
+            S[i][j] = H[i][0] * PHt[0][j] + H[i][1] * PHt[1][j] + H[i][2] * PHt[2][j];
+            S[j][i] = S[i][j];
+        }
+        S[i][i] += ATTITUDE_EKF_ACCEL_NOISE * ATTITUDE_EKF_ACCEL_NOISE;
+    }
+
+    // 3x3对称矩阵求逆(伴随矩阵)，伴随矩阵同样对称
+    Si[0][0] = S[1][1] * S[2][2] - S[1][2] * S[1][2];
+    Si[0][1] = S[0][2] * S[1][2] - S[0][1] * S[2][2];
+    Si[0][2] = S[0][1] * S[1][2] - S[0][2] * S[1][1];
+    Si[1][1] = S[0][0] * S[2][2] - S[0][2] * S[0][2];
+    Si[1][2] = S[0][2] * S[0][1] - S[0][0] * S[1][2];
+    Si[2][2] = S[0][0] * S[1][1] - S[0][1] * S[0][1];
+    Si[1][0] = Si[0][1];
+    Si[2][0] = Si[0][2];
+    Si[2][1] = Si[1][2];
+    det = S[0][0] * Si[0][0] + S[0][1] * Si[1][0] + S[0][2] * Si[2][0];
+    if (!(det > 1e-12f)) {
+        return;
+    }
+    det = 1.0f / det;
+
+    // K = P H^T S^-1，δx = K r
+    for (i = 0; i < EKF_N; i++) {
+        for (j = 0; j < 3; j++) {
+            K[i][j] = (PHt[i][0] * Si[0][j] + PHt[i][1] * Si[1][j] + PHt[i][2] * Si[2][j]) * det;
+        }
+        for (j = 0; j < 3; j++) {
+            KS[i][j] = K[i][0] * S[0][j] + K[i][1] * S[1][j] + K[i][2] * S[2][j];
+        }
+        dx[i] = K[i][0] * r[0] + K[i][1] * r[1] + K[i][2] * r[2];
+    }
+
+    // Joseph形式：P ← P - K (P H^T)^T - (P H^T) K^T + (K S) K^T，只算上三角
+    for (i = 0; i < EKF_N; i++) {
+        for (j = i; j < EKF_N; j++) {
+            float sum = 0.0f;
+            for (k = 0; k < 3; k++) {
+                sum += K[i][k] * PHt[j][k] + PHt[i][k] * K[j][k] - KS[i][k] * K[j][k];
+            }
+            ekfP[EKF_IDX(i, j)] -= sum;
+        }
+    }
+
+    // 注入名义状态，误差状态随之清零
+    AttitudeEKF_Rotate(dx[0], dx[1], dx[2]);
+    ekfBias[0] += dx[3];
+    ekfBias[1] += dx[4];
+    ekfBias[2] += dx[5];
+}
+
+void AttitudeEstimator_Init(float gain) {
+    int i;
+
+    (void)gain;
+    ekfQ = AttitudeQuat_Identity();
+    for (i = 0; i < 3; i++) {
+        ekfBias[i] = 0.0f;
+        ekfAccel[i] = 0.0f;
+    }
+    ekfAccelCount = 0;
+    for (i = 0; i < EKF_PACKED; i++) {
+        ekfP[i] = 0.0f;
+    }
+    for (i = 0; i < 3; i++) {
+        ekfP[EKF_IDX(i, i)] = ATTITUDE_EKF_INIT_ATT * ATTITUDE_EKF_INIT_ATT;
+        ekfP[EKF_IDX(i + 3, i + 3)] = ATTITUDE_EKF_INIT_BIAS * ATTITUDE_EKF_INIT_BIAS;
+    }
+    tSeqLatchWrite(&ekfLatch, &ekfQ);
+}
+
+// 协方差保持初始化时的值，对准误差仍按ATTITUDE_EKF_INIT_ATT考虑
+void AttitudeEstimator_SetQuaternion(const float *q) {
+    ekfQ = AttitudeQuat_Load(q);
+    tSeqLatchWrite(&ekfLatch, &ekfQ);
+}
+
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    float ux = (gx - ekfBias[0]) * dt;
+    float uy = (gy - ekfBias[1]) * dt;
+    float uz = (gz - ekfBias[2]) * dt;
+
+    AttitudeEKF_PredictCovariance(ux, uy, uz, dt);
+    AttitudeEKF_Rotate(ux, uy, uz);
+
+    ekfAccel[0] += ax;
+    ekfAccel[1] += ay;
+    ekfAccel[2] += az;
+    if (++ekfAccelCount >= ATTITUDE_EKF_UPDATE_DIV) {
+        float scale = 1.0f / (float)ekfAccelCount;
+        float norm2;
+
+        ax = ekfAccel[0] * scale;
+        ay = ekfAccel[1] * scale;
+        az = ekfAccel[2] * scale;
+        ekfAccel[0] = ekfAccel[1] = ekfAccel[2] = 0.0f;
+        ekfAccelCount = 0;
+
+        // 加速度模长明显偏离1g时含有运动加速度，不作为重力方向的量测
+        norm2 = ax * ax + ay * ay + az * az;
+        if (norm2 > 0.0f) {
+            float norm = ATTITUDE_SQRTF(norm2);
+            float dev = norm - 1.0f;
+
+            if ((dev < ATTITUDE_EKF_ACCEL_GATE) && (dev > -ATTITUDE_EKF_ACCEL_GATE)) {
+                norm = 1.0f / norm;
+                AttitudeEKF_Correct(ax * norm, ay * norm, az * norm);
+            }
+        }
+    }
+
+    tSeqLatchWrite(&ekfLatch, &ekfQ);
+}
+
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    (void)mx; (void)my; (void)mz;
+    AttitudeEstimator_UpdateIMU(gx, gy, gz, ax, ay, az, dt);
+}
+
+void AttitudeEstimator_GetQuaternion(float *q) {
+    tSeqLatchRead(&ekfLatch, q);
+}
+
+const char *AttitudeEstimator_GetName(void) {
+    return "ekf";
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "AttitudeEstimator.h"
+#include "AttitudeQuat.h"
+#if ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MADGWICK
+#include "MadgWick.h"
+#elif ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MYMADGWICK
+#include "MyMadgWick.h"
+#endif
+
+// 与后端无关的部分，以及MadgWick.c、MyMadgWick.c两个已有实现的适配；
+// Mahony、互补滤波及EKF后端分别在各自的源文件中实现同一组函数
+
+#if ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MADGWICK
+
+void AttitudeEstimator_Init(float gain) {
+    beta = gain;
+    q0 = 1.0f; q1 = 0.0f;
+    q2 = 0.0f; q3 = 0.0f;
+    MadgwickPublishQuaternion();
+}
+
+void AttitudeEstimator_SetQuaternion(const float *q) {
+    q0 = q[0]; q1 = q[1];
+    q2 = q[2]; q3 = q[3];
+    MadgwickPublishQuaternion();
+}
+
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    MadgwickAHRSupdateIMU(gx, gy, gz, ax, ay, az, dt);
+}
+
+void AttitudeEstimator_UpdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt) {
+    MadgwickAHRSupdateIMUBatch(gyro, count, ax, ay, az, dt);
+}
+
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    MadgwickAHRSupdate(gx, gy, gz, ax, ay, az, mx, my, mz, dt);
+}
+
+void AttitudeEstimator_GetQuaternion(float *q) {
+    MadgwickGetQuaternion(q);
+}
+
+const char *AttitudeEstimator_GetName(void) {
+    return "madgwick";
+}
+
+#elif ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MYMADGWICK
+
+void AttitudeEstimator_Init(float gain) {
+    (void)gain;
+    MyMadgWick_Reset();
+}
+
+void AttitudeEstimator_SetQuaternion(const float *q) {
+    MyMadgWick_Set(AttitudeQuat_Load(q));
+}
+
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    merge(ax, ay, az, gx, gy, gz, dt);
+}
+
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    (void)mx; (void)my; (void)mz;
+    merge(ax, ay, az, gx, gy, gz, dt);
+}
+
+void AttitudeEstimator_GetQuaternion(float *q) {
+    quaternion snapshot;
+
+    MyMadgWick_GetQuaternion(&snapshot);
+    AttitudeQuat_Store(q, snapshot);
+}
+
+const char *AttitudeEstimator_GetName(void) {
+    return "mymadgwick";
+}
+
+#endif
+
+#if ATTITUDE_ESTIMATOR != ATTITUDE_ESTIMATOR_MADGWICK
+// 没有专门批量更新的后端逐个样本更新，每个样本都使用整批的加速度；EKF的协方差预测本来就需要逐步进行
+void AttitudeEstimator_UpdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt) {
+    uint32_t i;
+
+    for (i = 0; i < count; i++, gyro += 3) {
+        AttitudeEstimator_UpdateIMU(gyro[0], gyro[1], gyro[2], ax, ay, az, dt);
+    }
+}
+#endif
+
+// 四元数换算欧拉角(ZYX顺序，单位°)，用多项式近似的AttitudeAtan2/AttitudeAsin，误差在0.001°以内；
+// 未归一化的四元数在±90°附近sin(pitch)可能略超出[-1, 1]，由AttitudeAsin按±1处理
+void AttitudeEstimator_QuaternionToEuler(const float *q, float *roll, float *pitch, float *yaw) {
+    *roll = AttitudeAtan2(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2])) * ATTITUDE_RAD_TO_DEG;
+    *pitch = AttitudeAsin(2.0f * (q[0] * q[2] - q[3] * q[1])) * ATTITUDE_RAD_TO_DEG;
+    *yaw = AttitudeAtan2(2.0f * (q[0] * q[3] + q[1] * q[2]), 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) * ATTITUDE_RAD_TO_DEG;
+}
+
+// 相对水平姿态的倾斜误差(°)：取机体系下的重力方向g = R^T [0 0 1]，小角度时roll ≈ g_y、pitch ≈ -g_x，
+// 与偏航无关且不需要三角函数；纯滚转时为sin(roll)，15°以内与欧拉角相差不到1.2%
+void AttitudeEstimator_TiltError(const float *q, float *roll, float *pitch) {
+    AttitudeVec3 g = AttitudeQuat_Gravity(AttitudeQuat_Load(q));
+
+    *roll = g.y * ATTITUDE_RAD_TO_DEG;
+    *pitch = -g.x * ATTITUDE_RAD_TO_DEG;
+}
+
+// 由当前后端的四元数快照换算欧拉角
+void AttitudeEstimator_GetEuler(float *roll, float *pitch, float *yaw) {
+    float q[4];
+
+    AttitudeEstimator_GetQuaternion(q);
+    AttitudeEstimator_QuaternionToEuler(q, roll, pitch, yaw);
+}
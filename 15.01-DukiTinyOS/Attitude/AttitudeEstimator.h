@@ -0,0 +1,39 @@
+#ifndef __ATTITUDEESTIMATOR_H
+#define __ATTITUDEESTIMATOR_H
+
+#include <stdint.h>
+
+// 姿态估计器接口：各后端实现同一组AttitudeEstimator_xxx函数，由ATTITUDE_ESTIMATOR在编译时选定一个，
+// 其余后端的源文件编译为空，不会链接进固件；四元数按{w, x, y, z}排列，均经双缓冲顺序锁发布，可在其它任务中读取
+#define ATTITUDE_ESTIMATOR_MADGWICK         0   // MadgWick.c，梯度下降，可融合磁力计，gain为beta
+#define ATTITUDE_ESTIMATOR_MYMADGWICK       1   // MyMadgWick.c，固定步长B的梯度下降，忽略gain
+#define ATTITUDE_ESTIMATOR_MAHONY           2   // Mahony.c，PI修正的互补滤波，gain为比例增益Kp
+#define ATTITUDE_ESTIMATOR_COMPLEMENTARY    3   // Complementary.c，重力方向一阶互补滤波，不做四元数积分，gain为加速度计修正速率(1/s)
+#define ATTITUDE_ESTIMATOR_EKF              4   // AttitudeEKF.c，误差状态扩展卡尔曼滤波，同时估计陀螺仪零偏，忽略gain
+
+#define ATTITUDE_ESTIMATOR                  ATTITUDE_ESTIMATOR_MADGWICK
+
+// Mahony后端的积分增益，为0时不做零偏积分
+#define ATTITUDE_MAHONY_KI                  0.0f
+
+// EKF后端的噪声参数
+#define ATTITUDE_EKF_GYRO_NOISE             0.01f   // 陀螺仪噪声(rad/s)
+#define ATTITUDE_EKF_BIAS_NOISE             0.0001f // 零偏随机游走(rad/s/√s)
+#define ATTITUDE_EKF_ACCEL_NOISE            0.05f   // 加速度计方向噪声(g)
+#define ATTITUDE_EKF_ACCEL_GATE             0.15f   // 加速度模长偏离1g超过该值时视为机动过载，跳过量测更新
+#define ATTITUDE_EKF_INIT_ATT               0.1f    // 初始姿态误差(rad)
+#define ATTITUDE_EKF_INIT_BIAS              0.02f   // 初始零偏误差(rad/s)
+#define ATTITUDE_EKF_UPDATE_DIV             1       // 每几次预测(陀螺仪样本)做一次加速度计量测更新
+
+void AttitudeEstimator_Init(float gain); // 复位为单位四元数，gain的含义见上
+void AttitudeEstimator_SetQuaternion(const float *q); // 以给定的单位四元数为当前姿态并发布，用于上电对准，其余状态不变
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt); // 陀螺仪rad/s，加速度计g(EKF按模长判断是否有运动加速度，其余后端只用方向)，dt(s)
+void AttitudeEstimator_UpdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt); // count个{gx, gy, gz}依次排列，加速度整批一个，dt为每个样本的间隔
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt); // 不支持磁力计的后端忽略磁力计
+void AttitudeEstimator_GetQuaternion(float *q); // 读取最近一次更新完成的四元数{w, x, y, z}
+void AttitudeEstimator_GetEuler(float *roll, float *pitch, float *yaw); // 由四元数快照换算的欧拉角(°)
+const char *AttitudeEstimator_GetName(void); // 当前后端的名称
+void AttitudeEstimator_QuaternionToEuler(const float *q, float *roll, float *pitch, float *yaw); // 四元数换算欧拉角(°)
+void AttitudeEstimator_TiltError(const float *q, float *roll, float *pitch); // 相对水平姿态的滚转、俯仰误差(°，小角度近似)
+
+#endif // __ATTITUDEESTIMATOR_H
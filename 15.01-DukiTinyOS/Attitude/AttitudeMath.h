@@ -0,0 +1,80 @@
+#ifndef __ATTITUDEMATH_H
+#define __ATTITUDEMATH_H
+
+#include <math.h>
+
+// 姿态解算用的单精度运算：Cortex-M4F的FPU只支持单精度，double常量或sqrt()会把整个表达式
+// 提升为双精度，退化为软件库调用，因此姿态相关代码中的常量一律带f后缀，开方统一使用ATTITUDE_SQRTF
+// 乘加按a * b + c的形式书写，可由编译器合并为VMLA/VFMA(ARMCC需--fpmode=fast，GCC默认即合并)
+
+#define ATTITUDE_PI         3.14159265f
+#define ATTITUDE_DEG_TO_RAD 0.0174532925f   // PI / 180
+#define ATTITUDE_RAD_TO_DEG 57.2957795f     // 180 / PI
+
+// 单精度开方，直接生成VSQRT.F32指令，不经过设置errno的库函数
+#if defined(__CC_ARM)
+#define ATTITUDE_SQRTF(x)   __sqrtf(x)
+#elif defined(__GNUC__)
+#define ATTITUDE_SQRTF(x)   __builtin_sqrtf(x)
+#else
+#define ATTITUDE_SQRTF(x)   sqrtf(x)
+#endif
+
+// 平方根倒数：VSQRT与VDIV各14个周期，比快速平方根倒数的整数运算加牛顿迭代更快，且为精确值
+static __inline float AttitudeInvSqrt(float x) {
+    return 1.0f / ATTITUDE_SQRTF(x);
+}
+
+// 限幅：写成两次条件选择，编译为VCMP后接IT块中的条件VMOV，不产生分支(M4F的FPv4没有VMAXNM/VMINNM)
+static __inline float AttitudeClamp(float v, float lo, float hi) {
+    v = (v > hi) ? hi : v;
+    return (v < lo) ? lo : v;
+}
+
+/**
+ * @brief 快速atan2：先把比值折叠到[0, 1]，用9次奇多项式(Abramowitz & Stegun 4.4.47)逼近，再按象限展开
+ *        最大误差1.2e-5 rad(0.0007°)，只有一次除法，约为库函数atan2f的几分之一
+ *
+ * @param y 纵坐标
+ * @param x 横坐标
+ *
+ * @retval 角度(rad)，范围[-PI, PI]，x、y均为0时返回0
+ */
+static __inline float AttitudeAtan2(float y, float x) {
+    float ax = (x < 0.0f) ? -x : x;
+    float ay = (y < 0.0f) ? -y : y;
+    float a, s, r;
+
+    if (ax >= ay) {
+        if (ax == 0.0f) {
+            return 0.0f;
+        }
+        a = ay / ax;
+    } else {
+        a = ax / ay;
+    }
+    s = a * a;
+    r = a * (0.9998660f + s * (-0.3302995f + s * (0.1801410f + s * (-0.0851330f + s * 0.0208351f))));
+    if (ay > ax) {
+        r = 0.5f * ATTITUDE_PI - r;
+    }
+    if (x < 0.0f) {
+        r = ATTITUDE_PI - r;
+    }
+    return (y < 0.0f) ? -r : r;
+}
+
+/**
+ * @brief 快速asin：asin(x) = atan2(x, sqrt(1 - x^2))，误差与AttitudeAtan2相同，参数超出[-1, 1]时按±1计算
+ *
+ * @param x 正弦值
+ *
+ * @retval 角度(rad)，范围[-PI/2, PI/2]
+ */
+static __inline float AttitudeAsin(float x) {
+    float c = 1.0f - x * x;
+
+    return AttitudeAtan2(x, (c > 0.0f) ? ATTITUDE_SQRTF(c) : 0.0f);
+}
+
+#endif // __ATTITUDEMATH_H
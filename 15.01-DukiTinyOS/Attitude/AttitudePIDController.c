@@ -1,8 +1,94 @@
 #include "AttitudePIDController.h"
 #include "MadgWick.h"
 #include "AttitudeSolver.h"
+#include "AttitudeEstimator.h"
 #include "MPU6050.h"
 #include "MySerial.h"
+#include "CalibStore.h"
+#include "FlashKV.h"
+#include "tinyOS.h"
+
+// PID参数在Flash中的保存顺序
+#define ATTITUDE_PID_GAIN_COUNT 5
+
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+// 温度模型作为一个值保存，端点数受单个值的大小限制
+typedef char AttitudeTempModelFitsFlashKV[(sizeof(AttitudeTempModel) <= FLASHKV_MAX_VALUE) ? 1 : -1];
+#endif
+
+//当前的零偏估计及加速度计校准写入备份寄存器，只是几次寄存器写入，可以在控制回路中调用
+static void AttitudePIDController_SaveBackup(void) {
+	CalibStoreData calib;
+	MPU6050AccelCalib accel;
+	int i;
+
+	AttitudeSolver_GetGyroBias(calib.gyroBias);
+	MPU6050_GetAccelCalib(MPU6050_PRIMARY, &accel);
+	for (i = 0; i < 3; i++) {
+		calib.accelScale[i] = accel.scale[i];
+		calib.accelOffset[i] = accel.offset[i];
+	}
+	CalibStore_Save(&calib);
+}
+
+void AttitudePIDController_SaveCalib(void) {
+	MPU6050AccelCalib accel;
+	float bias[3];
+
+	AttitudePIDController_SaveBackup();
+	MPU6050_GetAccelCalib(MPU6050_PRIMARY, &accel);
+	AttitudeSolver_GetGyroBias(bias);
+	FlashKV_Write(FLASHKV_KEY_ACCEL_CALIB, &accel, sizeof(accel));
+	FlashKV_Write(FLASHKV_KEY_GYRO_BIAS, bias, sizeof(bias));
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+	{
+		AttitudeTempModel model;
+		AttitudeSolver_GetTempModel(&model);
+		FlashKV_Write(FLASHKV_KEY_GYRO_TEMP, &model, sizeof(model));
+	}
+#endif
+}
+
+void AttitudePIDController_SaveGains(AttitudePIDController * attitudePIDController) {
+	PIDGains gains[ATTITUDE_PID_GAIN_COUNT];
+
+	PIDAxis3_GetGains(&attitudePIDController->attitudePID.angle, PID_AXIS_ROLL, &gains[0]);
+	PIDAxis3_GetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_ROLL, &gains[1]);
+	PIDAxis3_GetGains(&attitudePIDController->attitudePID.angle, PID_AXIS_PITCH, &gains[2]);
+	PIDAxis3_GetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_PITCH, &gains[3]);
+	PIDAxis3_GetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_YAW, &gains[4]);
+	FlashKV_Write(FLASHKV_KEY_PID_GAINS, gains, sizeof(gains));
+}
+
+//从Flash键值存储恢复校准及PID参数，长度不符(结构有变化)的记录不使用
+static void AttitudePIDController_Restore(AttitudePIDController * attitudePIDController) {
+	MPU6050AccelCalib accel;
+	PIDGains gains[ATTITUDE_PID_GAIN_COUNT];
+	float bias[3];
+
+	FlashKV_Init();
+	if (FlashKV_Read(FLASHKV_KEY_ACCEL_CALIB, &accel, sizeof(accel)) == sizeof(accel)) {
+		MPU6050_SetAccelCalib(MPU6050_PRIMARY, &accel);
+	}
+	if (FlashKV_Read(FLASHKV_KEY_GYRO_BIAS, bias, sizeof(bias)) == sizeof(bias)) {
+		AttitudeSolver_SetGyroBias(bias);
+	}
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+	{
+		AttitudeTempModel model;
+		if (FlashKV_Read(FLASHKV_KEY_GYRO_TEMP, &model, sizeof(model)) == sizeof(model)) {
+			AttitudeSolver_SetTempModel(&model);
+		}
+	}
+#endif
+	if (FlashKV_Read(FLASHKV_KEY_PID_GAINS, gains, sizeof(gains)) == sizeof(gains)) {
+		PIDAxis3_SetGains(&attitudePIDController->attitudePID.angle, PID_AXIS_ROLL, &gains[0]);
+		PIDAxis3_SetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_ROLL, &gains[1]);
+		PIDAxis3_SetGains(&attitudePIDController->attitudePID.angle, PID_AXIS_PITCH, &gains[2]);
+		PIDAxis3_SetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_PITCH, &gains[3]);
+		PIDAxis3_SetGains(&attitudePIDController->attitudePID.rate, PID_AXIS_YAW, &gains[4]);
+	}
+}
 
 void AttitudePIDController_Init(AttitudePIDController * attitudePIDController) {
 	//
@@ -15,34 +101,104 @@ void AttitudePIDController_Init(AttitudePIDController * attitudePIDController) {
 	attitudePIDController->Pitch = 0;
 	attitudePIDController->Roll = 0;
 	attitudePIDController->Yaw = 0;
-	attitudePIDController->count = 0;
 	
-	AttitudeSolver_Init(50, 0.8f); // 采样频率50Hz，增益为0.8
-	PIDAngleProc_Init(&attitudePIDController->rollPID,&attitudePIDController->pitchPID,&attitudePIDController->yawPID);
+	AttitudeSolver_Init(MPU6050_DEFAULT_RATE_HZ, 0.8f); // 标称采样频率只用于第一个样本，之后按时间戳间隔积分，增益为0.8
+	PIDAttitude_Init(&attitudePIDController->attitudePID, 1.0f / MPU6050_DEFAULT_RATE_HZ); //固定周期为标称采样周期
+	AttitudePIDController_Restore(attitudePIDController);
+	{
+		//备份寄存器保存的是上次运行中最新的零偏估计及加速度计校准，复位后仍有效时优先使用；
+		//都没有记录时零偏从0开始，静止片刻后收敛，加速度计沿用驱动中的默认参数
+		CalibStoreData calib;
+		if (CalibStore_Load(&calib) == 0) {
+			MPU6050AccelCalib accel;
+			int i;
+			for (i = 0; i < 3; i++) {
+				accel.scale[i] = calib.accelScale[i];
+				accel.offset[i] = calib.accelOffset[i];
+			}
+			MPU6050_SetAccelCalib(MPU6050_PRIMARY, &accel);
+			AttitudeSolver_SetGyroBias(calib.gyroBias);
+		}
+	}
 }
 
 void AttitudePIDController_ProcData(AttitudePIDController * attitudePIDController) {
 	//mpu6050处理数据
-		MPU6050_GetAccelData(&attitudePIDController->ax, &attitudePIDController->ay, &attitudePIDController->az);
-		MPU6050_GetGyroData(&attitudePIDController->gx, &attitudePIDController->gy, &attitudePIDController->gz);
-	//madgwick处理数据
-	  AttitudeSolver_UpdateIMU(attitudePIDController->gx, attitudePIDController->gy, attitudePIDController->gz,attitudePIDController->ax, attitudePIDController->ay, attitudePIDController->az);
+	//加速度与陀螺仪一次连续读取，经硬件I2C时本任务等待DMA完成期间让出CPU
+	//轮询读取没有数据就绪中断，以开始读取的时刻作为样本时间戳；读取失败时沿用上一次的数据
+		MPU6050TimedSample timed;
+		timed.timestamp = (uint32_t)tTimeGetMicros();
+		if (MPU6050_ReadSample(MPU6050_PRIMARY, &timed.sample) != 0) {
+			timed.sample.ax = attitudePIDController->ax;
+			timed.sample.ay = attitudePIDController->ay;
+			timed.sample.az = attitudePIDController->az;
+			timed.sample.gx = attitudePIDController->gx;
+			timed.sample.gy = attitudePIDController->gy;
+			timed.sample.gz = attitudePIDController->gz;
+		}
+		AttitudePIDController_ProcSample(attitudePIDController, &timed);
+}
+
+void AttitudePIDController_ProcSample(AttitudePIDController * attitudePIDController, const MPU6050TimedSample * timed) {
+		attitudePIDController->ax = timed->sample.ax;
+		attitudePIDController->ay = timed->sample.ay;
+		attitudePIDController->az = timed->sample.az;
+		attitudePIDController->gx = timed->sample.gx;
+		attitudePIDController->gy = timed->sample.gy;
+		attitudePIDController->gz = timed->sample.gz;
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+		AttitudeSolver_SetTemperature(timed->sample.temp);
+#endif
+	//madgwick处理数据，积分步长为与上一样本数据就绪时间戳之差
+	  AttitudeSolver_UpdateIMU(attitudePIDController->gx, attitudePIDController->gy, attitudePIDController->gz,attitudePIDController->ax, attitudePIDController->ay, attitudePIDController->az,
+			AttitudeSolver_SampleInterval(timed->timestamp));
+	//内环使用扣除零偏估计后的角速度；估计值更新一段时间后写入备份寄存器(不写Flash，飞行中不能让CPU停顿)
+	{
+		float bias[3];
+		AttitudeSolver_GetGyroBias(bias);
+		attitudePIDController->gx -= bias[0];
+		attitudePIDController->gy -= bias[1];
+		attitudePIDController->gz -= bias[2];
+		if (AttitudeSolver_TakeGyroBias(bias)) {
+			AttitudePIDController_SaveBackup();
+		}
+	}
+#if ATTITUDE_PID_QUAT_ERROR == 1
+	//由四元数直接得出倾斜误差，省去欧拉角换算
+	{
+		float q[4];
+		AttitudeSolver_GetQuaternion(q);
+		AttitudeEstimator_TiltError(q, &attitudePIDController->Roll, &attitudePIDController->Pitch);
+	}
+#else
 	//转换为欧拉角
-	 AttitudeSolver_GetEulerAngles(&attitudePIDController->Roll,&attitudePIDController->Pitch,&attitudePIDController->Yaw,&attitudePIDController->count);
+	 AttitudeSolver_GetEulerAngles(&attitudePIDController->Roll,&attitudePIDController->Pitch,&attitudePIDController->Yaw);
+#endif
 	//注意：此时三个角的单位为°
-//   printf("Accel: X=%.2fg Y=%.2fg Z=%.2fg\n", attitudePIDController->ax, attitudePIDController->ay, attitudePIDController->az);
-//	 printf("Gyro: X=%.2fPI Y=%.2fPI Z=%.2fPI\n", attitudePIDController->gx, attitudePIDController->gy, attitudePIDController->gz);
-//	 printf("Roll = %.2frad\tPitch = %.2frad\tYaw = %.2frad\n",attitudePIDController->Roll, attitudePIDController->Pitch, attitudePIDController->Yaw);
-//	printf("Roll = %.2f°\tPitch = %.2f°\tYaw = %.2f°\n",attitudePIDController->Roll * RAD_TO_DEG, attitudePIDController->Pitch * RAD_TO_DEG, attitudePIDController->Yaw * RAD_TO_DEG);
-	PIDAngleProc_Roll(&(attitudePIDController->rollPID),0.0f,attitudePIDController->Roll,attitudePIDController->gx);
-	PIDAngleProc_Pitch(&(attitudePIDController->pitchPID),0.0f,attitudePIDController->Pitch,attitudePIDController->gx);
-	PIDAngleProc_Yaw(&(attitudePIDController->yawPID),0.0f,attitudePIDController->gz);
+	//调试输出用二进制日志记录，只在TINYOS_LOG_LEVEL为debug时编译进固件，由日志任务延后格式化
+	tLogDebug("Accel: X=%.2fg Y=%.2fg Z=%.2fg", tLogFloat(attitudePIDController->ax), tLogFloat(attitudePIDController->ay), tLogFloat(attitudePIDController->az));
+	tLogDebug("Gyro: X=%.2fPI Y=%.2fPI Z=%.2fPI", tLogFloat(attitudePIDController->gx), tLogFloat(attitudePIDController->gy), tLogFloat(attitudePIDController->gz));
+	tLogDebug("Roll = %.2f°\tPitch = %.2f°\tYaw = %.2f°", tLogFloat(attitudePIDController->Roll), tLogFloat(attitudePIDController->Pitch), tLogFloat(attitudePIDController->Yaw));
+	{
+		//三轴一起计算：角度设定值为0(水平)，偏航只控制角速度，设定值为0
+		static const float angleRef[PID_AXIS_COUNT] = {0.0f, 0.0f, 0.0f};
+		float angle[PID_AXIS_COUNT];
+		float rate[PID_AXIS_COUNT];
+		angle[PID_AXIS_ROLL] = attitudePIDController->Roll;
+		angle[PID_AXIS_PITCH] = attitudePIDController->Pitch;
+		angle[PID_AXIS_YAW] = attitudePIDController->Yaw;
+		rate[PID_AXIS_ROLL] = attitudePIDController->gx;
+		rate[PID_AXIS_PITCH] = attitudePIDController->gy;
+		rate[PID_AXIS_YAW] = attitudePIDController->gz;
+		PIDAttitude_Calc(&attitudePIDController->attitudePID, angleRef, angle, NULL, rate);
+	}
 
 	// 再打印 rollPID 的内外环数据
-//	printf("外环目标值:%.2f\t外环反馈值:%.2f\t内环目标值:%.2f\t内环反馈值:%.2f\t内环输出值:%.2f\n",
-//			0.0f, attitudePIDController->Roll,
-//			attitudePIDController->rollPID.outer.output,
-//			attitudePIDController->gx,
-//			attitudePIDController->rollPID.inner.output);
+	//一条日志最多4个参数，外环目标值固定为0不再输出
+	tLogDebug("外环反馈值:%.2f\t内环目标值:%.2f\t内环反馈值:%.2f\t内环输出值:%.2f",
+			tLogFloat(attitudePIDController->Roll),
+			tLogFloat(attitudePIDController->attitudePID.angle.output[PID_AXIS_ROLL]),
+			tLogFloat(attitudePIDController->gx),
+			tLogFloat(attitudePIDController->attitudePID.rate.output[PID_AXIS_ROLL]));
 }
 
@@ -2,17 +2,30 @@
 #define __ATTITUDEPIDCONTROLLER_H
 #include "main.h"
 #include "PID.h"
+#include "MPU6050Sampler.h"
+
+// 为1时滚转、俯仰的外环反馈直接由四元数的倾斜误差得出(小角度近似)，控制回路不做欧拉角换算，Yaw不再更新；
+// 为0时按欧拉角反馈，换算用多项式近似的atan2/asin
+#define ATTITUDE_PID_QUAT_ERROR 0
 
 typedef struct _AttitudePIDController {
 	float ax, ay, az, gx, gy, gz; //六个轴的数据
 	float Roll, Pitch, Yaw; //三个角的数据
-	int count;         //用于yaw线性回归矫正的计数器
-	PIDCascade rollPID;
-	PIDCascade pitchPID;
-	PID yawPID;//三个角的pid
+	PIDAttitude attitudePID; //三轴串级pid，roll/pitch/yaw并排计算
 }AttitudePIDController;
 
+// 初始化，并从Flash键值存储恢复保存过的校准参数及PID参数，备份寄存器中有更新的零偏估计时以其为准
 void AttitudePIDController_Init(AttitudePIDController * attitudePIDController);
 
+// 把当前的陀螺仪零偏估计及加速度计校准参数写入Flash键值存储及备份寄存器，如加速度计重新校准后调用；
+// 写Flash期间CPU停顿，只能在电机未解锁时调用
+void AttitudePIDController_SaveCalib(void);
+
+// 把当前的PID参数写入Flash键值存储，下次上电直接使用，调参不需要重新编译；只能在电机未解锁时调用
+void AttitudePIDController_SaveGains(AttitudePIDController * attitudePIDController);
+
 void AttitudePIDController_ProcData(AttitudePIDController * attitudePIDController);
+
+// 处理一个带数据就绪时间戳的样本，按与上一样本的实测间隔积分
+void AttitudePIDController_ProcSample(AttitudePIDController * attitudePIDController, const MPU6050TimedSample * timed);
 #endif
@@ -0,0 +1,197 @@
+#ifndef __ATTITUDEQUAT_H
+#define __ATTITUDEQUAT_H
+
+#include "AttitudeMath.h"
+
+// 四元数及三维向量运算，全部为按值传递、按值返回的内联函数：16字节以内的结构体在调用处展开后，
+// 分量直接留在FPU寄存器中，不经过结果指针写回内存，几个运算连写时中间结果也不落到栈上
+// 四元数按{w, x, y, z}排列，与float[4]的布局相同，可用AttitudeQuat_Load/Store与各后端的数组互换；
+// 旋转约定与各估计器一致：q表示机体系到地理系的旋转，R(q)v把机体系向量转到地理系
+
+typedef struct _AttitudeQuat {
+    float w;
+    float x;
+    float y;
+    float z;
+} AttitudeQuat;
+
+typedef struct _AttitudeVec3 {
+    float x;
+    float y;
+    float z;
+} AttitudeVec3;
+
+//************************** 三维向量 **************************
+
+static __inline AttitudeVec3 AttitudeVec3_Make(float x, float y, float z) {
+    AttitudeVec3 r;
+
+    r.x = x;
+    r.y = y;
+    r.z = z;
+    return r;
+}
+
+static __inline AttitudeVec3 AttitudeVec3_Add(AttitudeVec3 a, AttitudeVec3 b) {
+    return AttitudeVec3_Make(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static __inline AttitudeVec3 AttitudeVec3_Sub(AttitudeVec3 a, AttitudeVec3 b) {
+    return AttitudeVec3_Make(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static __inline AttitudeVec3 AttitudeVec3_Scale(AttitudeVec3 a, float s) {
+    return AttitudeVec3_Make(a.x * s, a.y * s, a.z * s);
+}
+
+// a + b * s，各分量一次乘加
+static __inline AttitudeVec3 AttitudeVec3_MulAdd(AttitudeVec3 a, AttitudeVec3 b, float s) {
+    return AttitudeVec3_Make(b.x * s + a.x, b.y * s + a.y, b.z * s + a.z);
+}
+
+static __inline float AttitudeVec3_Dot(AttitudeVec3 a, AttitudeVec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static __inline AttitudeVec3 AttitudeVec3_Cross(AttitudeVec3 a, AttitudeVec3 b) {
+    return AttitudeVec3_Make(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+static __inline float AttitudeVec3_NormSq(AttitudeVec3 a) {
+    return AttitudeVec3_Dot(a, a);
+}
+
+// 归一化，零向量原样返回
+static __inline AttitudeVec3 AttitudeVec3_Normalize(AttitudeVec3 a) {
+    float n2 = AttitudeVec3_NormSq(a);
+
+    return (n2 > 0.0f) ? AttitudeVec3_Scale(a, AttitudeInvSqrt(n2)) : a;
+}
+
+//************************** 四元数 **************************
+
+static __inline AttitudeQuat AttitudeQuat_Make(float w, float x, float y, float z) {
+    AttitudeQuat r;
+
+    r.w = w;
+    r.x = x;
+    r.y = y;
+    r.z = z;
+    return r;
+}
+
+static __inline AttitudeQuat AttitudeQuat_Identity(void) {
+    return AttitudeQuat_Make(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+static __inline AttitudeQuat AttitudeQuat_Load(const float *q) {
+    return AttitudeQuat_Make(q[0], q[1], q[2], q[3]);
+}
+
+static __inline void AttitudeQuat_Store(float *out, AttitudeQuat q) {
+    out[0] = q.w;
+    out[1] = q.x;
+    out[2] = q.y;
+    out[3] = q.z;
+}
+
+static __inline AttitudeQuat AttitudeQuat_Add(AttitudeQuat a, AttitudeQuat b) {
+    return AttitudeQuat_Make(a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static __inline AttitudeQuat AttitudeQuat_Sub(AttitudeQuat a, AttitudeQuat b) {
+    return AttitudeQuat_Make(a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static __inline AttitudeQuat AttitudeQuat_Scale(AttitudeQuat a, float s) {
+    return AttitudeQuat_Make(a.w * s, a.x * s, a.y * s, a.z * s);
+}
+
+// a + b * s，各分量一次乘加
+static __inline AttitudeQuat AttitudeQuat_MulAdd(AttitudeQuat a, AttitudeQuat b, float s) {
+    return AttitudeQuat_Make(b.w * s + a.w, b.x * s + a.x, b.y * s + a.y, b.z * s + a.z);
+}
+
+static __inline AttitudeQuat AttitudeQuat_Conj(AttitudeQuat a) {
+    return AttitudeQuat_Make(a.w, -a.x, -a.y, -a.z);
+}
+
+static __inline float AttitudeQuat_Dot(AttitudeQuat a, AttitudeQuat b) {
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static __inline float AttitudeQuat_NormSq(AttitudeQuat a) {
+    return AttitudeQuat_Dot(a, a);
+}
+
+static __inline float AttitudeQuat_Norm(AttitudeQuat a) {
+    return ATTITUDE_SQRTF(AttitudeQuat_NormSq(a));
+}
+
+// 归一化，零四元数原样返回
+static __inline AttitudeQuat AttitudeQuat_Normalize(AttitudeQuat a) {
+    float n2 = AttitudeQuat_NormSq(a);
+
+    return (n2 > 0.0f) ? AttitudeQuat_Scale(a, AttitudeInvSqrt(n2)) : a;
+}
+
+// 四元数乘法a ⊗ b
+static __inline AttitudeQuat AttitudeQuat_Mul(AttitudeQuat a, AttitudeQuat b) {
+    return AttitudeQuat_Make(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                             a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+}
+
+// 乘法后归一化，乘积的16个分量乘积与模长在同一组寄存器中完成，用于姿态的合成
+static __inline AttitudeQuat AttitudeQuat_MulNormalize(AttitudeQuat a, AttitudeQuat b) {
+    return AttitudeQuat_Normalize(AttitudeQuat_Mul(a, b));
+}
+
+// q ⊗ [0, v]，四元数对机体系角速度的导数乘2
+static __inline AttitudeQuat AttitudeQuat_MulVec(AttitudeQuat q, AttitudeVec3 v) {
+    return AttitudeQuat_Make(-q.x * v.x - q.y * v.y - q.z * v.z,
+                              q.w * v.x + q.y * v.z - q.z * v.y,
+                              q.w * v.y - q.x * v.z + q.z * v.x,
+                              q.w * v.z + q.x * v.y - q.y * v.x);
+}
+
+// 按机体系小转角v(rad)转动：q ⊗ [1, v / 2]，不归一化，调用方常与其它修正合并后再归一化
+static __inline AttitudeQuat AttitudeQuat_Integrate(AttitudeQuat q, AttitudeVec3 v) {
+    return AttitudeQuat_MulAdd(q, AttitudeQuat_MulVec(q, v), 0.5f);
+}
+
+// 按机体系小转角v转动并归一化
+static __inline AttitudeQuat AttitudeQuat_IntegrateNormalize(AttitudeQuat q, AttitudeVec3 v) {
+    return AttitudeQuat_Normalize(AttitudeQuat_Integrate(q, v));
+}
+
+// 机体系向量转到地理系R(q)v：v + 2w(u × v) + 2u × (u × v)，u为q的向量部分，
+// 两次叉乘共18次乘法，比先构造旋转矩阵或做两次四元数乘法都少，q需为单位四元数
+static __inline AttitudeVec3 AttitudeQuat_Rotate(AttitudeQuat q, AttitudeVec3 v) {
+    AttitudeVec3 u = AttitudeVec3_Make(q.x, q.y, q.z);
+    AttitudeVec3 t = AttitudeVec3_Scale(AttitudeVec3_Cross(u, v), 2.0f);
+
+    return AttitudeVec3_Add(AttitudeVec3_MulAdd(v, t, q.w), AttitudeVec3_Cross(u, t));
+}
+
+// 地理系向量转到机体系R(q)^T v
+static __inline AttitudeVec3 AttitudeQuat_RotateInv(AttitudeQuat q, AttitudeVec3 v) {
+    return AttitudeQuat_Rotate(AttitudeQuat_Conj(q), v);
+}
+
+// 机体系下的重力方向R(q)^T [0 0 1]，即旋转矩阵的第三行，q需为单位四元数
+static __inline AttitudeVec3 AttitudeQuat_Gravity(AttitudeQuat q) {
+    return AttitudeVec3_Make(2.0f * (q.x * q.z - q.w * q.y),
+                             2.0f * (q.w * q.x + q.y * q.z),
+                             q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z);
+}
+
+// 归一化线性插值，由a向b靠拢t(0 ~ 1)；q与-q表示同一姿态，先取与a同侧的b
+static __inline AttitudeQuat AttitudeQuat_Nlerp(AttitudeQuat a, AttitudeQuat b, float t) {
+    float s = (AttitudeQuat_Dot(a, b) < 0.0f) ? -t : t;
+
+    return AttitudeQuat_Normalize(AttitudeQuat_MulAdd(AttitudeQuat_Scale(a, 1.0f - t), b, s));
+}
+
+#endif // __ATTITUDEQUAT_H
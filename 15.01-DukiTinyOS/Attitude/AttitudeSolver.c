@@ -1,39 +1,545 @@
 #include "AttitudeSolver.h"
-#include "MadgWick.h"
-#include <math.h>
-
-#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
-#define RAD_TO_DEG (180.0 / 3.14159265358979323846)
+#include "AttitudeEstimator.h"
+#include "AttitudeMath.h"
+#include "tinyOS.h"
+#include <string.h>
+#if ATTITUDE_MULTIRATE == 1
+#include "Mahony.h"
+#include "GyroPreint.h"
+#include "tSeqLock.h"
+#endif
 // 输出的姿态角（全局变量）
 
+static float solverNominalPeriod = 0.02f; // 标称采样周期(s)
+static uint32_t solverLastStamp;          // 上一样本的时间戳(us)
+static uint8_t solverHasStamp;            // 是否已有上一样本
+static float solverRunTime;               // 未对准时累计的更新时长(s)
+static volatile uint8_t solverValid;      // 姿态有效，由融合任务置位，解锁检查在其它任务中读取
+
+// 派生量按需换算：姿态每变化一次solverGen加1(只由融合任务修改)，欧拉角在代数变化后第一次读取时才换算，
+// 连同换算时的代数缓存，同一代的其余读者直接复制缓存，不再每个周期、每个读者各算一遍反三角函数
+static volatile uint32_t solverGen;
+static uint32_t solverEulerGen = 0xFFFFFFFFu; // 缓存对应的代数，初值与任何代数都不同
+static float solverEuler[3];
+
+// 零偏估计，只由调用更新函数的任务访问
+static float solverBias[3];               // 陀螺仪零偏估计(rad/s)
+static float solverGyroAvg[3];            // 陀螺仪短时均值，用于静止判定
+static float solverStillTime;             // 已持续静止的时间(s)
+static float solverBiasTime;              // 自上次报告以来零偏更新的累计时间(s)
+static uint8_t solverGyroAvgValid;
+
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+static AttitudeTempModel solverTempModel;
+static float solverTempSample;            // 最近一个样本的温度
+static float solverTemp;                  // 平滑后的温度，查表及学习都按该值
+static uint32_t solverTempCount;
+static uint8_t solverTempValid;
+#endif
+
+#if ATTITUDE_MULTIRATE == 1
+// 一个窗口内的数据：陀螺仪逐个样本预积分为旋转向量，加速度计及磁力计累加，交给慢速估计器时取平均
+typedef struct _AttitudeWindow {
+    GyroPreint gyro;
+    float a[3], m[3];
+    float dt;               // 窗口内步长之和
+    uint32_t count;
+} AttitudeWindow;
+
+static MahonyFilter solverFast;
+static float solverFastSnapshot[2][4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch solverFastLatch = {{0}, {solverFastSnapshot[0], solverFastSnapshot[1]}, sizeof(solverFastSnapshot[0])};
+static AttitudeWindow solverWindow;         // 快速路径正在累计的窗口，只由采样任务访问
+static AttitudeWindow solverPending;        // 等待慢速估计器处理的窗口，上一个未处理完时继续累加
+static volatile uint32_t solverSlowSeq;     // 慢速估计器完成的更新次数
+static uint32_t solverBlendSeq;             // 快速路径已合并到的慢速更新次数
+#if TINYOS_ENABLE_JOB == 1
+static tJob solverSlowJob;
+#endif
+
+// 慢速更新：取出待处理的窗口，以平均值及窗口总时长更新ATTITUDE_ESTIMATOR选定的估计器
+static void AttitudeSolver_SlowUpdate(void *arg) {
+    AttitudeWindow w;
+    float rot[3];
+    float scale, rate;
+    uint32_t status = tTaskEnterCritical();
+
+    w = solverPending;
+    solverPending.count = 0;
+    tTaskExitCritical(status);
+
+    if (w.count == 0) {
+        return;
+    }
+    // 窗口的旋转向量除以总时长作为等效角速度，估计器按总时长积分一步即转过整段的角度，含窗口内的圆锥修正
+    GyroPreint_Get(&w.gyro, rot);
+    scale = 1.0f / (float)w.count;
+    rate = 1.0f / w.dt;
+    AttitudeEstimator_Update(rot[0] * rate, rot[1] * rate, rot[2] * rate,
+                             w.a[0] * scale, w.a[1] * scale, w.a[2] * scale,
+                             w.m[0] * scale, w.m[1] * scale, w.m[2] * scale, w.dt);
+    solverSlowSeq++;
+}
+
+// 快速路径：每个样本更新Mahony并合并最近一次慢速更新的结果，窗口满时交给慢速估计器
+static void AttitudeSolver_MultiRateUpdate(float gx, float gy, float gz, float ax, float ay, float az,
+                                           float mx, float my, float mz, float dt) {
+    uint32_t status;
+    uint32_t i;
+
+    Mahony_UpdateIMU(&solverFast, gx, gy, gz, ax, ay, az, dt);
+    if (solverBlendSeq != solverSlowSeq) {
+        float q[4];
+
+        solverBlendSeq = solverSlowSeq;
+        AttitudeEstimator_GetQuaternion(q);
+        Mahony_Blend(&solverFast, q, ATTITUDE_FAST_BLEND);
+    }
+    tSeqLatchWrite(&solverFastLatch, solverFast.q);
+
+    GyroPreint_Push(&solverWindow.gyro, gx, gy, gz, dt);
+    solverWindow.a[0] += ax; solverWindow.a[1] += ay; solverWindow.a[2] += az;
+    solverWindow.m[0] += mx; solverWindow.m[1] += my; solverWindow.m[2] += mz;
+    solverWindow.dt += dt;
+    if (++solverWindow.count < ATTITUDE_SLOW_DIVIDER) {
+        return;
+    }
+
+    status = tTaskEnterCritical();
+    if (solverPending.count == 0) {
+        solverPending = solverWindow;
+    } else {
+        GyroPreint_Append(&solverPending.gyro, &solverWindow.gyro);
+        for (i = 0; i < 3; i++) {
+            solverPending.a[i] += solverWindow.a[i];
+            solverPending.m[i] += solverWindow.m[i];
+        }
+        solverPending.dt += solverWindow.dt;
+        solverPending.count += solverWindow.count;
+    }
+    tTaskExitCritical(status);
+    memset(&solverWindow, 0, sizeof(solverWindow));
+
+#if TINYOS_ENABLE_JOB == 1
+    tJobPost(&solverSlowJob);
+#else
+    AttitudeSolver_SlowUpdate((void *)0);
+#endif
+}
+#endif
+
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+// 平滑后的温度所在的段及段内位置，超出表的范围时取两端
+static uint32_t AttitudeSolver_TempSegment(float *frac) {
+    float pos = (solverTemp - ATTITUDE_TEMP_MIN) * (1.0f / ATTITUDE_TEMP_STEP);
+    uint32_t seg;
+
+    pos = AttitudeClamp(pos, 0.0f, (float)(ATTITUDE_TEMP_POINTS - 1));
+    seg = (uint32_t)pos;
+    if (seg >= ATTITUDE_TEMP_POINTS - 1) {
+        seg = ATTITUDE_TEMP_POINTS - 2;
+    }
+    *frac = pos - (float)seg;
+    return seg;
+}
+
+// 静止时把陀螺仪读数按插值权重计入相邻两个端点：权重未满时为累计平均，满后为指数平均
+static void AttitudeSolver_LearnTemp(const float *g, float dt) {
+    float frac, w[2];
+    uint32_t seg, k, i;
+
+    if (!solverTempValid) {
+        return;
+    }
+    seg = AttitudeSolver_TempSegment(&frac);
+    w[0] = (1.0f - frac) * dt;
+    w[1] = frac * dt;
+    for (k = 0; k < 2; k++) {
+        float *weight = &solverTempModel.weight[seg + k];
+        float alpha;
+
+        if (w[k] <= 0.0f) {
+            continue;
+        }
+        *weight = (*weight + w[k] < ATTITUDE_TEMP_WEIGHT_MAX) ? (*weight + w[k]) : ATTITUDE_TEMP_WEIGHT_MAX;
+        alpha = w[k] / *weight;
+        for (i = 0; i < 3; i++) {
+            solverTempModel.bias[seg + k][i] += alpha * (g[i] - solverTempModel.bias[seg + k][i]);
+        }
+    }
+}
+
+// 按平滑后的温度查表：两个端点都已学到时插值，只有一个学到时取该端点，都没有时返回0
+static uint8_t AttitudeSolver_LookupTemp(float *bias) {
+    float frac;
+    uint32_t seg = AttitudeSolver_TempSegment(&frac);
+    uint8_t lo = solverTempModel.weight[seg] >= ATTITUDE_TEMP_LEARN_TIME;
+    uint8_t hi = solverTempModel.weight[seg + 1] >= ATTITUDE_TEMP_LEARN_TIME;
+    uint32_t i;
+
+    if (!lo && !hi) {
+        return 0;
+    }
+    if (!lo) {
+        frac = 1.0f;
+    } else if (!hi) {
+        frac = 0.0f;
+    }
+    for (i = 0; i < 3; i++) {
+        bias[i] = solverTempModel.bias[seg][i] + frac * (solverTempModel.bias[seg + 1][i] - solverTempModel.bias[seg][i]);
+    }
+    return 1;
+}
+
+void AttitudeSolver_SetTemperature(float temp) {
+    float bias[3];
+
+    solverTempSample = temp;
+    if (++solverTempCount < ATTITUDE_TEMP_DIV) {
+        return;
+    }
+    solverTempCount = 0;
+    solverTemp = solverTempValid ? (solverTemp + ATTITUDE_TEMP_ALPHA * (solverTempSample - solverTemp)) : solverTempSample;
+    solverTempValid = 1;
+
+    // 静止时由在线估计跟踪，不用查表的结果覆盖
+    if ((solverStillTime < ATTITUDE_BIAS_STILL_TIME) && AttitudeSolver_LookupTemp(bias)) {
+        AttitudeSolver_SetGyroBias(bias);
+    }
+}
+
+void AttitudeSolver_GetTempModel(AttitudeTempModel *model) {
+    *model = solverTempModel;
+}
+
+void AttitudeSolver_SetTempModel(const AttitudeTempModel *model) {
+    solverTempModel = *model;
+}
+#endif
+
+#if ATTITUDE_BIAS_ESTIMATE == 1
+/**
+ * @brief 静止检测及零偏估计，每个样本调用一次
+ *
+ * @param g 陀螺仪原始读数(rad/s)
+ * @param ax, ay, az 加速度(g)
+ * @param dt 样本间隔(s)
+ *
+ * @return void
+ */
+static void AttitudeSolver_EstimateBias(const float *g, float ax, float ay, float az, float dt) {
+    float avgAlpha = dt / (ATTITUDE_BIAS_AVG_TAU + dt);
+    float norm2 = ax * ax + ay * ay + az * az;
+    uint8_t still;
+    int i;
+
+    if (!solverGyroAvgValid) {
+        for (i = 0; i < 3; i++) {
+            solverGyroAvg[i] = g[i];
+        }
+        solverGyroAvgValid = 1;
+    }
+
+    // 模长比较按平方进行：|a|^2 - 1 ≈ 2(|a| - 1)，省去开方
+    still = ((norm2 - 1.0f) < 2.0f * ATTITUDE_BIAS_ACCEL_TOL) && ((norm2 - 1.0f) > -2.0f * ATTITUDE_BIAS_ACCEL_TOL);
+    for (i = 0; i < 3; i++) {
+        float dev = g[i] - solverGyroAvg[i];
+
+        if ((dev > ATTITUDE_BIAS_GYRO_TOL) || (dev < -ATTITUDE_BIAS_GYRO_TOL)) {
+            still = 0;
+        }
+        solverGyroAvg[i] += avgAlpha * dev;
+    }
+
+    if (!still) {
+        solverStillTime = 0.0f;
+        return;
+    }
+    if (solverStillTime < ATTITUDE_BIAS_STILL_TIME) {
+        solverStillTime += dt;
+        return;
+    }
+
+    for (i = 0; i < 3; i++) {
+        solverBias[i] = AttitudeClamp(solverBias[i] + (dt / ATTITUDE_BIAS_TAU) * (g[i] - solverBias[i]), -ATTITUDE_BIAS_LIMIT, ATTITUDE_BIAS_LIMIT);
+    }
+    solverBiasTime += dt;
+#if ATTITUDE_TEMP_COMP == 1
+    AttitudeSolver_LearnTemp(g, dt);
+#endif
+}
+#endif
+
+// 姿态已改变，之后读取的派生量需重新换算；在每个改变估计器状态的公开函数末尾调用
+static void AttitudeSolver_Changed(void) {
+    solverGen++;
+}
 
 // 初始化函数
 void AttitudeSolver_Init(float sample_frequency, float gain) {
-    beta = gain;                 // 设置 Madgwick 算法增益
-    q0 = 1.0f; q1 = 0.0f;        // 初始化四元数
-    q2 = 0.0f; q3 = 0.0f;
+    if (sample_frequency > 0.0f) {
+        solverNominalPeriod = 1.0f / sample_frequency;
+    }
+    solverHasStamp = 0;
+    solverRunTime = 0.0f;
+    solverValid = 0;
+    solverGyroAvgValid = 0;
+    solverStillTime = 0.0f;
+    solverBiasTime = 0.0f;
+    AttitudeEstimator_Init(gain); // 复位ATTITUDE_ESTIMATOR选定的估计器，gain的含义随后端而定
+#if ATTITUDE_MULTIRATE == 1
+    Mahony_Init(&solverFast, ATTITUDE_FAST_KP, 0.0f);
+    tSeqLatchWrite(&solverFastLatch, solverFast.q);
+    memset(&solverWindow, 0, sizeof(solverWindow));
+    memset(&solverPending, 0, sizeof(solverPending));
+    solverBlendSeq = solverSlowSeq;
+#if TINYOS_ENABLE_JOB == 1
+    tJobInit(&solverSlowJob, AttitudeSolver_SlowUpdate, (void *)0, ATTITUDE_SLOW_JOB_PRIO);
+#endif
+#endif
+    AttitudeSolver_Changed();
+}
+
+// 由数据就绪时间戳求样本间隔，差值按32位无符号计算，计时回绕不影响结果
+float AttitudeSolver_SampleInterval(uint32_t timestamp) {
+    float dt = solverNominalPeriod;
+
+    if (solverHasStamp) {
+        uint32_t diff = timestamp - solverLastStamp;
+        if ((diff != 0) && (diff <= (uint32_t)(ATTITUDE_DT_MAX * 1000000.0f))) {
+            dt = (float)diff * 1e-6f;
+        }
+    }
+    solverLastStamp = timestamp;
+    solverHasStamp = 1;
+    return dt;
+}
+
+// 步长不合理(非正数或过大)时退回标称周期，避免一次积分把姿态拉飞
+static float AttitudeSolver_CheckInterval(float dt) {
+    if (!(dt > 0.0f) || (dt > ATTITUDE_DT_MAX)) {
+        return solverNominalPeriod;
+    }
+    return dt;
+}
+
+// 未对准时累计更新时长，满ATTITUDE_CONVERGE_TIME后认为估计器已从单位四元数收敛
+static void AttitudeSolver_Converge(float dt) {
+    if (solverValid) {
+        return;
+    }
+    solverRunTime += dt;
+    if (solverRunTime >= ATTITUDE_CONVERGE_TIME) {
+        solverValid = 1;
+    }
+}
+
+/**
+ * @brief 由静止时的重力方向(及磁场)闭式求出姿态，作为估计器的初始值
+ *
+ * 滚转、俯仰与Complementary.c由重力方向换算的方式相同：roll = atan2(ay, az)，pitch = atan2(-ax, sqrt(ay^2 + az^2))；
+ * 偏航由磁场按滚转、俯仰旋回水平面后的分量求出，yaw = atan2(-my', mx')，四元数按ZYX顺序合成
+ *
+ * @param accel 平均的加速度(g)
+ * @param mag 磁力计读数，为0时偏航取0
+ *
+ * @return uint8_t 0：成功，1：加速度模长超出ATTITUDE_ALIGN_ACCEL_TOL
+ */
+uint8_t AttitudeSolver_Align(const float *accel, const float *mag) {
+    float norm2 = accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2];
+    float roll, pitch, yaw = 0.0f;
+    float cr, sr, cp, sp, cy, sy;
+    float q[4];
+
+    // 模长比较按平方进行，同静止检测
+    if (((norm2 - 1.0f) > 2.0f * ATTITUDE_ALIGN_ACCEL_TOL) || ((norm2 - 1.0f) < -2.0f * ATTITUDE_ALIGN_ACCEL_TOL)) {
+        return 1;
+    }
+    roll = AttitudeAtan2(accel[1], accel[2]);
+    pitch = AttitudeAtan2(-accel[0], ATTITUDE_SQRTF(accel[1] * accel[1] + accel[2] * accel[2]));
+    cr = cosf(roll); sr = sinf(roll);
+    cp = cosf(pitch); sp = sinf(pitch);
+    if (mag != (const float *)0) {
+        float hx = mag[0] * cp + (mag[1] * sr + mag[2] * cr) * sp;
+        float hy = mag[1] * cr - mag[2] * sr;
+        yaw = AttitudeAtan2(-hy, hx);
+    }
+
+    cr = cosf(0.5f * roll); sr = sinf(0.5f * roll);
+    cp = cosf(0.5f * pitch); sp = sinf(0.5f * pitch);
+    cy = cosf(0.5f * yaw); sy = sinf(0.5f * yaw);
+    q[0] = cr * cp * cy + sr * sp * sy;
+    q[1] = sr * cp * cy - cr * sp * sy;
+    q[2] = cr * sp * cy + sr * cp * sy;
+    q[3] = cr * cp * sy - sr * sp * cy;
+
+    AttitudeEstimator_SetQuaternion(q);
+#if ATTITUDE_MULTIRATE == 1
+    {
+        int i;
+        for (i = 0; i < 4; i++) {
+            solverFast.q[i] = q[i];
+        }
+        tSeqLatchWrite(&solverFastLatch, solverFast.q);
+    }
+#endif
+    solverValid = 1;
+    AttitudeSolver_Changed();
+    return 0;
+}
+
+uint8_t AttitudeSolver_IsValid(void) {
+    return solverValid;
+}
+
+// 使用加速度计和陀螺仪更新姿态，陀螺仪读数先扣除零偏估计
+void AttitudeSolver_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    dt = AttitudeSolver_CheckInterval(dt);
+    AttitudeSolver_Converge(dt);
+#if ATTITUDE_BIAS_ESTIMATE == 1
+    {
+        float g[3];
+
+        g[0] = gx; g[1] = gy; g[2] = gz;
+        AttitudeSolver_EstimateBias(g, ax, ay, az, dt);
+    }
+#endif
+    gx -= solverBias[0];
+    gy -= solverBias[1];
+    gz -= solverBias[2];
+#if ATTITUDE_MULTIRATE == 1
+    AttitudeSolver_MultiRateUpdate(gx, gy, gz, ax, ay, az, 0.0f, 0.0f, 0.0f, dt);
+#else
+    AttitudeEstimator_UpdateIMU(gx, gy, gz, ax, ay, az, dt);
+#endif
+    AttitudeSolver_Changed();
+}
+
+// 批量更新姿态，各样本先扣除零偏估计，每ATTITUDE_BATCH_MAX个样本交给估计器一次
+void AttitudeSolver_UpdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt) {
+#if ATTITUDE_MULTIRATE == 1
+    uint32_t i;
+
+    // 快速路径的Mahony每个样本都要与慢速结果合并，逐个更新
+    for (i = 0; i < count; i++, gyro += 3) {
+        AttitudeSolver_UpdateIMU(gyro[0], gyro[1], gyro[2], ax, ay, az, dt);
+    }
+#else
+    float batch[ATTITUDE_BATCH_MAX][3];
+    uint32_t n = 0;
+    uint32_t i, j;
+
+    dt = AttitudeSolver_CheckInterval(dt);
+    AttitudeSolver_Converge(dt * (float)count);
+    for (i = 0; i < count; i++, gyro += 3) {
+#if ATTITUDE_BIAS_ESTIMATE == 1
+        AttitudeSolver_EstimateBias(gyro, ax, ay, az, dt);
+#endif
+        for (j = 0; j < 3; j++) {
+            batch[n][j] = gyro[j] - solverBias[j];
+        }
+        if (++n == ATTITUDE_BATCH_MAX) {
+            AttitudeEstimator_UpdateIMUBatch(batch[0], n, ax, ay, az, dt);
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        AttitudeEstimator_UpdateIMUBatch(batch[0], n, ax, ay, az, dt);
+    }
+    AttitudeSolver_Changed();
+#endif
 }
 
-// 使用加速度计和陀螺仪更新姿态
-void AttitudeSolver_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az) {
-    MadgwickAHRSupdateIMU(gx, gy, gz, ax, ay, az);
+// 使用加速度计、陀螺仪和磁力计更新姿态，陀螺仪读数先扣除零偏估计
+void AttitudeSolver_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    dt = AttitudeSolver_CheckInterval(dt);
+    AttitudeSolver_Converge(dt);
+#if ATTITUDE_BIAS_ESTIMATE == 1
+    {
+        float g[3];
+
+        g[0] = gx; g[1] = gy; g[2] = gz;
+        AttitudeSolver_EstimateBias(g, ax, ay, az, dt);
+    }
+#endif
+    gx -= solverBias[0];
+    gy -= solverBias[1];
+    gz -= solverBias[2];
+#if ATTITUDE_MULTIRATE == 1
+    AttitudeSolver_MultiRateUpdate(gx, gy, gz, ax, ay, az, mx, my, mz, dt);
+#else
+    AttitudeEstimator_Update(gx, gy, gz, ax, ay, az, mx, my, mz, dt);
+#endif
+    AttitudeSolver_Changed();
 }
 
-// 使用加速度计、陀螺仪和磁力计更新姿态
-void AttitudeSolver_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz) {
-    MadgwickAHRSupdate(gx, gy, gz, ax, ay, az, mx, my, mz);
+// 读取陀螺仪零偏估计
+void AttitudeSolver_GetGyroBias(float *bias) {
+    bias[0] = solverBias[0];
+    bias[1] = solverBias[1];
+    bias[2] = solverBias[2];
 }
 
-// 获取姿态角（欧拉角形式,单位为rad）
-void AttitudeSolver_GetEulerAngles(float *roll, float *pitch, float *yaw, int *count) {
-    *roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD_TO_DEG;  // 转换为角度
-    *pitch = asinf(2.0f * (q0 * q2 - q3 * q1)) * RAD_TO_DEG;
-    *yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * RAD_TO_DEG;
-		*yaw = *yaw - (K * (*count) + B); // 线性回归矫正
-	  *count = *count + 1;
+// 设置陀螺仪零偏估计，如上电时恢复保存过的值，之后继续在线更新
+void AttitudeSolver_SetGyroBias(const float *bias) {
+    solverBias[0] = bias[0];
+    solverBias[1] = bias[1];
+    solverBias[2] = bias[2];
+}
+
+// 累计更新满ATTITUDE_BIAS_SAVE_TIME时报告一次，调用者据此保存，避免每个样本都写存储
+uint8_t AttitudeSolver_TakeGyroBias(float *bias) {
+    if (solverBiasTime < ATTITUDE_BIAS_SAVE_TIME) {
+        return 0;
+    }
+    solverBiasTime = 0.0f;
+    AttitudeSolver_GetGyroBias(bias);
+    return 1;
+}
+
+// 获取姿态四元数快照
+void AttitudeSolver_GetQuaternion(float *q) {
+#if ATTITUDE_MULTIRATE == 1
+    tSeqLatchRead(&solverFastLatch, q);
+#else
+    AttitudeEstimator_GetQuaternion(q);
+#endif
+}
+
+uint32_t AttitudeSolver_GetGeneration(void) {
+    return solverGen;
+}
+
+// 获取姿态角（欧拉角形式,单位为°），陀螺仪零偏已在融合前扣除，yaw不再需要额外矫正
+// 代数在读取四元数之前取得，缓存的角度不会比其代数旧；两个读者同时换算时后写入的覆盖先写入的，至多多算一次
+void AttitudeSolver_GetEulerAngles(float *roll, float *pitch, float *yaw) {
+    float q[4], e[3];
+    uint32_t gen = solverGen;
+    uint32_t status = tTaskEnterCritical();
+
+    if (solverEulerGen == gen) {
+        *roll = solverEuler[0];
+        *pitch = solverEuler[1];
+        *yaw = solverEuler[2];
+        tTaskExitCritical(status);
+        return;
+    }
+    tTaskExitCritical(status);
+
+    AttitudeSolver_GetQuaternion(q); // 一致的四元数快照
+    AttitudeEstimator_QuaternionToEuler(q, &e[0], &e[1], &e[2]);
+    status = tTaskEnterCritical();
+    solverEuler[0] = e[0];
+    solverEuler[1] = e[1];
+    solverEuler[2] = e[2];
+    solverEulerGen = gen;
+    tTaskExitCritical(status);
+    *roll = e[0];
+    *pitch = e[1];
+    *yaw = e[2];
 	  
 	  //转换回来
-//		*roll *= DEG_TO_RAD;
-//	  *pitch *= DEG_TO_RAD;
-//	  *yaw *= DEG_TO_RAD;
+//		*roll *= ATTITUDE_DEG_TO_RAD;
+//	  *pitch *= ATTITUDE_DEG_TO_RAD;
+//	  *yaw *= ATTITUDE_DEG_TO_RAD;
 }
@@ -3,23 +3,108 @@
 
 #include <stdint.h>
 
-//Yaw值线性回归矫正
-#define K -0.00023825
-#define B -0.00448912
+// 积分步长：每个样本按与上一样本数据就绪时间戳之差积分，不再假定固定的采样频率；
+// 第一个样本、时间戳倒退或间隔超过ATTITUDE_DT_MAX(采样中断过)时，按初始化给出的标称周期积分
+#define ATTITUDE_DT_MAX 0.1f // 积分步长上限(s)
+#define ATTITUDE_BATCH_MAX 16 // 批量更新每次交给估计器的样本数上限，更多的样本分几次更新
+
+// 多速率融合：每个样本只跑一次开销很小的Mahony快速路径，PID读到的姿态始终是最新的；
+// ATTITUDE_ESTIMATOR选定的估计器(Madgwick/EKF等)每ATTITUDE_SLOW_DIVIDER个样本更新一次，陀螺仪为窗口内
+// 带圆锥修正的预积分(GyroPreint)换算的等效角速度，加速度计及磁力计为窗口内的平均值，
+// 结果以ATTITUDE_FAST_BLEND的权重拉回快速路径，抵消其漂移；开启TINYOS_ENABLE_JOB时慢速更新作为作业
+// 在低于控制回路的优先级上运行，不占用采样任务的时间，否则在采样任务中内联执行
+#define ATTITUDE_MULTIRATE      0
+#define ATTITUDE_SLOW_DIVIDER   8                       // 慢速估计器的分频数，如2kHz采样时为250Hz
+#define ATTITUDE_FAST_KP        0.2f                    // 快速路径的比例增益，主要修正由慢速估计器完成
+#define ATTITUDE_FAST_BLEND     0.2f                    // 每次慢速更新后快速路径向其结果靠拢的权重
+#define ATTITUDE_SLOW_JOB_PRIO  (TINYOS_PRIO_COUNT - 4) // 慢速更新作业的优先级，低于控制回路，高于遥测
+
+// 上电对准：静止时由平均的加速度闭式求出滚转、俯仰(有磁力计时再由倾斜补偿后的水平分量求出偏航)，直接作为估计器的
+// 初始姿态，不必等估计器从单位四元数收敛(beta为0.8时需要数秒)；加速度模长偏离1g超过ATTITUDE_ALIGN_ACCEL_TOL时
+// 视为有运动，不对准，估计器从单位四元数开始，更新累计满ATTITUDE_CONVERGE_TIME后才认为姿态有效
+#define ATTITUDE_ALIGN_ACCEL_TOL    0.05f   // 对准时加速度模长与1g之差的上限(g)
+#define ATTITUDE_CONVERGE_TIME      3.0f    // 未对准时估计器从单位四元数收敛所需的更新时长(s)
+
+// 陀螺仪零偏在线估计：静止时(陀螺仪各轴与其短时均值之差、加速度模长与1g之差都在容限内，且持续
+// ATTITUDE_BIAS_STILL_TIME)以时间常数ATTITUDE_BIAS_TAU把零偏估计拉向陀螺仪读数，估计值在送入估计器前扣除；
+// 重力量测观测不到偏航方向的零偏，静止检测则对三轴都有效，取代按机架标定的偏航线性回归及固定零偏
+#define ATTITUDE_BIAS_ESTIMATE      1
+#define ATTITUDE_BIAS_GYRO_TOL      0.02f   // 静止判定：陀螺仪与短时均值之差(rad/s)
+#define ATTITUDE_BIAS_ACCEL_TOL     0.03f   // 静止判定：加速度模长与1g之差(g)
+#define ATTITUDE_BIAS_AVG_TAU       0.1f    // 短时均值的时间常数(s)
+#define ATTITUDE_BIAS_STILL_TIME    0.5f    // 持续静止多久后开始更新零偏(s)
+#define ATTITUDE_BIAS_TAU           5.0f    // 零偏估计的时间常数(s)
+#define ATTITUDE_BIAS_LIMIT         0.35f   // 零偏估计的上限(rad/s)，MPU6050的零偏规格为±20°/s
+#define ATTITUDE_BIAS_SAVE_TIME     10.0f   // 累计更新多久后报告一次新估计，供保存(s)
+
+// 零偏的温度模型：按温度分段的零偏表，各段端点之间线性插值。静止时的陀螺仪读数按插值权重计入相邻两个端点，
+// 暖机期间温度上升，静止的这段时间即可学到工作温度范围内的各点；运动时无法做静止检测，零偏改为按当前温度查表，
+// 飞行中IMU随电机发热升温时零偏随之跟踪。温度取自每个样本的14字节连续读取，不另外访问总线，
+// 每ATTITUDE_TEMP_DIV个样本平滑一次并重新查表，其余样本只记下温度；表经Flash键值存储保存，上电时恢复。
+// 需开启ATTITUDE_BIAS_ESTIMATE
+#define ATTITUDE_TEMP_COMP          0
+#define ATTITUDE_TEMP_MIN           0.0f    // 第一个端点的温度(°C)
+#define ATTITUDE_TEMP_STEP          10.0f   // 端点间隔(°C)
+#define ATTITUDE_TEMP_POINTS        7       // 端点数，覆盖0 ~ 60°C；表的大小不能超过FLASHKV_MAX_VALUE
+#define ATTITUDE_TEMP_DIV           50      // 温度平滑及查表的分频
+#define ATTITUDE_TEMP_ALPHA         0.1f    // 每次查表前温度的一阶平滑系数
+#define ATTITUDE_TEMP_LEARN_TIME    2.0f    // 端点累计的静止时间达到该值后才用于查表(s)
+#define ATTITUDE_TEMP_WEIGHT_MAX    30.0f   // 端点权重的上限(s)，之后按该时间常数跟踪零偏的缓慢变化
+
+// 温度模型，按端点保存三轴零偏及累计的静止时间
+typedef struct _AttitudeTempModel {
+    float bias[ATTITUDE_TEMP_POINTS][3];    // 零偏(rad/s)
+    float weight[ATTITUDE_TEMP_POINTS];     // 计入该端点的静止时间(s)，按插值权重累计
+} AttitudeTempModel;
 
 // 输出的姿态角（全局变量）
 extern volatile float Roll, Pitch, Yaw;
 
-// 初始化函数
+// 初始化函数，sample_frequency为标称采样频率，只用于得不到实测间隔的样本
 void AttitudeSolver_Init(float sample_frequency, float gain);
 
-// 使用加速度计和陀螺仪进行更新
-void AttitudeSolver_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az);
+// 由样本的数据就绪时间戳(us，tTimeGetMicros的低32位)求出与上一样本的间隔(s)，每个样本调用一次
+float AttitudeSolver_SampleInterval(uint32_t timestamp);
+
+// 使用加速度计和陀螺仪进行更新，dt为实测的样本间隔(s)
+void AttitudeSolver_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+// 批量更新：count个陀螺仪样本{gx, gy, gz}依次排列，ax ~ az为整批的加速度(如均值)，dt为每个样本的间隔(s)；
+// 零偏估计仍逐个样本进行，Madgwick后端在寄存器中连续积分、每批做一次加速度计修正
+void AttitudeSolver_UpdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt);
+
+// 使用加速度计、陀螺仪和磁力计进行更新，dt为实测的样本间隔(s)
+void AttitudeSolver_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt);
+
+// 上电对准：accel为静止时平均的加速度(g)，mag为磁力计读数(任意单位)，为0时偏航取0；
+// 成功返回0并使姿态立即有效，加速度模长超出容限返回1，姿态不变；在更新函数之前、同一任务中调用
+uint8_t AttitudeSolver_Align(const float *accel, const float *mag);
+
+// 姿态是否有效：已对准，或未对准但更新累计满ATTITUDE_CONVERGE_TIME；解锁前检查，可在其它任务中读取
+uint8_t AttitudeSolver_IsValid(void);
+
+// 获取姿态四元数{w, x, y, z}，多速率融合时为快速路径的结果
+void AttitudeSolver_GetQuaternion(float *q);
+
+// 姿态的代数，每次更新、对准或初始化后加1；读者可据此判断是否有新姿态，不必复制四元数比较
+uint32_t AttitudeSolver_GetGeneration(void);
+
+// 获取姿态角(°)，每代只在第一次读取时由四元数换算，其余读者共用缓存
+void AttitudeSolver_GetEulerAngles(float *roll, float *pitch, float *yaw);
+
+// 读取/设置陀螺仪零偏估计(rad/s)，设置用于上电时恢复保存过的估计；与更新函数在同一任务中调用
+void AttitudeSolver_GetGyroBias(float *bias);
+void AttitudeSolver_SetGyroBias(const float *bias);
 
-// 使用加速度计、陀螺仪和磁力计进行更新
-void AttitudeSolver_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz);
+// 零偏估计自上次报告以来累计更新满ATTITUDE_BIAS_SAVE_TIME时返回1并读出估计值，否则返回0
+uint8_t AttitudeSolver_TakeGyroBias(float *bias);
 
-// 获取姿态角
-void AttitudeSolver_GetEulerAngles(float *roll, float *pitch, float *yaw, int *count);
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+// 记下样本的温度(°C)，在更新函数之前每个样本调用一次，每ATTITUDE_TEMP_DIV次才平滑并查表
+void AttitudeSolver_SetTemperature(float temp);
+// 读取/设置温度模型，用于保存及上电恢复；与更新函数在同一任务中调用
+void AttitudeSolver_GetTempModel(AttitudeTempModel *model);
+void AttitudeSolver_SetTempModel(const AttitudeTempModel *model);
+#endif
 
 #endif // ATTITUDE_SOLVER_H
@@ -0,0 +1,462 @@
+#include "Blackbox.h"
+#include "tinyOS.h"
+
+#if BLACKBOX_ENABLE == 1
+
+#if (TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_MEMBLOCK == 0) || (TINYOS_ENABLE_QUEUE == 0) || (TINYOS_ENABLE_RINGBUF == 0)
+#error "BLACKBOX_ENABLE requires TINYOS_ENABLE_SEM, MEMBLOCK, QUEUE and RINGBUF"
+#endif
+
+#include <stdio.h>
+#include "AttitudeMath.h"
+#include "SpiFlash.h"
+#include "DeltaCodec.h"
+
+// 选中的字段数，原始帧为时间戳加上各字段，均为32位
+#define BLACKBOX_COUNT(group, n)    (((BLACKBOX_FIELDS) & (group)) ? (n) : 0)
+#define BLACKBOX_FIELD_COUNT        (BLACKBOX_COUNT(BLACKBOX_FIELD_GYRO, 3) + BLACKBOX_COUNT(BLACKBOX_FIELD_ACCEL, 3) + \
+                                     BLACKBOX_COUNT(BLACKBOX_FIELD_ATTITUDE, 3) + BLACKBOX_COUNT(BLACKBOX_FIELD_PID, 6) + \
+                                     BLACKBOX_COUNT(BLACKBOX_FIELD_MOTOR, 4) + BLACKBOX_COUNT(BLACKBOX_FIELD_RC, 4) + \
+                                     BLACKBOX_COUNT(BLACKBOX_FIELD_BATTERY, 2))
+#define BLACKBOX_RAW_SIZE           ((1 + BLACKBOX_FIELD_COUNT) * 4)
+
+#if BLACKBOX_FIELD_COUNT > DELTA_CODEC_MAX_CHANNELS
+#error "too many blackbox fields for DELTA_CODEC_MAX_CHANNELS"
+#endif
+
+#if BLACKBOX_RAW_SIZE > BLACKBOX_RING_SIZE
+#error "BLACKBOX_RING_SIZE must hold at least one frame"
+#endif
+
+// 编码任务的请求
+#define BLACKBOX_REQ_START          (1 << 0)
+#define BLACKBOX_REQ_STOP           (1 << 1)
+
+// 该页是一段新日志的第一页，写入任务从下一个扇区开始写
+#define BLACKBOX_PAGE_NEW_LOG       (1 << 0)
+
+// Betaflight日志格式中的帧类型、预测器及编码
+#define BLACKBOX_FRAME_I            'I'
+#define BLACKBOX_FRAME_P            'P'
+#define BLACKBOX_FRAME_EVENT        'E'
+#define BLACKBOX_EVENT_LOG_END      255
+#define BLACKBOX_PREDICT_0          0   // 原值
+#define BLACKBOX_PREDICT_PREVIOUS   1   // 相对上一帧
+#define BLACKBOX_PREDICT_INC        6   // 上一帧加1，不写入数据
+#define BLACKBOX_ENCODING_SVB       0   // 有符号变长整数(zigzag)
+#define BLACKBOX_ENCODING_UVB       1   // 无符号变长整数
+#define BLACKBOX_ENCODING_NULL      9   // 不写入
+
+// 写入任务收到的一页
+typedef struct _BlackboxPage {
+    uint8_t *data;
+    uint16_t len;
+    uint16_t flags;
+} BlackboxPage;
+
+// 字段组的名称，顺序与Blackbox_Log中的打包顺序一致
+typedef struct _BlackboxGroup {
+    uint32_t group;
+    const char *name;
+    uint32_t count;
+} BlackboxGroup;
+
+static const BlackboxGroup blackboxGroups[] = {
+    {BLACKBOX_FIELD_GYRO,       "gyroADC",      3},
+    {BLACKBOX_FIELD_ACCEL,      "accSmooth",    3},
+    {BLACKBOX_FIELD_ATTITUDE,   "attitude",     3},
+    {BLACKBOX_FIELD_PID,        "axisSum",      3},
+    {BLACKBOX_FIELD_PID,        "axisI",        3},
+    {BLACKBOX_FIELD_MOTOR,      "motor",        4},
+    {BLACKBOX_FIELD_RC,         "rcCommand",    4},
+    {BLACKBOX_FIELD_BATTERY,    "vbatLatest",   1},
+    {BLACKBOX_FIELD_BATTERY,    "amperageLatest", 1},
+};
+
+static tTask blackboxEncoderTask;
+static tTask blackboxWriterTask;
+static tTaskStack blackboxEncoderStack[BLACKBOX_STACK_SIZE];
+static tTaskStack blackboxWriterStack[BLACKBOX_STACK_SIZE];
+
+// 控制回路写入、编码任务取出的原始帧
+static tRingBuf blackboxRing;
+static uint8_t blackboxRingBuf[BLACKBOX_RING_SIZE];
+
+// 页池及待写入的页，队列容量等于页数，发送时不会阻塞
+static tMemBlock blackboxPagePool;
+static uint32_t blackboxPageMem[BLACKBOX_PAGE_COUNT][SPIFLASH_PAGE_SIZE / 4];
+static tQueue blackboxPageQueue;
+static BlackboxPage blackboxPageQueueBuf[BLACKBOX_PAGE_COUNT];
+
+static volatile uint8_t blackboxRunning;    // 控制回路是否写入原始帧
+static volatile uint8_t blackboxRequest;
+static uint32_t blackboxDivCount;
+
+// 编码任务的状态
+static uint8_t *blackboxPage;               // 正在填写的页
+static uint32_t blackboxPageLen;
+static uint16_t blackboxPageFlags;
+static uint32_t blackboxIteration;
+static uint32_t blackboxPrevTime;
+static DeltaCodec blackboxCodec;            // 各字段相对上一帧的差分，I帧前复位，即记录原值
+
+static BlackboxStat blackboxStat;
+
+// 四舍五入为整数
+static int32_t Blackbox_Round(float v)
+{
+    return (int32_t)(v + ((v < 0.0f) ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief 控制回路每个周期调用一次，每BLACKBOX_RATE_DIV次把选中的字段换算为整数，整帧写入环形缓冲区
+ *
+ * 只有换算及复制，不等待；缓冲区放不下整帧时丢弃并计数，已写入部分帧的情况不会出现。
+ *
+ * @param frame 本周期的数据
+ *
+ * @return void
+ */
+void Blackbox_Log(const BlackboxFrame *frame)
+{
+    int32_t raw[1 + BLACKBOX_FIELD_COUNT];
+    uint32_t n = 1;
+    int i;
+
+    if (!blackboxRunning || (++blackboxDivCount < BLACKBOX_RATE_DIV)) {
+        return;
+    }
+    blackboxDivCount = 0;
+
+    raw[0] = (int32_t)frame->timeUs;
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_GYRO
+    for (i = 0; i < 3; i++) {
+        raw[n++] = Blackbox_Round(frame->gyro[i] * (ATTITUDE_RAD_TO_DEG * 10.0f));
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_ACCEL
+    for (i = 0; i < 3; i++) {
+        raw[n++] = Blackbox_Round(frame->accel[i] * 1000.0f);
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_ATTITUDE
+    for (i = 0; i < 3; i++) {
+        raw[n++] = Blackbox_Round(frame->attitude[i] * 10.0f);
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_PID
+    for (i = 0; i < 3; i++) {
+        raw[n++] = Blackbox_Round(frame->pidOutput[i] * 10.0f);
+    }
+    for (i = 0; i < 3; i++) {
+        raw[n++] = Blackbox_Round(frame->pidIntegral[i] * 10.0f);
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_MOTOR
+    for (i = 0; i < 4; i++) {
+        raw[n++] = Blackbox_Round(frame->motor[i] * 1000.0f) + 1000;
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_RC
+    for (i = 0; i < 4; i++) {
+        raw[n++] = frame->rc[i];
+    }
+#endif
+#if BLACKBOX_FIELDS & BLACKBOX_FIELD_BATTERY
+    raw[n++] = Blackbox_Round(frame->vbat * 100.0f);
+    raw[n++] = Blackbox_Round(frame->current * 100.0f);
+#endif
+    (void)i;
+
+    if (tRingBufFree(&blackboxRing) < BLACKBOX_RAW_SIZE) {
+        blackboxStat.dropped++;
+        return;
+    }
+    tRingBufPut(&blackboxRing, (const uint8_t *)raw, BLACKBOX_RAW_SIZE);
+}
+
+// 写满的页交给写入任务
+static void Blackbox_SendPage(void)
+{
+    BlackboxPage page;
+
+    if (blackboxPage == (uint8_t *)0) {
+        return;
+    }
+    page.data = blackboxPage;
+    page.len = (uint16_t)blackboxPageLen;
+    page.flags = blackboxPageFlags;
+    tQueueSend(&blackboxPageQueue, &page, 0);
+    blackboxPage = (uint8_t *)0;
+    blackboxPageLen = 0;
+    blackboxPageFlags = 0;
+}
+
+// 编码输出一个字节，页池空时等待写入任务归还
+static void Blackbox_PutByte(uint8_t value)
+{
+    if (blackboxPage == (uint8_t *)0) {
+        tMemBlockWait(&blackboxPagePool, &blackboxPage, 0);
+        blackboxPageLen = 0;
+    }
+    blackboxPage[blackboxPageLen++] = value;
+    if (blackboxPageLen == SPIFLASH_PAGE_SIZE) {
+        Blackbox_SendPage();
+    }
+}
+
+static void Blackbox_PutBytes(const uint8_t *data, uint32_t len)
+{
+    while (len--) {
+        Blackbox_PutByte(*data++);
+    }
+}
+
+static void Blackbox_PutString(const char *s)
+{
+    while (*s) {
+        Blackbox_PutByte((uint8_t)*s++);
+    }
+}
+
+// 输出一行字段属性：前两个为loopIteration及time，其余字段都为rest
+static void Blackbox_PutFieldLine(const char *key, int iteration, int time, int rest)
+{
+    char buf[8];
+    int i;
+
+    Blackbox_PutString("H Field ");
+    Blackbox_PutString(key);
+    snprintf(buf, sizeof(buf), ":%d,%d", iteration, time);
+    Blackbox_PutString(buf);
+    snprintf(buf, sizeof(buf), ",%d", rest);
+    for (i = 0; i < BLACKBOX_FIELD_COUNT; i++) {
+        Blackbox_PutString(buf);
+    }
+    Blackbox_PutByte('\n');
+}
+
+// 文件头：Blackbox Explorer按其中的字段名、预测器及编码解析数据帧
+static void Blackbox_WriteHeader(void)
+{
+    char buf[24];
+    uint32_t g, k;
+
+    blackboxPageFlags = BLACKBOX_PAGE_NEW_LOG;
+    Blackbox_PutString("H Product:Blackbox flight data recorder by Nicholas Sherlock\n");
+    Blackbox_PutString("H Data version:2\n");
+    snprintf(buf, sizeof(buf), "H I interval:%d\n", BLACKBOX_I_INTERVAL);
+    Blackbox_PutString(buf);
+    Blackbox_PutString("H P interval:1/1\n");
+    Blackbox_PutString("H Firmware type:Cleanflight\n");
+    Blackbox_PutString("H Firmware revision:DukiTinyOS\n");
+    Blackbox_PutString("H minthrottle:1000\n");
+    Blackbox_PutString("H maxthrottle:2000\n");
+
+    Blackbox_PutString("H Field I name:loopIteration,time");
+    for (g = 0; g < sizeof(blackboxGroups) / sizeof(blackboxGroups[0]); g++) {
+        if (!(BLACKBOX_FIELDS & blackboxGroups[g].group)) {
+            continue;
+        }
+        // 单个字段的名称不带下标，与Betaflight的vbatLatest等一致
+        for (k = 0; k < blackboxGroups[g].count; k++) {
+            if (blackboxGroups[g].count == 1) {
+                snprintf(buf, sizeof(buf), ",%s", blackboxGroups[g].name);
+            } else {
+                snprintf(buf, sizeof(buf), ",%s[%lu]", blackboxGroups[g].name, (unsigned long)k);
+            }
+            Blackbox_PutString(buf);
+        }
+    }
+    Blackbox_PutByte('\n');
+    Blackbox_PutFieldLine("I signed", 0, 0, 1);
+    Blackbox_PutFieldLine("I predictor", BLACKBOX_PREDICT_0, BLACKBOX_PREDICT_0, BLACKBOX_PREDICT_0);
+    Blackbox_PutFieldLine("I encoding", BLACKBOX_ENCODING_UVB, BLACKBOX_ENCODING_UVB, BLACKBOX_ENCODING_SVB);
+    Blackbox_PutFieldLine("P predictor", BLACKBOX_PREDICT_INC, BLACKBOX_PREDICT_PREVIOUS, BLACKBOX_PREDICT_PREVIOUS);
+    Blackbox_PutFieldLine("P encoding", BLACKBOX_ENCODING_NULL, BLACKBOX_ENCODING_SVB, BLACKBOX_ENCODING_SVB);
+}
+
+// 编码一帧：每BLACKBOX_I_INTERVAL帧一个I帧记原值，其余为P帧，记相对上一帧的差值；
+// Betaflight格式中I帧的字段即预测值为0的有符号变长整数，与差分编码器的关键帧一致
+static void Blackbox_EncodeFrame(const int32_t *raw)
+{
+    uint8_t buf[1 + DELTA_CODEC_MAX_BYTES(2 + BLACKBOX_FIELD_COUNT)];
+    uint32_t len = 1;
+
+    if ((blackboxIteration % BLACKBOX_I_INTERVAL) == 0) {
+        DeltaCodec_Reset(&blackboxCodec);
+        buf[0] = BLACKBOX_FRAME_I;
+        len += DeltaCodec_PutUnsigned(buf + len, blackboxIteration);
+        len += DeltaCodec_PutUnsigned(buf + len, (uint32_t)raw[0]);
+    } else {
+        buf[0] = BLACKBOX_FRAME_P;
+        len += DeltaCodec_PutSigned(buf + len, (int32_t)((uint32_t)raw[0] - blackboxPrevTime));
+    }
+    len += DeltaCodec_Encode(&blackboxCodec, raw + 1, buf + len);
+    Blackbox_PutBytes(buf, len);
+
+    blackboxPrevTime = (uint32_t)raw[0];
+    blackboxIteration++;
+    blackboxStat.frames++;
+}
+
+// 结束事件，Blackbox Explorer据此判断日志完整
+static void Blackbox_WriteEnd(void)
+{
+    Blackbox_PutByte(BLACKBOX_FRAME_EVENT);
+    Blackbox_PutByte(BLACKBOX_EVENT_LOG_END);
+    Blackbox_PutString("End of log");
+    Blackbox_PutByte(0);
+    Blackbox_SendPage();
+}
+
+static void Blackbox_EncoderEntry(void *param)
+{
+    int32_t raw[1 + BLACKBOX_FIELD_COUNT];
+    uint32_t lastWakeTick = tTaskTickGet();
+    uint32_t status;
+    uint8_t request;
+
+    (void)param;
+    for (;;) {
+        tTaskDelayUntil(&lastWakeTick, BLACKBOX_PERIOD_TICKS);
+
+        status = tTaskEnterCritical();
+        request = blackboxRequest;
+        blackboxRequest = 0;
+        tTaskExitCritical(status);
+
+        // 停止后又立即开始时，先写完上一段的剩余帧及结束事件，再开始新的一段
+        while (tRingBufCount(&blackboxRing) >= BLACKBOX_RAW_SIZE) {
+            tRingBufGet(&blackboxRing, (uint8_t *)raw, BLACKBOX_RAW_SIZE);
+            Blackbox_EncodeFrame(raw);
+        }
+        if (request & BLACKBOX_REQ_STOP) {
+            Blackbox_WriteEnd();
+        }
+        if (request & BLACKBOX_REQ_START) {
+            blackboxIteration = 0;
+            Blackbox_WriteHeader();
+            blackboxRunning = 1;
+        }
+    }
+}
+
+// 查找第一个空扇区：日志从地址0起连续存放，扇区的第一个字节为0xFF即未写过
+static uint32_t Blackbox_FindFree(void)
+{
+    uint32_t size = SpiFlash_GetSize();
+    uint32_t addr;
+    uint8_t value;
+
+    for (addr = 0; addr < size; addr += SPIFLASH_SECTOR_SIZE) {
+        SpiFlash_Read(addr, &value, 1);
+        if (value == 0xFF) {
+            break;
+        }
+    }
+    return addr;
+}
+
+// 写入一段数据，每进入一个新扇区先擦除，按页边界拆分；写满后置full并停止记录
+static void Blackbox_Program(const uint8_t *data, uint32_t len)
+{
+    uint32_t size = SpiFlash_GetSize();
+    uint32_t addr = blackboxStat.writeAddr;
+    uint32_t chunk;
+
+    while (len > 0) {
+        chunk = SPIFLASH_PAGE_SIZE - (addr & (SPIFLASH_PAGE_SIZE - 1u));
+        chunk = (chunk < len) ? chunk : len;
+        if (addr + chunk > size) {
+            blackboxStat.full = 1;
+            blackboxRunning = 0;
+            return;
+        }
+        if ((addr & (SPIFLASH_SECTOR_SIZE - 1u)) == 0) {
+            SpiFlash_EraseSector(addr);
+        }
+        SpiFlash_WritePage(addr, data, chunk);
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+        blackboxStat.writeAddr = addr;
+        blackboxStat.bytes += chunk;
+    }
+    blackboxStat.pages++;
+}
+
+static void Blackbox_WriterEntry(void *param)
+{
+    BlackboxPage page;
+
+    (void)param;
+    blackboxStat.writeAddr = Blackbox_FindFree();
+    for (;;) {
+        tQueueReceive(&blackboxPageQueue, &page, 0);
+        if (page.flags & BLACKBOX_PAGE_NEW_LOG) {
+            // 新的一段日志从下一个扇区开始，与上一段之间留有擦除后的空白
+            blackboxStat.writeAddr = (blackboxStat.writeAddr + SPIFLASH_SECTOR_SIZE - 1u) & ~(SPIFLASH_SECTOR_SIZE - 1u);
+            blackboxStat.bytes = 0;
+            blackboxStat.pages = 0;
+        }
+        if (!blackboxStat.full) {
+            Blackbox_Program(page.data, page.len);
+        }
+        tMemBlockNotify(&blackboxPagePool, page.data);
+    }
+}
+
+/**
+ * @brief 初始化外部Flash，创建编码及写入任务，此后调用Blackbox_Start开始记录
+ *
+ * @return 0成功；1没有识别到Flash，不创建任务，Blackbox_Log不会写入
+ */
+uint8_t Blackbox_Init(void)
+{
+    if (SpiFlash_Init() != 0) {
+        return 1;
+    }
+    DeltaCodec_Init(&blackboxCodec, BLACKBOX_FIELD_COUNT, DELTA_PREDICT_PREVIOUS);
+    tRingBufInit(&blackboxRing, blackboxRingBuf, sizeof(blackboxRingBuf));
+    tMemBlockInit(&blackboxPagePool, (uint8_t *)blackboxPageMem, SPIFLASH_PAGE_SIZE, BLACKBOX_PAGE_COUNT);
+    tQueueInit(&blackboxPageQueue, blackboxPageQueueBuf, sizeof(BlackboxPage), BLACKBOX_PAGE_COUNT);
+
+    tTaskInit(&blackboxEncoderTask, Blackbox_EncoderEntry, (void *)0, BLACKBOX_PRIO, blackboxEncoderStack, sizeof(blackboxEncoderStack));
+    tObjectSetName(&blackboxEncoderTask.object, "bbEncode");
+    tTaskInit(&blackboxWriterTask, Blackbox_WriterEntry, (void *)0, BLACKBOX_WRITER_PRIO, blackboxWriterStack, sizeof(blackboxWriterStack));
+    tObjectSetName(&blackboxWriterTask.object, "bbWrite");
+    return 0;
+}
+
+void Blackbox_Start(void)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    if (!blackboxRunning && !blackboxStat.full) {
+        blackboxRequest |= BLACKBOX_REQ_START;
+    }
+    tTaskExitCritical(status);
+}
+
+void Blackbox_Stop(void)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    if (blackboxRunning) {
+        blackboxRunning = 0;
+        blackboxRequest |= BLACKBOX_REQ_STOP;
+    }
+    tTaskExitCritical(status);
+}
+
+void Blackbox_GetStat(BlackboxStat *stat)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = blackboxStat;
+    stat->running = blackboxRunning;
+    tTaskExitCritical(status);
+}
+
+#endif
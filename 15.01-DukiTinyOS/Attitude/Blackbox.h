@@ -0,0 +1,72 @@
+#ifndef __BLACKBOX_H
+#define __BLACKBOX_H
+
+#include <stdint.h>
+
+// 黑匣子：控制回路每BLACKBOX_RATE_DIV个周期把选中的字段换算为整数，整帧写入无锁环形缓冲区后立即返回；
+// 编码任务按最低的几级优先级取出，对前一帧做差分后以zigzag变长整数编码，写入存储池中的页；
+// 写满的页经队列交给写入任务，由SPI DMA编程到外部Flash，编码与写入互不等待。
+// 文件格式与Betaflight/Cleanflight的黑匣子日志相同(文本头 + I帧/P帧 + 结束事件)，可用其Blackbox Explorer查看：
+//   I帧：每BLACKBOX_I_INTERVAL帧一个，记录各字段的原值；P帧：记录相对上一帧的差值，时间同样按差值记录
+// 每次开始记录从下一个空扇区开始，一片Flash中依次存放多段日志，写满后停止记录；
+// 需开启TINYOS_ENABLE_SEM、MEMBLOCK、QUEUE及RINGBUF
+#define BLACKBOX_ENABLE         0
+
+// 可选的字段组
+#define BLACKBOX_FIELD_GYRO     (1 << 0)    // gyroADC[0..2]，0.1°/s
+#define BLACKBOX_FIELD_ACCEL    (1 << 1)    // accSmooth[0..2]，mg
+#define BLACKBOX_FIELD_ATTITUDE (1 << 2)    // attitude[0..2]，0.1°
+#define BLACKBOX_FIELD_PID      (1 << 3)    // axisSum[0..2]内环输出、axisI[0..2]内环积分，放大10倍
+#define BLACKBOX_FIELD_MOTOR    (1 << 4)    // motor[0..3]，等效脉宽(us)，1000 ~ 2000
+#define BLACKBOX_FIELD_RC       (1 << 5)    // rcCommand[0..3]，接收机脉宽(us)
+#define BLACKBOX_FIELD_BATTERY  (1 << 6)    // vbatLatest电池电压(0.01V)、amperageLatest电流(0.01A)
+#define BLACKBOX_FIELDS         (BLACKBOX_FIELD_GYRO | BLACKBOX_FIELD_ATTITUDE | BLACKBOX_FIELD_PID | BLACKBOX_FIELD_MOTOR | BLACKBOX_FIELD_RC)
+
+#define BLACKBOX_RATE_DIV       2       // 每几个控制周期记录一帧
+#define BLACKBOX_I_INTERVAL     32      // I帧间隔(帧)，两个I帧之间都是P帧
+#define BLACKBOX_RING_SIZE      2048    // 原始帧环形缓冲区(字节)，2的幂，需容纳写入任务擦除扇区期间(约45ms)的帧
+#define BLACKBOX_PAGE_COUNT     4       // 存储池中的页数，每页为一个Flash页(SPIFLASH_PAGE_SIZE)
+#define BLACKBOX_PERIOD_TICKS   5       // 编码任务取出原始帧的周期(节拍)
+#define BLACKBOX_STACK_SIZE     256     // 编码及写入任务的栈(字)
+#define BLACKBOX_PRIO           (TINYOS_PRIO_COUNT - 4) // 低于遥测任务
+#define BLACKBOX_WRITER_PRIO    (TINYOS_PRIO_COUNT - 4)
+
+// 一个控制周期的数据，由控制回路填写
+typedef struct _BlackboxFrame {
+    uint32_t timeUs;        // 样本时间戳(us)
+    float gyro[3];          // 角速度(rad/s)，已扣除零偏
+    float accel[3];         // 加速度(g)
+    float attitude[3];      // 滚转、俯仰、偏航(°)
+    float pidOutput[3];     // 内环输出
+    float pidIntegral[3];   // 内环积分
+    float motor[4];         // 混控输出(0 ~ 1)
+    uint16_t rc[4];         // 接收机脉宽(us)
+    float vbat;             // 电池电压(V)
+    float current;          // 电流(A)
+} BlackboxFrame;
+
+// 记录统计
+typedef struct _BlackboxStat {
+    uint32_t frames;        // 编码的帧数
+    uint32_t dropped;       // 环形缓冲区满而丢弃的帧数
+    uint32_t bytes;         // 写入Flash的字节数(本段日志)
+    uint32_t pages;         // 写入的页数(本段日志)
+    uint32_t writeAddr;     // 下一页的写入地址
+    uint8_t running;        // 1：正在记录
+    uint8_t full;           // 1：Flash已写满，停止记录
+} BlackboxStat;
+
+#if BLACKBOX_ENABLE == 1
+uint8_t Blackbox_Init(void);    // 初始化外部Flash并创建编码及写入任务，没有识别到Flash时返回1
+void Blackbox_Start(void);      // 开始一段新的日志，先写文件头
+void Blackbox_Stop(void);       // 写入结束事件及未满的页后停止
+void Blackbox_Log(const BlackboxFrame *frame); // 控制回路每周期调用，按分频取帧，不阻塞
+void Blackbox_GetStat(BlackboxStat *stat);
+#else
+#define Blackbox_Init()     ((uint8_t)1)
+#define Blackbox_Start()
+#define Blackbox_Stop()
+#define Blackbox_Log(frame)
+#endif
+
+#endif // __BLACKBOX_H
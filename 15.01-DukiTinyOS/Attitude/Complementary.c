@@ -0,0 +1,95 @@
+#include "AttitudeEstimator.h"
+
+#if ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_COMPLEMENTARY
+
+#include "AttitudeQuat.h"
+#include "tSeqLock.h"
+
+// 一阶互补滤波：机体系中的重力方向v按陀螺仪角速度转动(dv/dt = v × ω)，再以gain * dt的权重向加速度计方向靠拢，
+// 相当于陀螺仪高通、加速度计低通，截止频率为gain / 2π；横滚、俯仰由v直接得出，偏航只由陀螺仪积分
+// v = {-sin(pitch), sin(roll)cos(pitch), cos(roll)cos(pitch)}
+
+static AttitudeVec3 compGravity = {0.0f, 0.0f, 1.0f};
+static float compYaw;               // 偏航角(rad)
+static float compGain = 1.0f;       // 加速度计修正速率(1/s)
+
+static float compSnapshot[2][4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch compLatch = {{0}, {compSnapshot[0], compSnapshot[1]}, sizeof(compSnapshot[0])};
+
+// 由重力方向及偏航角合成四元数(ZYX顺序)并发布
+static void Complementary_Publish(void) {
+    float q[4];
+    float roll = AttitudeAtan2(compGravity.y, compGravity.z);
+    float pitch = AttitudeAtan2(-compGravity.x, ATTITUDE_SQRTF(compGravity.y * compGravity.y + compGravity.z * compGravity.z));
+    float cr = cosf(0.5f * roll), sr = sinf(0.5f * roll);
+    float cp = cosf(0.5f * pitch), sp = sinf(0.5f * pitch);
+    float cy = cosf(0.5f * compYaw), sy = sinf(0.5f * compYaw);
+
+    q[0] = cr * cp * cy + sr * sp * sy;
+    q[1] = sr * cp * cy - cr * sp * sy;
+    q[2] = cr * sp * cy + sr * cp * sy;
+    q[3] = cr * cp * sy - sr * sp * cy;
+    tSeqLatchWrite(&compLatch, q);
+}
+
+void AttitudeEstimator_Init(float gain) {
+    compGain = gain;
+    compGravity = AttitudeVec3_Make(0.0f, 0.0f, 1.0f);
+    compYaw = 0.0f;
+    Complementary_Publish();
+}
+
+// 本后端的状态是机体系下的重力方向及偏航角，由四元数换算
+void AttitudeEstimator_SetQuaternion(const float *q) {
+    compGravity = AttitudeQuat_Gravity(AttitudeQuat_Load(q));
+    compYaw = AttitudeAtan2(2.0f * (q[0] * q[3] + q[1] * q[2]), 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]));
+    Complementary_Publish();
+}
+
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    AttitudeVec3 v = compGravity;
+    float cos2p;
+
+    // 陀螺仪预测：v += (v × ω) * dt
+    v = AttitudeVec3_MulAdd(v, AttitudeVec3_Cross(v, AttitudeVec3_Make(gx, gy, gz)), dt);
+
+    if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+        float alpha = compGain * dt;
+
+        if (alpha > 1.0f) {
+            alpha = 1.0f;
+        }
+        v = AttitudeVec3_MulAdd(v, AttitudeVec3_Sub(AttitudeVec3_Normalize(AttitudeVec3_Make(ax, ay, az)), v), alpha);
+    }
+
+    v = AttitudeVec3_Normalize(v);
+    compGravity = v;
+
+    // 偏航角速度 = (sin(roll) * gy + cos(roll) * gz) / cos(pitch)，用v的分量表示即无需三角函数；俯仰接近±90°时停止积分
+    cos2p = v.y * v.y + v.z * v.z;
+    if (cos2p > 1e-4f) {
+        compYaw += (v.y * gy + v.z * gz) / cos2p * dt;
+        if (compYaw > ATTITUDE_PI) {
+            compYaw -= 2.0f * ATTITUDE_PI;
+        } else if (compYaw < -ATTITUDE_PI) {
+            compYaw += 2.0f * ATTITUDE_PI;
+        }
+    }
+
+    Complementary_Publish();
+}
+
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    (void)mx; (void)my; (void)mz;
+    AttitudeEstimator_UpdateIMU(gx, gy, gz, ax, ay, az, dt);
+}
+
+void AttitudeEstimator_GetQuaternion(float *q) {
+    tSeqLatchRead(&compLatch, q);
+}
+
+const char *AttitudeEstimator_GetName(void) {
+    return "complementary";
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "DeltaCodec.h"
+
+uint32_t DeltaCodec_PutUnsigned(uint8_t *buf, uint32_t value) {
+    uint32_t n = 0;
+
+    while (value > 0x7F) {
+        buf[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = (uint8_t)value;
+    return n;
+}
+
+uint32_t DeltaCodec_PutSigned(uint8_t *buf, int32_t value) {
+    return DeltaCodec_PutUnsigned(buf, DeltaCodec_ZigZag(value));
+}
+
+/**
+ * @brief 读取一个无符号变长整数
+ *
+ * @param buf 数据
+ * @param len 可读的字节数
+ * @param value 读出的值
+ *
+ * @return 消耗的字节数；末字节缺失或超过5字节时返回0
+ */
+uint32_t DeltaCodec_GetUnsigned(const uint8_t *buf, uint32_t len, uint32_t *value) {
+    uint32_t result = 0;
+    uint32_t n;
+
+    for (n = 0; (n < len) && (n < 5); n++) {
+        result |= (uint32_t)(buf[n] & 0x7F) << (7 * n);
+        if (!(buf[n] & 0x80)) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t DeltaCodec_GetSigned(const uint8_t *buf, uint32_t len, int32_t *value) {
+    uint32_t raw;
+    uint32_t n = DeltaCodec_GetUnsigned(buf, len, &raw);
+
+    if (n != 0) {
+        *value = DeltaCodec_UnZigZag(raw);
+    }
+    return n;
+}
+
+void DeltaCodec_Init(DeltaCodec *codec, uint32_t channels, uint8_t predictor) {
+    codec->channels = (uint8_t)((channels < DELTA_CODEC_MAX_CHANNELS) ? channels : DELTA_CODEC_MAX_CHANNELS);
+    codec->predictor = predictor;
+    codec->history = 0;
+}
+
+void DeltaCodec_Reset(DeltaCodec *codec) {
+    codec->history = 0;
+}
+
+uint8_t DeltaCodec_IsKeyFrame(const DeltaCodec *codec) {
+    return codec->history == 0;
+}
+
+// 通道i的预测值：没有历史时为0(关键帧记录原值)，线性预测只有一个历史值时退化为上一个值
+static __inline int32_t DeltaCodec_Predict(const DeltaCodec *codec, uint32_t i) {
+    if (codec->history == 0) {
+        return 0;
+    }
+    if ((codec->predictor == DELTA_PREDICT_LINEAR) && (codec->history >= 2)) {
+        return (int32_t)(2u * (uint32_t)codec->prev[i] - (uint32_t)codec->prev2[i]);
+    }
+    return codec->prev[i];
+}
+
+// 记入一帧的原值
+static void DeltaCodec_Push(DeltaCodec *codec, const int32_t *values) {
+    uint32_t i;
+
+    for (i = 0; i < codec->channels; i++) {
+        codec->prev2[i] = codec->prev[i];
+        codec->prev[i] = values[i];
+    }
+    if (codec->history < 2) {
+        codec->history++;
+    }
+}
+
+/**
+ * @brief 编码一帧：各通道依次写入原值与预测值之差
+ *
+ * 差值按32位回绕计算，解码端以同样的回绕还原，任何输入都不会溢出出错。
+ *
+ * @param codec 编码状态
+ * @param values channels个原值
+ * @param buf 输出，至少DELTA_CODEC_MAX_BYTES(channels)字节
+ *
+ * @return 写入的字节数
+ */
+uint32_t DeltaCodec_Encode(DeltaCodec *codec, const int32_t *values, uint8_t *buf) {
+    uint32_t i, n = 0;
+
+    for (i = 0; i < codec->channels; i++) {
+        n += DeltaCodec_PutSigned(buf + n, (int32_t)((uint32_t)values[i] - (uint32_t)DeltaCodec_Predict(codec, i)));
+    }
+    DeltaCodec_Push(codec, values);
+    return n;
+}
+
+uint32_t DeltaCodec_Decode(DeltaCodec *codec, const uint8_t *buf, uint32_t len, int32_t *values) {
+    int32_t residual;
+    uint32_t i, k, n = 0;
+
+    for (i = 0; i < codec->channels; i++) {
+        k = DeltaCodec_GetSigned(buf + n, len - n, &residual);
+        if (k == 0) {
+            return 0;
+        }
+        n += k;
+        values[i] = (int32_t)((uint32_t)residual + (uint32_t)DeltaCodec_Predict(codec, i));
+    }
+    DeltaCodec_Push(codec, values);
+    return n;
+}
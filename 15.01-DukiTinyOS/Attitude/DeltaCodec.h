@@ -0,0 +1,46 @@
+#ifndef __DELTACODEC_H
+#define __DELTACODEC_H
+
+#include <stdint.h>
+
+// 预测差分 + 变长整数编码：每个通道先由历史值预测，只编码预测残差；残差经zigzag映射为无符号数，
+// 按每字节7位、低位在前、最高位为后续标志写出，绝对值小于64的残差只占1字节。
+// 传感器数据相邻样本变化很小，int16的字段平均约1字节，同样的链路可多发约2倍的数据。
+// 编码与解码的状态更新完全对称，不依赖硬件，也可编译到主机端解码程序中(Tools/deltadecode.py为其Python实现)
+#define DELTA_CODEC_MAX_CHANNELS    24
+#define DELTA_CODEC_MAX_BYTES(n)    ((n) * 5)   // n个通道编码后的最大字节数
+
+// 预测器
+#define DELTA_PREDICT_PREVIOUS      0   // 预测值为上一个值，适合噪声较大的数据(陀螺仪、加速度计)
+#define DELTA_PREDICT_LINEAR        1   // 按上两个值线性外推 2x[n-1] - x[n-2]，适合平滑变化的数据(姿态角)
+
+// 一组通道的编解码状态，编码端与解码端各一份，从同一个关键帧开始保持同步
+typedef struct _DeltaCodec {
+    int32_t prev[DELTA_CODEC_MAX_CHANNELS];     // x[n-1]
+    int32_t prev2[DELTA_CODEC_MAX_CHANNELS];    // x[n-2]
+    uint8_t channels;
+    uint8_t predictor;
+    uint8_t history;    // 已有的历史值个数(0 ~ 2)，为0时下一帧为关键帧，记录原值
+} DeltaCodec;
+
+// zigzag映射：0, -1, 1, -2, 2 ... 依次映射为0, 1, 2, 3, 4 ...
+static __inline uint32_t DeltaCodec_ZigZag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static __inline int32_t DeltaCodec_UnZigZag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint32_t DeltaCodec_PutUnsigned(uint8_t *buf, uint32_t value);  // 写入无符号变长整数，返回字节数(1 ~ 5)
+uint32_t DeltaCodec_PutSigned(uint8_t *buf, int32_t value);     // zigzag映射后写入
+uint32_t DeltaCodec_GetUnsigned(const uint8_t *buf, uint32_t len, uint32_t *value); // 读取，返回字节数，数据不完整时返回0
+uint32_t DeltaCodec_GetSigned(const uint8_t *buf, uint32_t len, int32_t *value);
+
+void DeltaCodec_Init(DeltaCodec *codec, uint32_t channels, uint8_t predictor); // channels不超过DELTA_CODEC_MAX_CHANNELS
+void DeltaCodec_Reset(DeltaCodec *codec);   // 清除历史值，下一帧为关键帧，如丢帧后重新同步
+uint8_t DeltaCodec_IsKeyFrame(const DeltaCodec *codec); // 下一帧是否为关键帧
+uint32_t DeltaCodec_Encode(DeltaCodec *codec, const int32_t *values, uint8_t *buf); // 编码一帧，返回字节数
+uint32_t DeltaCodec_Decode(DeltaCodec *codec, const uint8_t *buf, uint32_t len, int32_t *values); // 解码一帧，返回字节数，数据不完整时返回0且状态不变
+
+#endif // __DELTACODEC_H
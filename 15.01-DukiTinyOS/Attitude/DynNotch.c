@@ -0,0 +1,295 @@
+#include "DynNotch.h"
+#include "tinyOS.h"
+
+#if DYN_NOTCH_ENABLE == 1
+
+#if (GYRO_FILTER_ENABLE == 0) || (GYRO_FILTER_NOTCH_COUNT == 0)
+#error "DYN_NOTCH_ENABLE requires GYRO_FILTER_ENABLE and GYRO_FILTER_NOTCH_COUNT > 0"
+#endif
+#if TINYOS_ENABLE_NOTIFY == 0
+#error "DYN_NOTCH_ENABLE requires TINYOS_ENABLE_NOTIFY"
+#endif
+#if (DYN_NOTCH_FFT_SIZE < 64) || (DYN_NOTCH_FFT_SIZE > 512) || (DYN_NOTCH_FFT_SIZE & (DYN_NOTCH_FFT_SIZE - 1))
+#error "DYN_NOTCH_FFT_SIZE must be a power of 2 between 64 and 512"
+#endif
+
+#include "AttitudeMath.h"
+
+#define DYN_NOTCH_HALF          (DYN_NOTCH_FFT_SIZE / 2)
+
+// 发布给角速度级的中心频率
+typedef struct _DynNotchCenters {
+    float hz[GYRO_FILTER_NOTCH_COUNT];
+} DynNotchCenters;
+
+static tTask dynNotchTask;
+static tTaskStack dynNotchStack[DYN_NOTCH_STACK_SIZE];
+
+// 样本双缓冲：角速度级写dynNotchFill一份，写满后交给分析任务
+static float dynNotchSamples[2][GYRO_FILTER_AXIS_COUNT][DYN_NOTCH_FFT_SIZE];
+static uint32_t dynNotchFill;
+static uint32_t dynNotchPos;
+static volatile uint32_t dynNotchBusy;      // 分析任务正在处理另一份
+
+// 分析任务使用
+static float dynNotchWindow[DYN_NOTCH_FFT_SIZE];                    // 汉宁窗
+static float dynNotchCos[DYN_NOTCH_HALF], dynNotchSin[DYN_NOTCH_HALF]; // e^(-j2πk/N)，k < N/2
+static float dynNotchRe[DYN_NOTCH_HALF], dynNotchIm[DYN_NOTCH_HALF];
+static float dynNotchPower[DYN_NOTCH_HALF];
+static float dynNotchSampleHz;
+static uint32_t dynNotchBinMin, dynNotchBinMax;
+static float dynNotchCenter[GYRO_FILTER_NOTCH_COUNT];
+
+static DynNotchCenters dynNotchCopy[2];
+static tSeqLatch dynNotchLatch = {{0}, {&dynNotchCopy[0], &dynNotchCopy[1]}, sizeof(dynNotchCopy[0])};
+static uint32_t dynNotchSeen;               // 角速度级已应用的序号
+
+static DynNotchStat dynNotchStat;
+
+// N/2点原位复数FFT：先按位反转重排，再逐级蝶形运算，第s级的旋转因子在表中的步长为N/2^s
+static void DynNotch_Cfft(float *re, float *im) {
+    uint32_t i, j, bit, len, half, step, k;
+    float tr, ti, wr, wi;
+
+    for (i = 1, j = 0; i < DYN_NOTCH_HALF; i++) {
+        for (bit = DYN_NOTCH_HALF >> 1; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            tr = re[i]; re[i] = re[j]; re[j] = tr;
+            ti = im[i]; im[i] = im[j]; im[j] = ti;
+        }
+    }
+    for (len = 2; len <= DYN_NOTCH_HALF; len <<= 1) {
+        half = len >> 1;
+        step = DYN_NOTCH_FFT_SIZE / len;
+        for (i = 0; i < DYN_NOTCH_HALF; i += len) {
+            for (k = 0; k < half; k++) {
+                // N/2点FFT的旋转因子e^(-j2πk/(N/2))即表中第2k项
+                wr = dynNotchCos[k * step];
+                wi = dynNotchSin[k * step];
+                tr = wr * re[i + k + half] - wi * im[i + k + half];
+                ti = wr * im[i + k + half] + wi * re[i + k + half];
+                re[i + k + half] = re[i + k] - tr;
+                im[i + k + half] = im[i + k] - ti;
+                re[i + k] += tr;
+                im[i + k] += ti;
+            }
+        }
+    }
+}
+
+// 一个轴加窗后做实数FFT，各频点的功率累加到dynNotchPower：偶、奇序号的点分别作为实部、虚部做N/2点复数FFT，
+// 再由X[k] = (Z[k] + Z*[N/2-k]) / 2 - j * W^k * (Z[k] - Z*[N/2-k]) / 2拆分出实数序列的频谱
+static void DynNotch_AccumulateAxis(const float *x) {
+    uint32_t n, k;
+
+    for (n = 0; n < DYN_NOTCH_HALF; n++) {
+        dynNotchRe[n] = x[2 * n] * dynNotchWindow[2 * n];
+        dynNotchIm[n] = x[2 * n + 1] * dynNotchWindow[2 * n + 1];
+    }
+    DynNotch_Cfft(dynNotchRe, dynNotchIm);
+    for (k = dynNotchBinMin - 1; k <= dynNotchBinMax + 1; k++) {
+        float ar = dynNotchRe[k], ai = dynNotchIm[k];
+        uint32_t m = (DYN_NOTCH_HALF - k) & (DYN_NOTCH_HALF - 1);     // Z[N/2]即Z[0]
+        float br = dynNotchRe[m], bi = -dynNotchIm[m];
+        float er = (ar + br) * 0.5f, ei = (ai + bi) * 0.5f;     // 偶数点的频谱
+        float dr = (ar - br) * 0.5f, di = (ai - bi) * 0.5f;     // j倍奇数点的频谱
+        float wr = dynNotchCos[k], wi = dynNotchSin[k];
+        // X = E - j * W * D
+        float xr = er + wr * di + wi * dr;
+        float xi = ei - wr * dr + wi * di;
+        dynNotchPower[k] += xr * xr + xi * xi;
+    }
+}
+
+// 在频率范围内找出最多GYRO_FILTER_NOTCH_COUNT个峰，按频率从低到高写入hz，返回个数
+static uint32_t DynNotch_FindPeaks(float *hz) {
+    uint32_t bin[GYRO_FILTER_NOTCH_COUNT];
+    uint32_t count = 0, i, j, k, best;
+    float mean = 0.0f, threshold, denom, delta;
+
+    for (k = dynNotchBinMin; k <= dynNotchBinMax; k++) {
+        mean += dynNotchPower[k];
+    }
+    mean /= (float)(dynNotchBinMax - dynNotchBinMin + 1);
+    threshold = mean * DYN_NOTCH_PEAK_RATIO;
+
+    // 每次取剩下的最大局部极大值，已选峰的相邻频点不再参与，汉宁窗的主瓣宽两个频点
+    while (count < GYRO_FILTER_NOTCH_COUNT) {
+        best = 0;
+        for (k = dynNotchBinMin; k <= dynNotchBinMax; k++) {
+            if ((dynNotchPower[k] <= threshold) || (dynNotchPower[k] <= dynNotchPower[k - 1])
+                || (dynNotchPower[k] < dynNotchPower[k + 1])) {
+                continue;
+            }
+            for (i = 0; i < count; i++) {
+                if ((k + 1 >= bin[i]) && (k <= bin[i] + 1)) {
+                    break;
+                }
+            }
+            if ((i == count) && ((best == 0) || (dynNotchPower[k] > dynNotchPower[best]))) {
+                best = k;
+            }
+        }
+        if (best == 0) {
+            break;
+        }
+        bin[count++] = best;
+    }
+
+    // 按频率排序后依次对应各节陷波，峰的个数不变时每节跟踪同一个峰
+    for (i = 1; i < count; i++) {
+        for (j = i; (j > 0) && (bin[j - 1] > bin[j]); j--) {
+            k = bin[j]; bin[j] = bin[j - 1]; bin[j - 1] = k;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        k = bin[i];
+        denom = dynNotchPower[k - 1] - 2.0f * dynNotchPower[k] + dynNotchPower[k + 1];
+        delta = (denom < 0.0f) ? 0.5f * (dynNotchPower[k - 1] - dynNotchPower[k + 1]) / denom : 0.0f;
+        hz[i] = ((float)k + delta) * dynNotchSampleHz / DYN_NOTCH_FFT_SIZE;
+    }
+    return count;
+}
+
+/**
+ * @brief 分析任务：每收到一份写满的样本，求三轴的功率谱之和，找出峰值后平滑并发布中心频率
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void DynNotch_TaskEntry(void *param) {
+    DynNotchCenters centers;
+    float peak[GYRO_FILTER_NOTCH_COUNT];
+    uint32_t buf, axis, k, count, start;
+
+    (void)param;
+    for (;;) {
+        tTaskNotifyTake(1, 0);
+        start = tCycleCounterGet();
+        buf = dynNotchFill ^ 1;
+
+        for (k = dynNotchBinMin - 1; k <= dynNotchBinMax + 1; k++) {
+            dynNotchPower[k] = 0.0f;
+        }
+        for (axis = 0; axis < GYRO_FILTER_AXIS_COUNT; axis++) {
+            DynNotch_AccumulateAxis(dynNotchSamples[buf][axis]);
+        }
+        dynNotchBusy = 0;
+
+        count = DynNotch_FindPeaks(peak);
+        if (count == 0) {
+            dynNotchStat.noPeak++;
+        } else {
+            // 只找到部分峰时按频率对应到低端的几节，其余保持不变
+            for (k = 0; k < count; k++) {
+                dynNotchCenter[k] += DYN_NOTCH_SMOOTH * (peak[k] - dynNotchCenter[k]);
+            }
+            for (k = 0; k < GYRO_FILTER_NOTCH_COUNT; k++) {
+                centers.hz[k] = dynNotchCenter[k];
+            }
+            tSeqLatchWrite(&dynNotchLatch, &centers);
+        }
+        dynNotchStat.frames++;
+        dynNotchStat.lastCycles = tCycleCounterGet() - start;
+    }
+}
+
+/**
+ * @brief 计算窗函数及旋转因子并创建分析任务，在GyroFilter_InitConfig之后、采样开始之前调用
+ *
+ * @param sampleHz 样本频率(Hz)，与GyroFilter的采样率相同
+ *
+ * @return uint8_t 0成功；1频率范围超过采样率的一半或不足三个频点
+ */
+uint8_t DynNotch_Init(float sampleHz) {
+    uint32_t k;
+
+    dynNotchSampleHz = sampleHz;
+    dynNotchBinMin = (uint32_t)(DYN_NOTCH_MIN_HZ * DYN_NOTCH_FFT_SIZE / sampleHz);
+    dynNotchBinMax = (uint32_t)(DYN_NOTCH_MAX_HZ * DYN_NOTCH_FFT_SIZE / sampleHz);
+    if (dynNotchBinMin < 1) {
+        dynNotchBinMin = 1;
+    }
+    // 峰值插值需要两侧的频点，最高只到N/2 - 2
+    if ((dynNotchBinMax > DYN_NOTCH_HALF - 2) || (dynNotchBinMax < dynNotchBinMin + 2)) {
+        return 1;
+    }
+
+    for (k = 0; k < DYN_NOTCH_FFT_SIZE; k++) {
+        dynNotchWindow[k] = 0.5f - 0.5f * cosf(2.0f * ATTITUDE_PI * (float)k / DYN_NOTCH_FFT_SIZE);
+    }
+    for (k = 0; k < DYN_NOTCH_HALF; k++) {
+        dynNotchCos[k] = cosf(2.0f * ATTITUDE_PI * (float)k / DYN_NOTCH_FFT_SIZE);
+        dynNotchSin[k] = -sinf(2.0f * ATTITUDE_PI * (float)k / DYN_NOTCH_FFT_SIZE);
+    }
+    for (k = 0; k < GYRO_FILTER_NOTCH_COUNT; k++) {
+        dynNotchCenter[k] = GYRO_FILTER_NOTCH_HZ * (float)(k + 1);
+        dynNotchStat.centerHz[k] = dynNotchCenter[k];
+    }
+    dynNotchSeen = tSeqLockReadBegin(&dynNotchLatch.lock);
+
+    tTaskInit(&dynNotchTask, DynNotch_TaskEntry, (void *)0, DYN_NOTCH_PRIO, dynNotchStack, sizeof(dynNotchStack));
+    tObjectSetName(&dynNotchTask.object, "dynNotch");
+    return 0;
+}
+
+/**
+ * @brief 写入一个未滤波的三轴样本，写满一份后交给分析任务；分析任务仍在处理上一份时丢弃这一份
+ *
+ * @param gyro 三轴角速度
+ *
+ * @return void
+ */
+void DynNotch_Push(const float *gyro) {
+    uint32_t axis;
+
+    for (axis = 0; axis < GYRO_FILTER_AXIS_COUNT; axis++) {
+        dynNotchSamples[dynNotchFill][axis][dynNotchPos] = gyro[axis];
+    }
+    if (++dynNotchPos < DYN_NOTCH_FFT_SIZE) {
+        return;
+    }
+    dynNotchPos = 0;
+    if (dynNotchBusy) {
+        dynNotchStat.dropped++;
+        return;
+    }
+    dynNotchBusy = 1;
+    dynNotchFill ^= 1;
+    tTaskNotifyGive(&dynNotchTask);
+}
+
+/**
+ * @brief 有新发布的中心频率时改写陷波系数，没有时只比较一次序号
+ *
+ * @param filter 角速度级使用的滤波器，前GYRO_FILTER_NOTCH_COUNT节为陷波
+ *
+ * @return void
+ */
+void DynNotch_Update(GyroFilter *filter) {
+    DynNotchCenters centers;
+    uint32_t seq = tSeqLockReadBegin(&dynNotchLatch.lock);
+    uint32_t k;
+
+    if (seq == dynNotchSeen) {
+        return;
+    }
+    dynNotchSeen = seq;
+    tSeqLatchRead(&dynNotchLatch, &centers);
+    for (k = 0; k < GYRO_FILTER_NOTCH_COUNT; k++) {
+        (void)GyroFilter_SetNotch(filter, k, centers.hz[k], GYRO_FILTER_NOTCH_Q);
+        dynNotchStat.centerHz[k] = centers.hz[k];
+    }
+}
+
+void DynNotch_GetStat(DynNotchStat *stat) {
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = dynNotchStat;
+    tTaskExitCritical(status);
+}
+#endif
@@ -0,0 +1,37 @@
+#ifndef __DYNNOTCH_H
+#define __DYNNOTCH_H
+
+#include <stdint.h>
+#include "GyroFilter.h"
+
+// 动态陷波：按陀螺仪频谱跟踪电机噪声的频率，改变GyroFilter前GYRO_FILTER_NOTCH_COUNT节陷波的中心频率。
+// 角速度级每个样本把未滤波的三轴角速度写入双缓冲中的一份，写满DYN_NOTCH_FFT_SIZE点后交给低优先级的分析任务，
+// 改写另一份；分析任务加汉宁窗、对三轴分别做实数FFT(N/2点复数FFT加拆分)，功率相加后在DYN_NOTCH_MIN_HZ ~ MAX_HZ内
+// 找出最大的几个峰，抛物线插值得到频率，平滑后经双缓冲顺序锁发布。角速度级每个样本只比较一次序号，
+// 有新的中心频率时才重算陷波系数，不会等待分析任务；分析来不及时丢弃写满的一份，计数后继续采样。
+// 需开启GYRO_FILTER_ENABLE(GYRO_FILTER_NOTCH_COUNT不为0)及TINYOS_ENABLE_NOTIFY
+#define DYN_NOTCH_ENABLE        0
+#define DYN_NOTCH_FFT_SIZE      128         // FFT点数，2的幂，64 ~ 512；1kHz时频率分辨率约7.8Hz，每128ms分析一次
+#define DYN_NOTCH_MIN_HZ        80.0f       // 跟踪的频率范围(Hz)，上限需低于采样率的一半
+#define DYN_NOTCH_MAX_HZ        450.0f
+#define DYN_NOTCH_PEAK_RATIO    4.0f        // 峰值功率需超过范围内平均功率的倍数，否则沿用原来的中心频率
+#define DYN_NOTCH_SMOOTH        0.3f        // 中心频率每次向新峰值移动的比例，0 ~ 1
+#define DYN_NOTCH_PRIO          (TINYOS_PRIO_COUNT - 3) // 分析任务优先级，只使用控制任务剩下的时间
+#define DYN_NOTCH_STACK_SIZE    128         // 分析任务栈(字)，缓冲区均为静态变量
+
+typedef struct _DynNotchStat {
+	float centerHz[GYRO_FILTER_NOTCH_COUNT];    // 当前发布的中心频率
+	uint32_t frames;                            // 已分析的缓冲区数
+	uint32_t dropped;                           // 分析来不及而丢弃的缓冲区数
+	uint32_t noPeak;                            // 没有足够高的峰值的次数
+	uint32_t lastCycles;                        // 最近一次分析的耗时(CPU周期)
+} DynNotchStat;
+
+#if DYN_NOTCH_ENABLE == 1
+uint8_t DynNotch_Init(float sampleHz);                  // 计算窗函数及旋转因子并创建分析任务，返回0成功
+void DynNotch_Push(const float *gyro);                  // 角速度级每个样本调用，写入未滤波的三轴角速度
+void DynNotch_Update(GyroFilter *filter);               // 角速度级每个样本调用，有新的中心频率时改写陷波
+void DynNotch_GetStat(DynNotchStat *stat);
+#endif
+
+#endif
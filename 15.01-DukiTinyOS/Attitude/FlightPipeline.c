@@ -0,0 +1,616 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_FLIGHT == 1
+
+#if TINYOS_ENABLE_BENCHMARK != 0
+#error "TINYOS_ENABLE_FLIGHT与TINYOS_ENABLE_BENCHMARK都提供tInitApp，只能开启一个"
+#endif
+
+#include "FlightPipeline.h"
+#include "AttitudePIDController.h"
+#include "AttitudeSolver.h"
+#include "MPU6050.h"
+#include "MPU6050Sampler.h"
+#include "GyroCalib.h"
+#include "Receiver.h"
+#include "Motor.h"
+#include "Mixer.h"
+#include "Battery.h"
+#include "LoopLatency.h"
+#include "BootProfile.h"
+#include "Blackbox.h"
+#include "GyroFilter.h"
+#include "DynNotch.h"
+#include "EscTelemetry.h"
+#include "RpmFilter.h"
+#include "TuneLink.h"
+#include "GainSchedule.h"
+#include "Anonymity.h"
+#include "MySerial.h"
+
+#if MIXER_MOTOR_COUNT > MOTOR_COUNT
+#error "混控的电机数超过TIM3的PWM通道数"
+#endif
+
+// 接收机级发给角速度级及姿态级的指令
+typedef struct _FlightCommand {
+    float throttle;                     // 油门(0 ~ 1)
+    float angleRef[PID_AXIS_COUNT];     // 滚转、俯仰角度设定值(°)，偏航不使用
+    float yawRate;                      // 偏航角速度设定值(rad/s)
+    uint8_t armed;                      // 1：电调已就绪且接收机信号正常，可以输出油门
+    float vbatScale;                    // 混控输出的电压补偿系数
+    float cellVoltage;                  // 单节电压(V)，没有测量时为0，用于增益调度
+    float vbat;                         // 电池电压(V)、电流(A)，只用于黑匣子记录
+    float current;
+    uint16_t rc[CHANNEL_COUNT];         // 接收机脉宽(us)，只用于黑匣子记录
+} FlightCommand;
+
+// 姿态级发给角速度级的设定值
+typedef struct _FlightRateRef {
+    float rate[PID_AXIS_COUNT];         // 角速度设定值
+    float angle[PID_AXIS_COUNT];        // 计算设定值时的姿态角(°)，只用于黑匣子记录，角速度级不做欧拉角换算
+} FlightRateRef;
+
+static tTask flightRateTask;
+static tTask flightAttitudeTask;
+static tTask flightRxTask;
+static tTask flightLoggerTask;
+static tTaskStack flightRateStack[FLIGHT_STACK_SIZE];
+static tTaskStack flightAttitudeStack[FLIGHT_STACK_SIZE];
+static tTaskStack flightRxStack[FLIGHT_STACK_SIZE];
+static tTaskStack flightLoggerStack[FLIGHT_STACK_SIZE];
+
+// 外环角速度设定值：姿态级发布，角速度级订阅
+TINYOS_TOPIC_DEFINE(flightRateRefTopic, FlightRateRef);
+
+// 指令：接收机级发布，角速度级及姿态级订阅，发布之前订阅者保持全0即未解锁
+TINYOS_TOPIC_DEFINE(flightCommandTopic, FlightCommand);
+
+TINYOS_TOPIC_DEFINE(flightImuTopic, FlightImu);
+TINYOS_TOPIC_DEFINE(flightAttitudeTopic, FlightAttitude);
+
+// 外环按250Hz，内环按1kHz积分及微分，两者的周期不同，不能共用PIDAttitude
+static PIDAxis3 flightAnglePID;
+static PIDAxis3 flightRatePID;
+static AttitudePIDController flightController;
+
+static FlightStageStat flightStat[FlightStageCount];
+
+#if GYRO_FILTER_ENABLE == 1
+// 陀螺仪滤波只在角速度级中使用
+static GyroFilter flightGyroFilter;
+#endif
+#if RPM_FILTER_ENABLE == 1
+static RpmFilter flightRpmFilter;
+#endif
+#if GAIN_SCHEDULE_ENABLE == 1
+// 内环参数按油门及电压调度，基准参数为初始化或在线调参设置的值
+static GainSchedule flightGainSchedule;
+#endif
+
+#if MPU6050_FIFO_BATCH > 0
+// 硬件FIFO每次读出一批样本，姿态融合攒满一批后批量更新，内环PID仍逐个样本执行
+typedef struct _FlightFusionBatch {
+    float gyro[MPU6050_FIFO_BATCH][3];
+    float accel[3];                     // 加速度之和
+    float dt;                           // 样本间隔之和(s)
+    uint32_t count;
+} FlightFusionBatch;
+
+static FlightFusionBatch flightBatch;
+
+// 加入一个样本，满一批时以加速度及间隔的均值批量更新
+static void FlightPipeline_Fuse(const MPU6050Sample *sample, float dt) {
+    FlightFusionBatch *b = &flightBatch;
+    float scale;
+
+    b->gyro[b->count][0] = sample->gx;
+    b->gyro[b->count][1] = sample->gy;
+    b->gyro[b->count][2] = sample->gz;
+    b->accel[0] += sample->ax;
+    b->accel[1] += sample->ay;
+    b->accel[2] += sample->az;
+    b->dt += dt;
+    if (++b->count < MPU6050_FIFO_BATCH) {
+        return;
+    }
+    scale = 1.0f / (float)b->count;
+    AttitudeSolver_UpdateIMUBatch(b->gyro[0], b->count, b->accel[0] * scale, b->accel[1] * scale, b->accel[2] * scale,
+                                  b->dt * scale);
+    b->accel[0] = b->accel[1] = b->accel[2] = 0.0f;
+    b->dt = 0.0f;
+    b->count = 0;
+}
+#endif
+
+/**
+ * @brief 记录一级本次的耗时，每级只在自己的任务中记录
+ *
+ * @param stage 流水线的一级
+ * @param cycles 本次耗时(CPU周期)
+ *
+ * @return void
+ */
+static void FlightPipeline_Record(FlightStage stage, uint32_t cycles) {
+    FlightStageStat *stat = &flightStat[stage];
+    uint32_t status = tTaskEnterCritical();
+
+    stat->count++;
+    stat->lastCycles = cycles;
+    stat->totalCycles += cycles;
+    if (cycles > stat->maxCycles) {
+        stat->maxCycles = cycles;
+    }
+    if (cycles > stat->budgetCycles) {
+        stat->overruns++;
+    }
+    tTaskExitCritical(status);
+}
+
+void FlightPipeline_GetStat(FlightStage stage, FlightStageStat *stat) {
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = flightStat[stage];
+    tTaskExitCritical(status);
+}
+
+// 由源PID复制某一轴的参数，积分及微分状态不复制
+static void FlightPipeline_CopyGains(PIDAxis3 *dst, const PIDAxis3 *src) {
+    PIDGains gains;
+    int axis;
+
+    for (axis = 0; axis < PID_AXIS_COUNT; axis++) {
+        PIDAxis3_GetGains(src, axis, &gains);
+        PIDAxis3_SetGains(dst, axis, &gains);
+    }
+}
+
+/**
+ * @brief 角速度级：每个样本执行一次，姿态融合、内环PID、混控并写比较寄存器，再按分频唤醒低速级
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void FlightPipeline_RateEntry(void *param) {
+    MPU6050TimedSample timed;
+    FlightCommand cmd = {0};
+    FlightRateRef rateRef = {{0}};
+    tTopicSub cmdSub, rateRefSub;
+    FlightImu imu;
+    float rate[PID_AXIS_COUNT];
+    float bias[3];
+    float motor[MIXER_MOTOR_COUNT];
+    float duty[MOTOR_COUNT];
+#if ESC_TELEMETRY_ENABLE == 1
+    EscRpm escRpm;
+#endif
+#if BLACKBOX_ENABLE == 1
+    BlackboxFrame frame;
+#endif
+#if TUNE_LINK_ENABLE == 1
+    TuneGains tune;
+    uint32_t tuneVersion = 0;
+#endif
+    uint32_t samples = 0;
+    uint32_t start;
+    int i;
+
+    (void)param;
+    tTopicSubscribe(&cmdSub, &flightCommandTopic);
+    tTopicSubscribe(&rateRefSub, &flightRateRefTopic);
+    for (;;) {
+        if (MPU6050_SamplerRead(&timed, 0) != tErrorNoError) {
+            continue;
+        }
+        start = tCycleCounterGet();
+#if TUNE_LINK_ENABLE == 1
+        // 在线调参的新参数只在周期开始时整套换上
+        if (TuneLink_Fetch(&tuneVersion, &tune)) {
+            TuneLink_Apply(&flightRatePID, &tune, TUNE_LOOP_RATE);
+#if GAIN_SCHEDULE_ENABLE == 1
+            // 新参数作为基准，重新算好调度表
+            GainSchedule_Init(&flightGainSchedule, &flightRatePID);
+#endif
+        }
+#endif
+
+#if ESC_TELEMETRY_ENABLE == 1
+        // 取出电调回传的转速并发布，KISS遥测时同时轮到下一个电机，请求随本周期的DShot帧发出
+        if (EscTelemetry_Poll(&escRpm)) {
+#if RPM_FILTER_ENABLE == 1
+            RpmFilter_SetRpm(&flightRpmFilter, &escRpm);
+#endif
+        }
+#endif
+
+#if (GYRO_FILTER_ENABLE == 1) || (RPM_FILTER_ENABLE == 1)
+        // 滤除电机振动后再融合，姿态及内环都使用滤波后的角速度
+        {
+            float gyro[3] = {timed.sample.gx, timed.sample.gy, timed.sample.gz};
+
+#if RPM_FILTER_ENABLE == 1
+            // 先按各电机的转速滤除基频及谐波，中心频率每个样本更新
+            RpmFilter_Update(&flightRpmFilter);
+            RpmFilter_Apply(&flightRpmFilter, gyro);
+#endif
+#if GYRO_FILTER_ENABLE == 1
+#if DYN_NOTCH_ENABLE == 1
+            // 频谱分析使用GyroFilter之前的样本，开启转速陷波时只剩机架共振等与转速无关的噪声
+            DynNotch_Push(gyro);
+            DynNotch_Update(&flightGyroFilter);
+#endif
+            GyroFilter_Apply(&flightGyroFilter, gyro);
+#endif
+            timed.sample.gx = gyro[0];
+            timed.sample.gy = gyro[1];
+            timed.sample.gz = gyro[2];
+        }
+#endif
+#if (ATTITUDE_BIAS_ESTIMATE == 1) && (ATTITUDE_TEMP_COMP == 1)
+        AttitudeSolver_SetTemperature(timed.sample.temp);
+#endif
+#if MPU6050_FIFO_BATCH > 0
+        FlightPipeline_Fuse(&timed.sample, AttitudeSolver_SampleInterval(timed.timestamp));
+#else
+        AttitudeSolver_UpdateIMU(timed.sample.gx, timed.sample.gy, timed.sample.gz,
+                                 timed.sample.ax, timed.sample.ay, timed.sample.az,
+                                 AttitudeSolver_SampleInterval(timed.timestamp));
+#endif
+        AttitudeSolver_GetGyroBias(bias);
+        rate[PID_AXIS_ROLL] = timed.sample.gx - bias[0];
+        rate[PID_AXIS_PITCH] = timed.sample.gy - bias[1];
+        rate[PID_AXIS_YAW] = timed.sample.gz - bias[2];
+
+        // 指令50Hz、设定值250Hz更新，其余样本只比较代数，沿用上次的副本
+        (void)tTopicCopyNew(&cmdSub, &cmd);
+        (void)tTopicCopyNew(&rateRefSub, &rateRef);
+        if (cmd.armed) {
+#if GAIN_SCHEDULE_ENABLE == 1
+            GainSchedule_Apply(&flightGainSchedule, &flightRatePID, cmd.throttle, cmd.cellVoltage);
+#endif
+            PIDAxis3_Calc(&flightRatePID, rateRef.rate, rate);
+            Mixer_Mix(cmd.throttle,
+                      flightRatePID.output[PID_AXIS_ROLL] * FLIGHT_MIXER_SCALE,
+                      flightRatePID.output[PID_AXIS_PITCH] * FLIGHT_MIXER_SCALE,
+                      flightRatePID.output[PID_AXIS_YAW] * FLIGHT_MIXER_SCALE,
+                      motor);
+            Mixer_Output(motor, cmd.vbatScale);
+            for (i = 0; i < MOTOR_COUNT; i++) {
+                duty[i] = (i < MIXER_MOTOR_COUNT) ? (0.05f * motor[i] + 0.05f) : 0.05f;
+            }
+            Motor_SetAll(duty);
+        } else {
+            // 未解锁或失控：最低油门，积分清零，解锁时不带着旧的积分起飞
+            PIDAxis3_Reset(&flightRatePID);
+            Motor_Stop();
+            for (i = 0; i < MIXER_MOTOR_COUNT; i++) {
+                motor[i] = 0.0f;
+            }
+        }
+
+        // 电机输出之后再发布，订阅者的个数不影响这里的开销
+        imu.timeUs = timed.timestamp;
+        for (i = 0; i < 3; i++) {
+            imu.gyro[i] = rate[i];
+        }
+        imu.accel[0] = timed.sample.ax;
+        imu.accel[1] = timed.sample.ay;
+        imu.accel[2] = timed.sample.az;
+        tTopicPublish(&flightImuTopic, &imu);
+
+#if BLACKBOX_ENABLE == 1
+        // 电机输出之后再记录，只有换算及复制，不推迟输出
+        frame.timeUs = timed.timestamp;
+        for (i = 0; i < 3; i++) {
+            frame.gyro[i] = rate[i];
+            frame.attitude[i] = rateRef.angle[i];
+            frame.pidOutput[i] = flightRatePID.output[i];
+            frame.pidIntegral[i] = flightRatePID.integral[i];
+        }
+        frame.accel[0] = timed.sample.ax;
+        frame.accel[1] = timed.sample.ay;
+        frame.accel[2] = timed.sample.az;
+        frame.vbat = cmd.vbat;
+        frame.current = cmd.current;
+        for (i = 0; i < 4; i++) {
+            frame.motor[i] = (i < MIXER_MOTOR_COUNT) ? motor[i] : 0.0f;
+            frame.rc[i] = (i < CHANNEL_COUNT) ? cmd.rc[i] : 0;
+        }
+        Blackbox_Log(&frame);
+#endif
+
+        if (samples == 0) {
+            BootProfile_Mark(BootStageFirstCycle);
+        }
+        samples++;
+        if ((samples % FLIGHT_ATTITUDE_DIV) == 0) {
+            tTaskNotifyGive(&flightAttitudeTask);
+        }
+        if ((samples % FLIGHT_RX_DIV) == 0) {
+            tTaskNotifyGive(&flightRxTask);
+        }
+        FlightPipeline_Record(FlightStageRate, tCycleCounterGet() - start);
+    }
+}
+
+/**
+ * @brief 姿态级：由角速度级唤醒，外环PID由角度误差得出滚转、俯仰的角速度设定值，偏航直接取杆量
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void FlightPipeline_AttitudeEntry(void *param) {
+    FlightCommand cmd = {0};
+    FlightRateRef rateRef;
+    FlightAttitude attitude;
+    tTopicSub cmdSub;
+#if TUNE_LINK_ENABLE == 1
+    TuneGains tune;
+    uint32_t tuneVersion = 0;
+#endif
+    uint32_t start;
+
+    (void)param;
+    tTopicSubscribe(&cmdSub, &flightCommandTopic);
+    for (;;) {
+        tTaskNotifyTake(1, 0);
+        start = tCycleCounterGet();
+#if TUNE_LINK_ENABLE == 1
+        if (TuneLink_Fetch(&tuneVersion, &tune)) {
+            TuneLink_Apply(&flightAnglePID, &tune, TUNE_LOOP_ANGLE);
+        }
+#endif
+
+        AttitudeSolver_GetEulerAngles(&rateRef.angle[PID_AXIS_ROLL], &rateRef.angle[PID_AXIS_PITCH], &rateRef.angle[PID_AXIS_YAW]);
+        (void)tTopicCopyNew(&cmdSub, &cmd);
+        if (cmd.armed) {
+            PIDAxis3_Calc(&flightAnglePID, cmd.angleRef, rateRef.angle);
+            rateRef.rate[PID_AXIS_ROLL] = flightAnglePID.output[PID_AXIS_ROLL];
+            rateRef.rate[PID_AXIS_PITCH] = flightAnglePID.output[PID_AXIS_PITCH];
+            rateRef.rate[PID_AXIS_YAW] = cmd.yawRate;
+        } else {
+            PIDAxis3_Reset(&flightAnglePID);
+            rateRef.rate[PID_AXIS_ROLL] = 0.0f;
+            rateRef.rate[PID_AXIS_PITCH] = 0.0f;
+            rateRef.rate[PID_AXIS_YAW] = 0.0f;
+        }
+        tTopicPublish(&flightRateRefTopic, &rateRef);
+        // 欧拉角只在这里换算一次，遥测等订阅者直接取用
+        attitude.roll = rateRef.angle[PID_AXIS_ROLL];
+        attitude.pitch = rateRef.angle[PID_AXIS_PITCH];
+        attitude.yaw = rateRef.angle[PID_AXIS_YAW];
+        tTopicPublish(&flightAttitudeTopic, &attitude);
+
+        FlightPipeline_Record(FlightStageAttitude, tCycleCounterGet() - start);
+    }
+}
+
+/**
+ * @brief 接收机级：由角速度级唤醒，读取接收机快照换算为指令，同时发布遥测数据
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void FlightPipeline_RxEntry(void *param) {
+    ReceiverSnapshot snap;
+    BatteryState battery;
+    FlightCommand cmd;
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+    FlightAttitude attitude;
+    FlightImu imu;
+    tTopicSub attitudeSub, imuSub;
+#endif
+    uint8_t wasArmed = 0;
+    uint32_t start;
+    int i;
+
+    (void)param;
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+    tTopicSubscribe(&attitudeSub, &flightAttitudeTopic);
+    tTopicSubscribe(&imuSub, &flightImuTopic);
+#endif
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    tSetSysTickPeriod(FLIGHT_TICK_MS_GROUND);
+#endif
+    for (;;) {
+        tTaskNotifyTake(1, 0);
+        start = tCycleCounterGet();
+
+        // 通道2为油门，通道4、3、1为滚转、俯仰、偏航，以0.5为中位
+        Receiver_GetSnapshot(&snap);
+        cmd.throttle = snap.stick[CHANNEL2_INDEX];
+        cmd.angleRef[PID_AXIS_ROLL] = (snap.stick[CHANNEL4_INDEX] - 0.5f) * 2.0f * FLIGHT_MAX_ANGLE_DEG;
+        cmd.angleRef[PID_AXIS_PITCH] = (snap.stick[CHANNEL3_INDEX] - 0.5f) * 2.0f * FLIGHT_MAX_ANGLE_DEG;
+        cmd.angleRef[PID_AXIS_YAW] = 0.0f;
+        cmd.yawRate = (snap.stick[CHANNEL1_INDEX] - 0.5f) * 2.0f * FLIGHT_MAX_YAW_RATE;
+        // 姿态有效(已对准或估计器已收敛)之前不解锁
+        cmd.armed = (Motor_IsArmed() && !snap.failsafe && AttitudeSolver_IsValid()) ? 1 : 0;
+        for (i = 0; i < CHANNEL_COUNT; i++) {
+            cmd.rc[i] = snap.width[i];
+        }
+        // 电池状态按50Hz随指令带给角速度级，没有测量时不补偿
+        Battery_Get(&battery);
+        cmd.vbatScale = battery.valid ? Mixer_VbatScale(battery.voltage, battery.cells) : 1.0f;
+        cmd.cellVoltage = (battery.valid && (battery.cells > 0)) ? battery.voltage / (float)battery.cells : 0.0f;
+        cmd.vbat = battery.valid ? battery.voltage : 0.0f;
+        cmd.current = battery.valid ? battery.current : 0.0f;
+        tTopicPublish(&flightCommandTopic, &cmd);
+
+        // 黑匣子只记录可以输出油门的时段，每次进入时开始新的一段日志
+        if (cmd.armed != wasArmed) {
+            if (cmd.armed) {
+                Blackbox_Start();
+            } else {
+                Blackbox_Stop();
+            }
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+            tSetSysTickPeriod(cmd.armed ? FLIGHT_TICK_MS_FLIGHT : FLIGHT_TICK_MS_GROUND);
+#endif
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+            // 解锁期间全速运行，控制回路的耗时不受调频影响；上锁后由CPU利用率决定频率
+            if (cmd.armed) {
+                tClockBoostSet();
+            } else {
+                tClockBoostClear();
+            }
+#endif
+            wasArmed = cmd.armed;
+        }
+
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+        // 遥测只转发主题上的新数据，不再换算欧拉角
+        if (tTopicCopyNew(&attitudeSub, &attitude)) {
+            Ano_PublishAttitude(attitude.roll, attitude.pitch, attitude.yaw);
+        }
+        if (tTopicCopyNew(&imuSub, &imu)) {
+            Ano_PublishSensor(imu.accel[0], imu.accel[1], imu.accel[2], imu.gyro[0], imu.gyro[1], imu.gyro[2]);
+        }
+#endif
+
+        FlightPipeline_Record(FlightStageRx, tCycleCounterGet() - start);
+    }
+}
+
+/**
+ * @brief 后台日志：每秒输出各级的执行次数、平均及最长耗时、每次可用的周期数及CPU占用，第一次先输出启动耗时
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void FlightPipeline_LoggerEntry(void *param) {
+    static const char * const stageName[FlightStageCount] = {"rate", "attitude", "rx"};
+    FlightStageStat stat;
+    uint32_t lastWakeTick = tTaskTickGet();
+    uint32_t avg;
+    uint8_t bootReported = 0;
+    int i;
+
+    (void)param;
+    for (;;) {
+        tTaskDelayUntil(&lastWakeTick, tTimeMsToTicks(1000));
+        if (!bootReported) {
+            // 第一秒内第一个控制周期已完成，启动报告只输出一次
+            BootProfile_Print();
+            bootReported = 1;
+        }
+        for (i = 0; i < FlightStageCount; i++) {
+            FlightPipeline_GetStat((FlightStage)i, &stat);
+            avg = stat.count ? (uint32_t)(stat.totalCycles / stat.count) : 0;
+            printf("FLIGHT,%s,%u,%u,%u,%u,%u%%,%u\n", stageName[i],
+                   (unsigned)stat.count, (unsigned)avg, (unsigned)stat.maxCycles,
+                   (unsigned)stat.budgetCycles,
+                   (unsigned)(stat.budgetCycles ? (avg * 100u / stat.budgetCycles) : 0),
+                   (unsigned)stat.overruns);
+        }
+    }
+}
+
+// 上电对准：连续读取FLIGHT_ALIGN_SAMPLES次加速度求均值，静止时直接得出初始姿态；
+// 读取失败或有运动时不对准，由估计器自行收敛后才允许解锁。在采样任务启动之前调用，直接读取寄存器
+static void FlightPipeline_Align(void) {
+    MPU6050Sample sample;
+    float accel[3] = {0.0f, 0.0f, 0.0f};
+    uint32_t i, n = 0;
+
+    for (i = 0; i < FLIGHT_ALIGN_SAMPLES; i++) {
+        if (MPU6050_ReadSample(MPU6050_PRIMARY, &sample) != 0) {
+            continue;
+        }
+        accel[0] += sample.ax;
+        accel[1] += sample.ay;
+        accel[2] += sample.az;
+        n++;
+    }
+    if (n < FLIGHT_ALIGN_SAMPLES / 2) {
+        return;
+    }
+    for (i = 0; i < 3; i++) {
+        accel[i] /= (float)n;
+    }
+    (void)AttitudeSolver_Align(accel, (const float *)0); // 没有磁力计，偏航从0开始
+}
+
+void tInitApp(void) {
+    MPU6050Config config;
+
+    // 电调解锁等待最长，最先开始，与下面的传感器初始化及校准重叠
+    Motor_ArmAsync();
+    tCycleCounterInit();
+    LoopLatency_Init();
+    flightStat[FlightStageRate].budgetCycles = SystemCoreClock / FLIGHT_RATE_HZ;
+    flightStat[FlightStageAttitude].budgetCycles = SystemCoreClock / (FLIGHT_RATE_HZ / FLIGHT_ATTITUDE_DIV);
+    flightStat[FlightStageRx].budgetCycles = SystemCoreClock / (FLIGHT_RATE_HZ / FLIGHT_RX_DIV);
+
+    // 陀螺仪输出速率提高到角速度环频率，低通放宽到184Hz，群延迟约2ms
+    MPU6050_Init(MPU6050_PRIMARY);
+    MPU6050_GetConfig(MPU6050_PRIMARY, &config);
+    config.dlpf = MPU6050_DLPF_184HZ;
+    config.sampleRateHz = FLIGHT_RATE_HZ;
+    MPU6050_Configure(MPU6050_PRIMARY, &config);
+#if GYRO_FILTER_ENABLE == 1
+    // 滤波器的采样率为采样任务输出的速率，抽取时为抽取后的速率
+#if RPM_FILTER_ENABLE == 1
+    // 转速陷波已精确滤除电机噪声，去掉宽的低通以减小相位延迟，只在RPM_FILTER_LPF_HZ不为0时保留一节
+    (void)GyroFilter_InitNotches(&flightGyroFilter, (float)FLIGHT_RATE_HZ / MPU6050_SAMPLER_DECIMATION);
+    if (RPM_FILTER_LPF_HZ > 0.0f) {
+        (void)GyroFilter_AddLowPass(&flightGyroFilter, RPM_FILTER_LPF_HZ, 0.70710678f);
+    }
+#else
+    (void)GyroFilter_InitConfig(&flightGyroFilter, (float)FLIGHT_RATE_HZ / MPU6050_SAMPLER_DECIMATION);
+#endif
+#if DYN_NOTCH_ENABLE == 1
+    (void)DynNotch_Init((float)FLIGHT_RATE_HZ / MPU6050_SAMPLER_DECIMATION);
+#endif
+#endif
+#if RPM_FILTER_ENABLE == 1
+    RpmFilter_Init(&flightRpmFilter, (float)FLIGHT_RATE_HZ / MPU6050_SAMPLER_DECIMATION);
+#endif
+
+    // 姿态解算及校准、PID参数的恢复沿用AttitudePIDController，两级PID按各自的周期重新初始化后复制参数
+    AttitudePIDController_Init(&flightController);
+#if GYRO_CALIB_ENABLE == 1
+    {
+        // 上电时静止则以快速标定的零偏代替保存的值，之后由在线估计继续跟踪；有运动时沿用保存的值
+        GyroCalibResult calib;
+        if (GyroCalib_Capture(&calib) == GYRO_CALIB_OK) {
+            AttitudeSolver_SetGyroBias(calib.bias);
+        }
+    }
+#endif
+    FlightPipeline_Align();
+    PIDAxis3_Init(&flightAnglePID, (float)FLIGHT_ATTITUDE_DIV / FLIGHT_RATE_HZ, 0.0f);
+    PIDAxis3_Init(&flightRatePID, 1.0f / FLIGHT_RATE_HZ, PID_RATE_DERIV_CUTOFF_HZ);
+    FlightPipeline_CopyGains(&flightAnglePID, &flightController.attitudePID.angle);
+    FlightPipeline_CopyGains(&flightRatePID, &flightController.attitudePID.rate);
+#if GAIN_SCHEDULE_ENABLE == 1
+    GainSchedule_Init(&flightGainSchedule, &flightRatePID);
+#endif
+    TuneLink_Init(&flightAnglePID, &flightRatePID);
+
+    Receiver_Init();
+    Mixer_Init();
+    (void)EscTelemetry_Init(); // 未开启或初始化失败时转速陷波保持直通
+    (void)Battery_Init(); // 未开启时不补偿，记录及遥测中电压为0
+    (void)Blackbox_Init(); // 没有外部Flash时不记录
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+    Ano_TelemetryInit(ANO_FRAME_ATTITUDE);
+#endif
+
+    tTaskInit(&flightRateTask, FlightPipeline_RateEntry, (void *)0, FLIGHT_RATE_PRIO, flightRateStack, sizeof(flightRateStack));
+    tObjectSetName(&flightRateTask.object, "flightRate");
+    tTaskInit(&flightAttitudeTask, FlightPipeline_AttitudeEntry, (void *)0, FLIGHT_ATTITUDE_PRIO, flightAttitudeStack, sizeof(flightAttitudeStack));
+    tObjectSetName(&flightAttitudeTask.object, "flightAttitude");
+    tTaskInit(&flightRxTask, FlightPipeline_RxEntry, (void *)0, FLIGHT_RX_PRIO, flightRxStack, sizeof(flightRxStack));
+    tObjectSetName(&flightRxTask.object, "flightRx");
+    tTaskInit(&flightLoggerTask, FlightPipeline_LoggerEntry, (void *)0, FLIGHT_LOGGER_PRIO, flightLoggerStack, sizeof(flightLoggerStack));
+    tObjectSetName(&flightLoggerTask.object, "flightLog");
+
+    // 任务建好后再开数据就绪中断，第一个样本到来时角速度级已在等待
+    MPU6050_SamplerInit();
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __FLIGHTPIPELINE_H
+#define __FLIGHTPIPELINE_H
+
+#include <stdint.h>
+#include "tinyOS.h"
+
+// 多速率飞控任务链，开启TINYOS_ENABLE_FLIGHT后代替app.c中的演示任务：
+//   角速度环：每个陀螺仪样本(数据就绪中断驱动，1kHz)执行一次，姿态融合、内环PID、混控并写比较寄存器
+//   姿态环：角速度环每FLIGHT_ATTITUDE_DIV个样本以任务通知唤醒一次(250Hz)，外环PID得出角速度设定值
+//   接收机/遥测：每FLIGHT_RX_DIV个样本唤醒一次(50Hz)，读取接收机快照得出姿态设定值、油门及失控状态
+//   后台日志：每秒输出一次各级的耗时统计
+// 级间数据都经主题(tTopic)传递，高速级不会因低速级而阻塞，没有新数据时不复制；需开启TINYOS_ENABLE_SEM、
+// NOTIFY、TIMER及TOPIC，以及MPU6050_USE_HW_I2C或MPU6050_USE_SPI(数据就绪中断采样)
+#define FLIGHT_RATE_HZ          1000    // 陀螺仪输出速率，即角速度环频率
+#define FLIGHT_ATTITUDE_DIV     4       // 姿态环频率 = FLIGHT_RATE_HZ / FLIGHT_ATTITUDE_DIV
+#define FLIGHT_RX_DIV           20      // 接收机及遥测频率 = FLIGHT_RATE_HZ / FLIGHT_RX_DIV
+
+#define FLIGHT_RATE_PRIO        4       // 低于采样任务(0)及串行接收机解析任务
+#define FLIGHT_ATTITUDE_PRIO    5
+#define FLIGHT_RX_PRIO          6
+#define FLIGHT_LOGGER_PRIO      (TINYOS_PRIO_COUNT - 2)
+#define FLIGHT_STACK_SIZE       256     // 每个任务的栈(字)
+
+#define FLIGHT_MAX_ANGLE_DEG    30.0f   // 滚转、俯仰杆量满偏对应的角度(°)
+#define FLIGHT_MAX_YAW_RATE     3.5f    // 偏航杆量满偏对应的角速度(rad/s)
+#define FLIGHT_MIXER_SCALE      0.005f  // 内环PID输出(±100)换算为混控的三轴控制量
+#define FLIGHT_ALIGN_SAMPLES    32      // 上电对准时平均的加速度样本数，输出速率1kHz时约需15ms(每次读取约0.4ms，可能重复读到同一样本)
+
+// 开启TINYOS_ENABLE_TICK_SWITCH时，可以输出油门期间及在地面时的SysTick周期(ms)，
+// 取TINYOS_SYSTICK_MS为1时飞行中1ms节拍，地面上10ms节拍减少中断开销
+#define FLIGHT_TICK_MS_FLIGHT   TINYOS_SYSTICK_MS
+#define FLIGHT_TICK_MS_GROUND   10
+
+// 流水线的各级
+typedef enum _FlightStage {
+    FlightStageRate = 0,
+    FlightStageAttitude,
+    FlightStageRx,
+    FlightStageCount
+} FlightStage;
+
+// 一级的耗时统计(CPU周期)，budgetCycles为该级周期对应的周期数，平均耗时与之比值即为该级占用的CPU比例，
+// 比例最高的一级限制了可达到的回路频率
+typedef struct _FlightStageStat {
+    uint32_t count;         // 执行次数
+    uint32_t lastCycles;    // 最近一次耗时
+    uint32_t maxCycles;     // 最长耗时
+    uint64_t totalCycles;   // 累计耗时
+    uint32_t budgetCycles;  // 每次执行可用的周期数
+    uint32_t overruns;      // 耗时超过budgetCycles的次数
+} FlightStageStat;
+
+// flightImuTopic：角速度级每个样本发布一次扣除零偏、滤波后的惯性数据
+typedef struct _FlightImu {
+    uint32_t timeUs;        // 采样时刻(us)
+    float gyro[3];          // 角速度(rad/s)
+    float accel[3];         // 加速度(g)
+} FlightImu;
+
+// flightAttitudeTopic：姿态级每次执行发布一次外环使用的姿态角
+typedef struct _FlightAttitude {
+    float roll, pitch, yaw; // (°)
+} FlightAttitude;
+
+// 其它模块(日志、遥测等)订阅以下主题即可取得飞控数据，不需要再读姿态解算或传感器，也不增加角速度级的开销
+TINYOS_TOPIC_DECLARE(flightImuTopic);
+TINYOS_TOPIC_DECLARE(flightAttitudeTopic);
+
+void FlightPipeline_GetStat(FlightStage stage, FlightStageStat *stat); // 读取一级的耗时统计
+
+#endif // __FLIGHTPIPELINE_H
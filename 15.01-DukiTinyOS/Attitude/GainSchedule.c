@@ -0,0 +1,101 @@
+#include "GainSchedule.h"
+
+#if GAIN_SCHEDULE_ENABLE == 1
+
+#if (GAIN_SCHEDULE_THROTTLE_POINTS < 2) || (GAIN_SCHEDULE_CELL_POINTS < 2)
+#error "GAIN_SCHEDULE_THROTTLE_POINTS and GAIN_SCHEDULE_CELL_POINTS must be at least 2"
+#endif
+
+#include "AttitudeMath.h"
+
+// 网格坐标的换算系数，乘法代替除法
+#define GAIN_SCHEDULE_THROTTLE_SCALE    ((float)(GAIN_SCHEDULE_THROTTLE_POINTS - 1))
+#define GAIN_SCHEDULE_CELL_SCALE        ((float)(GAIN_SCHEDULE_CELL_POINTS - 1) / (GAIN_SCHEDULE_CELL_MAX - GAIN_SCHEDULE_CELL_MIN))
+
+// 相对基准参数的系数，三轴相同
+typedef struct _GainScheduleFactor {
+	float kp, ki, kd;
+}GainScheduleFactor;
+
+// 行为油门0、0.25、0.5、0.75、1，列为单节电压3.3、3.6、3.9、4.2V；基准参数在半油门、3.9V时整定(系数为1)。
+// 高油门及满电时力矩增益大，kp、kd减小以免振荡；怠速附近推力对转速不敏感，kp略增大；ki只随电压略作补偿
+static const GainScheduleFactor gainScheduleFactor[GAIN_SCHEDULE_THROTTLE_POINTS][GAIN_SCHEDULE_CELL_POINTS] = {
+	{{1.15f, 1.06f, 1.10f}, {1.10f, 1.04f, 1.06f}, {1.05f, 1.00f, 1.02f}, {1.00f, 0.97f, 0.98f}},
+	{{1.12f, 1.06f, 1.08f}, {1.07f, 1.04f, 1.04f}, {1.02f, 1.00f, 1.01f}, {0.97f, 0.97f, 0.96f}},
+	{{1.10f, 1.06f, 1.07f}, {1.05f, 1.04f, 1.03f}, {1.00f, 1.00f, 1.00f}, {0.95f, 0.97f, 0.95f}},
+	{{1.00f, 1.06f, 0.95f}, {0.95f, 1.04f, 0.90f}, {0.90f, 1.00f, 0.86f}, {0.86f, 0.97f, 0.82f}},
+	{{0.90f, 1.06f, 0.82f}, {0.86f, 1.04f, 0.78f}, {0.82f, 1.00f, 0.74f}, {0.78f, 0.97f, 0.70f}},
+};
+
+/**
+ * @brief 由基准参数预先算好各网格点的三轴参数，限幅不调度，沿用PIDAxis3中的值
+ *
+ * @param schedule 增益调度表
+ * @param base 基准参数，通常为刚设置过参数的内环PID
+ *
+ * @return void
+ */
+void GainSchedule_Init(GainSchedule *schedule, const PIDAxis3 *base) {
+	uint32_t t, v;
+	int axis;
+
+	for (t = 0; t < GAIN_SCHEDULE_THROTTLE_POINTS; t++) {
+		for (v = 0; v < GAIN_SCHEDULE_CELL_POINTS; v++) {
+			const GainScheduleFactor *f = &gainScheduleFactor[t][v];
+			GainScheduleCell *c = &schedule->cell[t][v];
+
+			for (axis = 0; axis < PID_AXIS_COUNT; axis++) {
+				c->kp[axis] = base->kp[axis] * f->kp;
+				c->ki[axis] = base->ki[axis] * f->ki;
+				c->kd[axis] = base->kd[axis] * f->kd;
+			}
+		}
+	}
+}
+
+/**
+ * @brief 按油门及单节电压双线性插值，结果直接写入pid的kp/ki/kd，积分等状态不变
+ *        油门及电压连续变化时参数也连续变化，不会在网格线上跳变
+ *
+ * @param schedule 增益调度表
+ * @param pid 内环PID
+ * @param throttle 油门(0 ~ 1)
+ * @param cellVoltage 单节电压(V)，不大于0时按GAIN_SCHEDULE_CELL_NOMINAL
+ *
+ * @return void
+ */
+void GainSchedule_Apply(const GainSchedule *schedule, PIDAxis3 *pid, float throttle, float cellVoltage) {
+	float x, y, fx, fy, w00, w01, w10, w11;
+	const GainScheduleCell *c00, *c01, *c10, *c11;
+	uint32_t t, v;
+	int axis;
+
+	if (!(cellVoltage > 0.0f)) {
+		cellVoltage = GAIN_SCHEDULE_CELL_NOMINAL;
+	}
+	x = AttitudeClamp(throttle * GAIN_SCHEDULE_THROTTLE_SCALE, 0.0f, GAIN_SCHEDULE_THROTTLE_SCALE);
+	y = AttitudeClamp((cellVoltage - GAIN_SCHEDULE_CELL_MIN) * GAIN_SCHEDULE_CELL_SCALE, 0.0f, (float)(GAIN_SCHEDULE_CELL_POINTS - 1));
+	// 落在上边界时取最后一格，插值系数为1
+	t = (uint32_t)x;
+	v = (uint32_t)y;
+	t = (t > GAIN_SCHEDULE_THROTTLE_POINTS - 2) ? (GAIN_SCHEDULE_THROTTLE_POINTS - 2) : t;
+	v = (v > GAIN_SCHEDULE_CELL_POINTS - 2) ? (GAIN_SCHEDULE_CELL_POINTS - 2) : v;
+	fx = x - (float)t;
+	fy = y - (float)v;
+	w11 = fx * fy;
+	w10 = fx - w11;
+	w01 = fy - w11;
+	w00 = 1.0f - fx - fy + w11;
+
+	c00 = &schedule->cell[t][v];
+	c01 = &schedule->cell[t][v + 1];
+	c10 = &schedule->cell[t + 1][v];
+	c11 = &schedule->cell[t + 1][v + 1];
+	for (axis = 0; axis < PID_AXIS_COUNT; axis++) {
+		pid->kp[axis] = w00 * c00->kp[axis] + w01 * c01->kp[axis] + w10 * c10->kp[axis] + w11 * c11->kp[axis];
+		pid->ki[axis] = w00 * c00->ki[axis] + w01 * c01->ki[axis] + w10 * c10->ki[axis] + w11 * c11->ki[axis];
+		pid->kd[axis] = w00 * c00->kd[axis] + w01 * c01->kd[axis] + w10 * c10->kd[axis] + w11 * c11->kd[axis];
+	}
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __GAINSCHEDULE_H
+#define __GAINSCHEDULE_H
+
+#include <stdint.h>
+#include "PID.h"
+
+// 增益调度：油门越高、电池电压越高，同样的控制量产生的力矩越大，固定参数只能在整个油门范围内折中。
+// 按油门及单节电压两个维度的网格给出kp、ki、kd相对基准参数的系数(GainSchedule.c中的常量表)，
+// 初始化及基准参数改变(如在线调参)时把系数乘上基准参数，预先算好每个网格点的三轴参数；
+// 角速度级每个周期按当前油门及电压双线性插值，直接写入PIDAxis3的kp/ki/kd，热路径上只有定位及36次乘加。
+// 网格等间距，格点位置由乘法得出，不查找；只调度内环，外环(角度 -> 角速度)与推力无关
+#define GAIN_SCHEDULE_ENABLE            0
+#define GAIN_SCHEDULE_THROTTLE_POINTS   5       // 油门网格点数，0 ~ 1等分
+#define GAIN_SCHEDULE_CELL_POINTS       4       // 单节电压网格点数，GAIN_SCHEDULE_CELL_MIN ~ MAX等分
+#define GAIN_SCHEDULE_CELL_MIN          3.3f    // 单节电压范围(V)，超出范围时取边界上的参数
+#define GAIN_SCHEDULE_CELL_MAX          4.2f
+#define GAIN_SCHEDULE_CELL_NOMINAL      3.9f    // 没有电压测量时使用的单节电压
+
+// 一个网格点的三轴参数
+typedef struct _GainScheduleCell {
+	float kp[PID_AXIS_COUNT], ki[PID_AXIS_COUNT], kd[PID_AXIS_COUNT];
+}GainScheduleCell;
+
+typedef struct _GainSchedule {
+	GainScheduleCell cell[GAIN_SCHEDULE_THROTTLE_POINTS][GAIN_SCHEDULE_CELL_POINTS];
+}GainSchedule;
+
+#if GAIN_SCHEDULE_ENABLE == 1
+void GainSchedule_Init(GainSchedule *schedule, const PIDAxis3 *base);  // 由基准参数预先算好各网格点的参数，基准参数改变时重新调用
+void GainSchedule_Apply(const GainSchedule *schedule, PIDAxis3 *pid, float throttle, float cellVoltage); // 每个周期在PIDAxis3_Calc之前调用
+#endif
+
+#endif
@@ -1,258 +1,259 @@
-//ps:本篇代码完全来自于wjy
+//ps:模型与迭代方法来自于wjy的离线版本，改为单精度、流式累加及Cholesky求解以便在目标板上运行
 #include "GaussNewton.h"
+#include "AttitudeMath.h"
+#include <string.h>
 
-// 全局变量定义
-double V[M][3];   // 实际输出矩阵
-double K[3][3];   // 比例误差矩阵
-double A[M][3];   // 理想输出矩阵
-double B[3];      // 零漂误差矩阵
-double P[6];      // 参数矩阵
-double e[M];      // 误差矩阵
+// 矩向量w及换算后的d = [1, dx, dy, dz, dx^2, dy^2, dz^2]中各项的位置，d_k = v_k - offset_k
+#define CALIB_W         7
+#define CALIB_LIN(k)    (1 + (k))
+#define CALIB_SQ(k)     (4 + (k))
+#define CALIB_N         6   // 参数个数：P[0..2]为比例，P[3..5]为零偏
 
-/**
- * @brief 打印矩阵
- * @param matrix 待打印的矩阵
- * @param n 矩阵大小（n x n）
- */
-void printMatrix(double matrix[M][M], int n) {
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            printf("%lf ", matrix[i][j]);
-        }
-        printf("\n");
-    }
+// 线搜索最多折半的次数，没有一步能降低代价时视为已到极小点
+#define CALIB_BACKTRACK 6
+
+void AccelCalib_Init(AccelCalib *cal) {
+    memset(cal, 0, sizeof(AccelCalib));
 }
 
-/**
- * @brief 计算残差
- * @param V 实际输出矩阵
- * @param e 残差矩阵
- * @param P 参数矩阵
- */
-void computeResiduals(double V[M][3], double e[M], double P[6]) {
-    for (int i = 0; i < M; i++) {
-        e[i] = (V[i][0] - P[3]) * (V[i][0] - P[3]) * P[0] * P[0] +
-               (V[i][1] - P[4]) * (V[i][1] - P[4]) * P[1] * P[1] +
-               (V[i][2] - P[5]) * (V[i][2] - P[5]) * P[2] * P[2] - 1.0f;
+void AccelCalib_AddSample(AccelCalib *cal, float ax, float ay, float az) {
+    float w[CALIB_W];
+    int i, j;
+
+    w[0] = 1.0f;
+    w[1] = ax; w[2] = ay; w[3] = az;
+    w[4] = ax * ax; w[5] = ay * ay; w[6] = az * az;
+    for (i = 0; i < CALIB_W; i++) {
+        for (j = i; j < CALIB_W; j++) {
+            cal->moment[i][j] += w[i] * w[j];
+        }
     }
+    cal->count++;
 }
 
 /**
- * @brief 计算雅可比矩阵
- * @param A 理想输出矩阵
- * @param J 雅可比矩阵
- * @param P 参数矩阵
+ * @brief 由原始矩W换算当前零偏下的矩D = T W T^T，d = T w
+ *
+ * @param W 原始矩(完整对称矩阵，已按样本数归一化)
+ * @param offset 零偏
+ * @param D 输出的矩
+ *
+ * @return void
  */
-void computeJacobian(double A[M][3], double J[M][M], double P[M]) {
-    for (int i = 0; i < M; i++) {
-        J[i][0] = 2 * P[0] * (V[i][0] - P[3]) * (V[i][0] - P[3]);
-        J[i][1] = 2 * P[1] * (V[i][1] - P[4]) * (V[i][1] - P[4]);
-        J[i][2] = 2 * P[2] * (V[i][2] - P[5]) * (V[i][2] - P[5]);
-        J[i][3] = -2 * P[0] * P[0] * (V[i][0] - P[3]);
-        J[i][4] = -2 * P[1] * P[1] * (V[i][1] - P[4]);
-        J[i][5] = -2 * P[2] * P[2] * (V[i][2] - P[5]);
+static void AccelCalib_ShiftMoments(float W[CALIB_W][CALIB_W], const float *offset, float D[CALIB_W][CALIB_W]) {
+    float T[CALIB_W][CALIB_W];
+    float TW[CALIB_W][CALIB_W];
+    int i, j, k;
+
+    // d_k = v_k - o_k，d_k^2 = v_k^2 - 2 o_k v_k + o_k^2
+    memset(T, 0, sizeof(T));
+    T[0][0] = 1.0f;
+    for (k = 0; k < 3; k++) {
+        T[CALIB_LIN(k)][0] = -offset[k];
+        T[CALIB_LIN(k)][CALIB_LIN(k)] = 1.0f;
+        T[CALIB_SQ(k)][0] = offset[k] * offset[k];
+        T[CALIB_SQ(k)][CALIB_LIN(k)] = -2.0f * offset[k];
+        T[CALIB_SQ(k)][CALIB_SQ(k)] = 1.0f;
     }
-}
 
-/**
- * @brief 计算矩阵的逆矩阵
- * @param matrix 原始矩阵
- * @param inverse 存储逆矩阵
- * @param n 矩阵大小
- * @return 1: 成功, 0: 失败（不可逆）
- */
-int inverseMatrix(double matrix[M][M], double inverse[M][M], int n) {
-    double augmented[M][2 * M];
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            augmented[i][j] = matrix[i][j];
-        }
-        for (int j = 0; j < n; j++) {
-            augmented[i][j + n] = (i == j) ? 1 : 0;  // 单位矩阵
+    for (i = 0; i < CALIB_W; i++) {
+        for (j = 0; j < CALIB_W; j++) {
+            float sum = 0.0f;
+            for (k = 0; k < CALIB_W; k++) {
+                sum += T[i][k] * W[k][j];
+            }
+            TW[i][j] = sum;
         }
     }
-
-    for (int i = 0; i < n; i++) {
-        double MEl = fabs(augmented[i][i]);
-        int MRow = i;
-        for (int k = i + 1; k < n; k++) {
-            if (fabs(augmented[k][i]) > MEl) {
-                MEl = fabs(augmented[k][i]);
-                MRow = k;
+    for (i = 0; i < CALIB_W; i++) {
+        for (j = i; j < CALIB_W; j++) {
+            float sum = 0.0f;
+            for (k = 0; k < CALIB_W; k++) {
+                sum += TW[i][k] * T[j][k];
             }
+            D[i][j] = sum;
+            D[j][i] = sum;
         }
+    }
+}
+
+// 残差e = h^T d，h = [-1, 0, 0, 0, s_x^2, s_y^2, s_z^2]
+static void AccelCalib_ResidualVector(const float *P, float *h) {
+    int k;
+
+    h[0] = -1.0f;
+    for (k = 0; k < 3; k++) {
+        h[CALIB_LIN(k)] = 0.0f;
+        h[CALIB_SQ(k)] = P[k] * P[k];
+    }
+}
 
-        for (int k = i; k < 2 * n; k++) {
-            double tmp = augmented[MRow][k];
-            augmented[MRow][k] = augmented[i][k];
-            augmented[i][k] = tmp;
+// 均方残差h^T D h
+static float AccelCalib_Cost(float W[CALIB_W][CALIB_W], const float *P) {
+    float D[CALIB_W][CALIB_W];
+    float h[CALIB_W];
+    float cost = 0.0f;
+    int i, j;
+
+    AccelCalib_ShiftMoments(W, &P[3], D);
+    AccelCalib_ResidualVector(P, h);
+    for (i = 0; i < CALIB_W; i++) {
+        for (j = 0; j < CALIB_W; j++) {
+            cost += h[i] * D[i][j] * h[j];
         }
+    }
+    return cost;
+}
 
-        double divisor = augmented[i][i];
-        if (divisor == 0) {
-            return 0;
+/**
+ * @brief 6x6对称正定方程组A x = b的Cholesky解法，A在原处分解为下三角L
+ *
+ * @param A 系数矩阵，返回时下三角为L
+ * @param b 右端项，返回时为解x
+ *
+ * @return uint8_t 0：成功，1：矩阵非正定(样本姿态不够分散)
+ */
+static uint8_t AccelCalib_Cholesky(float A[CALIB_N][CALIB_N], float *b) {
+    int i, j, k;
+
+    for (j = 0; j < CALIB_N; j++) {
+        float diag = A[j][j];
+        for (k = 0; k < j; k++) {
+            diag -= A[j][k] * A[j][k];
         }
-        for (int k = 0; k < 2 * n; k++) {
-            augmented[i][k] /= divisor;
+        if (!(diag > 1e-12f)) {
+            return 1;
         }
-
-        for (int k = 0; k < n; k++) {
-            if (k != i) {
-                double factor = augmented[k][i];
-                for (int j = 0; j < 2 * n; j++) {
-                    augmented[k][j] -= factor * augmented[i][j];
-                }
+        A[j][j] = ATTITUDE_SQRTF(diag);
+        for (i = j + 1; i < CALIB_N; i++) {
+            float sum = A[i][j];
+            for (k = 0; k < j; k++) {
+                sum -= A[i][k] * A[j][k];
             }
+            A[i][j] = sum / A[j][j];
         }
     }
 
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            inverse[i][j] = augmented[i][j + n];
+    // L y = b，L^T x = y
+    for (i = 0; i < CALIB_N; i++) {
+        for (k = 0; k < i; k++) {
+            b[i] -= A[i][k] * b[k];
         }
+        b[i] /= A[i][i];
     }
-
-    return 1;
+    for (i = CALIB_N - 1; i >= 0; i--) {
+        for (k = i + 1; k < CALIB_N; k++) {
+            b[i] -= A[k][i] * b[k];
+        }
+        b[i] /= A[i][i];
+    }
+    return 0;
 }
 
 /**
- * @brief 高斯牛顿迭代校准传感器
+ * @brief 高斯牛顿迭代拟合加速度计校准参数，从比例1、零偏0出发，每步带折半线搜索
+ *        雅可比J = G d，G每行只有一个非零元：∂e/∂s_k = 2 s_k d_k^2，∂e/∂o_k = -2 s_k^2 d_k，
+ *        因此J^T J[i][j] = g_i g_j D[c_i][c_j]，J^T e[i] = g_i (D h)[c_i]
+ *
+ * @param cal 累加的数据，返回时写入残差及迭代次数
+ * @param result 成功时写入拟合的参数
+ *
+ * @return uint8_t 0：成功，1：失败，result不变
  */
-void gaussNewtonCalibration() {
-    double J[M][M];
-    double J_T[M][M];
-    double J_T_Mul_J[M][M];
-    double J_T_Mul_J_N[M][M];
-    double J_T_Mul_e[M];
-    double unname[M];
-    double delt = 0;
-
-    while (1) {
-        delt = 0;
-        memset(J, 0, sizeof(J));
-        memset(J_T, 0, sizeof(J_T));
-        memset(J_T_Mul_J, 0, sizeof(J_T_Mul_J));
-        memset(J_T_Mul_J_N, 0, sizeof(J_T_Mul_J_N));
-        memset(J_T_Mul_e, 0, sizeof(J_T_Mul_e));
-        memset(unname, 0, sizeof(unname));
-
-        computeResiduals(V, e, P);
-        computeJacobian(A, J, P);
+uint8_t AccelCalib_Solve(AccelCalib *cal, MPU6050AccelCalib *result) {
+    float W[CALIB_W][CALIB_W];
+    float D[CALIB_W][CALIB_W];
+    float JtJ[CALIB_N][CALIB_N];
+    float Jte[CALIB_N];
+    float P[CALIB_N] = {1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+    float h[CALIB_W], Dh[CALIB_W];
+    float gval[CALIB_N];
+    int col[CALIB_N];
+    float scale, cost;
+    uint32_t iter;
+    uint8_t converged = 0;
+    int i, j, k;
+
+    if (cal->count < ACCEL_CALIB_MIN_SAMPLES) {
+        return 1;
+    }
 
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < M; j++) {
-                J_T[j][i] = J[i][j];
-            }
+    // 按样本数归一化，代价即为均方残差，数值量级与样本数无关
+    scale = 1.0f / (float)cal->count;
+    for (i = 0; i < CALIB_W; i++) {
+        for (j = i; j < CALIB_W; j++) {
+            W[i][j] = cal->moment[i][j] * scale;
+            W[j][i] = W[i][j];
         }
+    }
+    for (k = 0; k < 3; k++) {
+        col[k] = CALIB_SQ(k);
+        col[3 + k] = CALIB_LIN(k);
+    }
 
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < M; j++) {
-                for (int k = 0; k < M; k++) {
-                    J_T_Mul_J[i][j] += J_T[i][k] * J[k][j];
-                }
+    cost = AccelCalib_Cost(W, P);
+    for (iter = 0; iter < ACCEL_CALIB_MAX_ITER; iter++) {
+        float step = 1.0f;
+        float delta2 = 0.0f;
+        float trial[CALIB_N];
+        float trialCost = cost;
+
+        AccelCalib_ShiftMoments(W, &P[3], D);
+        AccelCalib_ResidualVector(P, h);
+        for (i = 0; i < CALIB_W; i++) {
+            float sum = 0.0f;
+            for (j = 0; j < CALIB_W; j++) {
+                sum += D[i][j] * h[j];
             }
+            Dh[i] = sum;
         }
-
-        if (!inverseMatrix(J_T_Mul_J, J_T_Mul_J_N, M)) {
-            printf("矩阵不可逆\n");
-            break;
+        for (k = 0; k < 3; k++) {
+            gval[k] = 2.0f * P[k];
+            gval[3 + k] = -2.0f * P[k] * P[k];
         }
-
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < M; j++) {
-                J_T_Mul_e[i] += J_T[i][j] * e[j];
+        for (i = 0; i < CALIB_N; i++) {
+            for (j = 0; j < CALIB_N; j++) {
+                JtJ[i][j] = gval[i] * gval[j] * D[col[i]][col[j]];
             }
+            Jte[i] = gval[i] * Dh[col[i]];
         }
-
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < M; j++) {
-                unname[i] += J_T_Mul_J_N[i][j] * J_T_Mul_e[j];
-            }
+        if (AccelCalib_Cholesky(JtJ, Jte) != 0) {
+            return 1;
         }
 
-        for (int i = 0; i < M; i++) {
-            P[i] -= unname[i] * 0.01;
+        for (i = 0; i < CALIB_N; i++) {
+            delta2 += Jte[i] * Jte[i];
         }
-
-        for (int i = 0; i < M; i++) {
-            delt += unname[i] * unname[i];
+        for (k = 0; k < CALIB_BACKTRACK; k++, step *= 0.5f) {
+            for (i = 0; i < CALIB_N; i++) {
+                trial[i] = P[i] - step * Jte[i];
+            }
+            trialCost = AccelCalib_Cost(W, trial);
+            if (trialCost <= cost) {
+                break;
+            }
         }
-
-        if (delt < ThreshodValue) {
-            K[0][0] = P[0];
-            K[1][1] = P[1];
-            K[2][2] = P[2];
-            B[0] = P[3];
-            B[1] = P[4];
-            B[2] = P[5];
+        if (k == CALIB_BACKTRACK) {
+            converged = 1;  // 任何步长都不能再降低代价，已在极小点
+            break;
+        }
+        memcpy(P, trial, sizeof(P));
+        cost = trialCost;
+        if (delta2 * step * step < ACCEL_CALIB_TOL) {
+            converged = 1;
+            iter++;
             break;
         }
     }
-}
-
-///*单独作为一个程序跑，放在在项目里就把main注释了*/
-
-//int main(){
-//    // 写入6组实际值和理想值V和A
-//    // 平放
-
-//    V[0][0]=-0.01;
-//    V[0][1]=0.00;
-//    V[0][2]=1.52;
-//    A[0][0]=0;
-//    A[0][1]=0;
-//    A[0][2]=1;
-
-//    //倒立
-//    V[1][0]=0.11;
-//    V[1][1]=-0.04;
-//    V[1][2]=-0.50;
-//    A[1][0]=0;
-//    A[1][1]=0;
-//    A[1][2]=-1;
-
-//    //左倾
-//    V[2][0]=0.09;
-//    V[2][1]=-1.00;
-//    V[2][2]=0.41;
-//    A[2][0]=0;
-//    A[2][1]=-1;
-//    A[2][2]=0;
 
-//    //右倾
-//    V[3][0]=0.02;
-//    V[3][1]=0.98;
-//    V[3][2]=0.52;
-//    A[3][0]=0;
-//    A[3][1]=1;
-//    A[3][2]=0;
-
-//    //前扑
-//    V[4][0]=-0.96;
-//    V[4][1]=-0.03;
-//    V[4][2]=0.50;
-//    A[4][0]=-1;
-//    A[4][1]=0;
-//    A[4][2]=0;
-
-//    //后仰
-//    V[5][0]=1.01;
-//    V[5][1]=0.22;
-//    V[5][2]=0.51;
-//    A[5][0]=1;
-//    A[5][1]=0;
-//    A[5][2]=0;
-
-//    //手动输入一组P值
-//    P[0]=1;
-//    P[1]=0.98;
-//    P[2]=0.956;
-//    P[3]=0.04;
-//    P[4]=-0.012;
-//    P[5]=-0.075;
-
-//    gaussNewtonCalibration();
-//    for(int r=0;r<6;r++){
-//        printf("#define\tP%d\t%f\n",r,P[r]);
-//    }
-//}
\ No newline at end of file
+    cal->iterations = iter;
+    cal->residual = ATTITUDE_SQRTF((cost > 0.0f) ? cost : 0.0f);
+    if (!converged || !(P[0] > 0.0f) || !(P[1] > 0.0f) || !(P[2] > 0.0f)) {
+        return 1;
+    }
+    for (k = 0; k < 3; k++) {
+        result->scale[k] = P[k];
+        result->offset[k] = P[3 + k];
+    }
+    return 0;
+}
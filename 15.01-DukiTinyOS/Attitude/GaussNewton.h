@@ -1,29 +1,29 @@
 #ifndef __GAUSSNEWTON_H
 #define __GAUSSNEWTON_H
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
+#include <stdint.h>
+#include "MPU6050.h"
 
-// 定义常量
-#define M 6                          // 数据组数
-#define g 1.0                        // 加速度标准值
-#define ThreshodValue 0.000001       // 迭代停止的阈值
+// 加速度计六参数校准：模型为Σ(scale_k (v_k - offset_k))^2 = 1，单精度高斯牛顿迭代在目标板上完成
+// 残差及雅可比都是(v - offset)的二次多项式，J^T J与J^T e可由原始数据至多四阶的矩换算得出，
+// 因此样本逐个累加进7x7的矩矩阵即可，样本数不限且不需要保存；每次迭代只做7x7矩阵乘法和6x6 Cholesky分解
+//
+// 用法：MPU6050_SetAccelCalib(dev, NULL)取消该IMU现有的校准，AccelCalib_Init后在多个不同姿态下(至少六面朝上)静止采样，
+// 每个样本调用AccelCalib_AddSample，AccelCalib_Solve成功后把结果交给MPU6050_SetAccelCalib并保存
+#define ACCEL_CALIB_MIN_SAMPLES 6       // 求解所需的最少样本数
+#define ACCEL_CALIB_MAX_ITER    20      // 最大迭代次数
+#define ACCEL_CALIB_TOL         1e-10f  // 参数增量的平方和小于该值时视为收敛
 
-// 数据矩阵定义
-extern double V[M][3];               // 实际输出
-extern double K[3][3];               // 比例误差矩阵
-extern double A[M][3];               // 理想输出
-extern double B[3];                  // 零漂误差
-extern double P[6];                  // 参数矩阵
-extern double e[M];                  // 误差矩阵
+// 流式累加的校准数据
+typedef struct _AccelCalib {
+    float moment[7][7];     // Σ w w^T，w = [1, vx, vy, vz, vx^2, vy^2, vz^2]，只累加上三角
+    uint32_t count;         // 样本数
+    float residual;         // 求解后的均方根残差(|v|^2 - 1)
+    uint32_t iterations;    // 求解用的迭代次数
+} AccelCalib;
 
-// 函数声明
-void printMatrix(double matrix[M][M], int n);  // 打印矩阵
-void computeResiduals(double V[M][3], double e[M], double P[6]); // 计算残差
-void computeJacobian(double A[M][3], double J[M][M], double P[M]); // 计算雅可比矩阵
-int inverseMatrix(double matrix[M][M], double inverse[M][M], int n); // 计算矩阵逆
-void gaussNewtonCalibration();  // 高斯牛顿校准主函数
+void AccelCalib_Init(AccelCalib *cal);                                      // 清空累加的数据
+void AccelCalib_AddSample(AccelCalib *cal, float ax, float ay, float az);   // 累加一个未校准的样本(g)
+uint8_t AccelCalib_Solve(AccelCalib *cal, MPU6050AccelCalib *result);       // 拟合校准参数，返回0成功，1失败(样本不足、姿态不够分散或不收敛)
 
 #endif
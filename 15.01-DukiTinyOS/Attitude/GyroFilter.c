@@ -0,0 +1,228 @@
+#include "GyroFilter.h"
+#include "AttitudeMath.h"
+
+#if (GYRO_FILTER_NOTCH_COUNT + GYRO_FILTER_LPF_ORDER / 2) > GYRO_FILTER_MAX_STAGES
+#error "GYRO_FILTER_NOTCH_COUNT and GYRO_FILTER_LPF_ORDER need more than GYRO_FILTER_MAX_STAGES stages"
+#endif
+#if (GYRO_FILTER_LPF_ORDER != 0) && (GYRO_FILTER_LPF_ORDER != 2) && (GYRO_FILTER_LPF_ORDER != 4)
+#error "GYRO_FILTER_LPF_ORDER must be 0, 2 or 4"
+#endif
+
+// 由RBJ音频均衡器公式的分子b0 ~ b2及cos(w0)、alpha写入一节的系数，按a0归一化并对a1、a2取负
+static void GyroFilter_SetCoeffs(float *c, float b0, float b1, float b2, float cosW, float alpha) {
+	float invA0 = 1.0f / (1.0f + alpha);
+
+	c[0] = b0 * invA0;
+	c[1] = b1 * invA0;
+	c[2] = b2 * invA0;
+	c[3] = 2.0f * cosW * invA0;
+	c[4] = (alpha - 1.0f) * invA0;
+}
+
+// 陷波系数：零点在单位圆上的中心频率处，极点半径由Q决定
+static uint8_t GyroFilter_NotchCoeffs(const GyroFilter *filter, float *c, float centerHz, float q) {
+	float w0, cosW;
+
+	if ((centerHz <= 0.0f) || (centerHz >= filter->sampleHz * 0.5f) || (q <= 0.0f)) {
+		return 1;
+	}
+	w0 = 2.0f * ATTITUDE_PI * centerHz / filter->sampleHz;
+	cosW = cosf(w0);
+	GyroFilter_NotchFromTrig(c, cosW, sinf(w0), q);
+	return 0;
+}
+
+/**
+ * @brief 由中心频率处的cos(w0)、sin(w0)直接写入一节陷波的系数，w0 = 2π * 中心频率 / 采样率
+ *
+ * 每个样本要改写很多节陷波时(如按电机转速的各次谐波)，调用者可以用递推得到各频率的三角函数，省去cosf、sinf。
+ *
+ * @param c 一节的系数{b0, b1, b2, -a1, -a2}
+ * @param cosW cos(w0)
+ * @param sinW sin(w0)，w0在(0, π)内时为正
+ * @param q 品质因数
+ *
+ * @return void
+ */
+void GyroFilter_NotchFromTrig(float *c, float cosW, float sinW, float q) {
+	GyroFilter_SetCoeffs(c, 1.0f, -2.0f * cosW, 1.0f, cosW, sinW / (2.0f * q));
+}
+
+void GyroFilter_Init(GyroFilter *filter, float sampleHz) {
+	filter->stageCount = 0;
+	filter->sampleHz = sampleHz;
+	GyroFilter_Reset(filter);
+}
+
+/**
+ * @brief 按GyroFilter.h中的默认配置初始化：GYRO_FILTER_NOTCH_COUNT个陷波依次为第0节起，之后为低通
+ *
+ * @param filter 滤波器
+ * @param sampleHz 陀螺仪样本的输出频率(Hz)
+ *
+ * @return uint8_t 0成功；1有频率不低于采样率的一半，该节及之后的节未加入
+ */
+uint8_t GyroFilter_InitConfig(GyroFilter *filter, float sampleHz) {
+	if (GyroFilter_InitNotches(filter, sampleHz) != 0) {
+		return 1;
+	}
+#if GYRO_FILTER_LPF_ORDER == 2
+	return GyroFilter_AddLowPass(filter, GYRO_FILTER_LPF_HZ, 0.70710678f);
+#elif GYRO_FILTER_LPF_ORDER == 4
+	// 四阶巴特沃斯分为两节，Q分别为1 / (2cos(22.5°))及1 / (2cos(67.5°))
+	if (GyroFilter_AddLowPass(filter, GYRO_FILTER_LPF_HZ, 0.54119610f) != 0) {
+		return 1;
+	}
+	return GyroFilter_AddLowPass(filter, GYRO_FILTER_LPF_HZ, 1.30656296f);
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief 只按默认配置加入GYRO_FILTER_NOTCH_COUNT个陷波，不加低通，由调用者决定是否另加低通
+ *
+ * @param filter 滤波器
+ * @param sampleHz 陀螺仪样本的输出频率(Hz)
+ *
+ * @return uint8_t 0成功；1有频率不低于采样率的一半，该节及之后的节未加入
+ */
+uint8_t GyroFilter_InitNotches(GyroFilter *filter, float sampleHz) {
+	uint32_t i;
+
+	GyroFilter_Init(filter, sampleHz);
+	for (i = 0; i < GYRO_FILTER_NOTCH_COUNT; i++) {
+		if (GyroFilter_AddNotch(filter, GYRO_FILTER_NOTCH_HZ * (float)(i + 1), GYRO_FILTER_NOTCH_Q) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief 追加一节二阶低通，截止频率处衰减3dB
+ *
+ * @param filter 滤波器
+ * @param cutoffHz 截止频率(Hz)，需低于采样率的一半
+ * @param q 品质因数，0.7071为巴特沃斯(通带最平)
+ *
+ * @return uint8_t 0成功；1节数已满或参数无效
+ */
+uint8_t GyroFilter_AddLowPass(GyroFilter *filter, float cutoffHz, float q) {
+	float w0, cosW;
+	float *c;
+
+	if ((filter->stageCount >= GYRO_FILTER_MAX_STAGES) || (cutoffHz <= 0.0f)
+		|| (cutoffHz >= filter->sampleHz * 0.5f) || (q <= 0.0f)) {
+		return 1;
+	}
+	c = filter->coeffs[filter->stageCount];
+	w0 = 2.0f * ATTITUDE_PI * cutoffHz / filter->sampleHz;
+	cosW = cosf(w0);
+	GyroFilter_SetCoeffs(c, (1.0f - cosW) * 0.5f, 1.0f - cosW, (1.0f - cosW) * 0.5f, cosW, sinf(w0) / (2.0f * q));
+	filter->stageCount++;
+	return 0;
+}
+
+/**
+ * @brief 追加一节陷波，中心频率处增益为0
+ *
+ * @param filter 滤波器
+ * @param centerHz 中心频率(Hz)，需低于采样率的一半
+ * @param q 品质因数，-3dB带宽为centerHz / q
+ *
+ * @return uint8_t 0成功；1节数已满或参数无效
+ */
+uint8_t GyroFilter_AddNotch(GyroFilter *filter, float centerHz, float q) {
+	if (filter->stageCount >= GYRO_FILTER_MAX_STAGES) {
+		return 1;
+	}
+	if (GyroFilter_NotchCoeffs(filter, filter->coeffs[filter->stageCount], centerHz, q) != 0) {
+		return 1;
+	}
+	filter->stageCount++;
+	return 0;
+}
+
+/**
+ * @brief 改变一节的中心频率，该节改为陷波；状态不清零，频率变化不大时输出没有跳变
+ *
+ * 系数在GyroFilter_Apply之间整体改写，须与GyroFilter_Apply在同一任务中调用。
+ *
+ * @param filter 滤波器
+ * @param stage 节的序号，按加入的顺序从0开始
+ * @param centerHz 中心频率(Hz)
+ * @param q 品质因数
+ *
+ * @return uint8_t 0成功；1序号或参数无效，系数不变
+ */
+uint8_t GyroFilter_SetNotch(GyroFilter *filter, uint32_t stage, float centerHz, float q) {
+	if (stage >= filter->stageCount) {
+		return 1;
+	}
+	return GyroFilter_NotchCoeffs(filter, filter->coeffs[stage], centerHz, q);
+}
+
+void GyroFilter_Reset(GyroFilter *filter) {
+	uint32_t i, axis;
+
+	for (i = 0; i < GYRO_FILTER_MAX_STAGES; i++) {
+		for (axis = 0; axis < GYRO_FILTER_AXIS_COUNT; axis++) {
+			filter->state[i][axis][0] = 0.0f;
+			filter->state[i][axis][1] = 0.0f;
+		}
+	}
+}
+
+/**
+ * @brief 滤波一个三轴样本，每个陀螺仪样本调用一次
+ *
+ * @param filter 滤波器
+ * @param gyro 三轴角速度，滤波后的值写回
+ *
+ * @return void
+ */
+void GyroFilter_Apply(GyroFilter *filter, float *gyro) {
+	GyroFilter_ApplyStages(filter->coeffs, filter->state, filter->stageCount, gyro);
+}
+
+/**
+ * @brief 按给定的系数及状态数组级联滤波一个三轴样本，GyroFilter及其它节数不同的滤波器组共用
+ *
+ * 每一节：y = b0 * x + s0；s0 = b1 * x + a1 * y + s1；s1 = b2 * x + a2 * y(a1、a2已取负)，
+ * 三轴的同一步排在一起，相邻的乘加互不依赖，可连续发射。
+ *
+ * @param coeffs 各节的{b0, b1, b2, -a1, -a2}
+ * @param state 各节各轴的DF2T状态
+ * @param count 节数
+ * @param gyro 三轴角速度，滤波后的值写回
+ *
+ * @return void
+ */
+void GyroFilter_ApplyStages(float (*coeffs)[5], float (*state)[GYRO_FILTER_AXIS_COUNT][2], uint32_t count, float *gyro) {
+	float x0 = gyro[0], x1 = gyro[1], x2 = gyro[2];
+	float y0, y1, y2;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		const float *c = coeffs[i];
+		float (*s)[2] = state[i];
+		float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+		y0 = b0 * x0 + s[0][0];
+		y1 = b0 * x1 + s[1][0];
+		y2 = b0 * x2 + s[2][0];
+		s[0][0] = b1 * x0 + s[0][1] + a1 * y0;
+		s[1][0] = b1 * x1 + s[1][1] + a1 * y1;
+		s[2][0] = b1 * x2 + s[2][1] + a1 * y2;
+		s[0][1] = b2 * x0 + a2 * y0;
+		s[1][1] = b2 * x1 + a2 * y1;
+		s[2][1] = b2 * x2 + a2 * y2;
+		x0 = y0;
+		x1 = y1;
+		x2 = y2;
+	}
+	gyro[0] = x0;
+	gyro[1] = x1;
+	gyro[2] = x2;
+}
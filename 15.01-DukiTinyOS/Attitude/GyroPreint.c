@@ -0,0 +1,62 @@
+#include "GyroPreint.h"
+#include <string.h>
+
+void GyroPreint_Reset(GyroPreint *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+/**
+ * @brief 加入一个样本：转角增量Δθ = ω·dt，先按累计前的α求圆锥修正，再累加α
+ *
+ * @param p 预积分
+ * @param gx, gy, gz 角速度(rad/s)
+ * @param dt 与上一样本的间隔(s)
+ *
+ * @return void
+ */
+void GyroPreint_Push(GyroPreint *p, float gx, float gy, float gz, float dt) {
+    float dx = gx * dt, dy = gy * dt, dz = gz * dt;
+    float ux = p->last[0] * (1.0f / 6.0f) + p->alpha[0];
+    float uy = p->last[1] * (1.0f / 6.0f) + p->alpha[1];
+    float uz = p->last[2] * (1.0f / 6.0f) + p->alpha[2];
+
+    p->beta[0] += (uy * dz - uz * dy) * 0.5f;
+    p->beta[1] += (uz * dx - ux * dz) * 0.5f;
+    p->beta[2] += (ux * dy - uy * dx) * 0.5f;
+    p->alpha[0] += dx;
+    p->alpha[1] += dy;
+    p->alpha[2] += dz;
+    p->last[0] = dx;
+    p->last[1] = dy;
+    p->last[2] = dz;
+}
+
+/**
+ * @brief 合并相邻的两段：旋转向量的合成取到二阶，β = β₁ + β₂ + α₁ × α₂ / 2，
+ *        用于上一段尚未被取走时把新的一段接在其后
+ *
+ * @param dst 在前的一段，合并结果写回
+ * @param src 紧接其后的一段
+ *
+ * @return void
+ */
+void GyroPreint_Append(GyroPreint *dst, const GyroPreint *src) {
+    const float *a = dst->alpha, *b = src->alpha;
+
+    dst->beta[0] += src->beta[0] + (a[1] * b[2] - a[2] * b[1]) * 0.5f;
+    dst->beta[1] += src->beta[1] + (a[2] * b[0] - a[0] * b[2]) * 0.5f;
+    dst->beta[2] += src->beta[2] + (a[0] * b[1] - a[1] * b[0]) * 0.5f;
+    dst->alpha[0] += b[0];
+    dst->alpha[1] += b[1];
+    dst->alpha[2] += b[2];
+    dst->last[0] = src->last[0];
+    dst->last[1] = src->last[1];
+    dst->last[2] = src->last[2];
+}
+
+// 整段的旋转向量：方向为等效转轴，模长为转角，除以段的总时长即为交给估计器的等效角速度
+void GyroPreint_Get(const GyroPreint *p, float *rot) {
+    rot[0] = p->alpha[0] + p->beta[0];
+    rot[1] = p->alpha[1] + p->beta[1];
+    rot[2] = p->alpha[2] + p->beta[2];
+}
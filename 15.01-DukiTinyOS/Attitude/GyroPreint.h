@@ -0,0 +1,22 @@
+#ifndef __GYROPREINT_H
+#define __GYROPREINT_H
+
+#include <stdint.h>
+
+// 陀螺仪预积分：采样率高于姿态更新时，逐个样本累加转角增量，并做圆锥误差(coning)修正，
+// 姿态更新时一次取出整段的旋转向量。各样本角速度求平均再乘总时长只保留了转角之和，
+// 转轴在窗口内变化(如两轴同时振动)时各次转动不可交换，平均值会丢失这部分转动，表现为姿态的缓慢漂移。
+// 修正按二阶算法：β += (α + Δθ₋₁ / 6) × Δθ / 2，α为段内累计的转角，Δθ₋₁为上一样本的转角增量，
+// 旋转向量为α + β；每个样本约20次浮点乘加，不做开方及归一化
+typedef struct _GyroPreint {
+    float alpha[3];     // 段内转角增量之和(rad)
+    float beta[3];      // 圆锥修正(rad)
+    float last[3];      // 上一样本的转角增量(rad)
+} GyroPreint;
+
+void GyroPreint_Reset(GyroPreint *p);                                           // 清零，开始新的一段
+void GyroPreint_Push(GyroPreint *p, float gx, float gy, float gz, float dt);    // 加入一个样本，角速度(rad/s)按间隔dt(s)积分
+void GyroPreint_Append(GyroPreint *dst, const GyroPreint *src);                 // 把紧接其后的一段src合并到dst之后
+void GyroPreint_Get(const GyroPreint *p, float *rot);                           // 取出整段的旋转向量(rad)，机体系
+
+#endif
@@ -16,24 +16,23 @@
 // Header files
 
 #include "MadgWick.h"
-#include <math.h>
+#include "tSeqLock.h"
+#include "AttitudeMath.h"
 
 //---------------------------------------------------------------------------------------------------
 // Definitions
 
-#define sampleFreq  512.0f    // sample frequency in Hz
 #define betaDef    0.1f      // 2 * proportional gain
 
 //---------------------------------------------------------------------------------------------------
 // Variable definitions
 
-volatile float beta = betaDef;                       // 2 * proportional gain (Kp)
-volatile float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;  // quaternion of sensor frame relative to auxiliary frame
+float beta = betaDef;                       // 2 * proportional gain (Kp)
+float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;  // quaternion of sensor frame relative to auxiliary frame
 
-//---------------------------------------------------------------------------------------------------
-// Function declarations
-
-float invSqrt(float x);
+// q0~q3在更新过程中会被多次改写，其它任务通过双缓冲顺序锁读取每次更新完成后的快照
+static float qSnapshot[2][4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch qLatch = {{0}, {qSnapshot[0], qSnapshot[1]}, sizeof(qSnapshot[0])};
 
 //====================================================================================================
 // Functions
@@ -41,7 +40,10 @@ float invSqrt(float x);
 //---------------------------------------------------------------------------------------------------
 // AHRS algorithm update
 
-void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz) {
+// dt为本样本与上一样本的实测间隔(s)，由调用者按数据就绪时间戳给出
+void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    // q0~q3先读入局部变量，最后一次写回
+    float _q0 = q0, _q1 = q1, _q2 = q2, _q3 = q3;
     float recipNorm;
     float s0, s1, s2, s3;
     float qDot1, qDot2, qDot3, qDot4;
@@ -50,67 +52,69 @@ void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float
 
     // Use IMU algorithm if magnetometer measurement invalid (avoids NaN in magnetometer normalisation)
     if((mx == 0.0f) && (my == 0.0f) && (mz == 0.0f)) {
-       MadgwickAHRSupdateIMU(gx, gy, gz, ax, ay, az);
+       MadgwickAHRSupdateIMU(gx, gy, gz, ax, ay, az, dt);
        return;
     }
 
     // Rate of change of quaternion from gyroscope
-    qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
-    qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
-    qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
-    qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+    qDot1 = 0.5f * (-_q1 * gx - _q2 * gy - _q3 * gz);
+    qDot2 = 0.5f * (_q0 * gx + _q2 * gz - _q3 * gy);
+    qDot3 = 0.5f * (_q0 * gy - _q1 * gz + _q3 * gx);
+    qDot4 = 0.5f * (_q0 * gz + _q1 * gy - _q2 * gx);
 
     // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
     if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
 
        // Normalise accelerometer measurement
-       recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+       recipNorm = AttitudeInvSqrt(ax * ax + ay * ay + az * az);
        ax *= recipNorm;
        ay *= recipNorm;
        az *= recipNorm;   
 
        // Normalise magnetometer measurement
-       recipNorm = invSqrt(mx * mx + my * my + mz * mz);
+       recipNorm = AttitudeInvSqrt(mx * mx + my * my + mz * mz);
        mx *= recipNorm;
        my *= recipNorm;
        mz *= recipNorm;
 
        // Auxiliary variables to avoid repeated arithmetic
-       _2q0mx = 2.0f * q0 * mx;
-       _2q0my = 2.0f * q0 * my;
-       _2q0mz = 2.0f * q0 * mz;
-       _2q1mx = 2.0f * q1 * mx;
-       _2q0 = 2.0f * q0;
-       _2q1 = 2.0f * q1;
-       _2q2 = 2.0f * q2;
-       _2q3 = 2.0f * q3;
-       _2q0q2 = 2.0f * q0 * q2;
-       _2q2q3 = 2.0f * q2 * q3;
-       q0q0 = q0 * q0;
-       q0q1 = q0 * q1;
-       q0q2 = q0 * q2;
-       q0q3 = q0 * q3;
-       q1q1 = q1 * q1;
-       q1q2 = q1 * q2;
-       q1q3 = q1 * q3;
-       q2q2 = q2 * q2;
-       q2q3 = q2 * q3;
-       q3q3 = q3 * q3;
+       _2q0mx = 2.0f * _q0 * mx;
+       _2q0my = 2.0f * _q0 * my;
+       _2q0mz = 2.0f * _q0 * mz;
+       _2q1mx = 2.0f * _q1 * mx;
+       _2q0 = 2.0f * _q0;
+       _2q1 = 2.0f * _q1;
+       _2q2 = 2.0f * _q2;
+       _2q3 = 2.0f * _q3;
+       _2q0q2 = 2.0f * _q0 * _q2;
+       _2q2q3 = 2.0f * _q2 * _q3;
+       q0q0 = _q0 * _q0;
+       q0q1 = _q0 * _q1;
+       q0q2 = _q0 * _q2;
+       q0q3 = _q0 * _q3;
+       q1q1 = _q1 * _q1;
+       q1q2 = _q1 * _q2;
+       q1q3 = _q1 * _q3;
+       q2q2 = _q2 * _q2;
+       q2q3 = _q2 * _q3;
+       q3q3 = _q3 * _q3;
 
        // Reference direction of Earth's magnetic field
-       hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
-       hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
-       _2bx = sqrt(hx * hx + hy * hy);
-       _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+       hx = mx * q0q0 - _2q0my * _q3 + _2q0mz * _q2 + mx * q1q1 + _2q1 * my * _q2 + _2q1 * mz * _q3 - mx * q2q2 - mx * q3q3;
+       hy = _2q0mx * _q3 + my * q0q0 - _2q0mz * _q1 + _2q1mx * _q2 - my * q1q1 + my * q2q2 + _2q2 * mz * _q3 - my * q3q3;
+       _2bx = ATTITUDE_SQRTF(hx * hx + hy * hy);
+       _2bz = -_2q0mx * _q2 + _2q0my * _q1 + mz * q0q0 + _2q1mx * _q3 - mz * q1q1 + _2q2 * my * _q3 - mz * q2q2 + mz * q3q3;
        _4bx = 2.0f * _2bx;
        _4bz = 2.0f * _2bz;
 
        // Gradient decent algorithm corrective step
-       s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay) - _2bz * q2 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * q3 + _2bz * q1) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * q2 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-       s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * q1 * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + _2bz * q3 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * q2 + _2bz * q0) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * q3 - _4bz * q1) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-       s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * q2 * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + (-_4bx * q2 - _2bz * q0) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * q1 + _2bz * q3) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * q0 - _4bz * q2) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-       s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay) + (-_4bx * q3 + _2bz * q1) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * q0 + _2bz * q2) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * q1 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-       recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
+       s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay) - _2bz * _q2 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * _q3 + _2bz * _q1) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * _q2 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+       s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * _q1 * (1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az) + _2bz * _q3 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * _q2 + _2bz * _q0) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * _q3 - _4bz * _q1) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+       s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * _q2 * (1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az) + (-_4bx * _q2 - _2bz * _q0) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * _q1 + _2bz * _q3) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * _q0 - _4bz * _q2) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+       s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay) + (-_4bx * _q3 + _2bz * _q1) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * _q0 + _2bz * _q2) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * _q1 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+       // normalise step magnitude; a zero step (estimate already aligned) would give 0 * inf = NaN
+       recipNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+       recipNorm = (recipNorm > 0.0f) ? AttitudeInvSqrt(recipNorm) : 0.0f;
        s0 *= recipNorm;
        s1 *= recipNorm;
        s2 *= recipNorm;
@@ -124,102 +128,175 @@ void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float
     }
 
     // Integrate rate of change of quaternion to yield quaternion
-    q0 += qDot1 * (1.0f / sampleFreq);
-    q1 += qDot2 * (1.0f / sampleFreq);
-    q2 += qDot3 * (1.0f / sampleFreq);
-    q3 += qDot4 * (1.0f / sampleFreq);
+    _q0 += qDot1 * dt;
+    _q1 += qDot2 * dt;
+    _q2 += qDot3 * dt;
+    _q3 += qDot4 * dt;
 
     // Normalise quaternion
-    recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-    q0 *= recipNorm;
-    q1 *= recipNorm;
-    q2 *= recipNorm;
-    q3 *= recipNorm;
+    recipNorm = AttitudeInvSqrt(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+    q0 = _q0 * recipNorm;
+    q1 = _q1 * recipNorm;
+    q2 = _q2 * recipNorm;
+    q3 = _q3 * recipNorm;
+    MadgwickPublishQuaternion();
 }
 
 //---------------------------------------------------------------------------------------------------
 // IMU algorithm update
 
-void MadgwickAHRSupdateIMU(float gx, float gy, float gz, float ax, float ay, float az) {
+void MadgwickAHRSupdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    // q0~q3先读入局部变量，整个更新在寄存器中完成，最后一次写回
+    float _q0 = q0, _q1 = q1, _q2 = q2, _q3 = q3;
     float recipNorm;
     float s0, s1, s2, s3;
     float qDot1, qDot2, qDot3, qDot4;
-    float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2 ,_8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
+    float k, kaz;
 
-    // Rate of change of quaternion from gyroscope
-    qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
-    qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
-    qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
-    qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+    // Rate of change of quaternion from gyroscope, 0.5f folded into the rates
+    gx *= 0.5f;
+    gy *= 0.5f;
+    gz *= 0.5f;
+    qDot1 = -_q1 * gx - _q2 * gy - _q3 * gz;
+    qDot2 = _q0 * gx + _q2 * gz - _q3 * gy;
+    qDot3 = _q0 * gy - _q1 * gz + _q3 * gx;
+    qDot4 = _q0 * gz + _q1 * gy - _q2 * gx;
 
     // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
     if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+       float b = beta;
 
        // Normalise accelerometer measurement
-       recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+       recipNorm = AttitudeInvSqrt(ax * ax + ay * ay + az * az);
        ax *= recipNorm;
        ay *= recipNorm;
-       az *= recipNorm;   
-
-       // Auxiliary variables to avoid repeated arithmetic
-       _2q0 = 2.0f * q0;
-       _2q1 = 2.0f * q1;
-       _2q2 = 2.0f * q2;
-       _2q3 = 2.0f * q3;
-       _4q0 = 4.0f * q0;
-       _4q1 = 4.0f * q1;
-       _4q2 = 4.0f * q2;
-       _8q1 = 8.0f * q1;
-       _8q2 = 8.0f * q2;
-       q0q0 = q0 * q0;
-       q1q1 = q1 * q1;
-       q2q2 = q2 * q2;
-       q3q3 = q3 * q3;
+       az *= recipNorm;
 
        // Gradient decent algorithm corrective step
-       s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
-       s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
-       s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
-       s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
-       recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
-       s0 *= recipNorm;
-       s1 *= recipNorm;
-       s2 *= recipNorm;
-       s3 *= recipNorm;
-
-       // Apply feedback step
-       qDot1 -= beta * s0;
-       qDot2 -= beta * s1;
-       qDot3 -= beta * s2;
-       qDot4 -= beta * s3;
+       // 原式按q为单位四元数化简(q0q0 + q3q3 = 1 - q1q1 - q2q2)，并约去公因子2，步长随后归一化，方向不变
+       k = _q1 * _q1 + _q2 * _q2;
+       kaz = k + az;
+       s0 = 2.0f * _q0 * k + _q2 * ax - _q1 * ay;
+       s1 = 2.0f * _q1 * kaz - _q3 * ax - _q0 * ay;
+       s2 = 2.0f * _q2 * kaz + _q0 * ax - _q3 * ay;
+       s3 = 2.0f * _q3 * k - _q1 * ax - _q2 * ay;
+
+       // Apply feedback step, normalise step magnitude and scale by beta in one go
+       // 步长为0(估计已与加速度计一致)时1/sqrt(0)为inf，0 * inf得NaN，原快速平方根倒数对0返回有限值，没有这个问题
+       recipNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+       recipNorm = (recipNorm > 0.0f) ? b * AttitudeInvSqrt(recipNorm) : 0.0f;
+       qDot1 -= s0 * recipNorm;
+       qDot2 -= s1 * recipNorm;
+       qDot3 -= s2 * recipNorm;
+       qDot4 -= s3 * recipNorm;
     }
 
     // Integrate rate of change of quaternion to yield quaternion
-    q0 += qDot1 * (1.0f / sampleFreq);
-    q1 += qDot2 * (1.0f / sampleFreq);
-    q2 += qDot3 * (1.0f / sampleFreq);
-    q3 += qDot4 * (1.0f / sampleFreq);
+    _q0 += qDot1 * dt;
+    _q1 += qDot2 * dt;
+    _q2 += qDot3 * dt;
+    _q3 += qDot4 * dt;
 
     // Normalise quaternion
-    recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-    q0 *= recipNorm;
-    q1 *= recipNorm;
-    q2 *= recipNorm;
-    q3 *= recipNorm;
+    recipNorm = AttitudeInvSqrt(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+    q0 = _q0 * recipNorm;
+    q1 = _q1 * recipNorm;
+    q2 = _q2 * recipNorm;
+    q3 = _q3 * recipNorm;
+    MadgwickPublishQuaternion();
+}
+
+//---------------------------------------------------------------------------------------------------
+// IMU algorithm batch update
+
+/**
+ * @brief 一批陀螺仪样本(如硬件FIFO一次读出的N个)的更新：四元数在局部变量中逐个积分，
+ *        批末归一化后按整批时长做一次加速度计修正，再归一化并发布一次
+ *
+ * 逐样本更新时每个样本都有两次开方及一次发布；这里积分不归一化(每步的模长误差为(ωdt/2)²量级)，每批只有三次开方。
+ * 修正步长beta * count * dt与逐样本修正count次的总量相同，即加速度计修正按批抽取、增益随之放大
+ *
+ * @param gyro 陀螺仪样本，每个样本{gx, gy, gz}(rad/s)依次排列
+ * @param count 样本数，为0时不更新
+ * @param ax, ay, az 整批的加速度(如各样本的均值)，全为0时不修正
+ * @param dt 每个样本的间隔(s)
+ *
+ * @return void
+ */
+void MadgwickAHRSupdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt) {
+    float _q0 = q0, _q1 = q1, _q2 = q2, _q3 = q3;
+    float halfDt = 0.5f * dt;
+    float recipNorm;
+    uint32_t i;
+
+    if (count == 0) {
+        return;
+    }
+
+    // 逐个样本积分q += 0.5 * q * ω * dt
+    for (i = 0; i < count; i++, gyro += 3) {
+        float gx = gyro[0] * halfDt, gy = gyro[1] * halfDt, gz = gyro[2] * halfDt;
+        float w = _q0, x = _q1, y = _q2, z = _q3;
+
+        _q0 = w - x * gx - y * gy - z * gz;
+        _q1 = x + w * gx + y * gz - z * gy;
+        _q2 = y + w * gy - x * gz + z * gx;
+        _q3 = z + w * gz + x * gy - y * gx;
+    }
+
+    if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+       float s0, s1, s2, s3;
+       float k, kaz;
+
+       // 梯度的化简要求单位四元数
+       recipNorm = AttitudeInvSqrt(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+       _q0 *= recipNorm;
+       _q1 *= recipNorm;
+       _q2 *= recipNorm;
+       _q3 *= recipNorm;
+
+       recipNorm = AttitudeInvSqrt(ax * ax + ay * ay + az * az);
+       ax *= recipNorm;
+       ay *= recipNorm;
+       az *= recipNorm;
+
+       // 与MadgwickAHRSupdateIMU相同的梯度
+       k = _q1 * _q1 + _q2 * _q2;
+       kaz = k + az;
+       s0 = 2.0f * _q0 * k + _q2 * ax - _q1 * ay;
+       s1 = 2.0f * _q1 * kaz - _q3 * ax - _q0 * ay;
+       s2 = 2.0f * _q2 * kaz + _q0 * ax - _q3 * ay;
+       s3 = 2.0f * _q3 * k - _q1 * ax - _q2 * ay;
+
+       recipNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+       recipNorm = (recipNorm > 0.0f) ? beta * (float)count * dt * AttitudeInvSqrt(recipNorm) : 0.0f;
+       _q0 -= s0 * recipNorm;
+       _q1 -= s1 * recipNorm;
+       _q2 -= s2 * recipNorm;
+       _q3 -= s3 * recipNorm;
+    }
+
+    recipNorm = AttitudeInvSqrt(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+    q0 = _q0 * recipNorm;
+    q1 = _q1 * recipNorm;
+    q2 = _q2 * recipNorm;
+    q3 = _q3 * recipNorm;
+    MadgwickPublishQuaternion();
 }
 
 //---------------------------------------------------------------------------------------------------
-// Fast inverse square-root
-// See: http://en.wikipedia.org/wiki/Fast_inverse_square_root
-
-float invSqrt(float x) {
-    float halfx = 0.5f * x;
-    float y = x;
-    long i = *(long*)&y;
-    i = 0x5f3759df - (i>>1);
-    y = *(float*)&i;
-    y = y * (1.5f - (halfx * y * y));
-    return y;
+// Quaternion snapshot
+
+// 发布q0~q3的快照，只能由更新四元数的任务调用
+void MadgwickPublishQuaternion(void) {
+    float q[4];
+    q[0] = q0; q[1] = q1; q[2] = q2; q[3] = q3;
+    tSeqLatchWrite(&qLatch, q);
+}
+
+// 读取最近一次更新完成的四元数{q0, q1, q2, q3}，不阻塞更新任务
+void MadgwickGetQuaternion(float * q) {
+    tSeqLatchRead(&qLatch, q);
 }
 
 //====================================================================================================
@@ -13,17 +13,23 @@
 #ifndef __MadgWick_h
 #define __MadgWick_h
 
+#include <stdint.h>
+
 //----------------------------------------------------------------------------------------------------
 // Variable declaration
 
-extern volatile float beta;          // algorithm gain
-extern volatile float q0, q1, q2, q3;   // quaternion of sensor frame relative to auxiliary frame
+// 只由融合任务读写，不再是volatile，更新函数中可以留在寄存器里；其它任务经MadgwickGetQuaternion读取快照
+extern float beta;          // algorithm gain
+extern float q0, q1, q2, q3;   // quaternion of sensor frame relative to auxiliary frame
 
 //---------------------------------------------------------------------------------------------------
 // Function declarations
 
-void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz);
-void MadgwickAHRSupdateIMU(float gx, float gy, float gz, float ax, float ay, float az);
+void MadgwickAHRSupdate(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt);
+void MadgwickAHRSupdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+void MadgwickAHRSupdateIMUBatch(const float *gyro, uint32_t count, float ax, float ay, float az, float dt);
+void MadgwickPublishQuaternion(void);
+void MadgwickGetQuaternion(float * q);
 
 #endif
 //=====================================================================================================
@@ -0,0 +1,91 @@
+#include "AttitudeEstimator.h"
+#include "AttitudeSolver.h"
+
+#if (ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MAHONY) || (ATTITUDE_MULTIRATE == 1)
+
+#include "Mahony.h"
+#include "AttitudeQuat.h"
+#include "tSeqLock.h"
+
+// Mahony互补滤波：估计的重力方向与加速度计测得的方向叉乘得到误差，经PI修正后叠加到陀螺仪角速度上再积分
+// 只有一次叉乘与两次归一化，比梯度下降的Madgwick更省，积分项同时补偿陀螺仪零偏
+
+void Mahony_Init(MahonyFilter *filter, float kp, float ki) {
+    filter->q[0] = 1.0f; filter->q[1] = 0.0f;
+    filter->q[2] = 0.0f; filter->q[3] = 0.0f;
+    filter->kp = kp;
+    filter->ki = ki;
+    filter->integral[0] = 0.0f;
+    filter->integral[1] = 0.0f;
+    filter->integral[2] = 0.0f;
+}
+
+void Mahony_UpdateIMU(MahonyFilter *filter, float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    AttitudeQuat q = AttitudeQuat_Load(filter->q);
+    AttitudeVec3 g = AttitudeVec3_Make(gx, gy, gz);
+
+    if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+        // 误差为测得方向与估计的重力方向(机体系)的叉乘
+        AttitudeVec3 a = AttitudeVec3_Normalize(AttitudeVec3_Make(ax, ay, az));
+        AttitudeVec3 e = AttitudeVec3_Cross(a, AttitudeQuat_Gravity(q));
+
+        if (filter->ki > 0.0f) {
+            filter->integral[0] += filter->ki * e.x * dt;
+            filter->integral[1] += filter->ki * e.y * dt;
+            filter->integral[2] += filter->ki * e.z * dt;
+            g = AttitudeVec3_Add(g, AttitudeVec3_Make(filter->integral[0], filter->integral[1], filter->integral[2]));
+        }
+        g = AttitudeVec3_MulAdd(g, e, filter->kp);
+    }
+
+    // q += 0.5 * q * ω * dt
+    AttitudeQuat_Store(filter->q, AttitudeQuat_IntegrateNormalize(q, AttitudeVec3_Scale(g, dt)));
+}
+
+// 归一化线性插值，q与-q表示同一姿态，先取与当前估计同侧的一个
+void Mahony_Blend(MahonyFilter *filter, const float *q, float weight) {
+    AttitudeQuat_Store(filter->q, AttitudeQuat_Nlerp(AttitudeQuat_Load(filter->q), AttitudeQuat_Load(q), weight));
+}
+
+#if ATTITUDE_ESTIMATOR == ATTITUDE_ESTIMATOR_MAHONY
+
+static MahonyFilter mahonyFilter = {{1.0f, 0.0f, 0.0f, 0.0f}, 0.5f, ATTITUDE_MAHONY_KI, {0.0f, 0.0f, 0.0f}};
+
+static float mahonySnapshot[2][4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch mahonyLatch = {{0}, {mahonySnapshot[0], mahonySnapshot[1]}, sizeof(mahonySnapshot[0])};
+
+void AttitudeEstimator_Init(float gain) {
+    Mahony_Init(&mahonyFilter, gain, ATTITUDE_MAHONY_KI);
+    tSeqLatchWrite(&mahonyLatch, mahonyFilter.q);
+}
+
+void AttitudeEstimator_SetQuaternion(const float *q) {
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        mahonyFilter.q[i] = q[i];
+    }
+    tSeqLatchWrite(&mahonyLatch, mahonyFilter.q);
+}
+
+void AttitudeEstimator_UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    Mahony_UpdateIMU(&mahonyFilter, gx, gy, gz, ax, ay, az, dt);
+    tSeqLatchWrite(&mahonyLatch, mahonyFilter.q);
+}
+
+void AttitudeEstimator_Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz, float dt) {
+    (void)mx; (void)my; (void)mz;
+    AttitudeEstimator_UpdateIMU(gx, gy, gz, ax, ay, az, dt);
+}
+
+void AttitudeEstimator_GetQuaternion(float *q) {
+    tSeqLatchRead(&mahonyLatch, q);
+}
+
+const char *AttitudeEstimator_GetName(void) {
+    return "mahony";
+}
+
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef __MAHONY_H
+#define __MAHONY_H
+
+// Mahony互补滤波器，每个实例独立保存状态，既作为ATTITUDE_ESTIMATOR_MAHONY后端，也作为多速率融合的快速路径
+typedef struct _MahonyFilter {
+    float q[4];             // {w, x, y, z}
+    float kp;               // 比例增益
+    float ki;               // 积分增益，为0时不做零偏积分
+    float integral[3];      // 误差积分(rad/s)，即零偏估计
+} MahonyFilter;
+
+void Mahony_Init(MahonyFilter *filter, float kp, float ki); // 复位为单位四元数
+void Mahony_UpdateIMU(MahonyFilter *filter, float gx, float gy, float gz, float ax, float ay, float az, float dt);
+void Mahony_Blend(MahonyFilter *filter, const float *q, float weight); // 以weight(0~1)的权重向q靠拢
+
+#endif // __MAHONY_H
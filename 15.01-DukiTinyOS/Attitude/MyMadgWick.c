@@ -5,82 +5,22 @@
 #include "MyMadgWick.h"
 #include "stdio.h"
 #include "MPU6050.h"
+#include "tSeqLock.h"
 //定义全局变量用于存储上个时刻的姿态四元数
 quaternion q_est_pre = {1.0f, 0.0f, 0.0f, 0.0f};  // 初始化为单位四元数
 //定义全局变量用于存储当前时刻的姿态四元数
 quaternion q_est_now = {1.0f, 0.0f, 0.0f, 0.0f};  // 初始化为单位四元数
 quaternion q;
+//q_est_now的快照，供其它任务读取
+static quaternion q_est_copy[2] = {{1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}};
+static tSeqLatch q_est_latch = {{0}, {&q_est_copy[0], &q_est_copy[1]}, sizeof(quaternion)};
 //extern float Roll, Pitch, Yaw;
 //************************** 四元数部分 **************************
 
-// 四元数加法
-void quaternion_add(quaternion *q1, quaternion *q2, quaternion *q_res) {
-    q_res->w = q1->w + q2->w;
-    q_res->x = q1->x + q2->x;
-    q_res->y = q1->y + q2->y;
-    q_res->z = q1->z + q2->z;
-}
-
-// 四元数减法
-void quaternion_sub(quaternion *q1, quaternion *q2, quaternion *q_res) {
-    q_res->w = q1->w - q2->w;
-    q_res->x = q1->x - q2->x;
-    q_res->y = q1->y - q2->y;
-    q_res->z = q1->z - q2->z;
-}
-
-// 四元数数乘
-void quaternion_scalar(quaternion *q1, float num, quaternion *q_res) {
-    q_res->w = q1->w * num;
-    q_res->x = q1->x * num;
-    q_res->y = q1->y * num;
-    q_res->z = q1->z * num;
-}
-
-// 四元数乘法
-void quaternion_mul(quaternion *q1, quaternion *q2, quaternion *q_res) {
-    q_res->w = q1->w * q2->w - q1->x * q2->x - q1->y * q2->y - q1->z * q2->z;
-    q_res->x = q1->w * q2->x + q1->x * q2->w + q1->y * q2->z - q1->z * q2->y;
-    q_res->y = q1->w * q2->y - q1->x * q2->z + q1->y * q2->w + q1->z * q2->x;
-    q_res->z = q1->w * q2->z + q1->x * q2->y - q1->y * q2->x + q1->z * q2->w;
-}
-
-// 四元数取模
-float quaternion_norm(quaternion *q) {
-    return sqrt(q->w * q->w + q->x * q->x + q->y * q->y + q->z * q->z);
-}
-
-// 快速求平方根倒数（Fast Inverse Square Root）
-float fast_inverse_sqrt(float number) {
-    const float threehalfs = 1.5F;
-
-    union {
-        float f;
-        uint32_t i;
-    } conv = { number };
-
-    conv.i = 0x5f3759df - (conv.i >> 1); // 魔数常量
-    conv.f *= (threehalfs - (number * 0.5F * conv.f * conv.f)); // 牛顿迭代一次
-    return conv.f;
-}
-
-// 四元数归一化
-// 取模可以参考 快速求平方根倒数算法
-// 优化的四元数归一化
-void quaternion_normalization(quaternion *q) {
-    float norm_squared = q->w * q->w + q->x * q->x + q->y * q->y + q->z * q->z;
-    if (norm_squared > 0.0f) {  // 防止除以0
-        float inv_sqrt_norm = fast_inverse_sqrt(norm_squared);
-        q->w *= inv_sqrt_norm;
-        q->x *= inv_sqrt_norm;
-        q->y *= inv_sqrt_norm;
-        q->z *= inv_sqrt_norm;
-    }
-}
 //*********************** 雅可比矩阵、误差函数、梯度计算 **********************
 
 // 雅可比矩阵
-void jacobi(float J[3][4], struct quaternion *q) {
+void jacobi(float J[3][4], const quaternion *q) {
     J[0][0] = -2.0f * (q->y);
     J[0][1] =  2.0f * (q->z);
     J[0][2] = -2.0f * (q->w);
@@ -98,7 +38,7 @@ void jacobi(float J[3][4], struct quaternion *q) {
 }
 
 // 误差函数
-void Func(float F[3], struct quaternion *q, quaternion *q_acc) {
+void Func(float F[3], const quaternion *q, const quaternion *q_acc) {
     F[0] = 2.0f * (q->x * q->z - q->w * q->y) - q_acc->x;
     F[1] = 2.0f * (q->y * q->z + q->w * q->x) - q_acc->y;
     F[2] = 2.0f * (0.5f - q->x * q->x - q->y * q->y) - q_acc->z;
@@ -114,45 +54,60 @@ void gra(quaternion *gradient, float J[3][4], float F[3]) {
 
 //***************************** 融合函数 ****************************
 
-void merge(float ax, float ay, float az, float wx, float wy, float wz) {
-//		for (int i = 0; i < 500000; i++) { __asm__("nop"); } // 代替 HAL_Delay(10) 的延时
-    q_est_pre = q_est_now;
-
-    // 构造陀螺仪角速度四元数
-    quaternion q_ang = {0, wx, wy, wz};
-    // 构造加速度计加速度四元数
-    quaternion q_acc = {0, ax, ay, az};
-    // 加速度归一化
-    quaternion_normalization(&q_acc);
-
-    // 求出姿态变化率 0.5 * q(t-1) * w
-    quaternion tmp1;
-    quaternion_scalar(&q_est_pre, 0.5f, &tmp1);
-    quaternion q_w_gra;
-    quaternion_mul(&tmp1, &q_ang, &q_w_gra);
-    // 求出雅可比矩阵
-    float J[3][4];
-    jacobi(J, &q_est_pre);
-
-    // 求出误差函数
-    float F[3];
-    Func(F, &q_est_pre, &q_acc);
-
-    // 求出梯度
-    quaternion gradient;
-    gra(&gradient, J, F);
-
-    // 梯度归一化
-    quaternion_normalization(&gradient);
-
-    // q(t) = q(t-1) + q' * deltaT - B * 梯度归一化
-    quaternion_scalar(&q_w_gra, deltaT, &tmp1);
-    quaternion tmp2;
-    quaternion_scalar(&gradient, B, &tmp2);
-    quaternion_add(&q_est_pre, &tmp1, &q_est_now);
-    quaternion_sub(&q_est_now, &tmp2, &q_est_now);
-		
-		q = q_est_now;
+// 梯度下降一步，梯度为J^T·F的展开式(与gra(jacobi(), Func())相同)，全部在局部变量中计算，不构造矩阵及临时四元数
+// 梯度随后归一化，展开时约去了公因子2
+void merge(float ax, float ay, float az, float wx, float wy, float wz, float dt) {
+    quaternion p = q_est_now;
+    quaternion grad, q_new;
+    AttitudeVec3 a, f;
+    float step;
+
+    q_est_pre = p;
+
+    // 误差函数F：估计的重力方向减去测得的加速度方向(已归一化)；q不做归一化，z分量按原式1 - 2(x² + y²)
+    a = AttitudeVec3_Normalize(AttitudeVec3_Make(ax, ay, az));
+    f = AttitudeVec3_Make(2.0f * (p.x * p.z - p.w * p.y) - a.x,
+                          2.0f * (p.y * p.z + p.w * p.x) - a.y,
+                          1.0f - 2.0f * (p.x * p.x + p.y * p.y) - a.z);
+
+    // 梯度J^T·F / 2
+    grad = AttitudeQuat_Make(p.x * f.y - p.y * f.x,
+                             p.z * f.x + p.w * f.y - 2.0f * p.x * f.z,
+                             p.z * f.y - p.w * f.x - 2.0f * p.y * f.z,
+                             p.x * f.x + p.y * f.y);
+
+    // 梯度归一化，步长B一并乘入
+    step = AttitudeQuat_NormSq(grad);
+    if (step > 0.0f) {
+        step = B * AttitudeInvSqrt(step);
+    }
+
+    // q(t) = q(t-1) + 0.5 * q(t-1) * w * dt - B * 梯度归一化
+    q_new = AttitudeQuat_MulAdd(AttitudeQuat_Integrate(p, AttitudeVec3_Make(wx * dt, wy * dt, wz * dt)), grad, -step);
+
+    // 一次性更新并发布快照，读者不会看到中间值
+    q_est_now = q_new;
+    tSeqLatchWrite(&q_est_latch, &q_new);
+
+    q = q_est_now;
+}
+
+// 以给定的姿态为上一时刻及当前时刻的估计并发布
+void MyMadgWick_Set(quaternion q_set) {
+    q_est_pre = q_set;
+    q_est_now = q_set;
+    q = q_set;
+    tSeqLatchWrite(&q_est_latch, &q_set);
+}
+
+// 复位为单位四元数并发布
+void MyMadgWick_Reset(void) {
+    MyMadgWick_Set(AttitudeQuat_Identity());
+}
+
+// 读取最近一次融合得到的姿态四元数，不阻塞融合任务
+void MyMadgWick_GetQuaternion(quaternion *q_out) {
+    tSeqLatchRead(&q_est_latch, q_out);
 }
 
 
@@ -172,13 +127,13 @@ void quaternion_to_euler(quaternion *q, float *roll, float *pitch, float *yaw) {
     float qy = q->y;
     float qz = q->z;
 
-    // 计算欧拉角（单位：弧度）
-    *roll = atan2f(2.0f * (qw * qx + qy * qz), 1.0f - 2.0f * (qx * qx + qy * qy));  // Roll
-    *pitch = asinf(2.0f * (qw * qy - qz * qx));                                     // Pitch
-    *yaw = atan2f(2.0f * (qw * qz + qx * qy), 1.0f - 2.0f * (qy * qy + qz * qz));   // Yaw
+    // 计算欧拉角（单位：弧度），多项式近似，误差在0.001°以内
+    *roll = AttitudeAtan2(2.0f * (qw * qx + qy * qz), 1.0f - 2.0f * (qx * qx + qy * qy));  // Roll
+    *pitch = AttitudeAsin(2.0f * (qw * qy - qz * qx));                                     // Pitch
+    *yaw = AttitudeAtan2(2.0f * (qw * qz + qx * qy), 1.0f - 2.0f * (qy * qy + qz * qz));   // Yaw
 
     // 转换为角度（如果需要以度为单位）
-    *roll *= (180.0f / PI);
-    *pitch *= (180.0f / PI);
-    *yaw *= (180.0f / PI);
+    *roll *= ATTITUDE_RAD_TO_DEG;
+    *pitch *= ATTITUDE_RAD_TO_DEG;
+    *yaw *= ATTITUDE_RAD_TO_DEG;
 }
@@ -8,48 +8,31 @@
 // Created by 邓可 on 2024/10/16.
 //
 #include "main.h"
-#include <math.h>
+#include "AttitudeQuat.h"
 
 //************************** 四元数部分 **************************
-//四元数定义
-typedef struct quaternion {
-    float w;
-    float x;
-    float y;
-    float z;
-}quaternion;
+//四元数定义，运算使用AttitudeQuat.h中按值传递的内联函数
+typedef AttitudeQuat quaternion;
 // 声明全局变量
 extern quaternion q_est_pre;
 extern quaternion q_est_now;
 
-//定义全局变量B和deltaT
-#define PI 3.1415926535897932
+//定义全局变量B，积分步长deltaT改由merge的dt参数按实测样本间隔给出
+#define PI ATTITUDE_PI
 //#define B sqrt(3.0f/4.0f) * 0.5f / 180 * PI //查手册发现噪声为0.05度每秒
-#define B 0.01 //查手册发现噪声为0.05度每秒//隔一段时间roll和yaw就会加2.6
+#define B 0.01f //查手册发现噪声为0.05度每秒//隔一段时间roll和yaw就会加2.6
 //Bq取0.2没有大偏移
-#define deltaT 0.08f
 
-void quaternion_add(quaternion *q1, quaternion *q2, quaternion *q_res) ;
+void jacobi(float J[3][4], const quaternion *q) ;
 
-void quaternion_sub(quaternion *q1, quaternion *q2, quaternion *q_res) ;
-
-void quaternion_scalar(quaternion *q1, float num, quaternion *q_res) ;
-
-void quaternion_mul(quaternion *q1, quaternion *q2, quaternion *q_res) ;
-
-float quaternion_norm(quaternion *q) ;
-
-float fast_inverse_sqrt(float number);
-
-void quaternion_normalization(quaternion *q) ;
-
-void jacobi(float J[3][4], struct quaternion *q) ;
-
-void Func(float F[3], struct quaternion *q, quaternion *q_acc) ;
+void Func(float F[3], const quaternion *q, const quaternion *q_acc) ;
 
 void gra(quaternion *gradient, float J[3][4], float F[3]);
 
-void merge(float ax, float ay, float az, float wx, float wy, float wz);
+void merge(float ax, float ay, float az, float wx, float wy, float wz, float dt); // dt为实测的样本间隔(s)
+void MyMadgWick_GetQuaternion(quaternion *q_out); // 读取姿态四元数快照
+void MyMadgWick_Reset(void); // 复位为单位四元数
+void MyMadgWick_Set(quaternion q_set); // 设置当前姿态，用于上电对准
 
 void quaternion_to_euler(quaternion *q, float *roll, float *pitch, float *yaw);
 #endif //UNTITLED_MADGWICK_H
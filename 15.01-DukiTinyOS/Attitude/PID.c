@@ -1,5 +1,7 @@
 #include "PID.h"
 #include "MySerial.h"
+#include "AttitudeMath.h"
+#include <string.h>
 
 //初始化
 void PID_Init(PID *pid, float kp, float ki, float kd, float maxIntegral, float maxOutput)
@@ -30,6 +32,19 @@ void PID_Adjust(PID *pid, float kp, float ki, float kd) {
     pid->ki = ki;
     pid->kd = kd;
 }
+// 读取参数
+void PID_GetGains(const PID *pid, PIDGains *gains) {
+    gains->kp = pid->kp;
+    gains->ki = pid->ki;
+    gains->kd = pid->kd;
+    gains->maxIntegral = pid->maxIntegral;
+    gains->maxOutput = pid->maxOutput;
+}
+
+// 设置参数，积分及误差等状态不变
+void PID_SetGains(PID *pid, const PIDGains *gains) {
+    PID_Init(pid, gains->kp, gains->ki, gains->kd, gains->maxIntegral, gains->maxOutput);
+}
 //进行一次pid计算
 //参数为(pid结构体,目标值,反馈值)，计算结果放在pid结构体的output成员中
 void PID_Calc(PID *pid, float reference, float feedback)
@@ -98,4 +113,120 @@ void PIDAngleProc_Yaw(PID *yawPID, float yawRef, float yawFeedback) {
 
 //	  printf("外环目标值:%.2f\t外环反馈值:%.2f\t外环输出值:%.2f\n",yawRef,yawFeedback,yawPID->output);
 
-}
\ No newline at end of file
+}
+// 三轴PID部分
+void PIDAxis3_Init(PIDAxis3 *pid, float dt, float derivCutoffHz) {
+    float tau = (derivCutoffHz > 0.0f) ? 1.0f / (2.0f * ATTITUDE_PI * derivCutoffHz) : 0.0f;
+
+    memset(pid, 0, sizeof(PIDAxis3));
+    pid->dt = dt;
+    pid->invDt = 1.0f / dt;
+    pid->derivAlpha = dt / (tau + dt); // 截止频率为0时不滤波
+}
+
+void PIDAxis3_SetGains(PIDAxis3 *pid, int axis, const PIDGains *gains) {
+    pid->kp[axis] = gains->kp;
+    pid->ki[axis] = gains->ki;
+    pid->kd[axis] = gains->kd;
+    pid->maxIntegral[axis] = gains->maxIntegral;
+    pid->maxOutput[axis] = gains->maxOutput;
+}
+
+void PIDAxis3_GetGains(const PIDAxis3 *pid, int axis, PIDGains *gains) {
+    gains->kp = pid->kp[axis];
+    gains->ki = pid->ki[axis];
+    gains->kd = pid->kd[axis];
+    gains->maxIntegral = pid->maxIntegral[axis];
+    gains->maxOutput = pid->maxOutput[axis];
+}
+
+void PIDAxis3_Reset(PIDAxis3 *pid) {
+    int i;
+
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        pid->integral[i] = 0.0f;
+        pid->deriv[i] = 0.0f;
+        pid->output[i] = 0.0f;
+    }
+}
+
+/**
+ * @brief 三轴一起计算一次PID，reference与measurement均按roll/pitch/yaw排列
+ *        第一次计算前lastMeas为0，PIDAxis3_Reset之后的第一步会有一次微分跳变，解锁前先以当前测量值调用一次即可
+ *
+ * @param pid 三轴PID
+ * @param reference 设定值
+ * @param measurement 测量值
+ *
+ * @return void
+ */
+void PIDAxis3_Calc(PIDAxis3 *pid, const float *reference, const float *measurement) {
+    const float dt = pid->dt;
+    const float invDt = pid->invDt;
+    const float alpha = pid->derivAlpha;
+    int i;
+
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        float error = reference[i] - measurement[i];
+        float rate = (pid->lastMeas[i] - measurement[i]) * invDt; // 测量值变化率取负，与误差的变化同号
+        float integral = pid->integral[i] + pid->ki[i] * error * dt;
+
+        pid->lastMeas[i] = measurement[i];
+        pid->deriv[i] += alpha * (rate - pid->deriv[i]);
+        pid->integral[i] = AttitudeClamp(integral, -pid->maxIntegral[i], pid->maxIntegral[i]);
+        pid->output[i] = AttitudeClamp(pid->kp[i] * error + pid->integral[i] + pid->kd[i] * pid->deriv[i],
+                                       -pid->maxOutput[i], pid->maxOutput[i]);
+    }
+}
+
+/**
+ * @brief 以PIDAngleProc_Init相同的参数初始化串级姿态控制
+ *        原来的kd按每个采样周期的误差变化计，这里换算为连续时间单位(乘以dt)，原控制频率下响应不变；
+ *        原PID_Calc中积分实际被清零，ki默认为0以保持现有行为，需要积分时经PIDAxis3_SetGains设置(单位1/s)
+ *
+ * @param pid 串级姿态控制
+ * @param dt 控制周期(s)
+ *
+ * @return void
+ */
+void PIDAttitude_Init(PIDAttitude *pid, float dt) {
+    PIDGains angle = {1.0f, 0.0f, 0.01f, 50.0f, 100.0f};
+    PIDGains rate = {0.8f, 0.0f, 0.005f, 10.0f, 100.0f};
+    PIDGains yaw = {1.0f, 0.0f, 0.01f, 50.0f, 100.0f};
+    PIDGains none = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    angle.kd *= dt;
+    rate.kd *= dt;
+    yaw.kd *= dt;
+
+    PIDAxis3_Init(&pid->angle, dt, 0.0f);
+    PIDAxis3_Init(&pid->rate, dt, PID_RATE_DERIV_CUTOFF_HZ);
+    PIDAxis3_SetGains(&pid->angle, PID_AXIS_ROLL, &angle);
+    PIDAxis3_SetGains(&pid->angle, PID_AXIS_PITCH, &angle);
+    PIDAxis3_SetGains(&pid->angle, PID_AXIS_YAW, &none);
+    PIDAxis3_SetGains(&pid->rate, PID_AXIS_ROLL, &rate);
+    PIDAxis3_SetGains(&pid->rate, PID_AXIS_PITCH, &rate);
+    PIDAxis3_SetGains(&pid->rate, PID_AXIS_YAW, &yaw);
+}
+
+/**
+ * @brief 串级姿态控制：外环输出加上前馈作为内环的角速度设定值，偏航通道外环参数为0，前馈即偏航角速度设定值
+ *
+ * @param pid 串级姿态控制
+ * @param angleRef 角度设定值(°)
+ * @param angle 角度反馈(°)
+ * @param rateFeedforward 角速度前馈，NULL时为0
+ * @param rate 角速度反馈
+ *
+ * @return void
+ */
+void PIDAttitude_Calc(PIDAttitude *pid, const float *angleRef, const float *angle, const float *rateFeedforward, const float *rate) {
+    float rateRef[PID_AXIS_COUNT];
+    int i;
+
+    PIDAxis3_Calc(&pid->angle, angleRef, angle);
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        rateRef[i] = pid->angle.output[i] + ((rateFeedforward != NULL) ? rateFeedforward[i] : 0.0f);
+    }
+    PIDAxis3_Calc(&pid->rate, rateRef, rate);
+}
@@ -11,6 +11,11 @@ typedef struct _PID {
 	float integral, maxIntegral; //积分、积分限幅
   float output, maxOutput; //输出、输出限幅
 }PID;
+//可持久化保存的pid参数
+typedef struct _PIDGains {
+	float kp, ki, kd;
+	float maxIntegral, maxOutput;
+}PIDGains;
 //定义串级pid结构体
 typedef struct _PIDCascade
 {
@@ -19,10 +24,49 @@ typedef struct _PIDCascade
     float output; //串级输出，等于inner.output
 }PIDCascade;
 
+// 三轴PID：roll/pitch/yaw三个通道按数组并排存放(结构数组)，一次调用算完三轴，循环可完全展开，
+// 同一参数的三个通道地址连续，省去逐轴调用的结构体寻址及函数调用；积分及微分按显式的固定周期dt计算，
+// 参数为连续时间单位(ki为1/s，kd为s)，提高控制频率时只需改dt。微分取测量值的变化(设定值突变不产生微分冲击)，
+// 经一阶低通滤波，系数由截止频率预先算好；积分与输出的限幅均不含分支
+#define PID_AXIS_COUNT      3
+#define PID_AXIS_ROLL       0
+#define PID_AXIS_PITCH      1
+#define PID_AXIS_YAW        2
+#define PID_RATE_DERIV_CUTOFF_HZ 30.0f  // 内环微分的低通截止频率，抑制陀螺仪噪声经微分放大
+
+typedef struct _PIDAxis3 {
+	float kp[PID_AXIS_COUNT], ki[PID_AXIS_COUNT], kd[PID_AXIS_COUNT];
+	float integral[PID_AXIS_COUNT], maxIntegral[PID_AXIS_COUNT];
+	float maxOutput[PID_AXIS_COUNT];
+	float lastMeas[PID_AXIS_COUNT];   // 上次的测量值
+	float deriv[PID_AXIS_COUNT];      // 滤波后的测量值变化率
+	float output[PID_AXIS_COUNT];
+	float dt;                         // 控制周期(s)
+	float invDt;                      // 1 / dt
+	float derivAlpha;                 // 微分低通系数 dt / (tau + dt)
+}PIDAxis3;
+
+// 串级姿态控制：外环角度 -> 角速度设定值，内环角速度 -> 输出；偏航没有角度环，外环参数为0，角速度设定值直接给定
+typedef struct _PIDAttitude {
+	PIDAxis3 angle;                   // 外环，输入为角度(°)，输出为角速度设定值
+	PIDAxis3 rate;                    // 内环，输入为角速度，输出即控制量
+}PIDAttitude;
+
+void PIDAxis3_Init(PIDAxis3 *pid, float dt, float derivCutoffHz); // 清零参数及状态，设置控制周期及微分滤波截止频率
+void PIDAxis3_SetGains(PIDAxis3 *pid, int axis, const PIDGains *gains); // 设置一个通道的参数
+void PIDAxis3_GetGains(const PIDAxis3 *pid, int axis, PIDGains *gains); // 读取一个通道的参数
+void PIDAxis3_Reset(PIDAxis3 *pid);                                     // 清零积分及微分状态，如解锁前调用
+void PIDAxis3_Calc(PIDAxis3 *pid, const float *reference, const float *measurement); // 三轴一起计算，结果在output中
+
+void PIDAttitude_Init(PIDAttitude *pid, float dt); // 使用默认参数初始化
+void PIDAttitude_Calc(PIDAttitude *pid, const float *angleRef, const float *angle, const float *rateFeedforward, const float *rate); // 角度、角速度按roll/pitch/yaw排列
+
 void PID_Init(PID *pid, float kp, float ki, float kd, float maxIntegral, float maxOutput);
 void PID_Calc(PID *pid, float reference, float feedback);
 void PID_CascadeCalc(PIDCascade *pid, float outerRef, float outerFdb, float innerFdb);
 void PID_Adjust(PID *pid, float kp, float ki, float kd);
+void PID_GetGains(const PID *pid, PIDGains *gains); // 读取参数，用于保存
+void PID_SetGains(PID *pid, const PIDGains *gains); // 设置参数，用于恢复保存过的参数
 void PIDAngleProc_Init(PIDCascade *rollPID,PIDCascade *pitchPID,PID *yawPID);
 void PIDAngleProc_Roll(PIDCascade *rollPID,float rollRef, float rollFeedback, float rollRateFeedback);
 void PIDAngleProc_Pitch(PIDCascade *pitchPID,float pitchRef, float pitchFeedback, float pitchRateFeedback);
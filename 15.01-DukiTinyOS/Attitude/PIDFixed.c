@@ -0,0 +1,228 @@
+#include "PIDFixed.h"
+#include "AttitudeMath.h"
+#include "tConfig.h"
+#include <string.h>
+
+#if !defined(TINYOS_PORT_POSIX)
+#include "main.h"   // CMSIS内核头文件，提供SIMD及饱和指令的内联函数
+#endif
+
+// 带DSP扩展的内核(M4/M7)用SIMD指令；M3只有SSAT；M0及主机上的测试全部用C实现
+#if !defined(TINYOS_PORT_POSIX) && (TINYOS_PORT_CORE >= 4)
+#define PIDQ_USE_DSP    1
+#else
+#define PIDQ_USE_DSP    0
+#endif
+#if !defined(TINYOS_PORT_POSIX) && (TINYOS_PORT_CORE >= 3)
+#define PIDQ_USE_SSAT   1
+#else
+#define PIDQ_USE_SSAT   0
+#endif
+
+// 四轴X型混控表(与Betaflight的QuadX一致)，Motor通道1~4依次为右后、右前、左后、左前：{滚转, 俯仰, 偏航}
+static const int8_t pidqMix[4][3] = {
+    {-1,  1, -1},
+    {-1, -1,  1},
+    { 1,  1,  1},
+    { 1, -1, -1},
+};
+
+#define PIDQ_LO(w)      ((int16_t)(uint16_t)(w))
+#define PIDQ_HI(w)      ((int16_t)(uint16_t)((w) >> 16))
+#define PIDQ_PACK(lo, hi) (((uint32_t)(uint16_t)(lo)) | ((uint32_t)(uint16_t)(hi) << 16))
+
+static __inline int32_t PIDQ_Sat16(int32_t x) {
+#if PIDQ_USE_SSAT == 1
+    return __SSAT(x, 16);
+#else
+    return (x > 32767) ? 32767 : ((x < -32768) ? -32768 : x);
+#endif
+}
+
+// 两路16位饱和减法
+static __inline uint32_t PIDQ_QSub16(uint32_t a, uint32_t b) {
+#if PIDQ_USE_DSP == 1
+    return __QSUB16(a, b);
+#else
+    return PIDQ_PACK(PIDQ_Sat16((int32_t)PIDQ_LO(a) - PIDQ_LO(b)), PIDQ_Sat16((int32_t)PIDQ_HI(a) - PIDQ_HI(b)));
+#endif
+}
+
+// 两路16x16乘积之和
+static __inline int32_t PIDQ_Smuad(uint32_t a, uint32_t b) {
+#if PIDQ_USE_DSP == 1
+    return (int32_t)__SMUAD(a, b);
+#else
+    return (int32_t)PIDQ_LO(a) * PIDQ_LO(b) + (int32_t)PIDQ_HI(a) * PIDQ_HI(b);
+#endif
+}
+
+// 两路16x16乘积之和再累加
+static __inline int32_t PIDQ_Smlad(uint32_t a, uint32_t b, int32_t acc) {
+#if PIDQ_USE_DSP == 1
+    return (int32_t)__SMLAD(a, b, (uint32_t)acc);
+#else
+    return (int32_t)PIDQ_LO(a) * PIDQ_LO(b) + (int32_t)PIDQ_HI(a) * PIDQ_HI(b) + acc;
+#endif
+}
+
+// 32位饱和加法
+static __inline int32_t PIDQ_QAdd(int32_t a, int32_t b) {
+#if PIDQ_USE_DSP == 1
+    return __QADD(a, b);
+#else
+    int64_t sum = (int64_t)a + b;
+    return (sum > 2147483647) ? 2147483647 : ((sum < -2147483647 - 1) ? (-2147483647 - 1) : (int32_t)sum);
+#endif
+}
+
+static __inline int32_t PIDQ_Clamp(int32_t v, int32_t limit) {
+    v = (v > limit) ? limit : v;
+    return (v < -limit) ? -limit : v;
+}
+
+static __inline uint32_t PIDQ_Load(const int16_t *pair) {
+    uint32_t word;
+
+    memcpy(&word, pair, 4);
+    return word;
+}
+
+// 浮点数换算为定点并饱和，scale为小数位对应的倍数
+static int32_t PIDQ_FromFloat(float v, float scale, float limit) {
+    v *= scale;
+    v = AttitudeClamp(v, -limit, limit);
+    return (int32_t)((v >= 0.0f) ? (v + 0.5f) : (v - 0.5f));
+}
+
+void PIDQ15Axis3_Init(PIDQ15Axis3 *pid, float dt, float derivCutoffHz, float inScale, float outScale) {
+    float tau = (derivCutoffHz > 0.0f) ? 1.0f / (2.0f * ATTITUDE_PI * derivCutoffHz) : 0.0f;
+
+    memset(pid, 0, sizeof(PIDQ15Axis3));
+    pid->dt = dt;
+    pid->inScale = inScale;
+    pid->outScale = outScale;
+    pid->derivAlpha = (int16_t)PIDQ_FromFloat(dt / (tau + dt), 32768.0f, 32767.0f);
+}
+
+/**
+ * @brief 按物理单位设置一个通道的参数：输入x = x_q * inScale，输出y = y_q * outScale，
+ *        因此kp_q = kp * inScale / outScale，ki、kd再分别乘、除以dt；超出Q12范围(±8)的参数饱和
+ *
+ * @param pid 三轴定点PID
+ * @param axis PID_AXIS_xxx
+ * @param gains 浮点参数(ki为1/s，kd为s，限幅为输出单位)
+ *
+ * @return void
+ */
+void PIDQ15Axis3_SetGains(PIDQ15Axis3 *pid, int axis, const PIDGains *gains) {
+    const float one = (float)(1 << PIDQ_GAIN_SHIFT);
+    float ratio = pid->inScale / pid->outScale;
+    int32_t kp = PIDQ_FromFloat(gains->kp * ratio, one, 32767.0f);
+    int32_t kd = PIDQ_FromFloat(gains->kd * ratio / pid->dt, one, 32767.0f);
+
+    pid->gainPD[axis] = PIDQ_PACK(kp, kd);
+    pid->ki[axis] = (int16_t)PIDQ_FromFloat(gains->ki * ratio * pid->dt, one, 32767.0f);
+    pid->maxIntegral[axis] = PIDQ_FromFloat(gains->maxIntegral / pid->outScale, 32768.0f * one, 2147483520.0f);
+    pid->maxOutput[axis] = (int16_t)PIDQ_FromFloat(gains->maxOutput / pid->outScale, 32768.0f, 32767.0f);
+}
+
+void PIDQ15Axis3_Reset(PIDQ15Axis3 *pid) {
+    int i;
+
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        pid->integral[i] = 0;
+        pid->deriv[i] = 0;
+        pid->output[i] = 0;
+    }
+}
+
+/**
+ * @brief 三轴一起计算一次定点PID：roll/pitch打包为一个字，误差及测量值变化各用一条QSUB16两路同时算出，
+ *        yaw与第4个元素为另一个字；每路的kp * e + kd * d用一条SMUAD，积分及输出经QADD、SSAT饱和
+ *
+ * @param pid 三轴定点PID
+ * @param reference 设定值(Q15)，4个元素，第4个不使用
+ * @param measurement 测量值(Q15)，4个元素，第4个不使用
+ *
+ * @return void
+ */
+void PIDQ15Axis3_Calc(PIDQ15Axis3 *pid, const int16_t *reference, const int16_t *measurement) {
+    uint32_t measRP = PIDQ_Load(&measurement[0]);
+    uint32_t measY = PIDQ_Load(&measurement[2]);
+    uint32_t error[2], delta[2];
+    int i;
+
+    error[0] = PIDQ_QSub16(PIDQ_Load(&reference[0]), measRP);
+    error[1] = PIDQ_QSub16(PIDQ_Load(&reference[2]), measY);
+    delta[0] = PIDQ_QSub16(PIDQ_Load(&pid->lastMeas[0]), measRP); // 测量值变化取负，与误差的变化同号
+    delta[1] = PIDQ_QSub16(PIDQ_Load(&pid->lastMeas[2]), measY);
+    memcpy(&pid->lastMeas[0], &measRP, 4);
+    memcpy(&pid->lastMeas[2], &measY, 4);
+
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        int32_t e = (i & 1) ? PIDQ_HI(error[i >> 1]) : PIDQ_LO(error[i >> 1]);
+        int32_t d = (i & 1) ? PIDQ_HI(delta[i >> 1]) : PIDQ_LO(delta[i >> 1]);
+        int32_t acc;
+
+        pid->deriv[i] = (int16_t)(pid->deriv[i] + ((pid->derivAlpha * (d - pid->deriv[i])) >> 15));
+        pid->integral[i] = PIDQ_Clamp(PIDQ_QAdd(pid->integral[i], e * pid->ki[i]), pid->maxIntegral[i]);
+        acc = PIDQ_QAdd(PIDQ_Smuad(PIDQ_PACK(e, pid->deriv[i]), pid->gainPD[i]), pid->integral[i]);
+        pid->output[i] = (int16_t)PIDQ_Clamp(PIDQ_Sat16(acc >> PIDQ_GAIN_SHIFT), pid->maxOutput[i]);
+    }
+}
+
+/**
+ * @brief 以PIDAttitude_Init相同的参数初始化定点串级姿态控制
+ *
+ * @param pid 定点串级姿态控制
+ * @param dt 控制周期(s)
+ * @param angleScale 角度输入的满量程(°)，如180
+ * @param rateScale 角速度的满量程(rad/s)，与陀螺仪量程一致时原始数据可直接作为Q15输入
+ * @param outScale 控制量的满量程，如100
+ *
+ * @return void
+ */
+void PIDQ15Attitude_Init(PIDQ15Attitude *pid, float dt, float angleScale, float rateScale, float outScale) {
+    PIDAttitude ref;
+    PIDGains gains;
+    int i;
+
+    PIDAttitude_Init(&ref, dt); // 取浮点版本的默认参数，保证两者一致
+    PIDQ15Axis3_Init(&pid->angle, dt, 0.0f, angleScale, rateScale);
+    PIDQ15Axis3_Init(&pid->rate, dt, PID_RATE_DERIV_CUTOFF_HZ, rateScale, outScale);
+    for (i = 0; i < PID_AXIS_COUNT; i++) {
+        PIDAxis3_GetGains(&ref.angle, i, &gains);
+        PIDQ15Axis3_SetGains(&pid->angle, i, &gains);
+        PIDAxis3_GetGains(&ref.rate, i, &gains);
+        PIDQ15Axis3_SetGains(&pid->rate, i, &gains);
+    }
+}
+
+void PIDQ15Attitude_Calc(PIDQ15Attitude *pid, const int16_t *angleRef, const int16_t *angle, const int16_t *rate) {
+    PIDQ15Axis3_Calc(&pid->angle, angleRef, angle);
+    PIDQ15Axis3_Calc(&pid->rate, pid->angle.output, rate); // 偏航外环参数为0，角速度设定值即0
+}
+
+/**
+ * @brief 四轴X型混控，每个电机的滚转、俯仰两项用一条SMLAD累加到油门与偏航项之上，结果饱和到[0, 1)
+ *
+ * @param thrust 油门(Q15)
+ * @param axis 三轴控制量(Q15)，按roll/pitch/yaw排列
+ * @param motor 四个电机的占空比(Q15)
+ *
+ * @return void
+ */
+void PIDQ15_MixQuadX(int16_t thrust, const int16_t *axis, int16_t *motor) {
+    uint32_t rp = PIDQ_PACK(axis[PID_AXIS_ROLL], axis[PID_AXIS_PITCH]);
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        int32_t v = PIDQ_Smlad(rp, PIDQ_PACK(pidqMix[i][0], pidqMix[i][1]), (int32_t)thrust + pidqMix[i][2] * axis[PID_AXIS_YAW]);
+#if PIDQ_USE_SSAT == 1
+        motor[i] = (int16_t)__USAT(v, 15);
+#else
+        motor[i] = (int16_t)((v > 32767) ? 32767 : ((v < 0) ? 0 : v));
+#endif
+    }
+}
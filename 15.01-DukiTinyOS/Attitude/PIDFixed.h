@@ -0,0 +1,48 @@
+#ifndef __PIDFIXED_H
+#define __PIDFIXED_H
+
+#include <stdint.h>
+#include "PID.h"
+
+// 定点三轴PID及四轴X型混控，用于没有FPU的Cortex-M0/M3构建：数据为Q15(int16，满量程为±1)，
+// 参数为Q12(int16，±8)，积分及乘积累加为Q27(int32)；roll/pitch两路打包成一个字并行处理。
+// TINYOS_PORT_CORE为4/7(带DSP扩展)时用QSUB16一次算出两路的误差及测量值变化，每路的P、D两项用一条SMUAD
+// 完成(误差与变化率打包，kp与kd打包)，积分及输出用QADD/SSAT饱和；M3没有SIMD及饱和加减指令，
+// 按相同的算法以普通整数运算实现(SSAT仍由硬件完成)，M0全部用C实现，结果与DSP版本逐位一致
+#define PIDQ_GAIN_SHIFT     12      // 参数的小数位数
+#define PIDQ_ONE            32767   // Q15的1
+
+// 三轴定点PID，周期固定，ki、kd在设置参数时已乘除dt
+typedef struct _PIDQ15Axis3 {
+    uint32_t gainPD[PID_AXIS_COUNT];        // 低半字kp，高半字kd(Q12)
+    int16_t ki[PID_AXIS_COUNT];             // ki * dt(Q12)
+    int16_t maxOutput[PID_AXIS_COUNT];      // Q15
+    int32_t integral[PID_AXIS_COUNT];       // Q27
+    int32_t maxIntegral[PID_AXIS_COUNT];    // Q27
+    int16_t lastMeas[4];                    // 上次的测量值，按[roll, pitch]、[yaw, 0]两个字排列
+    int16_t deriv[PID_AXIS_COUNT];          // 滤波后的测量值变化量(Q15每周期)
+    int16_t derivAlpha;                     // 微分低通系数(Q15)
+    int16_t output[4];                      // Q15，第4个元素固定为0，使其可直接作为内环的设定值
+    float dt;                               // 控制周期(s)，只在设置参数时使用
+    float inScale, outScale;                // 输入、输出满量程对应的物理量，用于把浮点参数换算为定点
+} PIDQ15Axis3;
+
+// 串级姿态控制，结构与PIDAttitude相同：外环输入角度，内环输入角速度，外环的输出满量程须与内环的输入满量程一致
+typedef struct _PIDQ15Attitude {
+    PIDQ15Axis3 angle;
+    PIDQ15Axis3 rate;
+} PIDQ15Attitude;
+
+void PIDQ15Axis3_Init(PIDQ15Axis3 *pid, float dt, float derivCutoffHz, float inScale, float outScale); // 清零，设置周期、微分截止频率及满量程
+void PIDQ15Axis3_SetGains(PIDQ15Axis3 *pid, int axis, const PIDGains *gains); // 按物理单位的浮点参数设置一个通道(与PIDAxis3相同的单位)
+void PIDQ15Axis3_Reset(PIDQ15Axis3 *pid);  // 清零积分及微分状态
+void PIDQ15Axis3_Calc(PIDQ15Axis3 *pid, const int16_t *reference, const int16_t *measurement); // 三轴一起计算，数组须4字节对齐并留出第4个元素
+
+void PIDQ15Attitude_Init(PIDQ15Attitude *pid, float dt, float angleScale, float rateScale, float outScale); // 使用与PIDAttitude_Init相同的默认参数
+void PIDQ15Attitude_Calc(PIDQ15Attitude *pid, const int16_t *angleRef, const int16_t *angle, const int16_t *rate); // 偏航没有角度环，角速度设定值为0
+
+// 四轴X型混控：电机 = 油门 + 滚转、俯仰两路的点积(一条SMLAD) + 偏航，结果限制在[0, 1)；
+// thrust为Q15油门，输出motor[4]为Q15占空比，电机顺序及转向见PIDQ_MIX_xxx
+void PIDQ15_MixQuadX(int16_t thrust, const int16_t *axis, int16_t *motor);
+
+#endif
@@ -0,0 +1,114 @@
+#include "RpmFilter.h"
+#include "AttitudeMath.h"
+
+#if RPM_FILTER_ENABLE == 1
+
+#if ESC_TELEMETRY_ENABLE == 0
+#error "RPM_FILTER_ENABLE requires ESC_TELEMETRY_ENABLE"
+#endif
+#if (RPM_FILTER_HARMONICS < 1) || (RPM_FILTER_HARMONICS > 3)
+#error "RPM_FILTER_HARMONICS must be between 1 and 3"
+#endif
+
+// 直通：y = x + s0，切换前留下的状态两个样本内流出，之后状态保持为0
+static void RpmFilter_Bypass(float *c) {
+	c[0] = 1.0f;
+	c[1] = 0.0f;
+	c[2] = 0.0f;
+	c[3] = 0.0f;
+	c[4] = 0.0f;
+}
+
+void RpmFilter_Init(RpmFilter *filter, float sampleHz) {
+	uint32_t i, axis;
+
+	for (i = 0; i < RPM_FILTER_STAGES; i++) {
+		RpmFilter_Bypass(filter->coeffs[i]);
+		for (axis = 0; axis < GYRO_FILTER_AXIS_COUNT; axis++) {
+			filter->state[i][axis][0] = 0.0f;
+			filter->state[i][axis][1] = 0.0f;
+		}
+	}
+	for (i = 0; i < MOTOR_COUNT; i++) {
+		filter->targetHz[i] = 0.0f;
+		filter->centerHz[i] = 0.0f;
+	}
+	filter->sampleHz = sampleHz;
+	filter->smooth = 1.0f / (1.0f + sampleHz / (2.0f * ATTITUDE_PI * RPM_FILTER_SMOOTH_HZ));
+}
+
+/**
+ * @brief 按遥测设置各电机的目标基频，遥测无效的电机目标为0，之后的RpmFilter_Update中该电机的陷波直通
+ *
+ * @param filter 滤波器
+ * @param rpm EscTelemetry_Poll得到的转速
+ *
+ * @return void
+ */
+void RpmFilter_SetRpm(RpmFilter *filter, const EscRpm *rpm) {
+	uint32_t m;
+
+	for (m = 0; m < MOTOR_COUNT; m++) {
+		filter->targetHz[m] = (rpm->validMask & (1u << m)) ? rpm->hz[m] : 0.0f;
+	}
+}
+
+/**
+ * @brief 各电机的基频向目标平滑一步，改写全部谐波陷波的系数，每个样本在RpmFilter_Apply之前调用
+ *
+ * 第h次谐波的cos、sin由e^(jw)的h次方递推，一个电机只调用一次cosf、sinf；
+ * 电机从无效变为有效时基频直接跳到目标，不从0开始扫过整个频段。
+ *
+ * @param filter 滤波器
+ *
+ * @return void
+ */
+void RpmFilter_Update(RpmFilter *filter) {
+	float maxHz = filter->sampleHz * RPM_FILTER_MAX_RATIO;
+	float w, c1, s1, c, s, t;
+	uint32_t m, h;
+
+	for (m = 0; m < MOTOR_COUNT; m++) {
+		float (*stage)[5] = &filter->coeffs[m * RPM_FILTER_HARMONICS];
+		float target = filter->targetHz[m];
+		float hz;
+
+		if (!(target > 0.0f)) {
+			filter->centerHz[m] = 0.0f;
+			for (h = 0; h < RPM_FILTER_HARMONICS; h++) {
+				RpmFilter_Bypass(stage[h]);
+			}
+			continue;
+		}
+		if (filter->centerHz[m] > 0.0f) {
+			filter->centerHz[m] += filter->smooth * (target - filter->centerHz[m]);
+		} else {
+			filter->centerHz[m] = target;
+		}
+
+		hz = filter->centerHz[m];
+		w = 2.0f * ATTITUDE_PI * hz / filter->sampleHz;
+		c1 = cosf(w);
+		s1 = sinf(w);
+		c = c1;
+		s = s1;
+		for (h = 0; h < RPM_FILTER_HARMONICS; h++) {
+			float harmonicHz = hz * (float)(h + 1);
+
+			if ((harmonicHz < RPM_FILTER_MIN_HZ) || (harmonicHz > maxHz)) {
+				RpmFilter_Bypass(stage[h]);
+			} else {
+				GyroFilter_NotchFromTrig(stage[h], c, s, RPM_FILTER_Q);
+			}
+			t = c * c1 - s * s1;
+			s = s * c1 + c * s1;
+			c = t;
+		}
+	}
+}
+
+void RpmFilter_Apply(RpmFilter *filter, float *gyro) {
+	GyroFilter_ApplyStages(filter->coeffs, filter->state, RPM_FILTER_STAGES, gyro);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __RPMFILTER_H
+#define __RPMFILTER_H
+
+#include <stdint.h>
+#include "GyroFilter.h"
+#include "EscTelemetry.h"
+
+// 转速陷波：按电调回传的各电机转速，在每个电机转频的1 ~ RPM_FILTER_HARMONICS次谐波处各放一节陷波，
+// 共MOTOR_COUNT * RPM_FILTER_HARMONICS节，在GyroFilter之前逐个样本处理。中心频率精确跟踪电机噪声，
+// 可以用较窄的陷波代替GyroFilter中宽的低通，角速度环的相位延迟随之减小(RPM_FILTER_LPF_HZ)。
+// 每个周期各电机的基频向最新的遥测平滑移动，各次谐波的cos、sin由基频复数相乘递推，每个电机只算一次cosf、sinf；
+// 谐波超出RPM_FILTER_MIN_HZ ~ 采样率 * RPM_FILTER_MAX_RATIO或电机遥测无效时该节直通
+// 需开启ESC_TELEMETRY_ENABLE
+#define RPM_FILTER_ENABLE           0
+#define RPM_FILTER_HARMONICS        3       // 每个电机的谐波数，1 ~ 3
+#define RPM_FILTER_Q                5.0f    // 陷波品质因数，遥测精确，比按频谱估计的动态陷波窄
+#define RPM_FILTER_MIN_HZ           80.0f   // 低于该频率的谐波不滤波，怠速以下的转速不可靠
+#define RPM_FILTER_MAX_RATIO        0.45f   // 高于采样率该比例的谐波不滤波
+#define RPM_FILTER_SMOOTH_HZ        150.0f  // 基频一阶平滑的截止频率(Hz)，KISS遥测每个电机数毫秒才更新一次
+#define RPM_FILTER_LPF_HZ           0.0f    // 开启转速陷波时GyroFilter的低通截止频率，0为不用低通，只保留陷波
+
+#define RPM_FILTER_STAGES           (MOTOR_COUNT * RPM_FILTER_HARMONICS)
+
+typedef struct _RpmFilter {
+	float coeffs[RPM_FILTER_STAGES][5];                              // 第m个电机的第h次谐波为第m * RPM_FILTER_HARMONICS + h节
+	float state[RPM_FILTER_STAGES][GYRO_FILTER_AXIS_COUNT][2];
+	float targetHz[MOTOR_COUNT];                                     // 最近一次遥测的基频，0为无效
+	float centerHz[MOTOR_COUNT];                                     // 平滑后的基频
+	float sampleHz;
+	float smooth;                                                    // 一阶平滑的系数
+}RpmFilter;
+
+#if RPM_FILTER_ENABLE == 1
+void RpmFilter_Init(RpmFilter *filter, float sampleHz);            // 所有节直通，状态清零
+void RpmFilter_SetRpm(RpmFilter *filter, const EscRpm *rpm);       // 遥测有更新时调用，设置各电机的目标基频
+void RpmFilter_Update(RpmFilter *filter);                          // 每个样本调用，基频平滑一步并改写各节系数
+void RpmFilter_Apply(RpmFilter *filter, float *gyro);              // 滤波一个三轴样本，结果写回gyro
+#endif
+
+#endif
@@ -0,0 +1,395 @@
+#include "TuneLink.h"
+#include "tinyOS.h"
+#include "MySerial.h"
+
+#if TUNE_LINK_ENABLE == 1
+
+#if (TINYOS_ENABLE_QUEUE == 0) || (MYSERIAL_RX_USE_DMA == 0)
+#error "TUNE_LINK_ENABLE requires TINYOS_ENABLE_QUEUE and MYSERIAL_RX_USE_DMA"
+#endif
+
+#include <string.h>
+#include "Anonymity.h"
+#include "FlightPipeline.h"
+#include "tSeqLock.h"
+
+// 一帧结束时回头读取数据部分，期间DMA最多又写入约半个缓冲区，数据部分须仍未被覆盖
+#if (TUNE_FRAME_DATA_MAX + 8) > (MYSERIAL_RX_DMA_SIZE / 2)
+#error "TUNE_FRAME_DATA_MAX is too large for MYSERIAL_RX_DMA_SIZE"
+#endif
+
+#define TUNE_REPLY_MAX          17      // 应答数据部分的最大字节数
+#define TUNE_FRAME_SIZE(len)    ((len) + 6)
+
+// 解析状态
+typedef enum _TuneParseState {
+    TuneParseHead = 0,
+    TuneParseHead2,
+    TuneParseId,
+    TuneParseLen,
+    TuneParseData,
+    TuneParseSum,
+    TuneParseAdd,
+} TuneParseState;
+
+// 串口中断中的解析器，只记录位置与校验，不保存数据
+typedef struct _TuneParser {
+    TuneParseState state;
+    uint8_t id;
+    uint8_t len;
+    uint8_t count;
+    uint8_t sumcheck;
+    uint8_t addcheck;
+    uint32_t dataPos;       // 数据部分第一个字节在DMA缓冲区中的位置
+} TuneParser;
+
+static TuneParser tuneParser;
+static TuneLinkStat tuneStat;
+
+static TuneCommand tuneQueueBuf[TUNE_QUEUE_SIZE];
+static tQueue tuneQueue;
+
+// 暂存的参数只由调参任务修改，经顺序锁发布给控制回路
+static TuneGains tuneStaged;
+static TuneGains tuneCopy[2];
+static tSeqLatch tuneLatch = {{0}, {&tuneCopy[0], &tuneCopy[1]}, sizeof(tuneCopy[0])};
+static volatile uint32_t tuneVersion;
+
+static tTask tuneTask;
+static tTaskStack tuneTaskStack[TUNE_STACK_SIZE];
+
+static __inline void TuneLink_Check(TuneParser *p, uint8_t ch) {
+    p->sumcheck += ch;
+    p->addcheck += p->sumcheck;
+}
+
+// 数据部分的第i个字节，DMA缓冲区末尾绕回时从头读取
+static __inline uint8_t TuneLink_DataByte(const uint8_t *ring, uint32_t size, uint32_t i) {
+    return ring[(tuneParser.dataPos + i) % size];
+}
+
+// 校验正确，从DMA缓冲区中解码出命令交给调参任务
+static void TuneLink_Dispatch(const uint8_t *ring, uint32_t size) {
+    TuneCommand cmd;
+    uint32_t raw = 0;
+    uint32_t i;
+
+    cmd.id = tuneParser.id;
+    cmd.len = tuneParser.len;
+    cmd.param = (cmd.len >= 1) ? TuneLink_DataByte(ring, size, 0) : 0;
+    if (cmd.len >= 5) {
+        for (i = 0; i < 4; i++) {
+            raw |= (uint32_t)TuneLink_DataByte(ring, size, 1 + i) << (8 * i);
+        }
+    }
+    memcpy(&cmd.value, &raw, sizeof(cmd.value));
+    tuneStat.commands++;
+    if (tQueueSendFromISR(&tuneQueue, &cmd) != tErrorNoError) {
+        tuneStat.dropped++;
+    }
+}
+
+/**
+ * @brief 串口中断中逐字节解析命令帧，直接读取DMA循环缓冲区
+ *
+ * @param ring DMA循环缓冲区
+ * @param size 缓冲区大小
+ * @param pos 本字节的位置，MYSERIAL_RX_PARSER_IDLE表示线路空闲
+ *
+ * @return 1：该字节属于命令帧
+ */
+static uint32_t TuneLink_Parse(const uint8_t *ring, uint32_t size, uint32_t pos) {
+    TuneParser *p = &tuneParser;
+    uint8_t ch;
+
+    // 命令帧总是连续发送，线路空闲时还没收完的帧作废
+    if (pos == MYSERIAL_RX_PARSER_IDLE) {
+        if (p->state > TuneParseHead2) {
+            tuneStat.checksumErrors++;
+        }
+        p->state = TuneParseHead;
+        return 0;
+    }
+
+    ch = ring[pos];
+    switch (p->state) {
+    case TuneParseHead:
+        if (ch != 0xAA) {
+            return 0;
+        }
+        p->sumcheck = 0;
+        p->addcheck = 0;
+        TuneLink_Check(p, ch);
+        p->state = TuneParseHead2;
+        return 1;
+    case TuneParseHead2:
+        if (ch != 0xFF) {
+            p->state = TuneParseHead;
+            return 0;
+        }
+        TuneLink_Check(p, ch);
+        p->state = TuneParseId;
+        return 1;
+    case TuneParseId:
+        TuneLink_Check(p, ch);
+        p->id = ch;
+        p->state = TuneParseLen;
+        return 1;
+    case TuneParseLen:
+        if (ch > TUNE_FRAME_DATA_MAX) {
+            tuneStat.checksumErrors++;
+            p->state = TuneParseHead;
+            return 1;
+        }
+        TuneLink_Check(p, ch);
+        p->len = ch;
+        p->count = 0;
+        p->dataPos = (pos + 1) % size;
+        p->state = (ch > 0) ? TuneParseData : TuneParseSum;
+        return 1;
+    case TuneParseData:
+        TuneLink_Check(p, ch);
+        if (++p->count == p->len) {
+            p->state = TuneParseSum;
+        }
+        return 1;
+    case TuneParseSum:
+        if (ch != p->sumcheck) {
+            tuneStat.checksumErrors++;
+            p->state = TuneParseHead;
+            return 1;
+        }
+        p->state = TuneParseAdd;
+        return 1;
+    case TuneParseAdd:
+    default:
+        p->state = TuneParseHead;
+        if (ch != p->addcheck) {
+            tuneStat.checksumErrors++;
+            return 1;
+        }
+        TuneLink_Dispatch(ring, size);
+        return 1;
+    }
+}
+
+static void TuneLink_PutU32(AnoFrameBuilder *builder, uint32_t value) {
+    AnoFrame_PutU8(builder, (uint8_t)value);
+    AnoFrame_PutU8(builder, (uint8_t)(value >> 8));
+    AnoFrame_PutU8(builder, (uint8_t)(value >> 16));
+    AnoFrame_PutU8(builder, (uint8_t)(value >> 24));
+}
+
+static void TuneLink_PutFloat(AnoFrameBuilder *builder, float value) {
+    uint32_t raw;
+
+    memcpy(&raw, &value, sizeof(raw));
+    TuneLink_PutU32(builder, raw);
+}
+
+// 参数号对应的暂存参数，超出范围时返回0
+static float *TuneLink_Param(uint32_t param) {
+    PIDGains *gains;
+
+    if (param >= TUNE_PARAM_COUNT) {
+        return (float *)0;
+    }
+    gains = &tuneStaged.gains[param / (PID_AXIS_COUNT * TUNE_FIELD_COUNT)][(param / TUNE_FIELD_COUNT) % PID_AXIS_COUNT];
+    switch (param % TUNE_FIELD_COUNT) {
+    case 0:
+        return &gains->kp;
+    case 1:
+        return &gains->ki;
+    case 2:
+        return &gains->kd;
+    case 3:
+        return &gains->maxIntegral;
+    default:
+        return &gains->maxOutput;
+    }
+}
+
+// 读取或设置一个参数，应答[参数号, 值, 状态]
+static void TuneLink_HandleParam(AnoFrameBuilder *builder, const TuneCommand *cmd) {
+    float *field = TuneLink_Param(cmd->param);
+    uint8_t status = TUNE_STATUS_OK;
+
+    if (cmd->len != ((cmd->id == TUNE_CMD_SET_PARAM) ? 5 : 1)) {
+        status = TUNE_STATUS_BAD_LENGTH;
+    } else if (field == (float *)0) {
+        status = TUNE_STATUS_BAD_PARAM;
+    } else if (cmd->id == TUNE_CMD_SET_PARAM) {
+        // NaN及过大的值会使积分发散，拒绝
+        if (!((cmd->value > -1.0e6f) && (cmd->value < 1.0e6f))) {
+            status = TUNE_STATUS_BAD_PARAM;
+        } else {
+            *field = cmd->value;
+            tSeqLatchWrite(&tuneLatch, &tuneStaged);
+            tuneVersion = tuneVersion + 1;
+        }
+    }
+    if (AnoFrame_Begin(builder, cmd->id, 6)) {
+        AnoFrame_PutU8(builder, cmd->param);
+        TuneLink_PutFloat(builder, field ? *field : 0.0f);
+        AnoFrame_PutU8(builder, status);
+        AnoFrame_End(builder);
+    }
+}
+
+// 改变遥测发送的帧，应答[生效的组合, 状态]
+static void TuneLink_HandleStream(AnoFrameBuilder *builder, const TuneCommand *cmd) {
+    uint8_t frames = 0;
+    uint8_t status = TUNE_STATUS_OK;
+
+    if (cmd->len != 1) {
+        status = TUNE_STATUS_BAD_LENGTH;
+    } else {
+#if (TINYOS_ENABLE_MEMBLOCK == 1) && (MYSERIAL_TX_USE_DMA == 1)
+        Ano_TelemetrySetFrames(cmd->param & ANO_FRAME_ALL);
+        frames = (uint8_t)Ano_TelemetryGetFrames();
+#else
+        status = TUNE_STATUS_UNSUPPORTED;
+#endif
+    }
+    if (AnoFrame_Begin(builder, TUNE_CMD_STREAM, 2)) {
+        AnoFrame_PutU8(builder, frames);
+        AnoFrame_PutU8(builder, status);
+        AnoFrame_End(builder);
+    }
+}
+
+// 每级一帧耗时统计，最后一帧为调参链路的统计
+static void TuneLink_HandleStats(AnoFrameBuilder *builder) {
+    TuneLinkStat link;
+#if TINYOS_ENABLE_FLIGHT == 1
+    FlightStageStat stat;
+    uint32_t i;
+
+    for (i = 0; i < FlightStageCount; i++) {
+        FlightPipeline_GetStat((FlightStage)i, &stat);
+        if (!AnoFrame_Begin(builder, TUNE_CMD_STATS, TUNE_REPLY_MAX)) {
+            return;
+        }
+        AnoFrame_PutU8(builder, (uint8_t)i);
+        TuneLink_PutU32(builder, stat.count);
+        TuneLink_PutU32(builder, stat.count ? (uint32_t)(stat.totalCycles / stat.count) : 0);
+        TuneLink_PutU32(builder, stat.maxCycles);
+        TuneLink_PutU32(builder, stat.overruns);
+        AnoFrame_End(builder);
+    }
+#endif
+    TuneLink_GetStat(&link);
+    if (AnoFrame_Begin(builder, TUNE_CMD_LINK_STATS, 16)) {
+        TuneLink_PutU32(builder, link.commands);
+        TuneLink_PutU32(builder, link.checksumErrors);
+        TuneLink_PutU32(builder, link.dropped);
+        TuneLink_PutU32(builder, link.version);
+        AnoFrame_End(builder);
+    }
+}
+
+/**
+ * @brief 调参任务：取出中断中解码的命令，修改暂存参数或读取统计，整批应答一次写入串口
+ *
+ * @param param 未使用
+ *
+ * @return void
+ */
+static void TuneLink_Entry(void *param) {
+    uint8_t reply[(FlightStageCount + 1) * TUNE_FRAME_SIZE(TUNE_REPLY_MAX)];
+    AnoFrameBuilder builder;
+    TuneCommand cmd;
+
+    (void)param;
+    for (;;) {
+        tQueueReceive(&tuneQueue, &cmd, 0);
+        AnoFrame_Init(&builder, reply, sizeof(reply));
+        switch (cmd.id) {
+        case TUNE_CMD_GET_PARAM:
+        case TUNE_CMD_SET_PARAM:
+            TuneLink_HandleParam(&builder, &cmd);
+            break;
+        case TUNE_CMD_STREAM:
+            TuneLink_HandleStream(&builder, &cmd);
+            break;
+        case TUNE_CMD_STATS:
+            TuneLink_HandleStats(&builder);
+            break;
+        default:
+            // 其它功能字不是发给本机的命令，不应答
+            break;
+        }
+        if (builder.len > 0) {
+            MySerial_Write(reply, builder.len);
+        }
+    }
+}
+
+/**
+ * @brief 以当前参数为暂存参数，创建调参任务，并在串口接收中接管命令帧
+ *
+ * 需在两个环的PID参数设置好之后、控制任务开始读取之前调用。
+ * @param angle 外环角度PID
+ * @param rate 内环角速度PID
+ */
+void TuneLink_Init(const PIDAxis3 *angle, const PIDAxis3 *rate) {
+    int axis;
+
+    for (axis = 0; axis < PID_AXIS_COUNT; axis++) {
+        PIDAxis3_GetGains(angle, axis, &tuneStaged.gains[TUNE_LOOP_ANGLE][axis]);
+        PIDAxis3_GetGains(rate, axis, &tuneStaged.gains[TUNE_LOOP_RATE][axis]);
+    }
+    tSeqLatchWrite(&tuneLatch, &tuneStaged);
+    tuneVersion = 0;
+    tuneParser.state = TuneParseHead;
+
+    tQueueInit(&tuneQueue, tuneQueueBuf, sizeof(TuneCommand), TUNE_QUEUE_SIZE);
+    tTaskInit(&tuneTask, TuneLink_Entry, (void *)0, TUNE_PRIO, tuneTaskStack, sizeof(tuneTaskStack));
+    tObjectSetName(&tuneTask.object, "tune");
+    MySerial_SetRxParser(TuneLink_Parse);
+}
+
+/**
+ * @brief 控制回路在每个周期开始时调用，有新发布的参数时整套取出
+ *
+ * 没有更新时只比较一次版本号；读取经顺序锁，不会与调参任务的写入交错，也不会阻塞。
+ * @param version 调用者上次取得的版本号，初始为0
+ * @param gains 取出的整套参数
+ *
+ * @return 1：取出了新的参数
+ */
+uint32_t TuneLink_Fetch(uint32_t *version, TuneGains *gains) {
+    uint32_t latest = tuneVersion;
+
+    if (latest == *version) {
+        return 0;
+    }
+    // 读到的可能比latest更新，下次再取一次同样的参数，无妨
+    tSeqLatchRead(&tuneLatch, gains);
+    *version = latest;
+    return 1;
+}
+
+/**
+ * @brief 把一个环的三轴参数设置到PID，积分及微分状态不变
+ * @param pid 该环的PID，只能在执行该环计算的任务中调用
+ * @param gains 整套参数
+ * @param loop TUNE_LOOP_ANGLE或TUNE_LOOP_RATE
+ */
+void TuneLink_Apply(PIDAxis3 *pid, const TuneGains *gains, uint32_t loop) {
+    int axis;
+
+    for (axis = 0; axis < PID_AXIS_COUNT; axis++) {
+        PIDAxis3_SetGains(pid, axis, &gains->gains[loop][axis]);
+    }
+}
+
+void TuneLink_GetStat(TuneLinkStat *stat) {
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = tuneStat;
+    stat->version = tuneVersion;
+    tTaskExitCritical(status);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __TUNELINK_H
+#define __TUNELINK_H
+
+#include <stdint.h>
+#include "PID.h"
+
+// 在线调参：上位机经USART1发送与匿名帧相同格式的命令帧(0xAA 0xFF 功能字 长度 数据 和校验 附加校验)，
+// 串口中断中逐字节解析，直接读取DMA循环缓冲区，校验正确后把命令解码为定长的TuneCommand交给调参任务；
+// 命令帧的字节不会交给命令行，文本输入中不会出现0xAA，两者可共用一个串口。
+// 修改的参数先写入暂存的一整套参数，经双缓冲顺序锁发布，控制回路在每个周期开始时检查版本号，
+// 有更新时整套取出后再计算，一个周期内用到的参数总是来自同一次发布。
+// 需开启TINYOS_ENABLE_QUEUE及MYSERIAL_RX_USE_DMA，应答经MySerial_Write发送
+#define TUNE_LINK_ENABLE        0
+
+#define TUNE_QUEUE_SIZE         4       // 待处理的命令数，调参任务来不及处理时丢弃新命令
+#define TUNE_FRAME_DATA_MAX     16      // 命令帧数据部分的最大字节数
+#define TUNE_STACK_SIZE         256     // 调参任务栈(字)
+#define TUNE_PRIO               (TINYOS_PRIO_COUNT - 3) // 与遥测任务相同，低于控制任务
+
+// 命令的功能字，应答使用相同的功能字
+#define TUNE_CMD_GET_PARAM      0xE0    // [参数号] -> [参数号, 值(float), 状态]
+#define TUNE_CMD_SET_PARAM      0xE1    // [参数号, 值(float)] -> [参数号, 暂存后的值(float), 状态]
+#define TUNE_CMD_STREAM         0xE2    // [ANO_FRAME_xxx的组合，含内核状态帧] -> [生效的组合, 状态]，为0时停止遥测
+#define TUNE_CMD_STATS          0xE3    // [] -> 每级一帧[级号, 执行次数, 平均耗时, 最长耗时, 超时次数]，另有一帧0xE4
+#define TUNE_CMD_LINK_STATS     0xE4    // 应答：[收到的命令数, 校验错误数, 丢弃的命令数, 已发布的版本号]
+
+// 应答中的状态
+#define TUNE_STATUS_OK          0
+#define TUNE_STATUS_BAD_PARAM   1       // 参数号超出范围或值不是有限数
+#define TUNE_STATUS_BAD_LENGTH  2       // 数据长度与命令不符
+#define TUNE_STATUS_UNSUPPORTED 3       // 未开启相应的功能
+
+// 参数号 = 环 * 15 + 轴 * 5 + 项，环：0外环角度、1内环角速度；轴：PID_AXIS_xxx；
+// 项：0 kp、1 ki、2 kd、3 积分限幅、4 输出限幅
+#define TUNE_LOOP_ANGLE         0
+#define TUNE_LOOP_RATE          1
+#define TUNE_LOOP_COUNT         2
+#define TUNE_FIELD_COUNT        5
+#define TUNE_PARAM_COUNT        (TUNE_LOOP_COUNT * PID_AXIS_COUNT * TUNE_FIELD_COUNT)
+#define TUNE_PARAM_ID(loop, axis, field) ((loop) * PID_AXIS_COUNT * TUNE_FIELD_COUNT + (axis) * TUNE_FIELD_COUNT + (field))
+
+// 一整套参数，按环、轴排列
+typedef struct _TuneGains {
+    PIDGains gains[TUNE_LOOP_COUNT][PID_AXIS_COUNT];
+} TuneGains;
+
+// 串口中断解码出的命令
+typedef struct _TuneCommand {
+    uint8_t id;                         // 功能字
+    uint8_t len;                        // 数据长度
+    uint8_t param;                      // 参数号或帧组合
+    float value;                        // 设置的值
+} TuneCommand;
+
+// 调参链路的统计
+typedef struct _TuneLinkStat {
+    uint32_t commands;                  // 校验正确的命令帧数
+    uint32_t checksumErrors;            // 校验错误或数据超长的帧数
+    uint32_t dropped;                   // 队列满而丢弃的命令数
+    uint32_t version;                   // 已发布的参数版本号，每次设置加1
+} TuneLinkStat;
+
+#if TUNE_LINK_ENABLE == 1
+void TuneLink_Init(const PIDAxis3 *angle, const PIDAxis3 *rate); // 以当前参数为暂存参数，创建调参任务并接管串口接收的命令帧
+uint32_t TuneLink_Fetch(uint32_t *version, TuneGains *gains); // 版本号比*version新时取出整套参数并更新*version，返回1；否则返回0
+void TuneLink_Apply(PIDAxis3 *pid, const TuneGains *gains, uint32_t loop); // 把一个环的三轴参数设置到PID，积分等状态不变
+void TuneLink_GetStat(TuneLinkStat *stat);
+#else
+#define TuneLink_Init(angle, rate)
+#endif
+
+#endif // __TUNELINK_H
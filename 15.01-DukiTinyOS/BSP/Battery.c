@@ -0,0 +1,147 @@
+#include "Battery.h"
+#include "tinyOS.h"
+
+#if BATTERY_ENABLE == 1
+
+#if TINYOS_ENABLE_TIMER == 0
+#error "BATTERY_ENABLE requires TINYOS_ENABLE_TIMER"
+#endif
+
+#include "tSeqLock.h"
+
+#define BATTERY_DMA_STREAM          DMA2_Stream0
+#define BATTERY_PERIOD_S            (tTimeMsToTicks(BATTERY_PERIOD_MS) * TINYOS_SYSTICK_MS * 0.001f) // 按节拍取整后的实际周期(s)
+#define BATTERY_FILTER_ALPHA        (BATTERY_PERIOD_S / (1.0f / (6.2831853f * BATTERY_FILTER_HZ) + BATTERY_PERIOD_S))
+#define BATTERY_RAW_TO_VOLT         (BATTERY_VREF / (4095.0f * BATTERY_SCAN_COUNT))  // 一个通道所有扫描的总和换算为引脚电压
+
+// DMA循环写入的缓冲区，只由DMA写，定时器函数读取时转换仍在进行，每个半字都是完整的一次转换
+static volatile uint16_t batteryBuf[BATTERY_SCAN_COUNT][2];
+static DMA_HandleTypeDef batteryDma;
+static tTimer batteryTimer;
+
+// 滤波状态，只由定时器函数访问
+static BatteryState batteryState;
+
+static BatteryState batteryCopy[2];
+static tSeqLatch batteryLatch = {{0}, {&batteryCopy[0], &batteryCopy[1]}, sizeof(batteryCopy[0])};
+
+// 采样时间设为480个ADC时钟，分压电阻的源阻抗较高也能充满采样电容
+static void Battery_SetSampleTime(uint32_t channel) {
+    if (channel >= 10) {
+        ADC1->SMPR1 |= 7u << (3 * (channel - 10));
+    } else {
+        ADC1->SMPR2 |= 7u << (3 * channel);
+    }
+}
+
+/**
+ * @brief 软件定时器函数：对循环缓冲区求平均，低通滤波后换算并发布
+ *
+ * 转换溢出(DMA未及时取走，如调试时暂停)时重新开始连续转换。
+ *
+ * @param arg 未使用
+ *
+ * @return void
+ */
+static void Battery_TimerFunc(void *arg) {
+    uint32_t sumV = 0, sumI = 0;
+    float v, i;
+    uint32_t n;
+
+    (void)arg;
+    if (ADC1->SR & ADC_SR_OVR) {
+        ADC1->SR &= ~ADC_SR_OVR;
+        ADC1->CR2 &= ~ADC_CR2_DMA;
+        ADC1->CR2 |= ADC_CR2_DMA;
+        ADC1->CR2 |= ADC_CR2_SWSTART;
+    }
+    for (n = 0; n < BATTERY_SCAN_COUNT; n++) {
+        sumV += batteryBuf[n][0];
+        sumI += batteryBuf[n][1];
+    }
+    v = (float)sumV * (BATTERY_RAW_TO_VOLT * BATTERY_VOLTAGE_SCALE);
+    i = ((float)sumI * BATTERY_RAW_TO_VOLT - BATTERY_CURRENT_OFFSET) * BATTERY_CURRENT_SCALE;
+
+    if (!batteryState.valid) {
+        // 第一次直接取平均值，不从0开始爬升；按满电单节电压判断节数
+        batteryState.voltage = v;
+        batteryState.current = i;
+        batteryState.cells = (uint8_t)(v / BATTERY_CELL_MAX) + 1;
+        batteryState.valid = 1;
+    } else {
+        batteryState.voltage += (v - batteryState.voltage) * BATTERY_FILTER_ALPHA;
+        batteryState.current += (i - batteryState.current) * BATTERY_FILTER_ALPHA;
+    }
+    // A·s换算为mAh
+    batteryState.consumedMah += batteryState.current * (BATTERY_PERIOD_S / 3.6f);
+    batteryState.low = (batteryState.voltage < batteryState.cells * BATTERY_CELL_MIN) ? 1 : 0;
+    tSeqLatchWrite(&batteryLatch, &batteryState);
+}
+
+/**
+ * @brief 配置ADC1扫描电压、电流两个通道，DMA循环写入缓冲区后开始连续转换，并创建求平均的定时器
+ *
+ * ADC时钟为PCLK2的1/8，每次转换492个ADC时钟，84MHz时每组扫描约94us，缓冲区约6ms刷新一遍
+ *
+ * @return 0成功，1 DMA初始化失败
+ */
+uint8_t Battery_Init(void) {
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    gpio.Pin = GPIO_PIN_0 | GPIO_PIN_1;
+    gpio.Mode = GPIO_MODE_ANALOG;
+    gpio.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOC, &gpio);
+
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    batteryDma.Instance = BATTERY_DMA_STREAM;
+    batteryDma.Init.Channel = DMA_CHANNEL_0;
+    batteryDma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    batteryDma.Init.PeriphInc = DMA_PINC_DISABLE;
+    batteryDma.Init.MemInc = DMA_MINC_ENABLE;
+    batteryDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    batteryDma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    batteryDma.Init.Mode = DMA_CIRCULAR;
+    batteryDma.Init.Priority = DMA_PRIORITY_LOW;
+    batteryDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&batteryDma) != HAL_OK) {
+        return 1;
+    }
+    BATTERY_DMA_STREAM->PAR = (uint32_t)&ADC1->DR;
+    BATTERY_DMA_STREAM->M0AR = (uint32_t)batteryBuf;
+    BATTERY_DMA_STREAM->NDTR = BATTERY_SCAN_COUNT * 2;
+    BATTERY_DMA_STREAM->CR |= DMA_SxCR_EN;
+
+    // 扫描两个通道，连续转换，每次转换后请求DMA且一直请求(DDS)，即循环模式
+    __HAL_RCC_ADC1_CLK_ENABLE();
+    ADC->CCR = (ADC->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0 | ADC_CCR_ADCPRE_1;
+    ADC1->CR1 = ADC_CR1_SCAN;
+    ADC1->CR2 = ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_ADON;
+    Battery_SetSampleTime(BATTERY_VOLTAGE_CHANNEL);
+    Battery_SetSampleTime(BATTERY_CURRENT_CHANNEL);
+    ADC1->SQR1 = (2 - 1) << ADC_SQR1_L_Pos;
+    ADC1->SQR3 = BATTERY_VOLTAGE_CHANNEL | (BATTERY_CURRENT_CHANNEL << ADC_SQR3_SQ2_Pos);
+    // ADON后等待ADC稳定(最长3us)再开始转换
+    tDelayUs(3);
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+
+    // 第一次等缓冲区写满一遍后再求平均
+    tTimerInit(&batteryTimer, tTimeMsToTicks(BATTERY_PERIOD_MS), tTimeMsToTicks(BATTERY_PERIOD_MS),
+               Battery_TimerFunc, (void *)0, TIMER_CONFIG_TYPE_SOFT);
+    tTimerStart(&batteryTimer);
+    return 0;
+}
+
+/**
+ * @brief 读取最近一次发布的电池状态，尚未发布时valid为0
+ *
+ * @param state 电池状态
+ *
+ * @return void
+ */
+void Battery_Get(BatteryState *state) {
+    tSeqLatchRead(&batteryLatch, state);
+}
+
+#endif
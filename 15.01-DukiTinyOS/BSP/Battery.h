@@ -0,0 +1,43 @@
+#ifndef __BATTERY_H
+#define __BATTERY_H
+
+#include "main.h"
+
+// 电池电压、电流测量：ADC1连续扫描两个通道，DMA2 Stream0 Channel0循环写入BATTERY_SCAN_COUNT组的缓冲区，
+// 不开传输中断，每个样本不占用CPU；软件定时器每BATTERY_PERIOD_MS对整个缓冲区求平均(等效于约6ms的滑动平均)，
+// 再经一阶低通滤除电机电流的纹波，换算为电压、电流及累计用电量后经双缓冲顺序锁发布，任何任务都可以不阻塞地读取
+// 引脚：PC0(ADC1_IN10)经分压电阻接电池，PC1(ADC1_IN11)接电流传感器的电压输出
+// 需开启TINYOS_ENABLE_TIMER(软件定时器)
+#define BATTERY_ENABLE              0
+
+#define BATTERY_VOLTAGE_CHANNEL     10      // ADC通道
+#define BATTERY_CURRENT_CHANNEL     11
+#define BATTERY_SCAN_COUNT          64      // 循环缓冲区的扫描组数，每组依次为电压、电流
+#define BATTERY_PERIOD_MS           20      // 求平均及发布的周期
+#define BATTERY_FILTER_HZ           2.0f    // 低通截止频率
+#define BATTERY_VREF                3.3f    // ADC参考电压(V)
+#define BATTERY_VOLTAGE_SCALE       11.0f   // 分压比，电池电压 = 引脚电压 * 分压比
+#define BATTERY_CURRENT_SCALE       40.0f   // 电流传感器的灵敏度(A/V)
+#define BATTERY_CURRENT_OFFSET      0.0f    // 零电流时的引脚电压(V)
+#define BATTERY_CELL_MAX            4.35f   // 单节满电电压，上电时据此判断串联节数
+#define BATTERY_CELL_MIN            3.3f    // 单节低压报警电压
+
+// 一次发布的电池状态
+typedef struct _BatteryState {
+    float voltage;          // 电池电压(V)
+    float current;          // 电流(A)
+    float consumedMah;      // 累计用电量(mAh)
+    uint8_t cells;          // 串联节数，第一次发布时判断
+    uint8_t low;            // 1：每节电压低于BATTERY_CELL_MIN
+    uint8_t valid;          // 0：尚未发布过
+} BatteryState;
+
+#if BATTERY_ENABLE == 1
+uint8_t Battery_Init(void);             // 配置ADC1及DMA并开始连续转换，创建定时器，返回0成功
+void Battery_Get(BatteryState *state);  // 读取最近一次发布的状态，可在任何任务中调用
+#else
+#define Battery_Init()          ((uint8_t)1)
+#define Battery_Get(state)      ((state)->valid = 0)
+#endif
+
+#endif // __BATTERY_H
@@ -0,0 +1,89 @@
+#include "BootProfile.h"
+#include "tinyOS.h"
+#include "MySerial.h"
+
+#if BOOT_PROFILE_ENABLE == 1
+
+static uint32_t bootCycles[BootStageCount];     // 各阶段结束时的周期数
+static uint32_t bootClock[BootStageCount];      // 记录时的主频，用于换算下一阶段
+static uint32_t bootMarked;
+
+#if TINYOS_ENABLE_SHELL == 1
+static tShellCmd bootCmd = {"boot", BootProfile_Print, "boot time of each stage"};
+#endif
+
+void BootProfile_Start(void)
+{
+    tCycleCounterInit();
+    bootMarked = 0;
+    BootProfile_Mark(BootStageReset);
+}
+
+void BootProfile_Mark(BootStage stage)
+{
+    uint32_t now = tCycleCounterGet();
+    uint32_t status;
+
+    if (bootMarked & (1u << stage)) {
+        return;
+    }
+    status = tTaskEnterCritical();
+    bootCycles[stage] = now;
+    bootClock[stage] = SystemCoreClock;
+    bootMarked |= 1u << stage;
+    tTaskExitCritical(status);
+#if TINYOS_ENABLE_SHELL == 1
+    if (stage == BootStageKernel) {
+        tShellAddCmd(&bootCmd);
+    }
+#endif
+}
+
+/**
+ * @brief 读取各阶段的耗时
+ *
+ * 一个阶段的周期数按其起点(上一个已记录阶段)的主频换算，系统时钟配置阶段因此按复位后的主频计算，
+ * 其中PLL锁定之后的一小段实际要快一些，结果略偏大。
+ * @param report 启动报告
+ */
+void BootProfile_GetReport(BootProfileReport *report)
+{
+    float total = 0.0f;
+    int i, last = -1;
+
+    report->marked = bootMarked;
+    for (i = 0; i < BootStageCount; i++) {
+        report->stageUs[i] = 0.0f;
+        report->totalUs[i] = 0.0f;
+        if (!(bootMarked & (1u << i))) {
+            continue;
+        }
+        if (last >= 0) {
+            report->stageUs[i] = (float)(bootCycles[i] - bootCycles[last]) * 1000000.0f / (float)bootClock[last];
+        }
+        total += report->stageUs[i];
+        report->totalUs[i] = total;
+        last = i;
+    }
+}
+
+void BootProfile_Print(void)
+{
+    static const char * const stageName[BootStageCount] = {
+        "reset", "clock", "kernel", "board", "scheduler", "app", "first cycle",
+    };
+    BootProfileReport report;
+    int i;
+
+    BootProfile_GetReport(&report);
+    printf("boot stage     stage(us)  total(us)\r\n");
+    for (i = 0; i < BootStageCount; i++) {
+        if (report.marked & (1u << i)) {
+            tPrintf("%-12s %10.1f %10.1f\r\n", stageName[i], report.stageUs[i], report.totalUs[i]);
+        } else {
+            printf("%-12s %10s %10s\r\n", stageName[i], "-", "-");
+        }
+    }
+}
+
+#endif
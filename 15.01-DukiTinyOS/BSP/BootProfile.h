@@ -0,0 +1,41 @@
+#ifndef __BOOTPROFILE_H
+#define __BOOTPROFILE_H
+
+#include "main.h"
+
+// 启动耗时统计：main入口启动DWT周期计数器，启动过程的各阶段结束时记下周期数，换算为us，
+// 最后一项即复位到第一个控制周期完成的时间(不含main之前的启动代码及分散加载)；
+// 时钟切换之前的阶段按切换前的主频换算；开启TINYOS_ENABLE_SHELL时登记boot命令输出报告
+#define BOOT_PROFILE_ENABLE     1
+
+// 启动的各阶段，按发生的顺序排列
+typedef enum _BootStage {
+    BootStageReset = 0,     // 进入main
+    BootStageClock,         // HAL及系统时钟配置完成，之后以全速运行
+    BootStageKernel,        // 内核初始化完成
+    BootStageBoard,         // 外设初始化完成
+    BootStageScheduler,     // 第一个任务(启动任务)开始运行
+    BootStageApp,           // tInitApp及系统服务任务创建完成
+    BootStageFirstCycle,    // 第一个控制周期完成，由应用标记，没有控制回路时不出现
+    BootStageCount
+} BootStage;
+
+// 启动报告，时间单位为us
+typedef struct _BootProfileReport {
+    uint32_t marked;                    // 已记录的阶段，第i位对应BootStage i
+    float stageUs[BootStageCount];      // 各阶段相对上一个已记录阶段的耗时
+    float totalUs[BootStageCount];      // 各阶段相对进入main的时间
+} BootProfileReport;
+
+#if BOOT_PROFILE_ENABLE == 1
+void BootProfile_Start(void);               // main入口调用，启动周期计数器并记下起点
+void BootProfile_Mark(BootStage stage);     // 一个阶段结束，同一阶段只记第一次，可在调度器启动前调用
+void BootProfile_GetReport(BootProfileReport *report);
+void BootProfile_Print(void);               // 报告经printf输出
+#else
+#define BootProfile_Start()
+#define BootProfile_Mark(stage)
+#define BootProfile_Print()
+#endif
+
+#endif // __BOOTPROFILE_H
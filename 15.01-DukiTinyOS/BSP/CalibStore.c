@@ -0,0 +1,79 @@
+#include "CalibStore.h"
+#include <string.h>
+
+// 记录布局：魔数、数据、校验和，各占一个备份寄存器
+#define CALIBSTORE_DATA_WORDS   ((sizeof(CalibStoreData) + 3) / 4)
+
+// 预处理阶段不能求sizeof，记录放不下时数组长度为负，编译报错
+typedef char CalibStoreSizeCheck[(CALIBSTORE_DATA_WORDS + 2 <= CALIBSTORE_MAX_WORDS) ? 1 : -1];
+
+static volatile uint32_t *const calibStoreReg = &RTC->BKP0R;
+
+// 备份域在复位后处于写保护状态，访问前打开PWR时钟并解除保护
+static void CalibStore_Unlock(void)
+{
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+}
+
+// 校验和：逐字循环左移后异或，再与魔数混合，全0或全1的寄存器不会被当作有效记录
+static uint32_t CalibStore_Checksum(const uint32_t *words, uint32_t count)
+{
+    uint32_t sum = CALIBSTORE_MAGIC;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        sum = ((sum << 5) | (sum >> 27)) ^ words[i];
+    }
+    return ~sum;
+}
+
+/**
+ * @brief 读取备份寄存器中的校准数据
+ *
+ * @param data 读到有效记录时写入
+ *
+ * @return uint8_t 0：有效；1：没有记录或校验失败
+ */
+uint8_t CalibStore_Load(CalibStoreData *data)
+{
+    uint32_t words[CALIBSTORE_DATA_WORDS];
+    uint32_t i;
+
+    CalibStore_Unlock();
+    if (calibStoreReg[0] != CALIBSTORE_MAGIC) {
+        return 1;
+    }
+    for (i = 0; i < CALIBSTORE_DATA_WORDS; i++) {
+        words[i] = calibStoreReg[1 + i];
+    }
+    if (calibStoreReg[1 + CALIBSTORE_DATA_WORDS] != CalibStore_Checksum(words, CALIBSTORE_DATA_WORDS)) {
+        return 1;
+    }
+    memcpy(data, words, sizeof(CalibStoreData));
+    return 0;
+}
+
+/**
+ * @brief 写入校准数据，先清除魔数，中途复位时留下的是无效记录而不是新旧混合的数据
+ *
+ * @param data 要保存的校准数据
+ *
+ * @return void
+ */
+void CalibStore_Save(const CalibStoreData *data)
+{
+    uint32_t words[CALIBSTORE_DATA_WORDS];
+    uint32_t i;
+
+    words[CALIBSTORE_DATA_WORDS - 1] = 0;
+    memcpy(words, data, sizeof(CalibStoreData));
+
+    CalibStore_Unlock();
+    calibStoreReg[0] = 0;
+    for (i = 0; i < CALIBSTORE_DATA_WORDS; i++) {
+        calibStoreReg[1 + i] = words[i];
+    }
+    calibStoreReg[1 + CALIBSTORE_DATA_WORDS] = CalibStore_Checksum(words, CALIBSTORE_DATA_WORDS);
+    calibStoreReg[0] = CALIBSTORE_MAGIC;
+}
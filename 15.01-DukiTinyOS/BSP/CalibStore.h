@@ -0,0 +1,21 @@
+#ifndef __CALIBSTORE_H
+#define __CALIBSTORE_H
+
+#include "main.h"
+
+// 校准数据存放在RTC备份寄存器(BKP0R起)中：复位、看门狗复位后保持，接VBAT时掉电也保持，
+// 不占用Flash扇区也不需要擦写；记录以魔数开头、校验和结尾，内容不完整或版本不符时视为无效
+#define CALIBSTORE_MAGIC        0x43414C02u // "CAL"+版本号，记录布局变化时递增
+#define CALIBSTORE_MAX_WORDS    20          // STM32F401共20个32位备份寄存器
+
+// 持久化的校准数据
+typedef struct _CalibStoreData {
+    float gyroBias[3];      // 陀螺仪零偏(rad/s)，由姿态解算在静止时在线估计
+    float accelScale[3];    // 加速度计比例系数，由AccelCalib在目标板上拟合
+    float accelOffset[3];   // 加速度计零偏(g)
+} CalibStoreData;
+
+uint8_t CalibStore_Load(CalibStoreData *data);          // 读取校准数据，返回0表示有效，1表示无效(data不变)
+void CalibStore_Save(const CalibStoreData *data);       // 写入校准数据
+
+#endif
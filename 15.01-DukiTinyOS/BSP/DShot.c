@@ -0,0 +1,238 @@
+#include "DShot.h"
+#include "Motor.h"
+
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+
+#include "tim.h"
+
+#define DSHOT_FRAME_BITS        16
+#define DSHOT_FRAME_SLOTS       (DSHOT_FRAME_BITS + 1)  // 帧后补一个比较值为0的位周期，保持空闲电平
+#define DSHOT_DMA_STREAM        DMA1_Stream4
+#define DSHOT_DMA_FLAGS         (DMA_HIFCR_CTCIF4 | DMA_HIFCR_CHTIF4 | DMA_HIFCR_CTEIF4 | DMA_HIFCR_CDMEIF4 | DMA_HIFCR_CFEIF4)
+
+// 位缓冲区：每个位周期依次为CCR1~CCR4，DMAR突发按字访问
+static uint32_t dshotBuf[DSHOT_FRAME_SLOTS][MOTOR_COUNT];
+static uint32_t dshotBit0;
+static uint32_t dshotBit1;
+static uint32_t dshotRate;
+static volatile uint8_t dshotTelemetryChannel = 0xFF;  // 下一帧请求遥测的通道，0xFF为不请求
+static DMA_HandleTypeDef dshotDma;
+
+/**
+ * @brief 把TIM3配置为DShot输出
+ *
+ * 定时器时钟按APB1分频换算(APB1分频不为1时定时器时钟加倍)，一个计数周期为一位；
+ * 每个位周期CH1比较匹配时产生DMA请求，DMA经DMAR把下一位的四个比较值写入预装载寄存器，
+ * 在下一次更新事件同时生效。调用前需已调用MX_TIM3_Init。
+ *
+ * @param rate 位速率，DSHOT150、DSHOT300或DSHOT600
+ *
+ * @return 0成功，1参数错误或DMA初始化失败
+ */
+//按当前的定时器时钟计算一位的计数周期及两种位的比较值，返回计数周期
+static uint32_t DShot_BitTiming(void) {
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+    uint32_t period;
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clk *= 2;
+    }
+    period = clk / (dshotRate * 1000);
+    dshotBit1 = period * 3 / 4;
+    dshotBit0 = period * 3 / 8;
+    return period;
+}
+
+uint8_t DShot_Init(uint32_t rate) {
+    uint32_t period;
+
+    if ((rate != DSHOT150) && (rate != DSHOT300) && (rate != DSHOT600)) {
+        return 1;
+    }
+    dshotRate = rate;
+    period = DShot_BitTiming();
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    dshotDma.Instance = DSHOT_DMA_STREAM;
+    dshotDma.Init.Channel = DMA_CHANNEL_5;
+    dshotDma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    dshotDma.Init.PeriphInc = DMA_PINC_DISABLE;
+    dshotDma.Init.MemInc = DMA_MINC_ENABLE;
+    dshotDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    dshotDma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    dshotDma.Init.Mode = DMA_NORMAL;
+    dshotDma.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+    dshotDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&dshotDma) != HAL_OK) {
+        return 1;
+    }
+    DSHOT_DMA_STREAM->PAR = (uint32_t)&TIM3->DMAR;
+
+    // 停止计数后改为位速率，比较值清零(输出空闲电平)，预装载保证每一位在更新事件整体切换
+    TIM3->CR1 &= ~TIM_CR1_CEN;
+    TIM3->DIER &= ~TIM_DIER_CC1DE;
+    TIM3->PSC = 0;
+    TIM3->ARR = period - 1;
+    TIM3->CCR1 = 0;
+    TIM3->CCR2 = 0;
+    TIM3->CCR3 = 0;
+    TIM3->CCR4 = 0;
+    TIM3->CCMR1 |= TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE;
+    TIM3->CCMR2 |= TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE;
+#if DSHOT_BIDIR == 1
+    TIM3->CCER |= TIM_CCER_CC1P | TIM_CCER_CC2P | TIM_CCER_CC3P | TIM_CCER_CC4P;
+#else
+    TIM3->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC2P | TIM_CCER_CC3P | TIM_CCER_CC4P);
+#endif
+    TIM3->DCR = TIM_DMABASE_CCR1 | TIM_DMABURSTLENGTH_4TRANSFERS;
+    TIM3->CCER |= TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E | TIM_CCER_CC4E;
+    TIM3->EGR = TIM_EGR_UG;
+    // 自动重装载预装载，调频时新的位周期从下一位开始
+    TIM3->CR1 |= TIM_CR1_ARPE | TIM_CR1_CEN;
+    return 0;
+}
+
+/**
+ * @brief 定时器时钟改变后按新的时钟重新计算位周期，在调频的临界区内调用，只写寄存器
+ *
+ * 正在发送的一帧其余各位按新时钟计数，电调校验不通过时丢弃该帧；下一帧起使用新的比较值。
+ * 自动重装载已预装载(DShot_Init中打开)，新的位周期从下一位开始。
+ */
+void DShot_ClockChanged(void) {
+    if (dshotRate == 0) {
+        return;
+    }
+    TIM3->ARR = DShot_BitTiming() - 1;
+}
+
+/**
+ * @brief 组成一帧DShot数据
+ *
+ * @param value 油门值(48 ~ 2047)、命令(1 ~ 47)或0(停转)，超出11位时截断
+ * @param telemetry 非0时请求电调回送遥测
+ *
+ * @return 16位帧，高位先发
+ */
+uint16_t DShot_Encode(uint16_t value, uint8_t telemetry) {
+    uint16_t packet = (uint16_t)(((value & 0x07FF) << 1) | (telemetry ? 1 : 0));
+    uint16_t crc = (packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F;
+
+#if DSHOT_BIDIR == 1
+    crc = (~crc) & 0x0F;
+#endif
+    return (uint16_t)((packet << 4) | crc);
+}
+
+/**
+ * @brief 四个通道同时发送一帧
+ *
+ * 先关闭CH1的DMA请求，丢弃上一帧结束后空闲期间挂起的请求；第一位直接写入比较寄存器并产生更新事件，
+ * 计数器从0开始输出第一位，其后每一位由DMA在上一位的比较匹配时写入。
+ * 帧末的0比较值写入后DMA传输结束，输出保持空闲电平。可在中断中调用。
+ *
+ * @param value 四个通道的油门值或命令，value[0]对应通道1
+ *
+ * @return 0开始发送，1上一帧仍在发送，本帧丢弃
+ */
+uint8_t DShot_Write(const uint16_t *value) {
+    uint16_t frame[MOTOR_COUNT];
+    uint32_t status;
+    int bit, ch;
+
+    if (DSHOT_DMA_STREAM->CR & DMA_SxCR_EN) {
+        return 1;
+    }
+
+    // 遥测请求只随一帧发出，本帧被丢弃时留到下一帧
+    for (ch = 0; ch < MOTOR_COUNT; ch++) {
+        frame[ch] = DShot_Encode(value[ch], ch == dshotTelemetryChannel);
+    }
+    dshotTelemetryChannel = 0xFF;
+    for (bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        for (ch = 0; ch < MOTOR_COUNT; ch++) {
+            dshotBuf[bit][ch] = (frame[ch] & (0x8000u >> bit)) ? dshotBit1 : dshotBit0;
+        }
+    }
+    for (ch = 0; ch < MOTOR_COUNT; ch++) {
+        dshotBuf[DSHOT_FRAME_BITS][ch] = 0;
+    }
+
+    status = tTaskEnterCritical();
+    TIM3->DIER &= ~TIM_DIER_CC1DE;
+    DMA1->HIFCR = DSHOT_DMA_FLAGS;
+    DSHOT_DMA_STREAM->M0AR = (uint32_t)dshotBuf[1];
+    DSHOT_DMA_STREAM->NDTR = (DSHOT_FRAME_SLOTS - 1) * MOTOR_COUNT;
+    DSHOT_DMA_STREAM->CR |= DMA_SxCR_EN;
+    TIM3->CCR1 = dshotBuf[0][0];
+    TIM3->CCR2 = dshotBuf[0][1];
+    TIM3->CCR3 = dshotBuf[0][2];
+    TIM3->CCR4 = dshotBuf[0][3];
+    TIM3->EGR = TIM_EGR_UG;
+    TIM3->DIER |= TIM_DIER_CC1DE;
+    tTaskExitCritical(status);
+    return 0;
+}
+
+/**
+ * @brief 请求一个通道的电调回送遥测
+ *
+ * 只影响下一个成功发送的帧，该通道的遥测请求位置1，KISS等电调随后在遥测串口上回送一帧；
+ * 一帧之内只能请求一个通道，各电调的遥测线通常并在一起，再次调用会改为请求新的通道。
+ *
+ * @param channel 通道(0 ~ MOTOR_COUNT - 1)，超出范围时取消请求
+ *
+ * @return void
+ */
+void DShot_RequestTelemetry(uint8_t channel) {
+    dshotTelemetryChannel = (channel < MOTOR_COUNT) ? channel : 0xFF;
+}
+
+#endif
+
+// GCR 5位码到4位数据的映射，非法码为0xFF
+static const uint8_t dshotGcrTable[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x09, 0x0A, 0x0B, 0xFF, 0x0D, 0x0E, 0x0F,
+    0xFF, 0xFF, 0x02, 0x03, 0xFF, 0x05, 0x06, 0x07,
+    0xFF, 0x00, 0x08, 0x01, 0xFF, 0x04, 0x0C, 0xFF,
+};
+
+/**
+ * @brief 解码双向DShot的回送数据
+ *
+ * 回送数据为21位电平序列，电平翻转表示1(raw ^ raw >> 1得到20位GCR码)，每5位GCR码对应4位数据，
+ * 组成16位：3位指数、9位尾数、4位校验；周期(us) = 尾数 << 指数，电转速 = 60000000 / 周期。
+ * 纯计算，与MOTOR_PROTOCOL无关，可在主机上验证。
+ *
+ * @param raw 按回送位速率(发送位速率的5/4)采样的21位电平，最先收到的位在最高位
+ * @param erpm 输出电转速(eRPM，除以极对数为机械转速)，电机停转时为0
+ *
+ * @return 0成功，1存在非法GCR码或校验错误
+ */
+uint8_t DShot_DecodeTelemetry(uint32_t raw, uint32_t *erpm) {
+    uint32_t gcr = (raw ^ (raw >> 1)) & 0xFFFFF;
+    uint32_t value = 0;
+    uint32_t period;
+    int i;
+
+    for (i = 3; i >= 0; i--) {
+        uint8_t nibble = dshotGcrTable[(gcr >> (i * 5)) & 0x1F];
+
+        if (nibble == 0xFF) {
+            return 1;
+        }
+        value = (value << 4) | nibble;
+    }
+    if (((value ^ (value >> 4) ^ (value >> 8) ^ (value >> 12)) & 0x0F) != 0x0F) {
+        return 1;
+    }
+
+    value >>= 4;
+    if (value == 0x0FFF) {
+        *erpm = 0;
+        return 0;
+    }
+    period = (value & 0x01FF) << (value >> 9);
+    *erpm = (period != 0) ? (60000000u / period) : 0;
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef __DSHOT_H
+#define __DSHOT_H
+
+#include "main.h"
+
+// DShot数字电调协议：每帧16位，高11位为油门值(0停转，1~47为命令，48~2047为油门)，1位请求遥测，低4位为校验；
+// 每一位是一个固定周期的脉冲，高电平占3/4为1、占3/8为0。TIM3改为按位速率计数，预先把整帧展开成每一位、
+// 每个通道的比较值，由TIM3_CH1的DMA请求(DMA1 Stream4 Channel5)经DMAR每个位周期突发写入CCR1~CCR4，
+// 四个电机同时发送；DShot600一帧约27us，CPU只负责填缓冲区
+#define DSHOT150                150     // 位速率(kbit/s)
+#define DSHOT300                300
+#define DSHOT600                600
+
+#define DSHOT_CMD_MAX           47      // 1~47为命令(如电机转向、蜂鸣)，需连续发送多帧才执行
+#define DSHOT_THROTTLE_MIN      48
+#define DSHOT_THROTTLE_MAX      2047
+
+// 双向DShot：信号反相(空闲为高)，校验取反，电调在每帧后约30us用GCR编码回送电转速(eRPM)
+// 本驱动只负责发送反相帧及解码回送数据，回送信号的采样需要另配定时器的输入捕获与DMA(TIM3各通道的DMA流
+// 与I2C2冲突)，采样得到的21位电平序列交给DShot_DecodeTelemetry
+#define DSHOT_BIDIR             0
+
+uint8_t DShot_Init(uint32_t rate);          // 把TIM3配置为DShot输出，rate为DSHOT150/300/600，返回0成功
+void DShot_ClockChanged(void);              // 定时器时钟改变后重新计算位周期，由电机驱动的调频通知调用
+uint16_t DShot_Encode(uint16_t value, uint8_t telemetry); // 组成一帧：油门值或命令、遥测请求位、校验
+uint8_t DShot_Write(const uint16_t *value); // 四个通道同时发送一帧，value[0]对应通道1；上一帧仍在发送时返回1
+uint8_t DShot_DecodeTelemetry(uint32_t raw, uint32_t *erpm); // 解码双向DShot回送的21位电平序列，校验通过返回0
+void DShot_RequestTelemetry(uint8_t channel); // 下一帧中通道channel(0 ~ MOTOR_COUNT - 1)置遥测请求位，电调经遥测串口回送一帧
+
+#endif // __DSHOT_H
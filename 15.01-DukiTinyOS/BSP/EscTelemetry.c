@@ -0,0 +1,270 @@
+#include "EscTelemetry.h"
+#include "DShot.h"
+#include <string.h>
+
+#if ESC_TELEMETRY_ENABLE == 1
+
+#if MOTOR_PROTOCOL != MOTOR_PROTOCOL_DSHOT
+#error "ESC_TELEMETRY_ENABLE requires MOTOR_PROTOCOL_DSHOT"
+#endif
+#if (ESC_TELEMETRY_SOURCE == ESC_TELEMETRY_BIDIR) && (DSHOT_BIDIR == 0)
+#error "ESC_TELEMETRY_BIDIR requires DSHOT_BIDIR"
+#endif
+
+#define ESC_TELEMETRY_KISS_FRAME    10
+#define ESC_TELEMETRY_TIMEOUT_US    (ESC_TELEMETRY_TIMEOUT_MS * 1000u)
+
+// 最新的转速：角速度级发布，其它任务订阅
+TINYOS_TOPIC_DEFINE(escRpmTopic, EscRpm);
+
+static EscRpm escRpm;                       // 只由调用EscTelemetry_Poll的任务读写
+static uint8_t escSeenMask;                 // 收到过数据的电机
+static EscTelemetryStat escStat;
+
+#if ESC_TELEMETRY_SOURCE == ESC_TELEMETRY_KISS
+static UART_HandleTypeDef escUart;
+static DMA_HandleTypeDef escDma;
+static uint8_t escDmaBuf[ESC_TELEMETRY_DMA_SIZE];
+static uint32_t escDmaPos;
+static uint8_t escFrame[ESC_TELEMETRY_KISS_FRAME];
+static uint32_t escFrameLen;
+static uint8_t escRequestMotor;             // 正在等待回送的电机
+static uint32_t escRequestUs;               // 发出请求的时间
+#else
+static volatile uint32_t escBidirErpm[MOTOR_COUNT];
+static volatile uint8_t escBidirMask;       // 中断写入、尚未取走的通道
+#endif
+
+//记录一个电机的电转速
+static void EscTelemetry_SetMotor(uint8_t motor, uint32_t erpm, uint32_t now) {
+    escRpm.rpm[motor] = (float)erpm * (2.0f / ESC_TELEMETRY_MOTOR_POLES);
+    escRpm.hz[motor] = escRpm.rpm[motor] * (1.0f / 60.0f);
+    escRpm.timeUs[motor] = now;
+    escSeenMask |= (uint8_t)(1u << motor);
+}
+
+#if ESC_TELEMETRY_SOURCE == ESC_TELEMETRY_KISS
+//KISS遥测的CRC8，多项式0x07，高位先行
+static uint8_t EscTelemetry_Crc8(const uint8_t *data, uint32_t len) {
+    uint8_t crc = 0;
+    uint32_t i;
+    int bit;
+
+    for (i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+//校验并解析一帧：温度(°C)、电压(10mV)、电流(10mA)、耗电(mAh)、eRPM/100，多字节均为高字节在前
+static uint8_t EscTelemetry_ParseKiss(const uint8_t *frame, uint8_t motor, uint32_t *erpm) {
+    if (EscTelemetry_Crc8(frame, ESC_TELEMETRY_KISS_FRAME - 1) != frame[ESC_TELEMETRY_KISS_FRAME - 1]) {
+        escStat.crcErrors++;
+        return 1;
+    }
+    escStat.temperature[motor] = (float)frame[0];
+    escStat.voltage[motor] = (float)(((uint16_t)frame[1] << 8) | frame[2]) * 0.01f;
+    escStat.current[motor] = (float)(((uint16_t)frame[3] << 8) | frame[4]) * 0.01f;
+    *erpm = (((uint32_t)frame[7] << 8) | frame[8]) * 100u;
+    escStat.frames++;
+    return 0;
+}
+
+//请求下一个电机，丢弃未收齐的字节；迟到的字节与下一帧拼在一起时由校验丢弃
+static void EscTelemetry_RequestNext(uint32_t now) {
+    escRequestMotor = (uint8_t)((escRequestMotor + 1) % MOTOR_COUNT);
+    escFrameLen = 0;
+    escRequestUs = now;
+    DShot_RequestTelemetry(escRequestMotor);
+}
+
+//取出DMA缓冲区中的新字节，收齐一帧或超时后请求下一个电机，有新的转速时返回1
+static uint8_t EscTelemetry_Drain(uint32_t now) {
+    uint32_t pos = ESC_TELEMETRY_DMA_SIZE - __HAL_DMA_GET_COUNTER(&escDma);
+    uint32_t erpm;
+    uint8_t updated = 0;
+
+    if (pos == ESC_TELEMETRY_DMA_SIZE) {
+        pos = 0;
+    }
+    while (escDmaPos != pos) {
+        escFrame[escFrameLen++] = escDmaBuf[escDmaPos];
+        escDmaPos = (escDmaPos + 1) % ESC_TELEMETRY_DMA_SIZE;
+        if (escFrameLen < ESC_TELEMETRY_KISS_FRAME) {
+            continue;
+        }
+        if (EscTelemetry_ParseKiss(escFrame, escRequestMotor, &erpm) == 0) {
+            EscTelemetry_SetMotor(escRequestMotor, erpm, now);
+            updated = 1;
+        }
+        EscTelemetry_RequestNext(now);
+    }
+    if ((now - escRequestUs) > ESC_TELEMETRY_REPLY_US) {
+        escStat.timeouts++;
+        EscTelemetry_RequestNext(now);
+    }
+    return updated;
+}
+
+/**
+ * @brief 配置USART6只接收及其循环DMA，请求第一个电机的遥测
+ *
+ * 与SerialRC相同，串口及DMA都不开中断，由EscTelemetry_Poll取出新字节。需在Motor_Init(DShot_Init)之后调用。
+ *
+ * @retval 0: 成功, 1: 串口或DMA初始化失败
+ */
+uint8_t EscTelemetry_Init(void) {
+    GPIO_InitTypeDef gpio = {0};
+
+    memset(&escRpm, 0, sizeof(escRpm));
+    memset(&escStat, 0, sizeof(escStat));
+    escSeenMask = 0;
+    escDmaPos = 0;
+
+    __HAL_RCC_USART6_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    gpio.Pin = GPIO_PIN_7;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    gpio.Alternate = GPIO_AF8_USART6;
+    HAL_GPIO_Init(GPIOC, &gpio);
+
+    escUart.Instance = USART6;
+    escUart.Init.BaudRate = ESC_TELEMETRY_BAUDRATE;
+    escUart.Init.WordLength = UART_WORDLENGTH_8B;
+    escUart.Init.StopBits = UART_STOPBITS_1;
+    escUart.Init.Parity = UART_PARITY_NONE;
+    escUart.Init.Mode = UART_MODE_RX;
+    escUart.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    escUart.Init.OverSampling = UART_OVERSAMPLING_16;
+    if (HAL_UART_Init(&escUart) != HAL_OK) {
+        return 1;
+    }
+
+    escDma.Instance = DMA2_Stream1;
+    escDma.Init.Channel = DMA_CHANNEL_5;
+    escDma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    escDma.Init.PeriphInc = DMA_PINC_DISABLE;
+    escDma.Init.MemInc = DMA_MINC_ENABLE;
+    escDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    escDma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    escDma.Init.Mode = DMA_CIRCULAR;
+    escDma.Init.Priority = DMA_PRIORITY_MEDIUM;
+    escDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&escDma) != HAL_OK) {
+        return 1;
+    }
+    __HAL_LINKDMA(&escUart, hdmarx, escDma);
+    if (HAL_UART_Receive_DMA(&escUart, escDmaBuf, ESC_TELEMETRY_DMA_SIZE) != HAL_OK) {
+        return 1;
+    }
+
+    // 从最后一个电机的下一个即电机0开始
+    escRequestMotor = MOTOR_COUNT - 1;
+    EscTelemetry_RequestNext((uint32_t)tTimeGetMicros());
+    return 0;
+}
+#else
+uint8_t EscTelemetry_Init(void) {
+    memset(&escRpm, 0, sizeof(escRpm));
+    memset(&escStat, 0, sizeof(escStat));
+    escSeenMask = 0;
+    escBidirMask = 0;
+    return 0;
+}
+
+/**
+ * @brief 解码各通道双向DShot的回送，校验通过的通道留给EscTelemetry_Poll取走
+ *
+ * @param raw MOTOR_COUNT个通道的21位电平序列，格式见DShot_DecodeTelemetry
+ *
+ * @return void
+ */
+void EscTelemetry_PushBidir(const uint32_t *raw) {
+    uint32_t erpm;
+    uint32_t status;
+    int ch;
+
+    for (ch = 0; ch < MOTOR_COUNT; ch++) {
+        if (DShot_DecodeTelemetry(raw[ch], &erpm) != 0) {
+            escStat.crcErrors++;
+            continue;
+        }
+        status = tTaskEnterCritical();
+        escBidirErpm[ch] = erpm;
+        escBidirMask |= (uint8_t)(1u << ch);
+        tTaskExitCritical(status);
+        escStat.frames++;
+    }
+}
+
+//取走中断解码好的通道，有新的转速时返回1
+static uint8_t EscTelemetry_Drain(uint32_t now) {
+    uint32_t erpm[MOTOR_COUNT];
+    uint32_t status;
+    uint8_t mask;
+    int ch;
+
+    status = tTaskEnterCritical();
+    mask = escBidirMask;
+    escBidirMask = 0;
+    for (ch = 0; ch < MOTOR_COUNT; ch++) {
+        erpm[ch] = escBidirErpm[ch];
+    }
+    tTaskExitCritical(status);
+
+    for (ch = 0; ch < MOTOR_COUNT; ch++) {
+        if (mask & (1u << ch)) {
+            EscTelemetry_SetMotor((uint8_t)ch, erpm[ch], now);
+        }
+    }
+    return (mask != 0) ? 1 : 0;
+}
+#endif
+
+/**
+ * @brief 取出新到的转速，有更新或有电机超时时发布escRpmTopic
+ *
+ * 只能由一个任务调用(通常为角速度级，每个周期一次)，KISS时还负责轮流发出遥测请求，请求随下一帧DShot发出。
+ *
+ * @param rpm 有更新时写入各电机的最新转速
+ *
+ * @retval 1: 有更新，rpm有效, 0: 没有新数据
+ */
+uint8_t EscTelemetry_Poll(EscRpm *rpm) {
+    uint32_t now = (uint32_t)tTimeGetMicros();
+    uint8_t updated = EscTelemetry_Drain(now);
+    uint8_t mask = 0;
+    int i;
+
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        if ((escSeenMask & (1u << i)) && ((now - escRpm.timeUs[i]) <= ESC_TELEMETRY_TIMEOUT_US)) {
+            mask |= (uint8_t)(1u << i);
+        }
+    }
+    if (mask != escRpm.validMask) {
+        escRpm.validMask = mask;
+        updated = 1;
+    }
+    if (!updated) {
+        return 0;
+    }
+    tTopicPublish(&escRpmTopic, &escRpm);
+    *rpm = escRpm;
+    return 1;
+}
+
+void EscTelemetry_GetStat(EscTelemetryStat *stat) {
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = escStat;
+    tTaskExitCritical(status);
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __ESCTELEMETRY_H
+#define __ESCTELEMETRY_H
+
+#include "main.h"
+#include "Motor.h"
+#include "tinyOS.h"
+
+// 电调转速遥测：取得每个电机的转速，发布到escRpmTopic，并交给角速度级的转速陷波。两种来源：
+// KISS遥测：在DShot帧中轮流对一个电机置遥测请求位，该电调约1ms内在遥测串口回送10字节(温度、电压、电流、
+//   耗电、eRPM/100、CRC8)。各电调的遥测线并接到USART6_RX(PC7)，由DMA2 Stream1循环接收，不开中断；
+//   角速度级每个周期调用EscTelemetry_Poll取出新字节，收齐一帧或超时后请求下一个电机，1kHz时每个电机约8ms更新一次
+// 双向DShot：电调在每帧后回送eRPM，四个电机每帧都更新；回送信号的采样需另配定时器输入捕获(见DShot.h)，
+//   采样完成处调用EscTelemetry_PushBidir，解码后的转速同样由EscTelemetry_Poll取出并发布
+// 需MOTOR_PROTOCOL为MOTOR_PROTOCOL_DSHOT
+#define ESC_TELEMETRY_ENABLE        0
+#define ESC_TELEMETRY_KISS          0
+#define ESC_TELEMETRY_BIDIR         1
+#define ESC_TELEMETRY_SOURCE        ESC_TELEMETRY_KISS
+
+#define ESC_TELEMETRY_BAUDRATE      115200  // KISS遥测串口，8N1
+#define ESC_TELEMETRY_DMA_SIZE      64      // DMA循环接收缓冲区，需大于两次Poll之间收到的字节数
+#define ESC_TELEMETRY_REPLY_US      2000    // 请求后等待一帧回送的时间，超时则请求下一个电机
+#define ESC_TELEMETRY_TIMEOUT_MS    50      // 超过该时间没有更新的电机视为无效
+#define ESC_TELEMETRY_MOTOR_POLES   14      // 电机磁极数，eRPM除以极对数为机械转速
+
+// 各电机的转速
+typedef struct _EscRpm {
+    float rpm[MOTOR_COUNT];         // 机械转速(转/分)
+    float hz[MOTOR_COUNT];          // 机械转频(Hz)，电机噪声的基频
+    uint32_t timeUs[MOTOR_COUNT];   // 最近一次更新的时间(us)
+    uint8_t validMask;              // 位i为1：电机i在ESC_TELEMETRY_TIMEOUT_MS内有更新
+} EscRpm;
+
+typedef struct _EscTelemetryStat {
+    uint32_t frames;                // 收到的有效帧(KISS)或解码成功的回送(双向DShot)
+    uint32_t crcErrors;             // 校验错误而丢弃的帧
+    uint32_t timeouts;              // 请求后没有收齐一帧的次数(KISS)
+    float temperature[MOTOR_COUNT]; // 电调温度(°C)，只有KISS遥测有
+    float voltage[MOTOR_COUNT];     // 电调测得的电压(V)，只有KISS遥测有
+    float current[MOTOR_COUNT];     // 电流(A)，只有KISS遥测有
+} EscTelemetryStat;
+
+#if ESC_TELEMETRY_ENABLE == 1
+TINYOS_TOPIC_DECLARE(escRpmTopic);
+
+uint8_t EscTelemetry_Init(void);                    // KISS时配置USART6及DMA并请求第一个电机，返回0成功
+uint8_t EscTelemetry_Poll(EscRpm *rpm);             // 角速度级每个周期调用，有新的转速时填写rpm、发布escRpmTopic并返回1
+#if ESC_TELEMETRY_SOURCE == ESC_TELEMETRY_BIDIR
+void EscTelemetry_PushBidir(const uint32_t *raw);   // 双向DShot回送采样完成时调用，raw为各通道的21位电平序列，可在中断中调用
+#endif
+void EscTelemetry_GetStat(EscTelemetryStat *stat);
+#else
+#define EscTelemetry_Init()         1
+#define EscTelemetry_Poll(rpm)      0
+#endif
+
+#endif // __ESCTELEMETRY_H
@@ -0,0 +1,311 @@
+#include "FlashKV.h"
+#include <string.h>
+
+#define FLASHKV_END             (FLASHKV_BASE + FLASHKV_SIZE)
+#define FLASHKV_ERASED          0xFFFFFFFFu
+#define FLASHKV_KEY_INVALID     0xFFFFu
+
+// 记录占用的字节数：头字、数据、CRC
+#define FLASHKV_RECORD_SIZE(len) (4u + (((len) + 3u) & ~3u) + 4u)
+
+typedef struct _FlashKVEntry {
+    uint16_t key;
+    uint16_t len;
+    uint32_t addr;      // 最新一条有效记录的地址
+} FlashKVEntry;
+
+static FlashKVEntry kvIndex[FLASHKV_MAX_KEYS];
+static uint32_t kvCount;
+static uint32_t kvFree;         // 下一条记录的写入地址，扇区有损坏时置为FLASHKV_END，下次写入先压缩
+static uint8_t kvReady;
+
+/**
+ * @brief 用硬件CRC单元(CRC-32/MPEG-2，每字一个周期)计算一条记录的CRC
+ *
+ * @param data 数据，最后不足一字的部分按0xFF填充计算，与Flash中的填充一致
+ * @param len 数据字节数
+ * @param header 记录头字，先于数据参与计算
+ *
+ * @return uint32_t CRC
+ */
+static uint32_t FlashKV_Crc(const uint8_t *data, uint32_t len, uint32_t header)
+{
+    uint32_t i;
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = header;
+    for (i = 0; i + 4 <= len; i += 4) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        CRC->DR = word;
+    }
+    if (i < len) {
+        uint32_t word = FLASHKV_ERASED;
+        memcpy(&word, data + i, len - i);
+        CRC->DR = word;
+    }
+    return CRC->DR;
+}
+
+// 检查addr处的记录是否完整：头字合理、不越界且CRC正确
+static uint8_t FlashKV_RecordValid(uint32_t addr)
+{
+    uint32_t header = *(const volatile uint32_t *)addr;
+    uint32_t len = header & 0xFFFFu;
+    uint32_t size = FLASHKV_RECORD_SIZE(len);
+
+    if ((header == FLASHKV_ERASED) || (len > FLASHKV_MAX_VALUE) || (addr + size > FLASHKV_END)) {
+        return 0;
+    }
+    return FlashKV_Crc((const uint8_t *)(addr + 4), len, header) == *(const volatile uint32_t *)(addr + size - 4);
+}
+
+static FlashKVEntry *FlashKV_Find(uint16_t key)
+{
+    uint32_t i;
+
+    for (i = 0; i < kvCount; i++) {
+        if (kvIndex[i].key == key) {
+            return &kvIndex[i];
+        }
+    }
+    return (FlashKVEntry *)0;
+}
+
+// 记下key的一条记录，后出现的记录覆盖先出现的；键数超出时忽略
+static void FlashKV_Index(uint16_t key, uint16_t len, uint32_t addr)
+{
+    FlashKVEntry *entry = FlashKV_Find(key);
+
+    if (entry == (FlashKVEntry *)0) {
+        if (kvCount >= FLASHKV_MAX_KEYS) {
+            return;
+        }
+        entry = &kvIndex[kvCount++];
+        entry->key = key;
+    }
+    entry->len = len;
+    entry->addr = addr;
+}
+
+/**
+ * @brief 扫描扇区：只读头字沿记录链前进，建立各键最新记录的索引，再校验这些记录的CRC；
+ *        最新记录损坏(写入中掉电)时重新扫描，取该键上一条有效记录。一般只读几十个字，耗时为微秒级
+ *
+ * @param void
+ *
+ * @return void
+ */
+static void FlashKV_Scan(void)
+{
+    uint32_t addr = FLASHKV_BASE;
+    uint32_t i;
+
+    kvCount = 0;
+    while (addr + 8 <= FLASHKV_END) {
+        uint32_t header = *(const volatile uint32_t *)addr;
+        uint32_t key = header >> 16;
+        uint32_t len = header & 0xFFFFu;
+
+        if (header == FLASHKV_ERASED) {
+            break;
+        }
+        if ((key == 0) || (key == FLASHKV_KEY_INVALID) || (len > FLASHKV_MAX_VALUE) ||
+            (addr + FLASHKV_RECORD_SIZE(len) > FLASHKV_END)) {
+            addr = FLASHKV_END; // 头字损坏，无法确定后续记录的位置
+            break;
+        }
+        FlashKV_Index((uint16_t)key, (uint16_t)len, addr);
+        addr += FLASHKV_RECORD_SIZE(len);
+    }
+    kvFree = addr;
+
+    for (i = 0; i < kvCount; i++) {
+        uint32_t scan, last = 0;
+
+        if (FlashKV_RecordValid(kvIndex[i].addr)) {
+            continue;
+        }
+        for (scan = FLASHKV_BASE; scan < kvIndex[i].addr; scan += FLASHKV_RECORD_SIZE(*(const volatile uint32_t *)scan & 0xFFFFu)) {
+            if (((*(const volatile uint32_t *)scan >> 16) == kvIndex[i].key) && FlashKV_RecordValid(scan)) {
+                last = scan;
+            }
+        }
+        kvIndex[i].addr = last;
+        kvIndex[i].len = (last != 0) ? (uint16_t)(*(const volatile uint32_t *)last & 0xFFFFu) : 0;
+    }
+}
+
+uint8_t FlashKV_Init(void)
+{
+    if (!kvReady) {
+        FlashKV_Scan();
+        kvReady = 1;
+    }
+    return 0;
+}
+
+uint32_t FlashKV_Read(uint16_t key, void *buf, uint32_t size)
+{
+    FlashKVEntry *entry = FlashKV_Find(key);
+
+    if ((entry == (FlashKVEntry *)0) || (entry->addr == 0)) {
+        return 0;
+    }
+    memcpy(buf, (const void *)(entry->addr + 4), (entry->len < size) ? entry->len : size);
+    return entry->len;
+}
+
+uint32_t FlashKV_FreeBytes(void)
+{
+    return FLASHKV_END - kvFree;
+}
+
+// 在addr处按字编程一条记录，调用前需已解锁Flash
+static uint8_t FlashKV_Program(uint32_t addr, uint16_t key, const uint8_t *data, uint32_t len)
+{
+    uint32_t header = ((uint32_t)key << 16) | len;
+    uint32_t crc = FlashKV_Crc(data, len, header);
+    uint32_t i;
+
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, header) != HAL_OK) {
+        return 1;
+    }
+    for (i = 0; i < len; i += 4) {
+        uint32_t word = FLASHKV_ERASED;
+        memcpy(&word, data + i, (len - i < 4) ? (len - i) : 4);
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + 4 + i, word) != HAL_OK) {
+            return 1;
+        }
+    }
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + FLASHKV_RECORD_SIZE(len) - 4, crc) != HAL_OK) {
+        return 1;
+    }
+    return 0;
+}
+
+static void FlashKV_Unlock(void)
+{
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+}
+
+/**
+ * @brief 压缩：各键的最新值暂存到RAM，擦除扇区后依次写回，可附带一个新值(替换该键原有的值)
+ *
+ * @param key 附带写入的键，FLASHKV_KEY_INVALID表示没有
+ * @param data, len 附带写入的值
+ *
+ * @return uint8_t 0：成功，1：暂存缓冲区不够或Flash操作失败
+ */
+static uint8_t FlashKV_CompactWith(uint16_t key, const uint8_t *data, uint32_t len)
+{
+    static uint8_t buf[FLASHKV_COMPACT_SIZE];
+    static FlashKVEntry saved[FLASHKV_MAX_KEYS + 1];
+    FLASH_EraseInitTypeDef erase;
+    uint32_t sectorError;
+    uint32_t used = 0, count = 0, addr, i;
+    uint8_t result = 0;
+
+    for (i = 0; i < kvCount; i++) {
+        if ((kvIndex[i].addr == 0) || (kvIndex[i].key == key)) {
+            continue;
+        }
+        if (used + kvIndex[i].len > FLASHKV_COMPACT_SIZE) {
+            return 1;
+        }
+        memcpy(buf + used, (const void *)(kvIndex[i].addr + 4), kvIndex[i].len);
+        saved[count].key = kvIndex[i].key;
+        saved[count].len = kvIndex[i].len;
+        saved[count].addr = used;
+        used += kvIndex[i].len;
+        count++;
+    }
+    if (key != FLASHKV_KEY_INVALID) {
+        if (used + len > FLASHKV_COMPACT_SIZE) {
+            return 1;
+        }
+        memcpy(buf + used, data, len);
+        saved[count].key = key;
+        saved[count].len = (uint16_t)len;
+        saved[count].addr = used;
+        used += len;
+        count++;
+    }
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = FLASHKV_SECTOR;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    FlashKV_Unlock();
+    if (HAL_FLASHEx_Erase(&erase, &sectorError) != HAL_OK) {
+        result = 1;
+    } else {
+        addr = FLASHKV_BASE;
+        for (i = 0; i < count; i++) {
+            if (FlashKV_Program(addr, saved[i].key, buf + saved[i].addr, saved[i].len) != 0) {
+                result = 1;
+                break;
+            }
+            addr += FLASHKV_RECORD_SIZE(saved[i].len);
+        }
+    }
+    HAL_FLASH_Lock();
+
+    FlashKV_Scan();
+    return result;
+}
+
+uint8_t FlashKV_Compact(void)
+{
+    FlashKV_Init();
+    return FlashKV_CompactWith(FLASHKV_KEY_INVALID, (const uint8_t *)0, 0);
+}
+
+/**
+ * @brief 追加一个键的新值，与当前值相同时不写入；扇区剩余空间不够时先压缩
+ *
+ * @param key 键，1~0xFFFE
+ * @param data 值
+ * @param len 值的字节数，不超过FLASHKV_MAX_VALUE
+ *
+ * @return uint8_t 0：成功，1：参数错误、键数已满或Flash操作失败
+ */
+uint8_t FlashKV_Write(uint16_t key, const void *data, uint32_t len)
+{
+    FlashKVEntry *entry;
+    uint32_t addr;
+    uint8_t result;
+
+    if ((key == 0) || (key == FLASHKV_KEY_INVALID) || (len > FLASHKV_MAX_VALUE)) {
+        return 1;
+    }
+    FlashKV_Init();
+
+    entry = FlashKV_Find(key);
+    if ((entry != (FlashKVEntry *)0) && (entry->addr != 0) && (entry->len == len) &&
+        (memcmp((const void *)(entry->addr + 4), data, len) == 0)) {
+        return 0;
+    }
+    if ((entry == (FlashKVEntry *)0) && (kvCount >= FLASHKV_MAX_KEYS)) {
+        return 1;
+    }
+    if (kvFree + FLASHKV_RECORD_SIZE(len) > FLASHKV_END) {
+        return FlashKV_CompactWith(key, (const uint8_t *)data, len);
+    }
+
+    addr = kvFree;
+    FlashKV_Unlock();
+    result = FlashKV_Program(addr, key, (const uint8_t *)data, len);
+    HAL_FLASH_Lock();
+
+    // 不论成败，写过的区域都不能再编程
+    kvFree = addr + FLASHKV_RECORD_SIZE(len);
+    if ((result != 0) || !FlashKV_RecordValid(addr)) {
+        return 1;
+    }
+    FlashKV_Index(key, (uint16_t)len, addr);
+    return 0;
+}
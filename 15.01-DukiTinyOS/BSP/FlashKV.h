@@ -0,0 +1,31 @@
+#ifndef __FLASHKV_H
+#define __FLASHKV_H
+
+#include "main.h"
+
+// Flash键值存储：占用STM32F401RE的最后一个扇区(扇区7，0x08060000起128KB，分散加载文件中已从代码区扣除)
+// 记录只追加不改写：头字(键<<16 | 长度)、数据(补齐到4字节)、CRC32(硬件CRC单元，覆盖头字与数据)；
+// 同一个键以最后一条CRC正确的记录为准，写入与当前值相同时不追加。扇区写满后把各键的最新值收集到RAM中，
+// 擦除扇区再写回(压缩)，每个扇区擦除一次可以容纳上千次写入，摊薄擦写次数
+// 注意：F401只有一个Flash存储体，编程及擦除期间CPU从Flash取指被挂起(写一个字约16us，擦除128KB扇区约1~2s)，
+// 写入只能在地面(电机未解锁)时进行；压缩过程中掉电会丢失全部记录
+#define FLASHKV_BASE            0x08060000u
+#define FLASHKV_SIZE            0x00020000u
+#define FLASHKV_SECTOR          FLASH_SECTOR_7
+#define FLASHKV_MAX_KEYS        8       // 最多的键数
+#define FLASHKV_MAX_VALUE       128     // 单个值的最大字节数
+#define FLASHKV_COMPACT_SIZE    512     // 压缩时暂存各键最新记录的RAM缓冲区(字节)
+
+// 已分配的键
+#define FLASHKV_KEY_ACCEL_CALIB 0x0001  // 加速度计校准参数，MPU6050AccelCalib
+#define FLASHKV_KEY_GYRO_BIAS   0x0002  // 陀螺仪零偏估计，float[3]
+#define FLASHKV_KEY_PID_GAINS   0x0003  // 姿态PID参数，PIDGains[5]
+#define FLASHKV_KEY_GYRO_TEMP   0x0004  // 陀螺仪零偏的温度模型，AttitudeTempModel
+
+uint8_t FlashKV_Init(void);                                         // 扫描扇区建立索引，返回0成功；重复调用直接返回
+uint32_t FlashKV_Read(uint16_t key, void *buf, uint32_t size);      // 读取一个键的值，返回值的长度，没有记录时返回0
+uint8_t FlashKV_Write(uint16_t key, const void *data, uint32_t len); // 追加一个键的新值，返回0成功，1失败
+uint8_t FlashKV_Compact(void);                                      // 擦除扇区并只写回各键的最新值，返回0成功
+uint32_t FlashKV_FreeBytes(void);                                   // 扇区剩余的可追加字节数
+
+#endif
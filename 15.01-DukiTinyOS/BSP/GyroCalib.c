@@ -0,0 +1,192 @@
+#include "GyroCalib.h"
+#include "MPU6050Sampler.h"
+#include "tinyOS.h"
+#include <math.h>
+#include <string.h>
+
+#if GYRO_CALIB_ENABLE == 1
+
+#define GYRO_CALIB_SAMPLE_BYTES     6       // FIFO中一个样本：GYRO_XOUT_H至GYRO_ZOUT_L
+#define GYRO_CALIB_POLL_MAX         1000    // 等待一块攒满时读取FIFO计数的次数上限
+#define GYRO_CALIB_OVERFLOW_MAX     4       // 连续溢出的块数上限，超过视为总线过慢
+
+// 一块按FIFO最多能放下的样本读出，停止写入前后多到达的几个样本一并计入
+static uint8_t gyroCalibBuf[(MPU6050_FIFO_SIZE / GYRO_CALIB_SAMPLE_BYTES) * GYRO_CALIB_SAMPLE_BYTES];
+
+// 一块样本的各轴累加值(LSB)
+typedef struct _GyroCalibSum {
+    int64_t sum[3];
+    int64_t sumSq[3];
+    uint32_t count;
+} GyroCalibSum;
+
+//清空FIFO并开始写入陀螺仪样本，同时清除溢出标志(读INT_STATUS即清除)
+static uint8_t GyroCalib_StartBlock(void)
+{
+    uint8_t intStatus;
+
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET) != 0)
+        return 1;
+    if (MPU6050_ReadReg(MPU6050_PRIMARY, MPU6050_INT_STATUS, &intStatus) != 0)
+        return 1;
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN) != 0)
+        return 1;
+    return MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_FIFO_EN, MPU6050_FIFO_GYRO);
+}
+
+//等FIFO攒满一块后停止写入，连续读出并累加；*overflow置1表示期间溢出，样本不可用
+static uint8_t GyroCalib_ReadBlock(GyroCalibSum *block, uint8_t *overflow)
+{
+    uint8_t countBuf[2], intStatus;
+    uint32_t count = 0, n, i, poll;
+
+    for (poll = 0; poll < GYRO_CALIB_POLL_MAX; poll++) {
+        if (MPU6050_ReadData(MPU6050_PRIMARY, MPU6050_FIFO_COUNTH, countBuf, 2) != 0)
+            return 1;
+        count = ((uint32_t)countBuf[0] << 8) | countBuf[1];
+        if (count >= GYRO_CALIB_BLOCK * GYRO_CALIB_SAMPLE_BYTES)
+            break;
+    }
+    if (poll == GYRO_CALIB_POLL_MAX)
+        return 1;
+
+    // 停止写入后再读计数，之后FIFO不再变化，读出的字节数与样本边界确定
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_FIFO_EN, 0) != 0)
+        return 1;
+    if (MPU6050_ReadReg(MPU6050_PRIMARY, MPU6050_INT_STATUS, &intStatus) != 0)
+        return 1;
+    if (MPU6050_ReadData(MPU6050_PRIMARY, MPU6050_FIFO_COUNTH, countBuf, 2) != 0)
+        return 1;
+    count = ((uint32_t)countBuf[0] << 8) | countBuf[1];
+    *overflow = ((intStatus & MPU6050_INT_FIFO_OFLOW) != 0) || (count > sizeof(gyroCalibBuf));
+    if (*overflow)
+        return 0;
+
+    n = count / GYRO_CALIB_SAMPLE_BYTES;
+    if (MPU6050_ReadData(MPU6050_PRIMARY, MPU6050_FIFO_R_W, gyroCalibBuf, (uint16_t)(n * GYRO_CALIB_SAMPLE_BYTES)) != 0)
+        return 1;
+
+    memset(block, 0, sizeof(*block));
+    for (i = 0; i < n; i++) {
+        const uint8_t *p = &gyroCalibBuf[i * GYRO_CALIB_SAMPLE_BYTES];
+        int axis;
+        for (axis = 0; axis < 3; axis++) {
+            int32_t v = (int16_t)(((uint16_t)p[axis * 2] << 8) | p[axis * 2 + 1]);
+            block->sum[axis] += v;
+            block->sumSq[axis] += (int64_t)v * v;
+        }
+    }
+    block->count = n;
+    return 0;
+}
+
+//由累加值求均值及标准差(LSB)，方差的分子n*Σx²-(Σx)²以整数计算，不受单精度相减的抵消误差影响
+static void GyroCalib_Stats(const GyroCalibSum *s, float *mean, float *std)
+{
+    int axis;
+
+    for (axis = 0; axis < 3; axis++) {
+        int64_t num = (int64_t)s->count * s->sumSq[axis] - s->sum[axis] * s->sum[axis];
+        mean[axis] = (float)s->sum[axis] / s->count;
+        std[axis] = sqrtf((float)num) / s->count;
+    }
+}
+
+//块内方差过大或均值偏离已接受的样本时视为有运动
+static uint8_t GyroCalib_IsMoving(const GyroCalibSum *block, const GyroCalibSum *total, float scale)
+{
+    float mean[3], std[3], totalMean[3], totalStd[3];
+    int axis;
+
+    GyroCalib_Stats(block, mean, std);
+    if (total->count > 0)
+        GyroCalib_Stats(total, totalMean, totalStd);
+    for (axis = 0; axis < 3; axis++) {
+        if (std[axis] * scale > GYRO_CALIB_MAX_STD)
+            return 1;
+        if ((total->count > 0) && (fabsf(mean[axis] - totalMean[axis]) * scale > GYRO_CALIB_MAX_DRIFT))
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 以8kHz的FIFO批量读取快速标定陀螺仪零偏，结束后恢复原来的配置并关闭FIFO
+ * @param result 标定结果，返回GYRO_CALIB_OK时零偏及噪声有效
+ * @retval GYRO_CALIB_OK: 成功, GYRO_CALIB_BUS_ERROR: 读写失败或FIFO持续溢出, GYRO_CALIB_MOTION: 一直有运动
+ */
+uint8_t GyroCalib_Capture(GyroCalibResult *result)
+{
+    // ±250°/s量程下的rad/s/LSB
+    const float scale = 250.0f * 2 / ADC_16 * DEG_TO_RAD;
+    MPU6050Config saved, config;
+    GyroCalibSum block, total;
+    uint32_t start = (uint32_t)tTimeGetMicros();
+    uint32_t settle = GYRO_CALIB_SETTLE_BLOCKS, overflowRun = 0;
+    uint8_t err = GYRO_CALIB_OK, overflow;
+    int axis;
+
+    memset(result, 0, sizeof(*result));
+    memset(&total, 0, sizeof(total));
+    MPU6050_GetConfig(MPU6050_PRIMARY, &saved);
+    config = saved;
+    config.dlpf = MPU6050_DLPF_260HZ;
+    config.sampleRateHz = 8000;
+    config.gyroRange = MPU6050_GYRO_250DPS;
+    if (MPU6050_Configure(MPU6050_PRIMARY, &config) != 0)
+        return GYRO_CALIB_BUS_ERROR;
+
+    while (total.count < GYRO_CALIB_SAMPLES) {
+        if ((GyroCalib_StartBlock() != 0) || (GyroCalib_ReadBlock(&block, &overflow) != 0)) {
+            err = GYRO_CALIB_BUS_ERROR;
+            break;
+        }
+        if (overflow) {
+            result->overflows++;
+            if (++overflowRun > GYRO_CALIB_OVERFLOW_MAX) {
+                err = GYRO_CALIB_BUS_ERROR;
+                break;
+            }
+            continue;
+        }
+        overflowRun = 0;
+        if ((settle > 0) || (block.count == 0)) {
+            if (settle > 0)
+                settle--;
+            continue;
+        }
+        if (GyroCalib_IsMoving(&block, &total, scale)) {
+            if (++result->retries > GYRO_CALIB_MAX_RETRIES) {
+                err = GYRO_CALIB_MOTION;
+                break;
+            }
+            memset(&total, 0, sizeof(total));
+            continue;
+        }
+        for (axis = 0; axis < 3; axis++) {
+            total.sum[axis] += block.sum[axis];
+            total.sumSq[axis] += block.sumSq[axis];
+        }
+        total.count += block.count;
+    }
+
+    // FIFO关闭后恢复飞行配置，MPU6050_SamplerInit按自己的需要重新开启
+    (void)MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_FIFO_EN, 0);
+    (void)MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET);
+    if (MPU6050_Configure(MPU6050_PRIMARY, &saved) != 0)
+        err = GYRO_CALIB_BUS_ERROR;
+
+    if (err == GYRO_CALIB_OK) {
+        float mean[3], std[3];
+        GyroCalib_Stats(&total, mean, std);
+        for (axis = 0; axis < 3; axis++) {
+            result->bias[axis] = mean[axis] * scale;
+            result->noise[axis] = std[axis] * scale;
+        }
+        result->samples = total.count;
+    }
+    result->durationUs = (uint32_t)tTimeGetMicros() - start;
+    return err;
+}
+
+#endif
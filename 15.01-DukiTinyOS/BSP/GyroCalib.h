@@ -0,0 +1,41 @@
+#ifndef __GYROCALIB_H
+#define __GYROCALIB_H
+
+#include "MPU6050.h"
+
+// 上电快速零偏标定：临时把MPU6050设为关闭低通(内部8kHz)、不分频、±250°/s，只把陀螺仪写入FIFO，
+// 每次让FIFO攒满一块后停止写入并一次连续读出，块间的读取时间里不写FIFO，不会溢出；
+// 每块先检查方差及与已接受样本均值的偏离，超过阈值视为有运动，丢弃已累计的样本重新开始；
+// 得到零偏及噪声标准差后恢复原来的配置。比逐次读取陀螺仪寄存器求均值快得多，±250°/s量程的分辨率也是飞行时±2000°/s的8倍
+// 标定的是主IMU(MPU6050_PRIMARY)，需在MPU6050_Init之后、MPU6050_SamplerInit之前的任务中调用，期间占用I2C总线
+#define GYRO_CALIB_ENABLE           1
+
+#define GYRO_CALIB_SAMPLES          2048    // 接受的样本数，8kHz下纯采集0.26s，加上读出约0.6s
+#define GYRO_CALIB_BLOCK            128     // 每块的样本数(6字节)，8kHz下16ms攒满，FIFO容量1024字节的上限为170
+#define GYRO_CALIB_SETTLE_BLOCKS    1       // 切换配置后丢弃的块数，等待滤波器及量程切换稳定
+#define GYRO_CALIB_MAX_STD          0.02f   // 块内标准差上限(rad/s)，静止时的噪声约0.0015rad/s
+#define GYRO_CALIB_MAX_DRIFT        0.01f   // 块均值与已接受样本均值之差的上限(rad/s)
+#define GYRO_CALIB_MAX_RETRIES      5       // 因运动重新开始的次数上限
+
+// 返回值
+#define GYRO_CALIB_OK               0
+#define GYRO_CALIB_BUS_ERROR        1       // I2C读写失败或FIFO溢出过多
+#define GYRO_CALIB_MOTION           2       // 重试次数用完仍检测到运动
+
+// 标定结果
+typedef struct _GyroCalibResult {
+    float bias[3];          // 零偏(rad/s)
+    float noise[3];         // 噪声标准差(rad/s)，8kHz、不滤波时的单个样本
+    uint32_t samples;       // 参与计算的样本数
+    uint32_t retries;       // 因运动重新开始的次数
+    uint32_t overflows;     // FIFO溢出而丢弃的块数
+    uint32_t durationUs;    // 含配置切换及恢复的总耗时
+} GyroCalibResult;
+
+#if GYRO_CALIB_ENABLE == 1
+uint8_t GyroCalib_Capture(GyroCalibResult *result); // 采集并计算零偏，返回GYRO_CALIB_xxx，失败时result中只有统计字段有效
+#else
+#define GyroCalib_Capture(result)   GYRO_CALIB_BUS_ERROR
+#endif
+
+#endif
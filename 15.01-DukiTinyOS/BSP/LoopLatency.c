@@ -0,0 +1,148 @@
+#include "LoopLatency.h"
+#include "tinyOS.h"
+#include "MySerial.h"
+
+#if LOOP_LATENCY_ENABLE == 1
+
+static uint32_t latencyReadyCycles;     // 未结束周期的起点
+static uint8_t latencyPending;          // 1：有已就绪、尚未输出的样本
+static uint32_t latencyBinCycles;       // 每组的周期数
+static uint32_t latencyCount;
+static uint32_t latencySkipped;
+static uint32_t latencyMin;
+static uint32_t latencyMax;
+static uint64_t latencyTotal;
+static uint32_t latencyHist[LOOP_LATENCY_BINS];
+
+#if TINYOS_ENABLE_SHELL == 1
+static tShellCmd latencyCmd = {"loop", LoopLatency_Print, "control loop latency: data-ready to motor output"};
+static tShellCmd latencyResetCmd = {"loopreset", LoopLatency_Reset, "clear loop latency statistics"};
+#endif
+
+void LoopLatency_Init(void)
+{
+    tCycleCounterInit();
+    latencyBinCycles = (SystemCoreClock / 1000000u) * LOOP_LATENCY_BIN_US;
+    LoopLatency_Reset();
+#if TINYOS_ENABLE_SHELL == 1
+    tShellAddCmd(&latencyCmd);
+    tShellAddCmd(&latencyResetCmd);
+#endif
+}
+
+void LoopLatency_Reset(void)
+{
+    uint32_t status = tTaskEnterCritical();
+    int i;
+
+    latencyPending = 0;
+    latencyCount = 0;
+    latencySkipped = 0;
+    latencyMin = 0xFFFFFFFFu;
+    latencyMax = 0;
+    latencyTotal = 0;
+    for (i = 0; i < LOOP_LATENCY_BINS; i++) {
+        latencyHist[i] = 0;
+    }
+    tTaskExitCritical(status);
+}
+
+void LoopLatency_MarkReady(void)
+{
+    uint32_t now = tCycleCounterGet();
+
+    if (latencyPending) {
+        latencySkipped++;
+    }
+    latencyReadyCycles = now;
+    latencyPending = 1;
+}
+
+void LoopLatency_MarkOutput(void)
+{
+    uint32_t now = tCycleCounterGet();
+    uint32_t status = tTaskEnterCritical();
+    uint32_t cycles, bin;
+
+    // 同一个样本只记第一次输出，最低油门等不跟随样本的输出没有起点，不计入
+    if (latencyPending) {
+        latencyPending = 0;
+        cycles = now - latencyReadyCycles;
+        bin = latencyBinCycles ? (cycles / latencyBinCycles) : 0;
+        bin = (bin < LOOP_LATENCY_BINS) ? bin : (LOOP_LATENCY_BINS - 1);
+        latencyHist[bin]++;
+        latencyCount++;
+        latencyTotal += cycles;
+        latencyMin = (cycles < latencyMin) ? cycles : latencyMin;
+        latencyMax = (cycles > latencyMax) ? cycles : latencyMax;
+    }
+    tTaskExitCritical(status);
+}
+
+// 由直方图求分位数：累计次数首次达到count * permille / 1000的组，取该组上沿
+static float LoopLatency_Percentile(const LoopLatencyReport *report, uint32_t permille)
+{
+    uint32_t target = (uint32_t)(((uint64_t)report->count * permille + 999u) / 1000u);
+    uint32_t sum = 0;
+    float us;
+    int i;
+
+    for (i = 0; i < LOOP_LATENCY_BINS - 1; i++) {
+        sum += report->hist[i];
+        if (sum >= target) {
+            break;
+        }
+    }
+    us = (float)((i + 1) * LOOP_LATENCY_BIN_US);
+    return (us < report->maxUs) ? us : report->maxUs;
+}
+
+void LoopLatency_GetReport(LoopLatencyReport *report)
+{
+    float usPerCycle = 1000000.0f / (float)SystemCoreClock;
+    uint64_t total;
+    uint32_t min, max, status;
+    int i;
+
+    status = tTaskEnterCritical();
+    report->count = latencyCount;
+    report->skipped = latencySkipped;
+    min = latencyMin;
+    max = latencyMax;
+    total = latencyTotal;
+    for (i = 0; i < LOOP_LATENCY_BINS; i++) {
+        report->hist[i] = latencyHist[i];
+    }
+    tTaskExitCritical(status);
+
+    if (report->count == 0) {
+        report->minUs = report->avgUs = report->maxUs = 0.0f;
+        report->p50Us = report->p99Us = 0.0f;
+        return;
+    }
+    report->minUs = (float)min * usPerCycle;
+    report->maxUs = (float)max * usPerCycle;
+    report->avgUs = (float)(total / report->count) * usPerCycle;
+    report->p50Us = LoopLatency_Percentile(report, 500);
+    report->p99Us = LoopLatency_Percentile(report, 990);
+}
+
+void LoopLatency_Print(void)
+{
+    static LoopLatencyReport report;    // 由命令任务或日志任务调用，直方图不放在栈上
+    int i;
+
+    LoopLatency_GetReport(&report);
+    tPrintf("loop latency: n=%lu skipped=%lu min=%.1f avg=%.1f p50=%.1f p99=%.1f max=%.1f us\r\n",
+           (unsigned long)report.count, (unsigned long)report.skipped,
+           report.minUs, report.avgUs, report.p50Us, report.p99Us, report.maxUs);
+    for (i = 0; i < LOOP_LATENCY_BINS; i++) {
+        if (report.hist[i] != 0) {
+            printf("%s%4d us %lu\r\n", (i == LOOP_LATENCY_BINS - 1) ? ">=" : "< ",
+                   (i == LOOP_LATENCY_BINS - 1) ? i * LOOP_LATENCY_BIN_US : (i + 1) * LOOP_LATENCY_BIN_US,
+                   (unsigned long)report.hist[i]);
+        }
+    }
+}
+
+#endif
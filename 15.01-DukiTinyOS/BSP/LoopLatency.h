@@ -0,0 +1,41 @@
+#ifndef __LOOPLATENCY_H
+#define __LOOPLATENCY_H
+
+#include "main.h"
+
+// 控制回路延迟统计：数据就绪中断中记下DWT周期数，Motor_SetAll写完比较寄存器(或发出DShot帧)后取差值，
+// 即一个样本从传感器就绪到电机输出的总延迟，含采样任务读取、姿态融合、PID、混控及其间的调度延迟；
+// 按LOOP_LATENCY_BIN_US宽的线性分组统计直方图，由直方图得出中位数及p99，分布的宽度即抖动，
+// 内核或驱动改动前后各测一次即可比较；开启TINYOS_ENABLE_SHELL时登记loop命令输出报告，loopreset清零
+#define LOOP_LATENCY_ENABLE     1
+#define LOOP_LATENCY_BIN_US     10  // 直方图每组的宽度(us)
+#define LOOP_LATENCY_BINS       64  // 直方图组数，最后一组统计所有更长的情况
+
+// 延迟报告，时间单位均为us
+typedef struct _LoopLatencyReport {
+    uint32_t count;         // 统计的周期数
+    uint32_t skipped;       // 上一个样本尚未输出就来了新的数据就绪中断的次数(回路跟不上采样速率)
+    float minUs;
+    float avgUs;
+    float maxUs;
+    float p50Us;            // 中位数，取所在组的上沿，不超过maxUs
+    float p99Us;            // 99%的周期不超过该值，取法同上
+    uint32_t hist[LOOP_LATENCY_BINS];
+} LoopLatencyReport;
+
+#if LOOP_LATENCY_ENABLE == 1
+void LoopLatency_Init(void);        // 开启周期计数器并清零统计，开启SHELL时登记命令
+void LoopLatency_MarkReady(void);   // 数据就绪中断中调用，记下本周期的起点
+void LoopLatency_MarkOutput(void);  // 电机输出写入后调用，有未结束的周期时记录其延迟，可在中断中调用
+void LoopLatency_Reset(void);       // 清零统计
+void LoopLatency_GetReport(LoopLatencyReport *report); // 读取统计并算出各分位数
+void LoopLatency_Print(void);       // 报告经printf输出
+#else
+#define LoopLatency_Init()
+#define LoopLatency_MarkReady()
+#define LoopLatency_MarkOutput()
+#define LoopLatency_Reset()
+#define LoopLatency_Print()
+#endif
+
+#endif // __LOOPLATENCY_H
@@ -1,59 +1,212 @@
 #include "mpu6050.h"
+#include "tinyOS.h"
+#include <stddef.h>
+#include <string.h>
+#if MPU6050_USE_SPI == 1
+#include "SpiImu.h" // SPI经DMA读取
+#if SPI_IMU_ENABLE == 0
+#error "MPU6050_USE_SPI requires SPI_IMU_ENABLE"
+#endif
+#elif MPU6050_USE_HW_I2C == 1
+#include "MyHwIIC.h" // 硬件I2C经DMA读取
+#else
 #include "MyIIC.h" // 引入软件I2C库
+#endif
+
+#if MPU6050_USE_SPI == 1
+/**
+ * @brief SPI器件的复位：复位全部寄存器及信号通路，识别型号后关闭I2C接口，防止片选的跳变被当作I2C起始条件
+ * @param dev 器件实例
+ * @retval 0: 成功, 1: WHO_AM_I不是已知的型号
+ */
+static uint8_t MPU6050_SpiReset(MPU6050Dev *dev)
+{
+    uint8_t id = 0;
+
+    SpiImu_Init(dev->bus);
+    dev->whoAmI = 0;
+    MPU6050_WriteReg(dev, MPU6050_PWR_MGMT_1, MPU6050_PWR_RESET);
+    HAL_Delay(100);
+    MPU6050_WriteReg(dev, MPU6050_SIGNAL_PATH_RESET, 0x07); // 陀螺仪、加速度计、温度
+    HAL_Delay(100);
+    if (MPU6050_ReadReg(dev, MPU6050_WHO_AM_I, &id) != 0)
+        return 1;
+    switch (id) {
+    case MPU6050_WHOAMI_MPU6000:
+        dev->whoAmI = id;
+        MPU6050_WriteReg(dev, MPU6050_USER_CTRL, 0); // 由WriteReg带上I2C_IF_DIS
+        break;
+    case MPU6050_WHOAMI_ICM20602:
+    case MPU6050_WHOAMI_ICM20608:
+    case MPU6050_WHOAMI_ICM20689:
+        dev->whoAmI = id;
+        MPU6050_WriteReg(dev, MPU6050_ICM_I2C_IF, MPU6050_ICM_I2C_IF_DIS);
+        break;
+    default:
+        return 1;
+    }
+    MPU6050_WriteReg(dev, MPU6050_PWR_MGMT_1, MPU6050_PWR_CLK_PLL);
+    HAL_Delay(15);
+    return 0;
+}
+#endif
 
 /**
  * @brief 初始化MPU6050
+ * @param dev 器件实例，总线及地址已由MPU6050_DEV_INITIALIZER填写
  * @retval 0: 成功, 1: 失败
  */
-uint8_t MPU6050_Init(void)
+uint8_t MPU6050_Init(MPU6050Dev *dev)
 {
-    I2C_Init(); // 初始化I2C
-    if (MPU6050_WriteReg(MPU6050_PWR_MGMT_1, 0x00) != 0) // 解除休眠模式
+    MPU6050Config config = {
+        MPU6050_DEFAULT_DLPF, MPU6050_DEFAULT_RATE_HZ, MPU6050_DEFAULT_ACCEL_RANGE, MPU6050_DEFAULT_GYRO_RANGE
+    };
+
+#if MPU6050_USE_SPI == 1
+    if (MPU6050_SpiReset(dev) != 0)
         return 1;
-    if (MPU6050_WriteReg(MPU6050_SMPLRT_DIV, 0x07) != 0) // 设置采样率
+#else
+#if MPU6050_USE_HW_I2C == 0
+    I2C_Init(); // 初始化I2C，硬件I2C总线由MX_I2C2_Init及HwI2C_Init初始化
+#endif
+    if (MPU6050_WriteReg(dev, MPU6050_PWR_MGMT_1, 0x00) != 0) // 解除休眠模式
+        return 1;
+#endif
+    return MPU6050_Configure(dev, &config);
+}
+
+/**
+ * @brief 设置片上低通滤波、输出速率及量程，并更新换算系数
+ *        输出速率 = 内部采样率 / (1 + SMPLRT_DIV)，内部采样率在关闭滤波时为8kHz，否则为1kHz
+ * @param dev 器件实例
+ * @param config 配置，sampleRateHz取不大于该值的最近一档，不低于内部采样率的1/256
+ * @retval 0: 成功, 1: 失败，失败时换算系数不变
+ */
+uint8_t MPU6050_Configure(MPU6050Dev *dev, const MPU6050Config *config)
+{
+    static const uint16_t accelFullScale[] = {2, 4, 8, 16};         // ±g
+    static const uint16_t gyroFullScale[] = {250, 500, 1000, 2000}; // ±°/s
+    uint32_t baseRate = (config->dlpf == MPU6050_DLPF_260HZ) ? 8000 : 1000;
+    uint32_t rate = config->sampleRateHz;
+    uint32_t div;
+
+    if (rate == 0)
+        rate = 1;
+    div = (baseRate + rate - 1) / rate - 1; // 向上取整，保证实际速率不超过要求
+    if (div > 255)
+        div = 255;
+
+    if (MPU6050_WriteReg(dev, MPU6050_SMPLRT_DIV, (uint8_t)div) != 0) // 设置采样率
         return 1;
-    if (MPU6050_WriteReg(MPU6050_CONFIG, 0x06) != 0)     // 配置低通滤波器
+    if (MPU6050_WriteReg(dev, MPU6050_CONFIG, (uint8_t)config->dlpf) != 0)     // 配置低通滤波器
         return 1;
-    if (MPU6050_WriteReg(MPU6050_GYRO_CONFIG, 0x18) != 0) // 配置陀螺仪量程 ±2000°/s
+    if (MPU6050_WriteReg(dev, MPU6050_GYRO_CONFIG, (uint8_t)(config->gyroRange << 3)) != 0) // 配置陀螺仪量程
         return 1;
-    if (MPU6050_WriteReg(MPU6050_ACCEL_CONFIG, 0x01) != 0) // 配置加速度计量程 ±4g
+    if (MPU6050_WriteReg(dev, MPU6050_ACCEL_CONFIG, (uint8_t)(config->accelRange << 3)) != 0) // 配置加速度计量程
         return 1;
+
+    dev->config = *config;
+    dev->config.sampleRateHz = baseRate / (div + 1);
+    dev->accelScale = (float)accelFullScale[config->accelRange] * 2 / ADC_16;
+    dev->gyroScale = (float)gyroFullScale[config->gyroRange] * 2 / ADC_16 * DEG_TO_RAD;
     return 0;
 }
 
 /**
- * @brief 向MPU6050寄存器写数据
+ * @brief 读取当前配置
+ * @param dev 器件实例
+ * @param config 当前配置，sampleRateHz为实际输出速率
+ */
+void MPU6050_GetConfig(MPU6050Dev *dev, MPU6050Config *config)
+{
+    *config = dev->config;
+}
+
+/**
+ * @brief 设置加速度计校准参数，在临界区内整体替换，换算中的样本不会用到新旧混合的参数
+ * @param dev 器件实例
+ * @param calib 校准参数，NULL时恢复为不校准(比例1、零偏0)，采集校准数据前使用
+ */
+void MPU6050_SetAccelCalib(MPU6050Dev *dev, const MPU6050AccelCalib *calib)
+{
+    static const MPU6050AccelCalib identity = MPU6050_ACCEL_CALIB_NONE;
+    uint32_t status = tTaskEnterCritical();
+
+    dev->accelCalib = (calib != NULL) ? *calib : identity;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 读取当前的加速度计校准参数
+ * @param dev 器件实例
+ * @param calib 输出的校准参数
+ */
+void MPU6050_GetAccelCalib(MPU6050Dev *dev, MPU6050AccelCalib *calib)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    *calib = dev->accelCalib;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 向MPU6050寄存器写数据；SPI接口的MPU6000写USER_CTRL时保持I2C_IF_DIS，调用者清空FIFO等不会重新打开I2C接口
+ * @param dev 器件实例
  * @param reg 寄存器地址
  * @param data 写入的数据
  * @retval 0: 成功, 1: 失败
  */
-uint8_t MPU6050_WriteReg(uint8_t reg, uint8_t data)
+uint8_t MPU6050_WriteReg(MPU6050Dev *dev, uint8_t reg, uint8_t data)
 {
-    return I2C_WriteReg(MPU6050_I2C_ADDR, reg, data);
+#if MPU6050_USE_SPI == 1
+    if ((reg == MPU6050_USER_CTRL) && (dev->whoAmI == MPU6050_WHOAMI_MPU6000))
+        data |= MPU6050_USER_I2C_IF_DIS;
+    return SpiImu_WriteReg(dev->bus, reg, data);
+#elif MPU6050_USE_HW_I2C == 1
+    return HwI2C_WriteReg(dev->bus, dev->addr, reg, data) != HWIIC_OK;
+#else
+    return I2C_WriteReg(dev->addr, reg, data);
+#endif
 }
 
 /**
  * @brief 从MPU6050寄存器读取数据
+ * @param dev 器件实例
  * @param reg 寄存器地址
  * @param data 读取到的数据
  * @retval 0: 成功, 1: 失败
  */
-uint8_t MPU6050_ReadReg(uint8_t reg, uint8_t *data)
+uint8_t MPU6050_ReadReg(MPU6050Dev *dev, uint8_t reg, uint8_t *data)
 {
-    return I2C_ReadReg(MPU6050_I2C_ADDR, reg, data);
+#if MPU6050_USE_SPI == 1
+    return SpiImu_Read(dev->bus, reg, data, 1);
+#elif MPU6050_USE_HW_I2C == 1
+    return HwI2C_ReadReg(dev->bus, dev->addr, reg, data) != HWIIC_OK;
+#else
+    return I2C_ReadReg(dev->addr, reg, data);
+#endif
 }
 
 /**
- * @brief 从MPU6050批量读取数据
+ * @brief 从MPU6050批量读取数据，硬件I2C时以MPU6050_I2C_PRIO排队经DMA读取，SPI时经DMA全双工读取，调用的任务等待期间让出CPU
+ * @param dev 器件实例
  * @param reg 起始寄存器地址
  * @param buf 存储读取数据的缓冲区
  * @param len 读取数据的长度
  * @retval 0: 成功, 1: 失败
  */
-uint8_t MPU6050_ReadData(uint8_t reg, uint8_t *buf, uint16_t len)
+uint8_t MPU6050_ReadData(MPU6050Dev *dev, uint8_t reg, uint8_t *buf, uint16_t len)
 {
+#if MPU6050_USE_SPI == 1
+    return SpiImu_Read(dev->bus, reg, buf, len);
+#elif MPU6050_USE_HW_I2C == 1
+    HwI2CXfer xfer;
+
+    HwI2C_XferInit(&xfer, dev->bus, HWIIC_READ, dev->addr, reg, buf, len, MPU6050_I2C_PRIO);
+    return HwI2C_Transfer(&xfer) != HWIIC_OK;
+#else
     I2C_Start();
-    I2C_SendByte((MPU6050_I2C_ADDR << 1) | 0); // 发送设备地址+写指令
+    I2C_SendByte((dev->addr << 1) | 0); // 发送设备地址+写指令
     if (I2C_WaitAck() != 0)
     {
         I2C_Stop();
@@ -68,7 +221,7 @@ uint8_t MPU6050_ReadData(uint8_t reg, uint8_t *buf, uint16_t len)
     }
 
     I2C_Start();
-    I2C_SendByte((MPU6050_I2C_ADDR << 1) | 1); // 发送设备地址+读指令
+    I2C_SendByte((dev->addr << 1) | 1); // 发送设备地址+读指令
     if (I2C_WaitAck() != 0)
     {
         I2C_Stop();
@@ -85,72 +238,142 @@ uint8_t MPU6050_ReadData(uint8_t reg, uint8_t *buf, uint16_t len)
     }
     I2C_Stop();
     return 0;
+#endif
 }
 
-/**
- * @brief 获取并处理加速度数据，将原始ADC值转换为工程单位(g)
- * @param ax 指向X轴加速度数据的指针（浮点型，单位g）
- * @param ay 指向Y轴加速度数据的指针（浮点型，单位g）
- * @param az 指向Z轴加速度数据的指针（浮点型，单位g）
- */
-void MPU6050_GetAccelData(float *ax, float *ay, float *az)
+//原始加速度换算为g并校准，buf为ACCEL_XOUT_H起的6字节
+static void MPU6050_ConvertAccel(const MPU6050Dev *dev, const uint8_t *buf, float *ax, float *ay, float *az)
 {
-    uint8_t buf[6];
     int16_t raw_ax, raw_ay, raw_az;
 
-    // 读取6字节的原始加速度数据
-    MPU6050_ReadData(MPU6050_ACCEL_XOUT_H, buf, 6);
-
     // 合并高低字节为int16_t类型的原始数据
     raw_ax = (int16_t)((buf[0] << 8) | buf[1]);
     raw_ay = (int16_t)((buf[2] << 8) | buf[3]);
     raw_az = (int16_t)((buf[4] << 8) | buf[5]);
 
     // 转换为浮点数并存储到输出变量
-    *ax = (float)raw_ax * ACC_Range / ADC_16;
-    *ay = (float)raw_ay * ACC_Range / ADC_16;
-    *az = (float)raw_az * ACC_Range / ADC_16;
+    *ax = (float)raw_ax * dev->accelScale;
+    *ay = (float)raw_ay * dev->accelScale;
+    *az = (float)raw_az * dev->accelScale;
 	
-		// 使用高斯牛顿计算得到的校准参数
-    *ax = (*ax - P3) * P0;  // X轴校准：减去零偏误差，乘以比例误差
-    *ay = (*ay - P4) * P1;  // Y轴校准
-    *az = (*az - P5) * P2;  // Z轴校准
+		// 使用高斯牛顿拟合得到的校准参数
+    *ax = (*ax - dev->accelCalib.offset[0]) * dev->accelCalib.scale[0];  // X轴校准：减去零偏误差，乘以比例误差
+    *ay = (*ay - dev->accelCalib.offset[1]) * dev->accelCalib.scale[1];  // Y轴校准
+    *az = (*az - dev->accelCalib.offset[2]) * dev->accelCalib.scale[2];  // Z轴校准
+}
+
+//原始角速度换算为rad/s，buf为GYRO_XOUT_H起的6字节；零偏由姿态解算在线估计并扣除
+static void MPU6050_ConvertGyro(const MPU6050Dev *dev, const uint8_t *buf, float *gx, float *gy, float *gz)
+{
+    int16_t raw_gx, raw_gy, raw_gz;
+
+    // 合并高低字节为int16_t类型的原始数据
+    raw_gx = (int16_t)((buf[0] << 8) | buf[1]);
+    raw_gy = (int16_t)((buf[2] << 8) | buf[3]);
+    raw_gz = (int16_t)((buf[4] << 8) | buf[5]);
+
+    // 转换为浮点数并存储到输出变量
+    *gx = (float)raw_gx * dev->gyroScale;
+    *gy = (float)raw_gy * dev->gyroScale;
+    *gz = (float)raw_gz * dev->gyroScale;
+}
+
+//原始温度换算为摄氏度，buf为TEMP_OUT_H起的2字节；ICM-206xx的灵敏度及零点与MPU6050/MPU6000不同
+static float MPU6050_ConvertTemp(const MPU6050Dev *dev, const uint8_t *buf)
+{
+    int16_t raw_temp = (int16_t)((buf[0] << 8) | buf[1]);
+
+#if MPU6050_USE_SPI == 1
+    if ((dev->whoAmI != 0) && (dev->whoAmI != MPU6050_WHOAMI_MPU6000))
+        return raw_temp * (1.0f / 326.8f) + 25.0f;
+#else
+    (void)dev;
+#endif
+    return raw_temp * (1.0f / 340.0f) + 36.53f; // 将原始温度值转换为摄氏度，单精度以免调用双精度软件库
+}
+
+/**
+ * @brief 换算MPU6050_ReadAll读到的14字节原始数据
+ * @param dev 读出该数据的器件，按其量程及校准参数换算
+ * @param buf ACCEL_XOUT_H至GYRO_ZOUT_L的原始数据
+ * @param sample 校准后的加速度(g)、温度(摄氏度)及角速度(rad/s)
+ */
+void MPU6050_ParseSample(const MPU6050Dev *dev, const uint8_t *buf, MPU6050Sample *sample)
+{
+    MPU6050_ConvertAccel(dev, &buf[0], &sample->ax, &sample->ay, &sample->az);
+    sample->temp = MPU6050_ConvertTemp(dev, &buf[6]);
+    MPU6050_ConvertGyro(dev, &buf[8], &sample->gx, &sample->gy, &sample->gz);
+}
+
+// 大端的两个16位数据按一个字读入后，REV16一次交换两个半字内的字节，得到小端排列的一对int16
+static uint32_t MPU6050_LoadPair(const uint8_t *buf)
+{
+    uint32_t word;
+
+    memcpy(&word, buf, 4); // 缓冲区不保证字对齐，LDR允许非对齐访问
+    return __REV16(word);
+}
+
+/**
+ * @brief 14字节原始数据转为int16，不换算单位也不校准，供定点控制路径使用；每两个数据为一对，
+ *        按字读入、REV16交换字节后整字写出，结构中相邻的两个int16即一对，可再按字读出两路并行处理
+ * @param buf ACCEL_XOUT_H至GYRO_ZOUT_L的原始数据
+ * @param raw 原始数据，LSB
+ */
+void MPU6050_ParseRaw(const uint8_t *buf, MPU6050RawSample *raw)
+{
+    uint32_t pair[4];
+
+    pair[0] = MPU6050_LoadPair(&buf[0]);    // ax, ay
+    pair[1] = MPU6050_LoadPair(&buf[4]);    // az, temp
+    pair[2] = MPU6050_LoadPair(&buf[8]);    // gx, gy
+    pair[3] = (uint32_t)(uint16_t)((buf[12] << 8) | buf[13]); // gz, 填充
+    memcpy(raw, pair, sizeof(pair));
+}
+
+/**
+ * @brief 获取并处理加速度数据，将原始ADC值转换为工程单位(g)
+ * @param dev 器件实例
+ * @param ax 指向X轴加速度数据的指针（浮点型，单位g）
+ * @param ay 指向Y轴加速度数据的指针（浮点型，单位g）
+ * @param az 指向Z轴加速度数据的指针（浮点型，单位g）
+ */
+void MPU6050_GetAccelData(MPU6050Dev *dev, float *ax, float *ay, float *az)
+{
+    uint8_t buf[6];
+
+    // 读取6字节的原始加速度数据
+    MPU6050_ReadData(dev, MPU6050_ACCEL_XOUT_H, buf, 6);
+    MPU6050_ConvertAccel(dev, buf, ax, ay, az);
 }
 
 /**
  * @brief 获取并处理陀螺仪数据，将原始ADC值转换为工程单位(°/s)
+ * @param dev 器件实例
  * @param gx 指向X轴角速度数据的指针（浮点型，单位°/s）
  * @param gy 指向Y轴角速度数据的指针（浮点型，单位°/s）
  * @param gz 指向Z轴角速度数据的指针（浮点型，单位°/s）
  */
-void MPU6050_GetGyroData(float *gx, float *gy, float *gz)
+void MPU6050_GetGyroData(MPU6050Dev *dev, float *gx, float *gy, float *gz)
 {
     uint8_t buf[6];
-    int16_t raw_gx, raw_gy, raw_gz;
 
     // 读取6字节的原始陀螺仪数据
-    MPU6050_ReadData(MPU6050_GYRO_XOUT_H, buf, 6);
-
-    // 合并高低字节为int16_t类型的原始数据
-    raw_gx = (int16_t)((buf[0] << 8) | buf[1]);
-    raw_gy = (int16_t)((buf[2] << 8) | buf[3]);
-    raw_gz = (int16_t)((buf[4] << 8) | buf[5]);
-
-    // 转换为浮点数并存储到输出变量
-    *gx = (float)raw_gx * GRO_Range / ADC_16 * DEG_TO_RAD;
-    *gy = (float)raw_gy * GRO_Range / ADC_16 * DEG_TO_RAD;
-    *gz = (float)raw_gz * GRO_Range / ADC_16 * DEG_TO_RAD;
-	
-	  // 消去零偏误差
-		*gx = (*gx) - GX_OFFSET;
-		*gy = (*gy) - GY_OFFSET;
-		*gz = (*gz) - GZ_OFFSET;
+    MPU6050_ReadData(dev, MPU6050_GYRO_XOUT_H, buf, 6);
+    MPU6050_ConvertGyro(dev, buf, gx, gy, gz);
 }
 
-void MPU6050_GetGyroAveData(float *gx, float *gy, float *gz) {
+/**
+ * @brief 连续读取CYCLE_COUNT次陀螺仪取均值，期间一直占用调用者；
+ *        周期采样时改用MPU6050Sampler的抽取(MPU6050_SAMPLER_DECIMATION)，在后台求均值
+ */
+void MPU6050_GetGyroAveData(MPU6050Dev *dev, float *gx, float *gy, float *gz) {
 		float tmp_gx, tmp_gy, tmp_gz;
+		*gx = 0;
+		*gy = 0;
+		*gz = 0;
 		for(int i = 0;i < CYCLE_COUNT;i++) {
-			MPU6050_GetGyroData(&tmp_gx, &tmp_gy, &tmp_gz);
+			MPU6050_GetGyroData(dev, &tmp_gx, &tmp_gy, &tmp_gz);
 			*gx += tmp_gx;
 			*gy += tmp_gy;
 			*gz += tmp_gz;
@@ -163,12 +386,89 @@ void MPU6050_GetGyroAveData(float *gx, float *gy, float *gz) {
 	
 /**
  * @brief 获取温度数据
+ * @param dev 器件实例
  * @param temp 存储温度值的指针（单位：摄氏度）
  */
-void MPU6050_GetTemp(float *temp)
+void MPU6050_GetTemp(MPU6050Dev *dev, float *temp)
 {
     uint8_t buf[2];
-    MPU6050_ReadData(MPU6050_TEMP_OUT_H, buf, 2);
-    int16_t raw_temp = (int16_t)((buf[0] << 8) | buf[1]);
-    *temp = raw_temp / 340.0 + 36.53; // 将原始温度值转换为摄氏度
+    MPU6050_ReadData(dev, MPU6050_TEMP_OUT_H, buf, 2);
+    *temp = MPU6050_ConvertTemp(dev, buf);
+}
+
+/**
+ * @brief 一次连续读取ACCEL_XOUT_H至GYRO_ZOUT_L共14字节原始数据，
+ *        比分别读取加速度与陀螺仪少一次寻址，且两者取自同一时刻的寄存器
+ * @param dev 器件实例
+ * @param buf 存储原始数据的缓冲区，至少MPU6050_SAMPLE_SIZE字节
+ * @retval 0: 成功, 1: 失败
+ */
+uint8_t MPU6050_ReadAll(MPU6050Dev *dev, uint8_t *buf)
+{
+    return MPU6050_ReadData(dev, MPU6050_ACCEL_XOUT_H, buf, MPU6050_SAMPLE_SIZE);
+}
+
+/**
+ * @brief 一次读取加速度、温度及陀螺仪并换算
+ * @param dev 器件实例
+ * @param sample 换算后的数据，读取失败时不修改
+ * @retval 0: 成功, 1: 失败
+ */
+uint8_t MPU6050_ReadSample(MPU6050Dev *dev, MPU6050Sample *sample)
+{
+    uint8_t buf[MPU6050_SAMPLE_SIZE];
+
+    if (MPU6050_ReadAll(dev, buf) != 0)
+        return 1;
+    MPU6050_ParseSample(dev, buf, sample);
+    return 0;
+}
+
+#if MPU6050_USE_DMA == 1
+/**
+ * @brief 提交一次DMA采样后立即返回，硬件I2C时排在所在总线队列中其它低优先级传输之前，
+ *        完成后在I2C或SPI的DMA中断中调用done，再由任务调用MPU6050_GetSample换算；不同总线上的器件可同时采样
+ * @param dev 器件实例，采样缓冲区及描述符在实例中
+ * @param done 完成回调，status为0表示成功，可为0
+ * @param param 传给回调的参数
+ * @retval 0: 已提交, 1: 上一次采样尚未完成
+ */
+uint8_t MPU6050_StartSample(MPU6050Dev *dev, void (*done)(void *param, uint8_t status), void *param)
+{
+    return MPU6050_StartSampleTo(dev, dev->sampleBuf, done, param);
+}
+
+/**
+ * @brief 同MPU6050_StartSample，14字节原始数据由DMA直接写入buf，供采集链按槽位写入而不经过实例的缓冲区；
+ *        可在中断中调用
+ * @param dev 器件实例
+ * @param buf 至少MPU6050_SAMPLE_SIZE字节，完成前不能读取，硬件I2C时还须在上一次采样完成后才能换用
+ * @param done 完成回调，status为0表示成功，可为0
+ * @param param 传给回调的参数
+ * @retval 0: 已提交, 1: 上一次采样尚未完成(SPI时为总线上有进行中的传输)
+ */
+uint8_t MPU6050_StartSampleTo(MPU6050Dev *dev, uint8_t *buf, void (*done)(void *param, uint8_t status), void *param)
+{
+#if MPU6050_USE_SPI == 1
+    return SpiImu_StartRead(dev->bus, MPU6050_ACCEL_XOUT_H, buf, MPU6050_SAMPLE_SIZE, done, param);
+#else
+    if (dev->sampleXfer.status == HWIIC_PENDING)
+        return 1;
+    HwI2C_XferInit(&dev->sampleXfer, dev->bus, HWIIC_READ, dev->addr, MPU6050_ACCEL_XOUT_H,
+                   buf, MPU6050_SAMPLE_SIZE, MPU6050_I2C_PRIO);
+    dev->sampleXfer.done = done;
+    dev->sampleXfer.param = param;
+    return HwI2C_Submit(&dev->sampleXfer) != HWIIC_OK;
+#endif
+}
+
+/**
+ * @brief 换算最近一次完成的DMA采样，须在完成回调之后、下次启动之前调用
+ * @param dev 器件实例
+ * @param sample 换算后的数据
+ */
+void MPU6050_GetSample(MPU6050Dev *dev, MPU6050Sample *sample)
+{
+    MPU6050_ParseSample(dev, dev->sampleBuf, sample);
 }
+#endif
@@ -2,32 +2,93 @@
 #define __MPU6050_H
 
 #include "main.h"
+#include "MyHwIIC.h"
+#include "SpiImu.h"
 //倍率说明
-#define DEG_TO_RAD (3.14159265358979323846 / 180.0)
-#define RAD_TO_DEG (180.0 / 3.14159265358979323846)
+#define DEG_TO_RAD 0.0174532925f // PI / 180，单精度常量，避免换算提升为双精度
+#define RAD_TO_DEG 57.2957795f   // 180 / PI
 #define ADC_16 65536
-#define ACC_Range 4
-#define GRO_Range 4000
-
-//高斯牛顿迭代矫正参数
-#define P0      1.001004
-#define P1      1.006896
-#define P2      0.987984
-#define P3      0.038779
-#define P4      -0.012867
-#define P5      0.509085
-
-//陀螺仪偏置矫正
-#define GX_OFFSET -0.05
-#define GY_OFFSET -0.01
-#define GZ_OFFSET 0.03
 
 //陀螺仪采样循环次数
 #define CYCLE_COUNT 10
 
 
+// 1:经硬件I2C2(PB10/PB3)以DMA读取，读取期间任务让出CPU；0:软件模拟I2C(PC4/PC5)，读取期间CPU忙等
+#define MPU6050_USE_HW_I2C    1
+#define MPU6050_I2C_PRIO      HWIIC_PRIO_IMU // 在共享总线上的传输优先级，先于气压计、磁力计等
+// 1:改用SPI接口的MPU6000/ICM-20602类器件(SpiImu，需SPI_IMU_ENABLE)，接口不变，14字节采样约12us，可到8kHz；
+//   此时MPU6050_USE_HW_I2C不起作用。8kHz采样需配置为MPU6050_DLPF_260HZ、sampleRateHz 8000
+#define MPU6050_USE_SPI       0
+#define MPU6050_USE_DMA       ((MPU6050_USE_HW_I2C == 1) || (MPU6050_USE_SPI == 1)) // 支持MPU6050_StartSample
+
+// 一次采样的原始数据：ACCEL_XOUT_H至GYRO_ZOUT_L，加速度、温度、陀螺仪共14字节，一次连续读取
+#define MPU6050_SAMPLE_SIZE   (MPU6050_GYRO_ZOUT_L - MPU6050_ACCEL_XOUT_H + 1)
+
+// 片上数字低通滤波器带宽(CONFIG寄存器DLPF_CFG)，陀螺仪带宽略低于此值
+typedef enum _MPU6050Dlpf {
+    MPU6050_DLPF_260HZ = 0,     // 关闭滤波，陀螺仪内部采样8kHz
+    MPU6050_DLPF_184HZ,
+    MPU6050_DLPF_94HZ,
+    MPU6050_DLPF_44HZ,
+    MPU6050_DLPF_21HZ,
+    MPU6050_DLPF_10HZ,
+    MPU6050_DLPF_5HZ,
+} MPU6050Dlpf;
+
+// 加速度计量程(ACCEL_CONFIG寄存器AFS_SEL)
+typedef enum _MPU6050AccelRange {
+    MPU6050_ACCEL_2G = 0,
+    MPU6050_ACCEL_4G,
+    MPU6050_ACCEL_8G,
+    MPU6050_ACCEL_16G,
+} MPU6050AccelRange;
+
+// 陀螺仪量程(GYRO_CONFIG寄存器FS_SEL)
+typedef enum _MPU6050GyroRange {
+    MPU6050_GYRO_250DPS = 0,
+    MPU6050_GYRO_500DPS,
+    MPU6050_GYRO_1000DPS,
+    MPU6050_GYRO_2000DPS,
+} MPU6050GyroRange;
+
+// 传感器配置，换算系数由量程得出
+typedef struct _MPU6050Config {
+    MPU6050Dlpf dlpf;
+    uint32_t sampleRateHz;      // 输出速率，按内部采样率分频，取不大于该值的最近一档
+    MPU6050AccelRange accelRange;
+    MPU6050GyroRange gyroRange;
+} MPU6050Config;
+
+// MPU6050_Init使用的默认配置：5Hz低通、125Hz输出、±2g、±2000°/s
+#define MPU6050_DEFAULT_DLPF        MPU6050_DLPF_5HZ
+#define MPU6050_DEFAULT_RATE_HZ     125
+#define MPU6050_DEFAULT_ACCEL_RANGE MPU6050_ACCEL_2G
+#define MPU6050_DEFAULT_GYRO_RANGE  MPU6050_GYRO_2000DPS
+
+// 加速度计校准参数：校准值 = (原始值 - offset) * scale，可由GaussNewton.c的AccelCalib在目标板上拟合后设置
+typedef struct _MPU6050AccelCalib {
+    float scale[3];     // 各轴比例系数
+    float offset[3];    // 各轴零偏(g)
+} MPU6050AccelCalib;
+
+// 一次采样换算后的数据
+typedef struct _MPU6050Sample {
+    float ax, ay, az;   // 加速度(g)，已校准
+    float gx, gy, gz;   // 角速度(rad/s)，零偏由姿态解算在线估计并扣除
+    float temp;         // 温度(摄氏度)
+} MPU6050Sample;
+
+// 一次采样的原始数据(LSB)，按两个一对排列，字对齐，定点路径可按字读出一对数据用SIMD指令两路并行处理
+typedef struct _MPU6050RawSample {
+    int16_t ax, ay;
+    int16_t az, temp;
+    int16_t gx, gy;
+    int16_t gz, pad;
+} MPU6050RawSample;
+
 // MPU6050 I2C地址
 #define MPU6050_I2C_ADDR      0x68  // 默认地址（7位地址），实际写操作时需要左移1位
+#define MPU6050_I2C_ADDR_ALT  0x69  // AD0接高电平时的地址，同一总线上的第二个器件
 
 // MPU6050 寄存器地址
 #define MPU6050_SMPLRT_DIV    0x19
@@ -35,6 +96,11 @@
 #define MPU6050_GYRO_CONFIG   0x1B
 #define MPU6050_ACCEL_CONFIG  0x1C
 
+#define MPU6050_FIFO_EN       0x23
+#define MPU6050_INT_PIN_CFG   0x37
+#define MPU6050_INT_ENABLE    0x38
+#define MPU6050_INT_STATUS    0x3A
+
 #define MPU6050_ACCEL_XOUT_H  0x3B
 #define MPU6050_ACCEL_XOUT_L  0x3C
 #define MPU6050_ACCEL_YOUT_H  0x3D
@@ -50,18 +116,92 @@
 #define MPU6050_GYRO_ZOUT_H   0x47
 #define MPU6050_GYRO_ZOUT_L   0x48
 
+#define MPU6050_USER_CTRL     0x6A
 #define MPU6050_PWR_MGMT_1    0x6B
 #define MPU6050_PWR_MGMT_2    0x6C
+#define MPU6050_FIFO_COUNTH   0x72
+#define MPU6050_FIFO_COUNTL   0x73
+#define MPU6050_FIFO_R_W      0x74
 #define MPU6050_WHO_AM_I      0x75
 
-// MPU6050功能函数声明
-uint8_t MPU6050_Init(void);                         // 初始化MPU6050
-uint8_t MPU6050_WriteReg(uint8_t reg, uint8_t data); // 写寄存器
-uint8_t MPU6050_ReadReg(uint8_t reg, uint8_t *data); // 读寄存器
-uint8_t MPU6050_ReadData(uint8_t reg, uint8_t *buf, uint16_t len); // 批量读取数据
-void MPU6050_GetAccelData(float *ax, float *ay, float *az);  // 读取加速度
-void MPU6050_GetGyroData(float *gx, float *gy, float *gz);   // 读取陀螺仪
-void MPU6050_GetGyroAveData(float *gx, float *gy, float *gz); //读取取均值的陀螺仪示数
-void MPU6050_GetTemp(float *temp);                   // 读取温度
+// 寄存器位
+#define MPU6050_INT_DATA_RDY  0x01  // INT_ENABLE/INT_STATUS：数据就绪
+#define MPU6050_INT_FIFO_OFLOW 0x10 // INT_ENABLE/INT_STATUS：FIFO溢出
+#define MPU6050_FIFO_TEMP     0x80  // FIFO_EN：温度写入FIFO
+#define MPU6050_FIFO_GYRO     0x70  // FIFO_EN：三轴陀螺仪写入FIFO
+#define MPU6050_FIFO_ACCEL    0x08  // FIFO_EN：加速度写入FIFO
+#define MPU6050_USER_FIFO_EN  0x40  // USER_CTRL：使能FIFO
+#define MPU6050_USER_FIFO_RESET 0x04 // USER_CTRL：清空FIFO
+#define MPU6050_FIFO_SIZE     1024  // FIFO容量(字节)
+
+// SPI器件：识别、复位及关闭I2C接口
+#define MPU6050_SIGNAL_PATH_RESET 0x68
+#define MPU6050_ICM_I2C_IF    0x70  // ICM-206xx：I2C_IF寄存器
+#define MPU6050_PWR_RESET     0x80  // PWR_MGMT_1：复位全部寄存器
+#define MPU6050_PWR_CLK_PLL   0x01  // PWR_MGMT_1：时钟取自陀螺仪X轴PLL
+#define MPU6050_USER_I2C_IF_DIS 0x10 // USER_CTRL：关闭I2C接口，只用SPI(MPU6000)
+#define MPU6050_ICM_I2C_IF_DIS 0x40 // I2C_IF：关闭I2C接口(ICM-206xx)
+#define MPU6050_WHOAMI_MPU6000 0x68
+#define MPU6050_WHOAMI_ICM20602 0x12
+#define MPU6050_WHOAMI_ICM20608 0xAF
+#define MPU6050_WHOAMI_ICM20689 0x98
+
+// 一个MPU6050器件：所在总线、地址、当前配置、换算系数、校准参数及DMA采样缓冲区都在实例中，驱动本身不保存状态，
+// 多个IMU各用一个实例，可以分别挂在不同的硬件I2C总线上同时读取。实例由使用者静态定义(见MPU6050Sampler.h)
+typedef struct _MPU6050Dev {
+#if MPU6050_USE_SPI == 1
+    SpiImuBus *bus;             // 所在的片选
+#else
+    HwI2CBus *bus;              // 硬件I2C时所在的总线，软件I2C时不使用
+#endif
+    uint8_t addr;               // 7位地址，MPU6050_I2C_ADDR或MPU6050_I2C_ADDR_ALT
+    MPU6050Config config;       // 当前配置，MPU6050_Configure成功后更新
+    float accelScale;           // g/LSB，由量程得出
+    float gyroScale;            // rad/s/LSB
+    MPU6050AccelCalib accelCalib;
+#if MPU6050_USE_DMA == 1
+    uint8_t sampleBuf[MPU6050_SAMPLE_SIZE]; // DMA采样缓冲区，MPU6050_StartSample启动后由DMA写入，完成前不能读取
+#endif
+#if MPU6050_USE_SPI == 0
+#if MPU6050_USE_HW_I2C == 1
+    HwI2CXfer sampleXfer;
+#endif
+#else
+    uint8_t whoAmI;             // MPU6050_Init读到的WHO_AM_I，区分MPU6000与ICM-206xx
+#endif
+} MPU6050Dev;
+
+// 加速度计校准参数的初值
+#define MPU6050_ACCEL_CALIB_NONE    {{1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}}
+#define MPU6050_ACCEL_CALIB_LAB     {{1.001004f, 1.006896f, 0.987984f}, {0.038779f, -0.012867f, 0.509085f}} // 实验室用高斯牛顿法拟合的结果
+
+// 静态定义实例的初值：默认配置及其换算系数，calib为上面的校准初值之一
+#define MPU6050_DEV_INITIALIZER(busPtr, devAddr, calib) { \
+    (busPtr), (devAddr), \
+    {MPU6050_DEFAULT_DLPF, MPU6050_DEFAULT_RATE_HZ, MPU6050_DEFAULT_ACCEL_RANGE, MPU6050_DEFAULT_GYRO_RANGE}, \
+    (2.0f * 2) / ADC_16, (2000.0f * 2) / ADC_16 * DEG_TO_RAD, calib }
+
+// MPU6050功能函数声明，dev为器件实例
+uint8_t MPU6050_Init(MPU6050Dev *dev);              // 初始化MPU6050，使用默认配置
+uint8_t MPU6050_Configure(MPU6050Dev *dev, const MPU6050Config *config); // 设置低通滤波、输出速率及量程
+void MPU6050_GetConfig(MPU6050Dev *dev, MPU6050Config *config); // 读取当前配置，sampleRateHz为实际输出速率
+void MPU6050_SetAccelCalib(MPU6050Dev *dev, const MPU6050AccelCalib *calib); // 设置加速度计校准参数，NULL恢复为不校准
+void MPU6050_GetAccelCalib(MPU6050Dev *dev, MPU6050AccelCalib *calib); // 读取当前的加速度计校准参数
+uint8_t MPU6050_WriteReg(MPU6050Dev *dev, uint8_t reg, uint8_t data); // 写寄存器
+uint8_t MPU6050_ReadReg(MPU6050Dev *dev, uint8_t reg, uint8_t *data); // 读寄存器
+uint8_t MPU6050_ReadData(MPU6050Dev *dev, uint8_t reg, uint8_t *buf, uint16_t len); // 批量读取数据
+void MPU6050_GetAccelData(MPU6050Dev *dev, float *ax, float *ay, float *az);  // 读取加速度
+void MPU6050_GetGyroData(MPU6050Dev *dev, float *gx, float *gy, float *gz);   // 读取陀螺仪
+void MPU6050_GetGyroAveData(MPU6050Dev *dev, float *gx, float *gy, float *gz); //读取取均值的陀螺仪示数
+void MPU6050_GetTemp(MPU6050Dev *dev, float *temp);  // 读取温度
+uint8_t MPU6050_ReadAll(MPU6050Dev *dev, uint8_t *buf); // 一次连续读取14字节原始数据
+void MPU6050_ParseSample(const MPU6050Dev *dev, const uint8_t *buf, MPU6050Sample *sample); // 按该器件的量程及校准换算14字节原始数据
+void MPU6050_ParseRaw(const uint8_t *buf, MPU6050RawSample *raw); // 14字节原始数据转为成对排列的int16
+uint8_t MPU6050_ReadSample(MPU6050Dev *dev, MPU6050Sample *sample); // 一次读取加速度、陀螺仪及温度
+#if MPU6050_USE_DMA == 1
+uint8_t MPU6050_StartSample(MPU6050Dev *dev, void (*done)(void *param, uint8_t status), void *param); // 启动DMA采样，完成后在中断中回调
+uint8_t MPU6050_StartSampleTo(MPU6050Dev *dev, uint8_t *buf, void (*done)(void *param, uint8_t status), void *param); // 同上，写入指定的缓冲区
+void MPU6050_GetSample(MPU6050Dev *dev, MPU6050Sample *sample); // 换算最近一次完成的DMA采样
+#endif
 
 #endif
@@ -0,0 +1,688 @@
+#include "MPU6050Sampler.h"
+#include "MyHwIIC.h"
+#include "LoopLatency.h"
+#include "tinyOS.h"
+#include <math.h>
+#include <string.h>
+
+#if (MPU6050_IMU_COUNT < 1) || (MPU6050_IMU_COUNT > 3)
+#error "MPU6050_IMU_COUNT must be between 1 and 3"
+#endif
+
+// IMU0的加速度计校准参数为实验室拟合值，其余IMU需各自拟合后用MPU6050_SetAccelCalib设置
+MPU6050Dev mpu6050Imu[MPU6050_IMU_COUNT] = {
+    MPU6050_DEV_INITIALIZER(MPU6050_IMU0_BUS, MPU6050_I2C_ADDR, MPU6050_ACCEL_CALIB_LAB),
+#if MPU6050_IMU_COUNT > 1
+    MPU6050_DEV_INITIALIZER(MPU6050_IMU1_BUS, MPU6050_IMU1_ADDR, MPU6050_ACCEL_CALIB_NONE),
+#endif
+#if MPU6050_IMU_COUNT > 2
+    MPU6050_DEV_INITIALIZER(MPU6050_IMU2_BUS, MPU6050_IMU2_ADDR, MPU6050_ACCEL_CALIB_NONE),
+#endif
+};
+
+#if (MPU6050_USE_DMA == 1) && (TINYOS_ENABLE_SEM == 1)
+
+#if (MPU6050_SAMPLER_QUEUE & (MPU6050_SAMPLER_QUEUE - 1)) != 0
+#error "MPU6050_SAMPLER_QUEUE must be a power of 2"
+#endif
+#if MPU6050_FIFO_BATCH > 16
+#error "MPU6050_FIFO_BATCH must not exceed 16"
+#endif
+#if MPU6050_SAMPLER_DECIMATION < 1
+#error "MPU6050_SAMPLER_DECIMATION must be at least 1"
+#endif
+#if (MPU6050_SAMPLER_IRQ_THREAD == 1) && (TINYOS_ENABLE_IRQ_THREAD == 0)
+#error "MPU6050_SAMPLER_IRQ_THREAD requires TINYOS_ENABLE_IRQ_THREAD"
+#endif
+#if (MPU6050_IMU_COUNT > 1) && (TINYOS_ENABLE_FLAGGROUP == 0)
+#error "MPU6050_IMU_COUNT > 1 requires TINYOS_ENABLE_FLAGGROUP"
+#endif
+#if (MPU6050_IMU_COUNT > 1) && (MPU6050_FIFO_BATCH > 0)
+#error "MPU6050_IMU_COUNT > 1 requires MPU6050_FIFO_BATCH == 0"
+#endif
+#if (MPU6050_IMU_COUNT > 1) && (MPU6050_USE_SPI == 1)
+#error "MPU6050_USE_SPI supports a single IMU: the other IMUs are on I2C buses"
+#endif
+#if (MPU6050_SAMPLER_CHAIN == 1) && ((MPU6050_IMU_COUNT > 1) || (MPU6050_FIFO_BATCH > 0))
+#error "MPU6050_SAMPLER_CHAIN requires MPU6050_IMU_COUNT == 1 and MPU6050_FIFO_BATCH == 0"
+#endif
+#if (MPU6050_SAMPLER_CHAIN == 1) && ((MPU6050_SAMPLER_CHAIN_DEPTH < 1) || (2 * MPU6050_SAMPLER_CHAIN_DEPTH > MPU6050_SAMPLER_QUEUE))
+#error "MPU6050_SAMPLER_CHAIN_DEPTH must be between 1 and MPU6050_SAMPLER_QUEUE / 2"
+#endif
+#if (MPU6050_SAMPLER_CHAIN == 1) && (MPU6050_SAMPLER_CHAIN_TRIGGER == MPU6050_CHAIN_TRIGGER_TIM) && (TINYOS_ENABLE_BENCHMARK == 3)
+#error "MPU6050_CHAIN_TRIGGER_TIM shares TIM1_UP_TIM10_IRQHandler with StressBench"
+#endif
+
+// 数据就绪中断的时间戳，按中断序号存放，FIFO批量读取时逐个对应到读出的样本
+#define SAMPLER_STAMP_COUNT         32
+// FIFO模式一次最多读出的样本数，留出一批的余量以便追上
+#define SAMPLER_FIFO_READ_MAX       (2 * MPU6050_FIFO_BATCH)
+
+static tTask samplerTask;
+static tTaskStack samplerTaskStack[MPU6050_SAMPLER_STACK_SIZE];
+#if MPU6050_SAMPLER_IRQ_THREAD == 1
+static tIrqThread samplerIrqThread;     // 数据就绪中断直接唤醒采样任务，FIFO模式下每MPU6050_FIFO_BATCH个中断一次
+#else
+static tSem samplerReadySem;            // 数据就绪中断唤醒采样任务，FIFO模式下每MPU6050_FIFO_BATCH个中断一次
+#endif
+static tSem samplerAvailSem;            // 缓冲区中的样本数，取样本的任务在上面等待
+
+#if MPU6050_SAMPLER_CHAIN == 0
+static volatile uint32_t samplerStamp[SAMPLER_STAMP_COUNT];
+#endif
+static volatile uint32_t samplerIrqCount;   // 数据就绪中断次数，只由中断修改
+static uint32_t samplerConsumed;            // 已处理到的中断序号，只由采样任务修改
+
+static MPU6050TimedSample samplerQueue[MPU6050_SAMPLER_QUEUE];
+static volatile uint32_t samplerHead;       // 只由采样任务修改
+static volatile uint32_t samplerTail;       // 只由取样本的任务修改
+
+static MPU6050SamplerStat samplerStat;
+
+#if MPU6050_SAMPLER_DECIMATION > 1
+// 抽取累加器，只由采样任务访问
+static MPU6050Sample samplerSum;
+static uint32_t samplerSumCount;
+static uint32_t samplerSumFirstStamp;
+#endif
+
+#if MPU6050_FIFO_BATCH > 0
+static uint8_t samplerFifoBuf[SAMPLER_FIFO_READ_MAX * MPU6050_SAMPLE_SIZE];
+#endif
+
+#if MPU6050_SAMPLER_CHAIN == 1
+// 乒乓缓冲区：触发中断启动DMA写入正在填充的一半的下一格，一半写满后交给采样任务换算，另一半接着写
+static uint8_t samplerChainBuf[2][MPU6050_SAMPLER_CHAIN_DEPTH][MPU6050_SAMPLE_SIZE];
+static uint32_t samplerChainStamp[2][MPU6050_SAMPLER_CHAIN_DEPTH];
+static volatile uint8_t samplerChainHalf;       // 正在填充的一半，只由中断修改
+static volatile uint8_t samplerChainFill;       // 正在填充的一半已写入的样本数，只由中断修改
+static volatile uint8_t samplerChainReady;      // 位i为1：第i半已写满，等待采样任务换算
+static volatile uint32_t samplerChainDropped;   // 采样任务来不及换算而丢弃的样本数，只由中断修改
+#endif
+
+#if MPU6050_IMU_COUNT > 1
+#define SAMPLER_IMU_MASK            ((1u << MPU6050_IMU_COUNT) - 1)
+#define SAMPLER_IMU_PENDING         0xFF    // 读取尚未完成
+
+static tFlagGroup samplerImuDone;                               // 位i：IMUi本次的DMA读取已完成
+static volatile uint8_t samplerImuStatus[MPU6050_IMU_COUNT];    // 各IMU本次读取的结果，0为成功，由完成回调写入
+static uint8_t samplerImuHealthy;                               // 初始化成功的IMU，其余不再读取
+static MPU6050Sample samplerLast;                               // 上一个表决结果，两个IMU不一致时用来取舍
+static uint8_t samplerHasLast;
+#endif
+
+#if MPU6050_SAMPLER_DECIMATION > 1
+//累加一个样本，满MPU6050_SAMPLER_DECIMATION个时求出均值
+//返回1表示sample及timestamp已替换为均值样本及其时间戳
+static uint8_t MPU6050_SamplerDecimate(MPU6050Sample *sample, uint32_t *timestamp)
+{
+    const float scale = 1.0f / MPU6050_SAMPLER_DECIMATION;
+
+    if (samplerSumCount == 0) {
+        samplerSum = *sample;
+        samplerSumFirstStamp = *timestamp;
+    } else {
+        samplerSum.ax += sample->ax;
+        samplerSum.ay += sample->ay;
+        samplerSum.az += sample->az;
+        samplerSum.gx += sample->gx;
+        samplerSum.gy += sample->gy;
+        samplerSum.gz += sample->gz;
+        samplerSum.temp += sample->temp;
+    }
+    if (++samplerSumCount < MPU6050_SAMPLER_DECIMATION) {
+        return 0;
+    }
+
+    samplerSumCount = 0;
+    sample->ax = samplerSum.ax * scale;
+    sample->ay = samplerSum.ay * scale;
+    sample->az = samplerSum.az * scale;
+    sample->gx = samplerSum.gx * scale;
+    sample->gy = samplerSum.gy * scale;
+    sample->gz = samplerSum.gz * scale;
+    sample->temp = samplerSum.temp * scale;
+    // 均值滤波的群延迟为窗口的一半
+    *timestamp = samplerSumFirstStamp + (*timestamp - samplerSumFirstStamp) / 2;
+    return 1;
+}
+#endif
+
+//抽取后写入缓冲区，缓冲区满时丢弃
+static void MPU6050_SamplerPush(MPU6050Sample sample, uint32_t timestamp)
+{
+    MPU6050TimedSample *item;
+
+#if MPU6050_SAMPLER_DECIMATION > 1
+    if (!MPU6050_SamplerDecimate(&sample, &timestamp)) {
+        return;
+    }
+#endif
+
+    if (samplerHead - samplerTail >= MPU6050_SAMPLER_QUEUE) {
+        samplerStat.dropped++;
+        return;
+    }
+    item = &samplerQueue[samplerHead & (MPU6050_SAMPLER_QUEUE - 1)];
+    item->sample = sample;
+    item->timestamp = timestamp;
+    samplerHead++;
+    samplerStat.samples++;
+    tSemNotify(&samplerAvailSem);
+}
+
+#if MPU6050_IMU_COUNT > 1
+//DMA读取完成回调，在I2C中断中调用，param为IMU序号
+static void MPU6050_SamplerImuDone(void *param, uint8_t status)
+{
+    uint32_t i = (uint32_t)(uintptr_t)param;
+
+    samplerImuStatus[i] = status;
+    tFlagGroupNotifyFromISR(&samplerImuDone, 1, 1u << i);
+}
+
+//样本的加速度及角速度按分量排成数组，前3个为加速度
+static void MPU6050_SamplerToVec(const MPU6050Sample *s, float *v)
+{
+    v[0] = s->ax;
+    v[1] = s->ay;
+    v[2] = s->az;
+    v[3] = s->gx;
+    v[4] = s->gy;
+    v[5] = s->gz;
+}
+
+//三个数的中值
+static float MPU6050_SamplerMedian3(float a, float b, float c)
+{
+    if (a > b) {
+        float t = a;
+        a = b;
+        b = t;
+    }
+    if (b > c) {
+        b = c;
+    }
+    return (a > b) ? a : b;
+}
+
+//与参考值的偏差，各分量以容差归一化后取最大值，不超过1为一致
+static float MPU6050_SamplerDeviation(const float *v, const float *ref)
+{
+    float worst = 0.0f, d;
+    int k;
+
+    for (k = 0; k < 6; k++) {
+        d = fabsf(v[k] - ref[k]) * ((k < 3) ? (1.0f / MPU6050_IMU_ACCEL_TOL) : (1.0f / MPU6050_IMU_GYRO_TOL));
+        if (d > worst) {
+            worst = d;
+        }
+    }
+    return worst;
+}
+
+//表决：samples为本次读取成功的n个样本，imu为各自的IMU序号，选出参与平均的样本后求均值
+static void MPU6050_SamplerVote(const MPU6050Sample *samples, const uint8_t *imu, uint32_t n, MPU6050Sample *fused)
+{
+    float v[MPU6050_IMU_COUNT][6], ref[6];
+    uint32_t i, used = 0, count = 0;
+    int k;
+
+    for (i = 0; i < n; i++) {
+        MPU6050_SamplerToVec(&samples[i], v[i]);
+    }
+    if (n == 1) {
+        used = 1;
+    } else if (n == 2) {
+        // 两个一致则平均；不一致时无法判断哪个正确，取与上一个输出接近的一个，没有上一个输出时取序号小的
+        if (MPU6050_SamplerDeviation(v[0], v[1]) <= 1.0f) {
+            used = 3;
+        } else {
+            samplerStat.disagreements++;
+            used = 1;
+            if (samplerHasLast) {
+                MPU6050_SamplerToVec(&samplerLast, ref);
+                if (MPU6050_SamplerDeviation(v[1], ref) < MPU6050_SamplerDeviation(v[0], ref)) {
+                    used = 2;
+                }
+            }
+        }
+    } else {
+        // 逐个分量取中值作为参考，任一分量偏离超过容差的IMU本次剔除
+        for (k = 0; k < 6; k++) {
+            ref[k] = MPU6050_SamplerMedian3(v[0][k], v[1][k], v[2][k]);
+        }
+        for (i = 0; i < n; i++) {
+            if (MPU6050_SamplerDeviation(v[i], ref) <= 1.0f) {
+                used |= 1u << i;
+            } else {
+                samplerStat.imuRejects[imu[i]]++;
+            }
+        }
+        // 三个互不一致时中值分量来自不同的IMU，退回到中值本身
+        if (used == 0) {
+            fused->ax = ref[0];
+            fused->ay = ref[1];
+            fused->az = ref[2];
+            fused->gx = ref[3];
+            fused->gy = ref[4];
+            fused->gz = ref[5];
+            fused->temp = MPU6050_SamplerMedian3(samples[0].temp, samples[1].temp, samples[2].temp);
+            return;
+        }
+    }
+
+    memset(fused, 0, sizeof(*fused));
+    for (i = 0; i < n; i++) {
+        if (!(used & (1u << i))) {
+            continue;
+        }
+        fused->ax += samples[i].ax;
+        fused->ay += samples[i].ay;
+        fused->az += samples[i].az;
+        fused->gx += samples[i].gx;
+        fused->gy += samples[i].gy;
+        fused->gz += samples[i].gz;
+        fused->temp += samples[i].temp;
+        count++;
+    }
+    if (count > 1) {
+        float scale = 1.0f / count;
+        fused->ax *= scale;
+        fused->ay *= scale;
+        fused->az *= scale;
+        fused->gx *= scale;
+        fused->gy *= scale;
+        fused->gz *= scale;
+        fused->temp *= scale;
+    }
+}
+#endif
+
+#if MPU6050_SAMPLER_CHAIN == 1
+static void MPU6050_SamplerChainDone(void *param, uint8_t status);
+
+//触发：记下时间戳并启动DMA读取到正在填充的一格，在触发中断中调用；上一次的读取还未完成时本次计为丢失
+static void MPU6050_SamplerChainTrigger(void)
+{
+    uint32_t half = samplerChainHalf;
+    uint32_t slot = samplerChainFill;
+
+    LoopLatency_MarkReady();
+    samplerIrqCount++;
+    samplerChainStamp[half][slot] = (uint32_t)tTimeGetMicros();
+    if (MPU6050_StartSampleTo(MPU6050_PRIMARY, samplerChainBuf[half][slot], MPU6050_SamplerChainDone, (void *)0) != 0) {
+        samplerStat.missed++;
+    }
+}
+
+//DMA读取完成回调，在I2C或SPI的DMA中断中调用：出错的一格由下一次触发重写，一半写满时交给采样任务
+//触发中断与完成中断同为TINYOS_MAX_SYSCALL_PRIO，互不嵌套，传输状态与samplerChainFill总是一起更新
+static void MPU6050_SamplerChainDone(void *param, uint8_t status)
+{
+    uint32_t half = samplerChainHalf;
+
+    (void)param;
+    if (status != HWIIC_OK) {
+        samplerStat.busErrors++;
+        return;
+    }
+    if (++samplerChainFill < MPU6050_SAMPLER_CHAIN_DEPTH) {
+        return;
+    }
+    samplerChainFill = 0;
+    // 另一半还未换算完，不能切换过去，这一半作废后重新填充
+    if (samplerChainReady & (1u << (half ^ 1))) {
+        samplerChainDropped += MPU6050_SAMPLER_CHAIN_DEPTH;
+        return;
+    }
+    samplerChainReady |= (uint8_t)(1u << half);
+    samplerChainHalf = (uint8_t)(half ^ 1);
+#if MPU6050_SAMPLER_IRQ_THREAD == 1
+    tIrqThreadDispatch(&samplerIrqThread);
+#else
+    tSemNotifyFromISR(&samplerReadySem);
+#endif
+}
+
+//换算写满的一半并写入缓冲区，之后中断才能再切换到这一半；中断只在另一半为空时置位，同一时刻至多一半待换算
+static void MPU6050_SamplerChainDrain(void)
+{
+    uint32_t half, k, status;
+    MPU6050Sample sample;
+
+    if (samplerChainReady == 0) {
+        return;
+    }
+    half = (samplerChainReady & 0x1) ? 0 : 1;
+    for (k = 0; k < MPU6050_SAMPLER_CHAIN_DEPTH; k++) {
+        MPU6050_ParseSample(MPU6050_PRIMARY, samplerChainBuf[half][k], &sample);
+        MPU6050_SamplerPush(sample, samplerChainStamp[half][k]);
+    }
+    status = tTaskEnterCritical();
+    samplerChainReady &= (uint8_t)~(1u << half);
+    tTaskExitCritical(status);
+}
+
+#if MPU6050_SAMPLER_CHAIN_TRIGGER == MPU6050_CHAIN_TRIGGER_TIM
+//TIM1按MPU6050_SAMPLER_CHAIN_HZ产生更新中断，APB2分频不为1时定时器时钟为PCLK2的两倍
+static void MPU6050_SamplerChainTimerStart(void)
+{
+    uint32_t clk = HAL_RCC_GetPCLK2Freq();
+    uint32_t ticks, psc;
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE2) != RCC_CFGR_PPRE2_DIV1) {
+        clk *= 2;
+    }
+    __HAL_RCC_TIM1_CLK_ENABLE();
+    ticks = clk / MPU6050_SAMPLER_CHAIN_HZ;
+    psc = (ticks - 1) / 0x10000;
+    TIM1->CR1 = 0;
+    TIM1->PSC = psc;
+    TIM1->ARR = ticks / (psc + 1) - 1;
+    TIM1->RCR = 0;
+    TIM1->CNT = 0;
+    TIM1->EGR = TIM_EGR_UG;
+    TIM1->SR = 0;
+    TIM1->DIER = TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(TIM1_UP_TIM10_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);
+    HAL_NVIC_EnableIRQ(TIM1_UP_TIM10_IRQn);
+    TIM1->CR1 = TIM_CR1_CEN;
+}
+
+//采样定时：触发一次采集链
+void TIM1_UP_TIM10_IRQHandler(void)
+{
+    tIntEnter();
+    TIM1->SR = ~TIM_SR_UIF;
+    MPU6050_SamplerChainTrigger();
+    tIntExit();
+}
+#endif
+#elif MPU6050_FIFO_BATCH == 0
+//读取最新的一个样本，之前未来得及读取的样本计为丢失
+//多个IMU时同时启动各IMU的DMA读取，不同总线上的读取并行进行，全部完成或超时后表决
+static void MPU6050_SamplerReadOne(void)
+{
+    uint32_t irq = samplerIrqCount;
+    uint32_t timestamp = samplerStamp[(irq - 1) & (SAMPLER_STAMP_COUNT - 1)];
+#if MPU6050_IMU_COUNT > 1
+    MPU6050Sample samples[MPU6050_IMU_COUNT], fused;
+    uint8_t imu[MPU6050_IMU_COUNT];
+    uint32_t started = 0, result, i, n = 0;
+#else
+    uint8_t buf[MPU6050_SAMPLE_SIZE];
+    MPU6050Sample sample;
+#endif
+
+    if (irq - samplerConsumed > 1) {
+        samplerStat.missed += irq - samplerConsumed - 1;
+    }
+    samplerConsumed = irq;
+
+#if MPU6050_IMU_COUNT > 1
+    // 上次超时未完成的读取现已结束，其完成标志作废
+    tFlagGroupNotify(&samplerImuDone, 0, SAMPLER_IMU_MASK);
+    for (i = 0; i < MPU6050_IMU_COUNT; i++) {
+        samplerImuStatus[i] = SAMPLER_IMU_PENDING;
+        if ((samplerImuHealthy & (1u << i)) &&
+            (MPU6050_StartSample(&mpu6050Imu[i], MPU6050_SamplerImuDone, (void *)(uintptr_t)i) == 0)) {
+            started |= 1u << i;
+        } else {
+            samplerStat.imuRejects[i]++;
+        }
+    }
+    if (started != 0) {
+        tFlagGroupWait(&samplerImuDone, TFLAGGROUP_SET_ALL | TFLAGGROUP_CONSUME, started, &result, MPU6050_IMU_TIMEOUT_TICKS);
+    }
+
+    // 超时后才完成的读取同样可用，状态在DMA结束后才写入
+    for (i = 0; i < MPU6050_IMU_COUNT; i++) {
+        if (!(started & (1u << i))) {
+            continue;
+        }
+        if (samplerImuStatus[i] != 0) {
+            samplerStat.imuRejects[i]++;
+            continue;
+        }
+        MPU6050_GetSample(&mpu6050Imu[i], &samples[n]);
+        imu[n++] = (uint8_t)i;
+    }
+    if (n == 0) {
+        samplerStat.busErrors++;
+        return;
+    }
+    MPU6050_SamplerVote(samples, imu, n, &fused);
+    samplerLast = fused;
+    samplerHasLast = 1;
+    MPU6050_SamplerPush(fused, timestamp);
+#else
+    if (MPU6050_ReadAll(MPU6050_PRIMARY, buf) != 0) {
+        samplerStat.busErrors++;
+        return;
+    }
+    MPU6050_ParseSample(MPU6050_PRIMARY, buf, &sample);
+    MPU6050_SamplerPush(sample, timestamp);
+#endif
+}
+#else
+//清空FIFO，之前的中断时间戳作废
+static void MPU6050_SamplerFifoReset(void)
+{
+    MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET);
+    MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN);
+    samplerConsumed = samplerIrqCount;
+}
+
+//一次连续读出FIFO中已到达的样本，第k个样本对应第samplerConsumed+k次中断的时间戳
+static void MPU6050_SamplerReadFifo(void)
+{
+    uint8_t countBuf[2];
+    uint32_t count, n, pending, irq, k;
+    MPU6050Sample sample;
+
+    irq = samplerIrqCount;
+    if (MPU6050_ReadData(MPU6050_PRIMARY, MPU6050_FIFO_COUNTH, countBuf, 2) != 0) {
+        samplerStat.busErrors++;
+        return;
+    }
+    count = ((uint32_t)countBuf[0] << 8) | countBuf[1];
+
+    // 放不下下一个完整样本时FIFO即将溢出，样本边界不再可靠
+    if (count > MPU6050_FIFO_SIZE - MPU6050_SAMPLE_SIZE) {
+        samplerStat.overflows++;
+        MPU6050_SamplerFifoReset();
+        return;
+    }
+
+    // FIFO中的样本少于中断次数说明之前有样本丢失，最旧的时间戳作废
+    n = count / MPU6050_SAMPLE_SIZE;
+    pending = irq - samplerConsumed;
+    if (pending > n) {
+        samplerStat.missed += pending - n;
+        samplerConsumed = irq - n;
+        pending = n;
+    }
+    // 读取FIFO计数之后才到达的样本，其中断尚未计入，留到下次
+    if (n > pending) {
+        n = pending;
+    }
+    if (n > SAMPLER_FIFO_READ_MAX) {
+        n = SAMPLER_FIFO_READ_MAX;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    if (MPU6050_ReadData(MPU6050_PRIMARY, MPU6050_FIFO_R_W, samplerFifoBuf, n * MPU6050_SAMPLE_SIZE) != 0) {
+        // 读取的字节数未知，样本边界不再可靠
+        samplerStat.busErrors++;
+        MPU6050_SamplerFifoReset();
+        return;
+    }
+    for (k = 0; k < n; k++) {
+        MPU6050_ParseSample(MPU6050_PRIMARY, &samplerFifoBuf[k * MPU6050_SAMPLE_SIZE], &sample);
+        MPU6050_SamplerPush(sample, samplerStamp[(samplerConsumed + k) & (SAMPLER_STAMP_COUNT - 1)]);
+    }
+    samplerConsumed += n;
+}
+#endif
+
+//采样任务：等待数据就绪中断，经DMA读取，等待期间让出CPU
+static void MPU6050_SamplerEntry(void *param)
+{
+    for (;;) {
+#if MPU6050_SAMPLER_IRQ_THREAD == 1
+        tIrqThreadWait(&samplerIrqThread, 0);
+#else
+        tSemWait(&samplerReadySem, 0);
+#endif
+#if MPU6050_SAMPLER_CHAIN == 1
+        MPU6050_SamplerChainDrain();
+#elif MPU6050_FIFO_BATCH == 0
+        MPU6050_SamplerReadOne();
+#else
+        MPU6050_SamplerReadFifo();
+#endif
+    }
+}
+
+/**
+ * @brief 配置INT引脚及MPU6050的数据就绪中断，FIFO模式下开启FIFO，并创建采样任务
+ *        多个IMU时按IMU0的配置初始化其余IMU，初始化失败的IMU不参与采样
+ * @retval 0: 成功, 1: IMU0配置失败
+ */
+uint8_t MPU6050_SamplerInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+#if MPU6050_IMU_COUNT > 1
+    MPU6050Config config;
+    uint32_t i;
+#endif
+
+#if MPU6050_SAMPLER_IRQ_THREAD == 0
+    tSemInit(&samplerReadySem, 0, 1);
+#endif
+    tSemInit(&samplerAvailSem, 0, MPU6050_SAMPLER_QUEUE);
+    samplerIrqCount = 0;
+    samplerConsumed = 0;
+    samplerHead = 0;
+    samplerTail = 0;
+#if MPU6050_SAMPLER_DECIMATION > 1
+    samplerSumCount = 0;
+#endif
+#if MPU6050_SAMPLER_CHAIN == 1
+    samplerChainHalf = 0;
+    samplerChainFill = 0;
+    samplerChainReady = 0;
+    samplerChainDropped = 0;
+#endif
+#if MPU6050_IMU_COUNT > 1
+    tFlagGroupInit(&samplerImuDone, 0);
+    samplerHasLast = 0;
+    samplerImuHealthy = 1;  // IMU0已由调用者初始化
+    MPU6050_GetConfig(MPU6050_PRIMARY, &config);
+    for (i = 1; i < MPU6050_IMU_COUNT; i++) {
+        if ((MPU6050_Init(&mpu6050Imu[i]) == 0) && (MPU6050_Configure(&mpu6050Imu[i], &config) == 0)) {
+            samplerImuHealthy |= (uint8_t)(1u << i);
+        }
+    }
+#endif
+
+    // INT引脚：推挽高电平有效，50us脉冲，上升沿触发
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    GPIO_InitStruct.Pin = MPU6050_INT_GPIO_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+    GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+    HAL_GPIO_Init(MPU6050_INT_GPIO_PORT, &GPIO_InitStruct);
+
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_INT_PIN_CFG, 0x00) != 0)
+        return 1;
+#if MPU6050_FIFO_BATCH > 0
+    // 加速度、温度、陀螺仪按寄存器顺序写入FIFO，每个样本的布局与MPU6050_ReadAll相同
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_FIFO_EN, MPU6050_FIFO_ACCEL | MPU6050_FIFO_TEMP | MPU6050_FIFO_GYRO) != 0)
+        return 1;
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET) != 0)
+        return 1;
+    if (MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN) != 0)
+        return 1;
+#endif
+
+    tTaskInit(&samplerTask, MPU6050_SamplerEntry, (void *)0, MPU6050_SAMPLER_PRIO, samplerTaskStack, sizeof(samplerTaskStack));
+    tObjectSetName(&samplerTask.object, "imu");
+#if MPU6050_SAMPLER_IRQ_THREAD == 1
+    // EXTI挂起位已由HAL_GPIO_EXTI_IRQHandler清除，不需要应答及屏蔽
+    tIrqThreadInit(&samplerIrqThread, &samplerTask, -1, (void (*)(void))0);
+#endif
+#if (MPU6050_SAMPLER_CHAIN == 1) && (MPU6050_SAMPLER_CHAIN_TRIGGER == MPU6050_CHAIN_TRIGGER_TIM)
+    // 由TIM1定时触发，不使用MPU6050的数据就绪中断
+    MPU6050_SamplerChainTimerStart();
+    return 0;
+#else
+
+    HAL_NVIC_SetPriority(MPU6050_INT_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);//中断中唤醒采样任务，优先级不能高于TINYOS_MAX_SYSCALL_PRIO
+    HAL_NVIC_EnableIRQ(MPU6050_INT_IRQn);
+    return MPU6050_WriteReg(MPU6050_PRIMARY, MPU6050_INT_ENABLE, MPU6050_INT_DATA_RDY);
+#endif
+}
+
+/**
+ * @brief 取出最早的样本
+ * @param sample 取出的样本
+ * @param waitTicks 缓冲区为空时等待的节拍数，0为一直等待
+ * @return tErrorNoError或tErrorTimeOut
+ */
+uint32_t MPU6050_SamplerRead(MPU6050TimedSample *sample, uint32_t waitTicks)
+{
+    uint32_t err = tSemWait(&samplerAvailSem, waitTicks);
+
+    if (err != tErrorNoError) {
+        return err;
+    }
+    *sample = samplerQueue[samplerTail & (MPU6050_SAMPLER_QUEUE - 1)];
+    samplerTail++;
+    return tErrorNoError;
+}
+
+/**
+ * @brief 读取采样统计
+ */
+void MPU6050_SamplerGetStat(MPU6050SamplerStat *stat)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    *stat = samplerStat;
+    stat->interrupts = samplerIrqCount;
+#if MPU6050_SAMPLER_CHAIN == 1
+    stat->dropped += samplerChainDropped;
+#endif
+    tTaskExitCritical(status);
+}
+
+//数据就绪中断：记下时间戳，唤醒采样任务
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin != MPU6050_INT_GPIO_PIN) {
+        return;
+    }
+#if MPU6050_SAMPLER_CHAIN == 1
+    // 采集链：中断中直接启动读取，写满一半时才唤醒采样任务
+    MPU6050_SamplerChainTrigger();
+#else
+    LoopLatency_MarkReady();
+    samplerStamp[samplerIrqCount & (SAMPLER_STAMP_COUNT - 1)] = (uint32_t)tTimeGetMicros();
+    samplerIrqCount++;
+#if MPU6050_FIFO_BATCH > 0
+    if ((samplerIrqCount % MPU6050_FIFO_BATCH) != 0) {
+        return;
+    }
+#endif
+#if MPU6050_SAMPLER_IRQ_THREAD == 1
+    tIrqThreadDispatch(&samplerIrqThread);
+#else
+    tSemNotifyFromISR(&samplerReadySem);
+#endif
+#endif
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __MPU6050SAMPLER_H
+#define __MPU6050SAMPLER_H
+
+#include "MPU6050.h"
+
+// 数据就绪中断驱动的采样：MPU6050的INT引脚接PA1(EXTI1)，每个样本就绪时中断记下时间戳并唤醒采样任务，
+// 采样任务经硬件I2C或SPI的DMA读取，带时间戳的样本按到达顺序写入缓冲区，由融合任务取出；
+// 需开启TINYOS_ENABLE_SEM及MPU6050_USE_HW_I2C或MPU6050_USE_SPI
+#define MPU6050_INT_GPIO_PORT       GPIOA
+#define MPU6050_INT_GPIO_PIN        GPIO_PIN_1
+#define MPU6050_INT_IRQn            EXTI1_IRQn
+
+#define MPU6050_SAMPLER_PRIO        0   // 采样任务优先级，高于融合及控制任务
+#define MPU6050_SAMPLER_STACK_SIZE  256 // 采样任务栈(字)
+#define MPU6050_SAMPLER_QUEUE       16  // 待取出样本的缓冲区容量，2的幂
+
+// 硬件FIFO批量读取：0时每个数据就绪中断读取一个样本；N>0时样本先写入MPU6050的FIFO，
+// 每N个数据就绪中断一次连续读出N个样本，适合高输出速率时减少总线事务；每个样本14字节，N不超过16
+#define MPU6050_FIFO_BATCH          0
+
+// 抽取：每MPU6050_SAMPLER_DECIMATION个样本求均值后输出一个，取样本的任务按输出速率/抽取倍数得到均值样本，
+// 求均值在采样任务中随样本到达逐个累加完成；输出样本的时间戳取参与平均的首末样本的中点。1为不抽取
+#define MPU6050_SAMPLER_DECIMATION  1
+
+// 中断线程：1时数据就绪中断经tIrqThreadDispatch直接唤醒采样任务，不经过信号量的等待队列，需开启TINYOS_ENABLE_IRQ_THREAD
+#define MPU6050_SAMPLER_IRQ_THREAD  0
+
+// 采集链：1时由触发中断直接启动DMA读取，不经过采样任务，每个样本写入乒乓缓冲区中正在填充的一半的下一格，
+// 一半写满MPU6050_SAMPLER_CHAIN_DEPTH个样本后才唤醒采样任务换算，另一半接着填充；采样任务来不及换算时丢弃新写满的一半。
+// 触发源为MPU6050的INT(EXTI1)或TIM1更新事件，后者的采样时刻由定时器决定，读取的是最近一次转换的结果，
+// MPU6050的输出速率需不低于MPU6050_SAMPLER_CHAIN_HZ。F4的I2C须由中断产生起始位、发送地址，
+// 每个样本仍有触发中断及I2C事件中断，但不再有任务切换；MPU6050_USE_SPI时触发中断中直接启动SPI的DMA，
+// 每个样本只有触发及DMA完成两个中断，8kHz采样可取DEPTH为8让采样任务仍按1kHz唤醒；采样任务每DEPTH个样本唤醒一次，样本成批到达，
+// 控制回路按样本处理时延迟最多增加DEPTH - 1个周期，要求低延迟时DEPTH取1。
+// 需MPU6050_IMU_COUNT为1且MPU6050_FIFO_BATCH为0；TIM1触发时与TINYOS_ENABLE_BENCHMARK为3的StressBench共用中断向量，不能同时开启
+#define MPU6050_SAMPLER_CHAIN           0
+#define MPU6050_CHAIN_TRIGGER_EXTI      0
+#define MPU6050_CHAIN_TRIGGER_TIM       1
+#define MPU6050_SAMPLER_CHAIN_TRIGGER   MPU6050_CHAIN_TRIGGER_EXTI
+#define MPU6050_SAMPLER_CHAIN_DEPTH     4       // 乒乓缓冲区每一半的样本数，1 ~ MPU6050_SAMPLER_QUEUE / 2
+#define MPU6050_SAMPLER_CHAIN_HZ        1000    // TIM1触发时的采样频率
+
+// 冗余IMU：MPU6050_IMU_COUNT个MPU6050，IMU0的INT引脚驱动采样，每次中断对所有正常的IMU同时启动DMA读取，
+// 不同总线上的读取并行进行，采样任务在事件标志组上等待全部完成后再表决：
+// 3个时逐个分量取中值，偏离中值超过容差的IMU本次剔除，其余求平均；2个时一致则平均，不一致时取与上一个输出接近的一个；
+// 1个时(或其余都失效)直接输出。各IMU须以相同的轴向安装，加速度计校准参数只有IMU0预置实验室拟合值。
+// 多于1个时需开启TINYOS_ENABLE_FLAGGROUP，且MPU6050_FIFO_BATCH为0、MPU6050_USE_SPI为0；挂在I2C3上需开启HWIIC_BUS3_ENABLE
+#define MPU6050_IMU_COUNT           1               // 1 ~ 3
+#if MPU6050_USE_SPI == 1
+#define MPU6050_IMU0_BUS            (&spiImuBus0)   // 主IMU：SPI3，PA15片选
+#else
+#define MPU6050_IMU0_BUS            (&hwI2CBus2)    // 主IMU：I2C2，地址0x68
+#endif
+#define MPU6050_IMU1_BUS            (&hwI2CBus3)    // 第二个IMU：I2C3，地址0x68
+#define MPU6050_IMU1_ADDR           MPU6050_I2C_ADDR
+#define MPU6050_IMU2_BUS            (&hwI2CBus2)    // 第三个IMU：与IMU0同在I2C2，AD0接高电平取地址0x69
+#define MPU6050_IMU2_ADDR           MPU6050_I2C_ADDR_ALT
+#define MPU6050_IMU_TIMEOUT_TICKS   1               // 等待各IMU读取完成的节拍数，超时未完成的IMU本次不参与表决
+#define MPU6050_IMU_GYRO_TOL        0.2f            // 角速度与中值(或另一个IMU)的最大偏差(rad/s)
+#define MPU6050_IMU_ACCEL_TOL       0.3f            // 加速度的最大偏差(g)
+
+// 各IMU的实例，IMU0为主IMU，GyroCalib、对准及控制器的直接读取都使用IMU0
+extern MPU6050Dev mpu6050Imu[MPU6050_IMU_COUNT];
+#define MPU6050_PRIMARY             (&mpu6050Imu[0])
+
+// 带时间戳的样本
+typedef struct _MPU6050TimedSample {
+    MPU6050Sample sample;
+    uint32_t timestamp;     // 数据就绪中断的时间(us，tTimeGetMicros的低32位)
+} MPU6050TimedSample;
+
+// 采样统计
+typedef struct _MPU6050SamplerStat {
+    uint32_t interrupts;    // 数据就绪中断次数，采集链由TIM1触发时为触发次数
+    uint32_t samples;       // 写入缓冲区的样本数，抽取时为均值样本数
+    uint32_t missed;        // 采样任务来不及读取而丢失的样本数
+    uint32_t dropped;       // 缓冲区满而丢弃的样本数
+    uint32_t busErrors;     // I2C读取失败次数
+    uint32_t overflows;     // 硬件FIFO溢出次数
+    uint32_t imuRejects[MPU6050_IMU_COUNT]; // 各IMU读取失败、未初始化成功或表决中被剔除的次数
+    uint32_t disagreements; // 两个IMU不一致、无法判断哪个正确的次数
+} MPU6050SamplerStat;
+
+uint8_t MPU6050_SamplerInit(void);                                              // 配置中断及FIFO并创建采样任务，需先调用MPU6050_Init
+uint32_t MPU6050_SamplerRead(MPU6050TimedSample *sample, uint32_t waitTicks);   // 取出最早的样本，返回tError
+void MPU6050_SamplerGetStat(MPU6050SamplerStat *stat);                          // 读取采样统计
+
+#endif
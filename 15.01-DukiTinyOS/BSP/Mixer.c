@@ -0,0 +1,171 @@
+#include "Mixer.h"
+#include "AttitudeMath.h"
+
+// 混控表，系数的符号按接收机的杆量方向定义：滚转向右、俯仰向上、偏航向右为正
+static const MixerRule mixerTable[MIXER_MOTOR_COUNT] = {
+#if MIXER_TYPE == MIXER_QUAD_X
+    {-1.0f,  1.0f,  1.0f},  // 电机1
+    { 1.0f,  1.0f, -1.0f},  // 电机2
+    {-1.0f, -1.0f, -1.0f},  // 电机3
+    { 1.0f, -1.0f,  1.0f},  // 电机4
+#elif MIXER_TYPE == MIXER_QUAD_PLUS
+    { 0.0f,  1.0f,  1.0f},  // 前
+    { 1.0f,  0.0f, -1.0f},  // 右
+    { 0.0f, -1.0f,  1.0f},  // 后
+    {-1.0f,  0.0f, -1.0f},  // 左
+#elif MIXER_TYPE == MIXER_HEX_X
+    {-0.5f,  0.866025f,  1.0f}, // 右前
+    {-1.0f,  0.0f,      -1.0f}, // 右
+    {-0.5f, -0.866025f,  1.0f}, // 右后
+    { 0.5f, -0.866025f, -1.0f}, // 左后
+    { 1.0f,  0.0f,       1.0f}, // 左
+    { 0.5f,  0.866025f, -1.0f}, // 左前
+#else
+#error "MIXER_TYPE不支持"
+#endif
+};
+
+// 推力到油门指令的逆查找表，均匀分布的MIXER_THRUST_LUT_STEPS段，由Mixer_Init或Mixer_SetThrustCurve填写
+static float mixerThrustLut[MIXER_THRUST_LUT_STEPS + 1];
+
+/**
+ * @brief 按混控表计算所有电机的输出
+ *        循环内只有乘加与条件选择，编译为VMLA及IT块中的VMOV，不产生分支
+ *
+ * @param throttle 油门(0 ~ 1)
+ * @param roll 滚转控制量，0为中点
+ * @param pitch 俯仰控制量，0为中点
+ * @param yaw 偏航控制量，0为中点
+ * @param motor 输出MIXER_MOTOR_COUNT个电机的值(0 ~ 1)
+ *
+ * @return void
+ */
+void Mixer_Mix(float throttle, float roll, float pitch, float yaw, float *motor) {
+    float axis[MIXER_MOTOR_COUNT];
+    float lo = 0.0f, hi = 0.0f, range, scale, v;
+    int i;
+
+    for (i = 0; i < MIXER_MOTOR_COUNT; i++) {
+        v = roll * mixerTable[i].roll + pitch * mixerTable[i].pitch + yaw * mixerTable[i].yaw;
+        axis[i] = v;
+        hi = (v > hi) ? v : hi;
+        lo = (v < lo) ? v : lo;
+    }
+
+    // 三轴跨度超过输出范围时整体缩小
+    range = hi - lo;
+    scale = (range > 1.0f) ? (1.0f / range) : 1.0f;
+    lo *= scale;
+    hi *= scale;
+
+#if MIXER_AIRMODE == 1
+    // 平移油门，使最低与最高的电机都不超出范围
+    throttle = (throttle > 1.0f - hi) ? (1.0f - hi) : throttle;
+    throttle = (throttle < -lo) ? -lo : throttle;
+#endif
+
+    for (i = 0; i < MIXER_MOTOR_COUNT; i++) {
+        v = throttle + axis[i] * scale;
+        v = (v > 1.0f) ? 1.0f : v;
+        motor[i] = (v < 0.0f) ? 0.0f : v;
+    }
+}
+
+/**
+ * @brief 由电池电压得出电压补偿系数：参考电压与当前电压之比，限制在MIXER_VBAT_COMP_MAX以内
+ *
+ * @param voltage 电池电压(V)，不大于0表示未知
+ * @param cells 串联节数
+ *
+ * @return float 补偿系数，电压未知时为1
+ */
+float Mixer_VbatScale(float voltage, uint32_t cells) {
+    float scale;
+
+    if ((voltage <= 0.0f) || (cells == 0)) {
+        return 1.0f;
+    }
+    scale = MIXER_VBAT_REF_CELL * (float)cells / voltage;
+    return (scale > MIXER_VBAT_COMP_MAX) ? MIXER_VBAT_COMP_MAX : scale;
+}
+
+/**
+ * @brief 由推力模型t = (1 - k)u + ku²生成逆查找表：u = (sqrt((1 - k)² + 4kt) - (1 - k)) / 2k
+ *        开方只在这里做MIXER_THRUST_LUT_STEPS + 1次，k为0时为恒等映射
+ *
+ * @return void
+ */
+void Mixer_Init(void) {
+    const float k = MIXER_THRUST_LINEAR;
+    float t;
+    int i;
+
+    for (i = 0; i <= MIXER_THRUST_LUT_STEPS; i++) {
+        t = (float)i / MIXER_THRUST_LUT_STEPS;
+        mixerThrustLut[i] = (k > 0.0f) ? (ATTITUDE_SQRTF((1.0f - k) * (1.0f - k) + 4.0f * k * t) - (1.0f - k)) * (0.5f / k) : t;
+    }
+}
+
+/**
+ * @brief 用实测的推力曲线代替推力模型：thrust[i]为油门i / (count - 1)时的推力，按满油门归一化后求逆填入查找表
+ *
+ * @param thrust 推力，油门从0到满均匀分布的count个点，需单调递增，单位任意
+ * @param count 点数，至少2个
+ *
+ * @return 0成功，1点数不足或曲线不单调，查找表不变
+ */
+uint8_t Mixer_SetThrustCurve(const float *thrust, uint32_t count) {
+    float lut[MIXER_THRUST_LUT_STEPS + 1];
+    float full, t, lo, hi;
+    uint32_t i, seg = 0;
+
+    if ((count < 2) || !(thrust[count - 1] > thrust[0])) {
+        return 1;
+    }
+    for (i = 1; i < count; i++) {
+        if (thrust[i] < thrust[i - 1]) {
+            return 1;
+        }
+    }
+    full = thrust[count - 1] - thrust[0];
+    for (i = 0; i <= MIXER_THRUST_LUT_STEPS; i++) {
+        // 找到推力所在的一段，段内按线性插值得出油门
+        t = thrust[0] + full * (float)i / MIXER_THRUST_LUT_STEPS;
+        while ((seg < count - 2) && (thrust[seg + 1] < t)) {
+            seg++;
+        }
+        lo = thrust[seg];
+        hi = thrust[seg + 1];
+        lut[i] = ((float)seg + ((hi > lo) ? (t - lo) / (hi - lo) : 0.0f)) / (float)(count - 1);
+    }
+    for (i = 0; i <= MIXER_THRUST_LUT_STEPS; i++) {
+        mixerThrustLut[i] = lut[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief 把相对推力换算为油门指令：查表线性插值后乘以电压补偿系数，补偿后超过1的电机限幅，
+ *        高油门时电压补偿让位于姿态控制；每个电机一次查表，不做开方
+ *
+ * @param motor MIXER_MOTOR_COUNT个电机的相对推力(0 ~ 1)，原地换算为油门指令(0 ~ 1)
+ * @param vbatScale 电压补偿系数，见Mixer_VbatScale
+ *
+ * @return void
+ */
+void Mixer_Output(float *motor, float vbatScale) {
+    int i;
+    uint32_t index;
+    float v, x;
+
+    for (i = 0; i < MIXER_MOTOR_COUNT; i++) {
+        // Mixer_Mix的输出已在0 ~ 1内，x最大为MIXER_THRUST_LUT_STEPS，这时取最后一段的终点
+        x = motor[i] * MIXER_THRUST_LUT_STEPS;
+        index = (uint32_t)x;
+        index = (index >= MIXER_THRUST_LUT_STEPS) ? (MIXER_THRUST_LUT_STEPS - 1) : index;
+        v = mixerThrustLut[index] + (mixerThrustLut[index + 1] - mixerThrustLut[index]) * (x - (float)index);
+        v *= vbatScale;
+        v = (v > 1.0f) ? 1.0f : v;
+        motor[i] = (v < 0.0f) ? 0.0f : v;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef __MIXER_H
+#define __MIXER_H
+
+#include <stdint.h>
+
+// 电机混控：油门与滚转、俯仰、偏航三轴控制量按编译时选定的混控矩阵一次算出全部电机的输出
+// 每个电机的输出 = 油门 + 滚转 * roll + 俯仰 * pitch + 偏航 * yaw，系数见Mixer.c中的混控表
+#define MIXER_QUAD_X        0   // 四轴X型，电机顺序与通道定义与接收机混控一致(见Receiver.c中pwmMapVal的说明)
+#define MIXER_QUAD_PLUS     1   // 四轴+型，电机1~4依次为前、右、后、左
+#define MIXER_HEX_X         2   // 六轴X型，电机1~6从右前开始顺时针排列
+
+#define MIXER_TYPE          MIXER_QUAD_X
+
+#if MIXER_TYPE == MIXER_HEX_X
+#define MIXER_MOTOR_COUNT   6
+#else
+#define MIXER_MOTOR_COUNT   4
+#endif
+
+// 去饱和：三轴控制量的跨度超过输出范围时整体按比例缩小，保持各轴之间的比例
+// 空中模式开启时再平移油门使所有电机落在[0, 1]内，低油门及满油门时仍保留完整的姿态控制能力；
+// 关闭时油门优先，超出范围的电机直接限幅。空中模式下油门为0时打杆电机也会转动，只能在解锁后使用
+#define MIXER_AIRMODE       1
+
+// 推力线性化：电调及电机的推力约与油门指令u成二次关系，模型为(1 - k)u + ku²；混控得出的是各电机期望的相对推力，
+// 输出前按推力曲线求逆，低油门时放大、高油门时接近原值，使同一组PID参数在整个油门范围内响应一致。
+// 逆曲线在初始化时预先算成MIXER_THRUST_LUT_STEPS段的查找表，每个电机每周期只做一次线性插值；
+// 也可以用推力台实测的曲线代替模型(Mixer_SetThrustCurve)；k为0且未设置曲线时为恒等映射
+#define MIXER_THRUST_LINEAR     0.0f
+#define MIXER_THRUST_LUT_STEPS  32      // 查找表的段数，表长多1项
+// 电压补偿：电机转速约与电压乘油门成正比，电池电压下降时输出乘以参考电压与当前电压之比，保持同样的推力
+#define MIXER_VBAT_REF_CELL     4.0f    // 每节的参考电压(V)，高于该电压时系数小于1
+#define MIXER_VBAT_COMP_MAX     1.3f    // 补偿系数上限，电压测量异常时不会把输出放大过多
+
+// 混控表的一行：该电机对三轴控制量的系数
+typedef struct _MixerRule {
+    float roll;
+    float pitch;
+    float yaw;
+} MixerRule;
+
+void Mixer_Mix(float throttle, float roll, float pitch, float yaw, float *motor); // 油门0~1，三轴控制量以0为中点，motor输出MIXER_MOTOR_COUNT个0~1的值
+void Mixer_Init(void); // 按MIXER_THRUST_LINEAR生成推力查找表，在第一次调用Mixer_Output之前调用
+uint8_t Mixer_SetThrustCurve(const float *thrust, uint32_t count); // 以实测推力曲线(油门均匀分布的count个点)生成查找表，返回0成功
+float Mixer_VbatScale(float voltage, uint32_t cells); // 由电池电压(V)及节数得出电压补偿系数，电压未知(不大于0)时为1
+void Mixer_Output(float *motor, float vbatScale); // 把Mixer_Mix得出的相对推力换算为油门指令：查表线性化后乘以补偿系数，限幅到0~1
+
+#endif // __MIXER_H
@@ -1,29 +1,273 @@
 #include "Motor.h"
 #include "tim.h"
 #include "MySerial.h"
+#include "DShot.h"
+#include "LoopLatency.h"
+
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+static float motorPulse[MOTOR_COUNT] = {MOTOR_PULSE_MIN, MOTOR_PULSE_MIN, MOTOR_PULSE_MIN, MOTOR_PULSE_MIN}; // 各通道最近的占空比，单通道设置时其余通道沿用
+
+// 占空比换算为DShot油门值，最低油门及以下为停转
+static uint16_t Motor_PulseToDShot(float pulse)
+{
+    float t = (pulse - MOTOR_PULSE_MIN) * (1.0f / (MOTOR_PULSE_MAX - MOTOR_PULSE_MIN));
+
+    if (!(t > 0.0f)) {
+        return 0;
+    }
+    t = (t > 1.0f) ? 1.0f : t;
+    return (uint16_t)(DSHOT_THROTTLE_MIN + t * (DSHOT_THROTTLE_MAX - DSHOT_THROTTLE_MIN));
+}
+#endif
+
+/**
+ * @brief 打开四个通道的比较寄存器预装载
+ * 
+ * 预装载打开后写入的 CCR 值先进入影子寄存器，到下一个更新事件(计数器溢出)才生效，
+ * 正在输出的 PWM 周期不会被截断。HAL_TIM_PWM_ConfigChannel 已经打开，这里再确认一次，
+ * 避免重新生成的初始化代码改掉该配置。
+ */
+static void Motor_EnablePreload(void)
+{
+    htim3.Instance->CCMR1 |= TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE;
+    htim3.Instance->CCMR2 |= TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE;
+}
+
+#if TINYOS_ENABLE_POWER == 1
+/**
+ * @brief 开启PWM输出后禁止STOP模式
+ * 
+ * STOP期间TIM3停止计数，电调收不到信号会退出解锁状态；输出开启后一直保持，重复调用只登记一次。
+ */
+static void Motor_PowerHold(void)
+{
+    static uint8_t held = 0;
+
+    if (!held) {
+        held = 1;
+        tPowerConstraintSet(tPowerModeStop);
+    }
+}
+#else
+#define Motor_PowerHold()
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+#define MOTOR_PWM_HZ 50 // PWM频率，TIM3计数频率为ARR_VAL * MOTOR_PWM_HZ
+
+static tClockNotifier motorClockNotifier;
+
+//定时器时钟改变后重新计算TIM3的分频，预分频在下一个更新事件生效，只有当前这个周期的剩余部分按新时钟计数
+static void Motor_ClockChanged(uint32_t hclk, void *arg)
+{
+    (void)hclk;
+    (void)arg;
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    DShot_ClockChanged();
+#else
+    htim3.Instance->PSC = tClockTimerFreq() / (ARR_VAL * MOTOR_PWM_HZ) - 1;
+#endif
+}
+
+/**
+ * @brief 开启输出时登记调频通知，重复调用只登记一次
+ */
+static void Motor_ClockWatch(void)
+{
+    static uint8_t watched = 0;
+
+    if (!watched) {
+        watched = 1;
+        tClockNotifierAdd(&motorClockNotifier, Motor_ClockChanged, (void *)0);
+    }
+}
+#else
+#define Motor_ClockWatch()
+#endif
 
 /**
  * @brief 初始化电机 PWM 输出
  * 
  * 此函数开启四个通道的 PWM 输出，用于驱动舵机或电机。
  * 在调用此函数前，需确保定时器（TIM3）已通过 HAL 库初始化。
+ * DShot 时 TIM3 改为按位速率输出，发送停转帧后立即返回，不需要逐通道等待。
  */
 void Motor_Init(void) 
 {
+    Motor_EnablePreload();
+    Motor_PowerHold();
+    Motor_ClockWatch();
     // 开启 TIM3 的 4 个 PWM 通道
     HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
     HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
     HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3);
     HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_4);
-		Motor_SetPulse(1,0.05);
-		HAL_Delay(1000);
-		Motor_SetPulse(2,0.05);
-		HAL_Delay(1000);
-		Motor_SetPulse(3,0.05);
-		HAL_Delay(1000);
-		Motor_SetPulse(4,0.05);
-		HAL_Delay(1000);
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    DShot_Init(MOTOR_DSHOT_RATE);
+    Motor_Stop();
+#else
+    // 四个通道同时输出最低油门，电调并行识别，只需等待一次
+    Motor_Stop();
+    HAL_Delay(MOTOR_ARM_MS);
+#endif
+}
+
+/**
+ * @brief 所有电机输出最低油门
+ * 
+ * 只写比较寄存器，不阻塞，可在中断及内核钩子(如tSupervisorSetMissHook设置的钩子)中调用。
+ */
+void Motor_Stop(void)
+{
+    static const float idle[MOTOR_COUNT] = {0.05f, 0.05f, 0.05f, 0.05f};
+
+    Motor_SetAll(idle);
+}
+
+#if TINYOS_ENABLE_COROUTINE == 1
+//解锁序列：所有通道输出最低油门后等待MOTOR_ARM_MS，等待期间宿主任务可运行其它协程
+static uint32_t Motor_ArmEntry(tCoroutine * co)
+{
+    tCoBegin(co);
+    Motor_EnablePreload();
+    Motor_PowerHold();
+    Motor_ClockWatch();
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_4);
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    DShot_Init(MOTOR_DSHOT_RATE);
+    Motor_Stop();
+#else
+    Motor_Stop();
+    tCoDelay(co, tTimeMsToTicks(MOTOR_ARM_MS));
+#endif
+    tCoEnd(co);
+}
+
+/**
+ * @brief 非阻塞的电机初始化，与Motor_Init效果相同
+ * 
+ * @param co 协程控制块，解锁完成前需保持有效，可用tCoroutineIsRunning查询是否完成
+ */
+void Motor_ArmStart(tCoroutine * co)
+{
+    tCoroutineStart(co, Motor_ArmEntry, (void *)0);
+}
+#endif
+
+#if TINYOS_ENABLE_TIMER == 1
+static tTimer motorArmTimer;
+static uint32_t motorArmStart;
+static uint32_t motorArmTicks[MOTOR_COUNT] = {
+    tTimeMsToTicks(MOTOR_ARM_MS), tTimeMsToTicks(MOTOR_ARM_MS),
+    tTimeMsToTicks(MOTOR_ARM_MS), tTimeMsToTicks(MOTOR_ARM_MS),
+};
+static volatile MotorArmState motorArmState[MOTOR_COUNT];
+
+// 每个节拍检查一次各通道的等待时间，全部就绪后停止定时器；DShot时同时补发停转帧，电调需要连续收到帧
+// 使用硬定时器在节拍中断中执行：软定时器的回调持有定时器列表的信号量，不能在回调中停止自身
+static void Motor_ArmTimerFunc(void * arg)
+{
+    uint32_t elapsed = tTaskTickGet() - motorArmStart;
+    uint8_t waiting = 0;
+    int i;
+
+    (void)arg;
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    Motor_Stop();
+#endif
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        if (motorArmState[i] == MotorArmWaiting) {
+            if (elapsed >= motorArmTicks[i]) {
+                motorArmState[i] = MotorArmReady;
+            } else {
+                waiting = 1;
+            }
+        }
+    }
+    if (!waiting) {
+        tTimerStop(&motorArmTimer);
+    }
+}
+
+/**
+ * @brief 设置某个通道电调识别最低油门所需的等待时间
+ * 
+ * @param channel 通道号（1 ~ 4）
+ * @param ms 等待时间(ms)，默认MOTOR_ARM_MS
+ */
+void Motor_SetArmTime(int channel, uint32_t ms)
+{
+    if ((channel >= 1) && (channel <= MOTOR_COUNT)) {
+        motorArmTicks[channel - 1] = tTimeMsToTicks(ms);
+    }
+}
+
+/**
+ * @brief 启动非阻塞的电调解锁
+ * 
+ * 开启输出后所有通道同时输出最低油门，由内核定时器每个节拍推进状态机，
+ * 每个通道到达各自的等待时间后变为MotorArmReady，调用者不等待，可以继续初始化传感器。
+ * 需在内核启动后调用；重复调用会重新开始计时。
+ */
+void Motor_ArmAsync(void)
+{
+    int i;
+
+    Motor_EnablePreload();
+    Motor_PowerHold();
+    Motor_ClockWatch();
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_3);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_4);
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    DShot_Init(MOTOR_DSHOT_RATE);
+#endif
+    Motor_Stop();
+
+    tTimerStop(&motorArmTimer);
+    motorArmStart = tTaskTickGet();
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        motorArmState[i] = MotorArmWaiting;
+    }
+    tTimerInit(&motorArmTimer, 1, 1, Motor_ArmTimerFunc, (void *)0, TIMER_CONFIG_TYPE_HARD);
+    tTimerStart(&motorArmTimer);
+}
+
+/**
+ * @brief 查询某个通道的解锁状态
+ * 
+ * @param channel 通道号（1 ~ 4）
+ * @return 解锁状态，无效通道返回MotorArmIdle
+ */
+MotorArmState Motor_GetArmState(int channel)
+{
+    if ((channel < 1) || (channel > MOTOR_COUNT)) {
+        return MotorArmIdle;
+    }
+    return motorArmState[channel - 1];
+}
+
+/**
+ * @brief 所有电调是否都已解锁
+ * 
+ * @return 1全部就绪，0仍在等待或尚未开始
+ */
+uint8_t Motor_IsArmed(void)
+{
+    int i;
+
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        if (motorArmState[i] != MotorArmReady) {
+            return 0;
+        }
+    }
+    return 1;
 }
+#endif
 
 /**
  * @brief 设置指定通道的 PWM 占空比
@@ -35,9 +279,16 @@ void Motor_Init(void)
  *              - 其他值：高低电平按比例分配
  * 
  * 该函数会将占空比转换为定时器比较寄存器的值。
+ * DShot 时更新该通道后与其余通道一起重新发送一帧。
  */
 void Motor_SetPulse(int channel, float Pulse)
 {
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    if ((channel >= 1) && (channel <= MOTOR_COUNT)) {
+        motorPulse[channel - 1] = Pulse;
+        Motor_SetAll(motorPulse);
+    }
+#else
     // 确保占空比在有效范围内（0.0 ~ 1.0）
     if (Pulse < 0.0f) Pulse = 0.0f;
     if (Pulse > 1.0f) Pulse = 1.0f;
@@ -63,4 +314,53 @@ void Motor_SetPulse(int channel, float Pulse)
             // 无效通道号，忽略设置
             break;
     }
+#endif
+}
+
+/**
+ * @brief 一次设置全部通道的 PWM 占空比
+ * 
+ * @param pulse MOTOR_COUNT 个通道的占空比（0.0 ~ 1.0），pulse[0] 对应通道1
+ * 
+ * 先算出全部比较值，再连续写入 CCR1 ~ CCR4，不经过逐通道的 switch。
+ * 写入期间置位 UDIS 暂停更新事件，预装载的四个值只会在同一个更新事件一起生效：
+ * 写入恰好跨过计数器溢出时，该周期继续输出旧值，新值推迟到下一个周期，不会出现
+ * 部分通道已更新、部分仍为旧值的周期。与 Motor_Stop 一样可在中断中调用。
+ * DShot 时换算为油门值后四个通道同时发送一帧，上一帧仍在发送时本次丢弃。
+ */
+void Motor_SetAll(const float *pulse)
+{
+#if MOTOR_PROTOCOL == MOTOR_PROTOCOL_DSHOT
+    uint16_t value[MOTOR_COUNT];
+    int i;
+
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        motorPulse[i] = pulse[i];
+        value[i] = Motor_PulseToDShot(pulse[i]);
+    }
+    DShot_Write(value);
+#else
+    uint32_t duty[MOTOR_COUNT];
+    uint32_t status;
+    int i;
+
+    for (i = 0; i < MOTOR_COUNT; i++) {
+        float v = pulse[i];
+
+        v = (v > 1.0f) ? 1.0f : v;
+        v = (v < 0.0f) ? 0.0f : v;
+        duty[i] = (uint32_t)(ARR_VAL * v);
+    }
+
+    // 中断中的调用同样要置位清除UDIS，整个写入序列在临界区内完成，避免嵌套时提前清除
+    status = tTaskEnterCritical();
+    htim3.Instance->CR1 |= TIM_CR1_UDIS;
+    htim3.Instance->CCR1 = duty[0];
+    htim3.Instance->CCR2 = duty[1];
+    htim3.Instance->CCR3 = duty[2];
+    htim3.Instance->CCR4 = duty[3];
+    htim3.Instance->CR1 &= ~TIM_CR1_UDIS;
+    tTaskExitCritical(status);
+#endif
+    LoopLatency_MarkOutput();
 }
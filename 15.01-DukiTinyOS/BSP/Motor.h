@@ -2,7 +2,40 @@
 #define __MOTOR_H
 #include "main.h"
 #define ARR_VAL 10000 // 定义自动重装载值（ARR）
+#define MOTOR_COUNT 4 // TIM3的PWM通道数，即可驱动的电机数
+
+// 电调协议：PWM为50Hz、1~2ms脉宽；DShot时接口不变，Motor_SetPulse/Motor_SetAll的占空比按
+// MOTOR_PULSE_MIN~MOTOR_PULSE_MAX换算为DShot油门值，最低油门对应停转帧(0)，电调无需行程校准
+#define MOTOR_PROTOCOL_PWM 0
+#define MOTOR_PROTOCOL_DSHOT 1
+#define MOTOR_PROTOCOL MOTOR_PROTOCOL_PWM
+#define MOTOR_DSHOT_RATE DSHOT600 // DShot位速率，DSHOT150/DSHOT300/DSHOT600
+#define MOTOR_PULSE_MIN 0.05f // 最低油门的占空比(1ms)
+#define MOTOR_PULSE_MAX 0.10f // 最高油门的占空比(2ms)
+#define MOTOR_ARM_MS 1000 // 电调上电后需持续收到最低油门的时间(ms)，各通道同时输出，所有电调并行等待
 void Motor_Init(void);// 初始化电机 PWM 模块
 void Motor_SetPulse(int channel, float Pulse);// 设置 PWM 占空比
+void Motor_SetAll(const float *pulse);// 一次设置全部MOTOR_COUNT个通道的占空比，在同一个更新事件生效
+void Motor_Stop(void);// 所有通道输出最低油门，用于失效保护
+
+#include "tinyOS.h"
+#if TINYOS_ENABLE_COROUTINE == 1
+void Motor_ArmStart(tCoroutine * co);// 以协程方式解锁电调，不阻塞调用者
+#endif
+
+#if TINYOS_ENABLE_TIMER == 1
+// 软定时器驱动的解锁状态机：各通道同时输出最低油门，每个电调按自己的等待时间独立计时，
+// 期间可以继续初始化传感器及校准，用Motor_IsArmed查询是否全部就绪
+typedef enum _MotorArmState {
+    MotorArmIdle = 0,   // 尚未开始解锁
+    MotorArmWaiting,    // 正在输出最低油门，等待电调识别
+    MotorArmReady,      // 等待时间已到，可以输出油门
+} MotorArmState;
+
+void Motor_SetArmTime(int channel, uint32_t ms);// 设置某个通道电调所需的等待时间，需在Motor_ArmAsync前调用
+void Motor_ArmAsync(void);// 启动解锁，立即返回
+MotorArmState Motor_GetArmState(int channel);// 查询某个通道(1 ~ 4)的解锁状态
+uint8_t Motor_IsArmed(void);// 所有通道都已就绪时返回1
+#endif
 
 #endif
@@ -0,0 +1,529 @@
+#include "MyHwIIC.h"
+#include "i2c.h"
+#include "tinyOS.h"
+#include "tPort.h"
+
+HwI2CBus hwI2CBus2 = {&hi2c2};
+#if HWIIC_BUS3_ENABLE == 1
+static I2C_HandleTypeDef hwI2C3;
+static DMA_HandleTypeDef hwI2C3RxDma;
+HwI2CBus hwI2CBus3 = {&hwI2C3};
+#endif
+#if TINYOS_ENABLE_SEM == 1
+static tSem hwI2CWaitSem[HWIIC_WAITERS];    // 阻塞传输的等待者各占一个
+static uint32_t hwI2CWaitUsed;              // 已占用的等待信号量位图
+#endif
+
+//清空一条总线的队列及统计
+static void HwI2C_BusInit(HwI2CBus *bus)
+{
+    static const HwI2CStat empty = {0};
+
+    bus->queue = 0;
+    bus->active = 0;
+    bus->recovering = 0;
+    bus->stat = empty;
+    bus->statBaseUs = (uint32_t)tTimeGetMicros();
+}
+
+#if HWIIC_BUS3_ENABLE == 1
+//I2C3：PA8(SCL)、PC9(SDA)复用开漏，接收经DMA1 Stream1 Channel1，写寄存器只有1字节，用中断方式
+static void HwI2C_Bus3Config(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    __HAL_RCC_I2C3_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    gpio.Mode = GPIO_MODE_AF_OD;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF4_I2C3;
+    gpio.Pin = GPIO_PIN_8;
+    HAL_GPIO_Init(GPIOA, &gpio);
+    gpio.Pin = GPIO_PIN_9;
+    HAL_GPIO_Init(GPIOC, &gpio);
+
+    hwI2C3RxDma.Instance = DMA1_Stream1;
+    hwI2C3RxDma.Init.Channel = DMA_CHANNEL_1;
+    hwI2C3RxDma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hwI2C3RxDma.Init.PeriphInc = DMA_PINC_DISABLE;
+    hwI2C3RxDma.Init.MemInc = DMA_MINC_ENABLE;
+    hwI2C3RxDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hwI2C3RxDma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hwI2C3RxDma.Init.Mode = DMA_NORMAL;
+    hwI2C3RxDma.Init.Priority = DMA_PRIORITY_HIGH;
+    hwI2C3RxDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hwI2C3RxDma);
+    __HAL_LINKDMA(&hwI2C3, hdmarx, hwI2C3RxDma);
+
+    // 与I2C2相同：MX生成的HAL_I2C_MspInit只处理I2C2，这里先配好引脚、时钟及DMA，复位后再初始化时不需要重做
+    hwI2C3.Instance = I2C3;
+    hwI2C3.Init.ClockSpeed = 400000;
+    hwI2C3.Init.DutyCycle = I2C_DUTYCYCLE_2;
+    hwI2C3.Init.OwnAddress1 = 0;
+    hwI2C3.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+    hwI2C3.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+    hwI2C3.Init.OwnAddress2 = 0;
+    hwI2C3.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    hwI2C3.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+    HAL_I2C_Init(&hwI2C3);
+
+    // 回调中通知等待的任务，优先级不能高于TINYOS_MAX_SYSCALL_PRIO
+    HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+    HAL_NVIC_SetPriority(I2C3_EV_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);
+    HAL_NVIC_EnableIRQ(I2C3_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C3_ER_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);
+    HAL_NVIC_EnableIRQ(I2C3_ER_IRQn);
+}
+#endif
+
+/**
+ * @brief 初始化各总线的队列、统计及等待信号量，启用时配置I2C3
+ */
+void HwI2C_Init(void)
+{
+#if TINYOS_ENABLE_SEM == 1
+    uint32_t i;
+
+    for (i = 0; i < HWIIC_WAITERS; i++) {
+        tSemInit(&hwI2CWaitSem[i], 0, 1);
+    }
+    hwI2CWaitUsed = 0;
+#endif
+    HwI2C_BusInit(&hwI2CBus2);
+#if HWIIC_BUS3_ENABLE == 1
+    HwI2C_Bus3Config();
+    HwI2C_BusInit(&hwI2CBus3);
+#endif
+}
+
+/**
+ * @brief 填写传输描述符，完成回调置空
+ * @param xfer 描述符
+ * @param bus 所在总线，如&hwI2CBus2
+ * @param dir HWIIC_READ或HWIIC_WRITE
+ * @param devAddr 7位设备地址
+ * @param regAddr 起始寄存器地址
+ * @param buf 读取时存放数据，写入时为待写的数据，完成前不能释放
+ * @param len 字节数
+ * @param prio 优先级，HWIIC_PRIO_xxx，数值越小越先执行
+ */
+void HwI2C_XferInit(HwI2CXfer *xfer, HwI2CBus *bus, uint8_t dir, uint8_t devAddr, uint8_t regAddr,
+                    uint8_t *buf, uint16_t len, uint8_t prio)
+{
+    xfer->next = 0;
+    xfer->bus = bus;
+    xfer->devAddr = devAddr;
+    xfer->regAddr = regAddr;
+    xfer->dir = dir;
+    xfer->prio = prio;
+    xfer->buf = buf;
+    xfer->len = len;
+    xfer->status = HWIIC_OK;
+    xfer->done = 0;
+    xfer->param = 0;
+}
+
+//按优先级插入队列，同优先级先来先服务；须在临界区内调用
+static void HwI2C_Enqueue(HwI2CBus *bus, HwI2CXfer *xfer)
+{
+    HwI2CXfer **pos = &bus->queue;
+
+    while ((*pos != 0) && ((*pos)->prio <= xfer->prio)) {
+        pos = &(*pos)->next;
+    }
+    xfer->next = *pos;
+    *pos = xfer;
+    if (++bus->stat.queued > bus->stat.queuedMax) {
+        bus->stat.queuedMax = bus->stat.queued;
+    }
+}
+
+//总线空闲时取出队首作为进行中的传输；须在临界区内调用
+static HwI2CXfer *HwI2C_Dequeue(HwI2CBus *bus)
+{
+    HwI2CXfer *xfer = bus->queue;
+
+    if ((xfer == 0) || (bus->active != 0) || bus->recovering) {
+        return 0;
+    }
+    bus->queue = xfer->next;
+    bus->stat.queued--;
+    bus->active = xfer;
+    return xfer;
+}
+
+//进行中的传输结束，释放总线并计入统计
+static void HwI2C_Release(HwI2CBus *bus, uint8_t status)
+{
+    uint32_t s = tTaskEnterCritical();
+
+    bus->active = 0;
+    bus->stat.busyUs += (uint32_t)tTimeGetMicros() - bus->startUs;
+    bus->stat.transfers++;
+    if (status != HWIIC_OK) {
+        bus->stat.errors++;
+    }
+    tTaskExitCritical(s);
+}
+
+//写入结果并回调，回调中可以提交新的传输
+static void HwI2C_Notify(HwI2CXfer *xfer, uint8_t status)
+{
+    xfer->status = status;
+    if (xfer->done != 0) {
+        xfer->done(xfer->param, status);
+    }
+}
+
+//批量读经DMA，单字节读及写寄存器用中断方式
+static HAL_StatusTypeDef HwI2C_Start(HwI2CXfer *xfer)
+{
+    I2C_HandleTypeDef *hi2c = xfer->bus->hi2c;
+    uint16_t addr = (uint16_t)xfer->devAddr << 1;
+
+    if (xfer->dir == HWIIC_WRITE) {
+        return HAL_I2C_Mem_Write_IT(hi2c, addr, xfer->regAddr, I2C_MEMADD_SIZE_8BIT, xfer->buf, xfer->len);
+    }
+    if (xfer->len < 2) {
+        return HAL_I2C_Mem_Read_IT(hi2c, addr, xfer->regAddr, I2C_MEMADD_SIZE_8BIT, xfer->buf, xfer->len);
+    }
+    return HAL_I2C_Mem_Read_DMA(hi2c, addr, xfer->regAddr, I2C_MEMADD_SIZE_8BIT, xfer->buf, xfer->len);
+}
+
+//总线空闲时启动队首的传输，启动失败的以出错结束并继续下一笔，直到有一笔启动或队列为空
+static void HwI2C_Kick(HwI2CBus *bus)
+{
+    for (;;) {
+        uint32_t s = tTaskEnterCritical();
+        HwI2CXfer *xfer = HwI2C_Dequeue(bus);
+
+        tTaskExitCritical(s);
+        if (xfer == 0) {
+            return;
+        }
+        bus->startUs = (uint32_t)tTimeGetMicros();
+        if (HwI2C_Start(xfer) == HAL_OK) {
+            return;
+        }
+        HwI2C_Release(bus, HWIIC_ERROR);
+        HwI2C_Notify(xfer, HWIIC_ERROR);
+    }
+}
+
+/**
+ * @brief 进行中的传输完成，在I2C中断中调用；先启动下一笔再回调，总线不因回调空闲
+ * @param bus 所在总线
+ * @param status HWIIC_OK或HWIIC_ERROR
+ */
+static void HwI2C_Finish(HwI2CBus *bus, uint8_t status)
+{
+    HwI2CXfer *xfer = bus->active;
+
+    if ((xfer == 0) || bus->recovering) {
+        return;
+    }
+    HwI2C_Release(bus, status);
+    HwI2C_Kick(bus);
+    HwI2C_Notify(xfer, status);
+}
+
+/**
+ * @brief 提交传输后立即返回，完成后在I2C中断中调用xfer->done
+ * @param xfer 由HwI2C_XferInit填写的描述符，完成前不能修改或释放
+ * @retval HWIIC_OK: 已排队或已启动, HWIIC_BUSY: 描述符尚未完成
+ */
+uint8_t HwI2C_Submit(HwI2CXfer *xfer)
+{
+    uint32_t s = tTaskEnterCritical();
+
+    if (xfer->status == HWIIC_PENDING) {
+        tTaskExitCritical(s);
+        return HWIIC_BUSY;
+    }
+    xfer->status = HWIIC_PENDING;
+    HwI2C_Enqueue(xfer->bus, xfer);
+    tTaskExitCritical(s);
+
+    HwI2C_Kick(xfer->bus);
+    return HWIIC_OK;
+}
+
+/**
+ * @brief 取消阻塞传输：仍在排队的从队列移除，进行中的复位所在总线，随后继续执行队列中的传输
+ * @param xfer 描述符，取消后状态为HWIIC_ERROR；若已完成则保持原结果
+ */
+static void HwI2C_Cancel(HwI2CXfer *xfer)
+{
+    HwI2CBus *bus = xfer->bus;
+    HwI2CXfer **pos;
+    uint32_t s = tTaskEnterCritical();
+
+    for (pos = &bus->queue; *pos != 0; pos = &(*pos)->next) {
+        if (*pos == xfer) {
+            *pos = xfer->next;
+            bus->stat.queued--;
+            xfer->status = HWIIC_ERROR;
+            tTaskExitCritical(s);
+            return;
+        }
+    }
+    if (bus->active != xfer) {
+        tTaskExitCritical(s);
+        return;
+    }
+    bus->recovering = 1;
+    tTaskExitCritical(s);
+
+    HAL_I2C_DeInit(bus->hi2c);
+    HAL_I2C_Init(bus->hi2c);
+
+    HwI2C_Release(bus, HWIIC_ERROR);
+    bus->recovering = 0;
+    xfer->status = HWIIC_ERROR;
+    HwI2C_Kick(bus);
+}
+
+#if TINYOS_ENABLE_SEM == 1
+//占用一个等待信号量，都被占用时返回0
+static tSem *HwI2C_WaitSemAlloc(void)
+{
+    uint32_t i;
+    uint32_t s = tTaskEnterCritical();
+
+    for (i = 0; i < HWIIC_WAITERS; i++) {
+        if ((hwI2CWaitUsed & (1u << i)) == 0) {
+            hwI2CWaitUsed |= 1u << i;
+            tTaskExitCritical(s);
+            return &hwI2CWaitSem[i];
+        }
+    }
+    tTaskExitCritical(s);
+    return 0;
+}
+
+static void HwI2C_WaitSemFree(tSem *sem)
+{
+    uint32_t s = tTaskEnterCritical();
+
+    hwI2CWaitUsed &= ~(1u << (uint32_t)(sem - hwI2CWaitSem));
+    tTaskExitCritical(s);
+}
+#endif
+
+//阻塞传输的完成回调
+static void HwI2C_WaitDone(void *param, uint8_t status)
+{
+#if TINYOS_ENABLE_SEM == 1
+    if (param != 0) {
+        tSemNotifyFromISR((tSem *)param);
+    }
+#endif
+}
+
+/**
+ * @brief 提交传输并等待完成；任务中在信号量上等待，其它场合查询等待，不能在中断中调用
+ * @param xfer 由HwI2C_XferInit填写的描述符，done及param被覆盖
+ * @retval HWIIC_OK: 成功, HWIIC_BUSY: 描述符尚未完成, HWIIC_ERROR: 失败或超时
+ */
+uint8_t HwI2C_Transfer(HwI2CXfer *xfer)
+{
+    void *sem = 0;
+    uint32_t start;
+
+#if TINYOS_ENABLE_SEM == 1
+    if ((curTask != (tTask *)0) && (__get_IPSR() == 0)) {
+        sem = HwI2C_WaitSemAlloc();
+    }
+#endif
+    xfer->done = HwI2C_WaitDone;
+    xfer->param = sem;
+    if (HwI2C_Submit(xfer) != HWIIC_OK) {
+#if TINYOS_ENABLE_SEM == 1
+        if (sem != 0) {
+            HwI2C_WaitSemFree((tSem *)sem);
+        }
+#endif
+        return HWIIC_BUSY;
+    }
+
+#if TINYOS_ENABLE_SEM == 1
+    if (sem != 0) {
+        if (tSemWait((tSem *)sem, tTimeMsToTicks(HWIIC_TIMEOUT_MS) + 1) != tErrorNoError) {
+            HwI2C_Cancel(xfer);
+            // 取消的同时传输完成，通知已在信号量上，清掉后再归还
+            tSemNoWaitGet((tSem *)sem);
+            if (xfer->status != HWIIC_OK) {
+                xfer->bus->stat.timeouts++;
+            }
+        }
+        HwI2C_WaitSemFree((tSem *)sem);
+        return xfer->status;
+    }
+#endif
+
+    start = HAL_GetTick();
+    while (xfer->status == HWIIC_PENDING) {
+        if (HAL_GetTick() - start > HWIIC_TIMEOUT_MS) {
+            HwI2C_Cancel(xfer);
+            if (xfer->status != HWIIC_OK) {
+                xfer->bus->stat.timeouts++;
+            }
+            break;
+        }
+    }
+    return xfer->status;
+}
+
+/**
+ * @brief 读取连续的寄存器，以默认优先级排队，等待完成
+ * @param bus 所在总线
+ * @param devAddr 7位设备地址
+ * @param regAddr 起始寄存器地址
+ * @param buf 存储读取数据的缓冲区
+ * @param len 读取的字节数
+ * @retval HWIIC_OK: 成功, HWIIC_ERROR: 失败或超时
+ */
+uint8_t HwI2C_ReadRegs(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t *buf, uint16_t len)
+{
+    HwI2CXfer xfer;
+
+    HwI2C_XferInit(&xfer, bus, HWIIC_READ, devAddr, regAddr, buf, len, HWIIC_PRIO_DEFAULT);
+    return HwI2C_Transfer(&xfer);
+}
+
+/**
+ * @brief 读取一个寄存器，以默认优先级排队，等待完成
+ * @param bus 所在总线
+ * @param devAddr 7位设备地址
+ * @param regAddr 寄存器地址
+ * @param data 读取到的数据
+ * @retval HWIIC_OK: 成功, HWIIC_ERROR: 失败或超时
+ */
+uint8_t HwI2C_ReadReg(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t *data)
+{
+    return HwI2C_ReadRegs(bus, devAddr, regAddr, data, 1);
+}
+
+/**
+ * @brief 写入一个寄存器，以默认优先级排队，等待完成
+ * @param bus 所在总线
+ * @param devAddr 7位设备地址
+ * @param regAddr 寄存器地址
+ * @param data 写入的数据
+ * @retval HWIIC_OK: 成功, HWIIC_ERROR: 失败或超时
+ */
+uint8_t HwI2C_WriteReg(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t data)
+{
+    HwI2CXfer xfer;
+
+    HwI2C_XferInit(&xfer, bus, HWIIC_WRITE, devAddr, regAddr, &data, 1, HWIIC_PRIO_DEFAULT);
+    return HwI2C_Transfer(&xfer);
+}
+
+/**
+ * @brief 读取一条总线的统计
+ * @param bus 总线
+ * @param stat 统计，utilisation为总线忙时间的千分比
+ * @param reset 非0时清零累计的忙时间并重新开始计时
+ */
+void HwI2C_GetStat(HwI2CBus *bus, HwI2CStat *stat, uint8_t reset)
+{
+    uint32_t now = (uint32_t)tTimeGetMicros();
+    uint32_t s = tTaskEnterCritical();
+
+    *stat = bus->stat;
+    stat->elapsedUs = now - bus->statBaseUs;
+    stat->utilisation = (stat->elapsedUs != 0) ? (uint32_t)((uint64_t)stat->busyUs * 1000 / stat->elapsedUs) : 0;
+    if (reset) {
+        bus->stat.busyUs = 0;
+        bus->statBaseUs = now;
+    }
+    tTaskExitCritical(s);
+}
+
+//HAL的回调按句柄找到所在总线，不是本模块管理的总线返回0
+static HwI2CBus *HwI2C_FindBus(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == hwI2CBus2.hi2c) {
+        return &hwI2CBus2;
+    }
+#if HWIIC_BUS3_ENABLE == 1
+    if (hi2c == hwI2CBus3.hi2c) {
+        return &hwI2CBus3;
+    }
+#endif
+    return 0;
+}
+
+//HAL的I2C回调，DMA读完成后由I2C事件中断结束传输时调用
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    HwI2CBus *bus = HwI2C_FindBus(hi2c);
+
+    if (bus != 0) {
+        HwI2C_Finish(bus, HWIIC_OK);
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    HwI2CBus *bus = HwI2C_FindBus(hi2c);
+
+    if (bus != 0) {
+        HwI2C_Finish(bus, HWIIC_OK);
+    }
+}
+
+//无应答、仲裁丢失、总线错误或DMA错误
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    HwI2CBus *bus = HwI2C_FindBus(hi2c);
+
+    if (bus != 0) {
+        HwI2C_Finish(bus, HWIIC_ERROR);
+    }
+}
+
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    HwI2CBus *bus = HwI2C_FindBus(hi2c);
+
+    if (bus != 0) {
+        HwI2C_Finish(bus, HWIIC_ERROR);
+    }
+}
+
+#if HWIIC_BUS3_ENABLE == 1
+// I2C3的中断在这里处理，与stm32f4xx_it.c中I2C2的处理相同
+void DMA1_Stream1_IRQHandler(void)
+{
+    tIrqStatEnter();
+    tIntEnter();
+    HAL_DMA_IRQHandler(&hwI2C3RxDma);
+    tIntExit();
+    tIrqStatExit();
+}
+
+void I2C3_EV_IRQHandler(void)
+{
+    tIrqStatEnter();
+    tIntEnter();
+    HAL_I2C_EV_IRQHandler(&hwI2C3);
+    tIntExit();
+    tIrqStatExit();
+}
+
+void I2C3_ER_IRQHandler(void)
+{
+    tIrqStatEnter();
+    tIntEnter();
+    HAL_I2C_ER_IRQHandler(&hwI2C3);
+    tIntExit();
+    tIrqStatExit();
+}
+#endif
@@ -0,0 +1,84 @@
+#ifndef __MYHWIIC_H
+#define __MYHWIIC_H
+#include "main.h"
+
+// 硬件I2C总线管理：每条总线一个HwI2CBus，各有自己的传输队列，各传感器驱动提交传输描述符，按优先级排队，
+// 上一笔完成时在I2C中断中立即启动下一笔，不经任务切换；批量读经DMA，单字节读及写寄存器用中断方式
+// 正在进行的传输不会被打断，高优先级的传输排到队首；不同总线上的传输同时进行
+// hwI2CBus2：I2C2(PB10:SCL, PB3:SDA, 400kHz)，由CubeMX生成的MX_I2C2_Init初始化
+// hwI2CBus3：I2C3(PA8:SCL, PC9:SDA, 400kHz)，接收经DMA1 Stream1，由HwI2C_Init配置，用于第二个IMU等
+#define HWIIC_TIMEOUT_MS        5   // 阻塞传输从提交到完成的最长时间(ms)，超时后从队列取消，进行中的复位该总线
+#define HWIIC_WAITERS           4   // 可同时阻塞等待传输完成的任务数(各总线共用)，超出时查询等待
+#define HWIIC_BUS3_ENABLE       0   // 1：启用I2C3
+
+// 传输优先级，数值越小越先执行
+#define HWIIC_PRIO_IMU          0
+#define HWIIC_PRIO_DEFAULT      4
+#define HWIIC_PRIO_LOW          8
+
+// 返回值
+#define HWIIC_OK                0
+#define HWIIC_ERROR             1   // 无应答、总线错误或超时
+#define HWIIC_BUSY              2   // 描述符已在队列中
+#define HWIIC_PENDING           3   // 描述符状态：排队或进行中
+
+// 传输方向
+#define HWIIC_READ              0
+#define HWIIC_WRITE             1
+
+// 总线统计
+typedef struct _HwI2CStat {
+    uint32_t transfers;         // 完成的传输数
+    uint32_t errors;            // 出错的传输数
+    uint32_t timeouts;          // 阻塞传输超时次数
+    uint32_t queued;            // 当前排队的传输数，不含进行中的
+    uint32_t queuedMax;         // 排队数的最大值
+    uint32_t busyUs;            // 总线忙的累计时间(us)
+    uint32_t elapsedUs;         // 自初始化或上次清零以来的时间(us)
+    uint32_t utilisation;       // busyUs占elapsedUs的千分比
+} HwI2CStat;
+
+struct _HwI2CXfer;
+
+// 一条总线的队列及状态
+typedef struct _HwI2CBus {
+    I2C_HandleTypeDef *hi2c;
+    struct _HwI2CXfer *queue;               // 待执行的传输，按优先级排序
+    struct _HwI2CXfer *volatile active;     // 进行中的传输
+    volatile uint8_t recovering;            // 超时复位期间不启动新传输，迟到的回调被忽略
+    uint32_t startUs;                       // 进行中的传输的启动时间
+    uint32_t statBaseUs;                    // 统计时间的起点
+    HwI2CStat stat;
+} HwI2CBus;
+
+extern HwI2CBus hwI2CBus2;
+#if HWIIC_BUS3_ENABLE == 1
+extern HwI2CBus hwI2CBus3;
+#endif
+
+// 传输描述符，由提交者提供，完成前不能修改或释放
+typedef struct _HwI2CXfer {
+    struct _HwI2CXfer *next;
+    HwI2CBus *bus;              // 所在总线
+    uint8_t devAddr;            // 7位设备地址
+    uint8_t regAddr;            // 起始寄存器地址
+    uint8_t dir;                // HWIIC_READ或HWIIC_WRITE
+    uint8_t prio;               // 优先级
+    uint8_t *buf;
+    uint16_t len;
+    volatile uint8_t status;    // HWIIC_PENDING、HWIIC_OK或HWIIC_ERROR
+    void (*done)(void *param, uint8_t status); // 完成回调，在I2C中断中调用，可为0
+    void *param;
+} HwI2CXfer;
+
+// 硬件I2C操作函数声明，调用前需先调用MX_I2C2_Init
+void HwI2C_Init(void);                     // 初始化各总线的队列及等待信号量，启用时配置I2C3
+void HwI2C_XferInit(HwI2CXfer *xfer, HwI2CBus *bus, uint8_t dir, uint8_t devAddr, uint8_t regAddr,
+                    uint8_t *buf, uint16_t len, uint8_t prio);//填写描述符，回调置空
+uint8_t HwI2C_Submit(HwI2CXfer *xfer);     // 提交传输，立即返回
+uint8_t HwI2C_Transfer(HwI2CXfer *xfer);   // 提交传输并等待完成
+uint8_t HwI2C_ReadRegs(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t *buf, uint16_t len);//读取连续的寄存器，等待完成
+uint8_t HwI2C_ReadReg(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t *data);//读取一个字节，等待完成
+uint8_t HwI2C_WriteReg(HwI2CBus *bus, uint8_t devAddr, uint8_t regAddr, uint8_t data);//写入一个字节，等待完成
+void HwI2C_GetStat(HwI2CBus *bus, HwI2CStat *stat, uint8_t reset); // 读取总线统计，reset非0时清零累计时间
+#endif
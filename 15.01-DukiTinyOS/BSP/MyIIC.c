@@ -1,14 +1,31 @@
 #include "MyIIC.h"
 #include "stm32f4xx_hal.h"
+#include "tinyOS.h"
+
+static uint32_t i2cUnitCycles;  // 一个时序单位的CPU周期数
+static uint32_t i2cEdge;        // 上一个时序点的CYCCNT
 
 /**
  * @brief 延时函数，用于模拟I2C时序
- * @param time 延时的时间（单位：微秒）
+ * 
+ * 从上一个时序点起等待，而不是从调用时起，GPIO操作的耗时计入本段时间，总线频率不受其影响；
+ * 被中断耽误而已超时的，从现在重新计时，后面各段仍保持完整的长度
+ * 
+ * @param units 等待的时序单位数
  */
-static void I2C_Delay(uint16_t time)
+static void I2C_Delay(uint32_t units)
 {
-    for (uint32_t i = 0; i < time * 10; ++i)
-        __NOP();
+    uint32_t now = tCycleCounterGet();
+
+    i2cEdge += units * i2cUnitCycles;
+    if ((int32_t)(i2cEdge - now) < 0)
+    {
+        i2cEdge = now;
+        return;
+    }
+    while ((int32_t)(tCycleCounterGet() - i2cEdge) < 0)
+    {
+    }
 }
 
 /**
@@ -19,6 +36,9 @@ void I2C_Init(void)
 {
     GPIO_InitTypeDef GPIO_InitStruct = {0};
 
+    tCycleCounterInit();
+    i2cUnitCycles = SystemCoreClock / (I2C_SPEED_HZ * I2C_UNITS_PER_BIT);
+
     // 初始化SCL和SDA引脚为开漏输出模式
     GPIO_InitStruct.Pin = I2C_SCL_PIN | I2C_SDA_PIN;
     GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD; // 开漏输出
@@ -69,13 +89,15 @@ static uint8_t I2C_ReadSDA(void)
 void I2C_Start(void)
 {
 		//要做到通信开始和结束后，SCL和SDA都拉高，中间则二者都低
+    i2cEdge = tCycleCounterGet();
     I2C_SetSDA(1);
+    I2C_Delay(I2C_SETUP_UNITS); // 重复起始时SCL仍为低
     I2C_SetSCL(1);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);  // 起始条件建立时间
     I2C_SetSDA(0);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);  // 起始条件保持时间
     I2C_SetSCL(0);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HOLD_UNITS);
 }
 
 /**
@@ -84,10 +106,11 @@ void I2C_Start(void)
 void I2C_Stop(void)
 {
     I2C_SetSDA(0);
+    I2C_Delay(I2C_SETUP_UNITS);
     I2C_SetSCL(1);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);  // 停止条件建立时间
     I2C_SetSDA(1);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HOLD_UNITS + I2C_SETUP_UNITS); // 总线空闲时间，不短于SCL低电平
 }
 
 /**
@@ -99,8 +122,9 @@ uint8_t I2C_WaitAck(void)
     uint16_t timeout = 100;
 
     I2C_SetSDA(1); // 释放SDA
+    I2C_Delay(I2C_SETUP_UNITS);
     I2C_SetSCL(1); // 拉高SCL
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);
 
     while (I2C_ReadSDA())
     {
@@ -112,7 +136,7 @@ uint8_t I2C_WaitAck(void)
     }
 
     I2C_SetSCL(0);
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HOLD_UNITS);
     return 0; // 收到应答
 }
 
@@ -122,11 +146,11 @@ uint8_t I2C_WaitAck(void)
 void I2C_SendAck(void)
 {
     I2C_SetSDA(0);//主机发送0，表示应答
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_SETUP_UNITS);
     I2C_SetSCL(1);//从机此时读取应答
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);
     I2C_SetSCL(0);//读取完毕
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HOLD_UNITS);
 }
 
 /**
@@ -135,11 +159,11 @@ void I2C_SendAck(void)
 void I2C_SendNotAck(void)
 {
     I2C_SetSDA(1);//主机发送1，表示非应答
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_SETUP_UNITS);
     I2C_SetSCL(1);//从机此时读取应答
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HIGH_UNITS);
     I2C_SetSCL(0);//读取完毕
-    I2C_Delay(I2C_DELAY_TIME);
+    I2C_Delay(I2C_HOLD_UNITS);
 }
 
 /**
@@ -148,17 +172,17 @@ void I2C_SendNotAck(void)
  */
 void I2C_SendByte(uint8_t byte)
 {
+    // 进入时SCL为低且已保持了I2C_HOLD_UNITS
     for (uint8_t i = 0; i < 8; ++i)
     {
-        I2C_SetSCL(0);
-        I2C_Delay(I2C_DELAY_TIME);
         I2C_SetSDA(byte & 0x80);
         byte <<= 1;
-        I2C_Delay(I2C_DELAY_TIME);
+        I2C_Delay(I2C_SETUP_UNITS);
         I2C_SetSCL(1);
-        I2C_Delay(I2C_DELAY_TIME);
+        I2C_Delay(I2C_HIGH_UNITS);
+        I2C_SetSCL(0);
+        I2C_Delay(I2C_HOLD_UNITS);
     }
-    I2C_SetSCL(0);
 }
 
 /**
@@ -173,14 +197,14 @@ uint8_t I2C_ReceiveByte(void)
     for (uint8_t i = 0; i < 8; ++i)
     {
         byte <<= 1;
-        I2C_SetSCL(0);
-        I2C_Delay(I2C_DELAY_TIME);
+        I2C_Delay(I2C_SETUP_UNITS);
         I2C_SetSCL(1);
-        I2C_Delay(I2C_DELAY_TIME);
+        I2C_Delay(I2C_HIGH_UNITS);
         if (I2C_ReadSDA())
             byte |= 0x01;
+        I2C_SetSCL(0);
+        I2C_Delay(I2C_HOLD_UNITS);
     }
-    I2C_SetSCL(0);
     return byte;
 }
 
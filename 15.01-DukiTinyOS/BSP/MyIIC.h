@@ -6,7 +6,14 @@
 #define I2C_SCL_PIN        GPIO_PIN_4      // SCL: PC4
 #define I2C_SDA_PIN        GPIO_PIN_5      // SDA: PC5
 #define I2C_GPIO_PORT      GPIOC           // I2C引脚所在的端口
-#define I2C_DELAY_TIME     5               // 软件I2C延时（单位：微秒）
+
+// 软件I2C时序：每个SCL周期分为I2C_UNITS_PER_BIT个时序单位，由DWT周期计数器按SystemCoreClock计时；
+// 低电平 = 下降沿后保持 + 数据建立，400kHz时单位为500ns，低电平1.5us(规范不小于1.3us)、高电平1.0us(不小于0.6us)
+#define I2C_SPEED_HZ       400000          // SCL频率(Hz)，快速模式
+#define I2C_HOLD_UNITS     1               // SCL下降沿后数据保持
+#define I2C_SETUP_UNITS    2               // 数据建立，至SCL上升沿
+#define I2C_HIGH_UNITS     2               // SCL高电平
+#define I2C_UNITS_PER_BIT  (I2C_HOLD_UNITS + I2C_SETUP_UNITS + I2C_HIGH_UNITS)
 
 // I2C操作函数声明
 void I2C_Init(void);                       // 初始化I2C GPIO
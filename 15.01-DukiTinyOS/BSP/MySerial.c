@@ -1,47 +1,775 @@
 #include "MySerial.h"
 #include "usart.h"
+#include "tinyOS.h"
+#include "tPort.h"
+#include <string.h>
 
+#if (MYSERIAL_STDIO_RTT == 1) && (TINYOS_ENABLE_RTT == 0)
+#error "MYSERIAL_STDIO_RTT requires TINYOS_ENABLE_RTT"
+#endif
+
+#if MYSERIAL_RX_USE_DMA == 1
+#if MYSERIAL_RX_FRAME_MAX > 255
+#error "MYSERIAL_RX_FRAME_MAX must not exceed 255"
+#endif
+// DMA循环写入接收缓冲区，半满、全满及线路空闲时从上次取到的位置取出新数据拼入当前帧，
+// 空闲时当前帧结束，整帧交给任务处理；三个中断同优先级，互不嵌套
+static uint8_t serialRxDma[MYSERIAL_RX_DMA_SIZE];
+static uint32_t serialRxDmaPos;         // 已取出的位置
+static uint8_t serialRxFrame[1 + MYSERIAL_RX_FRAME_MAX]; // [0]为帧长，拼帧时留空，交出时填写
+static uint32_t serialRxFrameLen;
+static uint32_t serialRxDropped;
+static MySerialRxParser serialRxParser;
+#if TINYOS_ENABLE_STREAM == 1
+// 待处理的帧依次写入字节流，每帧为1字节帧长加数据，只在剩余空间放得下整帧时写入
+static uint8_t serialRxStreamBuffer[MYSERIAL_RX_STREAM_SIZE];
+static tStream serialRxStream;
+#else
+// 未开启字节流时只保存一帧，处理完之前到达的帧丢弃
+static uint8_t serialRxPending[MYSERIAL_RX_FRAME_MAX];
+static volatile uint32_t serialRxPendingLen;
+#endif
+#else
 // 定义一个数组用于存储接收到的数据
 char data[30] = {0};
 // 单字节数据存储
 uint8_t dat;
 // 数据指针，指向当前写入位置
 uint pointer;
+#endif
+
+#if MYSERIAL_TX_USE_DMA == 1
+// 发送环形缓冲区：写入者在临界区内拷入数据，DMA每次发送从tail开始的一段连续数据，
+// 发送完成回调中释放该段并接续下一段，直到缓冲区为空
+static uint8_t serialTxBuffer[MYSERIAL_TX_BUFFER_SIZE];
+static uint32_t serialTxHead;           // 下一个写入位置
+static uint32_t serialTxTail;           // 最早的未发送字节
+static uint32_t serialTxCount;          // 缓冲区中的字节数，含DMA正在发送的部分
+static uint32_t serialTxDmaLen;         // DMA正在发送的字节数，0表示DMA空闲
+static uint8_t serialTxDmaDirect;       // DMA正在发送的是直接发送队列的队首缓冲区，而不是环形缓冲区
+// 直接发送队列：调用者提供的缓冲区不经复制由DMA发送，发完后在中断中回调归还；
+// 环形缓冲区中有数据时先发环形缓冲区，两者之间不保持写入顺序
+typedef struct _MySerialTxDirect {
+    const uint8_t *buf;
+    uint32_t len;
+    void (*done)(void *param, const uint8_t *buf);
+    void *param;
+} MySerialTxDirect;
+static MySerialTxDirect serialTxDirect[MYSERIAL_TX_DIRECT_QUEUE];
+static uint32_t serialTxDirectHead;
+static uint32_t serialTxDirectCount;
+static uint32_t serialTxDirectBytes;    // 直接发送队列中的总字节数，含DMA正在发送的缓冲区
+static uint32_t serialTxSentBytes;      // 已发送的字节数，只增不减，供估计实际吞吐量
+static uint32_t serialTxDropped;
+static uint8_t serialTxReady;
+#if (TINYOS_ENABLE_POWER == 1) || (TINYOS_ENABLE_CLOCK_SCALE == 1)
+static uint8_t serialTxPowerHeld;       // DMA发送期间禁止STOP及调频，USART及DMA时钟停止或波特率改变会中断发送
+#endif
+#if (MYSERIAL_TX_POLICY == MYSERIAL_TX_BLOCK) && (TINYOS_ENABLE_SEM == 1)
+static tSem serialTxSpaceSem;           // DMA发完一段、腾出空间时通知等待的写入者
+#endif
+#elif TINYOS_ENABLE_STREAM == 1
+// 发送字节流，任务写入后由USART1的TXE中断逐字节取出发送
+static uint8_t serialTxBuffer[MYSERIAL_TX_BUFFER_SIZE];
+static tStream serialTxStream;
+static uint8_t serialTxReady;
+#endif
+
+#if MYSERIAL_RX_USE_DMA == 1
+//启动循环接收并打开线路空闲中断，初始化及出错后调用，未交出的半帧丢弃
+static void MySerial_RxStart(void)
+{
+    serialRxDropped += serialRxFrameLen;
+    serialRxFrameLen = 0;
+    serialRxDmaPos = 0;
+    HAL_UART_Receive_DMA(&huart1, serialRxDma, MYSERIAL_RX_DMA_SIZE);
+    __HAL_UART_CLEAR_IDLEFLAG(&huart1);
+    __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
+}
+
+//新到的数据开启命令行时逐字节交给命令行，否则拼入当前帧
+static void MySerial_RxPut(const uint8_t *buf, uint32_t len)
+{
+#if TINYOS_ENABLE_SHELL == 1
+    while (len--) {
+        tShellInputFromISR(*buf++);
+    }
+#else
+    uint32_t n = MYSERIAL_RX_FRAME_MAX - serialRxFrameLen;
+
+    if (n > len) {
+        n = len;
+    }
+    memcpy(&serialRxFrame[1 + serialRxFrameLen], buf, n);
+    serialRxFrameLen += n;
+    serialRxDropped += len - n;
+#endif
+}
+
+//设置了旁路解析时逐字节交给解析函数，属于二进制帧的字节从中剔除，其余的连续段照常交出
+static void MySerial_RxFilter(uint32_t start, uint32_t len)
+{
+    MySerialRxParser parser = serialRxParser;
+    uint32_t i, run = start;
+
+    if (parser == 0) {
+        MySerial_RxPut(&serialRxDma[start], len);
+        return;
+    }
+    for (i = start; i < start + len; i++) {
+        if (parser(serialRxDma, MYSERIAL_RX_DMA_SIZE, i)) {
+            MySerial_RxPut(&serialRxDma[run], i - run);
+            run = i + 1;
+        }
+    }
+    MySerial_RxPut(&serialRxDma[run], start + len - run);
+}
+
+//取出DMA自上次以来写入的数据，写到缓冲区末尾绕回时分两段
+static void MySerial_RxDrain(void)
+{
+    uint32_t pos = MYSERIAL_RX_DMA_SIZE - __HAL_DMA_GET_COUNTER(huart1.hdmarx);
+
+    if (pos == MYSERIAL_RX_DMA_SIZE) {
+        pos = 0;
+    }
+    if (pos < serialRxDmaPos) {
+        MySerial_RxFilter(serialRxDmaPos, MYSERIAL_RX_DMA_SIZE - serialRxDmaPos);
+        serialRxDmaPos = 0;
+    }
+    MySerial_RxFilter(serialRxDmaPos, pos - serialRxDmaPos);
+    serialRxDmaPos = pos;
+}
+
+//线路空闲，当前帧结束，交给任务处理
+static void MySerial_RxFrameEnd(void)
+{
+    uint32_t len = serialRxFrameLen;
+#if TINYOS_ENABLE_STREAM == 1
+    tStreamInfo info;
+#endif
+
+    if (len == 0) {
+        return;
+    }
+    serialRxFrameLen = 0;
+
+#if TINYOS_ENABLE_STREAM == 1
+    tStreamGetInfo(&serialRxStream, &info);
+    if (info.size - info.count >= 1 + len) {
+        serialRxFrame[0] = (uint8_t)len;
+        tStreamWriteFromISR(&serialRxStream, serialRxFrame, 1 + len);
+        return;
+    }
+#else
+    if (serialRxPendingLen == 0) {
+        memcpy(serialRxPending, &serialRxFrame[1], len);
+        serialRxPendingLen = len;
+        return;
+    }
+#endif
+    serialRxDropped += len;
+}
+#endif
+
+//标准输出写入RTT控制台通道或串口发送缓冲区
+static void MySerial_StdioWrite(const uint8_t *buf, uint32_t len)
+{
+#if MYSERIAL_STDIO_RTT == 1
+    tRttWrite(TINYOS_RTT_CH_CONSOLE, buf, len);
+#else
+    MySerial_Write(buf, len);
+#endif
+}
+
+#if MYSERIAL_STDIO_LINE_BUFFER == 1
+// 标准输出的行缓冲：多个任务同时printf时按整行交错，而不是逐字符交错，每行只进入一次发送缓冲区的临界区；
+// 行缓冲只在任务有未换行的输出时占用，整行发出后归还
+typedef struct _MySerialLine {
+    tTask * owner;
+    uint32_t len;
+    uint8_t buf[MYSERIAL_STDIO_LINE_SIZE];
+} MySerialLine;
+
+static MySerialLine serialLines[MYSERIAL_STDIO_LINE_SLOTS];
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+static tClockNotifier serialClockNotifier;
+
+//HCLK改变后按新的PCLK2重新计算波特率分频，DMA发送期间不会调频，正在接收的一个字节可能出错
+static void MySerial_ClockChanged(uint32_t hclk, void *arg)
+{
+    (void)hclk;
+    (void)arg;
+    huart1.Instance->BRR = (huart1.Init.OverSampling == UART_OVERSAMPLING_8)
+                         ? UART_BRR_SAMPLING8(HAL_RCC_GetPCLK2Freq(), huart1.Init.BaudRate)
+                         : UART_BRR_SAMPLING16(HAL_RCC_GetPCLK2Freq(), huart1.Init.BaudRate);
+}
+#endif
 
 /**
  * @brief 串口初始化函数
  * 
- * 初始化串口接收中断，使能接收数据。
+ * 启动串口接收：DMA循环接收并打开线路空闲中断，或逐字节接收中断。
  * 
  * @param 无
  * @return 无
  */
 void MySerial_Init(void)
 {
+#if MYSERIAL_RX_USE_DMA == 1
+    serialRxDropped = 0;
+#if TINYOS_ENABLE_STREAM == 1
+    tStreamInit(&serialRxStream, serialRxStreamBuffer, MYSERIAL_RX_STREAM_SIZE, 1);
+#else
+    serialRxPendingLen = 0;
+#endif
+    MySerial_RxStart();
+#else
     // 初始化UART1的接收中断，每次接收一个字节数据
     HAL_UART_Receive_IT(&huart1, &dat, 1);
+#endif
+
+#if MYSERIAL_TX_USE_DMA == 1
+    serialTxHead = 0;
+    serialTxTail = 0;
+    serialTxCount = 0;
+    serialTxDmaLen = 0;
+    serialTxDmaDirect = 0;
+    serialTxDirectHead = 0;
+    serialTxDirectCount = 0;
+    serialTxDirectBytes = 0;
+    serialTxSentBytes = 0;
+    serialTxDropped = 0;
+#if (MYSERIAL_TX_POLICY == MYSERIAL_TX_BLOCK) && (TINYOS_ENABLE_SEM == 1)
+    tSemInit(&serialTxSpaceSem, 0, 1);
+#endif
+    serialTxReady = 1;
+#elif TINYOS_ENABLE_STREAM == 1
+    // 发送由中断取数据，触发字节数与读者无关，取1即可
+    tStreamInit(&serialTxStream, serialTxBuffer, MYSERIAL_TX_BUFFER_SIZE, 1);
+    serialTxReady = 1;
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+    tClockNotifierAdd(&serialClockNotifier, MySerial_ClockChanged, (void *)0);
+#endif
+}
+
+#if MYSERIAL_TX_USE_DMA == 1
+#if (TINYOS_ENABLE_POWER == 1) || (TINYOS_ENABLE_CLOCK_SCALE == 1)
+//DMA开始或停止发送时登记或解除低功耗约束及调频暂停，需在临界区内调用
+static void MySerial_TxPowerUpdate(void)
+{
+    if ((serialTxDmaLen != 0) && !serialTxPowerHeld) {
+        serialTxPowerHeld = 1;
+#if TINYOS_ENABLE_POWER == 1
+        tPowerConstraintSet(tPowerModeStop);
+#else
+        tClockHoldSet();
+#endif
+    } else if ((serialTxDmaLen == 0) && serialTxPowerHeld) {
+        serialTxPowerHeld = 0;
+#if TINYOS_ENABLE_POWER == 1
+        tPowerConstraintClear(tPowerModeStop);
+#else
+        tClockHoldClear();
+#endif
+    }
+}
+#else
+#define MySerial_TxPowerUpdate()
+#endif
+
+//DMA空闲且缓冲区非空时启动下一段发送，到缓冲区末尾为止，绕回的部分在下一次完成回调中发送，需在临界区内调用
+//环形缓冲区为空时发送直接发送队列的队首缓冲区
+static void MySerial_TxDmaKick(void)
+{
+    uint32_t len;
+
+    if (serialTxDmaLen != 0) {
+        return;
+    }
+    if (serialTxCount == 0) {
+        if (serialTxDirectCount != 0) {
+            MySerialTxDirect *direct = &serialTxDirect[serialTxDirectHead];
+            serialTxDmaLen = direct->len;
+            serialTxDmaDirect = 1;
+            HAL_UART_Transmit_DMA(&huart1, (uint8_t *)direct->buf, (uint16_t)direct->len);
+        }
+        MySerial_TxPowerUpdate();
+        return;
+    }
+    serialTxDmaDirect = 0;
+    len = MYSERIAL_TX_BUFFER_SIZE - serialTxTail;
+    if (len > serialTxCount) {
+        len = serialTxCount;
+    }
+    serialTxDmaLen = len;
+    HAL_UART_Transmit_DMA(&huart1, &serialTxBuffer[serialTxTail], (uint16_t)len);
+    MySerial_TxPowerUpdate();
+}
+
+//拷入数据并在DMA空闲时启动发送，返回拷入的字节数
+//不超过缓冲区大小的数据整块拷入，空间不足时返回0，使一次写入的一行不与其它任务的输出交错；更长的数据拷入尽可能多的部分
+static uint32_t MySerial_TxDmaPut(const uint8_t *buf, uint32_t len)
+{
+    uint32_t n, first;
+    uint32_t status = tTaskEnterCritical();
+
+    n = MYSERIAL_TX_BUFFER_SIZE - serialTxCount;
+    if (n > len) {
+        n = len;
+    } else if (len <= MYSERIAL_TX_BUFFER_SIZE) {
+        n = 0;
+    }
+    first = MYSERIAL_TX_BUFFER_SIZE - serialTxHead;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(&serialTxBuffer[serialTxHead], buf, first);
+    memcpy(serialTxBuffer, buf + first, n - first);
+    serialTxHead = (serialTxHead + n) % MYSERIAL_TX_BUFFER_SIZE;
+    serialTxCount += n;
+    MySerial_TxDmaKick();
+
+    tTaskExitCritical(status);
+    return n;
+}
+
+/**
+ * @brief DMA发送完成回调
+ * 
+ * 最后一个字节移出后由HAL在USART1中断中调用，释放刚发完的一段或回调归还直接发送的缓冲区，
+ * 还有数据时接续下一段，并通知等待空间的写入者。
+ * 
+ * @param huart 串口句柄指针
+ * @return 无
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    MySerialTxDirect done = {0};
+    uint32_t status;
+
+    if (huart != &huart1) {
+        return;
+    }
+
+    status = tTaskEnterCritical();
+    if (serialTxDmaDirect) {
+        done = serialTxDirect[serialTxDirectHead];
+        serialTxDirectHead = (serialTxDirectHead + 1) % MYSERIAL_TX_DIRECT_QUEUE;
+        serialTxDirectCount--;
+        serialTxDirectBytes -= done.len;
+        serialTxDmaDirect = 0;
+    } else {
+        serialTxTail = (serialTxTail + serialTxDmaLen) % MYSERIAL_TX_BUFFER_SIZE;
+        serialTxCount -= serialTxDmaLen;
+    }
+    serialTxSentBytes += serialTxDmaLen;
+    serialTxDmaLen = 0;
+    MySerial_TxDmaKick();
+    tTaskExitCritical(status);
+
+    if (done.done != 0) {
+        done.done(done.param, done.buf);
+    }
+
+#if (MYSERIAL_TX_POLICY == MYSERIAL_TX_BLOCK) && (TINYOS_ENABLE_SEM == 1)
+    tSemNotifyFromISR(&serialTxSpaceSem);
+#endif
+}
+
+/**
+ * @brief 不经复制直接发送一个缓冲区
+ * 
+ * 缓冲区加入直接发送队列后立即返回，DMA发完后在中断中调用done归还，此前缓冲区不能修改；
+ * 可在任务及中断中调用，用于遥测等由存储池分配的整块数据。
+ * 
+ * @param buf 数据，需位于DMA可访问的内存
+ * @param len 字节数，1~65535
+ * @param done 发送完成回调，在中断中执行，可为0
+ * @param param 传给done的参数
+ * @return tErrorNoError，队列已满时为tErrorResourceFull，串口未初始化时为tErrorResourceUnavaliable
+ */
+uint32_t MySerial_WriteDirect(const uint8_t *buf, uint32_t len, void (*done)(void *param, const uint8_t *buf), void *param)
+{
+    MySerialTxDirect *direct;
+    uint32_t status;
+
+    if (!serialTxReady || (len == 0) || (len > 0xFFFF)) {
+        return tErrorResourceUnavaliable;
+    }
+
+    status = tTaskEnterCritical();
+    if (serialTxDirectCount == MYSERIAL_TX_DIRECT_QUEUE) {
+        tTaskExitCritical(status);
+        return tErrorResourceFull;
+    }
+    direct = &serialTxDirect[(serialTxDirectHead + serialTxDirectCount) % MYSERIAL_TX_DIRECT_QUEUE];
+    direct->buf = buf;
+    direct->len = len;
+    direct->done = done;
+    direct->param = param;
+    serialTxDirectCount++;
+    serialTxDirectBytes += len;
+    MySerial_TxDmaKick();
+    tTaskExitCritical(status);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 读取DMA发送的积压情况，供遥测等按链路拥塞程度调整发送量
+ * 
+ * @param txStatus 发送状态
+ * @return 无
+ */
+void MySerial_TxGetStatus(MySerialTxStatus *txStatus)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    txStatus->ringCount = serialTxCount;
+    txStatus->ringSize = MYSERIAL_TX_BUFFER_SIZE;
+    txStatus->directCount = serialTxDirectCount;
+    txStatus->directBytes = serialTxDirectBytes;
+    txStatus->sentBytes = serialTxSentBytes;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief DMA发送缓冲区满而丢弃的字节数
+ * 
+ * @param 无
+ * @return 自初始化以来丢弃的字节数
+ */
+uint32_t MySerial_TxDropped(void)
+{
+    return serialTxDropped;
+}
+#endif
+
+/**
+ * @brief 串口发送一段数据
+ * 
+ * DMA发送时数据拷入发送环形缓冲区后立即返回，不超过缓冲区大小的数据整块拷入，放不下时按MYSERIAL_TX_POLICY丢弃或等待；
+ * 开启字节流时数据整块写入发送缓冲区后立即返回(缓冲区满时等待)，由TXE中断发送；
+ * 否则阻塞发送。
+ * 
+ * @param buf 数据
+ * @param len 字节数
+ * @return 无
+ */
+void MySerial_Write(const uint8_t *buf, uint32_t len)
+{
+#if MYSERIAL_TX_USE_DMA == 1
+    if (serialTxReady) {
+        for (;;) {
+            uint32_t n = MySerial_TxDmaPut(buf, len);
+            buf += n;
+            len -= n;
+            if (len == 0) {
+                return;
+            }
+#if MYSERIAL_TX_POLICY == MYSERIAL_TX_BLOCK
+            if (__get_IPSR() == 0) {
+#if TINYOS_ENABLE_SEM == 1
+                if (curTask != (tTask *)0) {
+                    tSemWait(&serialTxSpaceSem, 0);
+                    continue;
+                }
+#endif
+                while (MYSERIAL_TX_BUFFER_SIZE - serialTxCount < ((len < MYSERIAL_TX_BUFFER_SIZE) ? len : MYSERIAL_TX_BUFFER_SIZE)) {
+                }
+                continue;
+            }
+#endif
+            serialTxDropped += len;
+            return;
+        }
+    }
+#elif TINYOS_ENABLE_STREAM == 1
+    if (serialTxReady) {
+        tStreamWrite(&serialTxStream, buf, len, 0);
+        __HAL_UART_ENABLE_IT(&huart1, UART_IT_TXE);
+        return;
+    }
+#endif
+    HAL_UART_Transmit(&huart1, (uint8_t *)buf, len, 0xfff);
+}
+
+static void MySerial_FormatPut(void *ctx, const char *s, uint32_t len)
+{
+    (void)ctx;
+    MySerial_Write((const uint8_t *)s, len);
+}
+
+/**
+ * @brief 格式化输出到串口
+ * 
+ * 用tFormat的整数格式化代替printf，%f不链接libc的浮点格式化；格式串的普通字符及每个数字
+ * 各自一次写入DMA发送缓冲区，不经fputc逐字符调用及任务的行缓冲，也不占用行缓冲的槽位。
+ * 同一行被其它任务的输出打断时各段仍各自完整，需要整行不被打断时先格式化到自己的缓冲区再MySerial_Write。
+ * 
+ * @param fmt 格式串，见tFormat.h
+ * @return 输出的字符数
+ */
+uint32_t MySerial_Printf(const char *fmt, ...)
+{
+    va_list ap;
+    uint32_t count;
+
+    va_start(ap, fmt);
+    count = tVFormat(MySerial_FormatPut, (void *)0, fmt, ap);
+    va_end(ap);
+    return count;
+}
+
+/**
+ * @brief 串口发送中断处理
+ * 
+ * 在USART1_IRQHandler中HAL处理之前调用，从发送缓冲区取一个字节写入数据寄存器，
+ * 缓冲区为空时关闭TXE中断。
+ * 
+ * @param 无
+ * @return 无
+ */
+void MySerial_TxIRQHandler(void)
+{
+#if (MYSERIAL_TX_USE_DMA == 0) && (TINYOS_ENABLE_STREAM == 1)
+    uint8_t ch;
+
+    if (!__HAL_UART_GET_FLAG(&huart1, UART_FLAG_TXE) || !(huart1.Instance->CR1 & USART_CR1_TXEIE)) {
+        return;
+    }
+    if (tStreamReadFromISR(&serialTxStream, &ch, 1)) {
+        huart1.Instance->DR = ch;
+    } else {
+        __HAL_UART_DISABLE_IT(&huart1, UART_IT_TXE);
+    }
+#endif
+}
+
+/**
+ * @brief 串口线路空闲中断处理
+ * 
+ * 在USART1_IRQHandler中HAL处理之前调用，线路空闲一个字符时间后取出DMA已写入的数据并结束当前帧。
+ * 
+ * @param 无
+ * @return 无
+ */
+void MySerial_RxIRQHandler(void)
+{
+#if MYSERIAL_RX_USE_DMA == 1
+    if (!__HAL_UART_GET_FLAG(&huart1, UART_FLAG_IDLE) || !(huart1.Instance->CR1 & USART_CR1_IDLEIE)) {
+        return;
+    }
+    __HAL_UART_CLEAR_IDLEFLAG(&huart1);
+    MySerial_RxDrain();
+    if (serialRxParser != 0) {
+        serialRxParser(serialRxDma, MYSERIAL_RX_DMA_SIZE, MYSERIAL_RX_PARSER_IDLE);
+    }
+    MySerial_RxFrameEnd();
+#endif
 }
 
+#if MYSERIAL_RX_USE_DMA == 1
+/**
+ * @brief 设置接收数据的旁路解析函数
+ * 
+ * 解析函数在串口中断中调用，一次一个字节，直接读取DMA循环缓冲区中的数据，不经复制；
+ * 一帧结束时帧中较早的字节仍在缓冲区中，可回头按位置读取，帧长需远小于缓冲区的一半。
+ * 
+ * @param parser 解析函数，为0时取消
+ * @return 无
+ */
+void MySerial_SetRxParser(MySerialRxParser parser)
+{
+    serialRxParser = parser;
+}
+#endif
+
 /**
  * @brief UART接收中断回调函数
  * 
- * 在串口接收到数据后调用，处理接收到的字节数据。
+ * DMA接收时在缓冲区全满时调用，取出后半部分数据；逐字节接收时处理接收到的字节数据。
  * 
  * @param huart 串口句柄指针
  * @return 无
  */
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
-    // 将接收到的数据存储到data数组中，并移动指针
-    data[pointer++] = dat;
+    if (huart != &huart1) {
+        return;
+    }
+#if MYSERIAL_RX_USE_DMA == 1
+    MySerial_RxDrain();
+#else
+#if TINYOS_ENABLE_SHELL == 1
+    // 开启命令行时收到的数据都交给命令行
+    tShellInputFromISR(dat);
+#else
+    // 将接收到的数据存储到data数组中，并移动指针，保留结尾的'\0'
+    if (pointer < sizeof(data) - 1) {
+        data[pointer++] = dat;
+    }
+#endif
     // 再次启动UART接收中断以接收后续数据
     HAL_UART_Receive_IT(&huart1, &dat, 1);	
+#endif
+}
+
+/**
+ * @brief DMA接收半满回调
+ * 
+ * 取出前半部分数据，DMA继续写入后半部分。
+ * 
+ * @param huart 串口句柄指针
+ * @return 无
+ */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+#if MYSERIAL_RX_USE_DMA == 1
+    if (huart == &huart1) {
+        MySerial_RxDrain();
+    }
+#endif
+}
+
+/**
+ * @brief 串口错误回调
+ * 
+ * 溢出等错误发生后HAL已停止接收，重新启动。
+ * 
+ * @param huart 串口句柄指针
+ * @return 无
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart != &huart1) {
+        return;
+    }
+#if MYSERIAL_RX_USE_DMA == 1
+    MySerial_RxStart();
+#else
+    HAL_UART_Receive_IT(&huart1, &dat, 1);
+#endif
+}
+
+#if (MYSERIAL_RX_USE_DMA == 1) && (TINYOS_ENABLE_STREAM == 1)
+/**
+ * @brief 等待并读取一帧数据
+ * 
+ * 在任务中调用，帧长超过size时只复制前size个字节，其余丢弃。
+ * 
+ * @param buf 接收缓冲区
+ * @param size 接收缓冲区大小
+ * @param waitTicks 最大等待的节拍数，为0时一直等待
+ * @return 复制的字节数，超时时为0
+ */
+uint32_t MySerial_ReadFrame(uint8_t *buf, uint32_t size, uint32_t waitTicks)
+{
+    uint8_t len;
+    uint8_t skip[16];
+    uint32_t n, rest;
+
+    if (tStreamRead(&serialRxStream, &len, 1, waitTicks) == 0) {
+        return 0;
+    }
+    // 帧长与数据在中断中一次写入，读出帧长后数据已在字节流中，不会再等待
+    n = (len < size) ? len : size;
+    tStreamRead(&serialRxStream, buf, n, 0);
+    for (rest = len - n; rest > 0; rest -= n) {
+        n = tStreamRead(&serialRxStream, skip, (rest < sizeof(skip)) ? rest : sizeof(skip), 0);
+    }
+    return (len < size) ? len : size;
+}
+#endif
+
+/**
+ * @brief 帧超长或来不及处理而丢弃的字节数
+ * 
+ * @param 无
+ * @return 自初始化以来丢弃的字节数，逐字节接收时为0
+ */
+uint32_t MySerial_RxDropped(void)
+{
+#if MYSERIAL_RX_USE_DMA == 1
+    return serialRxDropped;
+#else
+    return 0;
+#endif
+}
+
+#if MYSERIAL_STDIO_LINE_BUFFER == 1
+//查找任务的行缓冲，没有时分配一个空闲的或属于已删除任务的，都被占用时返回0
+//行缓冲只由所属任务读写，分配与归还在临界区内修改owner
+static MySerialLine * MySerial_LineGet(tTask * task)
+{
+    MySerialLine * line = (MySerialLine *)0;
+    uint32_t i, status;
+
+    for (i = 0; i < MYSERIAL_STDIO_LINE_SLOTS; i++) {
+        if (serialLines[i].owner == task) {
+            return &serialLines[i];
+        }
+    }
+
+    status = tTaskEnterCritical();
+    for (i = 0; i < MYSERIAL_STDIO_LINE_SLOTS; i++) {
+        tTask * owner = serialLines[i].owner;
+        if ((owner == (tTask *)0) || (owner->state & TINYOS_TASK_STATE_DESTORYED)) {
+            line = &serialLines[i];
+            line->owner = task;
+            line->len = 0;
+            break;
+        }
+    }
+    tTaskExitCritical(status);
+    return line;
+}
+
+//整行写入发送缓冲区并归还行缓冲
+static void MySerial_LineFlush(MySerialLine * line)
+{
+    MySerial_StdioWrite(line->buf, line->len);
+    line->len = 0;
+    line->owner = (tTask *)0;
+}
+#endif
+
+/**
+ * @brief 输出当前任务行缓冲中尚未换行的内容
+ * 
+ * 输出提示符等不以换行结尾的内容后调用；未开启行缓冲或在中断中调用时无作用。
+ * 
+ * @param 无
+ * @return 无
+ */
+void MySerial_Flush(void)
+{
+#if MYSERIAL_STDIO_LINE_BUFFER == 1
+    uint32_t i;
+
+    if ((__get_IPSR() != 0) || (curTask == (tTask *)0)) {
+        return;
+    }
+    for (i = 0; i < MYSERIAL_STDIO_LINE_SLOTS; i++) {
+        if (serialLines[i].owner == curTask) {
+            MySerial_LineFlush(&serialLines[i]);
+            return;
+        }
+    }
+#endif
 }
 
 /**
  * @brief 重定向标准输出函数
  * 
- * 用于实现printf函数的重定向，将标准输出数据通过串口发送。
+ * 用于实现printf函数的重定向，将标准输出数据通过串口发送，MYSERIAL_STDIO_RTT为1时写入RTT控制台通道。
+ * 开启行缓冲时任务的输出先放入各自的行缓冲，遇到换行或行缓冲满时整行发送；
+ * 中断中、调度器启动前或行缓冲都被占用时直接发送。
  * 
  * @param ch  要发送的字符
  * @param f   文件指针(这里无实际作用)
@@ -49,42 +777,78 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
  */
 int fputc(int ch, FILE *f)
 {
-    // 通过UART1发送数据，等待时间为最大
-    HAL_UART_Transmit(&huart1, (uint8_t *)&ch, 1, 0xfff);
+    uint8_t c = (uint8_t)ch;
+#if MYSERIAL_STDIO_LINE_BUFFER == 1
+    MySerialLine * line;
+
+    if ((__get_IPSR() == 0) && (curTask != (tTask *)0)) {
+        line = MySerial_LineGet(curTask);
+        if (line != (MySerialLine *)0) {
+            line->buf[line->len++] = c;
+            if ((c == '\n') || (line->len == MYSERIAL_STDIO_LINE_SIZE)) {
+                MySerial_LineFlush(line);
+            }
+            return ch;
+        }
+    }
+#endif
+    MySerial_StdioWrite(&c, 1);
     return ch;
 }
 
 /**
  * @brief 串口接收数据处理函数
  * 
- * 检查是否有数据接收完成并稳定。如果接收完成调用数据处理函数。
+ * 有完整的一帧时调用数据处理函数，没有时立即返回。DMA接收由线路空闲判断帧结束；
+ * 逐字节接收时延迟1ms后数据不再增加即认为接收完成。
  * 
  * @param 无
  * @return 无
  */
 void MySerial_ReceiveData(void)
 {
+#if MYSERIAL_RX_USE_DMA == 1
+#if TINYOS_ENABLE_STREAM == 1
+    uint8_t buf[MYSERIAL_RX_FRAME_MAX];
+    tStreamInfo info;
+    uint32_t len;
+
+    tStreamGetInfo(&serialRxStream, &info);
+    if (info.count > 0) {
+        len = MySerial_ReadFrame(buf, sizeof(buf), 0);
+        UART_RX_PROC(buf, len);
+    }
+#else
+    if (serialRxPendingLen != 0) {
+        UART_RX_PROC(serialRxPending, serialRxPendingLen);
+        serialRxPendingLen = 0;
+    }
+#endif
+#else
     // 检查指针是否有变化，判断是否接收到新数据
     if(pointer != 0) {
         int tmp = pointer;
         // 延迟1ms，等待数据接收稳定
         HAL_Delay(1);
         if(tmp == pointer) { // 如果延迟后指针未变，说明数据已完全接收
-            UART_RX_PROC(); // 调用数据处理函数
+            UART_RX_PROC((const uint8_t *)data, pointer); // 调用数据处理函数
+            pointer = 0;
         }
     }
+#endif
 }
 
 /**
  * @brief 数据处理函数
  * 
- * 处理接收到的数据并通过串口打印到标准输出。
+ * 处理接收到的一帧数据并通过串口打印到标准输出。
  * 
- * @param 无
+ * @param buf 数据
+ * @param len 字节数
  * @return 无
  */
-void UART_RX_PROC(void)
+void UART_RX_PROC(const uint8_t *buf, uint32_t len)
 {
     // 打印接收到的数据，并换行
-    printf("%s\n", data);
+    printf("%.*s\n", (int)len, (const char *)buf);
 }
@@ -3,9 +3,57 @@
 #include "main.h"
 #include "stdio.h"
 
+#define MYSERIAL_TX_BUFFER_SIZE 256 // 发送缓冲区大小，DMA发送或开启TINYOS_ENABLE_STREAM时使用
+#define MYSERIAL_TX_USE_DMA     1   // 1:经DMA2 Stream7从发送环形缓冲区发送，0:开启字节流时用TXE中断发送，否则阻塞发送
+#define MYSERIAL_TX_DIRECT_QUEUE 4  // MySerial_WriteDirect可同时排队的缓冲区数
+
+// DMA发送缓冲区放不下时的处理：丢弃放不下的部分，或等待DMA发出一段后继续写入
+// 中断中调用时总是丢弃；开启TINYOS_ENABLE_SEM且调度器已启动时阻塞在信号量上，否则轮询缓冲区
+#define MYSERIAL_TX_DROP        0
+#define MYSERIAL_TX_BLOCK       1
+#define MYSERIAL_TX_POLICY      MYSERIAL_TX_BLOCK
+
+#define MYSERIAL_RX_USE_DMA     1   // 1:DMA2 Stream2循环接收，线路空闲(IDLE)时结束一帧，0:逐字节接收中断
+#define MYSERIAL_RX_DMA_SIZE    64  // DMA循环接收缓冲区大小，半满及全满时取出数据，按波特率留出两次中断之间的余量
+#define MYSERIAL_RX_FRAME_MAX   64  // 一帧的最大字节数，超出的部分丢弃，不超过255
+#define MYSERIAL_RX_STREAM_SIZE 256 // 开启TINYOS_ENABLE_STREAM时待处理帧的缓冲区大小，每帧另占1字节帧长
+
+#define MYSERIAL_STDIO_LINE_BUFFER 1 // 1:任务中的printf先写入各自的行缓冲，换行时整行发送
+#define MYSERIAL_STDIO_LINE_SIZE 80 // 行缓冲大小，超出时不等换行先发送
+#define MYSERIAL_STDIO_LINE_SLOTS 6 // 同时有未换行输出的任务数上限，超出时该任务逐字符发送
+#define MYSERIAL_STDIO_RTT      0   // 1:printf写入RTT控制台通道(需TINYOS_ENABLE_RTT)，USART1只发送遥测等数据，0:经USART1发送
+
+// 接收数据的旁路解析(需MYSERIAL_RX_USE_DMA)：DMA取出的每个字节先交给解析函数，pos为该字节在ring中的位置，
+// 返回1表示属于二进制帧，不再交给命令行或拼帧；线路空闲时以MYSERIAL_RX_PARSER_IDLE为位置调用一次
+#define MYSERIAL_RX_PARSER_IDLE 0xFFFFFFFFu
+typedef uint32_t (*MySerialRxParser)(const uint8_t *ring, uint32_t size, uint32_t pos);
+
+// DMA发送的积压情况
+typedef struct _MySerialTxStatus {
+    uint32_t ringCount;     // 环形缓冲区中待发送的字节数
+    uint32_t ringSize;      // 环形缓冲区大小
+    uint32_t directCount;   // 直接发送队列中的缓冲区数
+    uint32_t directBytes;   // 直接发送队列中的字节数
+    uint32_t sentBytes;     // 已发送的总字节数，只增不减，两次读取之差即为期间的吞吐量
+} MySerialTxStatus;
+
 void MySerial_Init(void); // 初始化串口
+void MySerial_Write(const uint8_t *buf, uint32_t len); // 串口发送一段数据
+uint32_t MySerial_Printf(const char *fmt, ...); // 按tFormat格式化后直接写入发送缓冲区，不经行缓冲，返回字符数
+void MySerial_TxIRQHandler(void); // 串口发送中断处理
+void MySerial_RxIRQHandler(void); // 串口线路空闲中断处理，结束一帧
+uint32_t MySerial_ReadFrame(uint8_t *buf, uint32_t size, uint32_t waitTicks); // 等待并读取一帧，需开启TINYOS_ENABLE_STREAM
+void MySerial_SetRxParser(MySerialRxParser parser); // 设置接收数据的旁路解析函数，为0时取消
+uint32_t MySerial_RxDropped(void); // 帧超长或来不及处理而丢弃的字节数
+uint32_t MySerial_TxDropped(void); // DMA发送缓冲区满而丢弃的字节数
+void MySerial_TxGetStatus(MySerialTxStatus *txStatus); // 读取DMA发送的积压情况
+uint32_t MySerial_WriteDirect(const uint8_t *buf, uint32_t len, void (*done)(void *param, const uint8_t *buf), void *param); // 不经复制直接由DMA发送缓冲区
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart); // DMA发送完成回调，接续下一段
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart); // 串口接收中断回调处理
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart); // DMA接收半满回调
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart); // 串口错误回调，重新启动接收
 int fputc(int ch, FILE *f); // 标准输出字符到串口
+void MySerial_Flush(void); // 输出当前任务行缓冲中未换行的内容
 void MySerial_ReceiveData(void); // 接收串口数据
-void UART_RX_PROC(void); // 串口接收数据处理逻辑
+void UART_RX_PROC(const uint8_t *buf, uint32_t len); // 串口接收数据处理逻辑
 #endif
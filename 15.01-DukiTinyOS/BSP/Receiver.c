@@ -1,15 +1,49 @@
 #include "Receiver.h"
 #include "tim.h"
 #include "MySerial.h"
+#include "tinyOS.h"
+
+// 输入捕获：四个通道都按双边沿捕获，不在中断中切换极性，完整的一帧信号只留下边沿时刻；
+// 通道1、2的捕获值由DMA(DMA1 Stream0/Stream3，Channel2，循环模式)直接写入环形缓冲区，不产生中断；
+// RECEIVER_CH1_DMA为0时DMA1 Stream0留给SPI3接收，通道1与通道3、4一样由中断记录；
+// TIM4_CH3与I2C2发送共用DMA1 Stream7、TIM4_CH4没有DMA请求，这两个通道的中断只把捕获值存入环形缓冲区。
+// 脉宽与映射值在读取时才计算：取最近三个边沿的两段间隔，较短的一段即为高电平(1~2ms，远小于帧周期)；
+// 读取时发现新边沿才换算该通道的脉宽与杆量并缓存，receiverGen加1，通道丢失或恢复信号、校准改变时同样加1；
+// 混控输出按代数缓存，代数不变时各电机的读取直接取缓存，不再每次读取都把四个通道重新换算一遍
+#define RECEIVER_CAPTURE_DEPTH  4       // 环形缓冲区深度，读取最近三个边沿期间再来一个边沿也不会覆盖
+#define RECEIVER_WIDTH_VALID_MIN 800    // 有效脉宽范围(us)，范围外视为尚未收到信号，沿用中位值
+#define RECEIVER_WIDTH_VALID_MAX 2200
+#define RECEIVER_DMA_MASK       ((RECEIVER_CH1_DMA << CHANNEL1_INDEX) | (1u << CHANNEL2_INDEX)) // 经DMA记录的通道
 
 // 数据存储
-static uint32_t risingEdgeTime[CHANNEL_COUNT] = {0};  // 存储每个通道的上升沿捕获时间
-static uint32_t fallingEdgeTime[CHANNEL_COUNT] = {0}; // 存储每个通道的下降沿捕获时间
-static uint8_t isRisingEdge[CHANNEL_COUNT] = {1};     // 每个通道的标志位：1表示检测上升沿，0表示检测下降沿
-static uint32_t pwmWidth[CHANNEL_COUNT] = {0};        // 存储每个通道的脉宽（单位：计数值）
-static float curMapVal[CHANNEL_COUNT] = {0.5,0,0.5,0.5};          //存储当前通道的map值
-static float pwmMapVal[CHANNEL_COUNT] = {0};          // 存储每个通道映射到控制值的结果（0.0 到 1.0）
-//pwmMapVal规定
+static volatile uint16_t captureRing[CHANNEL_COUNT][RECEIVER_CAPTURE_DEPTH]; // 每个通道最近的边沿时刻(us)
+static volatile uint32_t captureCount[CHANNEL_COUNT];   // 中断方式的通道已写入的边沿数
+static DMA_HandleTypeDef captureDma[2];                 // 通道1、2的DMA
+static ReceiverCalib receiverCalib[CHANNEL_COUNT] = {
+    {MIN_MOTORVAL14, MAX_MOTORVAL14}, {MIN_MOTORVAL2, MAX_MOTORVAL2},
+    {MIN_MOTORVAL3, MAX_MOTORVAL3}, {MIN_MOTORVAL14, MAX_MOTORVAL14},
+};
+static uint32_t receiverScale[CHANNEL_COUNT];           // Q16换算系数：65536 / (max - min)
+// 信号丢失检测：读取时发现最新边沿的位置或时刻有变化即记为收到新信号
+static uint32_t lastNext[CHANNEL_COUNT];
+static uint16_t lastEdge[CHANNEL_COUNT];
+static uint32_t lastUpdate[CHANNEL_COUNT];
+static uint32_t seenMask;
+// 按需换算的缓存，都在临界区内与receiverGen一起更新
+static uint16_t channelWidth[CHANNEL_COUNT];            // 最近一个有效脉宽(us)，无效时为0
+static float channelStick[CHANNEL_COUNT];               // 由channelWidth换算的杆量，无效时为中位值
+static uint32_t staleState = (1u << CHANNEL_COUNT) - 1; // 上次读取时丢失信号的通道
+static uint32_t receiverGen = 1;                        // 缓存的代数
+static float mixValue[CHANNEL_COUNT];                   // 各电机的混控输出
+static uint32_t mixGen;                                 // mixValue对应的代数
+static const float curMapVal[CHANNEL_COUNT] = {0.5,0,0.5,0.5};  //没有信号时各通道的杆量，也是混控的零点
+//pwmMapVal规定：由杆量相对零点的变化按下表组合得到，下标为电机，列依次为通道1~4
+static const int8_t pwmMix[CHANNEL_COUNT][CHANNEL_COUNT] = {
+    { 1, 1,  1, -1},
+    {-1, 1,  1,  1},
+    {-1, 1, -1, -1},
+    { 1, 1, -1,  1},
+};
 /*
 pwmMapVal[0]:通道一  右手左右   控制航向
 pwmMapVal[1]:通道二  右手上下   控制升降
@@ -21,123 +55,116 @@ pwmMapVal[3]:通道四  左手左右   控制横滚
 4.偏航分别控制通道14和23，向右拨滑杆，飞机沿z轴顺时针转，14占空比增加，23减少
 */
 // 函数声明
-static uint32_t CalculatePWMWidth(uint32_t risingEdge, uint32_t fallingEdge, uint32_t period);
-static void MapPWMWidthToValue(uint32_t width, uint32_t channelIndex);
+static uint32_t CalculatePWMWidth(uint32_t channelIndex, uint32_t now, uint32_t *updateTick, float *stick);
+static float MapPWMWidthToValue(uint32_t width, uint32_t channelIndex);
 static uint32_t GetChannelIndex(TIM_HandleTypeDef *htim);
 
 /**
  * @brief 计算脉宽
- * @param risingEdge 上升沿捕获的计数值
- * @param fallingEdge 下降沿捕获的计数值
- * @param period 定时器的自动重装载值（ARR）
- * @return 脉宽值（单位：计数值）
+ * @param channelIndex 通道索引
+ * @param now 当前节拍数
+ * @param updateTick 输出最近一次收到新边沿时的节拍数
+ * @param stick 输出杆量，信号丢失或还没有有效信号时为中位值
+ * @return 最近一个完整脉冲的脉宽（单位：us），信号丢失或还没有有效信号时返回0
  * 
- * 该函数根据上升沿和下降沿时间点计算脉宽（高电平时间）。
- * 如果发生计数器溢出，考虑溢出的补偿周期。
+ * 取该通道最近三个边沿的两段间隔，较短的一段为高电平。计数器按0xFFFF回绕，
+ * 16位无符号减法直接得到跨越溢出的间隔。最新边沿的写入位置及时刻都与上次读取相同，
+ * 且持续超过RECEIVER_TIMEOUT_MS时视为信号丢失(缓冲区中留下的是旧脉冲)。
+ * 脉宽及杆量只在发现新边沿时换算一次，存入缓存供其余读者使用。
  */
-static uint32_t CalculatePWMWidth(uint32_t risingEdge, uint32_t fallingEdge, uint32_t period) {
-    if (fallingEdge >= risingEdge) {
-        return fallingEdge - risingEdge;  // 没有溢出，直接计算差值
+static uint32_t CalculatePWMWidth(uint32_t channelIndex, uint32_t now, uint32_t *updateTick, float *stick) {
+    uint32_t next, status, stale, width;
+    uint16_t c0, c1, c2, d1, d2;
+
+    // 下一个写入的位置：DMA通道由剩余传输数换算，中断通道由计数换算
+    if ((channelIndex <= CHANNEL2_INDEX) && (RECEIVER_DMA_MASK & (1u << channelIndex))) {
+        if (captureDma[channelIndex].Instance == 0) {
+            *updateTick = 0;
+            *stick = curMapVal[channelIndex];
+            return 0;   // 尚未调用Receiver_Init
+        }
+        next = RECEIVER_CAPTURE_DEPTH - captureDma[channelIndex].Instance->NDTR;
     } else {
-        return (period - risingEdge) + fallingEdge; // 溢出时补偿
+        next = captureCount[channelIndex];
+    }
+    c2 = captureRing[channelIndex][(next - 1) % RECEIVER_CAPTURE_DEPTH];
+    c1 = captureRing[channelIndex][(next - 2) % RECEIVER_CAPTURE_DEPTH];
+    c0 = captureRing[channelIndex][(next - 3) % RECEIVER_CAPTURE_DEPTH];
+
+    // 可能被多个任务同时读取，更新检测状态及缓存放在临界区内，发现新边沿的读者负责换算
+    status = tTaskEnterCritical();
+    if ((next != lastNext[channelIndex]) || (c2 != lastEdge[channelIndex])) {
+        lastNext[channelIndex] = next;
+        lastEdge[channelIndex] = c2;
+        lastUpdate[channelIndex] = now;
+        seenMask |= 1u << channelIndex;
+
+        d1 = (uint16_t)(c1 - c0);
+        d2 = (uint16_t)(c2 - c1);
+        width = (d1 < d2) ? d1 : d2;
+        if ((width < RECEIVER_WIDTH_VALID_MIN) || (width > RECEIVER_WIDTH_VALID_MAX)) {
+            width = 0;
+        }
+        channelWidth[channelIndex] = (uint16_t)width;
+        channelStick[channelIndex] = (width == 0) ? curMapVal[channelIndex] : MapPWMWidthToValue(width, channelIndex);
+        receiverGen++;
+    }
+    *updateTick = lastUpdate[channelIndex];
+    stale = !(seenMask & (1u << channelIndex)) ||
+            ((now - lastUpdate[channelIndex]) > tTimeMsToTicks(RECEIVER_TIMEOUT_MS));
+    if (stale != ((staleState >> channelIndex) & 1u)) {
+        staleState ^= 1u << channelIndex;
+        receiverGen++;
     }
+    width = stale ? 0 : channelWidth[channelIndex];
+    *stick = stale ? curMapVal[channelIndex] : channelStick[channelIndex];
+    tTaskExitCritical(status);
+    return width;
 }
 
 /**
  * @brief 映射脉宽到控制值
- * @param width 脉宽值（单位：计数值）
+ * @param width 脉宽值（单位：us）
  * @param channelIndex 通道索引
+ * @return 映射值（0.0 到 1.0）
  * 
- * 根据不同通道的范围（MIN_MOTORVAL、MAX_MOTORVAL）将脉宽值映射到 0.0 到 1.0 的范围。
- * 特定通道的映射范围通过 `channelIndex` 确定。
+ * 按通道的校准范围限幅后乘以预先算好的Q16系数，不做除法也不按通道分支。
  */
-static void MapPWMWidthToValue(uint32_t width, uint32_t channelIndex) {
-    float MIN_MOTORVAL, MAX_MOTORVAL, SUB_MOTORVAL;
-
-    // 根据通道索引选择不同的映射范围
-    switch (channelIndex) {
-        case CHANNEL3_INDEX:
-            MIN_MOTORVAL = MIN_MOTORVAL3;
-            MAX_MOTORVAL = MAX_MOTORVAL3;
-            SUB_MOTORVAL = SUB_MOTORVAL3;
-            break;
-        case CHANNEL2_INDEX:
-            MIN_MOTORVAL = MIN_MOTORVAL2;
-            MAX_MOTORVAL = MAX_MOTORVAL2;
-            SUB_MOTORVAL = SUB_MOTORVAL2;
-            break;
-        default:  // 偏航控制：CHANNEL14_INDEX，俯仰控制：CHANNEL12_INDEX，横滚控制：CHANNEL24_INDEX
-            MIN_MOTORVAL = MIN_MOTORVAL14;
-            MAX_MOTORVAL = MAX_MOTORVAL14;
-            SUB_MOTORVAL = SUB_MOTORVAL14;
-            break;
-    }
+static float MapPWMWidthToValue(uint32_t width, uint32_t channelIndex) {
+    uint32_t min = receiverCalib[channelIndex].min;
+    uint32_t max = receiverCalib[channelIndex].max;
 
     // 限制脉宽在有效范围内
-    if (width < MIN_MOTORVAL) {
-        width = MIN_MOTORVAL;
-    }
-    if (width > MAX_MOTORVAL) {
-        width = MAX_MOTORVAL;
-    }
+    width = (width > max) ? max : width;
+    width = (width < min) ? min : width;
 
-    // 映射值计算
-    float mappedValue = ((float)(width - MIN_MOTORVAL)) / SUB_MOTORVAL;
-//    pwmMapVal[channelIndex] = mappedValue;
-		
-		float deta = 0;
-		float tmp ;
-		
-		switch (channelIndex) {
-				case CHANNEL2_INDEX:  // 升降控制 
-					  tmp	= curMapVal[channelIndex];
-						curMapVal[channelIndex] = mappedValue;
-						deta = mappedValue - tmp;
-						
-						pwmMapVal[CHANNEL1_INDEX] += deta; // 电机1增加
-						pwmMapVal[CHANNEL2_INDEX] += deta; // 电机2增加
-						pwmMapVal[CHANNEL3_INDEX] += deta; // 电机3增加
-						pwmMapVal[CHANNEL4_INDEX] += deta; // 电机4增加
-						break;
-
-				case CHANNEL4_INDEX:  // 横滚控制
-					  tmp	= curMapVal[channelIndex];
-						curMapVal[channelIndex] = mappedValue;
-						deta = mappedValue - tmp;
-						pwmMapVal[CHANNEL1_INDEX] -= deta; // 电机13减小
-						pwmMapVal[CHANNEL3_INDEX] -= deta; // 电机13减小
-						pwmMapVal[CHANNEL2_INDEX] += deta;      // 电机24增加
-						pwmMapVal[CHANNEL4_INDEX] += deta;      // 电机24增加
-						break;
-
-				case CHANNEL3_INDEX:  // 俯仰控制
-					  tmp	= curMapVal[channelIndex];
-						curMapVal[channelIndex] = mappedValue;
-						deta = mappedValue - tmp;
-						pwmMapVal[CHANNEL1_INDEX] += deta; // 电机12增加
-						pwmMapVal[CHANNEL2_INDEX] += deta; // 电机12增加
-						pwmMapVal[CHANNEL3_INDEX] -= deta; // 电机34减小
-						pwmMapVal[CHANNEL4_INDEX] -= deta; // 电机34减小
-						break;
-
-				case CHANNEL1_INDEX:  // 偏航控制
-					  tmp	= curMapVal[channelIndex];
-						curMapVal[channelIndex] = mappedValue;
-						deta = mappedValue - tmp;
-						pwmMapVal[CHANNEL1_INDEX] += deta; // 电机14增加
-						pwmMapVal[CHANNEL4_INDEX] += deta; // 电机14增加
-						pwmMapVal[CHANNEL2_INDEX] -= deta; // 电机23减小
-						pwmMapVal[CHANNEL3_INDEX] -= deta; // 电机23减小
-						break;
-
-				default:
-						break;
-		}
-   
+    // 映射值计算：(width - min) * 65536 / (max - min)，结果为Q16
+    return (float)((width - min) * receiverScale[channelIndex]) * (1.0f / 65536.0f);
 }
 
+/**
+ * @brief 设置通道的校准范围
+ * @param channelIndex 通道索引
+ * @param calib 有效脉宽范围，max需大于min
+ * 
+ * Q16换算系数只在这里计算一次(四舍五入)，映射时只需一次整数乘法；缓存的杆量按新范围重新换算。
+ */
+void Receiver_SetCalib(uint32_t channelIndex, const ReceiverCalib *calib) {
+    uint32_t span, status;
 
-
+    if ((channelIndex >= CHANNEL_COUNT) || (calib->max <= calib->min)) {
+        return;
+    }
+    span = calib->max - calib->min;
+    status = tTaskEnterCritical();
+    receiverCalib[channelIndex] = *calib;
+    receiverScale[channelIndex] = (65536u + span / 2) / span;
+    if (channelWidth[channelIndex] != 0) {
+        channelStick[channelIndex] = MapPWMWidthToValue(channelWidth[channelIndex], channelIndex);
+    }
+    receiverGen++;
+    tTaskExitCritical(status);
+}
 
 /**
  * @brief 获取当前通道索引
@@ -160,49 +187,166 @@ static uint32_t GetChannelIndex(TIM_HandleTypeDef *htim) {
  * @brief 定时器输入捕获中断回调函数
  * @param htim 定时器句柄
  * 
- * 该函数在定时器捕获事件发生时触发。
- * 它根据当前通道索引读取捕获值，计算脉宽，并更新映射值。
- * 上升沿和下降沿捕获交替进行。
+ * 只有通道3、4(及RECEIVER_CH1_DMA为0时的通道1)使用中断：读取捕获值存入环形缓冲区，不切换极性，也不做任何计算。
  */
 void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
     if (htim->Instance == TIM4) {  // 检查是否为 TIM4
         uint32_t channelIndex = GetChannelIndex(htim);  // 获取通道索引
         if (channelIndex == INVALID_CHANNEL) return;    // 无效通道直接返回
 
-        // 读取捕获值
-        uint32_t capturedValue = HAL_TIM_ReadCapturedValue(htim, channelIndex * 4); // 修正参数传递错误
-
-        if (isRisingEdge[channelIndex]) {  // 上升沿捕获
-            risingEdgeTime[channelIndex] = capturedValue;  
-            __HAL_TIM_SET_CAPTUREPOLARITY(htim, channelIndex * 4, TIM_INPUTCHANNELPOLARITY_FALLING); // 切换到下降沿
-        } else {  // 下降沿捕获
-            fallingEdgeTime[channelIndex] = capturedValue;
-            pwmWidth[channelIndex] = CalculatePWMWidth(risingEdgeTime[channelIndex], fallingEdgeTime[channelIndex], TIM4->ARR); // 计算脉宽
-            MapPWMWidthToValue(pwmWidth[channelIndex], channelIndex); // 映射脉宽到控制值
-            __HAL_TIM_SET_CAPTUREPOLARITY(htim, channelIndex * 4, TIM_INPUTCHANNELPOLARITY_RISING); // 切换回上升沿
-        }
-        isRisingEdge[channelIndex] = !isRisingEdge[channelIndex]; // 切换边沿标志位
+        captureRing[channelIndex][captureCount[channelIndex] % RECEIVER_CAPTURE_DEPTH] =
+            (uint16_t)HAL_TIM_ReadCapturedValue(htim, channelIndex * 4);
+        captureCount[channelIndex]++;
     }
 }
 
+/**
+ * @brief 启动一个通道的捕获DMA
+ * @param hdma DMA句柄
+ * @param stream DMA数据流
+ * @param channelIndex 通道索引（通道1或通道2）
+ * 
+ * 捕获寄存器按半字循环写入该通道的环形缓冲区，由TIM4的CCxDE请求触发，不开启DMA中断。
+ */
+static void Receiver_StartCaptureDma(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream, uint32_t channelIndex) {
+    hdma->Instance = stream;
+    hdma->Init.Channel = DMA_CHANNEL_2;
+    hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    hdma->Init.Priority = DMA_PRIORITY_LOW;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(hdma);
+
+    stream->PAR = (uint32_t)((channelIndex == CHANNEL1_INDEX) ? &TIM4->CCR1 : &TIM4->CCR2);
+    stream->M0AR = (uint32_t)captureRing[channelIndex];
+    stream->NDTR = RECEIVER_CAPTURE_DEPTH;
+    stream->CR |= DMA_SxCR_EN;
+}
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+static tClockNotifier receiverClockNotifier;
+
+//定时器时钟改变后重设TIM4的预分频，保持1us的捕获分辨率；由软件更新事件立即装载，计数器随即写回原值，
+//URS置位时不置更新标志，已记录的边沿与之后的边沿仍在同一时间轴上
+static void Receiver_ClockChanged(uint32_t hclk, void *arg) {
+    uint32_t cnt = TIM4->CNT;
+
+    (void)hclk;
+    (void)arg;
+    TIM4->PSC = tClockTimerFreq() / 1000000 - 1;
+    TIM4->CR1 |= TIM_CR1_URS;
+    TIM4->EGR = TIM_EGR_UG;
+    TIM4->CNT = cnt;
+    TIM4->CR1 &= ~TIM_CR1_URS;
+}
+#endif
+
 /**
  * @brief 接收机初始化
  * 
- * 启动定时器捕获中断，用于捕获 4 个通道的信号。
+ * 四个通道改为双边沿捕获，计数器按0xFFFF回绕；通道1、2经DMA(RECEIVER_CH1_DMA为0时通道1经中断)、通道3、4经中断记录边沿。
  */
 void Receiver_Init(void) {
-    HAL_TIM_IC_Start_IT(&htim4, TIM_CHANNEL_1); // 启动通道1中断
-    HAL_TIM_IC_Start_IT(&htim4, TIM_CHANNEL_2); // 启动通道2中断
+    uint32_t i;
+
+    for (i = 0; i < CHANNEL_COUNT; i++) {
+        Receiver_SetCalib(i, &receiverCalib[i]);
+    }
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_TIM_SET_AUTORELOAD(&htim4, 0xFFFF);
+    __HAL_TIM_SET_CAPTUREPOLARITY(&htim4, TIM_CHANNEL_1, TIM_INPUTCHANNELPOLARITY_BOTHEDGE);
+    __HAL_TIM_SET_CAPTUREPOLARITY(&htim4, TIM_CHANNEL_2, TIM_INPUTCHANNELPOLARITY_BOTHEDGE);
+    __HAL_TIM_SET_CAPTUREPOLARITY(&htim4, TIM_CHANNEL_3, TIM_INPUTCHANNELPOLARITY_BOTHEDGE);
+    __HAL_TIM_SET_CAPTUREPOLARITY(&htim4, TIM_CHANNEL_4, TIM_INPUTCHANNELPOLARITY_BOTHEDGE);
+
+#if RECEIVER_CH1_DMA == 1
+    Receiver_StartCaptureDma(&captureDma[CHANNEL1_INDEX], DMA1_Stream0, CHANNEL1_INDEX);
+    __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC1);
+    HAL_TIM_IC_Start(&htim4, TIM_CHANNEL_1);    // 通道1由DMA记录
+#else
+    HAL_TIM_IC_Start_IT(&htim4, TIM_CHANNEL_1); // 通道1由中断记录
+#endif
+    Receiver_StartCaptureDma(&captureDma[CHANNEL2_INDEX], DMA1_Stream3, CHANNEL2_INDEX);
+    __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC2);
+    HAL_TIM_IC_Start(&htim4, TIM_CHANNEL_2);    // 通道2由DMA记录
     HAL_TIM_IC_Start_IT(&htim4, TIM_CHANNEL_3); // 启动通道3中断
     HAL_TIM_IC_Start_IT(&htim4, TIM_CHANNEL_4); // 启动通道4中断
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+    tClockNotifierAdd(&receiverClockNotifier, Receiver_ClockChanged, (void *)0);
+#endif
 }
 
 /**
  * @brief 映射值接口
  * 
- * @return 返回对应通道的映射值
+ * @return 返回对应电机的映射值：各通道杆量相对零点的变化按pwmMix组合
+ * 
+ * 先检查各通道有无新边沿或信号丢失，代数与混控缓存相同时直接返回缓存；否则按缓存的杆量一次算出所有电机的值，
+ * 同一帧内对其余电机的读取都取缓存。混控在临界区内按与代数一致的缓存计算，不会把旧杆量记为新代数。
  */
 float Receiver_GetMappedValue(uint32_t channelIndex) 
 {
-		return pwmMapVal[channelIndex];
-}
\ No newline at end of file
+		uint32_t now = tTaskTickGet();
+		uint32_t i, m, updateTick, status;
+		float stick, value;
+
+		for (i = 0; i < CHANNEL_COUNT; i++) {
+				(void)CalculatePWMWidth(i, now, &updateTick, &stick);
+		}
+		status = tTaskEnterCritical();
+		if (mixGen != receiverGen) {
+				for (m = 0; m < CHANNEL_COUNT; m++) {
+						value = 0.0f;
+						for (i = 0; i < CHANNEL_COUNT; i++) {
+								stick = (staleState & (1u << i)) ? curMapVal[i] : channelStick[i];
+								value += pwmMix[m][i] * (stick - curMapVal[i]);
+						}
+						mixValue[m] = value;
+				}
+				mixGen = receiverGen;
+		}
+		value = mixValue[channelIndex];
+		tTaskExitCritical(status);
+		return value;
+}
+
+/**
+ * @brief 杆量接口
+ * 
+ * @return 返回对应通道映射后的杆量(0 ~ 1)，油门通道从0开始，其余通道中位为0.5；信号丢失或还没有有效信号时返回中位值
+ */
+float Receiver_GetStickValue(uint32_t channelIndex) 
+{
+		uint32_t updateTick;
+		float stick;
+
+		(void)CalculatePWMWidth(channelIndex, tTaskTickGet(), &updateTick, &stick);
+		return stick;
+}
+
+/**
+ * @brief 快照接口
+ * 
+ * 以同一个节拍数读取所有通道，给出杆量、脉宽、最近更新时刻及信号丢失情况。
+ * @return 1有通道丢失信号(失控保护)，0正常
+ */
+uint8_t Receiver_GetSnapshot(ReceiverSnapshot *snap) 
+{
+		uint32_t now = tTaskTickGet();
+		uint32_t i, width;
+
+		snap->staleMask = 0;
+		for (i = 0; i < CHANNEL_COUNT; i++) {
+				width = CalculatePWMWidth(i, now, &snap->lastUpdate[i], &snap->stick[i]);
+				snap->width[i] = (uint16_t)width;
+				if (width == 0) {
+						snap->staleMask |= 1u << i;
+				}
+		}
+		snap->failsafe = (snap->staleMask != 0) ? 1 : 0;
+		return snap->failsafe;
+}
@@ -18,10 +18,27 @@
 #define MAX_MOTORVAL2 1750        // 2最大脉宽值
 #define MIN_MOTORVAL2 1500        // 2最小脉宽值
 
-#define SUB_MOTORVAL14 500        // 14通道脉宽范围的
-#define SUB_MOTORVAL3 1000        // 3通道脉宽范围
-#define SUB_MOTORVAL2 250        // 2通道脉宽范围
+#define RECEIVER_TIMEOUT_MS 100    // 通道超过该时间没有新的边沿视为信号丢失
+#define RECEIVER_CH1_DMA 1         // 1：通道1经DMA1 Stream0记录边沿；0：改为中断记录，让出该数据流给SPI3接收(SpiImu)
+
+// 通道校准：有效脉宽范围(us)，映射为0 ~ 1；上面的MIN/MAX_MOTORVAL为默认值
+typedef struct _ReceiverCalib {
+    uint16_t min;
+    uint16_t max;
+} ReceiverCalib;
+
+// 同一时刻所有通道的快照
+typedef struct _ReceiverSnapshot {
+    float stick[CHANNEL_COUNT];         // 杆量(0 ~ 1)，丢失信号的通道为中位值
+    uint16_t width[CHANNEL_COUNT];      // 脉宽(us)，丢失信号时为0
+    uint32_t lastUpdate[CHANNEL_COUNT]; // 最近一次收到新边沿时的节拍数
+    uint32_t staleMask;                 // 丢失信号的通道，第i位对应通道i+1
+    uint8_t failsafe;                   // 1：有通道丢失信号，应执行失控保护
+} ReceiverSnapshot;
 
 void Receiver_Init(void);        //初始化函数
 float Receiver_GetMappedValue(uint32_t channelIndex); //返回映射值，方便外层调用
+float Receiver_GetStickValue(uint32_t channelIndex); //返回通道的杆量(0 ~ 1)，不经过接收机内部的混控
+void Receiver_SetCalib(uint32_t channelIndex, const ReceiverCalib *calib); //设置通道的脉宽范围，换算系数在此一次算好
+uint8_t Receiver_GetSnapshot(ReceiverSnapshot *snap); //读取所有通道的快照，返回失控保护状态
 #endif // __RECEIVER_H
@@ -0,0 +1,296 @@
+#include "SerialRC.h"
+#include "tinyOS.h"
+#include "tSeqLock.h"
+#include <string.h>
+
+#if SERIALRC_PROTOCOL == SERIALRC_SBUS
+#define SERIALRC_BAUDRATE       100000
+#define SERIALRC_FRAME_MAX      25
+#elif SERIALRC_PROTOCOL == SERIALRC_CRSF
+#define SERIALRC_BAUDRATE       420000
+#define SERIALRC_FRAME_MAX      64
+#elif SERIALRC_PROTOCOL == SERIALRC_IBUS
+#define SERIALRC_BAUDRATE       115200
+#define SERIALRC_FRAME_MAX      32
+#else
+#error "SERIALRC_PROTOCOL不支持"
+#endif
+
+static uint8_t rcFrame[SERIALRC_FRAME_MAX];     // 正在拼接的帧
+static uint32_t rcFrameLen;
+static uint32_t rcErrors;
+static uint32_t rcFrames;
+
+static SerialRCData rcSnapshot[2];
+static tSeqLatch rcLatch = {{0}, {&rcSnapshot[0], &rcSnapshot[1]}, sizeof(rcSnapshot[0])};
+
+/**
+ * @brief 拆出16个11位的通道值(低位在前)，换算为等效脉宽
+ *        SBUS与CRSF的编码相同：172对应约988us，992对应1500us，1811对应约2012us
+ *
+ * @param p 22字节的通道数据
+ * @param data 输出通道
+ *
+ * @return void
+ */
+#if SERIALRC_PROTOCOL != SERIALRC_IBUS
+static void SerialRC_Unpack11(const uint8_t *p, SerialRCData *data) {
+    uint32_t bits = 0;
+    uint32_t n = 0;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        while (n < 11) {
+            bits |= (uint32_t)(*p++) << n;
+            n += 8;
+        }
+        data->channel[i] = (uint16_t)(880 + (((bits & 0x07FF) * 5) >> 3));
+        bits >>= 11;
+        n -= 11;
+    }
+    data->count = 16;
+}
+#endif
+
+#if SERIALRC_PROTOCOL == SERIALRC_CRSF
+// CRC-8/DVB-S2(多项式0xD5)，覆盖类型及负载
+static uint8_t SerialRC_Crc8(const uint8_t *p, uint32_t len) {
+    uint8_t crc = 0;
+    int i;
+
+    while (len--) {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0xD5) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @brief 解出一帧完整的数据，格式或校验错误时计入错误数
+ *
+ * @return 1解出通道数据，0不是通道帧或有错误
+ */
+static uint8_t SerialRC_Decode(SerialRCData *data) {
+#if SERIALRC_PROTOCOL == SERIALRC_SBUS
+    // 0x0F、22字节通道、标志字节、结束字节(0x00，SBUS2为低4位0x4)
+    if ((rcFrame[24] != 0x00) && ((rcFrame[24] & 0x0F) != 0x04)) {
+        rcErrors++;
+        return 0;
+    }
+    SerialRC_Unpack11(&rcFrame[1], data);
+    data->flags = 0;
+    if (rcFrame[23] & 0x04) {
+        data->flags |= SERIALRC_FLAG_FRAME_LOST;
+    }
+    if (rcFrame[23] & 0x08) {
+        data->flags |= SERIALRC_FLAG_FAILSAFE;
+    }
+    return 1;
+#elif SERIALRC_PROTOCOL == SERIALRC_CRSF
+    // 地址、长度(类型+负载+CRC)、类型、负载、CRC
+    uint32_t len = rcFrame[1];
+
+    if (SerialRC_Crc8(&rcFrame[2], len - 1) != rcFrame[len + 1]) {
+        rcErrors++;
+        return 0;
+    }
+    if ((rcFrame[2] != 0x16) || (len != 24)) {
+        return 0;
+    }
+    SerialRC_Unpack11(&rcFrame[3], data);
+    data->flags = 0;
+    return 1;
+#else
+    // 0x20、0x40、14个通道(小端)、校验(0xFFFF减去前30字节之和)
+    uint16_t sum = 0xFFFF;
+    int i;
+
+    for (i = 0; i < 30; i++) {
+        sum -= rcFrame[i];
+    }
+    if (sum != (uint16_t)(rcFrame[30] | (rcFrame[31] << 8))) {
+        rcErrors++;
+        return 0;
+    }
+    for (i = 0; i < 14; i++) {
+        data->channel[i] = (uint16_t)(rcFrame[2 + i * 2] | (rcFrame[3 + i * 2] << 8));
+    }
+    data->count = 14;
+    data->flags = 0;
+    return 1;
+#endif
+}
+
+/**
+ * @brief 解析一个字节
+ *
+ * 按帧头同步拼帧，帧长确定且收齐后校验解码；校验失败时丢弃整帧，从下一个帧头重新同步。
+ *
+ * @param byte 收到的字节
+ * @param data 解出完整的一帧时写入的通道数据，其它字段不改动
+ *
+ * @return 1解出一帧，0需要更多字节
+ */
+uint8_t SerialRC_Parse(uint8_t byte, SerialRCData *data) {
+    uint32_t need;
+
+    if (rcFrameLen == 0) {
+#if SERIALRC_PROTOCOL == SERIALRC_SBUS
+        if (byte != 0x0F) {
+            return 0;
+        }
+#elif SERIALRC_PROTOCOL == SERIALRC_CRSF
+        if ((byte != 0xC8) && (byte != 0xEE) && (byte != 0xEA)) {
+            return 0;
+        }
+#else
+        if (byte != 0x20) {
+            return 0;
+        }
+#endif
+    }
+    rcFrame[rcFrameLen++] = byte;
+
+#if SERIALRC_PROTOCOL == SERIALRC_SBUS
+    need = SERIALRC_FRAME_MAX;
+#elif SERIALRC_PROTOCOL == SERIALRC_CRSF
+    if (rcFrameLen < 2) {
+        return 0;
+    }
+    need = rcFrame[1] + 2u;
+    if ((rcFrame[1] < 2) || (need > SERIALRC_FRAME_MAX)) {
+        rcFrameLen = 0;
+        rcErrors++;
+        return 0;
+    }
+#else
+    if ((rcFrameLen == 2) && (byte != 0x40)) {
+        rcFrameLen = 0;
+        return 0;
+    }
+    need = SERIALRC_FRAME_MAX;
+#endif
+    if (rcFrameLen < need) {
+        return 0;
+    }
+    rcFrameLen = 0;
+    return SerialRC_Decode(data);
+}
+
+static UART_HandleTypeDef rcUart;
+static DMA_HandleTypeDef rcDma;
+static uint8_t rcDmaBuf[SERIALRC_DMA_SIZE];
+static uint32_t rcDmaPos;
+
+static tTask rcTask;
+static tTaskStack rcTaskStack[SERIALRC_STACK_SIZE];
+
+// 取出DMA缓冲区中的新字节并解析，解出的帧立即发布
+static void SerialRC_Drain(void) {
+    SerialRCData data;
+    uint32_t pos = SERIALRC_DMA_SIZE - __HAL_DMA_GET_COUNTER(&rcDma);
+
+    if (pos == SERIALRC_DMA_SIZE) {
+        pos = 0;
+    }
+    while (rcDmaPos != pos) {
+        if (SerialRC_Parse(rcDmaBuf[rcDmaPos], &data)) {
+            data.timestamp = tTaskTickGet();
+            data.frames = ++rcFrames;
+            tSeqLatchWrite(&rcLatch, &data);
+        }
+        rcDmaPos = (rcDmaPos + 1) % SERIALRC_DMA_SIZE;
+    }
+}
+
+static void SerialRC_Entry(void *param) {
+    uint32_t lastWakeTick = tTaskTickGet();
+
+    (void)param;
+    for (;;) {
+        tTaskDelayUntil(&lastWakeTick, SERIALRC_PERIOD_TICKS);
+        SerialRC_Drain();
+    }
+}
+
+/**
+ * @brief 配置USART2只接收及其循环DMA，创建解析任务
+ *
+ * 串口及DMA都不开中断，溢出等错误不影响DMA继续接收，错误的帧由校验丢弃。
+ */
+void SerialRC_Init(void) {
+    GPIO_InitTypeDef gpio = {0};
+
+    memset(rcSnapshot, 0, sizeof(rcSnapshot));
+    rcSnapshot[0].flags = SERIALRC_FLAG_NO_DATA;
+    rcSnapshot[1].flags = SERIALRC_FLAG_NO_DATA;
+    rcFrameLen = 0;
+    rcDmaPos = 0;
+
+    __HAL_RCC_USART2_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    gpio.Pin = GPIO_PIN_3;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    gpio.Alternate = GPIO_AF7_USART2;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    rcUart.Instance = USART2;
+    rcUart.Init.BaudRate = SERIALRC_BAUDRATE;
+#if SERIALRC_PROTOCOL == SERIALRC_SBUS
+    rcUart.Init.WordLength = UART_WORDLENGTH_9B;    // 8位数据加偶校验
+    rcUart.Init.StopBits = UART_STOPBITS_2;
+    rcUart.Init.Parity = UART_PARITY_EVEN;
+#else
+    rcUart.Init.WordLength = UART_WORDLENGTH_8B;
+    rcUart.Init.StopBits = UART_STOPBITS_1;
+    rcUart.Init.Parity = UART_PARITY_NONE;
+#endif
+    rcUart.Init.Mode = UART_MODE_RX;
+    rcUart.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    rcUart.Init.OverSampling = UART_OVERSAMPLING_16;
+    HAL_UART_Init(&rcUart);
+
+    rcDma.Instance = DMA1_Stream5;
+    rcDma.Init.Channel = DMA_CHANNEL_4;
+    rcDma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    rcDma.Init.PeriphInc = DMA_PINC_DISABLE;
+    rcDma.Init.MemInc = DMA_MINC_ENABLE;
+    rcDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    rcDma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    rcDma.Init.Mode = DMA_CIRCULAR;
+    rcDma.Init.Priority = DMA_PRIORITY_MEDIUM;
+    rcDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&rcDma);
+    __HAL_LINKDMA(&rcUart, hdmarx, rcDma);
+    HAL_UART_Receive_DMA(&rcUart, rcDmaBuf, SERIALRC_DMA_SIZE);
+
+    tTaskInit(&rcTask, SerialRC_Entry, (void *)0, SERIALRC_PRIO, rcTaskStack, sizeof(rcTaskStack));
+    tObjectSetName(&rcTask.object, "serialrc");
+}
+
+/**
+ * @brief 读取最新的通道数据
+ *
+ * @param data 通道数据快照，超过SERIALRC_TIMEOUT_MS没有新帧时附加SERIALRC_FLAG_STALE
+ *
+ * @return 0数据有效；1尚未收到、信号丢失或接收机处于失控保护，调用者应执行失控处理
+ */
+uint8_t SerialRC_Read(SerialRCData *data) {
+    tSeqLatchRead(&rcLatch, data);
+    if (!(data->flags & SERIALRC_FLAG_NO_DATA) &&
+        ((tTaskTickGet() - data->timestamp) > tTimeMsToTicks(SERIALRC_TIMEOUT_MS))) {
+        data->flags |= SERIALRC_FLAG_STALE;
+    }
+    return (data->flags & (SERIALRC_FLAG_FAILSAFE | SERIALRC_FLAG_STALE | SERIALRC_FLAG_NO_DATA)) ? 1 : 0;
+}
+
+uint32_t SerialRC_Errors(void) {
+    return rcErrors;
+}
@@ -0,0 +1,39 @@
+#ifndef __SERIALRC_H
+#define __SERIALRC_H
+
+#include "main.h"
+
+// 串行接收机：USART2(PA3，只接收)经DMA1 Stream5循环接收，不开启任何中断；解析任务按固定周期
+// 取出DMA缓冲区中的新字节逐字节解析，解出完整的一帧后连同时间戳、失控标志经双缓冲顺序锁发布
+#define SERIALRC_SBUS           0   // 100000波特率，8E2，信号反相，F401的串口不能反相接收，需外接反相器
+#define SERIALRC_CRSF           1   // 420000波特率，8N1，只解析RC通道帧(0x16)
+#define SERIALRC_IBUS           2   // 115200波特率，8N1
+#define SERIALRC_PROTOCOL       SERIALRC_SBUS
+
+#define SERIALRC_MAX_CHANNELS   16  // SBUS、CRSF为16通道，iBUS为14通道
+#define SERIALRC_DMA_SIZE       128 // DMA循环接收缓冲区大小，需大于一个解析周期内收到的字节数(CRSF约42字节/ms)
+#define SERIALRC_PERIOD_TICKS   1   // 解析周期(节拍)
+#define SERIALRC_TIMEOUT_MS     100 // 超过该时间没有收到完整的帧视为信号丢失
+#define SERIALRC_STACK_SIZE     128 // 解析任务栈(字)
+#define SERIALRC_PRIO           3   // 解析只取出几十个字节，优先级高于控制任务以降低输入延迟
+
+// 通道数据的标志
+#define SERIALRC_FLAG_FRAME_LOST    (1 << 0)    // 接收机报告丢帧(SBUS)
+#define SERIALRC_FLAG_FAILSAFE      (1 << 1)    // 接收机报告进入失控保护(SBUS)
+#define SERIALRC_FLAG_STALE         (1 << 2)    // 超过SERIALRC_TIMEOUT_MS没有新帧，读取时判断
+#define SERIALRC_FLAG_NO_DATA       (1 << 3)    // 尚未收到过完整的帧
+
+typedef struct _SerialRCData {
+    uint16_t channel[SERIALRC_MAX_CHANNELS];    // 各通道的等效脉宽(us)，约1000~2000
+    uint8_t count;                              // 有效通道数
+    uint8_t flags;                              // SERIALRC_FLAG_xxx
+    uint32_t timestamp;                         // 解出该帧时的节拍数
+    uint32_t frames;                            // 累计解出的帧数
+} SerialRCData;
+
+void SerialRC_Init(void);                   // 配置USART2及DMA，创建解析任务
+uint8_t SerialRC_Read(SerialRCData *data);  // 读取最新的通道数据，正常返回0，失控、丢失或没有数据时返回1
+uint32_t SerialRC_Errors(void);             // 校验错误或格式错误而丢弃的帧数
+uint8_t SerialRC_Parse(uint8_t byte, SerialRCData *data); // 解析一个字节，解出完整的一帧时填写data并返回1，不依赖硬件
+
+#endif // __SERIALRC_H
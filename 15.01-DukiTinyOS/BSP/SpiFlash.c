@@ -0,0 +1,217 @@
+#include "SpiFlash.h"
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_SEM == 1
+
+#define SPIFLASH_CMD_WRITE_ENABLE   0x06
+#define SPIFLASH_CMD_READ_STATUS    0x05
+#define SPIFLASH_CMD_READ_DATA      0x03
+#define SPIFLASH_CMD_PAGE_PROGRAM   0x02
+#define SPIFLASH_CMD_SECTOR_ERASE   0x20
+#define SPIFLASH_CMD_JEDEC_ID       0x9F
+#define SPIFLASH_STATUS_BUSY        0x01
+
+#define SPIFLASH_CS_PORT            GPIOA
+#define SPIFLASH_CS_PIN             GPIO_PIN_4
+#define SPIFLASH_DMA                DMA2_Stream3
+#define SPIFLASH_DMA_IRQn           DMA2_Stream3_IRQn
+
+static tSem spiFlashDmaSem;     // DMA发送完成
+static uint32_t spiFlashSize;
+
+static void SpiFlash_Select(void)
+{
+    SPIFLASH_CS_PORT->BSRR = (uint32_t)SPIFLASH_CS_PIN << 16;
+}
+
+static void SpiFlash_Deselect(void)
+{
+    // 等待最后一个字节移出后再拉高片选
+    while (!(SPI1->SR & SPI_SR_TXE)) {
+    }
+    while (SPI1->SR & SPI_SR_BSY) {
+    }
+    SPIFLASH_CS_PORT->BSRR = SPIFLASH_CS_PIN;
+}
+
+// 收发一个字节
+static uint8_t SpiFlash_Transfer(uint8_t value)
+{
+    while (!(SPI1->SR & SPI_SR_TXE)) {
+    }
+    *(volatile uint8_t *)&SPI1->DR = value;
+    while (!(SPI1->SR & SPI_SR_RXNE)) {
+    }
+    return *(volatile uint8_t *)&SPI1->DR;
+}
+
+static void SpiFlash_SendAddr(uint8_t cmd, uint32_t addr)
+{
+    SpiFlash_Transfer(cmd);
+    SpiFlash_Transfer((uint8_t)(addr >> 16));
+    SpiFlash_Transfer((uint8_t)(addr >> 8));
+    SpiFlash_Transfer((uint8_t)addr);
+}
+
+static void SpiFlash_WriteEnable(void)
+{
+    SpiFlash_Select();
+    SpiFlash_Transfer(SPIFLASH_CMD_WRITE_ENABLE);
+    SpiFlash_Deselect();
+}
+
+// 等待编程或擦除完成：页编程约0.7ms，扇区擦除约45ms，每次查询之间延时一个节拍让出CPU
+static void SpiFlash_WaitReady(void)
+{
+    uint8_t status;
+
+    for (;;) {
+        SpiFlash_Select();
+        SpiFlash_Transfer(SPIFLASH_CMD_READ_STATUS);
+        status = SpiFlash_Transfer(0xFF);
+        SpiFlash_Deselect();
+        if (!(status & SPIFLASH_STATUS_BUSY)) {
+            return;
+        }
+        tTaskDelay(1);
+    }
+}
+
+/**
+ * @brief 配置SPI1及其发送DMA，读取JEDEC ID识别芯片容量
+ *
+ * @return 0识别到芯片；1没有应答(ID全0或全1)
+ */
+uint8_t SpiFlash_Init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    uint8_t id[3];
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_SPI1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    gpio.Pin = GPIO_PIN_5 | GPIO_PIN_6 | GPIO_PIN_7;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF5_SPI1;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    SPIFLASH_CS_PORT->BSRR = SPIFLASH_CS_PIN;
+    gpio.Pin = SPIFLASH_CS_PIN;
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Alternate = 0;
+    HAL_GPIO_Init(SPIFLASH_CS_PORT, &gpio);
+
+    // 主机，软件片选，APB2(84MHz) 4分频
+    SPI1->CR1 = 0;
+    SPI1->CR2 = 0;
+    SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_BR_0;
+    SPI1->CR1 |= SPI_CR1_SPE;
+
+    // DMA2 Stream3通道3为SPI1_TX：存储器到外设，字节宽度，只开传输完成中断
+    SPIFLASH_DMA->CR = 0;
+    while (SPIFLASH_DMA->CR & DMA_SxCR_EN) {
+    }
+    SPIFLASH_DMA->PAR = (uint32_t)&SPI1->DR;
+    SPIFLASH_DMA->CR = (3u << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_DIR_0 | DMA_SxCR_TCIE;
+    SPIFLASH_DMA->FCR = 0;
+
+    tSemInit(&spiFlashDmaSem, 0, 1);
+    tObjectSetName(&spiFlashDmaSem.event.object, "spiflash.dma");
+    HAL_NVIC_SetPriority(SPIFLASH_DMA_IRQn, TINYOS_MAX_SYSCALL_PRIO, 0);//中断中释放信号量，优先级不能高于TINYOS_MAX_SYSCALL_PRIO
+    HAL_NVIC_EnableIRQ(SPIFLASH_DMA_IRQn);
+
+    SpiFlash_Select();
+    SpiFlash_Transfer(SPIFLASH_CMD_JEDEC_ID);
+    id[0] = SpiFlash_Transfer(0xFF);
+    id[1] = SpiFlash_Transfer(0xFF);
+    id[2] = SpiFlash_Transfer(0xFF);
+    SpiFlash_Deselect();
+
+    // 第三个字节为容量的以2为底的对数，W25Q128为0x18
+    if ((id[0] == 0x00) || (id[0] == 0xFF) || (id[2] < 16) || (id[2] > 25)) {
+        spiFlashSize = 0;
+        return 1;
+    }
+    spiFlashSize = 1ul << id[2];
+    return 0;
+}
+
+uint32_t SpiFlash_GetSize(void)
+{
+    return spiFlashSize;
+}
+
+uint8_t SpiFlash_Read(uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    uint32_t i;
+
+    SpiFlash_Select();
+    SpiFlash_SendAddr(SPIFLASH_CMD_READ_DATA, addr);
+    for (i = 0; i < len; i++) {
+        buf[i] = SpiFlash_Transfer(0xFF);
+    }
+    SpiFlash_Deselect();
+    return 0;
+}
+
+uint8_t SpiFlash_EraseSector(uint32_t addr)
+{
+    SpiFlash_WriteEnable();
+    SpiFlash_Select();
+    SpiFlash_SendAddr(SPIFLASH_CMD_SECTOR_ERASE, addr & ~(SPIFLASH_SECTOR_SIZE - 1u));
+    SpiFlash_Deselect();
+    SpiFlash_WaitReady();
+    return 0;
+}
+
+/**
+ * @brief 页编程：命令及地址轮询发送，数据经DMA发送，期间调用任务等待信号量
+ *
+ * 只开发送DMA，移入的字节不读取，结束后读一次DR、SR清除溢出标志。
+ *
+ * @param addr 起始地址，addr到addr + len - 1须在同一页内
+ * @param data 数据，传输期间不能修改
+ * @param len 字节数，1 ~ SPIFLASH_PAGE_SIZE
+ *
+ * @return 0成功；1参数错误
+ */
+uint8_t SpiFlash_WritePage(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if ((len == 0) || (((addr & (SPIFLASH_PAGE_SIZE - 1u)) + len) > SPIFLASH_PAGE_SIZE)) {
+        return 1;
+    }
+
+    SpiFlash_WriteEnable();
+    SpiFlash_Select();
+    SpiFlash_SendAddr(SPIFLASH_CMD_PAGE_PROGRAM, addr);
+
+    DMA2->LIFCR = DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+    SPIFLASH_DMA->M0AR = (uint32_t)data;
+    SPIFLASH_DMA->NDTR = len;
+    SPIFLASH_DMA->CR |= DMA_SxCR_EN;
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+    tSemWait(&spiFlashDmaSem, 0);
+    SPI1->CR2 &= ~SPI_CR2_TXDMAEN;
+
+    SpiFlash_Deselect();
+    (void)SPI1->DR;
+    (void)SPI1->SR;
+    SpiFlash_WaitReady();
+    return 0;
+}
+
+void DMA2_Stream3_IRQHandler(void)
+{
+    tIrqStatEnter();
+    if (DMA2->LISR & DMA_LISR_TCIF3) {
+        DMA2->LIFCR = DMA_LIFCR_CTCIF3;
+        tSemNotifyFromISR(&spiFlashDmaSem);
+    }
+    tIrqStatExit();
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef __SPIFLASH_H
+#define __SPIFLASH_H
+
+#include "main.h"
+
+// W25Qxx系列SPI NOR Flash：SPI1(PA5 SCK、PA6 MISO、PA7 MOSI，PA4片选)，模式0，21MHz；
+// 页编程的数据经DMA2 Stream3(通道3)发送，调用任务在传输及编程期间让出CPU，其余命令轮询完成；
+// 所有函数只能在任务中调用，且同一时刻只能有一个任务使用，需开启TINYOS_ENABLE_SEM
+#define SPIFLASH_PAGE_SIZE      256     // 页编程的最大长度，不能跨页
+#define SPIFLASH_SECTOR_SIZE    4096    // 最小擦除单位
+
+uint8_t SpiFlash_Init(void);        // 配置SPI1及DMA并读取JEDEC ID，识别到芯片时返回0
+uint32_t SpiFlash_GetSize(void);    // 芯片容量(字节)，由JEDEC ID得出，未识别时为0
+uint8_t SpiFlash_Read(uint32_t addr, uint8_t *buf, uint32_t len); // 读取任意长度，返回0
+uint8_t SpiFlash_EraseSector(uint32_t addr); // 擦除addr所在的扇区，等待擦除完成，返回0
+uint8_t SpiFlash_WritePage(uint32_t addr, const uint8_t *data, uint32_t len); // 编程一页内的数据(需已擦除)，等待编程完成，返回0
+
+#endif // __SPIFLASH_H
@@ -0,0 +1,263 @@
+#include "SpiImu.h"
+#include "Receiver.h"
+
+#if SPI_IMU_ENABLE == 1
+
+#if TINYOS_ENABLE_SEM == 0
+#error "SPI_IMU_ENABLE requires TINYOS_ENABLE_SEM"
+#endif
+#if RECEIVER_CH1_DMA == 1
+#error "SPI_IMU_ENABLE requires RECEIVER_CH1_DMA 0: DMA1 Stream0 is the SPI3 RX stream"
+#endif
+
+#define SPI_IMU_READ            0x80    // 寄存器地址最高位为1表示读
+#define SPI_IMU_BR_FAST         SPI_CR1_BR_0                    // 4分频，10.5MHz
+#define SPI_IMU_BR_SLOW         (SPI_CR1_BR_2 | SPI_CR1_BR_0)   // 64分频，656kHz
+#define SPI_IMU_RX_DMA          DMA1_Stream0
+#define SPI_IMU_TX_DMA          DMA1_Stream5
+#define SPI_IMU_RX_DMA_IRQn     DMA1_Stream0_IRQn
+
+SpiImuBus spiImuBus0 = {GPIOA, GPIO_PIN_15};
+
+static SpiImuBus * volatile spiImuActive;  // 占用总线的实例，0为空闲
+static uint8_t spiImuHwReady;
+static uint32_t spiImuBr = SPI_IMU_BR_SLOW;
+static uint8_t spiImuZero;                  // 读取期间发送DMA反复送出的字节
+
+// 占用总线，已被占用时返回1；任务、中断都可调用
+static uint8_t SpiImu_Claim(SpiImuBus *bus)
+{
+    uint32_t status = tTaskEnterCritical();
+    uint8_t busy = (spiImuActive != 0);
+
+    if (!busy) {
+        spiImuActive = bus;
+    }
+    tTaskExitCritical(status);
+    return busy;
+}
+
+// 任务中等待占用总线：进行中的传输由中断结束，最长十几微秒，不让出CPU
+static void SpiImu_ClaimWait(SpiImuBus *bus)
+{
+    while (SpiImu_Claim(bus)) {
+    }
+}
+
+// 切换波特率，须在占用总线且没有传输时调用；BR只能在SPE为0时修改
+static void SpiImu_SetBr(uint32_t br)
+{
+    if (br == spiImuBr) {
+        return;
+    }
+    SPI3->CR1 &= ~SPI_CR1_SPE;
+    SPI3->CR1 = (SPI3->CR1 & ~SPI_CR1_BR) | br;
+    SPI3->CR1 |= SPI_CR1_SPE;
+    spiImuBr = br;
+}
+
+static void SpiImu_Deselect(SpiImuBus *bus)
+{
+    // 等待最后一个字节移出后再拉高片选
+    while (!(SPI3->SR & SPI_SR_TXE)) {
+    }
+    while (SPI3->SR & SPI_SR_BSY) {
+    }
+    bus->csPort->BSRR = bus->csPin;
+}
+
+// 收发一个字节
+static uint8_t SpiImu_Transfer(uint8_t value)
+{
+    while (!(SPI3->SR & SPI_SR_TXE)) {
+    }
+    *(volatile uint8_t *)&SPI3->DR = value;
+    while (!(SPI3->SR & SPI_SR_RXNE)) {
+    }
+    return *(volatile uint8_t *)&SPI3->DR;
+}
+
+/**
+ * @brief 配置SPI3、两路DMA及该实例的片选，SPI3及DMA只配置一次
+ *
+ * @param bus 器件实例
+ *
+ * @return 0
+ */
+uint8_t SpiImu_Init(SpiImuBus *bus)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    if (bus->ready) {
+        return 0;
+    }
+    if (!spiImuHwReady) {
+        __HAL_RCC_GPIOC_CLK_ENABLE();
+        __HAL_RCC_SPI3_CLK_ENABLE();
+        __HAL_RCC_DMA1_CLK_ENABLE();
+
+        gpio.Pin = GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12;
+        gpio.Mode = GPIO_MODE_AF_PP;
+        gpio.Pull = GPIO_PULLUP;
+        gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+        gpio.Alternate = GPIO_AF6_SPI3;
+        HAL_GPIO_Init(GPIOC, &gpio);
+
+        // 主机，软件片选，模式3，先以低速配置寄存器
+        SPI3->CR1 = 0;
+        SPI3->CR2 = 0;
+        SPI3->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_IMU_BR_SLOW;
+        SPI3->CR1 |= SPI_CR1_SPE;
+        spiImuBr = SPI_IMU_BR_SLOW;
+
+        // DMA1 Stream0通道0为SPI3_RX：外设到存储器，开传输完成及错误中断；Stream5通道0为SPI3_TX：地址不递增，不开中断
+        SPI_IMU_RX_DMA->CR = 0;
+        SPI_IMU_TX_DMA->CR = 0;
+        while ((SPI_IMU_RX_DMA->CR & DMA_SxCR_EN) || (SPI_IMU_TX_DMA->CR & DMA_SxCR_EN)) {
+        }
+        SPI_IMU_RX_DMA->PAR = (uint32_t)&SPI3->DR;
+        SPI_IMU_RX_DMA->CR = DMA_SxCR_MINC | DMA_SxCR_PL_1 | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+        SPI_IMU_RX_DMA->FCR = 0;
+        SPI_IMU_TX_DMA->PAR = (uint32_t)&SPI3->DR;
+        SPI_IMU_TX_DMA->M0AR = (uint32_t)&spiImuZero;
+        SPI_IMU_TX_DMA->CR = DMA_SxCR_DIR_0 | DMA_SxCR_PL_1;
+        SPI_IMU_TX_DMA->FCR = 0;
+
+        HAL_NVIC_SetPriority(SPI_IMU_RX_DMA_IRQn, SPI_IMU_IRQ_PRIO, 0);
+        HAL_NVIC_EnableIRQ(SPI_IMU_RX_DMA_IRQn);
+        spiImuHwReady = 1;
+    }
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    bus->csPort->BSRR = bus->csPin;
+    gpio.Pin = bus->csPin;
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = 0;
+    HAL_GPIO_Init(bus->csPort, &gpio);
+
+    tSemInit(&bus->sem, 0, 1);
+    tObjectSetName(&bus->sem.event.object, "spiimu");
+    bus->ready = 1;
+    return 0;
+}
+
+/**
+ * @brief 低速轮询写一个配置寄存器
+ *
+ * @param bus 器件实例
+ * @param reg 寄存器地址
+ * @param data 写入的数据
+ *
+ * @return 0
+ */
+uint8_t SpiImu_WriteReg(SpiImuBus *bus, uint8_t reg, uint8_t data)
+{
+    SpiImu_ClaimWait(bus);
+    SpiImu_SetBr(SPI_IMU_BR_SLOW);
+    bus->csPort->BSRR = (uint32_t)bus->csPin << 16;
+    SpiImu_Transfer(reg & (uint8_t)~SPI_IMU_READ);
+    SpiImu_Transfer(data);
+    SpiImu_Deselect(bus);
+    spiImuActive = 0;
+    return 0;
+}
+
+// 已占用总线时启动一次读取：地址由CPU送出并丢弃移入的字节，之后接收、发送DMA各传输len字节
+static void SpiImu_Start(SpiImuBus *bus, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    SpiImu_SetBr(SPI_IMU_FAST_REG(reg) ? SPI_IMU_BR_FAST : SPI_IMU_BR_SLOW);
+    bus->csPort->BSRR = (uint32_t)bus->csPin << 16;
+    SpiImu_Transfer(reg | SPI_IMU_READ);
+
+    DMA1->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+    DMA1->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+    SPI_IMU_RX_DMA->M0AR = (uint32_t)buf;
+    SPI_IMU_RX_DMA->NDTR = len;
+    SPI_IMU_TX_DMA->NDTR = len;
+    // 先开接收请求，再开发送，第一个字节移入时接收DMA已就绪
+    SPI3->CR2 |= SPI_CR2_RXDMAEN;
+    SPI_IMU_RX_DMA->CR |= DMA_SxCR_EN;
+    SPI_IMU_TX_DMA->CR |= DMA_SxCR_EN;
+    SPI3->CR2 |= SPI_CR2_TXDMAEN;
+}
+
+/**
+ * @brief 启动一次DMA读取后立即返回，完成后在DMA中断中拉高片选并调用done
+ *
+ * @param bus 器件实例
+ * @param reg 起始寄存器地址，数据及FIFO寄存器以10.5MHz读取，其余以低速读取
+ * @param buf 接收缓冲区，DMA直接写入，完成前不能读取
+ * @param len 字节数，1 ~ 65535
+ * @param done 完成回调，status为0表示成功，可为0
+ * @param param 传给回调的参数
+ *
+ * @return 0已启动；1总线上有进行中的传输或参数错误
+ */
+uint8_t SpiImu_StartRead(SpiImuBus *bus, uint8_t reg, uint8_t *buf, uint16_t len,
+                         void (*done)(void *param, uint8_t status), void *param)
+{
+    if ((len == 0) || SpiImu_Claim(bus)) {
+        return 1;
+    }
+    bus->done = done;
+    bus->param = param;
+    SpiImu_Start(bus, reg, buf, len);
+    return 0;
+}
+
+static void SpiImu_ReadDone(void *param, uint8_t status)
+{
+    SpiImuBus *bus = (SpiImuBus *)param;
+
+    bus->status = status;
+    tSemNotifyFromISR(&bus->sem);
+}
+
+/**
+ * @brief 经DMA读取，调用任务等待期间让出CPU；中断中启动的采样进行中时先等待其结束
+ *
+ * @return 0成功；1参数错误或DMA错误
+ */
+uint8_t SpiImu_Read(SpiImuBus *bus, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    if (len == 0) {
+        return 1;
+    }
+    SpiImu_ClaimWait(bus);
+    bus->done = SpiImu_ReadDone;
+    bus->param = bus;
+    SpiImu_Start(bus, reg, buf, len);
+    tSemWait(&bus->sem, 0);
+    return bus->status;
+}
+
+// 接收完成时最后一个字节已移入，发送DMA早已结束；关闭DMA请求、拉高片选后释放总线再回调，回调中可以启动下一次读取
+void DMA1_Stream0_IRQHandler(void)
+{
+    SpiImuBus *bus = spiImuActive;
+    uint32_t isr = DMA1->LISR;
+    uint8_t status;
+    void (*done)(void *param, uint8_t status);
+
+    tIrqStatEnter();
+    if (isr & (DMA_LISR_TCIF0 | DMA_LISR_TEIF0)) {
+        DMA1->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+        status = (isr & DMA_LISR_TEIF0) ? 1 : 0;
+        SPI_IMU_RX_DMA->CR &= ~DMA_SxCR_EN;
+        SPI_IMU_TX_DMA->CR &= ~DMA_SxCR_EN;
+        SPI3->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        if (bus != 0) {
+            SpiImu_Deselect(bus);
+            done = bus->done;
+            spiImuActive = 0;
+            if (done != 0) {
+                done(bus->param, status);
+            }
+        }
+    }
+    tIrqStatExit();
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __SPIIMU_H
+#define __SPIIMU_H
+
+#include "main.h"
+#include "tinyOS.h"
+
+// SPI接口的MPU6000/ICM-20602类IMU：SPI3(PC10 SCK、PC11 MISO、PC12 MOSI)，模式3，PA15片选。
+// 配置寄存器限1MHz，按APB1(42MHz) 64分频轮询写入；数据、状态及FIFO寄存器可到20MHz，按4分频(10.5MHz)
+// 经DMA全双工读取：接收DMA1 Stream0(通道0)直接写入调用者的缓冲区，发送DMA1 Stream5(通道0)反复送出同一个0字节，
+// 寄存器地址由CPU先行送出。接收完成中断中等待移位结束、拉高片选后回调，14字节一次采样在总线上约12us，
+// 8kHz时总线占用约10%，不经过任务切换。
+// 需RECEIVER_CH1_DMA为0(让出DMA1 Stream0)，且不能使用SerialRC(DMA1 Stream5)，需开启TINYOS_ENABLE_SEM
+#define SPI_IMU_ENABLE          0
+#define SPI_IMU_IRQ_PRIO        TINYOS_MAX_SYSCALL_PRIO // 回调中会释放信号量，不能高于TINYOS_MAX_SYSCALL_PRIO
+
+// 可高速读取的寄存器：INT_STATUS至USER_CTRL之前的数据寄存器，及FIFO计数与读写寄存器
+#define SPI_IMU_FAST_REG(reg)   ((((reg) >= 0x3A) && ((reg) <= 0x60)) || (((reg) >= 0x72) && ((reg) <= 0x74)))
+
+// 一个片选上的器件：片选引脚及进行中传输的状态，总线本身(SPI3及两路DMA)由所有实例共用，同一时刻只有一个传输
+typedef struct _SpiImuBus {
+    GPIO_TypeDef *csPort;
+    uint16_t csPin;
+    void (*done)(void *param, uint8_t status); // 进行中传输的完成回调，在DMA中断中调用
+    void *param;
+    tSem sem;                   // SpiImu_Read等待完成
+    volatile uint8_t status;    // SpiImu_Read的结果，0成功
+    uint8_t ready;              // 已初始化
+} SpiImuBus;
+
+#if SPI_IMU_ENABLE == 1
+extern SpiImuBus spiImuBus0;    // PA15片选上的IMU
+
+uint8_t SpiImu_Init(SpiImuBus *bus);    // 配置SPI3、DMA及片选，可重复调用，返回0
+uint8_t SpiImu_WriteReg(SpiImuBus *bus, uint8_t reg, uint8_t data); // 低速轮询写一个寄存器，只能在任务中调用
+uint8_t SpiImu_Read(SpiImuBus *bus, uint8_t reg, uint8_t *buf, uint16_t len); // 经DMA读取，调用任务等待完成
+uint8_t SpiImu_StartRead(SpiImuBus *bus, uint8_t reg, uint8_t *buf, uint16_t len,
+                         void (*done)(void *param, uint8_t status), void *param); // 启动DMA读取后立即返回，可在中断中调用
+#endif
+
+#endif // __SPIIMU_H
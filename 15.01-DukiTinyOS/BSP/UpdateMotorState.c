@@ -1,16 +1,30 @@
 #include "UpdateMotorState.h"
 #include "Receiver.h"
 #include "Motor.h"
+#include "Mixer.h"
+
+#if MIXER_MOTOR_COUNT > MOTOR_COUNT
+#error "混控的电机数超过TIM3的PWM通道数"
+#endif
 
 void UpdateMotorState(void) {
-	for(int i = 0;i < CHANNEL_COUNT;i++) {
-		// 从接收机获取映射值 (0 ~ 1.0)
-			float mappedValue = Receiver_GetMappedValue(i);
+	float motor[MIXER_MOTOR_COUNT];
+	float motorDuty[MOTOR_COUNT];
+	int i;
 
-			// 将映射值转化为占空比 (0.05 ~ 1.0)
-			float motorDuty = 0.05 * mappedValue + 0.05; // 映射到占空比范围
+	// 从接收机获取杆量：通道2为油门，其余通道以0.5为中位
+	Mixer_Mix(Receiver_GetStickValue(CHANNEL2_INDEX),
+	          Receiver_GetStickValue(CHANNEL4_INDEX) - 0.5f,   // 横滚
+	          Receiver_GetStickValue(CHANNEL3_INDEX) - 0.5f,   // 俯仰
+	          Receiver_GetStickValue(CHANNEL1_INDEX) - 0.5f,   // 偏航
+	          motor);
 
-			// 更新电机状态
-			Motor_SetPulse(i + 1, motorDuty); // 电机通道从1开始，+1偏移
+	// 相对推力经推力曲线换算为油门指令(需已调用Mixer_Init)，再转化为占空比 (0.05 ~ 0.1)
+	Mixer_Output(motor, 1.0f);
+	for (i = 0; i < MOTOR_COUNT; i++) {
+		motorDuty[i] = (i < MIXER_MOTOR_COUNT) ? (0.05f * motor[i] + 0.05f) : 0.05f;
 	}
-}
\ No newline at end of file
+
+	// 全部通道一次更新
+	Motor_SetAll(motorDuty);
+}
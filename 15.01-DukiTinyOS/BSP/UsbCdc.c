@@ -0,0 +1,629 @@
+#include "UsbCdc.h"
+#include "tinyOS.h"
+#include "MySerial.h"
+#include <string.h>
+
+#if USBCDC_ENABLE == 1
+
+#if (TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_STREAM == 0)
+#error "USBCDC_ENABLE requires TINYOS_ENABLE_SEM and TINYOS_ENABLE_STREAM"
+#endif
+#if (USBCDC_TX_BUF_SIZE % 64) != 0
+#error "USBCDC_TX_BUF_SIZE must be a multiple of 64"
+#endif
+#if USBCDC_IRQ_PRIO < TINYOS_MAX_SYSCALL_PRIO
+#error "USBCDC_IRQ_PRIO must not be above TINYOS_MAX_SYSCALL_PRIO"
+#endif
+
+#define USBCDC_EP0_SIZE         64
+#define USBCDC_DATA_SIZE        64      // 全速批量端点的包长
+#define USBCDC_NOTIFY_SIZE      8
+#define USBCDC_EP_DATA_OUT      0x01
+#define USBCDC_EP_DATA_IN       0x81
+#define USBCDC_EP_NOTIFY        0x82
+
+// 标准请求及CDC类请求
+#define USB_REQ_GET_STATUS          0x00
+#define USB_REQ_CLEAR_FEATURE       0x01
+#define USB_REQ_SET_FEATURE         0x03
+#define USB_REQ_SET_ADDRESS         0x05
+#define USB_REQ_GET_DESCRIPTOR      0x06
+#define USB_REQ_GET_CONFIGURATION   0x08
+#define USB_REQ_SET_CONFIGURATION   0x09
+#define USB_REQ_GET_INTERFACE       0x0A
+#define USB_REQ_SET_INTERFACE       0x0B
+#define CDC_REQ_SET_LINE_CODING     0x20
+#define CDC_REQ_GET_LINE_CODING     0x21
+#define CDC_REQ_SET_CONTROL_LINE    0x22
+#define CDC_REQ_SEND_BREAK          0x23
+
+// 控制传输的阶段
+#define USBCDC_EP0_IDLE         0
+#define USBCDC_EP0_DATA_IN      1
+#define USBCDC_EP0_DATA_OUT     2
+#define USBCDC_EP0_STATUS_IN    3
+#define USBCDC_EP0_STATUS_OUT   4
+
+static PCD_HandleTypeDef usbPcd;
+
+static const uint8_t usbDeviceDesc[18] = {
+    18, 0x01, 0x00, 0x02,               // bcdUSB 2.00
+    0x02, 0x00, 0x00, USBCDC_EP0_SIZE,  // CDC设备类
+    USBCDC_VID & 0xFF, USBCDC_VID >> 8, USBCDC_PID & 0xFF, USBCDC_PID >> 8,
+    0x00, 0x02, 1, 2, 3, 1,
+};
+
+// 配置描述符：通信接口(中断通知端点) + 数据接口(批量输入/输出端点)
+static const uint8_t usbConfigDesc[67] = {
+    9, 0x02, 67, 0, 2, 1, 0, 0x80, 50,              // 总线供电，100mA
+    9, 0x04, 0, 0, 1, 0x02, 0x02, 0x01, 0,          // 通信接口，ACM
+    5, 0x24, 0x00, 0x10, 0x01,                      // Header，CDC 1.10
+    5, 0x24, 0x01, 0x00, 1,                         // Call Management，数据接口为1
+    4, 0x24, 0x02, 0x02,                            // ACM，支持Line Coding及Control Line State
+    5, 0x24, 0x06, 0, 1,                            // Union
+    7, 0x05, USBCDC_EP_NOTIFY, 0x03, USBCDC_NOTIFY_SIZE, 0, 16,
+    9, 0x04, 1, 0, 2, 0x0A, 0x00, 0x00, 0,          // 数据接口
+    7, 0x05, USBCDC_EP_DATA_OUT, 0x02, USBCDC_DATA_SIZE, 0, 0,
+    7, 0x05, USBCDC_EP_DATA_IN, 0x02, USBCDC_DATA_SIZE, 0, 0,
+};
+
+static const uint8_t usbLangDesc[4] = {4, 0x03, 0x09, 0x04};
+static const char * const usbStrings[] = {"DukiTinyOS", "Quadrotor CDC"};
+static uint8_t usbStringDesc[2 + 2 * 24];
+
+static uint8_t usbEp0State;
+static const uint8_t *usbEp0Data;
+static uint32_t usbEp0Left;
+static uint8_t usbEp0Zlp;               // 数据短于请求长度且为包长整数倍，最后补一个空包
+static uint8_t usbEp0Buf[8];
+static uint8_t usbEp0Request;
+static uint8_t usbConfigValue;
+// 波特率(小端)、停止位、校验、数据位，主机设置后原样返回
+static uint8_t usbLineCoding[7] = {0x00, 0xC2, 0x01, 0x00, 0, 0, 8};
+
+static volatile uint8_t usbConfigured;
+static volatile uint8_t usbOpened;
+
+static tStream usbTxStream;
+static uint8_t usbTxStreamBuf[USBCDC_TX_STREAM_SIZE];
+static uint8_t usbTxBuf[2][USBCDC_TX_BUF_SIZE];
+static tSem usbTxIdleSem;               // 端点空闲，可以开始下一次传输
+static volatile uint8_t usbTxBusy;
+static uint8_t usbTxZlp;
+static uint32_t usbTxBytes;
+static uint32_t usbTxDropped;
+
+static tStream usbRxStream;
+static uint8_t usbRxStreamBuf[USBCDC_RX_STREAM_SIZE];
+static uint8_t usbRxPacket[USBCDC_DATA_SIZE];
+static uint8_t usbRxPaused;             // 接收字节流放不下一个包，端点暂停接收
+static uint32_t usbRxBytes;
+
+static tTask usbTxTask;
+static tTaskStack usbTxStack[USBCDC_TX_STACK_SIZE];
+
+#if TINYOS_ENABLE_SHELL == 1
+static void UsbCdc_PrintStatus(void);
+static tShellCmd usbCmd = {"usb", UsbCdc_PrintStatus, "USB CDC connection state and transfer counters"};
+#endif
+
+//把ASCII字符串转换为字符串描述符(UTF-16LE)，返回描述符长度
+static uint32_t UsbCdc_StringDesc(const char *s)
+{
+    uint32_t len = 2;
+
+    while ((*s != '\0') && (len < sizeof(usbStringDesc))) {
+        usbStringDesc[len++] = (uint8_t)*s++;
+        usbStringDesc[len++] = 0;
+    }
+    usbStringDesc[0] = (uint8_t)len;
+    usbStringDesc[1] = 0x03;
+    return len;
+}
+
+//序列号取自96位芯片唯一ID，按十六进制输出其中的48位
+static uint32_t UsbCdc_SerialDesc(void)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint32_t id0 = *(const uint32_t *)UID_BASE + *(const uint32_t *)(UID_BASE + 8);
+    uint32_t id1 = *(const uint32_t *)(UID_BASE + 4);
+    char serial[13];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        serial[i] = hex[(id0 >> (28 - 4 * i)) & 0xF];
+    }
+    for (i = 0; i < 4; i++) {
+        serial[8 + i] = hex[(id1 >> (28 - 4 * i)) & 0xF];
+    }
+    serial[12] = '\0';
+    return UsbCdc_StringDesc(serial);
+}
+
+static void UsbCdc_Ep0Stall(void)
+{
+    HAL_PCD_EP_SetStall(&usbPcd, 0x80);
+    HAL_PCD_EP_SetStall(&usbPcd, 0x00);
+    usbEp0State = USBCDC_EP0_IDLE;
+}
+
+//状态阶段：无数据或OUT数据阶段之后回复空包
+static void UsbCdc_Ep0Status(void)
+{
+    usbEp0State = USBCDC_EP0_STATUS_IN;
+    HAL_PCD_EP_Transmit(&usbPcd, 0x80, (uint8_t *)0, 0);
+}
+
+//发送IN数据阶段的下一个包，端点0每次只能传输一个包
+static void UsbCdc_Ep0Continue(void)
+{
+    uint32_t n = (usbEp0Left > USBCDC_EP0_SIZE) ? USBCDC_EP0_SIZE : usbEp0Left;
+
+    HAL_PCD_EP_Transmit(&usbPcd, 0x80, (uint8_t *)usbEp0Data, n);
+    usbEp0Data += n;
+    usbEp0Left -= n;
+}
+
+static void UsbCdc_Ep0Send(const uint8_t *data, uint32_t len, uint32_t wLength)
+{
+    if (len > wLength) {
+        len = wLength;
+    }
+    usbEp0Data = data;
+    usbEp0Left = len;
+    usbEp0Zlp = (len < wLength) && ((len % USBCDC_EP0_SIZE) == 0);
+    usbEp0State = USBCDC_EP0_DATA_IN;
+    UsbCdc_Ep0Continue();
+}
+
+//开始接收，接收字节流放不下一个包时暂停，由UsbCdc_Read腾出空间后恢复，需在临界区或USB中断中调用
+static void UsbCdc_RxArm(void)
+{
+    tStreamInfo info;
+
+    tStreamGetInfo(&usbRxStream, &info);
+    if (info.size - info.count >= USBCDC_DATA_SIZE) {
+        usbRxPaused = 0;
+        HAL_PCD_EP_Receive(&usbPcd, USBCDC_EP_DATA_OUT, usbRxPacket, USBCDC_DATA_SIZE);
+    } else {
+        usbRxPaused = 1;
+    }
+}
+
+//中止进行中的发送：总线复位或取消配置后端点不会再完成传输，归还端点空闲信号
+static void UsbCdc_TxAbort(void)
+{
+    if (usbTxBusy) {
+        usbTxBusy = 0;
+        usbTxZlp = 0;
+        tSemNotifyFromISR(&usbTxIdleSem);
+    }
+}
+
+static void UsbCdc_SetConfiguration(uint8_t value)
+{
+    if (value == usbConfigValue) {
+        return;
+    }
+    if (usbConfigValue != 0) {
+        HAL_PCD_EP_Close(&usbPcd, USBCDC_EP_DATA_IN);
+        HAL_PCD_EP_Close(&usbPcd, USBCDC_EP_DATA_OUT);
+        HAL_PCD_EP_Close(&usbPcd, USBCDC_EP_NOTIFY);
+        usbConfigured = 0;
+        usbOpened = 0;
+        UsbCdc_TxAbort();
+    }
+    usbConfigValue = value;
+    if (value != 0) {
+        HAL_PCD_EP_Open(&usbPcd, USBCDC_EP_DATA_IN, USBCDC_DATA_SIZE, EP_TYPE_BULK);
+        HAL_PCD_EP_Open(&usbPcd, USBCDC_EP_DATA_OUT, USBCDC_DATA_SIZE, EP_TYPE_BULK);
+        HAL_PCD_EP_Open(&usbPcd, USBCDC_EP_NOTIFY, USBCDC_NOTIFY_SIZE, EP_TYPE_INTR);
+        UsbCdc_RxArm();
+        usbConfigured = 1;
+    }
+}
+
+static void UsbCdc_GetDescriptor(uint16_t wValue, uint16_t wLength)
+{
+    uint32_t len;
+
+    switch (wValue >> 8) {
+        case 0x01:
+            UsbCdc_Ep0Send(usbDeviceDesc, sizeof(usbDeviceDesc), wLength);
+            break;
+        case 0x02:
+            UsbCdc_Ep0Send(usbConfigDesc, sizeof(usbConfigDesc), wLength);
+            break;
+        case 0x03:
+            switch (wValue & 0xFF) {
+                case 0:
+                    UsbCdc_Ep0Send(usbLangDesc, sizeof(usbLangDesc), wLength);
+                    return;
+                case 1:
+                case 2:
+                    len = UsbCdc_StringDesc(usbStrings[(wValue & 0xFF) - 1]);
+                    break;
+                case 3:
+                    len = UsbCdc_SerialDesc();
+                    break;
+                default:
+                    UsbCdc_Ep0Stall();
+                    return;
+            }
+            UsbCdc_Ep0Send(usbStringDesc, len, wLength);
+            break;
+        default:
+            // 只支持全速，设备限定描述符等回复STALL
+            UsbCdc_Ep0Stall();
+            break;
+    }
+}
+
+static void UsbCdc_StandardRequest(const uint8_t *setup, uint16_t wValue, uint16_t wIndex, uint16_t wLength)
+{
+    static const uint8_t zero[2] = {0, 0};
+
+    switch (setup[1]) {
+        case USB_REQ_GET_DESCRIPTOR:
+            UsbCdc_GetDescriptor(wValue, wLength);
+            break;
+        case USB_REQ_SET_ADDRESS:
+            // OTG FS在状态阶段之前设置地址，状态阶段仍以地址0完成
+            HAL_PCD_SetAddress(&usbPcd, (uint8_t)(wValue & 0x7F));
+            UsbCdc_Ep0Status();
+            break;
+        case USB_REQ_SET_CONFIGURATION:
+            if (wValue > 1) {
+                UsbCdc_Ep0Stall();
+                break;
+            }
+            UsbCdc_SetConfiguration((uint8_t)wValue);
+            UsbCdc_Ep0Status();
+            break;
+        case USB_REQ_GET_CONFIGURATION:
+            UsbCdc_Ep0Send(&usbConfigValue, 1, wLength);
+            break;
+        case USB_REQ_GET_STATUS:
+        case USB_REQ_GET_INTERFACE:
+            UsbCdc_Ep0Send(zero, (setup[1] == USB_REQ_GET_STATUS) ? 2 : 1, wLength);
+            break;
+        case USB_REQ_CLEAR_FEATURE:
+        case USB_REQ_SET_FEATURE:
+            // 只处理端点的ENDPOINT_HALT，设备的远程唤醒不支持但同样应答
+            if (((setup[0] & 0x1F) == 0x02) && (wValue == 0) && ((wIndex & 0x7F) != 0)) {
+                if (setup[1] == USB_REQ_SET_FEATURE) {
+                    HAL_PCD_EP_SetStall(&usbPcd, (uint8_t)wIndex);
+                } else {
+                    HAL_PCD_EP_ClrStall(&usbPcd, (uint8_t)wIndex);
+                }
+            }
+            UsbCdc_Ep0Status();
+            break;
+        case USB_REQ_SET_INTERFACE:
+            UsbCdc_Ep0Status();
+            break;
+        default:
+            UsbCdc_Ep0Stall();
+            break;
+    }
+}
+
+static void UsbCdc_ClassRequest(const uint8_t *setup, uint16_t wValue, uint16_t wLength)
+{
+    switch (setup[1]) {
+        case CDC_REQ_SET_LINE_CODING:
+            usbEp0Request = CDC_REQ_SET_LINE_CODING;
+            usbEp0State = USBCDC_EP0_DATA_OUT;
+            HAL_PCD_EP_Receive(&usbPcd, 0x00, usbEp0Buf, (wLength > sizeof(usbEp0Buf)) ? sizeof(usbEp0Buf) : wLength);
+            break;
+        case CDC_REQ_GET_LINE_CODING:
+            UsbCdc_Ep0Send(usbLineCoding, sizeof(usbLineCoding), wLength);
+            break;
+        case CDC_REQ_SET_CONTROL_LINE:
+            // DTR置位表示主机打开了串口，之后才发送数据
+            usbOpened = (uint8_t)(wValue & 0x01);
+            UsbCdc_Ep0Status();
+            break;
+        case CDC_REQ_SEND_BREAK:
+            UsbCdc_Ep0Status();
+            break;
+        default:
+            UsbCdc_Ep0Stall();
+            break;
+    }
+}
+
+/**
+ * @brief 收到SETUP包，在USB中断中由HAL调用
+ */
+void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef *hpcd)
+{
+    const uint8_t *setup = (const uint8_t *)hpcd->Setup;
+    uint16_t wValue = (uint16_t)(setup[2] | (setup[3] << 8));
+    uint16_t wIndex = (uint16_t)(setup[4] | (setup[5] << 8));
+    uint16_t wLength = (uint16_t)(setup[6] | (setup[7] << 8));
+
+    usbEp0Request = 0;
+    switch ((setup[0] >> 5) & 0x03) {
+        case 0:
+            UsbCdc_StandardRequest(setup, wValue, wIndex, wLength);
+            break;
+        case 1:
+            UsbCdc_ClassRequest(setup, wValue, wLength);
+            break;
+        default:
+            UsbCdc_Ep0Stall();
+            break;
+    }
+}
+
+/**
+ * @brief OUT传输完成，在USB中断中由HAL调用
+ */
+void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+    uint32_t n;
+
+    if (epnum == 0) {
+        if (usbEp0State == USBCDC_EP0_DATA_OUT) {
+            if (usbEp0Request == CDC_REQ_SET_LINE_CODING) {
+                memcpy(usbLineCoding, usbEp0Buf, sizeof(usbLineCoding));
+            }
+            UsbCdc_Ep0Status();
+        } else {
+            usbEp0State = USBCDC_EP0_IDLE;
+        }
+        return;
+    }
+
+    if (epnum == (USBCDC_EP_DATA_OUT & 0x7F)) {
+        n = HAL_PCD_EP_GetRxCount(hpcd, epnum);
+        usbRxBytes += n;
+        // 开始接收前已确认放得下一个包
+        tStreamWriteFromISR(&usbRxStream, usbRxPacket, n);
+        UsbCdc_RxArm();
+    }
+}
+
+/**
+ * @brief IN传输完成，在USB中断中由HAL调用
+ */
+void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
+{
+    if (epnum == 0) {
+        if (usbEp0State != USBCDC_EP0_DATA_IN) {
+            usbEp0State = USBCDC_EP0_IDLE;
+        } else if (usbEp0Left > 0) {
+            UsbCdc_Ep0Continue();
+        } else if (usbEp0Zlp) {
+            usbEp0Zlp = 0;
+            HAL_PCD_EP_Transmit(hpcd, 0x80, (uint8_t *)0, 0);
+        } else {
+            usbEp0State = USBCDC_EP0_STATUS_OUT;
+            HAL_PCD_EP_Receive(hpcd, 0x00, (uint8_t *)0, 0);
+        }
+        return;
+    }
+
+    if (epnum == (USBCDC_EP_DATA_IN & 0x7F)) {
+        // 长度为包长整数倍的传输以空包结束，主机的读取才会返回
+        if (usbTxZlp) {
+            usbTxZlp = 0;
+            HAL_PCD_EP_Transmit(hpcd, USBCDC_EP_DATA_IN, (uint8_t *)0, 0);
+            return;
+        }
+        usbTxBusy = 0;
+        tSemNotifyFromISR(&usbTxIdleSem);
+    }
+}
+
+/**
+ * @brief 总线复位，重新打开端点0并回到未配置状态
+ */
+void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
+{
+    UsbCdc_SetConfiguration(0);
+    usbConfigured = 0;
+    usbOpened = 0;
+    usbEp0State = USBCDC_EP0_IDLE;
+    UsbCdc_TxAbort();
+    HAL_PCD_EP_Open(hpcd, 0x00, USBCDC_EP0_SIZE, EP_TYPE_CTRL);
+    HAL_PCD_EP_Open(hpcd, 0x80, USBCDC_EP0_SIZE, EP_TYPE_CTRL);
+}
+
+void HAL_PCD_SuspendCallback(PCD_HandleTypeDef *hpcd)
+{
+    // 主机挂起总线(拔出或休眠)后不再读取，按关闭串口处理，恢复后由主机重新设置DTR
+    usbOpened = 0;
+}
+
+void HAL_PCD_MspInit(PCD_HandleTypeDef *hpcd)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    gpio.Pin = GPIO_PIN_11 | GPIO_PIN_12;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF10_OTG_FS;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    __HAL_RCC_USB_OTG_FS_CLK_ENABLE();
+    HAL_NVIC_SetPriority(OTG_FS_IRQn, USBCDC_IRQ_PRIO, 0);//枚举及端点FIFO在中断中处理，数据交给任务，优先级不能高于TINYOS_MAX_SYSCALL_PRIO
+    HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+
+void OTG_FS_IRQHandler(void)
+{
+    tIrqStatEnter();
+    tIntEnter();
+    HAL_PCD_IRQHandler(&usbPcd);
+    tIntExit();
+    tIrqStatExit();
+}
+
+//发送任务：取出发送字节流中的数据，在一个缓冲区传输期间填充另一个
+static void UsbCdc_TxEntry(void *param)
+{
+    uint32_t fill = 0;
+    uint32_t len, status;
+    uint8_t sent;
+
+    for (;;) {
+        len = tStreamRead(&usbTxStream, usbTxBuf[fill], USBCDC_TX_BUF_SIZE, 0);
+        if (len == 0) {
+            continue;
+        }
+
+        // 等待另一个缓冲区的传输完成
+        tSemWait(&usbTxIdleSem, 0);
+        status = tTaskEnterCritical();
+        sent = usbConfigured && usbOpened;
+        if (sent) {
+            usbTxBusy = 1;
+            usbTxZlp = (len % USBCDC_DATA_SIZE) == 0;
+            usbTxBytes += len;
+            HAL_PCD_EP_Transmit(&usbPcd, USBCDC_EP_DATA_IN, usbTxBuf[fill], len);
+        } else {
+            usbTxDropped += len;
+        }
+        tTaskExitCritical(status);
+
+        if (sent) {
+            fill ^= 1;
+        } else {
+            tSemNotify(&usbTxIdleSem);
+        }
+    }
+}
+
+/**
+ * @brief 初始化USB OTG FS设备及字节流，创建发送任务，连接由主机在之后枚举
+ *
+ * @return uint8_t 返回0
+ */
+uint8_t UsbCdc_Init(void)
+{
+    tStreamInit(&usbTxStream, usbTxStreamBuf, sizeof(usbTxStreamBuf), 1);
+    tStreamInit(&usbRxStream, usbRxStreamBuf, sizeof(usbRxStreamBuf), 1);
+    tSemInit(&usbTxIdleSem, 1, 1);
+    tObjectSetName(&usbTxStream.event.object, "usb.tx");
+    tObjectSetName(&usbRxStream.event.object, "usb.rx");
+
+    usbPcd.Instance = USB_OTG_FS;
+    usbPcd.Init.dev_endpoints = 4;
+    usbPcd.Init.speed = PCD_SPEED_FULL;
+    usbPcd.Init.dma_enable = DISABLE;
+    usbPcd.Init.phy_itface = PCD_PHY_EMBEDDED;
+    usbPcd.Init.Sof_enable = DISABLE;
+    usbPcd.Init.low_power_enable = DISABLE;
+    usbPcd.Init.lpm_enable = DISABLE;
+    usbPcd.Init.vbus_sensing_enable = DISABLE;
+    usbPcd.Init.use_dedicated_ep1 = DISABLE;
+    if (HAL_PCD_Init(&usbPcd) != HAL_OK) {
+        return 1;
+    }
+    // FIFO共320字：接收128，端点0发送32，批量输入128(两个包)，通知16
+    HAL_PCDEx_SetRxFiFo(&usbPcd, 128);
+    HAL_PCDEx_SetTxFiFo(&usbPcd, 0, 32);
+    HAL_PCDEx_SetTxFiFo(&usbPcd, 1, 128);
+    HAL_PCDEx_SetTxFiFo(&usbPcd, 2, 16);
+
+    tTaskInit(&usbTxTask, UsbCdc_TxEntry, (void *)0, USBCDC_TX_PRIO, usbTxStack, sizeof(usbTxStack));
+    tObjectSetName(&usbTxTask.object, "usbTx");
+#if TINYOS_ENABLE_SHELL == 1
+    tShellAddCmd(&usbCmd);
+#endif
+    HAL_PCD_Start(&usbPcd);
+    return 0;
+}
+
+/**
+ * @brief 写入发送字节流，由发送任务交给端点
+ *
+ * 主机未打开串口时丢弃，不等待。
+ *
+ * @param data      数据
+ * @param len       字节数
+ * @param waitTicks 发送字节流满时每次等待的最大节拍数，为0时一直等待
+ * @return uint32_t 写入的字节数
+ */
+uint32_t UsbCdc_Write(const void *data, uint32_t len, uint32_t waitTicks)
+{
+    uint32_t done;
+
+    if (!usbOpened) {
+        usbTxDropped += len;
+        return 0;
+    }
+    done = tStreamWrite(&usbTxStream, data, len, waitTicks);
+    usbTxDropped += len - done;
+    return done;
+}
+
+/**
+ * @brief 不等待地写入发送字节流，放不下的部分丢弃，可在任务及中断中调用
+ *
+ * 参数形式与tLogDrain、tTraceDrain的输出函数相同。
+ *
+ * @param data 数据
+ * @param len  字节数
+ */
+void UsbCdc_Output(const uint8_t *data, uint32_t len)
+{
+    uint32_t done = 0;
+
+    if (usbOpened) {
+        done = tStreamWriteFromISR(&usbTxStream, data, len);
+    }
+    usbTxDropped += len - done;
+}
+
+/**
+ * @brief 读取主机发来的数据，读出后接收暂停时恢复接收
+ *
+ * @param buf       存放数据的缓冲区
+ * @param len       最多读取的字节数
+ * @param waitTicks 没有数据时等待的最大节拍数，为0时一直等待
+ * @return uint32_t 读到的字节数，超时为0
+ */
+uint32_t UsbCdc_Read(void *buf, uint32_t len, uint32_t waitTicks)
+{
+    uint32_t n = tStreamRead(&usbRxStream, buf, len, waitTicks);
+    uint32_t status = tTaskEnterCritical();
+
+    if (usbRxPaused && usbConfigured) {
+        UsbCdc_RxArm();
+    }
+    tTaskExitCritical(status);
+    return n;
+}
+
+void UsbCdc_GetStatus(UsbCdcStatus *status)
+{
+    uint32_t s = tTaskEnterCritical();
+
+    status->configured = usbConfigured;
+    status->opened = usbOpened;
+    status->baudRate = usbLineCoding[0] | (usbLineCoding[1] << 8) | (usbLineCoding[2] << 16) | ((uint32_t)usbLineCoding[3] << 24);
+    status->txBytes = usbTxBytes;
+    status->txDropped = usbTxDropped;
+    status->rxBytes = usbRxBytes;
+    tTaskExitCritical(s);
+}
+
+#if TINYOS_ENABLE_SHELL == 1
+static void UsbCdc_PrintStatus(void)
+{
+    UsbCdcStatus status;
+
+    UsbCdc_GetStatus(&status);
+    printf("usb %s, port %s, baud %lu\r\n", status.configured ? "configured" : "not configured",
+           status.opened ? "open" : "closed", (unsigned long)status.baudRate);
+    printf("tx %lu bytes, %lu dropped, rx %lu bytes\r\n", (unsigned long)status.txBytes,
+           (unsigned long)status.txDropped, (unsigned long)status.rxBytes);
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __USBCDC_H
+#define __USBCDC_H
+
+#include "main.h"
+
+// USB CDC-ACM虚拟串口：USB OTG FS(PA11 DM、PA12 DP)全速设备，主机上为标准的虚拟串口(Windows 10起免驱，Linux为ttyACM)，
+// 用于黑匣子日志下载、高速遥测及传感器数据流，吞吐量远高于USART1。
+// 中断中只处理枚举的控制传输及端点FIFO：收到的包写入接收字节流，发送完成时通知发送任务；
+// 发送任务把发送字节流中的数据取到两个缓冲区之一交给端点，一个在传输时填充另一个，长度为64整数倍的传输之后补一个空包。
+// 主机打开串口(DTR置位)之前写入的数据被丢弃，写入者不会被未连接的USB阻塞；接收字节流放不下一个包时端点暂停接收(NAK)，
+// 读出后恢复，主机的发送不会丢失。
+// 需开启TINYOS_ENABLE_SEM及TINYOS_ENABLE_STREAM，48MHz的USB时钟由PLLQ提供(SystemClock_Config中PLLQ为7)
+#define USBCDC_ENABLE           0
+
+#define USBCDC_VID              0x0483  // ST的虚拟串口VID/PID，仅供台架使用
+#define USBCDC_PID              0x5740
+#define USBCDC_TX_STREAM_SIZE   4096    // 发送字节流(字节)，容纳发送任务未及取出的数据
+#define USBCDC_TX_BUF_SIZE      1024    // 每次交给端点的最大字节数，两个缓冲区交替使用，为64的整数倍
+#define USBCDC_RX_STREAM_SIZE   512     // 接收字节流(字节)，至少为两个包
+#define USBCDC_TX_PRIO          (TINYOS_PRIO_COUNT - 4) // 发送任务的优先级，与遥测任务同级
+#define USBCDC_TX_STACK_SIZE    256     // 发送任务的栈(字)
+#define USBCDC_IRQ_PRIO         TINYOS_MAX_SYSCALL_PRIO // 中断中调用内核FromISR接口，不能高于TINYOS_MAX_SYSCALL_PRIO
+
+// 连接及传输统计
+typedef struct _UsbCdcStatus {
+    uint8_t configured;     // 1：主机已完成枚举
+    uint8_t opened;         // 1：主机已打开串口(DTR)
+    uint32_t baudRate;      // 主机设置的波特率，只用于显示，不影响传输速率
+    uint32_t txBytes;       // 已交给端点的字节数
+    uint32_t txDropped;     // 未连接或发送字节流满而丢弃的字节数
+    uint32_t rxBytes;       // 收到的字节数
+} UsbCdcStatus;
+
+#if USBCDC_ENABLE == 1
+uint8_t UsbCdc_Init(void); // 初始化USB设备并创建发送任务，返回0
+uint32_t UsbCdc_Write(const void *data, uint32_t len, uint32_t waitTicks); // 写入发送字节流，返回写入的字节数，未打开时为0
+uint32_t UsbCdc_Read(void *buf, uint32_t len, uint32_t waitTicks); // 读取收到的数据，waitTicks为0时一直等待
+void UsbCdc_Output(const uint8_t *data, uint32_t len); // 不等待的写入，可作为tLogDrain、tTraceDrain的输出函数
+void UsbCdc_GetStatus(UsbCdcStatus *status);
+#else
+#define UsbCdc_Init()       ((uint8_t)1)
+#endif
+
+#endif // __USBCDC_H
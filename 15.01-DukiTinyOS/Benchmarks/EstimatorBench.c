@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <math.h>
+#include "tinyOS.h"
+#include "tPort.h"
+#include "MadgWick.h"
+#include "MyMadgWick.h"
+#include "Mahony.h"
+#include "AttitudeEstimator.h"
+#include "PID.h"
+#include "Mixer.h"
+#include "GyroPreint.h"
+#include "EstimatorBench.h"
+
+#if (TINYOS_ENABLE_BENCHMARK == 1) && !defined(TINYOS_PORT_POSIX)
+
+// 姿态估计器及控制路径的目标板基准测试，由rhealstone.c在内核基准之后调用：用合成的六轴数据依次驱动各估计器
+// (Madgwick、merge()、Mahony，以及经估计器接口的ATTITUDE_ESTIMATOR所选后端，如EKF)和串级PID、混控，
+// 统计每次更新的周期数(混控一项含推力查找表)，并在单独的探测任务中测出每项调用的栈深度，据此估算各型号MCU可达到的最高融合/控制频率
+// 输出：BENCH,<测试项>,<样本数>,<最小周期>,<平均周期>,<最大周期>，格式与内核基准相同，已减去周期计数器的读取开销；
+//       STACK,<测试项>,<字节数>，从调用前的PSP算起，含测试项包装函数自身约8字节的压栈，不含中断的异常帧；
+//       #FPU,<0/1>为编译时是否使用FPU(CMSIS的__FPU_USED)
+// 对比有无FPU：在Target选项的Floating Point Hardware中选Not Used(即--fpu=softvfp)后重新编译运行，
+// 两次结果的差别即为软件浮点的代价；各项的代码大小由Tools/benchsize.py从链接生成的.map文件中统计
+
+#define ESTBENCH_INPUT_COUNT    256         //合成的样本数，循环使用
+#define ESTBENCH_DT             0.002f      //积分步长(s)，对应500Hz
+#define ESTBENCH_GAIN           0.1f
+#define ESTBENCH_PROBE_PRIO     3           //高于rhealstone.c的控制任务，通知后立即运行
+#define ESTBENCH_PROBE_STACK    512         //探测任务的栈(字)，须大于被测调用的最大深度
+
+typedef struct _EstBenchImu {
+    float gx, gy, gz, ax, ay, az;
+}EstBenchImu;
+
+// 一个测试项：每次调用处理一个样本
+typedef struct _EstBenchCase {
+    const char * name;
+    void (*reset)(void);
+    void (*step)(void);
+}EstBenchCase;
+
+static EstBenchImu estBenchInput[ESTBENCH_INPUT_COUNT];
+static uint32_t estBenchIndex;
+static MahonyFilter estBenchMahony;
+static PIDAttitude estBenchPID;
+static float estBenchMotor[MIXER_MOTOR_COUNT];
+static GyroPreint estBenchPreint;
+
+static tTask estBenchProbeTask;
+static tTaskStack estBenchProbeStack[ESTBENCH_PROBE_STACK];
+static tSem estBenchProbeSem;
+static void (* volatile estBenchProbeStep)(void);
+static volatile uint32_t estBenchProbeBytes;
+static uint8_t estBenchProbeStarted;
+
+/**
+ * @brief 生成合成的六轴数据：三轴陀螺仪为不同频率的正弦转动(rad/s)，加速度计为缓慢摆动的重力方向(g)
+ *
+ * @return void
+ */
+static void estBenchInputInit(void) {
+    uint32_t i;
+
+    for (i = 0; i < ESTBENCH_INPUT_COUNT; i++) {
+        float t = (float)i * ESTBENCH_DT;
+        estBenchInput[i].gx = 0.8f * sinf(6.0f * t);
+        estBenchInput[i].gy = 0.5f * sinf(9.0f * t + 1.0f);
+        estBenchInput[i].gz = 0.3f * cosf(4.0f * t);
+        estBenchInput[i].ax = 0.2f * sinf(3.0f * t);
+        estBenchInput[i].ay = 0.2f * cosf(5.0f * t);
+        estBenchInput[i].az = 0.95f;
+    }
+}
+
+static const EstBenchImu * estBenchNext(void) {
+    const EstBenchImu * in = &estBenchInput[estBenchIndex];
+
+    estBenchIndex = (estBenchIndex + 1) % ESTBENCH_INPUT_COUNT;
+    return in;
+}
+
+//************************** 测试项 **************************
+
+static void estBenchMadgwickReset(void) {
+    beta = ESTBENCH_GAIN;
+    q0 = 1.0f; q1 = 0.0f; q2 = 0.0f; q3 = 0.0f;
+}
+
+static void estBenchMadgwickStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    MadgwickAHRSupdateIMU(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, ESTBENCH_DT);
+}
+
+static void estBenchMergeStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    merge(in->ax, in->ay, in->az, in->gx, in->gy, in->gz, ESTBENCH_DT);
+}
+
+static void estBenchMahonyReset(void) {
+    Mahony_Init(&estBenchMahony, 2.0f * ESTBENCH_GAIN, 0.0f);
+}
+
+static void estBenchMahonyStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    Mahony_UpdateIMU(&estBenchMahony, in->gx, in->gy, in->gz, in->ax, in->ay, in->az, ESTBENCH_DT);
+}
+
+static void estBenchEstimatorReset(void) {
+    AttitudeEstimator_Init(ESTBENCH_GAIN);
+}
+
+static void estBenchEstimatorStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    AttitudeEstimator_UpdateIMU(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, ESTBENCH_DT);
+}
+
+static void estBenchPreintReset(void) {
+    GyroPreint_Reset(&estBenchPreint);
+}
+
+// 多速率融合中每个样本的陀螺仪预积分
+static void estBenchPreintStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    GyroPreint_Push(&estBenchPreint, in->gx, in->gy, in->gz, ESTBENCH_DT);
+}
+
+static void estBenchPIDReset(void) {
+    PIDAttitude_Init(&estBenchPID, ESTBENCH_DT);
+}
+
+// 角度取陀螺仪数据放大后的值，设定值为0，各通道的误差连续变化
+static void estBenchPIDStep(void) {
+    const EstBenchImu * in = estBenchNext();
+    float angleRef[PID_AXIS_COUNT] = {0.0f, 0.0f, 0.0f};
+    float angle[PID_AXIS_COUNT];
+
+    angle[PID_AXIS_ROLL] = in->gx * 20.0f;
+    angle[PID_AXIS_PITCH] = in->gy * 20.0f;
+    angle[PID_AXIS_YAW] = 0.0f;
+    PIDAttitude_Calc(&estBenchPID, angleRef, angle, (const float *)0, &in->gx);
+}
+
+static void estBenchMixerStep(void) {
+    const EstBenchImu * in = estBenchNext();
+
+    Mixer_Mix(0.5f, in->gx * 0.1f, in->gy * 0.1f, in->gz * 0.1f, estBenchMotor);
+    Mixer_Output(estBenchMotor, 1.0f);
+}
+
+// 控制周期内的完整路径：串级PID加混控
+static void estBenchControlStep(void) {
+    estBenchPIDStep();
+    Mixer_Mix(0.5f, estBenchPID.rate.output[PID_AXIS_ROLL] * 0.001f, estBenchPID.rate.output[PID_AXIS_PITCH] * 0.001f,
+              estBenchPID.rate.output[PID_AXIS_YAW] * 0.001f, estBenchMotor);
+    Mixer_Output(estBenchMotor, 1.0f);
+}
+
+static const EstBenchCase estBenchCases[] = {
+    {"madgwick_imu", estBenchMadgwickReset, estBenchMadgwickStep},
+    {"mymadgwick_merge", MyMadgWick_Reset, estBenchMergeStep},
+    {"mahony_imu", estBenchMahonyReset, estBenchMahonyStep},
+    {(const char *)0, estBenchEstimatorReset, estBenchEstimatorStep},   // 名称为"estimator_" + 后端名称
+    {"gyro_preint", estBenchPreintReset, estBenchPreintStep},
+    {"pid_attitude", estBenchPIDReset, estBenchPIDStep},
+    {"mixer", estBenchPIDReset, estBenchMixerStep},
+    {"pid_mixer", estBenchPIDReset, estBenchControlStep},
+};
+
+//************************** 栈深度 **************************
+
+/**
+ * @brief 探测任务：每次被通知后关中断，把当前PSP以下的栈填充为TINYOS_TASK_STACK_FILL，调用一次测试项，
+ *        再从栈底向上找到第一个被改写的字，与调用前的PSP之差即为该调用的栈深度
+ *        填充、调用与扫描之间不调用其它函数，关中断使异常帧不落到栈上
+ *
+ * @return void
+ */
+static void estBenchProbeEntry(void * param) {
+    (void)param;
+
+    for (;;) {
+        uint32_t status;
+        tTaskStack * sp;
+        tTaskStack * p;
+
+        tSemWait(&estBenchProbeSem, 0);
+        status = tTaskEnterCritical();
+        sp = (tTaskStack *)__get_PSP();
+        for (p = estBenchProbeStack; p < sp; p++) {
+            *p = TINYOS_TASK_STACK_FILL;
+        }
+        estBenchProbeStep();
+        for (p = estBenchProbeStack; (p < sp) && (*p == TINYOS_TASK_STACK_FILL); p++) {
+        }
+        estBenchProbeBytes = (uint32_t)(sp - p) * sizeof(tTaskStack);
+        tTaskExitCritical(status);
+    }
+}
+
+// 探测任务优先级更高，通知返回时已测完
+static uint32_t estBenchStackDepth(void (*step)(void)) {
+    if (!estBenchProbeStarted) {
+        tSemInit(&estBenchProbeSem, 0, 0);
+        tTaskInit(&estBenchProbeTask, estBenchProbeEntry, (void *)0, ESTBENCH_PROBE_PRIO,
+                  estBenchProbeStack, sizeof(estBenchProbeStack));
+        estBenchProbeStarted = 1;
+    }
+    estBenchProbeStep = step;
+    tSemNotify(&estBenchProbeSem);
+    return estBenchProbeBytes;
+}
+
+//************************** 计时 **************************
+
+static void estBenchTime(const char * name, const EstBenchCase * c, uint32_t overhead) {
+    uint32_t i;
+    uint32_t minCycles = 0xFFFFFFFF;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+
+    c->reset();
+    estBenchIndex = 0;
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        uint32_t start = tCycleCounterGet();
+        uint32_t cycles;
+
+        c->step();
+        cycles = tCycleCounterGet() - start;
+        cycles = (cycles > overhead) ? (cycles - overhead) : 0;
+        totalCycles += cycles;
+        if (cycles < minCycles) {
+            minCycles = cycles;
+        }
+        if (cycles > maxCycles) {
+            maxCycles = cycles;
+        }
+    }
+    printf("BENCH,%s,%lu,%lu,%lu,%lu\r\n", name, (unsigned long)TINYOS_BENCH_SAMPLES, (unsigned long)minCycles,
+           (unsigned long)(totalCycles / TINYOS_BENCH_SAMPLES), (unsigned long)maxCycles);
+}
+
+/**
+ * @brief 依次计时各测试项，之后再测各项的栈深度
+ *
+ * @param overhead 读取周期计数器本身的开销，从每个样本中扣除
+ *
+ * @return void
+ */
+void EstimatorBench_Run(uint32_t overhead) {
+    char names[sizeof(estBenchCases) / sizeof(estBenchCases[0])][32];
+    uint32_t count = sizeof(estBenchCases) / sizeof(estBenchCases[0]);
+    uint32_t i;
+
+#if defined(__FPU_USED) && (__FPU_USED == 1)
+    printf("#FPU,1\r\n");
+#else
+    printf("#FPU,0\r\n");
+#endif
+    estBenchInputInit();
+    Mixer_Init();
+    for (i = 0; i < count; i++) {
+        if (estBenchCases[i].name != (const char *)0) {
+            snprintf(names[i], sizeof(names[i]), "%s", estBenchCases[i].name);
+        } else {
+            snprintf(names[i], sizeof(names[i]), "estimator_%s", AttitudeEstimator_GetName());
+        }
+        estBenchTime(names[i], &estBenchCases[i], overhead);
+    }
+
+    printf("#STACK,test,bytes\r\n");
+    for (i = 0; i < count; i++) {
+        estBenchCases[i].reset();
+        printf("STACK,%s,%lu\r\n", names[i], (unsigned long)estBenchStackDepth(estBenchCases[i].step));
+    }
+
+    // 恢复为单位四元数，不影响之后姿态解算的初值
+    estBenchMadgwickReset();
+    MadgwickPublishQuaternion();
+    MyMadgWick_Reset();
+    AttitudeEstimator_Init(ESTBENCH_GAIN);
+}
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef __ESTIMATORBENCH_H
+#define __ESTIMATORBENCH_H
+
+#include <stdint.h>
+
+void EstimatorBench_Run(uint32_t overhead); // 计时各姿态估计器及PID/混控，并测量各自的栈深度，overhead为读取周期计数器的开销
+
+#endif // __ESTIMATORBENCH_H
@@ -0,0 +1,15 @@
+#ifndef __MAIN_H
+#define __MAIN_H
+
+// 主机回放程序用的main.h：Attitude/下的源文件经BSP头文件间接包含main.h，主机上没有HAL，
+// 这里只提供这些头文件的声明中用到的类型，源文件本身不做修改；编译时把本目录放在包含路径的最前面
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct { int unused; } UART_HandleTypeDef;
+typedef struct { int unused; } I2C_HandleTypeDef;
+typedef struct { int unused; } TIM_HandleTypeDef;
+typedef struct { int unused; } GPIO_TypeDef;
+
+#endif /* __MAIN_H */
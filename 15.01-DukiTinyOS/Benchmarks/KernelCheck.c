@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "tinyOS.h"
+
+#ifdef TINYOS_PORT_POSIX
+
+// 内核行为的主机检查：在主机仿真移植层上运行，以本文件代替Source/app.c(同样提供tInitApp)，
+// 检查多个模块交互时的优先级等不变式，只编入tConfig.h中已开启的检查项：
+//   budget  运行预算与互斥量优先级继承，需开启TINYOS_ENABLE_MUTEX及TINYOS_ENABLE_BUDGET
+//   timer   软定时器回调中重新启动、停止自己，需开启TINYOS_ENABLE_TIMER且TINYOS_TIMER_POOL_SIZE不为0
+// 每项通过后打印"KCHECK,OK,<检查项>"，失败时打印第一处不符并以1退出，全部通过时打印"KCHECK,PASS"并以0退出。
+// 编译运行(在工程根目录下)：
+//   gcc -DTINYOS_PORT_POSIX -ISource -IPort/Posix -o kcheck Benchmarks/KernelCheck.c Source/*.c Port/Posix/*.c
+//       排除 Source/app.c Source/tCpu.c Source/tHrTimer.c Source/tPower.c
+//   ./kcheck
+
+#define KCHECK_BUDGET_ON        ((TINYOS_ENABLE_MUTEX == 1) && (TINYOS_ENABLE_BUDGET == 1))
+#define KCHECK_TIMER_ON         ((TINYOS_ENABLE_TIMER == 1) && (TINYOS_TIMER_POOL_SIZE > 0))
+
+#if !KCHECK_BUDGET_ON && !KCHECK_TIMER_ON
+#error "KernelCheck.c requires TINYOS_ENABLE_MUTEX and TINYOS_ENABLE_BUDGET, or TINYOS_ENABLE_TIMER with TINYOS_TIMER_POOL_SIZE > 0"
+#endif
+
+#define KCHECK_PRIO_CTRL        1           //控制任务，与工作任务竞争互斥量的一方
+#define KCHECK_PRIO_WORKER      3           //设置了运行预算的工作任务
+#define KCHECK_BUDGET           2           //工作任务每周期的预算(节拍)
+#define KCHECK_PERIOD           20          //预算的补充周期(节拍)
+#define KCHECK_TIMEOUT          500         //每项检查的节拍上限，超过视为卡住
+#define KCHECK_STACK_SIZE       256
+
+#define KCHECK(cond, what) do { \
+    if (!(cond)) { \
+        printf("KCHECK,FAIL,%s\n", (what)); \
+        exit(1); \
+    } \
+} while (0)
+
+static tTask kcheckCtrl;
+static tTaskStack kcheckCtrlStack[KCHECK_STACK_SIZE];
+
+//控制任务每个节拍检查一次cond，超过KCHECK_TIMEOUT个节拍仍不成立时失败
+#define KCHECK_WAIT(cond, what) do { \
+    uint32_t waitStart = tTaskTickGet(); \
+    while (!(cond)) { \
+        KCHECK((tTaskTickGet() - waitStart) < KCHECK_TIMEOUT, (what)); \
+        tTaskDelay(1); \
+    } \
+} while (0)
+
+#if KCHECK_BUDGET_ON
+static tTask kcheckWorker;
+static tTaskStack kcheckWorkerStack[KCHECK_STACK_SIZE];
+static tMutex kcheckMutex;
+static volatile uint32_t kcheckStage;      //工作任务已进行到的步骤，控制任务据此配合
+
+//忙等到预算降级状态变为exhausted，期间节拍计入工作任务
+static void kcheckWaitExhausted(uint8_t exhausted) {
+    while (kcheckWorker.budgetExhausted != exhausted) {
+    }
+}
+
+static void kcheckWorkerEntry(void * param) {
+    (void)param;
+
+    // 1. 用完预算后降到后台优先级
+    kcheckWaitExhausted(1);
+    KCHECK(kcheckWorker.prio == TINYOS_BUDGET_BG_PRIO, "budget_demote");
+
+    // 2. 降级期间锁定、释放互斥量，基础优先级已是后台优先级，不能借重新计算回到原优先级
+    tMutexWait(&kcheckMutex, 0);
+    KCHECK(kcheckWorker.prio == TINYOS_BUDGET_BG_PRIO, "budget_mutex_lock");
+    tMutexNotify(&kcheckMutex);
+    KCHECK(kcheckWorker.prio == TINYOS_BUDGET_BG_PRIO, "budget_mutex_unlock");
+    KCHECK(kcheckWorker.budgetExhausted, "budget_mutex_exhausted");
+
+    // 3. 下一个周期开始时恢复原优先级
+    kcheckWaitExhausted(0);
+    KCHECK(kcheckWorker.prio == KCHECK_PRIO_WORKER, "budget_restore");
+
+    // 4. 持有无竞争的互斥量(开启ATOMIC_FASTPATH时经快速路径获得，不挂入持有列表)时用完预算，释放前不降级
+    tMutexWait(&kcheckMutex, 0);
+    while (kcheckWorker.budgetLeft != 0) {
+    }
+    {
+        uint32_t tick = tTaskTickGet();
+
+        while ((tTaskTickGet() - tick) < 2) {
+        }
+    }
+    KCHECK(!kcheckWorker.budgetExhausted && (kcheckWorker.prio == KCHECK_PRIO_WORKER), "budget_hold_no_demote");
+    tMutexNotify(&kcheckMutex);
+    kcheckWaitExhausted(1);
+    KCHECK(kcheckWorker.prio == TINYOS_BUDGET_BG_PRIO, "budget_demote_after_release");
+
+    // 5. 降级后持有互斥量，控制任务等待使其继承高优先级，此时取消预算不能丢掉继承的优先级
+    tMutexWait(&kcheckMutex, 0);
+    kcheckStage = 1;
+    while (kcheckWorker.prio != KCHECK_PRIO_CTRL) {
+    }
+    tTaskSetBudget(&kcheckWorker, 0, 0);
+    KCHECK(kcheckWorker.prio == KCHECK_PRIO_CTRL, "budget_remove_inherit");
+    kcheckStage = 2;
+    tMutexNotify(&kcheckMutex);
+
+    for (;;) {
+        tTaskDelay(0xFFFFFF);
+    }
+}
+
+static void kcheckBudget(void) {
+    tMutexInit(&kcheckMutex);
+    tTaskInit(&kcheckWorker, kcheckWorkerEntry, (void *)0, KCHECK_PRIO_WORKER, kcheckWorkerStack, sizeof(kcheckWorkerStack));
+    tTaskSetBudget(&kcheckWorker, KCHECK_BUDGET, KCHECK_PERIOD);
+
+    KCHECK_WAIT(kcheckStage == 1, "budget_timeout");
+    tMutexWait(&kcheckMutex, 0);
+    KCHECK(kcheckStage == 2, "budget_mutex_handoff");
+    KCHECK(kcheckWorker.prio == KCHECK_PRIO_WORKER, "budget_remove_release");
+    tMutexNotify(&kcheckMutex);
+    printf("KCHECK,OK,budget\n");
+}
+#endif
+
+#if KCHECK_TIMER_ON
+#define KCHECK_ONESHOT_FIRES    3           //单次定时器在回调中重新启动，共触发的次数
+#define KCHECK_PERIODIC_FIRES   2           //周期定时器触发这么多次后在回调中停止自己
+
+static tTimer * volatile kcheckOneShot;
+static volatile uint32_t kcheckOneShotFired;
+static tTimer kcheckPeriodic;
+static volatile uint32_t kcheckPeriodicFired;
+
+//在默认组的定时器任务中执行，此时该任务持有本组的protectSem
+static void kcheckOneShotFunc(void * arg) {
+    (void)arg;
+    if (++kcheckOneShotFired < KCHECK_ONESHOT_FIRES) {
+        tTimerStart(kcheckOneShot);
+    }
+}
+
+static void kcheckPeriodicFunc(void * arg) {
+    (void)arg;
+    if (++kcheckPeriodicFired == KCHECK_PERIODIC_FIRES) {
+        tTimerStop(&kcheckPeriodic);
+    }
+}
+
+static void kcheckTimer(void) {
+    tTimerInfo info;
+
+    kcheckOneShot = tTimerCreateOneShot(2, kcheckOneShotFunc, (void *)0);
+    KCHECK(kcheckOneShot != (tTimer *)0, "timer_pool_empty");
+    KCHECK_WAIT(kcheckOneShotFired >= KCHECK_ONESHOT_FIRES, "timer_restart_in_callback");
+    // 最后一次没有重新启动，回调返回后归还到定时器池
+    KCHECK_WAIT(tTimerPoolFreeCount() == TINYOS_TIMER_POOL_SIZE, "timer_pool_reclaim");
+
+    tTimerInit(&kcheckPeriodic, 0, 2, kcheckPeriodicFunc, (void *)0, TIMER_CONFIG_TYPE_SOFT);
+    tTimerStart(&kcheckPeriodic);
+    KCHECK_WAIT(kcheckPeriodicFired >= KCHECK_PERIODIC_FIRES, "timer_periodic");
+    tTaskDelay(10);
+    KCHECK(kcheckOneShotFired == KCHECK_ONESHOT_FIRES, "timer_oneshot_extra");
+    KCHECK(kcheckPeriodicFired == KCHECK_PERIODIC_FIRES, "timer_stop_in_callback");
+    tTimerGetInfo(&kcheckPeriodic, &info);
+    KCHECK(info.state == tTimerStopped, "timer_stop_state");
+    tTimerDestroy(&kcheckPeriodic);
+    printf("KCHECK,OK,timer\n");
+}
+#endif
+
+static void kcheckCtrlEntry(void * param) {
+    (void)param;
+    // 空闲任务在tInitApp返回后才启动节拍，先让出CPU，否则之后的忙等及等待都没有节拍可计
+    tTaskDelay(1);
+
+#if KCHECK_BUDGET_ON
+    kcheckBudget();
+#endif
+#if KCHECK_TIMER_ON
+    kcheckTimer();
+#endif
+
+    printf("KCHECK,PASS\n");
+    exit(0);
+}
+
+void tInitApp(void) {
+    tTaskInit(&kcheckCtrl, kcheckCtrlEntry, (void *)0, KCHECK_PRIO_CTRL, kcheckCtrlStack, sizeof(kcheckCtrlStack));
+}
+
+#endif
@@ -0,0 +1,361 @@
+#include "KernelCompat.h"
+
+#if defined(KBENCH_SNAPSHOT) || (TINYOS_ENABLE_BENCHMARK == 2)
+
+// 跨版本的内核基准测试：只用各章节快照都有的接口(经KernelCompat.h)，同一份代码在4.01~15.01上编译运行，
+// 由Tools/benchcompare.py把各版本的输出合并成对比表，找出切换时间、节拍开销等在哪一步变化
+// 输出格式与rhealstone.c相同，另有版本及内核对象大小：
+//   #VERSION,<快照编号>
+//   BENCH,<测试项>,<样本数>,<最小周期>,<平均周期>,<最大周期>
+//   SIZE,<对象>,<字节数>
+// 快照没有的对象(如6.01之前的信号量)不输出对应的行
+// 节拍开销不依赖性能统计模块：控制任务连续读取周期计数器，相邻两次读数之差超过KBENCH_TICK_GAP_MIN即为被SysTick打断，
+// 差值为节拍中断的进入、处理及退出；此时其余任务都在长延时中，中断返回后不发生切换
+
+#define KBENCH_SAMPLES          1000        //每一项的样本数
+#define KBENCH_PRIO_HIGH        1           //被唤醒/抢占的一方
+#define KBENCH_PRIO_CTRL        2           //控制任务及同优先级切换的辅助任务
+#define KBENCH_STACK_SIZE       256         //每个辅助任务的栈(字)
+#define KBENCH_MBOX_SIZE        4
+#define KBENCH_MEMBLOCK_SIZE    32
+#define KBENCH_MEMBLOCK_COUNT   4
+#define KBENCH_TICK_TASKS_MAX   8           //节拍开销测试中最多的延时任务数
+#define KBENCH_TICK_WINDOW      50          //每种任务数下统计的节拍数
+#define KBENCH_TICK_GAP_MIN     60          //超过该周期数的读数间隔视为被节拍中断打断
+
+typedef enum _kbenchItem {
+    kbenchOverhead = 0,
+    kbenchTaskSwitch,
+    kbenchPreempt,
+    kbenchSemShuffle,
+    kbenchMboxRoundTrip,
+    kbenchMemBlockAllocFree,
+    kbenchMutexUncontended,
+    kbenchItemCount
+}kbenchItem;
+
+typedef struct _kbenchStat {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+}kbenchStat;
+
+static const char * const kbenchName[kbenchItemCount] = {
+    "dwt_overhead",
+    "task_switch",
+    "preemption",
+    "sem_shuffle",
+    "mbox_roundtrip",
+    "memblock_alloc_free",
+    "mutex_uncontended",
+};
+
+static kbenchStat kbenchStats[kbenchItemCount];
+static uint32_t kbenchOverheadCycles;
+static volatile uint32_t kbenchStart;
+static char kbenchLine[64];
+
+static tTask kbenchCtrlTask;
+static tTaskStack kbenchCtrlStack[512];
+static tTask kbenchTickTask[KBENCH_TICK_TASKS_MAX];
+static tTaskStack kbenchTickStack[KBENCH_TICK_TASKS_MAX][KBENCH_STACK_SIZE];
+
+#if KBENCH_HAS_SUSPEND
+static tTask kbenchSwitchTask;
+static tTask kbenchPreemptTask;
+static tTaskStack kbenchSwitchStack[KBENCH_STACK_SIZE];
+static tTaskStack kbenchPreemptStack[KBENCH_STACK_SIZE];
+#endif
+
+#if KBENCH_HAS_SEM
+static tTask kbenchSemTask;
+static tTaskStack kbenchSemStack[KBENCH_STACK_SIZE];
+static tSem kbenchSemPing;
+static tSem kbenchSemPong;
+#endif
+
+#if KBENCH_HAS_MBOX
+static tTask kbenchMboxTask;
+static tTaskStack kbenchMboxStack[KBENCH_STACK_SIZE];
+static tMbox kbenchMboxPing;
+static tMbox kbenchMboxPong;
+static void * kbenchMboxPingBuffer[KBENCH_MBOX_SIZE];
+static void * kbenchMboxPongBuffer[KBENCH_MBOX_SIZE];
+#endif
+
+#if KBENCH_HAS_MEMBLOCK
+static tMemBlock kbenchMemBlock;
+static uint8_t kbenchMem[KBENCH_MEMBLOCK_COUNT][KBENCH_MEMBLOCK_SIZE];
+#endif
+
+#if KBENCH_HAS_MUTEX
+static tMutex kbenchMutex;
+#endif
+
+/**
+ * @brief 记录一个样本，扣除读取周期计数器的开销
+ *
+ * @param stat   统计
+ * @param cycles 测得的周期数
+ *
+ * @return void
+ */
+static void kbenchRecord(kbenchStat * stat, uint32_t cycles) {
+    cycles = (cycles > kbenchOverheadCycles) ? (cycles - kbenchOverheadCycles) : 0;
+    stat->count++;
+    stat->totalCycles += cycles;
+    if (cycles < stat->minCycles) {
+        stat->minCycles = cycles;
+    }
+    if (cycles > stat->maxCycles) {
+        stat->maxCycles = cycles;
+    }
+}
+
+static void kbenchStatReset(kbenchStat * stat) {
+    stat->count = 0;
+    stat->minCycles = 0xFFFFFFFF;
+    stat->maxCycles = 0;
+    stat->totalCycles = 0;
+}
+
+static void kbenchPrintRow(const char * name, const kbenchStat * stat) {
+    if (stat->count == 0) {
+        return;
+    }
+    sprintf(kbenchLine, "BENCH,%s,%lu,%lu,%lu,%lu\r\n", name, (unsigned long)stat->count,
+            (unsigned long)stat->minCycles, (unsigned long)(stat->totalCycles / stat->count),
+            (unsigned long)stat->maxCycles);
+    kbenchPuts(kbenchLine);
+}
+
+static void kbenchPrintSize(const char * name, uint32_t size) {
+    sprintf(kbenchLine, "SIZE,%s,%lu\r\n", name, (unsigned long)size);
+    kbenchPuts(kbenchLine);
+}
+
+#if KBENCH_HAS_SUSPEND
+// 同优先级的主动切换：控制任务唤醒本任务后挂起自己
+static void kbenchSwitchEntry(void * param) {
+    for (;;) {
+        kbenchRecord(&kbenchStats[kbenchTaskSwitch], kbenchCycleGet() - kbenchStart);
+        tTaskWakeUp(&kbenchCtrlTask);
+        tTaskSuspend(curTask);
+    }
+}
+
+// 抢占：控制任务唤醒更高优先级的本任务，立即发生切换
+static void kbenchPreemptEntry(void * param) {
+    for (;;) {
+        kbenchRecord(&kbenchStats[kbenchPreempt], kbenchCycleGet() - kbenchStart);
+        tTaskSuspend(curTask);
+    }
+}
+#endif
+
+#if KBENCH_HAS_SEM
+static void kbenchSemEntry(void * param) {
+    for (;;) {
+        tSemWait(&kbenchSemPing, 0);
+        tSemNotify(&kbenchSemPong);
+    }
+}
+#endif
+
+#if KBENCH_HAS_MBOX
+static void kbenchMboxEntry(void * param) {
+    void * msg;
+
+    for (;;) {
+        tMboxWait(&kbenchMboxPing, &msg, 0);
+        tMboxNotify(&kbenchMboxPong, msg, KBENCH_MBOX_NORMAL);
+    }
+}
+#endif
+
+static void kbenchTickEntry(void * param) {
+    for (;;) {
+        tTaskDelay(0xFFFFFF);
+    }
+}
+
+/**
+ * @brief 逐步增加处于延时状态的任务数，测量每次节拍中断打断控制任务的周期数
+ *
+ * @return void
+ */
+static void kbenchTickOverhead(void) {
+    char name[16];
+    uint32_t taskCount = 0;
+    uint32_t target;
+    uint32_t last, now, gap;
+    kbenchStat stat;
+
+    for (target = 0; target <= KBENCH_TICK_TASKS_MAX; target = (target == 0) ? 1 : target * 2) {
+        while (taskCount < target) {
+            kbenchTaskInit(&kbenchTickTask[taskCount], kbenchTickEntry, KBENCH_PRIO_HIGH, kbenchTickStack[taskCount]);
+            taskCount++;
+        }
+        // 等新任务先运行进入延时，再从一个节拍之后开始统计
+        tTaskDelay(1);
+
+        kbenchStatReset(&stat);
+        last = kbenchCycleGet();
+        while (stat.count < KBENCH_TICK_WINDOW) {
+            now = kbenchCycleGet();
+            gap = now - last;
+            last = now;
+            if (gap > KBENCH_TICK_GAP_MIN) {
+                kbenchRecord(&stat, gap);
+            }
+        }
+        sprintf(name, "tick_tasks_%lu", (unsigned long)target);
+        kbenchPrintRow(name, &stat);
+    }
+}
+
+static void kbenchRun(void) {
+    uint32_t i;
+    uint32_t start;
+#if KBENCH_HAS_MBOX
+    void * msg;
+#endif
+#if KBENCH_HAS_MEMBLOCK
+    uint8_t * mem;
+#endif
+
+    // 周期计数器连续读取两次的开销，作为其余各项的基准
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        start = kbenchCycleGet();
+        kbenchRecord(&kbenchStats[kbenchOverhead], kbenchCycleGet() - start);
+    }
+    kbenchOverheadCycles = kbenchStats[kbenchOverhead].minCycles;
+
+#if KBENCH_HAS_SUSPEND
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        kbenchStart = kbenchCycleGet();
+        tTaskWakeUp(&kbenchSwitchTask);
+        tTaskSuspend(curTask);
+    }
+
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        kbenchStart = kbenchCycleGet();
+        tTaskWakeUp(&kbenchPreemptTask);
+    }
+#endif
+
+#if KBENCH_HAS_SEM
+    // 往返两次切换加一对信号量操作
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        start = kbenchCycleGet();
+        tSemNotify(&kbenchSemPing);
+        tSemWait(&kbenchSemPong, 0);
+        kbenchRecord(&kbenchStats[kbenchSemShuffle], kbenchCycleGet() - start);
+    }
+#endif
+
+#if KBENCH_HAS_MBOX
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        start = kbenchCycleGet();
+        tMboxNotify(&kbenchMboxPing, (void *)i, KBENCH_MBOX_NORMAL);
+        tMboxWait(&kbenchMboxPong, &msg, 0);
+        kbenchRecord(&kbenchStats[kbenchMboxRoundTrip], kbenchCycleGet() - start);
+    }
+#endif
+
+#if KBENCH_HAS_MEMBLOCK
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        start = kbenchCycleGet();
+        tMemBlockNoWaitGet(&kbenchMemBlock, &mem, 0);
+        tMemBlockNotify(&kbenchMemBlock, mem);
+        kbenchRecord(&kbenchStats[kbenchMemBlockAllocFree], kbenchCycleGet() - start);
+    }
+#endif
+
+#if KBENCH_HAS_MUTEX
+    for (i = 0; i < KBENCH_SAMPLES; i++) {
+        start = kbenchCycleGet();
+        tMutexWait(&kbenchMutex, 0);
+        tMutexNotify(&kbenchMutex);
+        kbenchRecord(&kbenchStats[kbenchMutexUncontended], kbenchCycleGet() - start);
+    }
+#endif
+}
+
+static void kbenchCtrlEntry(void * param) {
+    uint32_t i;
+
+    kbenchTickStart();
+    // 等空闲任务(本工程中为外设及串口初始化)先运行
+    tTaskDelay(2);
+    kbenchCycleInit();
+
+    for (i = 0; i < kbenchItemCount; i++) {
+        kbenchStatReset(&kbenchStats[i]);
+    }
+
+    kbenchRun();
+
+    sprintf(kbenchLine, "#VERSION,%lu\r\n#CLOCK,%lu\r\n", (unsigned long)KBENCH_VERSION, (unsigned long)SystemCoreClock);
+    kbenchPuts(kbenchLine);
+    kbenchPuts("#BENCH,test,samples,min_cycles,avg_cycles,max_cycles\r\n");
+    for (i = 0; i < kbenchItemCount; i++) {
+        kbenchPrintRow(kbenchName[i], &kbenchStats[i]);
+    }
+    kbenchTickOverhead();
+
+    // 内核对象的RAM代价
+    kbenchPrintSize("task", sizeof(tTask));
+#if KBENCH_HAS_SEM
+    kbenchPrintSize("sem", sizeof(tSem));
+#endif
+#if KBENCH_HAS_MBOX
+    kbenchPrintSize("mbox", sizeof(tMbox));
+#endif
+#if KBENCH_HAS_MEMBLOCK
+    kbenchPrintSize("memblock", sizeof(tMemBlock));
+#endif
+#if KBENCH_HAS_MUTEX
+    kbenchPrintSize("mutex", sizeof(tMutex));
+#endif
+    kbenchPuts("#END\r\n");
+
+    for (;;) {
+        tTaskDelay(0xFFFFFF);
+    }
+}
+
+void tInitApp(void) {
+#if KBENCH_HAS_SEM
+    tSemInit(&kbenchSemPing, 0, 0);
+    tSemInit(&kbenchSemPong, 0, 0);
+#endif
+#if KBENCH_HAS_MBOX
+    tMboxInit(&kbenchMboxPing, kbenchMboxPingBuffer, KBENCH_MBOX_SIZE);
+    tMboxInit(&kbenchMboxPong, kbenchMboxPongBuffer, KBENCH_MBOX_SIZE);
+#endif
+#if KBENCH_HAS_MEMBLOCK
+    tMemBlockInit(&kbenchMemBlock, (uint8_t *)kbenchMem, KBENCH_MEMBLOCK_SIZE, KBENCH_MEMBLOCK_COUNT);
+#endif
+#if KBENCH_HAS_MUTEX
+    tMutexInit(&kbenchMutex);
+#endif
+
+    kbenchTaskInit(&kbenchCtrlTask, kbenchCtrlEntry, KBENCH_PRIO_CTRL, kbenchCtrlStack);
+#if KBENCH_HAS_SUSPEND
+    kbenchTaskInit(&kbenchSwitchTask, kbenchSwitchEntry, KBENCH_PRIO_CTRL, kbenchSwitchStack);
+    kbenchTaskInit(&kbenchPreemptTask, kbenchPreemptEntry, KBENCH_PRIO_HIGH, kbenchPreemptStack);
+    // 由控制任务唤醒的辅助任务在调度开始前先挂起，入口处即为被唤醒后的第一个测量点
+    tTaskSuspend(&kbenchSwitchTask);
+    tTaskSuspend(&kbenchPreemptTask);
+#endif
+#if KBENCH_HAS_SEM
+    kbenchTaskInit(&kbenchSemTask, kbenchSemEntry, KBENCH_PRIO_HIGH, kbenchSemStack);
+#endif
+#if KBENCH_HAS_MBOX
+    kbenchTaskInit(&kbenchMboxTask, kbenchMboxEntry, KBENCH_PRIO_HIGH, kbenchMboxStack);
+#endif
+}
+
+#endif
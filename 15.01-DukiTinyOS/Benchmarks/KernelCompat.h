@@ -0,0 +1,97 @@
+#ifndef __KERNELCOMPAT_H
+#define __KERNELCOMPAT_H
+
+// KernelCompare.c的兼容层：把各章节快照(4.01~14.01)及本工程内核的tinyOS.h接口差异收拢到这里，测试代码只用这里的宏
+// 在快照的test.uvprojx中以KernelCompare.c代替Source/app.c(同样提供tInitApp)，预定义KBENCH_SNAPSHOT为快照编号
+// (如4.03写作403，14.01写作1401)，包含路径加入本目录；本工程不定义KBENCH_SNAPSHOT，以TINYOS_ENABLE_BENCHMARK为2编译
+// 各快照接口的变化：
+//   4.01  tInitApp、tTaskSuspend/tTaskWakeUp，SysTick由应用调用tSetSysTickPeriod启动
+//   6.01  信号量    7.01 邮箱(发送选项只有tMboxSendFront)    8.01 存储块    10.01 互斥量
+//   12.01 tTaskInit传入栈底及栈大小，此前传入栈顶(数组末尾之后的地址)
+//   12.02 main在tInitApp之后启动SysTick
+//   13.01 起以TINYOS_ENABLE_xxx裁剪各内核对象，关闭的对象不测
+// 2.x、3.x没有tInitApp及挂起/唤醒，主函数直接创建任务，不在支持范围内
+
+#include <stdio.h>
+#include "tinyOS.h"
+
+#if defined(KBENCH_SNAPSHOT)
+
+#if KBENCH_SNAPSHOT < 401
+#error "KBENCH_SNAPSHOT: snapshots before 4.01 have no tInitApp or tTaskSuspend"
+#endif
+
+#include "ARMCM3.h"
+
+#define KBENCH_VERSION          KBENCH_SNAPSHOT
+#define KBENCH_TICK_MS          10          //4.01~12.01由测试启动SysTick的周期，与各快照app.c相同
+
+// 快照没有DWT的封装，直接开启周期计数器；Keil的Cortex-M3模拟器同样实现了CYCCNT
+static __inline void kbenchCycleInit(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#define kbenchCycleGet()        (DWT->CYCCNT)
+
+// 快照没有串口重定向，经ITM输出，在调试器的Debug (printf) Viewer中查看
+static __inline void kbenchPuts(const char * s) {
+    while (*s) {
+        ITM_SendChar((uint32_t)*s++);
+    }
+}
+
+#if KBENCH_SNAPSHOT < 1202
+#define kbenchTickStart()       tSetSysTickPeriod(KBENCH_TICK_MS)
+#else
+#define kbenchTickStart()
+#endif
+
+#if KBENCH_SNAPSHOT < 1201
+#define kbenchTaskInit(task, entry, prio, stack) \
+    tTaskInit((task), (entry), (void *)0, (prio), &(stack)[sizeof(stack) / sizeof((stack)[0])])
+#else
+#define kbenchTaskInit(task, entry, prio, stack) \
+    tTaskInit((task), (entry), (void *)0, (prio), (stack), sizeof(stack))
+#endif
+
+#define KBENCH_HAS_SUSPEND      1
+
+// 13.01起由tConfig.h裁剪，此前按快照编号判断
+#if defined(TINYOS_ENABLE_SEM)
+#define KBENCH_HAS_SEM          TINYOS_ENABLE_SEM
+#define KBENCH_HAS_MBOX         TINYOS_ENABLE_MBOX
+#define KBENCH_HAS_MEMBLOCK     TINYOS_ENABLE_MEMBLOCK
+#define KBENCH_HAS_MUTEX        TINYOS_ENABLE_MUTEX
+#else
+#define KBENCH_HAS_SEM          (KBENCH_SNAPSHOT >= 601)
+#define KBENCH_HAS_MBOX         (KBENCH_SNAPSHOT >= 701)
+#define KBENCH_HAS_MEMBLOCK     (KBENCH_SNAPSHOT >= 801)
+#define KBENCH_HAS_MUTEX        (KBENCH_SNAPSHOT >= 1001)
+#endif
+
+#else
+
+#include "MySerial.h"
+
+#define KBENCH_VERSION          1501
+
+#define kbenchCycleInit()       tCycleCounterInit()
+#define kbenchCycleGet()        tCycleCounterGet()
+#define kbenchPuts(s)           printf("%s", (s))
+#define kbenchTickStart()
+#define kbenchTaskInit(task, entry, prio, stack) \
+    tTaskInit((task), (entry), (void *)0, (prio), (stack), sizeof(stack))
+
+#define KBENCH_HAS_SUSPEND      TINYOS_ENABLE_SUSPEND
+#define KBENCH_HAS_SEM          TINYOS_ENABLE_SEM
+#define KBENCH_HAS_MBOX         TINYOS_ENABLE_MBOX
+#define KBENCH_HAS_MEMBLOCK     TINYOS_ENABLE_MEMBLOCK
+#define KBENCH_HAS_MUTEX        TINYOS_ENABLE_MUTEX
+
+#endif
+
+#define KBENCH_MBOX_NORMAL      0           //发送到邮箱尾部，7.01~11.03没有tMboxSendNormal
+
+#endif // __KERNELCOMPAT_H
@@ -0,0 +1,277 @@
+#if defined(TINYOS_PORT_POSIX)
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+#include <stdio.h>
+#include <math.h>
+#include "tinyOS.h"
+#include "tSeqLock.h"
+#include "MadgWick.h"
+#include "MadgwickBench.h"
+
+#if defined(TINYOS_PORT_POSIX) || (TINYOS_ENABLE_BENCHMARK == 1)
+
+// Madgwick IMU更新的基准测试：与改用VSQRT及单精度之前的实现(快速平方根倒数，每次访问volatile的q0~q3)对比
+// 两者用同一组合成的六轴数据(正弦转动加噪声)，先逐步比对四元数，确认误差在BENCH_TOLERANCE以内后再计时
+// 主机上编译运行(在工程根目录下)，结果为每次更新的纳秒数，只用于检查一致性与粗略对比：
+//   gcc -O2 -DTINYOS_PORT_POSIX -ISource -IPort/Posix -IAttitude -o madgwickbench Benchmarks/MadgwickBench.c Attitude/MadgWick.c Source/tSeqLock.c -lm
+//   ./madgwickbench
+// 目标板上开启TINYOS_ENABLE_BENCHMARK后由rhealstone.c在内核基准之后调用，输出与其相同格式的周期数：
+//   BENCH,<测试项>,<样本数>,<最小周期>,<平均周期>,<最大周期>
+
+#define BENCH_INPUT_COUNT   256         //合成的样本数，循环使用
+#define BENCH_CHECK_STEPS   20000       //比对的更新次数
+#define BENCH_TOLERANCE     5e-3f       //四元数各分量偏差之和的上限，主要来自原实现快速平方根倒数约0.2%的误差
+#define BENCH_DT            0.008f      //积分步长(s)，对应125Hz
+#define BENCH_BETA          0.1f
+
+typedef struct _tBenchImu {
+    float gx, gy, gz, ax, ay, az;
+}tBenchImu;
+
+static tBenchImu benchInput[BENCH_INPUT_COUNT];
+static uint32_t benchSeed = 0x12345678;
+
+// 参考实现的状态，与原实现一样为volatile全局变量
+static volatile float refQ0 = 1.0f, refQ1 = 0.0f, refQ2 = 0.0f, refQ3 = 0.0f;
+static float refSnapshot[2][4];
+static tSeqLatch refLatch = {{0}, {refSnapshot[0], refSnapshot[1]}, sizeof(refSnapshot[0])};
+
+static uint32_t benchRand(void) {
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return benchSeed;
+}
+
+// [-amp, amp)内的均匀噪声
+static float benchNoise(float amp) {
+    return ((float)(benchRand() >> 8) * (1.0f / 8388608.0f) - 1.0f) * amp;
+}
+
+/**
+ * @brief 生成合成的六轴数据：三轴陀螺仪为不同频率的正弦转动(rad/s)，加速度计为带噪声的重力方向(g)
+ *
+ * @return void
+ */
+static void benchInputInit(void) {
+    uint32_t i;
+
+    for (i = 0; i < BENCH_INPUT_COUNT; i++) {
+        float t = (float)i * BENCH_DT;
+        benchInput[i].gx = 0.8f * sinf(6.0f * t) + benchNoise(0.01f);
+        benchInput[i].gy = 0.5f * sinf(9.0f * t + 1.0f) + benchNoise(0.01f);
+        benchInput[i].gz = 0.3f * cosf(4.0f * t) + benchNoise(0.01f);
+        benchInput[i].ax = 0.2f * sinf(3.0f * t) + benchNoise(0.02f);
+        benchInput[i].ay = 0.2f * cosf(5.0f * t) + benchNoise(0.02f);
+        benchInput[i].az = 0.95f + benchNoise(0.02f);
+    }
+}
+
+// 原实现中的快速平方根倒数，原先经long指针转换，主机上long为64位，这里改用联合体
+static float refInvSqrt(float x) {
+    float halfx = 0.5f * x;
+    union {
+        float f;
+        uint32_t i;
+    } y;
+
+    y.f = x;
+    y.i = 0x5f3759df - (y.i >> 1);
+    y.f = y.f * (1.5f - (halfx * y.f * y.f));
+    return y.f;
+}
+
+// 原实现的IMU更新，逐行保留，只把全局变量换成参考状态
+static void refUpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    float recipNorm;
+    float s0, s1, s2, s3;
+    float qDot1, qDot2, qDot3, qDot4;
+    float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2 ,_8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
+    float q[4];
+
+    qDot1 = 0.5f * (-refQ1 * gx - refQ2 * gy - refQ3 * gz);
+    qDot2 = 0.5f * (refQ0 * gx + refQ2 * gz - refQ3 * gy);
+    qDot3 = 0.5f * (refQ0 * gy - refQ1 * gz + refQ3 * gx);
+    qDot4 = 0.5f * (refQ0 * gz + refQ1 * gy - refQ2 * gx);
+
+    if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+       recipNorm = refInvSqrt(ax * ax + ay * ay + az * az);
+       ax *= recipNorm;
+       ay *= recipNorm;
+       az *= recipNorm;
+
+       _2q0 = 2.0f * refQ0;
+       _2q1 = 2.0f * refQ1;
+       _2q2 = 2.0f * refQ2;
+       _2q3 = 2.0f * refQ3;
+       _4q0 = 4.0f * refQ0;
+       _4q1 = 4.0f * refQ1;
+       _4q2 = 4.0f * refQ2;
+       _8q1 = 8.0f * refQ1;
+       _8q2 = 8.0f * refQ2;
+       q0q0 = refQ0 * refQ0;
+       q1q1 = refQ1 * refQ1;
+       q2q2 = refQ2 * refQ2;
+       q3q3 = refQ3 * refQ3;
+
+       s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+       s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * refQ1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+       s2 = 4.0f * q0q0 * refQ2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+       s3 = 4.0f * q1q1 * refQ3 - _2q1 * ax + 4.0f * q2q2 * refQ3 - _2q2 * ay;
+       recipNorm = refInvSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+       s0 *= recipNorm;
+       s1 *= recipNorm;
+       s2 *= recipNorm;
+       s3 *= recipNorm;
+
+       qDot1 -= beta * s0;
+       qDot2 -= beta * s1;
+       qDot3 -= beta * s2;
+       qDot4 -= beta * s3;
+    }
+
+    refQ0 += qDot1 * dt;
+    refQ1 += qDot2 * dt;
+    refQ2 += qDot3 * dt;
+    refQ3 += qDot4 * dt;
+
+    recipNorm = refInvSqrt(refQ0 * refQ0 + refQ1 * refQ1 + refQ2 * refQ2 + refQ3 * refQ3);
+    refQ0 *= recipNorm;
+    refQ1 *= recipNorm;
+    refQ2 *= recipNorm;
+    refQ3 *= recipNorm;
+    q[0] = refQ0; q[1] = refQ1; q[2] = refQ2; q[3] = refQ3;
+    tSeqLatchWrite(&refLatch, q);
+}
+
+static void benchReset(void) {
+    beta = BENCH_BETA;
+    q0 = 1.0f; q1 = 0.0f; q2 = 0.0f; q3 = 0.0f;
+    refQ0 = 1.0f; refQ1 = 0.0f; refQ2 = 0.0f; refQ3 = 0.0f;
+}
+
+/**
+ * @brief 两种实现各自从单位四元数出发处理同一组数据，返回四元数分量的最大偏差
+ *
+ * @return float 最大偏差
+ */
+static float benchVerify(void) {
+    uint32_t i;
+    float maxErr = 0.0f;
+
+    benchReset();
+    for (i = 0; i < BENCH_CHECK_STEPS; i++) {
+        const tBenchImu * in = &benchInput[i % BENCH_INPUT_COUNT];
+        float err;
+
+        MadgwickAHRSupdateIMU(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, BENCH_DT);
+        refUpdateIMU(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, BENCH_DT);
+        err = fabsf(q0 - refQ0) + fabsf(q1 - refQ1) + fabsf(q2 - refQ2) + fabsf(q3 - refQ3);
+        if (err > maxErr) {
+            maxErr = err;
+        }
+    }
+    return maxErr;
+}
+
+#if defined(TINYOS_PORT_POSIX)
+
+#define BENCH_ROUNDS        2000        //计时的轮数，每轮处理一遍全部样本
+
+static uint64_t benchNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void benchTime(const char * name, void (*update)(float, float, float, float, float, float, float)) {
+    uint32_t r, i;
+    uint64_t ops = (uint64_t)BENCH_ROUNDS * BENCH_INPUT_COUNT;
+    uint64_t start;
+    uint64_t ns;
+
+    benchReset();
+    start = benchNowNs();
+    for (r = 0; r < BENCH_ROUNDS; r++) {
+        for (i = 0; i < BENCH_INPUT_COUNT; i++) {
+            const tBenchImu * in = &benchInput[i];
+            update(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, BENCH_DT);
+        }
+    }
+    ns = benchNowNs() - start;
+    printf("HOST,%s,%llu,%.2f\n", name, (unsigned long long)ops, (double)ns / ops);
+}
+
+int main(void) {
+    float maxErr;
+
+    benchInputInit();
+    maxErr = benchVerify();
+    if (!(maxErr <= BENCH_TOLERANCE)) {
+        printf("#FAIL,max_error=%g\n", (double)maxErr);
+        return 1;
+    }
+    printf("#CHECK,ok,%u,max_error=%g\n", BENCH_CHECK_STEPS, (double)maxErr);
+
+    printf("#HOST,test,ops,ns_per_op\n");
+    benchTime("madgwick_imu_ref", refUpdateIMU);
+    benchTime("madgwick_imu", MadgwickAHRSupdateIMU);
+    printf("#END\n");
+    return 0;
+}
+
+#else
+
+static void benchTime(const char * name, void (*update)(float, float, float, float, float, float, float), uint32_t overhead) {
+    uint32_t i;
+    uint32_t minCycles = 0xFFFFFFFF;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+
+    benchReset();
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        const tBenchImu * in = &benchInput[i % BENCH_INPUT_COUNT];
+        uint32_t start = tCycleCounterGet();
+        uint32_t cycles;
+
+        update(in->gx, in->gy, in->gz, in->ax, in->ay, in->az, BENCH_DT);
+        cycles = tCycleCounterGet() - start;
+        cycles = (cycles > overhead) ? (cycles - overhead) : 0;
+        totalCycles += cycles;
+        if (cycles < minCycles) {
+            minCycles = cycles;
+        }
+        if (cycles > maxCycles) {
+            maxCycles = cycles;
+        }
+    }
+    printf("BENCH,%s,%lu,%lu,%lu,%lu\r\n", name, (unsigned long)TINYOS_BENCH_SAMPLES, (unsigned long)minCycles,
+           (unsigned long)(totalCycles / TINYOS_BENCH_SAMPLES), (unsigned long)maxCycles);
+}
+
+/**
+ * @brief 比对并计时两种Madgwick IMU更新，比对的最大偏差以"#MADGWICK_CHECK"行输出
+ *
+ * @param overhead 读取周期计数器本身的开销，从每个样本中扣除
+ *
+ * @return void
+ */
+void MadgwickBench_Run(uint32_t overhead) {
+    float maxErr;
+
+    benchInputInit();
+    maxErr = benchVerify();
+    printf("#MADGWICK_CHECK,%s,%lu,max_error_ppm=%lu\r\n", (maxErr <= BENCH_TOLERANCE) ? "ok" : "fail",
+           (unsigned long)BENCH_CHECK_STEPS, (unsigned long)(maxErr * 1000000.0f));
+    benchTime("madgwick_imu_ref", refUpdateIMU, overhead);
+    benchTime("madgwick_imu", MadgwickAHRSupdateIMU, overhead);
+
+    // 恢复为单位四元数，不影响之后姿态解算的初值
+    q0 = 1.0f; q1 = 0.0f; q2 = 0.0f; q3 = 0.0f;
+    MadgwickPublishQuaternion();
+}
+
+#endif
+
+#endif
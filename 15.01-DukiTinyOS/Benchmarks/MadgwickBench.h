@@ -0,0 +1,8 @@
+#ifndef __MADGWICKBENCH_H
+#define __MADGWICKBENCH_H
+
+#include <stdint.h>
+
+void MadgwickBench_Run(uint32_t overhead); // 比对并计时Madgwick IMU更新，overhead为读取周期计数器的开销
+
+#endif // __MADGWICKBENCH_H
@@ -0,0 +1,574 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "AttitudeEstimator.h"
+#include "AttitudeQuat.h"
+#include "MadgWick.h"
+#include "MyMadgWick.h"
+#include "PID.h"
+#include "Blackbox.h"
+#include "DeltaCodec.h"
+#include "FlightPipeline.h"
+#include "Receiver.h"
+
+// 黑匣子日志的主机回放：解码Blackbox.c写入外部Flash的日志(读出的Flash映像或其中一段)，把记录的陀螺仪、
+// 加速度计数据依次送入各姿态估计器，把记录的接收机脉宽、姿态角及角速度送入与飞行流水线相同的串级PID，
+// 统计每次更新的耗时，以及姿态与参考数据、PID输出与记录值的差异。Attitude/下的源文件不做修改，
+// 经BSP头文件包含的main.h由Benchmarks/Host/main.h代替。修改融合或控制算法后重新编译回放，速度与精度一起对比。
+// 编译运行(在工程根目录下)：
+//   gcc -O2 -DTINYOS_PORT_POSIX -IBenchmarks/Host -ISource -IPort/Posix -IAttitude -IBSP -o replaybench
+//       Benchmarks/ReplayBench.c Attitude/MadgWick.c Attitude/MyMadgWick.c Attitude/AttitudeEstimator.c
+//       Attitude/Mahony.c Attitude/AttitudeEKF.c Attitude/Complementary.c Attitude/PID.c Attitude/DeltaCodec.c
+//       Source/tSeqLock.c -lm
+//   ./replaybench 日志文件 [-l 第几段日志] [-r 参考数据.csv] [-g 增益] [-s 跳过的秒数] [-n 计时重复次数]
+// 参考数据为每行time_us,roll,pitch,yaw(°)的CSV，如动作捕捉的结果，按时间取不晚于该帧的最近一行；
+// 不给出时以日志中记录的机载姿态为参考，即与飞行时的估计器比较。估计器需要日志中有accSmooth字段
+// (BLACKBOX_FIELDS中加入BLACKBOX_FIELD_ACCEL)；记录的陀螺仪已扣除零偏，如开启了滤波也是滤波后的值。
+// 接收机按Receiver.h中各通道的默认校准换算杆量，PID使用PIDAttitude_Init的默认参数，与机上保存过的参数不同时差异即来自参数。
+// 输出格式：REPLAY,<估计器>,<更新次数>,<每秒更新次数>,<每次纳秒数>,<滚转/俯仰/偏航误差的均方根>,<最大倾斜误差>(°)；
+//           CONTROL,rate_pid,<更新次数>,<每秒更新次数>,<每次纳秒数>,<三轴输出差的均方根>,<最大差值>
+
+#define REPLAY_FIELD_MAX    DELTA_CODEC_MAX_CHANNELS
+#define REPLAY_DT_MAX       0.1f    // 时间戳间隔超过该值(如丢帧)时按标称间隔积分
+#define REPLAY_REPEAT       20      // 计时的默认重复次数
+
+// 解码后的一帧，已换算为原来的单位
+typedef struct _ReplayFrame {
+    uint32_t timeUs;
+    float gyro[3];          // rad/s
+    float accel[3];         // g
+    float attitude[3];      // 机载姿态(°)
+    float axisSum[3];       // 内环输出
+    float ref[3];           // 参考姿态(°)
+    uint16_t rc[4];         // 接收机脉宽(us)
+    uint8_t armed;
+} ReplayFrame;
+
+// 日志中各字段组第一个字段的下标，没有该字段组时为-1
+typedef struct _ReplayLayout {
+    int gyro, accel, attitude, axisSum, motor, rc;
+    uint32_t fields;        // time之后的字段数
+} ReplayLayout;
+
+// 一个被比较的估计器：复位、更新、读取四元数
+typedef struct _ReplayEstimator {
+    const char *name;
+    void (*reset)(float gain);
+    void (*update)(const ReplayFrame *frame, float dt);
+    void (*get)(float *q);
+} ReplayEstimator;
+
+static ReplayFrame *replayFrames;
+static uint32_t replayCount;
+static ReplayLayout replayLayout;
+static uint32_t replayCorrupt;
+static float replayNominalDt = (float)BLACKBOX_RATE_DIV / FLIGHT_RATE_HZ;
+
+static uint64_t replayNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+//************************** 估计器 **************************
+
+static void replayMadgwickReset(float gain) {
+    beta = gain;
+    q0 = 1.0f; q1 = 0.0f; q2 = 0.0f; q3 = 0.0f;
+    MadgwickPublishQuaternion();
+}
+
+static void replayMadgwickUpdate(const ReplayFrame *f, float dt) {
+    MadgwickAHRSupdateIMU(f->gyro[0], f->gyro[1], f->gyro[2], f->accel[0], f->accel[1], f->accel[2], dt);
+}
+
+static void replayMyMadgwickReset(float gain) {
+    (void)gain;
+    MyMadgWick_Reset();
+}
+
+static void replayMyMadgwickUpdate(const ReplayFrame *f, float dt) {
+    merge(f->accel[0], f->accel[1], f->accel[2], f->gyro[0], f->gyro[1], f->gyro[2], dt);
+}
+
+static void replayMyMadgwickGet(float *q) {
+    quaternion snapshot;
+
+    MyMadgWick_GetQuaternion(&snapshot);
+    AttitudeQuat_Store(q, snapshot);
+}
+
+#if (ATTITUDE_ESTIMATOR != ATTITUDE_ESTIMATOR_MADGWICK) && (ATTITUDE_ESTIMATOR != ATTITUDE_ESTIMATOR_MYMADGWICK)
+static void replayEstimatorUpdate(const ReplayFrame *f, float dt) {
+    AttitudeEstimator_UpdateIMU(f->gyro[0], f->gyro[1], f->gyro[2], f->accel[0], f->accel[1], f->accel[2], dt);
+}
+#endif
+
+// MadgWick.c、MyMadgWick.c直接调用；ATTITUDE_ESTIMATOR选定其它后端时另经估计器接口比较该后端
+static const ReplayEstimator replayEstimators[] = {
+    {"madgwick", replayMadgwickReset, replayMadgwickUpdate, MadgwickGetQuaternion},
+    {"mymadgwick", replayMyMadgwickReset, replayMyMadgwickUpdate, replayMyMadgwickGet},
+#if (ATTITUDE_ESTIMATOR != ATTITUDE_ESTIMATOR_MADGWICK) && (ATTITUDE_ESTIMATOR != ATTITUDE_ESTIMATOR_MYMADGWICK)
+    {(const char *)0, AttitudeEstimator_Init, replayEstimatorUpdate, AttitudeEstimator_GetQuaternion},
+#endif
+};
+
+//************************** 日志解码 **************************
+
+// 在header中找出名为name[0]的字段组，返回其第一个字段在time之后的下标
+static int replayFindField(const char *names, const char *group) {
+    char key[40];
+    const char *p;
+    int index = 0;
+
+    snprintf(key, sizeof(key), ",%s[0]", group);
+    p = strstr(names, key);
+    if (p == (const char *)0) {
+        return -1;
+    }
+    // 前两个字段为loopIteration、time，之后的逗号数即为下标
+    for (names = strchr(names, ','); (names != (const char *)0) && (names < p); names = strchr(names + 1, ',')) {
+        index++;
+    }
+    return index - 1;
+}
+
+// 解析文件头，返回第一帧的位置，没有字段名时返回0
+static uint32_t replayParseHeader(const uint8_t *data, uint32_t len, uint32_t pos) {
+    char line[512];
+    uint8_t found = 0;
+
+    while ((pos + 2 < len) && (data[pos] == 'H') && (data[pos + 1] == ' ')) {
+        uint32_t n = 0;
+
+        while ((pos < len) && (data[pos] != '\n')) {
+            if (n < sizeof(line) - 1) {
+                line[n++] = (char)data[pos];
+            }
+            pos++;
+        }
+        line[n] = '\0';
+        pos++;
+        if (strncmp(line, "H Field I name:", 15) == 0) {
+            const char *c;
+
+            replayLayout.fields = 0;
+            for (c = strchr(line, ','); c != (const char *)0; c = strchr(c + 1, ',')) {
+                replayLayout.fields++;
+            }
+            replayLayout.fields--;  // 不含time
+            replayLayout.gyro = replayFindField(line, "gyroADC");
+            replayLayout.accel = replayFindField(line, "accSmooth");
+            replayLayout.attitude = replayFindField(line, "attitude");
+            replayLayout.axisSum = replayFindField(line, "axisSum");
+            replayLayout.motor = replayFindField(line, "motor");
+            replayLayout.rc = replayFindField(line, "rcCommand");
+            found = 1;
+        }
+    }
+    return (found && (replayLayout.fields <= REPLAY_FIELD_MAX)) ? pos : 0;
+}
+
+// 一帧的整数字段换算为原来的单位，与Blackbox_Log中的换算相反
+static void replayConvert(ReplayFrame *f, uint32_t timeUs, const int32_t *v) {
+    const ReplayLayout *l = &replayLayout;
+    int i;
+
+    memset(f, 0, sizeof(*f));
+    f->timeUs = timeUs;
+    f->armed = 1;
+    for (i = 0; i < 3; i++) {
+        if (l->gyro >= 0) {
+            f->gyro[i] = (float)v[l->gyro + i] * (0.1f * ATTITUDE_DEG_TO_RAD);
+        }
+        if (l->accel >= 0) {
+            f->accel[i] = (float)v[l->accel + i] * 0.001f;
+        }
+        if (l->attitude >= 0) {
+            f->attitude[i] = (float)v[l->attitude + i] * 0.1f;
+        }
+        if (l->axisSum >= 0) {
+            f->axisSum[i] = (float)v[l->axisSum + i] * 0.1f;
+        }
+    }
+    if (l->rc >= 0) {
+        for (i = 0; i < 4; i++) {
+            f->rc[i] = (uint16_t)v[l->rc + i];
+        }
+    }
+    // 未解锁时电机为最低值且PID清零
+    if (l->motor >= 0) {
+        f->armed = 0;
+        for (i = 0; i < 4; i++) {
+            if (v[l->motor + i] > 1000) {
+                f->armed = 1;
+            }
+        }
+    }
+    for (i = 0; i < 3; i++) {
+        f->ref[i] = f->attitude[i];
+    }
+}
+
+/**
+ * @brief 解码第logIndex段日志(从0开始)的所有帧
+ *
+ * @return 帧数，找不到日志时返回0
+ */
+static uint32_t replayDecode(const uint8_t *data, uint32_t len, uint32_t logIndex) {
+    static const char magic[] = "H Product:";
+    DeltaCodec codec;
+    int32_t values[REPLAY_FIELD_MAX];
+    uint32_t capacity = 0;
+    uint32_t timeUs = 0;
+    uint32_t pos, i;
+    uint8_t synced = 0;
+
+    // 各段日志都从文件头开始
+    for (pos = 0; pos + sizeof(magic) - 1 <= len; pos++) {
+        if (memcmp(data + pos, magic, sizeof(magic) - 1) == 0) {
+            if (logIndex == 0) {
+                break;
+            }
+            logIndex--;
+        }
+    }
+    if (pos + sizeof(magic) - 1 > len) {
+        return 0;
+    }
+    pos = replayParseHeader(data, len, pos);
+    if (pos == 0) {
+        return 0;
+    }
+    DeltaCodec_Init(&codec, replayLayout.fields, DELTA_PREDICT_PREVIOUS);
+
+    while (pos < len) {
+        uint8_t type = data[pos];
+        uint32_t n;
+
+        if (type == 'E') {
+            break;      // 结束事件
+        }
+        if (type == 'I') {
+            uint32_t iteration;
+
+            DeltaCodec_Reset(&codec);
+            n = DeltaCodec_GetUnsigned(data + pos + 1, len - pos - 1, &iteration);
+            i = n ? DeltaCodec_GetUnsigned(data + pos + 1 + n, len - pos - 1 - n, &timeUs) : 0;
+            if (i == 0) {
+                break;
+            }
+            n += i;
+            synced = 1;
+        } else if ((type == 'P') && synced) {
+            int32_t delta;
+
+            n = DeltaCodec_GetSigned(data + pos + 1, len - pos - 1, &delta);
+            if (n == 0) {
+                break;
+            }
+            timeUs += (uint32_t)delta;
+        } else {
+            // 损坏的数据：逐字节跳过，直到下一个I帧重新同步
+            replayCorrupt++;
+            synced = 0;
+            pos++;
+            continue;
+        }
+        pos += 1 + n;
+        n = DeltaCodec_Decode(&codec, data + pos, len - pos, values);
+        if (n == 0) {
+            break;
+        }
+        pos += n;
+
+        if (replayCount == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            replayFrames = (ReplayFrame *)realloc(replayFrames, capacity * sizeof(ReplayFrame));
+            if (replayFrames == (ReplayFrame *)0) {
+                return 0;
+            }
+        }
+        replayConvert(&replayFrames[replayCount++], timeUs, values);
+    }
+    return replayCount;
+}
+
+// 读入参考数据，按时间戳给每帧取不晚于它的最近一行
+static int replayLoadRef(const char *path) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    uint32_t frame = 0;
+    unsigned long t;
+    float r[3];
+    uint8_t have = 0;
+    float last[3] = {0.0f, 0.0f, 0.0f};
+
+    if (fp == (FILE *)0) {
+        return 1;
+    }
+    while ((frame < replayCount) && fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "%lu,%f,%f,%f", &t, &r[0], &r[1], &r[2]) != 4) {
+            continue;   // 表头或注释
+        }
+        while ((frame < replayCount) && ((int32_t)(replayFrames[frame].timeUs - (uint32_t)t) < 0)) {
+            if (have) {
+                memcpy(replayFrames[frame].ref, last, sizeof(last));
+            }
+            frame++;
+        }
+        memcpy(last, r, sizeof(last));
+        have = 1;
+    }
+    for (; have && (frame < replayCount); frame++) {
+        memcpy(replayFrames[frame].ref, last, sizeof(last));
+    }
+    fclose(fp);
+    return 0;
+}
+
+//************************** 回放 **************************
+
+// 由时间戳求积分步长，不合理时用标称间隔
+static float replayDt(uint32_t i) {
+    float dt;
+
+    if (i == 0) {
+        return replayNominalDt;
+    }
+    dt = (float)(replayFrames[i].timeUs - replayFrames[i - 1].timeUs) * 1e-6f;
+    return ((dt > 0.0f) && (dt < REPLAY_DT_MAX)) ? dt : replayNominalDt;
+}
+
+static float replayWrap180(float deg) {
+    while (deg > 180.0f) {
+        deg -= 360.0f;
+    }
+    while (deg < -180.0f) {
+        deg += 360.0f;
+    }
+    return deg;
+}
+
+// 一个估计器：第一遍统计误差，之后重复多遍只计时
+static void replayEstimator(const ReplayEstimator *est, float gain, uint32_t skip, uint32_t repeat) {
+    double sum[3] = {0.0, 0.0, 0.0};
+    float maxTilt = 0.0f;
+    uint32_t counted = 0;
+    uint64_t start, ns;
+    uint32_t r, i;
+    int k;
+
+    est->reset(gain);
+    for (i = 0; i < replayCount; i++) {
+        float q[4], e[3];
+
+        est->update(&replayFrames[i], replayDt(i));
+        if (i < skip) {
+            continue;
+        }
+        est->get(q);
+        AttitudeEstimator_QuaternionToEuler(q, &e[0], &e[1], &e[2]);
+        for (k = 0; k < 3; k++) {
+            float d = replayWrap180(e[k] - replayFrames[i].ref[k]);
+            sum[k] += (double)d * d;
+            if ((k < 2) && ((d > maxTilt) || (-d > maxTilt))) {
+                maxTilt = (d < 0.0f) ? -d : d;
+            }
+        }
+        counted++;
+    }
+
+    start = replayNowNs();
+    for (r = 0; r < repeat; r++) {
+        est->reset(gain);
+        for (i = 0; i < replayCount; i++) {
+            est->update(&replayFrames[i], replayDt(i));
+        }
+    }
+    ns = replayNowNs() - start;
+
+    printf("REPLAY,%s,%lu,%.0f,%.1f", est->name ? est->name : AttitudeEstimator_GetName(),
+           (unsigned long)replayCount * repeat, ns ? (double)replayCount * repeat * 1e9 / ns : 0.0,
+           (double)ns / ((double)replayCount * repeat));
+    for (k = 0; k < 3; k++) {
+        printf(",%.3f", counted ? sqrt(sum[k] / counted) : 0.0);
+    }
+    printf(",%.3f\n", maxTilt);
+}
+
+// 杆量(0 ~ 1)，按通道的默认校准换算
+static float replayStick(uint16_t width, uint16_t min, uint16_t max) {
+    float v = ((float)width - (float)min) / (float)(max - min);
+
+    return AttitudeClamp(v, 0.0f, 1.0f);
+}
+
+// 与飞行流水线相同的串级PID：姿态环每FLIGHT_ATTITUDE_DIV个控制周期一次，角速度环每帧一次；
+// 日志每BLACKBOX_RATE_DIV个控制周期一帧，两级都按日志的帧率换算周期
+static void replayControl(uint32_t skip, uint32_t repeat) {
+    PIDAttitude defaults;
+    PIDAxis3 angle, rate;
+    uint32_t attitudeDiv = (FLIGHT_ATTITUDE_DIV > BLACKBOX_RATE_DIV) ? (FLIGHT_ATTITUDE_DIV / BLACKBOX_RATE_DIV) : 1;
+    double sum[3] = {0.0, 0.0, 0.0};
+    float maxDiff = 0.0f;
+    uint32_t counted = 0;
+    uint64_t start = 0, ns = 0;
+    uint32_t r, i;
+    PIDGains gains;
+    int k;
+
+    for (r = 0; r <= repeat; r++) {
+        float rateRef[3] = {0.0f, 0.0f, 0.0f};
+
+        PIDAttitude_Init(&defaults, 1.0f / FLIGHT_RATE_HZ);
+        PIDAxis3_Init(&angle, replayNominalDt * attitudeDiv, 0.0f);
+        PIDAxis3_Init(&rate, replayNominalDt, PID_RATE_DERIV_CUTOFF_HZ);
+        for (k = 0; k < PID_AXIS_COUNT; k++) {
+            PIDAxis3_GetGains(&defaults.angle, k, &gains);
+            PIDAxis3_SetGains(&angle, k, &gains);
+            PIDAxis3_GetGains(&defaults.rate, k, &gains);
+            PIDAxis3_SetGains(&rate, k, &gains);
+        }
+        // 第一遍统计差异，之后只计时
+        if (r == 1) {
+            start = replayNowNs();
+        }
+        for (i = 0; i < replayCount; i++) {
+            const ReplayFrame *f = &replayFrames[i];
+
+            if (!f->armed) {
+                PIDAxis3_Reset(&angle);
+                PIDAxis3_Reset(&rate);
+                rateRef[0] = rateRef[1] = rateRef[2] = 0.0f;
+                continue;
+            }
+            if ((i % attitudeDiv) == 0) {
+                float angleRef[3];
+
+                angleRef[PID_AXIS_ROLL] = (replayStick(f->rc[CHANNEL4_INDEX], MIN_MOTORVAL14, MAX_MOTORVAL14) - 0.5f) * 2.0f * FLIGHT_MAX_ANGLE_DEG;
+                angleRef[PID_AXIS_PITCH] = (replayStick(f->rc[CHANNEL3_INDEX], MIN_MOTORVAL3, MAX_MOTORVAL3) - 0.5f) * 2.0f * FLIGHT_MAX_ANGLE_DEG;
+                angleRef[PID_AXIS_YAW] = 0.0f;
+                PIDAxis3_Calc(&angle, angleRef, f->attitude);
+                rateRef[PID_AXIS_ROLL] = angle.output[PID_AXIS_ROLL];
+                rateRef[PID_AXIS_PITCH] = angle.output[PID_AXIS_PITCH];
+                rateRef[PID_AXIS_YAW] = (replayStick(f->rc[CHANNEL1_INDEX], MIN_MOTORVAL14, MAX_MOTORVAL14) - 0.5f) * 2.0f * FLIGHT_MAX_YAW_RATE;
+            }
+            PIDAxis3_Calc(&rate, rateRef, f->gyro);
+            if ((r == 0) && (i >= skip) && (replayLayout.axisSum >= 0)) {
+                for (k = 0; k < 3; k++) {
+                    float d = rate.output[k] - f->axisSum[k];
+                    sum[k] += (double)d * d;
+                    if ((d > maxDiff) || (-d > maxDiff)) {
+                        maxDiff = (d < 0.0f) ? -d : d;
+                    }
+                }
+                counted++;
+            }
+        }
+    }
+    if (repeat > 0) {
+        ns = replayNowNs() - start;
+    }
+
+    printf("CONTROL,rate_pid,%lu,%.0f,%.1f", (unsigned long)replayCount * repeat,
+           ns ? (double)replayCount * repeat * 1e9 / ns : 0.0, repeat ? (double)ns / ((double)replayCount * repeat) : 0.0);
+    for (k = 0; k < 3; k++) {
+        printf(",%.3f", counted ? sqrt(sum[k] / counted) : 0.0);
+    }
+    printf(",%.3f\n", maxDiff);
+}
+
+static int replayUsage(const char *prog) {
+    fprintf(stderr, "usage: %s log [-l index] [-r ref.csv] [-g gain] [-s skip_s] [-n repeat]\n", prog);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    const char *logPath = (const char *)0;
+    const char *refPath = (const char *)0;
+    uint32_t logIndex = 0;
+    uint32_t repeat = REPLAY_REPEAT;
+    float gain = 0.8f;      // 与AttitudePIDController_Init中的增益相同
+    float skipSec = 2.0f;   // 跳过开始阶段的收敛过程
+    uint32_t skip;
+    uint8_t *data;
+    long len;
+    FILE *fp;
+    uint32_t i;
+    int a;
+
+    for (a = 1; a < argc; a++) {
+        if ((argv[a][0] == '-') && (a + 1 < argc)) {
+            switch (argv[a][1]) {
+            case 'l': logIndex = (uint32_t)strtoul(argv[++a], (char **)0, 0); break;
+            case 'r': refPath = argv[++a]; break;
+            case 'g': gain = strtof(argv[++a], (char **)0); break;
+            case 's': skipSec = strtof(argv[++a], (char **)0); break;
+            case 'n': repeat = (uint32_t)strtoul(argv[++a], (char **)0, 0); break;
+            default: return replayUsage(argv[0]);
+            }
+        } else if (logPath == (const char *)0) {
+            logPath = argv[a];
+        } else {
+            return replayUsage(argv[0]);
+        }
+    }
+    if (logPath == (const char *)0) {
+        return replayUsage(argv[0]);
+    }
+
+    fp = fopen(logPath, "rb");
+    if (fp == (FILE *)0) {
+        fprintf(stderr, "cannot open %s\n", logPath);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = (uint8_t *)malloc(len > 0 ? (size_t)len : 1);
+    if ((data == (uint8_t *)0) || (fread(data, 1, (size_t)len, fp) != (size_t)len)) {
+        fprintf(stderr, "cannot read %s\n", logPath);
+        return 1;
+    }
+    fclose(fp);
+
+    if ((replayDecode(data, (uint32_t)len, logIndex) == 0) || (replayLayout.gyro < 0)) {
+        printf("#FAIL,no frames with gyroADC in log %lu\n", (unsigned long)logIndex);
+        return 1;
+    }
+    if ((refPath != (const char *)0) && replayLoadRef(refPath)) {
+        printf("#FAIL,cannot read %s\n", refPath);
+        return 1;
+    }
+    if (replayCount > 1) {
+        replayNominalDt = (float)(replayFrames[replayCount - 1].timeUs - replayFrames[0].timeUs) * 1e-6f / (replayCount - 1);
+    }
+    skip = (uint32_t)(skipSec / replayNominalDt);
+
+    printf("#LOG,%s,index=%lu,frames=%lu,corrupt_bytes=%lu,rate_hz=%.1f,reference=%s\n", logPath,
+           (unsigned long)logIndex, (unsigned long)replayCount, (unsigned long)replayCorrupt,
+           1.0f / replayNominalDt, refPath ? refPath : "onboard");
+
+    if (replayLayout.accel >= 0) {
+        printf("#REPLAY,estimator,updates,updates_per_s,ns_per_update,rms_roll,rms_pitch,rms_yaw,max_tilt\n");
+        for (i = 0; i < sizeof(replayEstimators) / sizeof(replayEstimators[0]); i++) {
+            replayEstimator(&replayEstimators[i], gain, skip, repeat);
+        }
+    } else {
+        printf("#SKIP,estimators,no accSmooth fields (add BLACKBOX_FIELD_ACCEL to BLACKBOX_FIELDS)\n");
+    }
+
+    if ((replayLayout.attitude >= 0) && (replayLayout.rc >= 0)) {
+        printf("#CONTROL,loop,updates,updates_per_s,ns_per_update,rms_roll,rms_pitch,rms_yaw,max_diff\n");
+        replayControl(skip, repeat);
+    } else {
+        printf("#SKIP,control,no attitude/rcCommand fields\n");
+    }
+    printf("#END\n");
+    free(replayFrames);
+    free(data);
+    return 0;
+}
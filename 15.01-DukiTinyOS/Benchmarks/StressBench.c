@@ -0,0 +1,377 @@
+#include "tinyOS.h"
+#include "tPort.h"
+#include "MySerial.h"
+#include <string.h>
+
+#if TINYOS_ENABLE_BENCHMARK == 3
+
+// 中断风暴及过载压力测试，开启TINYOS_ENABLE_BENCHMARK为3时代替app.c中的演示任务
+// 三个APB2定时器产生中断：
+//   TIM9 风暴中断，频率按stressRates逐级提高，每次中断轮流释放信号量、向邮箱发消息、置事件标志，各有一个任务消费
+//   TIM10 随机唤醒，间隔在STRESS_WAKEUP_US的0.5~1.5倍之间随机，每次唤醒随机一个工作任务做一段忙等的计算
+//   TIM11 固定频率释放最高优先级的周期任务，中断中记下周期计数，任务中求释放延迟
+// 三者及SysTick同为TINYOS_MAX_SYSCALL_PRIO，风暴越密，周期任务的释放越可能排在风暴中断及内核临界区之后。
+// 每一级运行STRESS_PHASE_MS后停止全部定时器再输出一行：
+//   STRESS,<风暴频率>,<风暴中断数>,<释放次数>,<最小延迟>,<平均延迟>,<最大延迟>,<错过的释放>,<节拍漂移>,
+//          <信号量溢出>,<邮箱溢出>,<标志合并>,<随机唤醒>,<唤醒合并>,<工作任务运行次数>
+// 延迟为周期数，已减去读取周期计数器的开销；节拍漂移为节拍计数减去按周期计数器推算的节拍数，负数表示丢失了节拍；
+// 风暴中断数少于频率乘以时长说明中断来不及处理，更新标志被合并。信号量及邮箱满时的释放计为溢出
+
+#define STRESS_PRIO_PERIODIC    1           //被测的周期任务
+#define STRESS_PRIO_CTRL        2           //控制任务，各级运行期间在延时中
+#define STRESS_PRIO_CONSUMER    3           //信号量、邮箱及标志组的消费任务
+#define STRESS_PRIO_WORKER      4           //随机唤醒的工作任务
+#define STRESS_STACK_SIZE       256         //每个辅助任务的栈(字)
+#define STRESS_PHASE_MS         2000        //每一级的运行时间，需小于周期计数器回绕的时间
+#define STRESS_SETTLE_MS        100         //启动定时器后开始统计前的等待
+#define STRESS_PERIOD_HZ        1000        //周期任务的释放频率
+#define STRESS_WAKEUP_US        500         //随机唤醒的平均间隔，0为不做随机唤醒
+#define STRESS_WORKERS          4           //工作任务数
+#define STRESS_WORK_CYCLES      2000        //工作任务每次唤醒忙等的周期数
+#define STRESS_QUEUE_DEPTH      8           //风暴信号量的最大计数及邮箱容量
+
+// 各级风暴中断频率(Hz)，0为只有周期任务及随机唤醒的基线
+static const uint32_t stressRates[] = {0, 5000, 10000, 20000, 40000, 60000, 80000};
+
+typedef struct _tStressStat {
+    uint32_t stormIrqs;
+    uint32_t releases;
+    uint32_t runs;
+    uint32_t latMin;
+    uint32_t latMax;
+    uint64_t latTotal;
+    uint32_t periodMissed;
+    uint32_t semOverflow;
+    uint32_t mboxOverflow;
+    uint32_t flagCoalesced;
+    uint32_t wakeups;
+    uint32_t wakeupOverflow;
+    uint32_t workerRuns;
+}tStressStat;
+
+static tStressStat stressStat;
+static uint32_t stressOverhead;
+static volatile uint32_t stressReleaseStamp;
+static uint32_t stressRandom = 0x2545F491u;
+
+static tTask stressCtrlTask;
+static tTask stressPeriodicTask;
+static tTask stressSemTask;
+static tTask stressMboxTask;
+static tTask stressFlagTask;
+static tTask stressWorkerTask[STRESS_WORKERS];
+static tTaskStack stressCtrlStack[512];
+static tTaskStack stressPeriodicStack[STRESS_STACK_SIZE];
+static tTaskStack stressSemStack[STRESS_STACK_SIZE];
+static tTaskStack stressMboxStack[STRESS_STACK_SIZE];
+static tTaskStack stressFlagStack[STRESS_STACK_SIZE];
+static tTaskStack stressWorkerStack[STRESS_WORKERS][STRESS_STACK_SIZE];
+
+static tSem stressPeriodSem;
+static tSem stressStormSem;
+static tMbox stressStormMbox;
+static void * stressStormMboxBuffer[STRESS_QUEUE_DEPTH];
+static tFlagGroup stressStormFlag;
+static tSem stressWorkerSem[STRESS_WORKERS];
+
+// xorshift32，只在TIM10中断中调用
+static uint32_t stressRand(void) {
+    uint32_t r = stressRandom;
+
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    stressRandom = r;
+    return r;
+}
+
+//APB2定时器的时钟，APB2分频不为1时为PCLK2的两倍
+static uint32_t stressTimerClock(void) {
+    uint32_t clk = HAL_RCC_GetPCLK2Freq();
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE2) != RCC_CFGR_PPRE2_DIV1) {
+        clk *= 2;
+    }
+    return clk;
+}
+
+/**
+ * @brief 以hz的频率产生更新中断，hz为0时停止；TIM9~11为16位计数器，按需加预分频
+ *
+ * @param tim 定时器
+ * @param hz  中断频率
+ *
+ * @return void
+ */
+static void stressTimerStart(TIM_TypeDef * tim, uint32_t hz) {
+    uint32_t ticks, psc;
+
+    tim->CR1 = 0;
+    tim->DIER = 0;
+    tim->SR = 0;
+    if (hz == 0) {
+        return;
+    }
+    ticks = stressTimerClock() / hz;
+    psc = (ticks - 1) / 0x10000;
+    tim->PSC = psc;
+    tim->ARR = ticks / (psc + 1) - 1;
+    tim->CNT = 0;
+    tim->EGR = TIM_EGR_UG;
+    tim->SR = 0;
+    tim->DIER = TIM_DIER_UIE;
+    tim->CR1 = TIM_CR1_CEN;
+}
+
+//随机唤醒：计数频率1MHz，每次中断重新设置下一次的间隔
+static void stressWakeupStart(void) {
+    TIM10->CR1 = 0;
+    TIM10->DIER = 0;
+    TIM10->SR = 0;
+#if STRESS_WAKEUP_US > 0
+    TIM10->PSC = stressTimerClock() / 1000000 - 1;
+    TIM10->ARR = STRESS_WAKEUP_US - 1;
+    TIM10->CNT = 0;
+    TIM10->EGR = TIM_EGR_UG;
+    TIM10->SR = 0;
+    TIM10->DIER = TIM_DIER_UIE;
+    TIM10->CR1 = TIM_CR1_CEN;
+#endif
+}
+
+/**
+ * @brief 风暴中断：轮流释放信号量、发送邮箱消息、置事件标志
+ *
+ * @return void
+ */
+void TIM1_BRK_TIM9_IRQHandler(void) {
+    uint32_t n;
+
+    tIntEnter();
+    TIM9->SR = ~TIM_SR_UIF;
+    n = stressStat.stormIrqs++;
+    switch (n % 3) {
+        case 0:
+            if (stressStormSem.count >= STRESS_QUEUE_DEPTH) {
+                stressStat.semOverflow++;
+            }
+            tSemNotifyFromISR(&stressStormSem);
+            break;
+        case 1:
+            if (tMboxNotifyFromISR(&stressStormMbox, (void *)n, tMboxSendNormal) != tErrorNoError) {
+                stressStat.mboxOverflow++;
+            }
+            break;
+        default:
+            if (stressStormFlag.flags & 0x1) {
+                stressStat.flagCoalesced++;
+            }
+            tFlagGroupNotifyFromISR(&stressStormFlag, 1, 0x1);
+            break;
+    }
+    tIntExit();
+}
+
+/**
+ * @brief 随机唤醒一个工作任务，并在平均间隔的0.5~1.5倍之间随机选取下一次的间隔
+ *
+ * @return void
+ */
+void TIM1_UP_TIM10_IRQHandler(void) {
+    uint32_t r;
+    tSem * sem;
+
+    tIntEnter();
+    TIM10->SR = ~TIM_SR_UIF;
+    r = stressRand();
+    TIM10->ARR = STRESS_WAKEUP_US / 2 + (r >> 8) % (STRESS_WAKEUP_US + 1);
+    sem = &stressWorkerSem[r % STRESS_WORKERS];
+    if (sem->count != 0) {
+        stressStat.wakeupOverflow++;
+    }
+    stressStat.wakeups++;
+    tSemNotifyFromISR(sem);
+    tIntExit();
+}
+
+/**
+ * @brief 周期任务的释放：记下周期计数，上一次的释放尚未被取走时计为错过
+ *
+ * @return void
+ */
+void TIM1_TRG_COM_TIM11_IRQHandler(void) {
+    tIntEnter();
+    TIM11->SR = ~TIM_SR_UIF;
+    if (stressPeriodSem.count != 0) {
+        stressStat.periodMissed++;
+    }
+    stressStat.releases++;
+    stressReleaseStamp = tCycleCounterGet();
+    tSemNotifyFromISR(&stressPeriodSem);
+    tIntExit();
+}
+
+// 最高优先级的周期任务：释放中断至本任务运行的延迟
+static void stressPeriodicEntry(void * param) {
+    uint32_t lat;
+
+    for (;;) {
+        tSemWait(&stressPeriodSem, 0);
+        lat = tCycleCounterGet() - stressReleaseStamp;
+        lat = (lat > stressOverhead) ? (lat - stressOverhead) : 0;
+        stressStat.runs++;
+        stressStat.latTotal += lat;
+        if (lat < stressStat.latMin) {
+            stressStat.latMin = lat;
+        }
+        if (lat > stressStat.latMax) {
+            stressStat.latMax = lat;
+        }
+    }
+}
+
+static void stressSemEntry(void * param) {
+    for (;;) {
+        tSemWait(&stressStormSem, 0);
+    }
+}
+
+static void stressMboxEntry(void * param) {
+    void * msg;
+
+    for (;;) {
+        tMboxWait(&stressStormMbox, &msg, 0);
+    }
+}
+
+static void stressFlagEntry(void * param) {
+    uint32_t result;
+
+    for (;;) {
+        tFlagGroupWait(&stressStormFlag, TFLAGGROUP_SET_ANY | TFLAGGROUP_CONSUME, 0x1, &result, 0);
+    }
+}
+
+// 工作任务：被随机唤醒后忙等一段时间，模拟突发的低优先级负载
+static void stressWorkerEntry(void * param) {
+    tSem * sem = (tSem *)param;
+    uint32_t start;
+
+    for (;;) {
+        tSemWait(sem, 0);
+        start = tCycleCounterGet();
+        while ((tCycleCounterGet() - start) < STRESS_WORK_CYCLES) {
+        }
+        stressStat.workerRuns++;
+    }
+}
+
+/**
+ * @brief 以rate的风暴频率运行一级，结束后停止全部定时器并输出一行
+ *
+ * @param rate 风暴中断频率(Hz)
+ *
+ * @return void
+ */
+static void stressRunPhase(uint32_t rate) {
+    const uint32_t cyclesPerTick = SystemCoreClock / 1000 * TINYOS_SYSTICK_MS;
+    tStressStat stat;
+    uint64_t startTicks, ticks;
+    uint32_t startCycles, cycles, status;
+    int32_t drift;
+
+    stressTimerStart(TIM11, STRESS_PERIOD_HZ);
+    stressWakeupStart();
+    stressTimerStart(TIM9, rate);
+    tTaskDelay(tTimeMsToTicks(STRESS_SETTLE_MS));
+
+    status = tTaskEnterCritical();
+    memset(&stressStat, 0, sizeof(stressStat));
+    stressStat.latMin = 0xFFFFFFFF;
+    startTicks = tTimeGetTicks64();
+    startCycles = tCycleCounterGet();
+    tTaskExitCritical(status);
+
+    tTaskDelay(tTimeMsToTicks(STRESS_PHASE_MS));
+
+    status = tTaskEnterCritical();
+    ticks = tTimeGetTicks64() - startTicks;
+    cycles = tCycleCounterGet() - startCycles;
+    stat = stressStat;
+    tTaskExitCritical(status);
+
+    stressTimerStart(TIM9, 0);
+    stressTimerStart(TIM10, 0);
+    stressTimerStart(TIM11, 0);
+
+    drift = (int32_t)ticks - (int32_t)((cycles + cyclesPerTick / 2) / cyclesPerTick);
+    printf("STRESS,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%ld,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+           (unsigned long)rate, (unsigned long)stat.stormIrqs, (unsigned long)stat.releases,
+           (unsigned long)(stat.runs ? stat.latMin : 0),
+           (unsigned long)(stat.runs ? (uint32_t)(stat.latTotal / stat.runs) : 0),
+           (unsigned long)stat.latMax, (unsigned long)stat.periodMissed, (long)drift,
+           (unsigned long)stat.semOverflow, (unsigned long)stat.mboxOverflow, (unsigned long)stat.flagCoalesced,
+           (unsigned long)stat.wakeups, (unsigned long)stat.wakeupOverflow, (unsigned long)stat.workerRuns);
+}
+
+static void stressCtrlEntry(void * param) {
+    uint32_t i, start;
+
+    // 等空闲任务完成外设及串口初始化
+    tTaskDelay(2);
+    tCycleCounterInit();
+
+    stressOverhead = 0xFFFFFFFF;
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        start = tCycleCounterGet() - start;
+        if (start < stressOverhead) {
+            stressOverhead = start;
+        }
+    }
+
+    printf("#CLOCK,%lu\r\n", (unsigned long)SystemCoreClock);
+    printf("#STRESS,storm_hz,storm_irqs,releases,min_cycles,avg_cycles,max_cycles,missed,tick_drift,"
+           "sem_overflow,mbox_overflow,flag_coalesced,wakeups,wakeup_coalesced,worker_runs\r\n");
+    for (i = 0; i < sizeof(stressRates) / sizeof(stressRates[0]); i++) {
+        stressRunPhase(stressRates[i]);
+    }
+    printf("#END\r\n");
+
+    for (;;) {
+        tTaskDelay(0xFFFFFF);
+    }
+}
+
+void tInitApp(void) {
+    uint32_t i;
+
+    tSemInit(&stressPeriodSem, 0, 1);
+    tSemInit(&stressStormSem, 0, STRESS_QUEUE_DEPTH);
+    tMboxInit(&stressStormMbox, stressStormMboxBuffer, STRESS_QUEUE_DEPTH);
+    tFlagGroupInit(&stressStormFlag, 0);
+
+    __HAL_RCC_TIM9_CLK_ENABLE();
+    __HAL_RCC_TIM10_CLK_ENABLE();
+    __HAL_RCC_TIM11_CLK_ENABLE();
+    // 中断中释放内核对象，优先级不能高于TINYOS_MAX_SYSCALL_PRIO
+    NVIC_SetPriority(TIM1_BRK_TIM9_IRQn, TINYOS_MAX_SYSCALL_PRIO);
+    NVIC_SetPriority(TIM1_UP_TIM10_IRQn, TINYOS_MAX_SYSCALL_PRIO);
+    NVIC_SetPriority(TIM1_TRG_COM_TIM11_IRQn, TINYOS_MAX_SYSCALL_PRIO);
+    NVIC_EnableIRQ(TIM1_BRK_TIM9_IRQn);
+    NVIC_EnableIRQ(TIM1_UP_TIM10_IRQn);
+    NVIC_EnableIRQ(TIM1_TRG_COM_TIM11_IRQn);
+
+    tTaskInit(&stressCtrlTask, stressCtrlEntry, (void *)0, STRESS_PRIO_CTRL, stressCtrlStack, sizeof(stressCtrlStack));
+    tTaskInit(&stressPeriodicTask, stressPeriodicEntry, (void *)0, STRESS_PRIO_PERIODIC, stressPeriodicStack, sizeof(stressPeriodicStack));
+    tTaskInit(&stressSemTask, stressSemEntry, (void *)0, STRESS_PRIO_CONSUMER, stressSemStack, sizeof(stressSemStack));
+    tTaskInit(&stressMboxTask, stressMboxEntry, (void *)0, STRESS_PRIO_CONSUMER, stressMboxStack, sizeof(stressMboxStack));
+    tTaskInit(&stressFlagTask, stressFlagEntry, (void *)0, STRESS_PRIO_CONSUMER, stressFlagStack, sizeof(stressFlagStack));
+    for (i = 0; i < STRESS_WORKERS; i++) {
+        tSemInit(&stressWorkerSem[i], 0, 1);
+        tTaskInit(&stressWorkerTask[i], stressWorkerEntry, &stressWorkerSem[i], STRESS_PRIO_WORKER,
+                  stressWorkerStack[i], sizeof(stressWorkerStack[i]));
+    }
+}
+
+#endif
@@ -0,0 +1,350 @@
+#include "tinyOS.h"
+#include "tPort.h"
+#include "MySerial.h"
+#include "MadgwickBench.h"
+#include "EstimatorBench.h"
+
+#if TINYOS_ENABLE_BENCHMARK == 1
+
+// Rhealstone风格的内核基准测试，开启TINYOS_ENABLE_BENCHMARK后代替app.c中的演示任务
+// 每项测试由控制任务与辅助任务配合完成，在动作发生前记下DWT周期数，在对方任务或中断中读取差值
+// 结果以逗号分隔的表格从串口输出，以"#"开头的行为表头及说明，便于脚本解析：
+//   BENCH,<测试项>,<样本数>,<最小周期>,<平均周期>,<最大周期>
+// 各样本已减去一次读取周期计数器本身的开销(dwt_overhead行)
+// 开启TINYOS_ENABLE_FAST_SECTIONS时另输出"#RAMFUNC,<字节数>"，即复制到SRAM执行的内核代码大小，
+// 与关闭时的结果对比即可得到热点代码从SRAM执行带来的收益及其RAM代价
+// 内核各项之后依次输出Madgwick的比对与计时(MadgwickBench.c)，以及各估计器、PID及混控的周期数与栈深度(EstimatorBench.c)
+
+#define BENCH_PRIO_HIGH         3           //被唤醒/抢占的一方
+#define BENCH_PRIO_CTRL         5           //控制任务及同优先级切换的辅助任务
+#define BENCH_STACK_SIZE        256         //每个辅助任务的栈(字)
+#define BENCH_IRQn              EXTI0_IRQn  //未使用的外部中断线，由软件挂起触发
+#define BENCH_MBOX_SIZE         4
+#define BENCH_MEMBLOCK_SIZE     32
+#define BENCH_MEMBLOCK_COUNT    4
+#define BENCH_TICK_TASKS_MAX    8           //节拍开销测试中最多的延时任务数
+#define BENCH_TICK_WINDOW       50          //每种任务数下统计的节拍数
+
+typedef enum _tBenchItem {
+    tBenchOverhead = 0,
+    tBenchTaskSwitch,
+    tBenchPreempt,
+    tBenchSemShuffle,
+    tBenchMboxRoundTrip,
+    tBenchMutexUncontended,
+    tBenchMutexContended,
+    tBenchMemBlock,
+    tBenchIrqToTask,
+    tBenchItemCount
+}tBenchItem;
+
+typedef struct _tBenchStat {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+}tBenchStat;
+
+static const char * const benchName[tBenchItemCount] = {
+    "dwt_overhead",
+    "task_switch",
+    "preemption",
+    "sem_shuffle",
+    "mbox_roundtrip",
+    "mutex_uncontended",
+    "mutex_contended",
+    "memblock_alloc_free",
+    "irq_to_task",
+};
+
+static tBenchStat benchStat[tBenchItemCount];
+static uint32_t benchOverhead;
+static volatile uint32_t benchStart;
+
+static tTask benchCtrlTask;
+static tTask benchSwitchTask;
+static tTask benchPreemptTask;
+static tTask benchSemTask;
+static tTask benchMboxTask;
+static tTask benchMutexTask;
+static tTask benchIrqTask;
+static tTaskStack benchCtrlStack[1024];
+static tTaskStack benchSwitchStack[BENCH_STACK_SIZE];
+static tTaskStack benchPreemptStack[BENCH_STACK_SIZE];
+static tTaskStack benchSemStack[BENCH_STACK_SIZE];
+static tTaskStack benchMboxStack[BENCH_STACK_SIZE];
+static tTaskStack benchMutexStack[BENCH_STACK_SIZE];
+static tTaskStack benchIrqStack[BENCH_STACK_SIZE];
+
+static tSem benchSemPing;
+static tSem benchSemPong;
+static tSem benchIrqSem;
+static tMbox benchMboxPing;
+static tMbox benchMboxPong;
+static void * benchMboxPingBuffer[BENCH_MBOX_SIZE];
+static void * benchMboxPongBuffer[BENCH_MBOX_SIZE];
+static tMutex benchMutex;
+static tMemBlock benchMemBlock;
+static uint8_t benchMem[BENCH_MEMBLOCK_COUNT][BENCH_MEMBLOCK_SIZE];
+
+#if (TINYOS_ENABLE_FAST_SECTIONS == 1) && defined(__CC_ARM)
+extern unsigned int Image$$RW_RAMFUNC$$Length;     //分散加载文件中RW_RAMFUNC执行域的长度，由链接器生成
+#endif
+
+#if TINYOS_ENABLE_PROFILING == 1
+static tTask benchTickTask[BENCH_TICK_TASKS_MAX];
+static tTaskStack benchTickStack[BENCH_TICK_TASKS_MAX][BENCH_STACK_SIZE];
+#endif
+
+/**
+ * @brief 记录一个样本，扣除读取周期计数器的开销
+ *
+ * @param item 测试项
+ * @param cycles 测得的周期数
+ *
+ * @return void
+ */
+static void benchRecord(tBenchItem item, uint32_t cycles) {
+    tBenchStat * stat = &benchStat[item];
+
+    cycles = (cycles > benchOverhead) ? (cycles - benchOverhead) : 0;
+    stat->count++;
+    stat->totalCycles += cycles;
+    if (cycles < stat->minCycles) {
+        stat->minCycles = cycles;
+    }
+    if (cycles > stat->maxCycles) {
+        stat->maxCycles = cycles;
+    }
+}
+
+static void benchPrintRow(const char * name, uint32_t count, uint32_t minCycles, uint32_t avgCycles, uint32_t maxCycles) {
+    printf("BENCH,%s,%lu,%lu,%lu,%lu\r\n", name, (unsigned long)count,
+           (unsigned long)minCycles, (unsigned long)avgCycles, (unsigned long)maxCycles);
+}
+
+// 同优先级的主动切换：控制任务唤醒本任务后挂起自己
+static void benchSwitchEntry(void * param) {
+    for (;;) {
+        benchRecord(tBenchTaskSwitch, tCycleCounterGet() - benchStart);
+        tTaskWakeUp(&benchCtrlTask);
+        tTaskSuspend(curTask);
+    }
+}
+
+// 抢占：控制任务唤醒更高优先级的本任务，立即发生切换
+static void benchPreemptEntry(void * param) {
+    for (;;) {
+        benchRecord(tBenchPreempt, tCycleCounterGet() - benchStart);
+        tTaskSuspend(curTask);
+    }
+}
+
+static void benchSemEntry(void * param) {
+    for (;;) {
+        tSemWait(&benchSemPing, 0);
+        tSemNotify(&benchSemPong);
+    }
+}
+
+static void benchMboxEntry(void * param) {
+    void * msg;
+
+    for (;;) {
+        tMboxWait(&benchMboxPing, &msg, 0);
+        tMboxNotify(&benchMboxPong, msg, tMboxSendNormal);
+    }
+}
+
+// 有竞争的互斥量：本任务阻塞在控制任务持有的互斥量上，测量释放至本任务获得互斥量的时间
+static void benchMutexEntry(void * param) {
+    for (;;) {
+        tMutexWait(&benchMutex, 0);
+        benchRecord(tBenchMutexContended, tCycleCounterGet() - benchStart);
+        tMutexNotify(&benchMutex);
+        tTaskSuspend(curTask);
+    }
+}
+
+static void benchIrqEntry(void * param) {
+    for (;;) {
+        tSemWait(&benchIrqSem, 0);
+        benchRecord(tBenchIrqToTask, tCycleCounterGet() - benchStart);
+    }
+}
+
+/**
+ * @brief 基准测试用的软件触发中断，释放信号量唤醒等待的任务
+ *
+ * @return void
+ */
+void EXTI0_IRQHandler(void) {
+    tIntEnter();
+    tSemNotifyFromISR(&benchIrqSem);
+    tIntExit();
+}
+
+#if TINYOS_ENABLE_PROFILING == 1
+static void benchTickEntry(void * param) {
+    for (;;) {
+        tTaskDelay(0xFFFFFF);
+    }
+}
+
+/**
+ * @brief 逐步增加处于延时状态的任务数，由性能统计模块给出SysTick中断处理的周期数
+ *
+ * @return void
+ */
+static void benchTickOverhead(void) {
+    char name[16];
+    uint32_t taskCount = 0;
+    uint32_t target;
+    tProfileInfo info;
+
+    for (target = 0; target <= BENCH_TICK_TASKS_MAX; target = (target == 0) ? 1 : target * 2) {
+        while (taskCount < target) {
+            tTaskInit(&benchTickTask[taskCount], benchTickEntry, (void *)0, BENCH_PRIO_HIGH,
+                      benchTickStack[taskCount], sizeof(benchTickStack[taskCount]));
+            taskCount++;
+        }
+        // 等新任务先运行进入延时，再开始统计
+        tTaskDelay(1);
+        tProfileReset(tProfilePathSysTick);
+        tTaskDelay(BENCH_TICK_WINDOW);
+        tProfileGetInfo(tProfilePathSysTick, &info);
+        sprintf(name, "tick_tasks_%lu", (unsigned long)target);
+        benchPrintRow(name, info.count, info.minCycles, info.avgCycles, info.maxCycles);
+    }
+}
+#endif
+
+static void benchRun(void) {
+    uint32_t i;
+    uint32_t start;
+    uint8_t * mem;
+    void * msg;
+
+    // 周期计数器连续读取两次的开销，作为其余各项的基准
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        benchRecord(tBenchOverhead, tCycleCounterGet() - start);
+    }
+    benchOverhead = benchStat[tBenchOverhead].minCycles;
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        benchStart = tCycleCounterGet();
+        tTaskWakeUp(&benchSwitchTask);
+        tTaskSuspend(curTask);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        benchStart = tCycleCounterGet();
+        tTaskWakeUp(&benchPreemptTask);
+    }
+
+    // 往返两次切换加一对信号量操作
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        tSemNotify(&benchSemPing);
+        tSemWait(&benchSemPong, 0);
+        benchRecord(tBenchSemShuffle, tCycleCounterGet() - start);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        tMboxNotify(&benchMboxPing, (void *)i, tMboxSendNormal);
+        tMboxWait(&benchMboxPong, &msg, 0);
+        benchRecord(tBenchMboxRoundTrip, tCycleCounterGet() - start);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        tMutexWait(&benchMutex, 0);
+        tMutexNotify(&benchMutex);
+        benchRecord(tBenchMutexUncontended, tCycleCounterGet() - start);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        tMutexWait(&benchMutex, 0);
+        // 辅助任务优先级更高，唤醒后立即运行并阻塞在互斥量上
+        tTaskWakeUp(&benchMutexTask);
+        benchStart = tCycleCounterGet();
+        tMutexNotify(&benchMutex);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        start = tCycleCounterGet();
+        tMemBlockNoWaitGet(&benchMemBlock, &mem, 0);
+        tMemBlockNotify(&benchMemBlock, mem);
+        benchRecord(tBenchMemBlock, tCycleCounterGet() - start);
+    }
+
+    for (i = 0; i < TINYOS_BENCH_SAMPLES; i++) {
+        benchStart = tCycleCounterGet();
+        NVIC_SetPendingIRQ(BENCH_IRQn);
+    }
+}
+
+static void benchCtrlEntry(void * param) {
+    uint32_t i;
+
+    // 等空闲任务完成外设及串口初始化
+    tTaskDelay(2);
+    tCycleCounterInit();
+
+    for (i = 0; i < tBenchItemCount; i++) {
+        benchStat[i].minCycles = 0xFFFFFFFF;
+    }
+
+    benchRun();
+
+    printf("#CLOCK,%lu\r\n", (unsigned long)SystemCoreClock);
+#if (TINYOS_ENABLE_FAST_SECTIONS == 1) && defined(__CC_ARM)
+    printf("#RAMFUNC,%lu\r\n", (unsigned long)&Image$$RW_RAMFUNC$$Length);
+#endif
+    printf("#BENCH,test,samples,min_cycles,avg_cycles,max_cycles\r\n");
+    for (i = 0; i < tBenchItemCount; i++) {
+        tBenchStat * stat = &benchStat[i];
+        benchPrintRow(benchName[i], stat->count, stat->minCycles,
+                      stat->count ? (uint32_t)(stat->totalCycles / stat->count) : 0, stat->maxCycles);
+    }
+#if TINYOS_ENABLE_PROFILING == 1
+    benchTickOverhead();
+#endif
+    MadgwickBench_Run(benchOverhead);
+    EstimatorBench_Run(benchOverhead);
+    printf("#END\r\n");
+
+    for (;;) {
+        tTaskSuspend(curTask);
+    }
+}
+
+void tInitApp(void) {
+    tSemInit(&benchSemPing, 0, 0);
+    tSemInit(&benchSemPong, 0, 0);
+    tSemInit(&benchIrqSem, 0, 0);
+    tMboxInit(&benchMboxPing, benchMboxPingBuffer, BENCH_MBOX_SIZE);
+    tMboxInit(&benchMboxPong, benchMboxPongBuffer, BENCH_MBOX_SIZE);
+    tMutexInit(&benchMutex);
+    tMemBlockInit(&benchMemBlock, (uint8_t *)benchMem, BENCH_MEMBLOCK_SIZE, BENCH_MEMBLOCK_COUNT);
+
+    NVIC_SetPriority(BENCH_IRQn, TINYOS_MAX_SYSCALL_PRIO);
+    NVIC_EnableIRQ(BENCH_IRQn);
+
+    tTaskInit(&benchCtrlTask, benchCtrlEntry, (void *)0, BENCH_PRIO_CTRL, benchCtrlStack, sizeof(benchCtrlStack));
+    tTaskInit(&benchSwitchTask, benchSwitchEntry, (void *)0, BENCH_PRIO_CTRL, benchSwitchStack, sizeof(benchSwitchStack));
+    tTaskInit(&benchPreemptTask, benchPreemptEntry, (void *)0, BENCH_PRIO_HIGH, benchPreemptStack, sizeof(benchPreemptStack));
+    tTaskInit(&benchSemTask, benchSemEntry, (void *)0, BENCH_PRIO_HIGH, benchSemStack, sizeof(benchSemStack));
+    tTaskInit(&benchMboxTask, benchMboxEntry, (void *)0, BENCH_PRIO_HIGH, benchMboxStack, sizeof(benchMboxStack));
+    tTaskInit(&benchMutexTask, benchMutexEntry, (void *)0, BENCH_PRIO_HIGH, benchMutexStack, sizeof(benchMutexStack));
+    tTaskInit(&benchIrqTask, benchIrqEntry, (void *)0, BENCH_PRIO_HIGH, benchIrqStack, sizeof(benchIrqStack));
+
+    // 由控制任务唤醒的辅助任务在调度开始前先挂起，入口处即为被唤醒后的第一个测量点
+    tTaskSuspend(&benchSwitchTask);
+    tTaskSuspend(&benchPreemptTask);
+    tTaskSuspend(&benchMutexTask);
+}
+
+#endif
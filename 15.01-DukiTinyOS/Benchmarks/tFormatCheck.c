@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+#include "tFormat.h"
+
+// tFormat的主机检查：逐项与libc的snprintf比对输出及返回的字符数，打印第一处差异并返回1，全部一致时打印"TFORMAT,PASS"
+// 超出数字区的精度应截为TFORMAT_NUM_MAX位，与按TFORMAT_NUM_MAX位精度的snprintf比对，加-fsanitize=address可同时检查越界写。
+// 编译运行(在工程根目录下)：
+//   gcc -O1 -g -fsanitize=address -ISource -o tformatcheck Benchmarks/tFormatCheck.c Source/tFormat.c
+//   ./tformatcheck
+
+#define CHECK_BUF_SIZE      128
+
+typedef struct _tCheckBuf {
+    char data[CHECK_BUF_SIZE];
+    uint32_t len;
+}tCheckBuf;
+
+static void checkPut(void * ctx, const char * s, uint32_t len) {
+    tCheckBuf * buf = (tCheckBuf *)ctx;
+
+    while ((len > 0) && (buf->len < CHECK_BUF_SIZE - 1)) {
+        buf->data[buf->len++] = *s++;
+        len--;
+    }
+    buf->data[buf->len] = '\0';
+}
+
+// 按fmt输出一个整数参数，与expectFmt下snprintf的结果比对
+static int checkInt(const char * fmt, const char * expectFmt, int value) {
+    tCheckBuf buf;
+    char expect[CHECK_BUF_SIZE];
+    uint32_t count;
+
+    buf.len = 0;
+    buf.data[0] = '\0';
+    count = tFormat(checkPut, &buf, fmt, value);
+    snprintf(expect, sizeof(expect), expectFmt, value);
+    if ((strcmp(buf.data, expect) != 0) || (count != strlen(expect))) {
+        printf("TFORMAT,FAIL,\"%s\",%d,got \"%s\"(%u),expect \"%s\"\n", fmt, value, buf.data, count, expect);
+        return 1;
+    }
+    return 0;
+}
+
+static int checkStr(const char * fmt, const char * value) {
+    tCheckBuf buf;
+    char expect[CHECK_BUF_SIZE];
+    uint32_t count;
+
+    buf.len = 0;
+    buf.data[0] = '\0';
+    count = tFormat(checkPut, &buf, fmt, value);
+    snprintf(expect, sizeof(expect), fmt, value);
+    if ((strcmp(buf.data, expect) != 0) || (count != strlen(expect))) {
+        printf("TFORMAT,FAIL,\"%s\",\"%s\",got \"%s\"(%u),expect \"%s\"\n", fmt, value, buf.data, count, expect);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    static const char * const intFmts[] = {
+        "%d", "%i", "%5d", "%-5d|", "%05d", "%+d", "%.3d", "%.0d", "%8.4d", "%-+8.3d|",
+        "%u", "%x", "%X", "%08x", "%.6X", "%lu", "[%d]%%",
+    };
+    static const int intValues[] = {0, 1, -1, 42, -42, 12345, 2147483647, (int)0x80000000, 0x7fff, (int)0xdeadbeef};
+    static const char * const strFmts[] = {"%s", "%8s|", "%-8s|", "%.2s", "<%.0s>"};
+    uint32_t i, j;
+    int fail = 0;
+
+    for (i = 0; i < sizeof(intFmts) / sizeof(intFmts[0]); i++) {
+        for (j = 0; j < sizeof(intValues) / sizeof(intValues[0]); j++) {
+            fail |= checkInt(intFmts[i], intFmts[i], intValues[j]);
+        }
+    }
+    for (i = 0; i < sizeof(strFmts) / sizeof(strFmts[0]); i++) {
+        fail |= checkStr(strFmts[i], "tinyOS");
+        fail |= checkStr(strFmts[i], "");
+    }
+
+    // 精度大于数字区：按TFORMAT_NUM_MAX位输出，不越界
+    for (j = 0; j < sizeof(intValues) / sizeof(intValues[0]); j++) {
+        fail |= checkInt("%.20d", "%.20d", intValues[j]);
+        fail |= checkInt("%.30d", "%.20d", intValues[j]);
+        fail |= checkInt("%.30u", "%.20u", intValues[j]);
+        fail |= checkInt("%40.999x|", "%40.20x|", intValues[j]);
+        fail |= checkInt("%-+24.64d|", "%-+24.20d|", intValues[j]);
+    }
+
+    if (fail) {
+        return 1;
+    }
+    printf("TFORMAT,PASS\n");
+    return 0;
+}
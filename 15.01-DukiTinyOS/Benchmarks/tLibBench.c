@@ -0,0 +1,346 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tLib.h"
+
+// tList及tBitMap的主机微基准：随机操作序列与参考模型逐步比对，确认结果一致后再统计每次操作的耗时
+// 用于验证和比较链表内联、CLZ位图等优化，切换tConfig.h中的TINYOS_ENABLE_LIST_INLINE、
+// TINYOS_BITMAP_USE_CLZ及TINYOS_PRIO_COUNT后重新编译即可对比。编译运行(在工程根目录下)：
+//   gcc -O2 -DTINYOS_PORT_POSIX -ISource -IPort/Posix -o tlibbench Benchmarks/tLibBench.c Source/tList.c Source/tBitMap.c
+//   ./tlibbench [随机种子] [轮数]
+// 输出格式：HOST,<测试项>,<操作数>,<每次操作的纳秒数>；比对失败时打印第一处差异并返回1
+
+#define BENCH_NODE_COUNT    64          //参与测试的结点数
+#define BENCH_CHECK_OPS     200000      //与参考模型比对的随机操作数
+#define BENCH_ROUNDS        2000        //计时测试的默认轮数
+
+typedef enum _tBenchListOp {
+    tBenchListAddFirst = 0,
+    tBenchListAddLast,
+    tBenchListRemove,
+    tBenchListRemoveFirst,
+    tBenchListInsertAfter,
+    tBenchListOpCount
+}tBenchListOp;
+
+static tList benchList;
+static tNode benchNode[BENCH_NODE_COUNT];
+
+// 参考模型：按链表顺序保存结点序号
+static uint32_t modelOrder[BENCH_NODE_COUNT];
+static uint32_t modelCount;
+static uint8_t modelInList[BENCH_NODE_COUNT];
+
+static uint8_t modelBits[TBITMAP_GROUP_COUNT * 32];
+
+static uint32_t benchSeed = 0x12345678;
+static volatile uint32_t benchSink;
+
+// xorshift32，保证同一种子在不同主机上得到相同序列
+static uint32_t benchRand(void) {
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return benchSeed;
+}
+
+static uint64_t benchNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void benchPrint(const char * name, uint64_t ops, uint64_t ns) {
+    printf("HOST,%s,%llu,%.2f\n", name, (unsigned long long)ops, ops ? (double)ns / ops : 0.0);
+}
+
+static void modelInsertAt(uint32_t index, uint32_t id) {
+    uint32_t i;
+    for (i = modelCount; i > index; i--) {
+        modelOrder[i] = modelOrder[i - 1];
+    }
+    modelOrder[index] = id;
+    modelCount++;
+    modelInList[id] = 1;
+}
+
+static void modelRemoveAt(uint32_t index) {
+    uint32_t i;
+    modelInList[modelOrder[index]] = 0;
+    for (i = index; i + 1 < modelCount; i++) {
+        modelOrder[i] = modelOrder[i + 1];
+    }
+    modelCount--;
+}
+
+/**
+ * @brief 正反两个方向遍历链表，与参考模型的顺序及计数比对
+ *
+ * @param op 刚执行的操作序号，用于出错时定位
+ *
+ * @return 一致返回0，否则返回1
+ */
+static int benchListCheck(uint32_t op) {
+    uint32_t i;
+    tNode * node = &benchList.headNode;
+
+    if (tListCount(&benchList) != modelCount) {
+        printf("list: op %u count %u, expected %u\n", op, tListCount(&benchList), modelCount);
+        return 1;
+    }
+    for (i = 0; i < modelCount; i++) {
+        node = node->nextNode;
+        if (node != &benchNode[modelOrder[i]]) {
+            printf("list: op %u forward position %u mismatch\n", op, i);
+            return 1;
+        }
+    }
+    if (node->nextNode != &benchList.headNode) {
+        printf("list: op %u tail does not return to head\n", op);
+        return 1;
+    }
+    node = &benchList.headNode;
+    for (i = modelCount; i > 0; i--) {
+        node = node->preNode;
+        if (node != &benchNode[modelOrder[i - 1]]) {
+            printf("list: op %u backward position %u mismatch\n", op, i - 1);
+            return 1;
+        }
+    }
+    if ((modelCount == 0) && ((tListFirst(&benchList) != (tNode *)0) || (tListLast(&benchList) != (tNode *)0))) {
+        printf("list: op %u empty list returns a node\n", op);
+        return 1;
+    }
+    return 0;
+}
+
+static uint32_t benchPickFree(void) {
+    uint32_t id = benchRand() % BENCH_NODE_COUNT;
+    while (modelInList[id]) {
+        id = (id + 1) % BENCH_NODE_COUNT;
+    }
+    return id;
+}
+
+static int benchListVerify(void) {
+    uint32_t op;
+
+    tListInit(&benchList);
+    modelCount = 0;
+    for (op = 0; op < BENCH_NODE_COUNT; op++) {
+        tNodeInit(&benchNode[op]);
+        modelInList[op] = 0;
+    }
+
+    for (op = 0; op < BENCH_CHECK_OPS; op++) {
+        tBenchListOp kind = (tBenchListOp)(benchRand() % tBenchListOpCount);
+        uint32_t id;
+        uint32_t index;
+
+        // 满时只做删除，空时只做插入
+        if ((modelCount == BENCH_NODE_COUNT) && (kind != tBenchListRemove)) {
+            kind = tBenchListRemoveFirst;
+        } else if ((modelCount == 0) && ((kind == tBenchListRemove) || (kind == tBenchListRemoveFirst) || (kind == tBenchListInsertAfter))) {
+            kind = tBenchListAddLast;
+        }
+
+        switch (kind) {
+            case tBenchListAddFirst:
+                id = benchPickFree();
+                tListAddFirst(&benchList, &benchNode[id]);
+                modelInsertAt(0, id);
+                break;
+            case tBenchListAddLast:
+                id = benchPickFree();
+                tListAddLast(&benchList, &benchNode[id]);
+                modelInsertAt(modelCount, id);
+                break;
+            case tBenchListRemove:
+                index = benchRand() % modelCount;
+                tListRemove(&benchList, &benchNode[modelOrder[index]]);
+                modelRemoveAt(index);
+                break;
+            case tBenchListRemoveFirst:
+                if (tListRemoveFirst(&benchList) != &benchNode[modelOrder[0]]) {
+                    printf("list: op %u RemoveFirst returned the wrong node\n", op);
+                    return 1;
+                }
+                modelRemoveAt(0);
+                break;
+            case tBenchListInsertAfter:
+                index = benchRand() % modelCount;
+                id = benchPickFree();
+                tListInsertAfter(&benchList, &benchNode[modelOrder[index]], &benchNode[id]);
+                modelInsertAt(index + 1, id);
+                break;
+            default:
+                break;
+        }
+
+        if (benchListCheck(op)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int benchBitMapVerify(void) {
+    tBitMap bitMap;
+    uint32_t posCount = tBitMapPosCount();
+    uint32_t op;
+    uint32_t i;
+
+    tBitMapInit(&bitMap);
+    for (i = 0; i < posCount; i++) {
+        modelBits[i] = 0;
+    }
+
+    for (op = 0; op < BENCH_CHECK_OPS; op++) {
+        uint32_t pos = benchRand() % TINYOS_PRIO_COUNT;
+        uint32_t upTo = benchRand() % TINYOS_PRIO_COUNT;
+        uint32_t first = posCount;
+        uint32_t last = posCount;
+
+        // 置位与清除概率相同，位图在稀疏与稠密之间变化
+        if (benchRand() & 1) {
+            tBitMapSet(&bitMap, pos);
+            modelBits[pos] = 1;
+        } else {
+            tBitMapClear(&bitMap, pos);
+            modelBits[pos] = 0;
+        }
+
+        for (i = 0; i < posCount; i++) {
+            if (modelBits[i]) {
+                if (first == posCount) {
+                    first = i;
+                }
+                if (i <= upTo) {
+                    last = i;
+                }
+            }
+        }
+        if (tBitMapGetFirstSet(&bitMap) != first) {
+            printf("bitmap: op %u GetFirstSet %u, expected %u\n", op, tBitMapGetFirstSet(&bitMap), first);
+            return 1;
+        }
+        if (tBitMapGetLastSetUpTo(&bitMap, upTo) != last) {
+            printf("bitmap: op %u GetLastSetUpTo(%u) %u, expected %u\n", op, upTo, tBitMapGetLastSetUpTo(&bitMap, upTo), last);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void benchListTime(uint32_t rounds) {
+    static uint32_t perm[BENCH_NODE_COUNT];
+    uint64_t addFirstNs = 0, addLastNs = 0, removeNs = 0, removeFirstNs = 0, insertNs = 0;
+    uint64_t start;
+    uint32_t r;
+    uint32_t i;
+
+    for (r = 0; r < rounds; r++) {
+        // 每轮生成一个随机排列，删除及插入位置随排列变化
+        for (i = 0; i < BENCH_NODE_COUNT; i++) {
+            perm[i] = i;
+        }
+        for (i = BENCH_NODE_COUNT - 1; i > 0; i--) {
+            uint32_t j = benchRand() % (i + 1);
+            uint32_t t = perm[i];
+            perm[i] = perm[j];
+            perm[j] = t;
+        }
+
+        tListInit(&benchList);
+        start = benchNowNs();
+        for (i = 0; i < BENCH_NODE_COUNT; i++) {
+            tListAddFirst(&benchList, &benchNode[perm[i]]);
+        }
+        addFirstNs += benchNowNs() - start;
+
+        start = benchNowNs();
+        for (i = 0; i < BENCH_NODE_COUNT; i++) {
+            benchSink += (uint32_t)(uintptr_t)tListRemoveFirst(&benchList);
+        }
+        removeFirstNs += benchNowNs() - start;
+
+        start = benchNowNs();
+        for (i = 0; i < BENCH_NODE_COUNT; i++) {
+            tListAddLast(&benchList, &benchNode[i]);
+        }
+        addLastNs += benchNowNs() - start;
+
+        start = benchNowNs();
+        for (i = 0; i < BENCH_NODE_COUNT; i++) {
+            tListRemove(&benchList, &benchNode[perm[i]]);
+        }
+        removeNs += benchNowNs() - start;
+
+        tListAddFirst(&benchList, &benchNode[perm[0]]);
+        start = benchNowNs();
+        for (i = 1; i < BENCH_NODE_COUNT; i++) {
+            tListInsertAfter(&benchList, &benchNode[perm[benchSink % i]], &benchNode[perm[i]]);
+        }
+        insertNs += benchNowNs() - start;
+    }
+
+    benchPrint("list_add_first", (uint64_t)rounds * BENCH_NODE_COUNT, addFirstNs);
+    benchPrint("list_add_last", (uint64_t)rounds * BENCH_NODE_COUNT, addLastNs);
+    benchPrint("list_remove", (uint64_t)rounds * BENCH_NODE_COUNT, removeNs);
+    benchPrint("list_remove_first", (uint64_t)rounds * BENCH_NODE_COUNT, removeFirstNs);
+    benchPrint("list_insert_after", (uint64_t)rounds * (BENCH_NODE_COUNT - 1), insertNs);
+}
+
+static void benchBitMapTime(uint32_t rounds) {
+    static tBitMap maps[256];
+    uint64_t ns;
+    uint64_t start;
+    uint32_t r;
+    uint32_t i;
+
+    // 每个位图只置一位，位置均匀分布，覆盖所有分组
+    for (i = 0; i < 256; i++) {
+        tBitMapInit(&maps[i]);
+        tBitMapSet(&maps[i], benchRand() % TINYOS_PRIO_COUNT);
+    }
+
+    start = benchNowNs();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < 256; i++) {
+            benchSink += tBitMapGetFirstSet(&maps[i]);
+        }
+    }
+    ns = benchNowNs() - start;
+    benchPrint("bitmap_get_first_set", (uint64_t)rounds * 256, ns);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t rounds = BENCH_ROUNDS;
+
+    if (argc > 1) {
+        benchSeed = (uint32_t)strtoul(argv[1], (char **)0, 0);
+        if (benchSeed == 0) {
+            benchSeed = 1;
+        }
+    }
+    if (argc > 2) {
+        rounds = (uint32_t)strtoul(argv[2], (char **)0, 0);
+    }
+
+    printf("#SEED,%u\n", benchSeed);
+    printf("#CONFIG,prio_count=%u,list_inline=%u,bitmap_clz=%u\n",
+           TINYOS_PRIO_COUNT, TINYOS_ENABLE_LIST_INLINE, TINYOS_BITMAP_USE_CLZ);
+
+    if (benchListVerify() || benchBitMapVerify()) {
+        printf("#FAIL\n");
+        return 1;
+    }
+    printf("#CHECK,ok,%u\n", BENCH_CHECK_OPS);
+
+    printf("#HOST,test,ops,ns_per_op\n");
+    benchListTime(rounds);
+    benchBitMapTime(rounds);
+    printf("#END\n");
+    return 0;
+}
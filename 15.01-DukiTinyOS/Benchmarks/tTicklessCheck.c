@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include "tinyOS.h"
+
+// 低功耗空闲提前唤醒时节拍补偿的主机检查：tTicklessElapsedTicks与逐个数节拍边界的参考模型比对，
+// 覆盖剩余计数为0、恰在节拍边界前后及刚开始倒数(重装载值附近)的情况，打印第一处差异并返回1，全部一致时打印"TICKLESS,PASS"
+// 只用到头文件中的内联函数，不需要链接内核。编译运行(在工程根目录下)：
+//   gcc -DTINYOS_PORT_POSIX -ISource -IPort/Posix -o ticklesscheck Benchmarks/tTicklessCheck.c
+//   ./ticklesscheck
+
+// 参考模型：倒数的起点为reload，节拍边界在计数k * tickCycles(k = 1 .. sleepTicks - 1)处，
+// 计数到达0时COUNTFLAG置位，不属于提前唤醒；计数不大于边界即已经过该边界
+static uint32_t modelElapsed(uint32_t sleepTicks, uint32_t tickCycles, uint32_t val) {
+    uint32_t k, elapsed = 0;
+
+    if (val == 0) {
+        val = 1;
+    }
+    for (k = 1; k < sleepTicks; k++) {
+        if (val <= k * tickCycles) {
+            elapsed++;
+        }
+    }
+    return elapsed;
+}
+
+static int checkOne(uint32_t sleepTicks, uint32_t tickCycles, uint32_t val) {
+    uint32_t got = tTicklessElapsedTicks(sleepTicks, tickCycles, val);
+    uint32_t expect = modelElapsed(sleepTicks, tickCycles, val);
+
+    if ((got != expect) || (got >= sleepTicks)) {
+        printf("TICKLESS,FAIL,sleep=%u,cycles=%u,val=%u,got %u,expect %u\n", sleepTicks, tickCycles, val, got, expect);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    static const uint32_t cyclesList[] = {1, 2, 7, 1000, 168000};
+    static const uint32_t sleepList[] = {2, 3, 10, 99};
+    uint32_t c, s, start;
+    int fail = 0;
+
+    for (c = 0; c < sizeof(cyclesList) / sizeof(cyclesList[0]); c++) {
+        uint32_t tickCycles = cyclesList[c];
+
+        for (s = 0; s < sizeof(sleepList) / sizeof(sleepList[0]); s++) {
+            uint32_t sleepTicks = sleepList[s];
+
+            // 进入休眠时当前节拍剩余的计数取最小、中间及最大值
+            for (start = 0; start < tickCycles; start += (tickCycles > 2) ? (tickCycles / 2) : 1) {
+                uint32_t reload = start + (sleepTicks - 1) * tickCycles;
+                uint32_t k;
+
+                fail |= checkOne(sleepTicks, tickCycles, 0);
+                fail |= checkOne(sleepTicks, tickCycles, 1);
+                fail |= checkOne(sleepTicks, tickCycles, reload);
+                if (reload > 0) {
+                    fail |= checkOne(sleepTicks, tickCycles, reload - 1);
+                }
+                for (k = 1; k < sleepTicks; k++) {
+                    fail |= checkOne(sleepTicks, tickCycles, k * tickCycles - 1);
+                    fail |= checkOne(sleepTicks, tickCycles, k * tickCycles);
+                    fail |= checkOne(sleepTicks, tickCycles, k * tickCycles + 1);
+                }
+            }
+        }
+    }
+
+    if (fail) {
+        return 1;
+    }
+    printf("TICKLESS,PASS\n");
+    return 0;
+}
@@ -19,12 +19,15 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "tim.h"
+#include "dma.h"
+#include "i2c.h"
 #include "usart.h"
 #include "gpio.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "MySerial.h"
+#include "MyHwIIC.h"
 #include "MPU6050.h"
 #include "Anonymity.h"
 #include "AttitudeSolver.h"
@@ -36,6 +39,8 @@
 #include "AttitudePIDController.h"
 
 #include "tinyOS.h"
+#include "BootProfile.h"
+#include "UsbCdc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -74,60 +79,101 @@ void SystemClock_Config(void);
   * @brief  The application entry point.
   * @retval int
   */
+tTask tTaskBoot;
+tTaskStack bootTaskEnv[TINYOS_BOOTTASK_STACK_SIZE];
 tTask tTaskIdle;
 tTaskStack idleTaskEnv[TINYOS_IDLETASK_STACK_SIZE];
 
-void idleTaskEntry (void * param) {
-	
-#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
-    // 禁止调度，防止后面在创建任务时切换到其它任务中去
-    tTaskSchedDisable();
-#endif
-	
+// 启动任务：以最高优先级运行一次，创建应用及系统服务任务后删除自身；
+// 外设已在main中初始化，这里创建的任务在它删除之后按优先级开始运行
+void bootTaskEntry (void * param) {
+    BootProfile_Mark(BootStageScheduler);
+    // main中关闭了调度，调度器启动前的中断不切换任务
+    tTaskSchedEnable();
     // 初始化App相关配置
     tInitApp();
-	
 #if TINYOS_ENABLE_TIMER == 1
     // 初始化定时器任务
     tTimerInitTask();
 #endif
-	
-    // 启动系统时钟节拍
-    tSetSysTickPeriod(TINYOS_SYSTICK_MS);
-	
-#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
-    // 等待与时钟同步
-    cpuUsageSyncWithSysTick();
+#if TINYOS_ENABLE_JOB == 1
+    // 初始化作业分派任务
+    tJobInitTask();
+#endif
+#if TINYOS_ENABLE_COROUTINE == 1
+    // 初始化协程宿主任务
+    tCoroutineInitTask();
+#endif
+#if TINYOS_ENABLE_WORKQUEUE == 1
+    // 初始化系统工作队列
+    tWorkQueueInitTask();
+#endif
+#if TINYOS_ENABLE_LOG == 1
+    // 初始化日志输出任务
+    tLogInitTask();
+#endif
+#if TINYOS_ENABLE_SHELL == 1
+    // 初始化串口调试命令行
+    tShellInitTask();
+#endif
+    BootProfile_Mark(BootStageApp);
+#if TINYOS_ENABLE_TASK_DELETE == 1
+    tTaskDeleteSelf();
+#else
+    // 不能删除时永久挂起，不再参与调度
+    tTaskSuspend(curTask);
 #endif
-	
-	  //外设初始化
-		HAL_Init();
-		SystemClock_Config();
-		MX_GPIO_Init();
-		MX_USART1_UART_Init();
-		MX_TIM3_Init();
-		MX_TIM4_Init();
-		/* USER CODE BEGIN 2 */
-		MySerial_Init();
+}
+
+void idleTaskEntry (void * param) {
     for (;;)
     {
-#if TINYOS_ENABLE_CPUUSAGE_STATE == 1			
-        uint32_t status = tTaskEnterCritical();
-        idleCount++;
-        tTaskExitCritical(status);
+			tHooksRunCpuIdle();
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+			tTaskStackMonitorStep();
 #endif
-			
-#if TINYOS_ENABLE_HOOKS == 1
-			tHooksCpuIdle();
+#if TINYOS_ENABLE_IDLE_JOB == 1
+			// 仍有空闲作业未完成时不休眠
+			if (tIdleJobRun()) {
+				continue;
+			}
 #endif
+			tPortIdle();
     }
 }
 
 int main () 
 {
-		tTinyOSInit();
-    // 创建空闲任务
-    tTaskInit(&tTaskIdle, idleTaskEntry, (void *)0, TINYOS_PRIO_COUNT - 1, idleTaskEnv, TINYOS_IDLETASK_STACK_SIZE);
+    BootProfile_Start();
+    // 先切换到全速时钟，之后的初始化都在84MHz下运行
+    HAL_Init();
+    SystemClock_Config();
+    // SysTick由tCpu.c中的HAL_InitTick按内核节拍配置
+    BootProfile_Mark(BootStageClock);
+
+    tTinyOSInit();
+    // 调度器启动前中断中的释放操作只改变就绪状态，由启动任务开启调度
+    tTaskSchedDisable();
+    BootProfile_Mark(BootStageKernel);
+
+    // 外设初始化，在任务运行前完成，驱动在调度器启动前不等待信号量
+    MX_GPIO_Init();
+    MX_DMA_Init();
+    MX_I2C2_Init();
+    MX_USART1_UART_Init();
+    MX_TIM3_Init();
+    MX_TIM4_Init();
+    /* USER CODE BEGIN 2 */
+    MySerial_Init();
+    HwI2C_Init();
+    (void)UsbCdc_Init();
+    BootProfile_Mark(BootStageBoard);
+
+    // 创建启动任务及空闲任务
+    tTaskInit(&tTaskBoot, bootTaskEntry, (void *)0, 0, bootTaskEnv, sizeof(bootTaskEnv));
+    tObjectSetName(&tTaskBoot.object, "boot");
+    tTaskInit(&tTaskIdle, idleTaskEntry, (void *)0, TINYOS_PRIO_COUNT - 1, idleTaskEnv, sizeof(idleTaskEnv));
+    tObjectSetName(&tTaskIdle.object, "idle");
     tTinyOSStart();
     return 0;
 }
@@ -154,9 +200,9 @@ void SystemClock_Config(void)
   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
   RCC_OscInitStruct.PLL.PLLM = 4;
-  RCC_OscInitStruct.PLL.PLLN = 84;
-  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
-  RCC_OscInitStruct.PLL.PLLQ = 4;
+  RCC_OscInitStruct.PLL.PLLN = 168;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV4;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
   {
     Error_Handler();
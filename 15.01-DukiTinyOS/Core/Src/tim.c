@@ -182,7 +182,7 @@ void HAL_TIM_IC_MspInit(TIM_HandleTypeDef* tim_icHandle)
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
     /* TIM4 interrupt Init */
-    HAL_NVIC_SetPriority(TIM4_IRQn, 15, 0);//暂时改成了15
+    HAL_NVIC_SetPriority(TIM4_IRQn, 2, 0);//不调用内核API，高于TINYOS_MAX_SYSCALL_PRIO，不受内核临界区影响
     HAL_NVIC_EnableIRQ(TIM4_IRQn);
   /* USER CODE BEGIN TIM4_MspInit 1 */
 
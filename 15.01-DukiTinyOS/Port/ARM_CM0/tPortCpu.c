@@ -0,0 +1,229 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+// Cortex-M0/M0+移植：ARMv6-M只有Thumb-1的多寄存器存取，STM/LDM只能操作R0-R7并且只能递增，
+// R8-R11先搬到低寄存器再保存；没有BASEPRI，临界区固定使用PRIMASK；没有FPU，EXC_RETURN固定为0xFFFFFFFD
+
+#if TINYOS_PORT_CORE != 0
+#error "Port/ARM_CM0 is built but TINYOS_PORT_CORE is not 0"
+#endif
+
+#define TPORT_STR(x)    TPORT_XSTR(x)
+#define TPORT_XSTR(x)   #x
+
+//任务堆栈中软件保存的部分（自低地址到高地址）：R4-R11
+#if defined(__CC_ARM)
+__asm void PendSV_Handler(void) {
+	IMPORT curTask
+	IMPORT nextTask
+	IMPORT tTaskSwitchCount
+	IMPORT tTaskSwitchSkipCount
+
+	//nextTask已回到curTask时无需切换，直接返回
+	LDR R0,=curTask
+	LDR R0,[R0]
+	LDR R1,=nextTask
+	LDR R1,[R1]
+	CMP R0,R1
+	BNE PendSVHandler_switch
+	LDR R2,=tTaskSwitchSkipCount
+	LDR R3,[R2]
+	ADDS R3,R3,#1
+	STR R3,[R2]
+	BX LR
+
+PendSVHandler_switch
+	LDR R2,=tTaskSwitchCount
+	LDR R3,[R2]
+	ADDS R3,R3,#1
+	STR R3,[R2]
+
+	MRS R0,PSP
+	CMP R0,#0           //没有CBZ指令
+	BEQ PendSVHandler_nosave
+
+	SUBS R0,R0,#32      //先留出8个字，再递增保存
+	STMIA R0!,{R4-R7}
+	MOV R4,R8
+	MOV R5,R9
+	MOV R6,R10
+	MOV R7,R11
+	STMIA R0!,{R4-R7}
+	SUBS R0,R0,#32
+
+	LDR R1,=curTask
+	LDR R1,[R1]
+	STR R0,[R1]
+
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	IMPORT tTaskStackOverflow
+
+	//检查切出任务的栈：保存后的栈指针不能进入栈底的保护字，保护字也不能被改写
+	LDR R2,[R1,#4]      //stackBase
+	MOVS R3,#(TINYOS_STACK_CANARY_WORDS * 4)
+	ADDS R3,R2,R3
+	CMP R0,R3
+	BLO PendSVHandler_overflow
+	LDR R3,=TINYOS_TASK_STACK_FILL
+	LDR R0,[R2]
+	CMP R0,R3
+	BNE PendSVHandler_overflow
+	LDR R0,[R2,#((TINYOS_STACK_CANARY_WORDS - 1) * 4)]
+	CMP R0,R3
+	BNE PendSVHandler_overflow
+#endif
+
+PendSVHandler_nosave
+	LDR R0,=curTask
+	LDR R1,=nextTask
+	LDR R2,[R1]
+	STR R2,[R0]     //将curTask更新为nextTask
+
+	LDR R0,[R2]
+	ADDS R0,R0,#16      //先取出R8-R11
+	LDMIA R0!,{R4-R7}
+	MOV R8,R4
+	MOV R9,R5
+	MOV R10,R6
+	MOV R11,R7
+	SUBS R0,R0,#32
+	LDMIA R0!,{R4-R7}
+	ADDS R0,R0,#16
+	MSR PSP,R0
+
+	MOVS R0,#2
+	MVNS R0,R0          //EXC_RETURN = 0xFFFFFFFD，第一次切换时从MSP进入，也要返回到PSP
+	BX R0
+
+#if TINYOS_ENABLE_STACK_CHECK == 1
+PendSVHandler_overflow
+	MOV R0,R1
+	BL tTaskStackOverflow   //不返回
+#endif
+	ALIGN 4
+}
+#elif defined(__GNUC__) || defined(__clang__)
+TINYOS_FAST_CODE __attribute__((naked)) void PendSV_Handler(void) {
+	__asm volatile (
+	"	.syntax unified					\n"
+	"	ldr r0, =curTask				\n"
+	"	ldr r0, [r0]					\n"
+	"	ldr r1, =nextTask				\n"
+	"	ldr r1, [r1]					\n"
+	"	cmp r0, r1						\n"
+	"	bne .LPendSV_switch				\n"
+	"	ldr r2, =tTaskSwitchSkipCount	\n"
+	"	ldr r3, [r2]					\n"
+	"	adds r3, r3, #1					\n"
+	"	str r3, [r2]					\n"
+	"	bx lr							\n"
+	".LPendSV_switch:					\n"
+	"	ldr r2, =tTaskSwitchCount		\n"
+	"	ldr r3, [r2]					\n"
+	"	adds r3, r3, #1					\n"
+	"	str r3, [r2]					\n"
+	"	mrs r0, psp						\n"
+	"	cmp r0, #0						\n"
+	"	beq .LPendSV_nosave				\n"
+	"	subs r0, r0, #32				\n"
+	"	stmia r0!, {r4-r7}				\n"
+	"	mov r4, r8						\n"
+	"	mov r5, r9						\n"
+	"	mov r6, r10						\n"
+	"	mov r7, r11						\n"
+	"	stmia r0!, {r4-r7}				\n"
+	"	subs r0, r0, #32				\n"
+	"	ldr r1, =curTask				\n"
+	"	ldr r1, [r1]					\n"
+	"	str r0, [r1]					\n"
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	"	ldr r2, [r1, #4]				\n"
+	"	movs r3, #(" TPORT_STR(TINYOS_STACK_CANARY_WORDS) " * 4)	\n"
+	"	adds r3, r2, r3					\n"
+	"	cmp r0, r3						\n"
+	"	blo .LPendSV_overflow			\n"
+	"	ldr r3, =" TPORT_STR(TINYOS_TASK_STACK_FILL) "	\n"
+	"	ldr r0, [r2]					\n"
+	"	cmp r0, r3						\n"
+	"	bne .LPendSV_overflow			\n"
+	"	ldr r0, [r2, #((" TPORT_STR(TINYOS_STACK_CANARY_WORDS) " - 1) * 4)]	\n"
+	"	cmp r0, r3						\n"
+	"	bne .LPendSV_overflow			\n"
+#endif
+	".LPendSV_nosave:					\n"
+	"	ldr r0, =curTask				\n"
+	"	ldr r1, =nextTask				\n"
+	"	ldr r2, [r1]					\n"
+	"	str r2, [r0]					\n"
+	"	ldr r0, [r2]					\n"
+	"	adds r0, r0, #16				\n"
+	"	ldmia r0!, {r4-r7}				\n"
+	"	mov r8, r4						\n"
+	"	mov r9, r5						\n"
+	"	mov r10, r6						\n"
+	"	mov r11, r7						\n"
+	"	subs r0, r0, #32				\n"
+	"	ldmia r0!, {r4-r7}				\n"
+	"	adds r0, r0, #16				\n"
+	"	msr psp, r0						\n"
+	"	movs r0, #2						\n"
+	"	mvns r0, r0						\n"
+	"	bx r0							\n"
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	".LPendSV_overflow:					\n"
+	"	mov r0, r1						\n"
+	"	bl tTaskStackOverflow			\n"
+#endif
+	"	.align 2						\n"
+	"	.ltorg							\n"
+	);
+}
+#else
+#error "unsupported compiler"
+#endif
+
+//在栈顶构造任务的初始上下文，格式与PendSV恢复的顺序一致，返回保存的栈指针
+tTaskStack * tTaskStackInit(tTaskStack * stackTop, void (*entry)(void *), void * param) {
+    // 硬件自动保存的部分：xPSR(Thumb位)、PC、LR、R12、R3-R0
+    *(--stackTop) = (unsigned long)(1 << 24);
+    *(--stackTop) = (unsigned long)entry;
+    *(--stackTop) = (unsigned long)0xFFFFFFFD;
+    *(--stackTop) = (unsigned long)0x12;
+    *(--stackTop) = (unsigned long)0x3;
+    *(--stackTop) = (unsigned long)0x2;
+    *(--stackTop) = (unsigned long)0x1;
+    *(--stackTop) = (unsigned long)param;
+
+    // PendSV恢复的R11-R4
+    *(--stackTop) = (unsigned long)0x11;
+    *(--stackTop) = (unsigned long)0x10;
+    *(--stackTop) = (unsigned long)0x9;
+    *(--stackTop) = (unsigned long)0x8;
+    *(--stackTop) = (unsigned long)0x7;
+    *(--stackTop) = (unsigned long)0x6;
+    *(--stackTop) = (unsigned long)0x5;
+    *(--stackTop) = (unsigned long)0x4;
+
+    return stackTop;
+}
+
+void tTaskRunFirst(void) {
+	__set_PSP(0);
+
+	NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+TINYOS_FAST_CODE void tTaskSwitch(void) {
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+TINYOS_FAST_CODE uint32_t tTaskEnterCritical(void) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+TINYOS_FAST_CODE void tTaskExitCritical(uint32_t status) {
+	__set_PRIMASK(status);
+}
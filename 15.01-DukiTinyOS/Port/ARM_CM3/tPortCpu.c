@@ -0,0 +1,360 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+// Cortex-M3移植：没有FPU，任务总是以基本栈帧返回线程模式，EXC_RETURN固定为0xFFFFFFFD，不必随任务保存
+
+#if TINYOS_PORT_CORE != 3
+#error "Port/ARM_CM3 is built but TINYOS_PORT_CORE is not 3"
+#endif
+
+#define TPORT_STR(x)    TPORT_XSTR(x)
+#define TPORT_XSTR(x)   #x
+
+//任务堆栈中软件保存的部分（自低地址到高地址）：R4-R11
+#if defined(__CC_ARM)
+__asm void PendSV_Handler(void) {
+	IMPORT curTask
+	IMPORT nextTask
+	IMPORT tTaskSwitchCount
+	IMPORT tTaskSwitchSkipCount
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	IMPORT tIrqStatEnter
+	IMPORT tIrqStatExit
+
+	PUSH {R0,LR}        //PendSV自身的耗时按异常号14统计
+	BL tIrqStatEnter
+	POP {R0,LR}
+#endif
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+	IMPORT tTaskIsrReadyDrain
+
+	//中断中通知唤醒的任务先加入就绪表并更新nextTask，其中的调度再次挂起的PendSV在此清除
+	PUSH {R0,LR}
+	BL tTaskIsrReadyDrain
+	POP {R0,LR}
+	LDR R0,=0xE000ED04  //SCB->ICSR
+	LDR R1,=0x08000000  //PENDSVCLR
+	STR R1,[R0]
+#endif
+
+	//PendSV挂起后又有调度使nextTask回到curTask时(如中断中先后就绪了两个任务)，无需切换，直接返回
+	LDR R0,=curTask
+	LDR R0,[R0]
+	LDR R1,=nextTask
+	LDR R1,[R1]
+	CMP R0,R1
+	BNE PendSVHandler_switch
+	LDR R2,=tTaskSwitchSkipCount
+	LDR R3,[R2]
+	ADDS R3,R3,#1
+	STR R3,[R2]
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	PUSH {R0,LR}
+	BL tIrqStatExit
+	POP {R0,LR}
+#endif
+	BX LR
+
+PendSVHandler_switch
+	LDR R2,=tTaskSwitchCount
+	LDR R3,[R2]
+	ADDS R3,R3,#1
+	STR R3,[R2]
+#if TINYOS_ENABLE_PROFILING == 1
+	IMPORT tProfilePendSVStart
+	IMPORT tProfilePendSVExit
+
+	LDR R0,=0xE0001004  //DWT->CYCCNT，记录PendSV入口时间
+	LDR R0,[R0]
+	LDR R1,=tProfilePendSVStart
+	STR R0,[R1]
+#endif
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+	IMPORT tTaskRunTimeUpdate
+
+	PUSH {R0,LR}        //此时curTask仍为切出的任务，将其运行时间计入
+	BL tTaskRunTimeUpdate
+	POP {R0,LR}
+#endif
+
+	MRS R0,PSP
+	CBZ R0,PendSVHandler_nosave
+
+	STMDB R0!,{R4-R11}  //保存地址是当前任务的PSP
+
+	LDR R1,=curTask
+	LDR R1,[R1]
+
+	STR R0,[R1]
+
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	IMPORT tTaskStackOverflow
+
+	//检查切出任务的栈：保存后的栈指针不能进入栈底的保护字，保护字也不能被改写
+	LDR R2,[R1,#4]      //stackBase
+	ADD R3,R2,#(TINYOS_STACK_CANARY_WORDS * 4)
+	CMP R0,R3
+	BLO PendSVHandler_overflow
+#if TINYOS_ENABLE_STACK_GUARD == 0
+	LDR R12,=TINYOS_TASK_STACK_FILL
+	LDR R3,[R2]
+	CMP R3,R12
+	BNE PendSVHandler_overflow
+	LDR R3,[R2,#((TINYOS_STACK_CANARY_WORDS - 1) * 4)]
+	CMP R3,R12
+	BNE PendSVHandler_overflow
+#endif
+#endif
+
+PendSVHandler_nosave
+	LDR R0,=curTask
+	LDR R1,=nextTask
+	LDR R2,[R1]
+	STR R2,[R0]     //将curTask更新为nextTask
+
+#if TINYOS_ENABLE_STACK_GUARD == 1
+	//MPU区域7设为切入任务栈底的保护区，异常返回后生效
+	LDR R3,[R2,#4]
+	ADD R3,R3,#31
+	BIC R3,R3,#31
+	ORR R3,R3,#0x17     //VALID，区域号7
+	LDR R12,=0xE000ED9C //MPU->RBAR
+	STR R3,[R12]
+	LDR R3,=0x10000009  //MPU->RASR：XN，AP=禁止访问，SIZE=32字节，使能
+	STR R3,[R12,#4]
+	DSB
+#endif
+
+#if TINYOS_ENABLE_USER_MODE == 1
+	IMPORT tSvcSwitchIn
+
+	//装载切入任务的MPU区域并设置线程模式的特权级
+	PUSH {R2,LR}
+	BL tSvcSwitchIn
+	POP {R2,LR}
+#endif
+
+	LDR R0,[R2]     //R2本身已经是curTask，[R2]表示其中的第一个long数据，即堆栈指针
+	LDMIA R0!,{R4-R11}  //恢复寄存器
+
+
+	MSR PSP,R0
+#if TINYOS_ENABLE_PROFILING == 1
+	BL tProfilePendSVExit   //R4-R11已恢复且由被调函数保护，LR随后重新设置
+#endif
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	BL tIrqStatExit
+#endif
+	MVN LR,#2           //EXC_RETURN = 0xFFFFFFFD，第一次切换时从MSP进入，也要返回到PSP
+	BX LR
+
+#if TINYOS_ENABLE_STACK_CHECK == 1
+PendSVHandler_overflow
+	MOV R0,R1
+	BL tTaskStackOverflow   //不返回
+#endif
+	ALIGN 4
+}
+#elif defined(__GNUC__) || defined(__clang__)
+//GCC及ARMCLANG(AC6)：与上面的ARMCC版本逐条对应，naked函数不生成入口/出口代码
+TINYOS_FAST_CODE __attribute__((naked)) void PendSV_Handler(void) {
+	__asm volatile (
+	"	.syntax unified					\n"
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	"	push {r0, lr}					\n"
+	"	bl tIrqStatEnter				\n"
+	"	pop {r0, lr}					\n"
+#endif
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+	"	push {r0, lr}					\n"
+	"	bl tTaskIsrReadyDrain			\n"
+	"	pop {r0, lr}					\n"
+	"	ldr r0, =0xE000ED04				\n"
+	"	ldr r1, =0x08000000				\n"
+	"	str r1, [r0]					\n"
+#endif
+	"	ldr r0, =curTask				\n"
+	"	ldr r0, [r0]					\n"
+	"	ldr r1, =nextTask				\n"
+	"	ldr r1, [r1]					\n"
+	"	cmp r0, r1						\n"
+	"	bne .LPendSV_switch				\n"
+	"	ldr r2, =tTaskSwitchSkipCount	\n"
+	"	ldr r3, [r2]					\n"
+	"	adds r3, r3, #1					\n"
+	"	str r3, [r2]					\n"
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	"	push {r0, lr}					\n"
+	"	bl tIrqStatExit					\n"
+	"	pop {r0, lr}					\n"
+#endif
+	"	bx lr							\n"
+	".LPendSV_switch:					\n"
+	"	ldr r2, =tTaskSwitchCount		\n"
+	"	ldr r3, [r2]					\n"
+	"	adds r3, r3, #1					\n"
+	"	str r3, [r2]					\n"
+#if TINYOS_ENABLE_PROFILING == 1
+	"	ldr r0, =0xE0001004				\n"
+	"	ldr r0, [r0]					\n"
+	"	ldr r1, =tProfilePendSVStart	\n"
+	"	str r0, [r1]					\n"
+#endif
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+	"	push {r0, lr}					\n"
+	"	bl tTaskRunTimeUpdate			\n"
+	"	pop {r0, lr}					\n"
+#endif
+	"	mrs r0, psp						\n"
+	"	cbz r0, .LPendSV_nosave			\n"
+	"	stmdb r0!, {r4-r11}				\n"
+	"	ldr r1, =curTask				\n"
+	"	ldr r1, [r1]					\n"
+	"	str r0, [r1]					\n"
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	"	ldr r2, [r1, #4]				\n"
+	"	add r3, r2, #(" TPORT_STR(TINYOS_STACK_CANARY_WORDS) " * 4)	\n"
+	"	cmp r0, r3						\n"
+	"	blo .LPendSV_overflow			\n"
+#if TINYOS_ENABLE_STACK_GUARD == 0
+	"	ldr r12, =" TPORT_STR(TINYOS_TASK_STACK_FILL) "	\n"
+	"	ldr r3, [r2]					\n"
+	"	cmp r3, r12						\n"
+	"	bne .LPendSV_overflow			\n"
+	"	ldr r3, [r2, #((" TPORT_STR(TINYOS_STACK_CANARY_WORDS) " - 1) * 4)]	\n"
+	"	cmp r3, r12						\n"
+	"	bne .LPendSV_overflow			\n"
+#endif
+#endif
+	".LPendSV_nosave:					\n"
+	"	ldr r0, =curTask				\n"
+	"	ldr r1, =nextTask				\n"
+	"	ldr r2, [r1]					\n"
+	"	str r2, [r0]					\n"
+#if TINYOS_ENABLE_STACK_GUARD == 1
+	"	ldr r3, [r2, #4]				\n"
+	"	add r3, r3, #31					\n"
+	"	bic r3, r3, #31					\n"
+	"	orr r3, r3, #0x17				\n"
+	"	ldr r12, =0xE000ED9C			\n"
+	"	str r3, [r12]					\n"
+	"	ldr r3, =0x10000009				\n"
+	"	str r3, [r12, #4]				\n"
+	"	dsb								\n"
+#endif
+#if TINYOS_ENABLE_USER_MODE == 1
+	"	push {r2, lr}					\n"
+	"	bl tSvcSwitchIn					\n"
+	"	pop {r2, lr}					\n"
+#endif
+	"	ldr r0, [r2]					\n"
+	"	ldmia r0!, {r4-r11}				\n"
+	"	msr psp, r0						\n"
+#if TINYOS_ENABLE_PROFILING == 1
+	"	bl tProfilePendSVExit			\n"
+#endif
+#if TINYOS_ENABLE_IRQ_STAT == 1
+	"	bl tIrqStatExit				\n"
+#endif
+	"	mvn lr, #2						\n"
+	"	bx lr							\n"
+#if TINYOS_ENABLE_STACK_CHECK == 1
+	".LPendSV_overflow:					\n"
+	"	mov r0, r1						\n"
+	"	bl tTaskStackOverflow			\n"
+#endif
+	"	.align 2						\n"
+	"	.ltorg							\n"
+	);
+}
+#else
+#error "unsupported compiler"
+#endif
+
+//在栈顶构造任务的初始上下文，格式与PendSV恢复的顺序一致，返回保存的栈指针
+tTaskStack * tTaskStackInit(tTaskStack * stackTop, void (*entry)(void *), void * param) {
+    // 设置xpsr寄存器，第24位置1进入Thumb模式
+    *(--stackTop) = (unsigned long)(1 << 24);
+
+    // 设置PC寄存器（程序计数器），即任务入口地址
+    *(--stackTop) = (unsigned long)entry;
+
+    // 设置LR寄存器（链接寄存器），即任务返回地址
+    *(--stackTop) = (unsigned long)0xFFFFFFFD;
+
+    // 设置其他寄存器的初始值
+    *(--stackTop) = (unsigned long)0x12;      // R12寄存器
+    *(--stackTop) = (unsigned long)0x3;       // R3寄存器
+    *(--stackTop) = (unsigned long)0x2;       // R2寄存器
+    *(--stackTop) = (unsigned long)0x1;       // R1寄存器
+    *(--stackTop) = (unsigned long)param;     // 任务的入口函数参数
+
+    // 设置其他寄存器的初始值
+    *(--stackTop) = (unsigned long)0x11;      // R11寄存器
+    *(--stackTop) = (unsigned long)0x10;      // R10寄存器
+    *(--stackTop) = (unsigned long)0x9;       // R9寄存器
+    *(--stackTop) = (unsigned long)0x8;       // R8寄存器
+    *(--stackTop) = (unsigned long)0x7;       // R7寄存器
+    *(--stackTop) = (unsigned long)0x6;       // R6寄存器
+    *(--stackTop) = (unsigned long)0x5;       // R5寄存器
+    *(--stackTop) = (unsigned long)0x4;       // R4寄存器
+
+    return stackTop;
+}
+
+void tTaskRunFirst(void) {
+	__set_PSP(0);
+
+	// PendSV设为最低优先级，在所有中断退出后才切换任务
+	NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+TINYOS_FAST_CODE void tTaskSwitch(void) {
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+//只屏蔽优先级数值不小于TINYOS_MAX_SYSCALL_PRIO的中断，更高优先级的中断不受内核影响
+//__set_BASEPRI_MAX只会提高屏蔽级别，嵌套进入时不会降低
+TINYOS_FAST_CODE uint32_t tTaskEnterCritical(void) {
+	uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI_MAX(TINYOS_MAX_SYSCALL_PRIO << (8 - __NVIC_PRIO_BITS));
+	__ISB();
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+	if (basepri == 0) {
+		tCritProfileEnter(TINYOS_RETURN_ADDRESS());
+	}
+#endif
+	return basepri;
+}
+
+TINYOS_FAST_CODE void tTaskExitCritical(uint32_t status) {
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+	if (status == 0) {
+		tCritProfileExit();
+	}
+#endif
+	__set_BASEPRI(status);
+}
+#else
+TINYOS_FAST_CODE uint32_t tTaskEnterCritical(void) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+	if (primask == 0) {
+		tCritProfileEnter(TINYOS_RETURN_ADDRESS());
+	}
+#endif
+	return primask;
+}
+
+TINYOS_FAST_CODE void tTaskExitCritical(uint32_t status) {
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+	if (status == 0) {
+		tCritProfileExit();
+	}
+#endif
+	__set_PRIMASK(status);
+}
+#endif
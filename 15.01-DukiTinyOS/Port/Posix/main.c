@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "tinyOS.h"
+
+// 主机仿真的启动代码，与Core/Src/main.c相同，只是没有外设初始化，空闲时等待下一次仿真中断
+tTask tTaskIdle;
+tTaskStack idleTaskEnv[TINYOS_IDLETASK_STACK_SIZE];
+
+void idleTaskEntry (void * param) {
+	
+    // 初始化App相关配置
+    tInitApp();
+	
+#if TINYOS_ENABLE_TIMER == 1
+    // 初始化定时器任务
+    tTimerInitTask();
+#endif
+
+#if TINYOS_ENABLE_JOB == 1
+    // 初始化作业分派任务
+    tJobInitTask();
+#endif
+
+#if TINYOS_ENABLE_COROUTINE == 1
+    // 初始化协程宿主任务
+    tCoroutineInitTask();
+#endif
+
+#if TINYOS_ENABLE_WORKQUEUE == 1
+    // 初始化系统工作队列
+    tWorkQueueInitTask();
+#endif
+
+#if TINYOS_ENABLE_LOG == 1
+    // 初始化日志输出任务
+    tLogInitTask();
+#endif
+
+#if TINYOS_ENABLE_SHELL == 1
+    // 初始化串口调试命令行
+    tShellInitTask();
+#endif
+	
+    // 启动系统时钟节拍
+    tSetSysTickPeriod(TINYOS_SYSTICK_MS);
+	
+    for (;;)
+    {
+        tHooksRunCpuIdle();
+
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+        tTaskStackMonitorStep();
+#endif
+
+#if TINYOS_ENABLE_IDLE_JOB == 1
+        // 仍有空闲作业未完成时不休眠
+        if (tIdleJobRun()) {
+            continue;
+        }
+#endif
+
+        tPortIdle();
+    }
+}
+
+int main () 
+{
+    // 输出不缓冲，便于与目标板串口输出对照
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    tTinyOSInit();
+    // 创建空闲任务
+    tTaskInit(&tTaskIdle, idleTaskEntry, (void *)0, TINYOS_PRIO_COUNT - 1, idleTaskEnv, sizeof(idleTaskEnv));
+    tObjectSetName(&tTaskIdle.object, "idle");
+    tTinyOSStart();
+    return 0;
+}
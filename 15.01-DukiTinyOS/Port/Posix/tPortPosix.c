@@ -0,0 +1,296 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "tinyOS.h"
+
+// 主机仿真移植层：代替Port/ARM_CMx及Source/tCpu.c，内核其余源文件不做修改即可在Linux上编译运行
+// 编译示例(在工程根目录下)：
+//   gcc -DTINYOS_PORT_POSIX -ISource -IPort/Posix -o tinyos_sim Source/*.c Port/Posix/*.c
+//       排除 Source/tCpu.c Source/tHrTimer.c Source/tPower.c
+// 所有任务运行在同一个主机线程中，每个任务一个ucontext，任务的上下文及栈由仿真层另外分配，
+// tTaskInit传入的栈只用于栈统计；SysTick由SIGALRM模拟，临界区只是一个标志，
+// 处于临界区或仿真中断中时到达的信号推迟到退出时处理，行为与BASEPRI屏蔽后挂起的中断相同
+// 任务池、slab等模块把指针存进32位字，打开这些功能时需加-m32按32位编译
+
+#define TPORT_STACK_SIZE        (64 * 1024)     //每个任务在主机上使用的栈
+#define TPORT_CONTEXT_MAX       64
+
+typedef struct _tPortContext {
+    ucontext_t context;
+    tTaskStack * stackTop;          //目标板上的栈顶，同一个栈重新初始化任务时复用上下文
+    void (*entry) (void *);
+    void * param;
+    void * hostStack;
+}tPortContext;
+
+static tPortContext tPortContexts[TPORT_CONTEXT_MAX];
+static uint32_t tPortContextCount;
+
+volatile uint32_t tPortExclusive;
+volatile uint32_t tPortInIsr;
+uint32_t SystemCoreClock = 1000000000;  //仿真的周期计数以纳秒为单位
+tPortIwdg tPortIwdgRegs;
+
+static volatile uint32_t tPortMasked;           //临界区标志，相当于BASEPRI
+static volatile uint32_t tPortTickPending;      //被推迟的节拍中断数
+static volatile uint32_t tPortSwitchPending;    //相当于PendSV挂起
+static uint64_t tPortTickStartNs;               //最近一个节拍开始的时刻
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+static uint32_t tPortTickOverrunCount;          //一次处理多个推迟的节拍的次数
+static uint32_t tPortTickMissedTicks;
+#endif
+
+static uint64_t tPortNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+//任务入口，任务函数不应返回
+static void tPortTaskStart(int index) {
+    tPortContext * ctx = &tPortContexts[index];
+    ctx->entry(ctx->param);
+    fprintf(stderr, "tinyOS sim: task entry %p returned\n", (void *)ctx->entry);
+    exit(1);
+}
+
+tTaskStack * tTaskStackInit(tTaskStack * stackTop, void (*entry)(void *), void * param) {
+    uint32_t i;
+    tPortContext * ctx = (tPortContext *)0;
+
+    for (i = 0; i < tPortContextCount; i++) {
+        if (tPortContexts[i].stackTop == stackTop) {
+            ctx = &tPortContexts[i];
+            break;
+        }
+    }
+    if (ctx == (tPortContext *)0) {
+        if (tPortContextCount >= TPORT_CONTEXT_MAX) {
+            fprintf(stderr, "tinyOS sim: too many tasks\n");
+            exit(1);
+        }
+        i = tPortContextCount++;
+        ctx = &tPortContexts[i];
+        ctx->stackTop = stackTop;
+        ctx->hostStack = malloc(TPORT_STACK_SIZE);
+    }
+
+    ctx->entry = entry;
+    ctx->param = param;
+    getcontext(&ctx->context);
+    ctx->context.uc_stack.ss_sp = ctx->hostStack;
+    ctx->context.uc_stack.ss_size = TPORT_STACK_SIZE;
+    ctx->context.uc_link = (ucontext_t *)0;
+    sigemptyset(&ctx->context.uc_sigmask);
+    makecontext(&ctx->context, (void (*)(void))tPortTaskStart, 1, (int)i);
+
+    // PendSV只访问task->stack，仿真中用它保存上下文
+    return (tTaskStack *)ctx;
+}
+
+//相当于PendSV：切换到nextTask，只在不处于临界区及仿真中断时调用
+static void tPortDoSwitch(void) {
+    tTask * from;
+
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+    //其中的调度只更新nextTask，按处于中断中处理，不递归切换
+    tPortInIsr = 1;
+    tTaskIsrReadyDrain();
+    tPortInIsr = 0;
+#endif
+    tPortSwitchPending = 0;
+    if (curTask == nextTask) {
+        tTaskSwitchSkipCount++;
+        return;
+    }
+    tTaskSwitchCount++;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    tTaskRunTimeUpdate();
+#endif
+    from = curTask;
+    curTask = nextTask;
+    swapcontext(&((tPortContext *)from->stack)->context, &((tPortContext *)curTask->stack)->context);
+}
+
+//处理推迟的节拍中断及任务切换，期间屏蔽SIGALRM，切换后由切入任务恢复它自己的屏蔽状态
+static void tPortServicePending(void) {
+    sigset_t block, old;
+
+    sigemptyset(&block);
+    sigaddset(&block, SIGALRM);
+    sigprocmask(SIG_BLOCK, &block, &old);
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    //推迟了多个节拍时，除最后一个外合并为一次推进，与目标板上丢失的节拍中断相同
+    if (tPortTickPending > 1) {
+        uint32_t missed = tPortTickPending - 1;
+
+        tPortTickPending = 1;
+        tPortTickOverrunCount++;
+        tPortTickMissedTicks += missed;
+        tPortInIsr = 1;
+        tTaskSystemTickCatchUp(missed);
+        tPortInIsr = 0;
+    }
+#endif
+    while (tPortTickPending) {
+        tPortTickPending--;
+        tPortInIsr = 1;
+        tPortExclusive = 0;
+        tPortTickStartNs = tPortNowNs();
+        tIrqStatEnter();
+        tTaskSystemTickHandler();
+        tIrqStatExit();
+        tPortInIsr = 0;
+    }
+    if (tPortSwitchPending) {
+        tPortDoSwitch();
+    }
+    sigprocmask(SIG_SETMASK, &old, (sigset_t *)0);
+}
+
+static void tPortSignalHandler(int sig) {
+    (void)sig;
+    tPortTickPending++;
+    tPortExclusive = 0;
+    if (tPortMasked || tPortInIsr) {
+        return;
+    }
+    tPortServicePending();
+}
+
+uint32_t tTaskEnterCritical(void) {
+    uint32_t status = tPortMasked;
+    tPortMasked = 1;
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+    if (status == 0) {
+        tCritProfileEnter(TINYOS_RETURN_ADDRESS());
+    }
+#endif
+    return status;
+}
+
+void tTaskExitCritical(uint32_t status) {
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+    if ((status == 0) && tPortMasked) {
+        tCritProfileExit();
+    }
+#endif
+    tPortMasked = status;
+    if (!status && !tPortInIsr && (tPortTickPending || tPortSwitchPending)) {
+        tPortServicePending();
+    }
+}
+
+void __disable_irq(void) {
+    tPortMasked = 1;
+}
+
+void __enable_irq(void) {
+    tTaskExitCritical(0);
+}
+
+void tTaskSwitch(void) {
+    tPortSwitchPending = 1;
+    if (!tPortMasked && !tPortInIsr) {
+        tPortServicePending();
+    }
+}
+
+void tTaskRunFirst(void) {
+    static ucontext_t mainContext;
+
+    curTask = nextTask;
+    swapcontext(&mainContext, &((tPortContext *)curTask->stack)->context);
+}
+
+void tSetSysTickPeriod(uint32_t ms) {
+    struct sigaction action;
+    struct itimerval timer;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = tPortSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &action, (struct sigaction *)0);
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    // 主机上立即切换，每次SIGALRM推进相应的节拍数
+    if (ms < TINYOS_SYSTICK_MS) {
+        ms = TINYOS_SYSTICK_MS;
+    }
+    tTaskTickStepSet(ms / TINYOS_SYSTICK_MS);
+    ms = ms / TINYOS_SYSTICK_MS * TINYOS_SYSTICK_MS;
+#endif
+    tPortTickStartNs = tPortNowNs();
+    timer.it_interval.tv_sec = ms / 1000;
+    timer.it_interval.tv_usec = (ms % 1000) * 1000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, (struct itimerval *)0);
+}
+
+uint32_t tSysTickCyclesSince(uint32_t tick) {
+    return (tTaskTickGet() - tick) * (TINYOS_SYSTICK_MS * 1000000) + (uint32_t)(tPortNowNs() - tPortTickStartNs);
+}
+
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+uint32_t tTaskTickOverrunGet(uint32_t * missedTicks) {
+    if (missedTicks != (uint32_t *)0) {
+        *missedTicks = tPortTickMissedTicks;
+    }
+    return tPortTickOverrunCount;
+}
+#endif
+
+uint64_t tTimeGetMicros(void) {
+    uint64_t ticks;
+    uint64_t start;
+    uint32_t status = tTaskEnterCritical();
+
+    ticks = tTimeGetTicks64();
+    start = tPortTickStartNs;
+    tTaskExitCritical(status);
+    return ticks * (TINYOS_SYSTICK_MS * 1000) + (tPortNowNs() - start) / 1000;
+}
+
+void tCycleCounterInit(void) {
+}
+
+uint32_t tCycleCounterGet(void) {
+    return (uint32_t)tPortNowNs();
+}
+
+// 主机上周期计数即纳秒，延时全程忙等
+void tDelayCycles(uint32_t cycles) {
+    uint64_t start = tPortNowNs();
+
+    while ((tPortNowNs() - start) < cycles) {
+    }
+}
+
+void tDelayUs(uint32_t us) {
+    uint64_t start = tPortNowNs();
+
+    while ((tPortNowNs() - start) < (uint64_t)us * 1000) {
+    }
+}
+
+void tStackGuardInit(void) {
+}
+
+void tPortIdle(void) {
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigsuspend(&mask);
+}
+
+#if TINYOS_ENABLE_TICKLESS == 1
+void tTicklessIdle(void) {
+    tPortIdle();
+}
+#endif
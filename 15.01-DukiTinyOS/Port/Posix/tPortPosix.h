@@ -0,0 +1,82 @@
+#ifndef __TPORTPOSIX_H
+#define __TPORTPOSIX_H
+
+#include <stdint.h>
+
+// 主机仿真用的处理器内建函数：所有任务运行在同一个主机线程中，中断由信号模拟，
+// 因此内存屏障只需阻止编译器重排，独占访问用一个由“中断”清除的标志模拟
+
+extern volatile uint32_t tPortExclusive;
+extern volatile uint32_t tPortInIsr;
+extern uint32_t SystemCoreClock;
+
+static __inline uint32_t __CLZ(uint32_t value) {
+    return (value == 0) ? 32 : (uint32_t)__builtin_clz(value);
+}
+
+// 逐级交换相邻的1位、2位、4位组后再将字节反序，避免逐位循环影响主机微基准的计时
+static __inline uint32_t __RBIT(uint32_t value) {
+    value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+    value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+    value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+    return __builtin_bswap32(value);
+}
+
+#define __DMB()     __sync_synchronize()
+#define __DSB()     __sync_synchronize()
+#define __ISB()     __sync_synchronize()
+
+// 与LDREX/STREX相同：两者之间发生过“中断”时STREX失败，返回1
+static __inline uint32_t __LDREXW(volatile uint32_t * addr) {
+    tPortExclusive = 1;
+    return *addr;
+}
+
+static __inline uint32_t __STREXW(uint32_t value, volatile uint32_t * addr) {
+    if (!tPortExclusive) {
+        return 1;
+    }
+    tPortExclusive = 0;
+    *addr = value;
+    return 0;
+}
+
+// 按指针宽度的独占访问，64位主机上不截断指针
+static __inline void * tPortLdrexPtr(void * volatile * addr) {
+    tPortExclusive = 1;
+    return *addr;
+}
+
+static __inline uint32_t tPortStrexPtr(void * value, void * volatile * addr) {
+    if (!tPortExclusive) {
+        return 1;
+    }
+    tPortExclusive = 0;
+    *addr = value;
+    return 0;
+}
+
+static __inline void __CLREX(void) {
+    tPortExclusive = 0;
+}
+
+// 仿真的“中断号”，处于仿真中断中时返回SysTick的异常号
+static __inline uint32_t __get_IPSR(void) {
+    return tPortInIsr ? 15 : 0;
+}
+
+void __disable_irq(void);
+void __enable_irq(void);
+
+// 独立看门狗只保留寄存器，写入不产生效果
+typedef struct {
+    volatile uint32_t KR;
+    volatile uint32_t PR;
+    volatile uint32_t RLR;
+    volatile uint32_t SR;
+} tPortIwdg;
+extern tPortIwdg tPortIwdgRegs;
+#define IWDG        (&tPortIwdgRegs)
+
+// 空闲任务中等待下一次仿真中断
+#endif
@@ -1,5 +1,11 @@
 #include "tinyOS.h"
+
+#if (TINYOS_ENABLE_BENCHMARK == 0) && (TINYOS_ENABLE_FLIGHT == 0)
+#ifdef TINYOS_PORT_POSIX
+#include <stdio.h>
+#else
 #include "MySerial.h"
+#endif
 
 tTask Ttask1;
 tTask Ttask2;
@@ -15,39 +21,43 @@ tTaskStack task4Stack[1024];
 int task1Flag;
 void task1Entry (void * param)
 {
+     uint32_t lastWakeTick = tTaskTickGet();
      for (;;)
     {
         printf("this is task1\n");
-        tTaskDelay(10);
+        tTaskDelayUntil(&lastWakeTick, 10);
     }
 }
 
 int task2Flag;
 void task2Entry (void * param)
 {		
+	uint32_t lastWakeTick = tTaskTickGet();
 	for (;;)
 	{					
 		printf("this is task2\n");
-		tTaskDelay(10);
+		tTaskDelayUntil(&lastWakeTick, 10);
 	}
 }
 
 int task3Flag;
 void task3Entry (void * param)
 {
+	uint32_t lastWakeTick = tTaskTickGet();
 	for (;;)
 	{			
 		printf("this is task3\n");
-		tTaskDelay(10);
+		tTaskDelayUntil(&lastWakeTick, 10);
 	}
 }
 int task4Flag;
 void task4Entry (void * param)
 {	
+	uint32_t lastWakeTick = tTaskTickGet();
 	for (;;)
 	{				
 		printf("this is task4\n");
-		tTaskDelay(10);
+		tTaskDelayUntil(&lastWakeTick, 10);
 	}
 }
 
@@ -57,3 +67,5 @@ void tInitApp(void) {
 		tTaskInit(&Ttask3, task3Entry, (void *)0x33333333, 2, task3Stack,sizeof(task3Stack));
 	  tTaskInit(&Ttask4, task4Entry, (void *)0x44444444, 3, task4Stack,sizeof(task4Stack));
 }
+
+#endif
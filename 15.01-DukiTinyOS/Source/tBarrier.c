@@ -0,0 +1,100 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_BARRIER == 1
+/**
+ * @brief 初始化屏障。
+ * 
+ * @param barrier   指向屏障的指针。
+ * @param count     每轮的参与者数量。
+ * 
+ * @return void
+ */
+void tBarrierInit(tBarrier * barrier, uint32_t count) {
+    tEventInit(&barrier->event, tEventTypeBarrier);
+    tRegistryAdd(&barrier->event.object, tObjectTypeEvent);
+    barrier->count = count;
+    barrier->arrived = 0;
+    barrier->cycle = 0;
+}
+
+/**
+ * @brief 到达屏障并等待其余参与者。
+ * 
+ * 最后一个到达的任务一次性唤醒本轮所有等待者，只做一次调度。
+ * 
+ * @param barrier    指向屏障的指针。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待，超时的任务退出本轮，不再计入已到达数量。
+ * 
+ * @return uint32_t  `tErrorNoError`表示本轮放行，`tErrorTimeOut`表示超时，`tErrorDel`表示屏障被删除。
+ */
+uint32_t tBarrierWait(tBarrier * barrier, uint32_t waitTicks) {
+    uint32_t cycle, count;
+    uint32_t status = tTaskEnterCritical();
+
+    if (++barrier->arrived >= barrier->count) {
+        barrier->arrived = 0;
+        barrier->cycle++;
+        count = tEventRemoveAll(&barrier->event, (void *)0, tErrorNoError);
+        tTaskExitCritical(status);
+
+        if (count > 0) {
+            tTaskSched();
+        }
+        return tErrorNoError;
+    }
+
+    cycle = barrier->cycle;
+    tEventWait(&barrier->event, curTask, (void *)0, tEventTypeBarrier, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    if (curTask->waitEventResult == tErrorTimeOut) {
+        // 本轮尚未放行时撤回自己的到达计数
+        status = tTaskEnterCritical();
+        if ((barrier->cycle == cycle) && (barrier->arrived > 0)) {
+            barrier->arrived--;
+        }
+        tTaskExitCritical(status);
+    }
+    return curTask->waitEventResult;
+}
+
+/**
+ * @brief 获取屏障的状态信息。
+ * 
+ * @param barrier   指向屏障的指针。
+ * @param info      用于存放屏障信息的结构体指针。
+ * 
+ * @return void
+ */
+void tBarrierGetInfo(tBarrier * barrier, tBarrierInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->count = barrier->count;
+    info->arrived = barrier->arrived;
+    info->cycle = barrier->cycle;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除屏障，唤醒所有等待的任务。
+ * 
+ * @param barrier   指向屏障的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tBarrierDestroy(tBarrier * barrier) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&barrier->event, (void *)0, tErrorDel);
+    tRegistryRemove(&barrier->event.object);
+    barrier->arrived = 0;
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,23 @@
+#ifndef __TBARRIER_H
+#define __TBARRIER_H
+#include "tEvent.h"
+
+// 计数屏障，count个参与者都到达后同时放行，之后自动开始下一轮
+typedef struct _tBarrier {
+	tEvent event;
+	uint32_t count;                  //参与者数量
+	uint32_t arrived;                //本轮已到达的数量
+	uint32_t cycle;                  //已完成的轮数
+}tBarrier;
+
+typedef struct _tBarrierInfo {
+	uint32_t count;
+	uint32_t arrived;
+	uint32_t cycle;
+}tBarrierInfo;
+
+void tBarrierInit(tBarrier * barrier, uint32_t count);
+uint32_t tBarrierWait(tBarrier * barrier, uint32_t waitTicks);
+void tBarrierGetInfo(tBarrier * barrier, tBarrierInfo * info);
+uint32_t tBarrierDestroy(tBarrier * barrier);
+#endif
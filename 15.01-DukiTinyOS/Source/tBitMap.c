@@ -1,21 +1,19 @@
 #include "tLib.h"
+#include "tPort.h"
 
-void tBitMapInit(tBitMap* bitMap) {
-	bitMap->bitMap = 0;
-}
-uint32_t tBitMapPosCount(void) {
-	return 32;
-}
-void tBitMapSet(tBitMap* bitMap,uint32_t pos) {
-	//对应位置1
-	bitMap->bitMap |= 1 << pos;
-}
-void tBitMapClear(tBitMap* bitMap,uint32_t pos){
-	//对应位置0 
-	bitMap->bitMap &= ~(1 << pos);
-}
-uint32_t tBitMapGetFirstSet(tBitMap* bitMap) {
-	//获取第一个为1的位
+/**
+ * @brief 查找32位字中最低的为1的位
+ * 
+ * 位0对应最高优先级。M3/M4内核利用RBIT+CLZ两条指令完成，M0等无CLZ指令的内核使用查表法。
+ * 
+ * @param word 待查找的字，调用者需保证其不为0
+ * 
+ * @return uint32_t 最低的为1的位的序号
+ */
+static uint32_t tBitMapFirstSetInWord(uint32_t word) {
+#if TINYOS_BITMAP_USE_CLZ == 1
+	return tPortCtz(word);
+#else
 	static const uint8_t quickFindTable[] = {
 		0xff, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, //0x00 to 0x0F
 		4   , 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, //0x10 to 0x1F
@@ -34,17 +32,149 @@ uint32_t tBitMapGetFirstSet(tBitMap* bitMap) {
 		5   , 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, //0xE0 to 0xEF
 		4   , 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0  //0xF0 to 0xFF
 	};
-	//分四段查找32位bitMap中第一个出现0的地方
-	if(bitMap->bitMap & 0x000000ff) {
-		return quickFindTable[bitMap->bitMap & 0xff];
-	}else if(bitMap->bitMap & 0x0000ff00) {
-		return quickFindTable[(bitMap->bitMap >> 8 ) & 0xff] + 8 ;
-	}else if(bitMap->bitMap & 0x00ff0000) {
-		return quickFindTable[(bitMap->bitMap >> 16) & 0xff] + 16;
-	}else if(bitMap->bitMap & 0xff000000) {
-		return quickFindTable[(bitMap->bitMap >> 24) & 0xff] + 24;
+	//分四段查找32位字中第一个出现1的地方
+	if(word & 0x000000ff) {
+		return quickFindTable[word & 0xff];
+	}else if(word & 0x0000ff00) {
+		return quickFindTable[(word >> 8 ) & 0xff] + 8 ;
+	}else if(word & 0x00ff0000) {
+		return quickFindTable[(word >> 16) & 0xff] + 16;
 	}else {
+		return quickFindTable[(word >> 24) & 0xff] + 24;
+	}
+#endif
+}
+
+/**
+ * @brief 查找32位字中最高的为1的位
+ * 
+ * @param word 待查找的字，调用者需保证其不为0
+ * 
+ * @return uint32_t 最高的为1的位的序号
+ */
+static uint32_t tBitMapLastSetInWord(uint32_t word) {
+#if TINYOS_BITMAP_USE_CLZ == 1
+	return 31 - tPortClz(word);
+#else
+	uint32_t pos = 0;
+	//二分查找
+	if(word & 0xffff0000) {
+		word >>= 16;
+		pos += 16;
+	}
+	if(word & 0xff00) {
+		word >>= 8;
+		pos += 8;
+	}
+	if(word & 0xf0) {
+		word >>= 4;
+		pos += 4;
+	}
+	if(word & 0xc) {
+		word >>= 2;
+		pos += 2;
+	}
+	if(word & 0x2) {
+		pos += 1;
+	}
+	return pos;
+#endif
+}
+
+void tBitMapInit(tBitMap* bitMap) {
+#if TBITMAP_GROUP_COUNT > 1
+	uint32_t i;
+	bitMap->groupMap = 0;
+	for(i = 0;i < TBITMAP_GROUP_COUNT;i++) {
+		bitMap->bitMap[i] = 0;
+	}
+#else
+	bitMap->bitMap = 0;
+#endif
+}
+uint32_t tBitMapPosCount(void) {
+	return TBITMAP_GROUP_COUNT * 32;
+}
+TINYOS_FAST_CODE void tBitMapSet(tBitMap* bitMap,uint32_t pos) {
+	//对应位置1
+#if TBITMAP_GROUP_COUNT > 1
+	bitMap->bitMap[pos >> 5] |= 1u << (pos & 0x1f);
+	bitMap->groupMap |= 1u << (pos >> 5);
+#else
+	bitMap->bitMap |= 1u << pos;
+#endif
+}
+TINYOS_FAST_CODE void tBitMapClear(tBitMap* bitMap,uint32_t pos){
+	//对应位置0 
+#if TBITMAP_GROUP_COUNT > 1
+	bitMap->bitMap[pos >> 5] &= ~(1u << (pos & 0x1f));
+	if(bitMap->bitMap[pos >> 5] == 0) {
+		//组内已无置1的位，组位图对应位清0
+		bitMap->groupMap &= ~(1u << (pos >> 5));
+	}
+#else
+	bitMap->bitMap &= ~(1u << pos);
+#endif
+}
+TINYOS_FAST_CODE uint32_t tBitMapGetFirstSet(tBitMap* bitMap) {
+	//获取第一个为1的位
+#if TBITMAP_GROUP_COUNT > 1
+	uint32_t group;
+	if(bitMap->groupMap == 0) {
+		return tBitMapPosCount();
+	}
+	//先在组位图中找到最高优先级的组，再在组内查找
+	group = tBitMapFirstSetInWord(bitMap->groupMap);
+	return (group << 5) + tBitMapFirstSetInWord(bitMap->bitMap[group]);
+#else
+	if(bitMap->bitMap == 0) {
 		return tBitMapPosCount();
 	}
-	
-}
\ No newline at end of file
+	return tBitMapFirstSetInWord(bitMap->bitMap);
+#endif
+}
+TINYOS_FAST_CODE uint32_t tBitMapGetFirstSetMasked(tBitMap* bitMap,tBitMap* mask) {
+	//获取同时在mask中为1的第一个位，按组逐个查找，最多TBITMAP_GROUP_COUNT次
+#if TBITMAP_GROUP_COUNT > 1
+	uint32_t groups = bitMap->groupMap & mask->groupMap;
+	while(groups != 0) {
+		uint32_t group = tBitMapFirstSetInWord(groups);
+		uint32_t word = bitMap->bitMap[group] & mask->bitMap[group];
+		if(word != 0) {
+			return (group << 5) + tBitMapFirstSetInWord(word);
+		}
+		groups &= ~(1u << group);
+	}
+	return tBitMapPosCount();
+#else
+	uint32_t word = bitMap->bitMap & mask->bitMap;
+	if(word == 0) {
+		return tBitMapPosCount();
+	}
+	return tBitMapFirstSetInWord(word);
+#endif
+}
+uint32_t tBitMapGetLastSetUpTo(tBitMap* bitMap,uint32_t pos) {
+	//获取序号不大于pos的最后一个为1的位，即优先级不低于pos的最低优先级
+#if TBITMAP_GROUP_COUNT > 1
+	uint32_t group = pos >> 5;
+	uint32_t word = bitMap->bitMap[group] & ((2u << (pos & 0x1f)) - 1);
+	if(word != 0) {
+		return (group << 5) + tBitMapLastSetInWord(word);
+	}
+	//本组内没有，再在更高优先级的组中查找
+	word = bitMap->groupMap & ((1u << group) - 1);
+	if(word == 0) {
+		return tBitMapPosCount();
+	}
+	group = tBitMapLastSetInWord(word);
+	return (group << 5) + tBitMapLastSetInWord(bitMap->bitMap[group]);
+#else
+	//pos为31时2u << 31为0，减1后正好是全1的掩码
+	uint32_t word = bitMap->bitMap & ((2u << pos) - 1);
+	if(word == 0) {
+		return tBitMapPosCount();
+	}
+	return tBitMapLastSetInWord(word);
+#endif
+}
@@ -0,0 +1,253 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+
+#if TINYOS_CLOCK_LEVEL_MIN > 2
+#error "TINYOS_CLOCK_LEVEL_MIN must not exceed 2"
+#endif
+#if TINYOS_CLOCK_DOWN_USAGE * 2 >= TINYOS_CLOCK_UP_USAGE
+//降一级后利用率约加倍，不能超过升频的阈值，否则会在两级之间来回切换
+#error "TINYOS_CLOCK_DOWN_USAGE must be less than half of TINYOS_CLOCK_UP_USAGE"
+#endif
+
+// 电源电压2.7 ~ 3.6V时每个Flash等待周期允许的HCLK
+#define TCLOCK_HZ_PER_WAIT      30000000UL
+
+// 各等级的AHB及APB1分频，APB2始终不分频
+static const uint32_t clockCfgr[3] = {
+    RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV2,
+    RCC_CFGR_HPRE_DIV2 | RCC_CFGR_PPRE1_DIV1,
+    RCC_CFGR_HPRE_DIV4 | RCC_CFGR_PPRE1_DIV1,
+};
+
+static tClockNotifier * clockNotifierList;      // 驱动登记的通知，按登记的逆序排列
+static uint32_t clockFullHz;                    // 第0级的HCLK，即启动时的频率
+static uint32_t clockLevel;                     // 当前等级
+static uint32_t clockGovernorLevel;             // 调频策略选择的等级，全速请求时不生效
+static uint32_t clockLowSecs;                   // 利用率连续低于TINYOS_CLOCK_DOWN_USAGE的秒数
+static uint32_t clockBoost;
+static uint32_t clockHold;
+static uint32_t clockSwitchCount;
+static uint32_t clockDeferCount;
+static uint64_t clockTicks[TINYOS_CLOCK_LEVEL_COUNT];
+static uint64_t clockLevelStart;                // 进入当前等级时的节拍数
+
+/**
+ * @brief 记录启动时的HCLK作为第0级，在系统时钟配置完成之后调用。
+ *
+ * @return void
+ */
+void tClockInit(void) {
+    clockFullHz = SystemCoreClock;
+    clockLevel = 0;
+    clockGovernorLevel = 0;
+    clockLowSecs = 0;
+    clockLevelStart = tTimeGetTicks64();
+}
+
+/**
+ * @brief 登记时钟改变的通知，驱动在初始化时调用，登记后不能撤销。
+ *
+ * 通知在调频的临界区内调用，只应按新的时钟重写外设的分频寄存器；同一个通知只能登记一次。
+ *
+ * @param notifier 通知，由调用者提供存储空间
+ * @param func 时钟改变后调用的函数
+ * @param arg 传给func的参数
+ *
+ * @return void
+ */
+void tClockNotifierAdd(tClockNotifier * notifier, tClockNotifyFunc func, void * arg) {
+    uint32_t status;
+
+    notifier->func = func;
+    notifier->arg = arg;
+    status = tTaskEnterCritical();
+    notifier->next = clockNotifierList;
+    clockNotifierList = notifier;
+    tTaskExitCritical(status);
+}
+
+//切换到level，需在临界区内调用
+static void tClockSwitch(uint32_t level) {
+    uint32_t oldClock = SystemCoreClock;
+    uint32_t hclk = clockFullHz >> level;
+    uint32_t wait = (hclk - 1) / TCLOCK_HZ_PER_WAIT;
+    uint32_t cfgr = RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1);
+    uint64_t now = tTimeGetTicks64();
+    tClockNotifier * notifier;
+
+    if (level < clockLevel) {
+        // 升频：先增加等待周期，先改APB1再改AHB，PCLK1在切换过程中不超过允许的最高频率
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | wait;
+        while ((FLASH->ACR & FLASH_ACR_LATENCY) != wait) {
+        }
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_PPRE1) | (clockCfgr[level] & RCC_CFGR_PPRE1);
+        RCC->CFGR = cfgr | clockCfgr[level];
+    } else {
+        // 降频：顺序相反，分频生效后再减少等待周期
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_HPRE) | (clockCfgr[level] & RCC_CFGR_HPRE);
+        RCC->CFGR = cfgr | clockCfgr[level];
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | wait;
+    }
+    SystemCoreClock = hclk;
+
+    tSysTickRescale(oldClock);
+#if TINYOS_ENABLE_HRTIMER == 1
+    tHrTimerClockChanged();
+#endif
+#if TINYOS_ENABLE_PC_SAMPLE == 1
+    tPcSampleClockChanged();
+#endif
+    for (notifier = clockNotifierList; notifier != (tClockNotifier *)0; notifier = notifier->next) {
+        notifier->func(hclk, notifier->arg);
+    }
+
+    clockTicks[clockLevel] += now - clockLevelStart;
+    clockLevelStart = now;
+    clockLevel = level;
+    clockSwitchCount++;
+}
+
+//全速请求优先于调频策略，驱动暂停期间推迟到解除时，需在临界区内调用
+static void tClockApply(void) {
+    uint32_t level = (clockBoost > 0) ? 0 : clockGovernorLevel;
+
+    if (level == clockLevel) {
+        return;
+    }
+    if (clockHold > 0) {
+        clockDeferCount++;
+        return;
+    }
+    tClockSwitch(level);
+}
+
+/**
+ * @brief 请求以第0级全速运行，可多次请求，由tClockBoostClear逐次解除；可在中断中调用。
+ *
+ * 请求立即生效，驱动暂停调频时推迟到暂停解除。
+ *
+ * @return void
+ */
+void tClockBoostSet(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    clockBoost++;
+    tClockApply();
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 解除一次tClockBoostSet的请求，全部解除后由调频策略决定频率。
+ *
+ * @return void
+ */
+void tClockBoostClear(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (clockBoost > 0) {
+        clockBoost--;
+    }
+    tClockApply();
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 暂停调频，可多次暂停，由tClockHoldClear逐次解除；可在中断中调用。
+ *
+ * 驱动在改变时钟会破坏的传输期间调用，例如串口DMA发送期间波特率不能改变。
+ *
+ * @return void
+ */
+void tClockHoldSet(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    clockHold++;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 解除一次tClockHoldSet的暂停，全部解除时执行推迟的调频。
+ *
+ * @return void
+ */
+void tClockHoldClear(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (clockHold > 0) {
+        clockHold--;
+        if (clockHold == 0) {
+            tClockApply();
+        }
+    }
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 调频策略，由内核每秒统计CPU利用率后在节拍中断中调用。
+ *
+ * 利用率高于TINYOS_CLOCK_UP_USAGE时立即回到第0级；连续TINYOS_CLOCK_DOWN_SECS秒低于TINYOS_CLOCK_DOWN_USAGE时降一级，
+ * 降低后的利用率按新频率重新统计，两个阈值之间保持不变。调频发生在统计周期的边界，下一个周期的利用率不受影响。
+ *
+ * @param usage 最近1s的CPU利用率(%)
+ *
+ * @return void
+ */
+void tClockGovernor(float usage) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (usage > TINYOS_CLOCK_UP_USAGE) {
+        clockGovernorLevel = 0;
+        clockLowSecs = 0;
+    } else if ((usage < TINYOS_CLOCK_DOWN_USAGE) && (clockGovernorLevel < TINYOS_CLOCK_LEVEL_MIN)) {
+        if (++clockLowSecs >= TINYOS_CLOCK_DOWN_SECS) {
+            clockGovernorLevel++;
+            clockLowSecs = 0;
+        }
+    } else {
+        clockLowSecs = 0;
+    }
+    tClockApply();
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 获取APB1定时器的时钟频率，APB1分频不为1时为PCLK1的两倍；按本模块的分频各级均等于HCLK。
+ *
+ * @return uint32_t 定时器时钟(Hz)
+ */
+uint32_t tClockTimerFreq(void) {
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clk *= 2;
+    }
+    return clk;
+}
+
+/**
+ * @brief 获取调频的统计
+ *
+ * @param stat 统计结果
+ *
+ * @return void
+ */
+void tClockGetStat(tClockStat * stat) {
+    uint32_t level;
+    uint64_t now = tTimeGetTicks64();
+    uint32_t status = tTaskEnterCritical();
+
+    stat->hclk = SystemCoreClock;
+    stat->level = clockLevel;
+    stat->switchCount = clockSwitchCount;
+    stat->deferCount = clockDeferCount;
+    stat->boost = clockBoost;
+    stat->hold = clockHold;
+    for (level = 0; level < TINYOS_CLOCK_LEVEL_COUNT; level++) {
+        stat->ticks[level] = clockTicks[level];
+    }
+    stat->ticks[clockLevel] += now - clockLevelStart;
+    tTaskExitCritical(status);
+}
+#endif
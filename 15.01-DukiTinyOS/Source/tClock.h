@@ -0,0 +1,48 @@
+#ifndef __TCLOCK_H
+#define __TCLOCK_H
+#include <stdint.h>
+
+// 动态调频：PLL保持启动时的配置，按CPU利用率改变AHB及APB1分频，负载低时逐级降低HCLK，高时直接回到启动频率。
+//   第0级：HCLK = 启动频率，APB1二分频；第1级：HCLK减半，APB1不分频，PCLK1与第0级相同，I2C不受影响；
+//   第2级：HCLK为四分之一，PCLK1减半，I2C的SCL随之减半(时序仍满足要求，传输变慢)
+// 各级的定时器时钟均等于HCLK，APB2不分频，USART1的PCLK2也等于HCLK。
+// 调频在临界区内完成：调整Flash等待周期及分频、更新SystemCoreClock，按比例换算SysTick本周期的剩余计数(节拍相位不变)，
+// 重设TIM5的预分频，再依次调用驱动登记的通知，由驱动重新计算波特率、PWM及输入捕获的预分频，通知中只能写寄存器。
+// 内核每秒统计CPU利用率后调用调频策略；驱动在不能改变时钟的传输期间用tClockHoldSet推迟调频(如串口DMA发送)，
+// 需要全速运行时用tClockBoostSet(如电机解锁期间)；
+// 需开启TINYOS_ENABLE_CPUUSAGE_STATE，只支持STM32F4，启动时HCLK需等于SYSCLK且APB1二分频
+#define TINYOS_CLOCK_LEVEL_MIN      1       // 允许降到的最低一级，0 ~ 2，为0时只统计不调频
+#define TINYOS_CLOCK_UP_USAGE       70      // CPU利用率(%)高于该值时立即回到第0级
+#define TINYOS_CLOCK_DOWN_USAGE     30      // 连续TINYOS_CLOCK_DOWN_SECS秒低于该值时降一级，降频后利用率约加倍，需小于TINYOS_CLOCK_UP_USAGE的一半
+#define TINYOS_CLOCK_DOWN_SECS      3
+#define TINYOS_CLOCK_LEVEL_COUNT    (TINYOS_CLOCK_LEVEL_MIN + 1)
+
+// 时钟改变的通知，hclk为新的HCLK(Hz)，在临界区内调用
+typedef void (*tClockNotifyFunc)(uint32_t hclk, void * arg);
+
+typedef struct _tClockNotifier {
+	struct _tClockNotifier * next;
+	tClockNotifyFunc func;
+	void * arg;
+}tClockNotifier;
+
+typedef struct _tClockStat {
+	uint32_t hclk;                                  //当前的HCLK(Hz)
+	uint32_t level;                                 //当前等级，0为启动频率
+	uint32_t switchCount;                           //调频次数
+	uint32_t deferCount;                            //因驱动暂停调频而推迟的次数
+	uint32_t boost;                                 //当前的全速请求数
+	uint32_t hold;                                  //当前的暂停请求数
+	uint64_t ticks[TINYOS_CLOCK_LEVEL_COUNT];       //各等级运行的节拍数
+}tClockStat;
+
+void tClockInit(void);
+void tClockNotifierAdd(tClockNotifier * notifier, tClockNotifyFunc func, void * arg);
+void tClockBoostSet(void);
+void tClockBoostClear(void);
+void tClockHoldSet(void);
+void tClockHoldClear(void);
+void tClockGovernor(float usage);
+uint32_t tClockTimerFreq(void);
+void tClockGetStat(tClockStat * stat);
+#endif
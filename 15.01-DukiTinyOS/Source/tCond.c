@@ -0,0 +1,148 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_COND == 1
+/**
+ * @brief 初始化条件变量。
+ * 
+ * @param cond      指向条件变量的指针。
+ * 
+ * @return void
+ */
+void tCondInit(tCond * cond) {
+    tEventInit(&cond->event, tEventTypeCond);
+    tRegistryAdd(&cond->event.object, tObjectTypeEvent);
+}
+
+/**
+ * @brief 释放互斥量并等待条件变量，返回时重新持有互斥量。
+ * 
+ * 释放互斥量与进入等待在同一临界区内完成，其间发出的通知不会丢失；嵌套锁定的次数在返回时恢复。
+ * 
+ * @param cond       指向条件变量的指针。
+ * @param mutex      当前任务持有的互斥量。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待，超时后同样重新获取互斥量再返回。
+ * 
+ * @return uint32_t  `tErrorNoError`表示被通知，`tErrorTimeOut`表示超时，`tErrorOwner`表示当前任务不持有互斥量，
+ *                   `tErrorDel`表示条件变量或互斥量被删除，互斥量被删除时返回后不持有互斥量。
+ */
+uint32_t tCondWait(tCond * cond, tMutex * mutex, uint32_t waitTicks) {
+    uint32_t err, lockedCount;
+    uint32_t status = tTaskEnterCritical();
+
+    if (mutex->owner != curTask) {
+        tTaskExitCritical(status);
+        return tErrorOwner;
+    }
+
+    // 完全释放互斥量，由等待互斥量的任务接手
+    lockedCount = mutex->lockedCount;
+    mutex->lockedCount = 1;
+    tMutexNotify(mutex);
+
+    // eventMsg记录对应的互斥量，通知时据此把任务转过去
+    tEventWait(&cond->event, curTask, (void *)mutex, tEventTypeCond, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    err = curTask->waitEventResult;
+    if ((err == tErrorTimeOut) || ((err == tErrorDel) && (curTask->eventMsg == (void *)cond))) {
+        // 超时或条件变量被删除，仍需重新获取互斥量
+        if (tMutexWait(mutex, 0) != tErrorNoError) {
+            return tErrorDel;
+        }
+    } else if (err != tErrorNoError) {
+        // 转入互斥量后互斥量被删除
+        return err;
+    }
+
+    status = tTaskEnterCritical();
+    mutex->lockedCount = lockedCount;
+    tTaskExitCritical(status);
+    return err;
+}
+
+//通知一个等待者，需在临界区内调用
+static uint32_t tCondWakeOne(tCond * cond) {
+    tNode * node = tListFirst(&cond->event.waitList);
+    tTask * task = tNodeParent(node, tTask, linkNode);
+    return tMutexRequeueTask((tMutex *)task->eventMsg, task);
+}
+
+/**
+ * @brief 通知一个等待者。
+ * 
+ * 等待者对应的互斥量空闲时直接获得互斥量并就绪，否则转入互斥量的等待队列。
+ * 
+ * @param cond      指向条件变量的指针。
+ * 
+ * @return void
+ */
+void tCondSignal(tCond * cond) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    if (tEventWaitCount(&cond->event) > 0) {
+        sched = tCondWakeOne(cond);
+    }
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 通知所有等待者。
+ * 
+ * 最多只有一个等待者因互斥量空闲而就绪，其余全部转入互斥量的等待队列，依次获得互斥量。
+ * 
+ * @param cond      指向条件变量的指针。
+ * 
+ * @return void
+ */
+void tCondBroadcast(tCond * cond) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    while (tEventWaitCount(&cond->event) > 0) {
+        sched |= tCondWakeOne(cond);
+    }
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 获取条件变量的状态信息。
+ * 
+ * @param cond      指向条件变量的指针。
+ * @param info      用于存放条件变量信息的结构体指针。
+ * 
+ * @return void
+ */
+void tCondGetInfo(tCond * cond, tCondInfo * info) {
+    info->taskCount = tEventWaitCount(&cond->event);
+}
+
+/**
+ * @brief 删除条件变量，唤醒所有等待者，等待者重新获取互斥量后返回`tErrorDel`。
+ * 
+ * @param cond      指向条件变量的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tCondDestroy(tCond * cond) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&cond->event, (void *)cond, tErrorDel);
+    tRegistryRemove(&cond->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef __TCOND_H
+#define __TCOND_H
+#include "tMutex.h"
+
+// 条件变量，等待者阻塞前释放互斥量，被唤醒时已重新持有互斥量
+// 唤醒时等待者直接转入互斥量的等待队列，不会一次性全部就绪后再争抢互斥量
+typedef struct _tCond {
+	tEvent event;
+}tCond;
+
+typedef struct _tCondInfo {
+	uint32_t taskCount;
+}tCondInfo;
+
+void tCondInit(tCond * cond);
+uint32_t tCondWait(tCond * cond, tMutex * mutex, uint32_t waitTicks);
+void tCondSignal(tCond * cond);
+void tCondBroadcast(tCond * cond);
+void tCondGetInfo(tCond * cond, tCondInfo * info);
+uint32_t tCondDestroy(tCond * cond);
+#endif
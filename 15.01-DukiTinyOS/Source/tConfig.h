@@ -1,23 +1,163 @@
 #ifndef __TCONFIG_H
 #define __TCONFIG_H
 
-#define TINYOS_PRIO_COUNT 32
+#define TINYOS_PORT_CORE  4           //处理器内核：0 Cortex-M0/M0+，3 Cortex-M3，4 Cortex-M4F，7 Cortex-M7，工程中编译对应的Port/ARM_CMx/tPortCpu.c
+#define TINYOS_PORT_DEVICE_HEADER "stm32f4xx.h"  //芯片的CMSIS设备头文件
+#define TINYOS_FAST_CODE_SECTION  ".ramfunc"     //TINYOS_FAST_CODE标记的内核热点函数所在段，链接时放到ITCM或片内SRAM
+#define TINYOS_FAST_DATA_SECTION  ".dtcm"        //TINYOS_FAST_DATA标记的调度器热点数据所在段，M7上放到DTCM
+#define TINYOS_CACHE_LINE_SIZE    32             //数据缓存行字节数
+#define TINYOS_PRIO_COUNT 32          //优先级数量，超过32时自动启用两级位图，最多1024
+#define TINYOS_BITMAP_USE_CLZ 1       //1:使用tPortCtz查找最高优先级（M3/M4/M7为CLZ/RBIT指令），0:查表法（M0上更快）
 #define TINYOS_SLICE_MAX  10
-#define TINYOS_IDLETASK_STACK_SIZE 1024
+#define TINYOS_EDF_PRIO   2           //使用最早截止时间优先(EDF)调度的优先级，该优先级的任务不做时间片轮转
+#define TINYOS_IDLETASK_STACK_SIZE 512      //空闲任务栈(字)，tTaskInit的栈大小参数均为字节数
+#define TINYOS_BOOTTASK_STACK_SIZE 1024     //启动任务栈(字)，运行tInitApp，完成后删除
 
-#define TINYOS_TIMERTASK_STACK_SIZE 1024
+#define TINYOS_MUTEX_CHAIN_MAX      8       //互斥量优先级继承沿阻塞链传递的最大层数
+#define TINYOS_MUTEX_ALERT_PRIO     2       //优先级数值不大于该值的任务在互斥量上等待超过TINYOS_MUTEX_ALERT_US时告警
+#define TINYOS_MUTEX_ALERT_US       500
+
+#define TINYOS_TIMERTASK_STACK_SIZE 1024    //定时器任务栈(字)
 #define TINYOS_TIMERTASK_PRIO       1
+#define TINYOS_TIMER_POOL_SIZE      0       //tTimerCreateOneShot使用的定时器池容量，为0时不提供
+
+#define TINYOS_JOBTASK_STACK_SIZE   1024    //所有作业共用的分派任务栈(字)
+#define TINYOS_COHOST_STACK_SIZE    512     //运行所有协程的宿主任务栈(字)
+#define TINYOS_COHOST_PRIO          (TINYOS_PRIO_COUNT - 2)
+
+#define TINYOS_WORKQ_SIZE           16      //系统工作队列的槽位数，必须为2的幂
+#define TINYOS_WORKQ_STACK_SIZE     512     //系统工作任务栈(字)
+#define TINYOS_WORKQ_PRIO           2
+
+#define TINYOS_CYCLIC_STACK_SIZE    512     //循环执行表的执行任务栈(字)
+#define TINYOS_CYCLIC_PRIO          0       //执行任务的优先级，应高于所有普通任务
+
+#define TINYOS_SHELL_STACK_SIZE     512     //串口命令任务栈(字)
+#define TINYOS_SHELL_PRIO           (TINYOS_PRIO_COUNT - 2)
+#define TINYOS_SHELL_LINE_MAX       32      //一行命令的最大字节数(含结束符)
+
+#define TINYOS_LOG_LEVEL            1       //编译进固件的最低日志级别：0 debug，1 info，2 warn，3 error
+#define TINYOS_LOG_BUFFER_SIZE      128     //日志缓冲区可容纳的记录数(每条28字节)，必须为2的幂
+#define TINYOS_LOG_STACK_SIZE       512     //日志任务栈(字)
+#define TINYOS_LOG_PRIO             (TINYOS_PRIO_COUNT - 2)
+#define TINYOS_LOG_PERIOD_TICKS     10      //日志任务输出缓冲区的周期
+#define TINYOS_LOG_OUTPUT_RAW       0       //1:日志任务原样输出二进制记录，由Tools/tlogdecode.py结合axf文件解码，2:原样写入RTT日志通道(需开启RTT)，0:在目标上格式化后printf
 
 #define TINYOS_SYSTICK_MS           10
 
+//临界区实现：1使用BASEPRI，只屏蔽优先级数值>=TINYOS_MAX_SYSCALL_PRIO的中断；0使用PRIMASK屏蔽所有中断(M0没有BASEPRI，只能为0)
+//优先级数值小于TINYOS_MAX_SYSCALL_PRIO的中断不会被内核延迟，但不允许调用任何内核API
+#define TINYOS_CRITICAL_USE_BASEPRI 1
+#define TINYOS_MAX_SYSCALL_PRIO     5       //NVIC抢占优先级(0~15)
+#define TINYOS_TICKLESS_MIN_TICKS   2       //预计空闲节拍数不小于该值时才进入低功耗休眠
+#define TINYOS_TRACE_BUFFER_SIZE    256     //跟踪缓冲区可容纳的记录数，必须为2的幂
+#define TINYOS_RTT_CONSOLE_SIZE     1024    //RTT上行通道0(控制台：printf及命令行输出)的字节数
+#define TINYOS_RTT_LOG_SIZE         1024    //RTT上行通道1(二进制日志记录)的字节数
+#define TINYOS_RTT_TRACE_SIZE       1024    //RTT上行通道2(内核跟踪记录)的字节数
+#define TINYOS_RTT_DOWN_SIZE        32      //RTT下行通道0(命令行输入)的字节数
+#define TINYOS_RTT_POLL_TICKS       5       //命令任务轮询RTT下行通道的节拍间隔，调试器写入时没有中断
+#define TINYOS_CRIT_PROFILE_SITES   8       //临界区统计保留的调用位置数
+#define TINYOS_IRQ_STAT_COUNT       101     //中断统计表的项数，按异常号索引，STM32F401为16个系统异常加85个外设中断
+#define TINYOS_IRQ_STAT_DEPTH       8       //中断统计跟踪的嵌套层数，更深的嵌套计入第TINYOS_IRQ_STAT_DEPTH层
+#define TINYOS_PC_SAMPLE_HZ         997     //PC采样频率，取与控制回路频率不成整数倍的值，每次另加随机抖动
+#define TINYOS_PC_SAMPLE_BASE       0x08000000  //直方图覆盖的起始地址(Flash)
+#define TINYOS_PC_SAMPLE_SHIFT      6       //每组覆盖2^TINYOS_PC_SAMPLE_SHIFT字节的代码
+#define TINYOS_PC_SAMPLE_BUCKETS    2048    //直方图组数，每组4字节RAM，覆盖TINYOS_PC_SAMPLE_BUCKETS << TINYOS_PC_SAMPLE_SHIFT字节
+#define TINYOS_PC_SAMPLE_IRQ_PRIO   1       //TIM2中断的抢占优先级，须高于TINYOS_MAX_SYSCALL_PRIO(数值更小)，临界区及其它中断中也能采样
+#define TINYOS_HEAP_FL_INDEX_MAX    17      //堆中单个块最大为2^17 = 128KB
+#define TINYOS_SLAB_CLASS_MAX       5       //分级分配器最多包含的存储池级数
+#define TINYOS_MEMBLOCK_USE_LIFO    1       //1:存储池空闲块用后进先出的单向链表，0:先进先出的tList
+#define TINYOS_MEMBLOCK_DEBUG       0       //1:存储池空闲块填充固定值，分配时检查以发现释放后使用
+#define TINYOS_TASK_POOL_COUNT      4       //tTaskCreate可同时存在的任务数
+#define TINYOS_TASK_POOL_SMALL_STACK 512    //任务池小规格栈的字节数
+#define TINYOS_TASK_POOL_SMALL_COUNT 2
+#define TINYOS_TASK_POOL_LARGE_STACK 2048   //任务池大规格栈的字节数
+#define TINYOS_TASK_POOL_LARGE_COUNT 2
+#define TINYOS_EVENT_MULTI_MAX      4       //tEventWaitMulti一次最多等待的对象数
+#define TINYOS_PRIO_QUEUE_LEVELS    8       //优先级消息队列的优先级数，最多32
+#define TINYOS_STACK_MONITOR_CHUNK  32      //栈水位监视每次扫描的字数
+#define TINYOS_BUDGET_BG_PRIO       (TINYOS_PRIO_COUNT - 2) //运行预算用完的任务降到的优先级
+#define TINYOS_STACK_CANARY_WORDS   4       //栈底保留的保护字数，切换时检查
+#define TINYOS_BENCH_SAMPLES        1000    //基准测试每一项的样本数
+#define TINYOS_IPC_MSG_SLOTS        16      //处理器间通道每个方向的消息队列槽位数，必须为2的幂
+#define TINYOS_IPC_BYTE_SIZE        1024    //处理器间通道每个方向的字节队列字节数，必须为2的幂
+
 //裁剪部分，利用条件编译 1为开启功能
 #define TINYOS_ENABLE_SEM            0
 #define TINYOS_ENABLE_MUTEX          0
+#define TINYOS_ENABLE_MUTEX_STAT     0       //按互斥量统计锁定次数、竞争次数、持有及等待时长、优先级继承的时长(DWT)，高优先级任务等待过久时调用tHooksMutexWait，需开启MUTEX
 #define TINYOS_ENABLE_FLAGGROUP      0
 #define TINYOS_ENABLE_MBOX           0
+#define TINYOS_ENABLE_MBOX_LATEST    0       //邮箱的最新值模式(tMboxInitLatest)，发送总是覆盖唯一的消息，读取不取走，需开启MBOX
 #define TINYOS_ENABLE_MEMBLOCK       0
+#define TINYOS_ENABLE_COND           0       //与互斥量配合使用的条件变量，需开启MUTEX
+#define TINYOS_ENABLE_BARRIER        0       //计数屏障，多个任务每轮同步放行
+#define TINYOS_ENABLE_TOPIC          0       //发布/订阅主题，双缓冲发布，订阅者按代数判断新数据，读端无锁
+#define TINYOS_ENABLE_RWLOCK         0       //读写锁，写者优先，需开启MUTEX
+#define TINYOS_ENABLE_HEAP           0       //TLSF可变长度堆
+#define TINYOS_ENABLE_SLAB           0       //基于多个存储池的分级分配器，无锁分配，需开启MEMBLOCK
+#define TINYOS_ENABLE_MSGQUEUE       0       //带引用计数的零拷贝消息队列，需开启MBOX及MEMBLOCK
+#define TINYOS_ENABLE_QUEUE          0       //按值复制的定长消息队列
+#define TINYOS_ENABLE_PRIO_QUEUE     0       //按优先级投递的消息队列，每级一个子环形缓冲区，位图查找最高的非空级
+#define TINYOS_ENABLE_MSG_CALL       0       //同步消息调用(tMsgCall/tMsgReceive/tMsgReply)，服务者在回复前继承客户的优先级，需开启MUTEX
+#define TINYOS_ENABLE_STREAM         0       //带触发字节数的阻塞式字节流缓冲区
+#define TINYOS_ENABLE_RINGBUF        0       //无锁单生产者/单消费者字节环形缓冲区，通知功能需开启NOTIFY
+#define TINYOS_ENABLE_IPC            0       //处理器间通道，共享内存中的环形队列加门铃中断，接收端转入本地的邮箱及字节流，需开启MBOX及STREAM
 #define TINYOS_ENABLE_TIMER          0
-#define TINYOS_ENABLE_CPUUSAGE_STATE 0
-#define TINYOS_ENABLE_HOOKS          0
+#define TINYOS_ENABLE_JOB            0       //运行至完成的作业，共用一个栈
+#define TINYOS_ENABLE_COROUTINE      0       //无栈协程，所有协程在一个宿主任务中轮流运行
+#define TINYOS_ENABLE_WORKQUEUE      0       //中断中提交、工作任务中执行的延后工作队列，需开启SEM
+#define TINYOS_ENABLE_HRTIMER        0       //基于TIM5的微秒级高精度定时器，回调在中断中执行
+#define TINYOS_ENABLE_CYCLIC         0       //时间触发的循环执行表，主帧/小帧内固定偏移执行，需开启HRTIMER，任务方式需开启NOTIFY
+#define TINYOS_ENABLE_PARTITION      0       //时间分区，优先级划分给分区，主帧内按窗口只调度当前分区的任务，需开启HRTIMER
+#define TINYOS_ENABLE_NOTIFY         0       //任务通知
+#define TINYOS_ENABLE_IRQ_THREAD     0       //中断线程，中断直接唤醒绑定的任务并与下一任务比较优先级，驱动下半部在任务中执行
+#define TINYOS_ENABLE_TASK_POOL      0       //从静态任务池动态创建/删除任务，删除后回收TCB及栈
+#define TINYOS_ENABLE_PREEMPT_THRESHOLD 0    //任务抢占阈值，运行中的任务只能被优先级高于其阈值的任务抢占
+#define TINYOS_ENABLE_BUDGET         0       //按周期补充的任务运行预算，用完后降到后台优先级
+#define TINYOS_ENABLE_SUPERVISOR     0       //周期任务截止时间及看门狗监督，需以tTaskDelayUntil实现周期
+#define TINYOS_ENABLE_EDF            0       //在TINYOS_EDF_PRIO优先级内按截止时间调度
+#define TINYOS_ENABLE_EVENT_MULTI    0       //任务同时等待多个信号量/邮箱/存储池/事件标志组(tEventWaitMulti)
+#define TINYOS_ENABLE_EVENT_PRIO_WAIT 0      //事件等待队列按优先级排序(默认先来先服务)，每个事件多占用TINYOS_PRIO_COUNT个指针
+#define TINYOS_ENABLE_CPUUSAGE_STATE 0       //按任务统计运行周期数(DWT)，并由空闲任务的运行时间得出CPU利用率
+#define TINYOS_ENABLE_HOOKS          0       //把tHooks.c中的应用钩子登记到各钩子点，其它模块按各自的开关登记，用户模块用TINYOS_HOOKS_USER_xxx登记(见tHooks.h)
+#define TINYOS_ENABLE_SLICE          1       //同优先级任务间的时间片轮转，0时同优先级任务运行到阻塞或让出为止，tTask不含时间片字段，节拍中断不做轮转
+#define TINYOS_ENABLE_SUSPEND        1       //tTaskSuspend/tTaskWakeUp及任务的挂起计数
+#define TINYOS_ENABLE_TASK_GROUP     0       //任务组，在一个临界区内挂起、恢复或通知多个任务并只调度一次，需开启SUSPEND
+#define TINYOS_ENABLE_TASK_DELETE    1       //tTaskForceDelete、tTaskDeleteSelf、请求删除及删除时的清理回调
+#define TINYOS_ENABLE_TASK_INFO      1       //tTaskGetInfo
+#define TINYOS_ENABLE_PERIOD_STAT    1       //tTaskDelayUntil统计错过释放时刻的次数及最大释放延迟
+#define TINYOS_ENABLE_WAIT_STAT      0       //按阻塞原因(对象类型、延时、挂起等)统计各任务的阻塞时间，开启REGISTRY时同时按对象统计
+#define TINYOS_ENABLE_IDLE_JOB       0       //空闲任务中轮流执行的后台作业
+#define TINYOS_ENABLE_STACK_FILL     0       //tTaskInit填充整个任务栈，tTaskGetInfo据此统计剩余空间；0时只在需要时填充栈底保护字
+#define TINYOS_ENABLE_STACK_MONITOR  0       //空闲任务分段扫描各任务栈的水位，tTaskGetInfo直接读取结果
+#define TINYOS_ENABLE_STACK_CHECK    0       //PendSV切出任务时检查栈指针及栈底保护字，溢出时调用tTaskStackOverflow
+#define TINYOS_ENABLE_STACK_GUARD    0       //用MPU区域7将切入任务的栈底32字节设为禁止访问，溢出立即触发MemManage
+#define TINYOS_ENABLE_USER_MODE      0       //tTaskSetUserMode指定的任务以非特权方式运行，MPU限制其只能访问自己的栈及指定的数据区，经SVC系统调用使用内核
+#define TINYOS_ENABLE_TICKLESS       0
+#define TINYOS_ENABLE_POWER          0       //低功耗管理，按下一个到期时间及驱动约束在低功耗空闲与STOP模式间选择，RTC唤醒并补偿节拍，需开启TICKLESS
+#define TINYOS_ENABLE_CLOCK_SCALE    0       //按CPU利用率动态降低HCLK，驱动可请求全速或暂停调频，SysTick、TIM5及登记通知的外设随之换算，需开启CPUUSAGE_STATE
+#define TINYOS_ENABLE_TICK_SWITCH    0       //tSetSysTickPeriod可在运行中把SysTick周期改为TINYOS_SYSTICK_MS的整数倍，每次中断推进相应的节拍数，节拍单位不变
+#define TINYOS_ENABLE_TICK_OVERRUN   0       //SysTick中断按DWT周期计数检查是否因屏蔽中断过久丢失了节拍，丢失的节拍一次补上并计数
+#define TINYOS_ENABLE_PROFILING      0       //DWT周期计数统计调度、切换及节拍中断的耗时
+#define TINYOS_ENABLE_CRIT_PROFILE   0       //统计每次屏蔽中断的时长，按进入临界区的调用位置保留最长的TINYOS_CRIT_PROFILE_SITES处
+#define TINYOS_ENABLE_IRQ_STAT       0       //按异常号统计各中断的执行次数及周期数(不含嵌套其中的中断)，任务运行时间及CPU利用率中扣除中断时间
+#define TINYOS_ENABLE_PC_SAMPLE      0       //统计采样剖析，TIM2中断按TINYOS_PC_SAMPLE_HZ记录被打断处的PC，按地址分组计数，由Tools/pcprofile.py结合axf或map文件还原为函数
+#define TINYOS_ENABLE_TRACE          0       //内核事件跟踪缓冲区
+#define TINYOS_ENABLE_RTT            0       //SEGGER RTT：RAM中的环形缓冲区由调试器经SWD后台读写，控制台、日志、跟踪及命令行不占用串口
+#define TINYOS_ENABLE_LIST_INLINE    1       //链表操作使用tListInline.h中的内联实现，0为tList.c中的函数调用
+#define TINYOS_ENABLE_FAST_SECTIONS  0       //内核热点函数及数据放入TINYOS_FAST_CODE_SECTION/TINYOS_FAST_DATA_SECTION段，需在分散加载文件中定义对应的执行域(MDK-ARM/QuadrotorAircraft.sct已按本选项放到SRAM)
+#define TINYOS_ENABLE_DMABUF         0       //数据缓存一致的DMA缓冲区池，基于存储池，需开启MEMBLOCK
+#define TINYOS_ENABLE_REGISTRY       0       //任务、内核对象及定时器初始化时登记到对象表，并统计事件类对象的等待/唤醒/超时次数
+#define TINYOS_ENABLE_STATIC_OBJECT  0       //TINYOS_SEM_DEFINE等宏在编译时定义已初始化的内核对象，TINYOS_TASK_DEFINE定义的任务在tTinyOSStart时自动创建
+#define TINYOS_ENABLE_LOG            0       //延后格式化的二进制日志，记录格式串地址及原始参数，由日志任务或主机格式化
+#define TINYOS_ENABLE_SHELL          0       //串口调试命令行，列出登记的对象及其统计，需开启REGISTRY及SEM
+#define TINYOS_ENABLE_ATOMIC_FASTPATH 0      //无竞争的信号量获取/释放及互斥量加锁/解锁用LDREX/STREX完成，不关中断，需要阻塞或唤醒时才进入临界区
+#define TINYOS_ENABLE_ISR_READY_QUEUE 0      //中断中发送任务通知不关中断，唤醒的任务用LDREX/STREX压入待就绪链表，由PendSV加入就绪表后调度，需开启NOTIFY
+#define TINYOS_ENABLE_BENCHMARK      0       //以Benchmarks中的内核基准测试代替app.c的演示任务：1为rhealstone.c，需开启SEM、MBOX、MUTEX及MEMBLOCK，节拍开销一项需开启PROFILING；2为KernelCompare.c，与各章节快照对比的跨版本测试，只测开启的对象；3为StressBench.c，逐级提高的中断风暴下周期任务的释放延迟、节拍漂移及队列溢出，需开启SEM、MBOX及FLAGGROUP
+#define TINYOS_ENABLE_FLIGHT         0       //以Attitude/FlightPipeline.c中的多速率飞控任务链代替app.c的演示任务，需开启SEM、NOTIFY、TIMER、TOPIC及MPU6050_USE_HW_I2C或MPU6050_USE_SPI，不能与BENCHMARK同时开启
+
+//选项之间的依赖检查
+#include "tConfigCheck.h"
 #endif
 
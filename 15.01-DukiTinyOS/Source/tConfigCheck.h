@@ -0,0 +1,135 @@
+#ifndef __TCONFIGCHECK_H
+#define __TCONFIGCHECK_H
+
+// tConfig.h选项之间的依赖检查，由tConfig.h在末尾包含，不合法的组合在编译时报错；
+// 只与单个模块有关的取值检查(缓冲区大小为2的幂等)仍放在各模块中
+
+// 内核对象之间的依赖
+#if (TINYOS_ENABLE_TIMER == 1) && (TINYOS_ENABLE_SEM == 0)
+#error "TINYOS_ENABLE_TIMER requires TINYOS_ENABLE_SEM"
+#endif
+#if (TINYOS_ENABLE_COND == 1) && (TINYOS_ENABLE_MUTEX == 0)
+#error "TINYOS_ENABLE_COND requires TINYOS_ENABLE_MUTEX"
+#endif
+#if (TINYOS_ENABLE_RWLOCK == 1) && (TINYOS_ENABLE_MUTEX == 0)
+#error "TINYOS_ENABLE_RWLOCK requires TINYOS_ENABLE_MUTEX"
+#endif
+#if (TINYOS_ENABLE_MSG_CALL == 1) && (TINYOS_ENABLE_MUTEX == 0)
+#error "TINYOS_ENABLE_MSG_CALL requires TINYOS_ENABLE_MUTEX"
+#endif
+#if (TINYOS_ENABLE_MUTEX_STAT == 1) && (TINYOS_ENABLE_MUTEX == 0)
+#error "TINYOS_ENABLE_MUTEX_STAT requires TINYOS_ENABLE_MUTEX"
+#endif
+#if (TINYOS_ENABLE_SLAB == 1) && (TINYOS_ENABLE_MEMBLOCK == 0)
+#error "TINYOS_ENABLE_SLAB requires TINYOS_ENABLE_MEMBLOCK"
+#endif
+#if (TINYOS_ENABLE_DMABUF == 1) && (TINYOS_ENABLE_MEMBLOCK == 0)
+#error "TINYOS_ENABLE_DMABUF requires TINYOS_ENABLE_MEMBLOCK"
+#endif
+#if (TINYOS_ENABLE_MBOX_LATEST == 1) && (TINYOS_ENABLE_MBOX == 0)
+#error "TINYOS_ENABLE_MBOX_LATEST requires TINYOS_ENABLE_MBOX"
+#endif
+#if (TINYOS_ENABLE_MSGQUEUE == 1) && ((TINYOS_ENABLE_MBOX == 0) || (TINYOS_ENABLE_MEMBLOCK == 0))
+#error "TINYOS_ENABLE_MSGQUEUE requires TINYOS_ENABLE_MBOX and TINYOS_ENABLE_MEMBLOCK"
+#endif
+#if (TINYOS_ENABLE_IPC == 1) && ((TINYOS_ENABLE_MBOX == 0) || (TINYOS_ENABLE_STREAM == 0))
+#error "TINYOS_ENABLE_IPC requires TINYOS_ENABLE_MBOX and TINYOS_ENABLE_STREAM"
+#endif
+#if (TINYOS_ENABLE_CYCLIC == 1) && (TINYOS_ENABLE_HRTIMER == 0)
+#error "TINYOS_ENABLE_CYCLIC requires TINYOS_ENABLE_HRTIMER"
+#endif
+#if (TINYOS_ENABLE_PARTITION == 1) && (TINYOS_ENABLE_HRTIMER == 0)
+#error "TINYOS_ENABLE_PARTITION requires TINYOS_ENABLE_HRTIMER"
+#endif
+#if (TINYOS_ENABLE_PRIO_QUEUE == 1) && ((TINYOS_PRIO_QUEUE_LEVELS < 1) || (TINYOS_PRIO_QUEUE_LEVELS > 32))
+#error "TINYOS_PRIO_QUEUE_LEVELS must be between 1 and 32"
+#endif
+#if (TINYOS_ENABLE_WORKQUEUE == 1) && (TINYOS_ENABLE_SEM == 0)
+#error "TINYOS_ENABLE_WORKQUEUE requires TINYOS_ENABLE_SEM"
+#endif
+
+#if (TINYOS_ENABLE_ISR_READY_QUEUE == 1) && (TINYOS_ENABLE_NOTIFY == 0)
+#error "TINYOS_ENABLE_ISR_READY_QUEUE requires TINYOS_ENABLE_NOTIFY"
+#endif
+
+// 任务功能之间的依赖
+#if (TINYOS_ENABLE_TASK_POOL == 1) && (TINYOS_ENABLE_TASK_DELETE == 0)
+#error "TINYOS_ENABLE_TASK_POOL requires TINYOS_ENABLE_TASK_DELETE"
+#endif
+#if (TINYOS_ENABLE_TICKLESS == 1) && (TINYOS_ENABLE_CPUUSAGE_STATE == 1)
+//WFI休眠期间内核时钟停止，CYCCNT不计数，空闲任务的运行时间无法统计
+#error "TINYOS_ENABLE_TICKLESS can not be used with TINYOS_ENABLE_CPUUSAGE_STATE"
+#endif
+
+#if (TINYOS_ENABLE_POWER == 1) && (TINYOS_ENABLE_TICKLESS == 0)
+#error "TINYOS_ENABLE_POWER requires TINYOS_ENABLE_TICKLESS"
+#endif
+#if (TINYOS_ENABLE_POWER == 1) && defined(TINYOS_PORT_POSIX)
+#error "TINYOS_ENABLE_POWER is not supported by the POSIX port"
+#endif
+
+#if (TINYOS_ENABLE_USER_MODE == 1) && (TINYOS_ENABLE_TASK_DELETE == 0)
+//越权访问的非特权任务由MemManage删除
+#error "TINYOS_ENABLE_USER_MODE requires TINYOS_ENABLE_TASK_DELETE"
+#endif
+#if (TINYOS_ENABLE_USER_MODE == 1) && defined(TINYOS_PORT_POSIX)
+#error "TINYOS_ENABLE_USER_MODE is not supported by the POSIX port"
+#endif
+
+#if (TINYOS_ENABLE_CLOCK_SCALE == 1) && (TINYOS_ENABLE_CPUUSAGE_STATE == 0)
+#error "TINYOS_ENABLE_CLOCK_SCALE requires TINYOS_ENABLE_CPUUSAGE_STATE"
+#endif
+#if (TINYOS_ENABLE_CLOCK_SCALE == 1) && defined(TINYOS_PORT_POSIX)
+#error "TINYOS_ENABLE_CLOCK_SCALE is not supported by the POSIX port"
+#endif
+
+#if (TINYOS_ENABLE_TICK_SWITCH == 1) && (TINYOS_ENABLE_TICKLESS == 1)
+//两者都要重新装载SysTick，低功耗休眠按一个节拍一个SysTick周期计算
+#error "TINYOS_ENABLE_TICK_SWITCH can not be used with TINYOS_ENABLE_TICKLESS"
+#endif
+#if (TINYOS_ENABLE_TICK_OVERRUN == 1) && (TINYOS_ENABLE_TICKLESS == 1)
+//同上，WFI休眠期间CYCCNT不计数，无法与SysTick的节拍边界比较
+#error "TINYOS_ENABLE_TICK_OVERRUN can not be used with TINYOS_ENABLE_TICKLESS"
+#endif
+
+// 调试工具及应用的依赖
+#if (TINYOS_ENABLE_TRACE == 1) && defined(TINYOS_PORT_POSIX)
+//跟踪记录经ITM激励端口(SWO)直接写寄存器输出，主机上没有ITM
+#error "TINYOS_ENABLE_TRACE is not supported by the POSIX port"
+#endif
+#if (TINYOS_ENABLE_PC_SAMPLE == 1) && defined(TINYOS_PORT_POSIX)
+#error "TINYOS_ENABLE_PC_SAMPLE is not supported by the POSIX port"
+#endif
+#if (TINYOS_ENABLE_PC_SAMPLE == 1) && (TINYOS_PC_SAMPLE_IRQ_PRIO >= TINYOS_MAX_SYSCALL_PRIO)
+//采样中断被临界区屏蔽时只能在临界区结束处采样，临界区内的代码永远不会出现在剖析结果中
+#error "TINYOS_PC_SAMPLE_IRQ_PRIO must be above TINYOS_MAX_SYSCALL_PRIO"
+#endif
+#if (TINYOS_ENABLE_LOG == 1) && (TINYOS_LOG_OUTPUT_RAW == 2) && (TINYOS_ENABLE_RTT == 0)
+#error "TINYOS_LOG_OUTPUT_RAW 2 requires TINYOS_ENABLE_RTT"
+#endif
+#if (TINYOS_ENABLE_SHELL == 1) && ((TINYOS_ENABLE_REGISTRY == 0) || (TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_TASK_INFO == 0))
+#error "TINYOS_ENABLE_SHELL requires TINYOS_ENABLE_REGISTRY, TINYOS_ENABLE_SEM and TINYOS_ENABLE_TASK_INFO"
+#endif
+#if (TINYOS_ENABLE_BENCHMARK == 1) && ((TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_MBOX == 0) || (TINYOS_ENABLE_MUTEX == 0) \
+    || (TINYOS_ENABLE_MEMBLOCK == 0) || (TINYOS_ENABLE_SUSPEND == 0))
+#error "TINYOS_ENABLE_BENCHMARK requires TINYOS_ENABLE_SEM, MBOX, MUTEX, MEMBLOCK and SUSPEND"
+#endif
+#if (TINYOS_ENABLE_BENCHMARK == 3) && ((TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_MBOX == 0) || (TINYOS_ENABLE_FLAGGROUP == 0))
+#error "TINYOS_ENABLE_BENCHMARK 3 (StressBench.c) requires TINYOS_ENABLE_SEM, MBOX and FLAGGROUP"
+#endif
+#if TINYOS_ENABLE_BENCHMARK > 3
+#error "TINYOS_ENABLE_BENCHMARK must be 0, 1 (rhealstone.c), 2 (KernelCompare.c) or 3 (StressBench.c)"
+#endif
+#if (TINYOS_ENABLE_FLIGHT == 1) && ((TINYOS_ENABLE_SEM == 0) || (TINYOS_ENABLE_NOTIFY == 0) || (TINYOS_ENABLE_TIMER == 0) \
+    || (TINYOS_ENABLE_TOPIC == 0))
+#error "TINYOS_ENABLE_FLIGHT requires TINYOS_ENABLE_SEM, NOTIFY, TIMER and TOPIC"
+#endif
+#if (TINYOS_ENABLE_TASK_GROUP == 1) && (TINYOS_ENABLE_SUSPEND == 0)
+#error "TINYOS_ENABLE_TASK_GROUP requires TINYOS_ENABLE_SUSPEND"
+#endif
+#if (TINYOS_ENABLE_TASK_DELETE == 0) && (TINYOS_ENABLE_SUSPEND == 0) && !defined(TINYOS_PORT_POSIX)
+//Core/Src/main.c的启动任务完成后删除或挂起自身
+#error "the boot task requires TINYOS_ENABLE_TASK_DELETE or TINYOS_ENABLE_SUSPEND"
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_COROUTINE == 1
+static tTask tCoHostTask;
+static tTaskStack tCoHostTaskStack[TINYOS_COHOST_STACK_SIZE];
+//新启动的协程先放入该队列，由宿主任务取走，避免在临界区外遍历运行队列时被修改
+static tList tCoPendingList;
+//只由宿主任务访问
+static tList tCoRunList;
+
+/**
+ * @brief 启动协程，协程函数将在宿主任务中从头开始执行，可在任务中调用。
+ * 
+ * @param co        指向协程的指针，协程结束前不能重复启动。
+ * @param func      协程函数，用tCoBegin/tCoEnd包裹函数体。
+ * @param arg       协程函数可通过co->arg取得的参数。
+ * 
+ * @return void
+ */
+void tCoroutineStart(tCoroutine * co, tCoroutineFunc func, void * arg) {
+    uint32_t status;
+
+    tNodeInit(&co->node);
+    co->func = func;
+    co->arg = arg;
+    co->lc = 0;
+    co->waitTick = 0;
+
+    status = tTaskEnterCritical();
+    tListAddLast(&tCoPendingList, &co->node);
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 查询协程是否尚未结束。
+ * 
+ * @param co        指向协程的指针。
+ * 
+ * @return 1表示仍在运行，0表示已结束
+ */
+uint32_t tCoroutineIsRunning(tCoroutine * co) {
+    return co->func != (tCoroutineFunc)0;
+}
+
+//宿主任务：每轮依次调用所有协程，一轮中没有协程取得进展时延时一个节拍，等待条件因此以节拍为粒度轮询
+static void tCoHostTaskEntry(void * param) {
+    for (;;) {
+        uint32_t i;
+        uint32_t count;
+        uint32_t progress = 0;
+        tNode * node;
+        uint32_t status = tTaskEnterCritical();
+
+        while (tListCount(&tCoPendingList) > 0) {
+            tListAddLast(&tCoRunList, tListRemoveFirst(&tCoPendingList));
+        }
+        tTaskExitCritical(status);
+
+        count = tListCount(&tCoRunList);
+        node = tListFirst(&tCoRunList);
+        for (i = 0; i < count; i++) {
+            tCoroutine * co = tNodeParent(node, tCoroutine, node);
+            uint32_t result;
+
+            node = tListNext(&tCoRunList, node);
+            result = co->func(co);
+            if (result == TCO_ENDED) {
+                tListRemove(&tCoRunList, &co->node);
+                co->func = (tCoroutineFunc)0;
+            }
+            if (result != TCO_WAITING) {
+                progress = 1;
+            }
+        }
+
+        if (!progress) {
+            tTaskDelay(1);
+        }
+    }
+}
+
+/**
+ * @brief 初始化协程模块并创建宿主任务，在空闲任务中与tTimerInitTask一同调用。
+ * 
+ * @return void
+ */
+void tCoroutineInitTask(void) {
+    tListInit(&tCoPendingList);
+    tListInit(&tCoRunList);
+    tTaskInit(&tCoHostTask, tCoHostTaskEntry, (void *)0, TINYOS_COHOST_PRIO, tCoHostTaskStack, sizeof(tCoHostTaskStack));
+}
+#endif
@@ -0,0 +1,42 @@
+#ifndef __TCOROUTINE_H
+#define __TCOROUTINE_H
+
+#include "tLib.h"
+
+// 无栈协程：协程函数每次被调用时从上次让出的位置继续执行，所有协程由宿主任务在同一个栈上轮流调用
+// 让出点之间不保留局部变量，需要跨让出点的状态应放在包含tCoroutine的结构体中；
+// 由于用__LINE__记录继续执行的位置，同一行只能写一个让出/等待宏，让出宏也不能放在协程函数内的switch中
+struct _tCoroutine;
+typedef uint32_t (*tCoroutineFunc) (struct _tCoroutine * co);
+
+typedef struct _tCoroutine {
+	tNode node;
+	tCoroutineFunc func;
+	void * arg;
+	uint32_t lc;                     //继续执行的位置(行号)，0表示从头开始
+	uint32_t waitTick;               //tCoDelay的到期节拍
+}tCoroutine;
+
+// 协程函数的返回值
+#define TCO_WAITING                 0       //等待条件满足
+#define TCO_YIELDED                 1       //主动让出，宿主下一轮继续调用
+#define TCO_ENDED                   2       //执行完毕，宿主将其移除
+
+#define tCoBegin(co)                switch ((co)->lc) { case 0:
+#define tCoEnd(co)                  } (co)->lc = 0; return TCO_ENDED
+
+#define tCoYield(co)                do { (co)->lc = __LINE__; return TCO_YIELDED; case __LINE__:; } while (0)
+#define tCoAwait(co, cond)          do { (co)->lc = __LINE__; case __LINE__: if (!(cond)) { return TCO_WAITING; } } while (0)
+
+// 等待指定的节拍数
+#define tCoDelay(co, ticks)         do { (co)->waitTick = tTaskTickGet() + (ticks); \
+                                         tCoAwait(co, (int32_t)(tTaskTickGet() - (co)->waitTick) >= 0); } while (0)
+
+// 等待内核对象，条件满足时已取得资源
+#define tCoAwaitSem(co, sem)        tCoAwait(co, tSemNoWaitGet(sem) == tErrorNoError)
+#define tCoAwaitMbox(co, mbox, msg) tCoAwait(co, tMboxNoWaitGet(mbox, msg) == tErrorNoError)
+
+void tCoroutineStart(tCoroutine * co, tCoroutineFunc func, void * arg);
+uint32_t tCoroutineIsRunning(tCoroutine * co);
+void tCoroutineInitTask(void);
+#endif
@@ -1,5 +1,34 @@
 #include "tinyOS.h"
-#include "stm32f4xx.h"
+#include "tPort.h"
+
+// 各Cortex-M内核共用的移植部分：SysTick节拍、DWT周期计数、MPU栈保护及空闲休眠
+
+#if TINYOS_ENABLE_STACK_GUARD == 1
+//开启MPU及MemManage异常，未被区域覆盖的地址按默认存储映射访问，保护区由PendSV每次切换时设置
+void tStackGuardInit(void) {
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    __DSB();
+    __ISB();
+}
+#endif
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+static volatile uint32_t tickStepPending;   // 待切换的节拍步长，0表示没有，由下一个SysTick中断切换
+#define TICK_STEP           tTaskTickStepGet()
+#else
+#define TICK_STEP           1
+#endif
+
+// 一个内核节拍的CPU周期数
+#define TICK_UNIT_CYCLES    (SystemCoreClock / 1000 * TINYOS_SYSTICK_MS)
+
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+static uint32_t tickBoundary;       // 上一次处理的SysTick重装载时刻(CYCCNT)
+static uint32_t tickBoundaryValid;  // 0：重新装载后的第一次中断只记录时刻，不检查
+static uint32_t tickOverrunCount;   // 发生节拍中断丢失的次数
+static uint32_t tickMissedTicks;    // 累计补上的节拍数
+#endif
 
 /**
  * @brief 定时器初始化函数，设置定时器每隔指定毫秒触发一次中断。
@@ -10,11 +39,16 @@
  * 
  * @return void
  */
-void tSetSysTickPeriod(uint32_t ms) {
+static void tSysTickReload(uint32_t ms) {
     // 计算定时器加载值，确保定时器每隔指定毫秒触发一次中断
     // SystemCoreClock = 12000000 表示系统时钟频率为12 MHz
     // SysTick->LOAD 寄存器控制定时器的计数值，LOAD值 = ms * (SystemCoreClock / 1000) - 1
     SysTick->LOAD = ms * SystemCoreClock / 1000 - 1;
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    // 周期或CPU时钟改变，下一次中断重新对齐
+    tCycleCounterInit();
+    tickBoundaryValid = 0;
+#endif
 
     // 设置SysTick中断的优先级。此处设置为最低优先级
     NVIC_SetPriority(SysTick_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
@@ -28,6 +62,220 @@ void tSetSysTickPeriod(uint32_t ms) {
                     SysTick_CTRL_ENABLE_Msk;     // 启用SysTick定时器
 }
 
+/**
+ * @brief 设置SysTick中断周期
+ * 
+ * 开启TINYOS_ENABLE_TICK_SWITCH时，周期取整为TINYOS_SYSTICK_MS的整数倍(不超过24位SysTick的范围)，
+ * 每次中断推进相应的节拍数，节拍单位不变，已有的延时、超时及定时器无需换算。
+ * 调度器运行中调用时在下一个节拍边界切换，调用处可在任务或中断中。
+ * 
+ * @param ms 中断周期，单位为毫秒
+ * 
+ * @return void
+ */
+void tSetSysTickPeriod(uint32_t ms) {
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    uint32_t step = ms / TINYOS_SYSTICK_MS;
+    uint32_t maxStep = (SysTick_LOAD_RELOAD_Msk + 1) / TICK_UNIT_CYCLES;
+
+    if (step == 0) {
+        step = 1;
+    } else if (step > maxStep) {
+        step = maxStep;
+    }
+    if ((curTask != (tTask *)0) && (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+        tickStepPending = step;
+        return;
+    }
+    tTaskTickStepSet(step);
+    uwTickFreq = (HAL_TickFreqTypeDef)(step * TINYOS_SYSTICK_MS);
+    ms = step * TINYOS_SYSTICK_MS;
+#endif
+    tSysTickReload(ms);
+}
+
+#if TINYOS_ENABLE_POWER == 1
+/**
+ * @brief STOP唤醒并恢复系统时钟后，按当前的节拍步长重新装载SysTick
+ * 
+ * @return void
+ */
+void tSysTickRestart(void) {
+    tSysTickReload(TICK_STEP * TINYOS_SYSTICK_MS);
+}
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+/**
+ * @brief HCLK改变后按新的SystemCoreClock重新装载SysTick，在调频的临界区内调用
+ * 
+ * 本周期剩余的计数按新旧频率之比换算，作为一次性的装载值让计数器从该值继续，随后恢复完整周期，
+ * 下一次中断仍在原来的节拍边界，节拍不因调频而提前或推迟。
+ * 
+ * @param oldClock 调频前的SystemCoreClock
+ * 
+ * @return void
+ */
+void tSysTickRescale(uint32_t oldClock) {
+    uint32_t remain = (uint32_t)((uint64_t)SysTick->VAL * SystemCoreClock / oldClock);
+
+    if (remain == 0) {
+        remain = 1;
+    }
+    // 写VAL清零计数器，下一个时钟从LOAD装载剩余计数；装载之后LOAD即可改回完整周期，计到0时按完整周期重装
+    SysTick->LOAD = remain;
+    SysTick->VAL = 0;
+    __DSB();
+    SysTick->LOAD = TICK_STEP * TINYOS_SYSTICK_MS * (SystemCoreClock / 1000) - 1;
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    // CPU时钟改变，下一次中断重新对齐
+    tickBoundaryValid = 0;
+#endif
+}
+#endif
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+/**
+ * @brief 在节拍中断中按新的步长重新装载SysTick
+ * 
+ * 进入中断时SysTick已按原周期重装载，从LOAD中扣除至今已过的计数后清零VAL，
+ * 新周期从本节拍的边界算起，tTimeGetMicros不会跳变
+ * 
+ * @param step 新的节拍步长
+ * 
+ * @return void
+ */
+static void tSysTickSwitch(uint32_t step) {
+    uint32_t reload = step * TICK_UNIT_CYCLES;
+    uint32_t elapsed = SysTick->LOAD - SysTick->VAL;
+
+    SysTick->LOAD = reload - 1 - elapsed;
+    // 写VAL清零且不产生中断，下一个计数时钟从LOAD重装载，之后的周期按完整的reload计数
+    SysTick->VAL = 0;
+    __DSB();
+    SysTick->LOAD = reload - 1;
+}
+#endif
+
+/**
+ * @brief 获取从指定节拍的起点到现在经过的CPU周期数，需在临界区内调用
+ * 
+ * SysTick向下计数，每个节拍开始时从LOAD重装载，LOAD - VAL即为本节拍已经经过的周期数。
+ * 
+ * @param tick 起始节拍，不应早于当前节拍太多，以免结果溢出
+ * 
+ * @return uint32_t 经过的周期数
+ */
+uint32_t tSysTickCyclesSince(uint32_t tick) {
+    return (tTaskTickGet() - tick) * TICK_UNIT_CYCLES + (SysTick->LOAD - SysTick->VAL);
+}
+
+/**
+ * @brief 获取系统启动以来的微秒数
+ * 
+ * 由64位节拍计数加上本节拍内已经过的SysTick计数得到，分辨率为1us。
+ * SysTick的VAL始终是距下一个节拍边界的剩余计数(低功耗休眠唤醒后的第一个不完整节拍也是如此)，
+ * 因此按标称的节拍周期计算。若SysTick已重装载而节拍中断尚未处理，补上这一个节拍。
+ * SysTick周期为多个节拍时，本周期内已经过的部分同样按计数换算，不受节拍步长影响。
+ * 
+ * @return uint64_t 微秒数
+ */
+uint64_t tTimeGetMicros(void) {
+    uint64_t ticks;
+    uint32_t val;
+    uint32_t tickCycles;
+    uint32_t status = tTaskEnterCritical();
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    tickCycles = SysTick->LOAD + 1;
+#else
+    tickCycles = TICK_UNIT_CYCLES;
+#endif
+    ticks = tTimeGetTicks64();
+    val = SysTick->VAL;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        // 重读VAL，保证读到的是重装载之后的值
+        val = SysTick->VAL;
+        ticks += TICK_STEP;
+    }
+    tTaskExitCritical(status);
+
+    if (val >= tickCycles) {
+        val = tickCycles - 1;
+    }
+    return ticks * (TINYOS_SYSTICK_MS * 1000) + (tickCycles - 1 - val) / (SystemCoreClock / 1000000);
+}
+
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+/**
+ * @brief 检查上一次节拍中断至今丢失的SysTick中断数
+ * 
+ * SysTick与CYCCNT同为CPU时钟计数，CYCCNT减去本周期已经过的计数(LOAD - VAL)即为最近一次重装载的时刻，
+ * 与上一次处理的重装载时刻相隔的周期数减1即为丢失的中断数：屏蔽中断或更高优先级的中断超过一个周期时，
+ * 挂起的SysTick只会响应一次。相隔的周期数四舍五入，记录的时刻按整周期推进，不累积响应延迟的抖动。
+ * 切换节拍步长时新周期从本次的重装载时刻算起，因此需在tSysTickSwitch之前调用。
+ * 
+ * @return uint32_t 丢失的中断数，每个中断为TICK_STEP个节拍
+ */
+static uint32_t tSysTickMissed(void) {
+    uint32_t period = SysTick->LOAD + 1;
+    uint32_t boundary = tCycleCounterGet() - (SysTick->LOAD - SysTick->VAL);
+    uint32_t periods;
+
+    if (!tickBoundaryValid) {
+        tickBoundary = boundary;
+        tickBoundaryValid = 1;
+        return 0;
+    }
+    periods = (boundary - tickBoundary + period / 2) / period;
+    tickBoundary += periods * period;
+    return (periods > 1) ? periods - 1 : 0;
+}
+
+/**
+ * @brief 一次补上丢失的节拍：HAL计时逐个周期推进，内核节拍、延时及超时队列合并为一次推进
+ * 
+ * @param missed 丢失的中断数
+ * 
+ * @return void
+ */
+static void tSysTickOverrun(uint32_t missed) {
+    uint32_t i;
+    uint32_t status;
+    uint32_t ticks = missed * TICK_STEP;
+
+    tickOverrunCount++;
+    tickMissedTicks += ticks;
+    for (i = 0; i < missed; i++) {
+        HAL_IncTick();
+    }
+    if (curTask != (tTask *)0) {
+        status = tTaskEnterCritical();
+        tTaskSystemTickCatchUp(ticks);
+        tTaskExitCritical(status);
+    }
+}
+
+/**
+ * @brief 读取节拍中断丢失的统计
+ * 
+ * @param missedTicks 不为0时返回累计补上的节拍数
+ * 
+ * @return uint32_t 发生丢失的次数
+ */
+uint32_t tTaskTickOverrunGet(uint32_t * missedTicks) {
+    uint32_t count;
+    uint32_t status = tTaskEnterCritical();
+
+    count = tickOverrunCount;
+    if (missedTicks != (uint32_t *)0) {
+        *missedTicks = tickMissedTicks;
+    }
+    tTaskExitCritical(status);
+    return count;
+}
+#endif
+
 /**
  * @brief SysTick中断处理函数
  * 
@@ -35,7 +283,297 @@ void tSetSysTickPeriod(uint32_t ms) {
  * 
  * @return void
  */
-void SysTick_Handler(void) {
+TINYOS_FAST_CODE void SysTick_Handler(void) {
+    tIrqStatEnter();
+#if TINYOS_ENABLE_PROFILING == 1
+    // SysTick向下计数，到期重装载后已经过的计数即为中断响应延迟
+    uint32_t profileStart = tCycleCounterGet();
+    tProfileRecord(tProfilePathSysTickLatency, SysTick->LOAD - SysTick->VAL);
+#endif
+    tTraceRecord(tTraceEventIsrEnter, 0, SysTick_IRQn + 16);
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    uint32_t missed = tSysTickMissed();
+#endif
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    uint32_t step = tickStepPending;
+
+    if (step != 0) {
+        tickStepPending = 0;
+        tSysTickSwitch(step);
+    }
+#endif
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    // 丢失的节拍按原步长补上，本节拍的延时到期等照常由下面的节拍处理完成并调度
+    if (missed != 0) {
+        tSysTickOverrun(missed);
+    }
+#endif
 	  HAL_IncTick();
-    tTaskSystemTickHandler();  // 调用任务调度处理函数，执行时间片轮转等操作
+    // 调度器启动前(main中初始化外设期间)只为HAL计时
+    if (curTask != (tTask *)0) {
+        tTaskSystemTickHandler();  // 调用任务调度处理函数，执行时间片轮转等操作
+    }
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+    // 刚结束的周期按原步长推进，此后按新步长
+    if (step != 0) {
+        tTaskTickStepSet(step);
+        uwTickFreq = (HAL_TickFreqTypeDef)(step * TINYOS_SYSTICK_MS);
+    }
+#endif
+    tTraceRecord(tTraceEventIsrExit, 0, SysTick_IRQn + 16);
+#if TINYOS_ENABLE_PROFILING == 1
+    tProfileRecord(tProfilePathSysTick, tCycleCounterGet() - profileStart);
+#endif
+    tIrqStatExit();
+}
+
+// HAL时基：SysTick按内核节拍TINYOS_SYSTICK_MS运行，HAL_IncTick每个节拍把uwTick加TINYOS_SYSTICK_MS，
+// HAL_GetTick再补上本节拍内已经过的毫秒数，调度器启动前后都以1ms为单位计时；
+// SysTick周期为多个节拍时uwTickFreq随之修改，每次中断加一个完整的周期
+
+/**
+ * @brief 配置SysTick，代替HAL库按1ms配置的弱定义
+ * 
+ * HAL_Init及每次修改系统时钟(HAL_RCC_ClockConfig)时调用，按新的SystemCoreClock重新装载内核节拍。
+ * 
+ * @param TickPriority SysTick中断优先级
+ * 
+ * @return HAL_StatusTypeDef HAL_OK
+ */
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority) {
+    // 修改系统时钟时立即按当前的节拍步长重新装载
+    tSysTickReload(TICK_STEP * TINYOS_SYSTICK_MS);
+    if (TickPriority < (1UL << __NVIC_PRIO_BITS)) {
+        NVIC_SetPriority(SysTick_IRQn, TickPriority);
+        uwTickPrio = TickPriority;
+    }
+    uwTickFreq = (HAL_TickFreqTypeDef)(TICK_STEP * TINYOS_SYSTICK_MS);
+    return HAL_OK;
+}
+
+/**
+ * @brief 读取启动以来的毫秒数，分辨率1ms
+ * 
+ * @return uint32_t 毫秒数
+ */
+uint32_t HAL_GetTick(void) {
+    uint32_t tick, val, ms, period;
+    uint32_t status = tTaskEnterCritical();
+
+    period = (uint32_t)uwTickFreq;
+    tick = uwTick;
+    val = SysTick->VAL;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        // 已重装载而中断尚未处理，补上这一个节拍
+        val = SysTick->VAL;
+        tick += period;
+    }
+    ms = (SysTick->LOAD - val) / (SystemCoreClock / 1000);
+    tTaskExitCritical(status);
+    // 低功耗休眠中LOAD被临时加长，节拍内的部分不超过一个标称节拍
+    return tick + ((ms < period) ? ms : (period - 1));
+}
+
+/**
+ * @brief 延时至少Delay毫秒
+ * 
+ * 在任务中且调度器运行、未关调度时按节拍阻塞，让出CPU，最后不足一个节拍的部分按HAL_GetTick等待；
+ * 调度器启动前及中断中仍忙等。
+ * 
+ * @param Delay 毫秒数
+ * 
+ * @return void
+ */
+void HAL_Delay(uint32_t Delay) {
+    uint32_t start = HAL_GetTick();
+
+    if ((curTask != (tTask *)0) && (__get_IPSR() == 0) && (schedLockCounter == 0)) {
+        // 当前节拍已经过了一部分，多等一个节拍，剩余的忙等通常为0
+        tTaskDelay(Delay / TINYOS_SYSTICK_MS + 1);
+    }
+    while ((HAL_GetTick() - start) < Delay) {
+    }
+}
+
+/**
+ * @brief 启动DWT周期计数器，作为性能统计与任务运行时间统计的自由运行时基
+ * 
+ * 启动耗时及控制回路延迟等板级统计也使用，不随内核统计选项裁剪；可在调度器启动前调用
+ * 
+ * @return void
+ */
+void tCycleCounterInit(void) {
+    if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+        return;
+    }
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief 获取当前的CPU周期计数，32位计数器回绕后差值仍然正确
+ * 
+ * @return 当前的CYCCNT值
+ */
+uint32_t tCycleCounterGet(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief 忙等指定的CPU周期数，用于比1us更细的时序
+ * 
+ * 以CYCCNT计时，被中断或抢占时只会延长；单次不超过2^32个周期，84MHz下约51s
+ * 
+ * @param cycles 等待的CPU周期数
+ * @return void
+ */
+void tDelayCycles(uint32_t cycles) {
+    uint32_t start;
+
+    tCycleCounterInit();
+    start = DWT->CYCCNT;
+    while ((DWT->CYCCNT - start) < cycles) {
+    }
+}
+
+/**
+ * @brief 微秒延时，按SystemCoreClock换算为CPU周期
+ * 
+ * 不足两个SysTick周期时忙等，精度为几个周期；更长时若在调度器运行的任务中，先阻塞整节拍数减一个周期，
+ * 让出CPU，剩余的不足两个节拍再按tTimeGetMicros忙等到期，提前唤醒不会缩短延时。
+ * 中断服务、调度器锁定或启动前调用时全程忙等
+ * 
+ * @param us 延时的微秒数
+ * @return void
+ */
+void tDelayUs(uint32_t us) {
+    uint64_t start;
+    uint32_t ticks = us / (TINYOS_SYSTICK_MS * 1000);
+    uint32_t step = TICK_STEP;
+
+    if ((ticks >= 2 * step) && (curTask != (tTask *)0) && (__get_IPSR() == 0) && (schedLockCounter == 0)) {
+        start = tTimeGetMicros();
+        // 节拍按整个SysTick周期推进，少阻塞一个周期，保证在到期前醒来
+        tTaskDelay(ticks - step);
+        while ((tTimeGetMicros() - start) < us) {
+        }
+        return;
+    }
+
+    // CYCCNT约51s回绕一次，更长的分段等待
+    while (us > 0) {
+        uint32_t part = (us > 10000000) ? 10000000 : us;
+
+        tDelayCycles(part * (SystemCoreClock / 1000000));
+        us -= part;
+    }
+}
+
+#if TINYOS_ENABLE_TICKLESS == 1
+/**
+ * @brief 低功耗空闲处理，由空闲任务循环调用
+ * 
+ * 只有空闲任务就绪时，将SysTick重新装载为最近一个到期时间，执行WFI休眠。
+ * 唤醒后根据SysTick的计数值计算实际经过的节拍数，并补偿给内核。
+ * 若SysTick到期唤醒，最后一个节拍由挂起的SysTick中断正常处理。
+ * 
+ * @return void
+ */
+void tTicklessIdle(void) {
+    uint32_t tickCycles, sleepTicks, maxTicks, reload, ctrl, elapsed, i;
+    uint32_t status = tTaskEnterCritical();
+
+    sleepTicks = tTaskSleepTicksGet();
+    if (sleepTicks < TINYOS_TICKLESS_MIN_TICKS) {
+        tTaskExitCritical(status);
+        return;
+    }
+
+    // SysTick为24位计数器，限制最大休眠节拍数
+    tickCycles = SysTick->LOAD + 1;
+    maxTicks = SysTick_LOAD_RELOAD_Msk / tickCycles;
+    if (sleepTicks > maxTicks) {
+        sleepTicks = maxTicks;
+    }
+
+    // 停止SysTick，若此时节拍中断已挂起则放弃本次休眠
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        tTaskExitCritical(status);
+        return;
+    }
+
+    // 当前节拍剩余的计数 + 其余整节拍的计数
+    reload = SysTick->VAL + (sleepTicks - 1) * tickCycles;
+    SysTick->LOAD = reload;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    // PRIMASK置位时，中断挂起仍可唤醒WFI，但要等退出临界区后才会进入中断服务
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+    // BASEPRI屏蔽的中断不能唤醒WFI，休眠期间改用PRIMASK屏蔽
+    __disable_irq();
+    __set_BASEPRI(0);
+#endif
+    __DSB();
+    __WFI();
+    __ISB();
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+    __set_BASEPRI(TINYOS_MAX_SYSCALL_PRIO << (8 - __NVIC_PRIO_BITS));
+    __enable_irq();
+#endif
+
+    // 读CTRL会清除COUNTFLAG，只读一次
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk) {
+        // 休眠到期，SysTick中断已挂起，由它处理最后一个节拍
+        elapsed = sleepTicks - 1;
+        SysTick->LOAD = tickCycles - 1;
+        SysTick->VAL = 0;
+    } else {
+        // 被其它中断提前唤醒，按剩余计数得到已经经过的节拍，并使下一次中断对齐到原来的节拍边界
+        uint32_t val = SysTick->VAL;
+        if (val == 0) {
+            val = 1;
+        }
+        elapsed = tTicklessElapsedTicks(sleepTicks, tickCycles, val);
+        SysTick->LOAD = (val - 1) % tickCycles;
+        SysTick->VAL = 0;
+    }
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    // 写入后在下一次重装载时生效，不影响本次计数
+    SysTick->LOAD = tickCycles - 1;
+
+    for (i = 0; i < elapsed; i++) {
+        HAL_IncTick();
+    }
+    tTaskSystemTickCatchUp(elapsed);
+    tTaskExitCritical(status);
+
+    // 补偿过程中可能有任务就绪
+    tTaskSched();
+}
+#endif
+
+/**
+ * @brief 空闲任务每轮循环最后调用，没有其它工作时休眠等待中断
+ * 
+ * 开启低功耗管理时由tPowerIdle选择休眠模式；开启低功耗空闲时由tTicklessIdle停止节拍后休眠；
+ * 否则直接WFI，由下一个节拍或外设中断唤醒。
+ * 统计CPU利用率时WFI期间CYCCNT停止计数，空闲时间无法计入，此时不休眠。
+ * 
+ * @return void
+ */
+void tPortIdle(void) {
+#if TINYOS_ENABLE_POWER == 1
+    tPowerIdle();
+#elif TINYOS_ENABLE_TICKLESS == 1
+    tTicklessIdle();
+#elif TINYOS_ENABLE_CPUUSAGE_STATE == 0
+    __DSB();
+    __WFI();
+#endif
 }
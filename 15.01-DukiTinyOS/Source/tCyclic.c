@@ -0,0 +1,187 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_CYCLIC == 1
+
+static tHrTimer tCyclicTimer;
+static const tCyclicEntry * tCyclicTable;
+static uint32_t tCyclicCount;
+static uint32_t tCyclicMinorUs;
+static uint32_t tCyclicMajorUs;
+static uint32_t tCyclicMode;
+static uint32_t tCyclicFrameStart;          //当前主帧的起点(TIM5计数值)
+static uint32_t tCyclicNext;                //下一个到期的表项
+static tCyclicInfo tCyclicStat;
+
+#if TINYOS_ENABLE_NOTIFY == 1
+static tTask tCyclicTask;
+static tTaskStack tCyclicTaskStack[TINYOS_CYCLIC_STACK_SIZE];
+static uint32_t tCyclicTaskCreated;
+static volatile uint32_t tCyclicBusy;       //执行任务正在运行表项
+static const tCyclicEntry * tCyclicRunEntry; //交给执行任务的表项及其释放时刻
+static uint32_t tCyclicRunRelease;
+#endif
+
+//表项相对主帧起点的偏移
+static uint32_t tCyclicOffset(uint32_t index) {
+    return tCyclicTable[index].minor * tCyclicMinorUs + tCyclicTable[index].offsetUs;
+}
+
+//执行一个表项并更新延迟及执行时间统计
+static void tCyclicRun(const tCyclicEntry * entry, uint32_t release) {
+    uint32_t start = tHrTimerGetCounter();
+    uint32_t run;
+
+    if (start - release > tCyclicStat.maxLatencyUs) {
+        tCyclicStat.maxLatencyUs = start - release;
+    }
+    entry->func(entry->param);
+    run = tHrTimerGetCounter() - start;
+    if (run > tCyclicStat.maxRunUs) {
+        tCyclicStat.maxRunUs = run;
+    }
+}
+
+//按下一个表项的释放时刻装载定时器，释放时刻已过时立即触发
+static void tCyclicArm(void) {
+    int32_t delay = (int32_t)(tCyclicFrameStart + tCyclicOffset(tCyclicNext) - tHrTimerGetCounter());
+
+    if (delay <= 0) {
+        tCyclicStat.overruns++;
+        delay = 0;
+    }
+    tHrTimerStart(&tCyclicTimer, (uint32_t)delay, 0);
+}
+
+//TIM5中断中调用：执行或交出到期的表项，再装载下一项
+static void tCyclicTimerFunc(void * arg) {
+    uint32_t index = tCyclicNext;
+    uint32_t release = tCyclicFrameStart + tCyclicOffset(index);
+
+    (void)arg;
+    if (++tCyclicNext >= tCyclicCount) {
+        tCyclicNext = 0;
+        tCyclicFrameStart += tCyclicMajorUs;
+        tCyclicStat.frames++;
+    }
+
+#if TINYOS_ENABLE_NOTIFY == 1
+    if (tCyclicMode == TCYCLIC_MODE_TASK) {
+        if (tCyclicBusy) {
+            tCyclicStat.overruns++;
+        } else {
+            tCyclicRunEntry = &tCyclicTable[index];
+            tCyclicRunRelease = release;
+            tCyclicBusy = 1;
+            tTaskNotifyGiveFromISR(&tCyclicTask);
+        }
+    } else
+#endif
+    {
+        tCyclicRun(&tCyclicTable[index], release);
+    }
+
+    if (tCyclicTable != (const tCyclicEntry *)0) {
+        tCyclicArm();
+    }
+}
+
+#if TINYOS_ENABLE_NOTIFY == 1
+//执行任务：每收到一次通知运行中断交来的一个表项
+static void tCyclicTaskEntry(void * param) {
+    (void)param;
+    for (;;) {
+        tTaskNotifyTake(1, 0);
+        tCyclicRun(tCyclicRunEntry, tCyclicRunRelease);
+        tCyclicBusy = 0;
+    }
+}
+#endif
+
+/**
+ * @brief 开始按表执行，已在执行的表被替换
+ *
+ * @param table      表项，按(小帧, 偏移)从小到大排列，执行期间不能修改
+ * @param count      表项数
+ * @param minorUs    小帧长度(us)
+ * @param minorCount 一个主帧中的小帧数
+ * @param mode       TCYCLIC_MODE_ISR或TCYCLIC_MODE_TASK(需开启NOTIFY)
+ *
+ * @return uint32_t  tErrorNoError；表为空、未排序、偏移超出小帧或不支持的方式时返回tErrorResourceUnavaliable
+ */
+uint32_t tCyclicStart(const tCyclicEntry * table, uint32_t count, uint32_t minorUs, uint32_t minorCount, uint32_t mode) {
+    uint32_t status;
+    uint32_t i;
+
+    if ((count == 0) || (minorUs == 0) || (minorCount == 0)) {
+        return tErrorResourceUnavaliable;
+    }
+    for (i = 0; i < count; i++) {
+        if ((table[i].minor >= minorCount) || (table[i].offsetUs >= minorUs) || (table[i].func == 0)) {
+            return tErrorResourceUnavaliable;
+        }
+        if ((i > 0) && (table[i].minor * minorUs + table[i].offsetUs < table[i - 1].minor * minorUs + table[i - 1].offsetUs)) {
+            return tErrorResourceUnavaliable;
+        }
+    }
+#if TINYOS_ENABLE_NOTIFY == 1
+    if (mode == TCYCLIC_MODE_TASK) {
+        if (!tCyclicTaskCreated) {
+            tTaskInit(&tCyclicTask, tCyclicTaskEntry, (void *)0, TINYOS_CYCLIC_PRIO, tCyclicTaskStack, sizeof(tCyclicTaskStack));
+            tObjectSetName(&tCyclicTask.object, "cyclic");
+            tCyclicTaskCreated = 1;
+        }
+    } else
+#endif
+    if (mode != TCYCLIC_MODE_ISR) {
+        return tErrorResourceUnavaliable;
+    }
+
+    tCyclicStop();
+    status = tTaskEnterCritical();
+    tCyclicTable = table;
+    tCyclicCount = count;
+    tCyclicMinorUs = minorUs;
+    tCyclicMajorUs = minorUs * minorCount;
+    tCyclicMode = mode;
+    tCyclicNext = 0;
+    tCyclicStat.frames = 0;
+    tCyclicStat.overruns = 0;
+    tCyclicStat.maxLatencyUs = 0;
+    tCyclicStat.maxRunUs = 0;
+    // 第一个主帧从下一个小帧长度之后开始，留出启动的时间
+    tCyclicFrameStart = tHrTimerGetCounter() + minorUs;
+    tHrTimerInit(&tCyclicTimer, tCyclicTimerFunc, (void *)0);
+    tCyclicArm();
+    tTaskExitCritical(status);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 停止按表执行，执行任务中正在运行的表项会运行完
+ *
+ * @return void
+ */
+void tCyclicStop(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (tCyclicTable != (const tCyclicEntry *)0) {
+        tHrTimerStop(&tCyclicTimer);
+        tCyclicTable = (const tCyclicEntry *)0;
+    }
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 读取执行统计
+ *
+ * @param info 统计信息
+ *
+ * @return void
+ */
+void tCyclicGetInfo(tCyclicInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+    *info = tCyclicStat;
+    tTaskExitCritical(status);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __TCYCLIC_H
+#define __TCYCLIC_H
+
+#include <stdint.h>
+#include "tLib.h"
+
+// 时间触发的循环执行表：主帧分为minorCount个等长的小帧，表中每一项在所在小帧内的固定偏移处执行，
+// 主帧结束后从头重复。释放时刻由高精度定时器按主帧起点加偏移计算，不随执行时间漂移，
+// 表项之间及表执行完后的空闲时间由tTaskSched照常调度其它任务。
+// 两种执行方式：在TIM5中断中直接调用(只能使用FromISR结尾的API)，或由优先级为TINYOS_CYCLIC_PRIO的执行任务调用；
+// 执行任务仍在运行时到期的表项不执行，计为一次超时。需开启HRTIMER，任务方式还需开启NOTIFY
+#define TCYCLIC_MODE_ISR        0
+#define TCYCLIC_MODE_TASK       1
+
+typedef struct _tCyclicEntry {
+	uint32_t minor;                 //所在小帧，0 ~ minorCount - 1
+	uint32_t offsetUs;              //在小帧内的偏移，小于小帧长度
+	void (*func) (void * param);
+	void * param;
+}tCyclicEntry;
+
+typedef struct _tCyclicInfo {
+	uint32_t frames;                //已完成的主帧数
+	uint32_t overruns;              //释放时刻已过或执行任务仍忙而延后/跳过的次数
+	uint32_t maxLatencyUs;          //释放时刻到开始执行的最大延迟
+	uint32_t maxRunUs;              //单个表项的最长执行时间
+}tCyclicInfo;
+
+uint32_t tCyclicStart(const tCyclicEntry * table, uint32_t count, uint32_t minorUs, uint32_t minorCount, uint32_t mode);
+void tCyclicStop(void);
+void tCyclicGetInfo(tCyclicInfo * info);
+#endif
@@ -0,0 +1,97 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_DMABUF == 1
+
+/**
+ * @brief 初始化DMA缓冲区池
+ * 
+ * @param pool    缓冲区池
+ * @param mem     存储区，须按TINYOS_CACHE_LINE_SIZE对齐，大小为tDmaBufSize(bufSize) * bufCnt
+ * @param bufSize 每个缓冲区的字节数，按缓存行向上取整
+ * @param bufCnt  缓冲区个数
+ * 
+ * @return void
+ */
+void tDmaBufInit(tDmaBuf * pool, uint8_t * mem, uint32_t bufSize, uint32_t bufCnt) {
+	tMemBlockInit(&pool->memBlock, mem, tDmaBufSize(bufSize), bufCnt);
+}
+
+// 新取出的缓冲区内容无意义，直接作废整块，丢弃其中的脏缓存行
+static void tDmaBufTake(tDmaBuf * pool, uint8_t * buf) {
+	tPortDCacheInvalidate(buf, pool->memBlock.blockSize);
+}
+
+/**
+ * @brief 获取一个缓冲区，没有空闲缓冲区时等待
+ * 
+ * @param pool      缓冲区池
+ * @param buf       取得的缓冲区
+ * @param waitTicks 最长等待的节拍数，0为一直等待
+ * 
+ * @return uint32_t tErrorNoError，或等待失败的错误码
+ */
+uint32_t tDmaBufWait(tDmaBuf * pool, uint8_t ** buf, uint32_t waitTicks) {
+	uint32_t err = tMemBlockWait(&pool->memBlock, buf, waitTicks);
+	if (err == tErrorNoError) {
+		tDmaBufTake(pool, *buf);
+	}
+	return err;
+}
+
+/**
+ * @brief 获取一个缓冲区，不等待
+ * 
+ * @param pool 缓冲区池
+ * @param buf  取得的缓冲区
+ * 
+ * @return uint32_t tErrorNoError，没有空闲缓冲区时为tErrorResourceUnavaliable
+ */
+uint32_t tDmaBufNoWaitGet(tDmaBuf * pool, uint8_t ** buf) {
+	uint32_t err = tMemBlockNoWaitGet(&pool->memBlock, buf, 0);
+	if (err == tErrorNoError) {
+		tDmaBufTake(pool, *buf);
+	}
+	return err;
+}
+
+/**
+ * @brief 归还缓冲区，有任务等待时直接交给它，由等待的任务在tDmaBufWait返回前作废缓存
+ * 
+ * @param pool 缓冲区池
+ * @param buf  缓冲区
+ * 
+ * @return uint32_t 与tMemBlockNotify相同
+ */
+uint32_t tDmaBufNotify(tDmaBuf * pool, uint8_t * buf) {
+	return tMemBlockNotify(&pool->memBlock, buf);
+}
+
+uint32_t tDmaBufNotifyFromISR(tDmaBuf * pool, uint8_t * buf) {
+	return tMemBlockNotifyFromISR(&pool->memBlock, buf);
+}
+
+/**
+ * @brief 启动DMA发送前调用，将CPU写入的数据写回内存
+ * 
+ * @param buf  缓冲区
+ * @param size 待发送的字节数
+ * 
+ * @return void
+ */
+void tDmaBufPrepareTx(uint8_t * buf, uint32_t size) {
+	tPortDCacheClean(buf, size);
+}
+
+/**
+ * @brief DMA接收完成后调用，作废缓存使CPU读到DMA写入的数据
+ * 
+ * @param buf  缓冲区
+ * @param size 接收到的字节数
+ * 
+ * @return void
+ */
+void tDmaBufCompleteRx(uint8_t * buf, uint32_t size) {
+	tPortDCacheInvalidate(buf, size);
+}
+#endif
@@ -0,0 +1,24 @@
+#ifndef __TDMABUF_H
+#define __TDMABUF_H
+#include "tMemBlock.h"
+
+// 数据缓存一致的DMA缓冲区池
+// 在存储池之上保证每个缓冲区独占整数个缓存行：分配时作废整块缓存，存储池写在块首的链表指针等
+// 残留的脏数据不会在DMA传输期间被写回而覆盖接收到的数据；发送前清除、接收完成后作废实际使用的范围。
+// 缓冲区可以像普通存储块一样经由邮箱、消息队列在任务间传递，没有数据缓存的内核上维护操作为空
+typedef struct _tDmaBuf {
+	tMemBlock memBlock;
+}tDmaBuf;
+
+// 缓冲区大小向上取整到缓存行，存储区按此定义并用TINYOS_CACHE_ALIGNED对齐：
+//   TINYOS_CACHE_ALIGNED uint8_t rxMem[4][tDmaBufSize(100)];
+#define tDmaBufSize(size)   (((size) + TINYOS_CACHE_LINE_SIZE - 1) & ~(TINYOS_CACHE_LINE_SIZE - 1))
+
+void tDmaBufInit(tDmaBuf * pool, uint8_t * mem, uint32_t bufSize, uint32_t bufCnt);
+uint32_t tDmaBufWait(tDmaBuf * pool, uint8_t ** buf, uint32_t waitTicks);
+uint32_t tDmaBufNoWaitGet(tDmaBuf * pool, uint8_t ** buf);
+uint32_t tDmaBufNotify(tDmaBuf * pool, uint8_t * buf);
+uint32_t tDmaBufNotifyFromISR(tDmaBuf * pool, uint8_t * buf);
+void tDmaBufPrepareTx(uint8_t * buf, uint32_t size);
+void tDmaBufCompleteRx(uint8_t * buf, uint32_t size);
+#endif
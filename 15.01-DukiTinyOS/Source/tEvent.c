@@ -1,5 +1,11 @@
 #include "tEvent.h"
 #include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_WAIT_STAT == 1
+// 阻塞原因的编号紧接在事件类型之后
+TINYOS_STATIC_ASSERT(waitEventTypes, tEventTypeCount == TINYOS_WAIT_EVENT_TYPES);
+#endif
 
 /**
  * @brief 初始化事件对象。
@@ -14,8 +20,61 @@
 void tEventInit(tEvent * event, tEventType type) {
     event->type = type;  // 设置事件的类型
     tListInit(&(event->waitList));  // 初始化事件等待任务链表
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+    tBitMapInit(&(event->waitBitMap));
+#endif
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+    tListInit(&(event->multiList));
+#endif
+#if TINYOS_ENABLE_REGISTRY == 1
+    event->stat.waitCount = 0;
+    event->stat.wakeCount = 0;
+    event->stat.timeoutCount = 0;
+    event->stat.maxWaiters = 0;
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    event->stat.waitUs = 0;
+    event->stat.maxWaitUs = 0;
+#endif
+#endif
+}
+
+//对象登记表开启时统计等待、唤醒及超时次数，需在临界区内调用
+#if TINYOS_ENABLE_REGISTRY == 1
+#define tEventStatInc(event, field)     ((event)->stat.field++)
+#else
+#define tEventStatInc(event, field)
+#endif
+
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+//按优先级插入等待队列：插到优先级不低于该任务的最后一个等待任务之后，同优先级保持先来先服务
+TINYOS_FAST_CODE static void tEventWaitListAdd(tEvent * event, tTask * task) {
+    uint32_t prio = tBitMapGetLastSetUpTo(&(event->waitBitMap), task->prio);
+    tNode * preNode = (prio >= tBitMapPosCount()) ? &(event->waitList.headNode) : event->waitTail[prio];
+
+    tListInsertAfter(&(event->waitList), preNode, &(task->linkNode));
+    event->waitTail[task->prio] = &(task->linkNode);
+    tBitMapSet(&(event->waitBitMap), task->prio);
 }
 
+//从等待队列移除，若是该优先级的最后一个结点则更新waitTail及位图
+TINYOS_FAST_CODE static void tEventWaitListRemove(tEvent * event, tTask * task) {
+    if (event->waitTail[task->prio] == &(task->linkNode)) {
+        tNode * preNode = task->linkNode.preNode;
+        tTask * preTask = tNodeParent(preNode, tTask, linkNode);
+        if ((preNode != &(event->waitList.headNode)) && (preTask->prio == task->prio)) {
+            event->waitTail[task->prio] = preNode;
+        } else {
+            event->waitTail[task->prio] = (tNode *)0;
+            tBitMapClear(&(event->waitBitMap), task->prio);
+        }
+    }
+    tListRemove(&(event->waitList), &(task->linkNode));
+}
+#else
+#define tEventWaitListAdd(event, task)      tListAddLast(&((event)->waitList), &((task)->linkNode))
+#define tEventWaitListRemove(event, task)   tListRemove(&((event)->waitList), &((task)->linkNode))
+#endif
+
 /**
  * @brief 当前任务等待事件。
  * 
@@ -29,20 +88,27 @@ void tEventInit(tEvent * event, tEventType type) {
  * 
  * @return void
  */
-void tEventWait(tEvent * event, tTask * task, void * msg, uint32_t state, uint32_t timeout) {
+TINYOS_FAST_CODE void tEventWait(tEvent * event, tTask * task, void * msg, uint32_t state, uint32_t timeout) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
 	task->state |= state << 16;  // 设置任务的状态为等待状态
     task->waitEvent = event;  // 设置任务等待的事件
     task->eventMsg = msg;  // 存储事件消息
     task->waitEventResult = tErrorNoError;  // 初始设置事件结果为无错误
+    tTraceRecord(tTraceEventWait, event, event->type);
 
     tTaskSchedUnRdy(task);  // 将任务从就绪队列中移除，进入等待状态
 
-    tListAddLast(&(event->waitList), &(task->linkNode));  // 将任务加入事件的等待队列
+    tEventWaitListAdd(event, task);  // 将任务加入事件的等待队列
+    tEventStatInc(event, waitCount);
+#if TINYOS_ENABLE_REGISTRY == 1
+    if (tListCount(&event->waitList) > event->stat.maxWaiters) {
+        event->stat.maxWaiters = tListCount(&event->waitList);
+    }
+#endif
 
     if (timeout) {
-        tTimeTaskWait(task, timeout);  // 如果设置了超时时间，将任务加入延时队列
+        tTimeTaskTimeoutStart(task, timeout);  // 如果设置了超时时间，将任务加入超时队列
     }
 
     tTaskExitCritical(status);  // 退出临界区
@@ -59,22 +125,25 @@ void tEventWait(tEvent * event, tTask * task, void * msg, uint32_t state, uint32
  * 
  * @return tTask* 返回被唤醒的任务指针。如果没有任务等待事件，则返回NULL。
  */
-tTask * tEventWakeUp(tEvent * event, void * msg, uint32_t result) {
+TINYOS_FAST_CODE tTask * tEventWakeUp(tEvent * event, void * msg, uint32_t result) {
     tNode * node;
     tTask * task = (tTask *)0;
 
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-    // 从事件的等待队列中移除第一个任务
-    if ((node = tListRemoveFirst(&event->waitList)) != (tNode *)0) {
+    // 从事件的等待队列中移除第一个任务，按优先级排序时即为优先级最高的任务
+    if ((node = tListFirst(&event->waitList)) != (tNode *)0) {
         task = (tTask *)tNodeParent(node, tTask, linkNode);  // 获取等待的任务指针
+        tEventWaitListRemove(event, task);
         task->waitEvent = (tEvent *)0;  // 清除任务的等待事件
         task->eventMsg = msg;  // 设置任务的事件消息
         task->waitEventResult = result;  // 设置任务的等待结果
         task->state &= ~TINYOS_TASK_WAIT_MASK;  // 清除任务的等待状态
+        tTraceRecord(tTraceEventWakeUp, event, event->type);
+        tEventStatInc(event, wakeCount);
 
-        if (task->delayTicks != 0) {
-            tTimeTaskWakeUp(task);  // 如果任务被延时，唤醒任务
+        if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+            tTimeTaskTimeoutCancel(task);  // 超时前被唤醒，取消超时计时
         }
 
         tTaskSchedRdy(task);  // 将任务加入就绪队列
@@ -84,20 +153,38 @@ tTask * tEventWakeUp(tEvent * event, void * msg, uint32_t result) {
     return task;  // 返回被唤醒的任务指针
 }
 
-tTask * tEventWakeUpTask(tEvent * event, tTask * task, void * msg, uint32_t result) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+/**
+ * @brief 唤醒等待事件的指定任务，调用者已处于临界区内。
+ * 
+ * 供一次唤醒多个任务的场合(如事件标志组)在同一临界区内批量使用，省去每次嵌套进入临界区。
+ * 
+ * @param event   指向事件对象的指针。
+ * @param task    正在等待该事件的任务。
+ * @param msg     事件消息，传递给唤醒任务。
+ * @param result  事件的结果。
+ * 
+ * @return void
+ */
+TINYOS_FAST_CODE void tEventWakeUpTaskLocked(tEvent * event, tTask * task, void * msg, uint32_t result) {
+    tEventWaitListRemove(event, task);
+    task->waitEvent = (tEvent *)0;  // 清除任务的等待事件
+    task->eventMsg = msg;  // 设置任务的事件消息
+    task->waitEventResult = result;  // 设置任务的等待结果
+    task->state &= ~TINYOS_TASK_WAIT_MASK;  // 清除任务的等待状态
+    tTraceRecord(tTraceEventWakeUp, event, event->type);
+    tEventStatInc(event, wakeCount);
+
+    if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+        tTimeTaskTimeoutCancel(task);  // 超时前被唤醒，取消超时计时
+    }
 
-		tListRemove(&event->waitList,&task->linkNode);
-		task->waitEvent = (tEvent *)0;  // 清除任务的等待事件
-		task->eventMsg = msg;  // 设置任务的事件消息
-		task->waitEventResult = result;  // 设置任务的等待结果
-		task->state &= ~TINYOS_TASK_WAIT_MASK;  // 清除任务的等待状态
+    tTaskSchedRdy(task);  // 将任务加入就绪队列
+}
 
-		if (task->delayTicks != 0) {
-				tTimeTaskWakeUp(task);  // 如果任务被延时，唤醒任务
-		}
+TINYOS_FAST_CODE tTask * tEventWakeUpTask(tEvent * event, tTask * task, void * msg, uint32_t result) {
+    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-		tTaskSchedRdy(task);  // 将任务加入就绪队列
+    tEventWakeUpTaskLocked(event, task, msg, result);
 
     tTaskExitCritical(status);  // 退出临界区
 		
@@ -115,10 +202,13 @@ tTask * tEventWakeUpTask(tEvent * event, tTask * task, void * msg, uint32_t resu
  * 
  * @return void
  */
-void tEventRemoveTask(tTask * task, void * msg, uint32_t result) {
+TINYOS_FAST_CODE void tEventRemoveTask(tTask * task, void * msg, uint32_t result) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-    tListRemove(&task->waitEvent->waitList, &task->linkNode);  // 从事件的等待队列中移除任务
+    if (result == tErrorTimeOut) {
+        tEventStatInc(task->waitEvent, timeoutCount);
+    }
+    tEventWaitListRemove(task->waitEvent, task);  // 从事件的等待队列中移除任务
     task->waitEvent = (tEvent *)0;  // 清除任务的等待事件
     task->eventMsg = msg;  // 设置任务的事件消息
     task->waitEventResult = result;  // 设置任务的等待结果
@@ -153,17 +243,71 @@ uint32_t tEventRemoveAll(tEvent * event, void * msg, uint32_t result) {
         task->waitEventResult = result;  // 设置任务的等待结果
         task->state &= ~TINYOS_TASK_WAIT_MASK;  // 清除任务的等待状态
 
-        if (task->delayTicks != 0) {
-            tTimeTaskWakeUp(task);  // 如果任务被延时，唤醒任务
+        if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+            tTimeTaskTimeoutCancel(task);  // 超时前被唤醒，取消超时计时
         }
 
         tTaskSchedRdy(task);  // 将任务加入就绪队列
     }
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+    tBitMapInit(&(event->waitBitMap));
+#endif
+    // 同时等待多个对象的任务也一并唤醒，返回删除等结果
+    tEventMultiWakeUp(event, result);
 
     tTaskExitCritical(status);  // 退出临界区
     return count;  // 返回被移除的任务数量
 }
 
+/**
+ * @brief 修改任务的优先级。
+ * 
+ * 任务正在等待事件时，需要按新的优先级调整其在等待队列中的位置，供互斥量优先级继承等场合使用。
+ * 调用者需保证任务不在就绪队列中，并在临界区内调用。
+ * 
+ * @param task    指向任务结构体的指针。
+ * @param prio    新的优先级。
+ * 
+ * @return void
+ */
+void tEventTaskSetPrio(tTask * task, uint32_t prio) {
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+    if (task->waitEvent) {
+        tEventWaitListRemove(task->waitEvent, task);
+        task->prio = prio;
+        tEventWaitListAdd(task->waitEvent, task);
+        return;
+    }
+#endif
+    task->prio = prio;
+}
+
+/**
+ * @brief 将正在等待的任务转到另一个事件的等待队列，任务保持阻塞。
+ * 
+ * 供条件变量把等待者直接转到互斥量上，避免唤醒后再阻塞。转移后不再计算超时，需在临界区内调用。
+ * 
+ * @param event   新的事件对象。
+ * @param task    正在等待的任务。
+ * @param state   新的等待状态(事件类型)。
+ * 
+ * @return void
+ */
+void tEventMoveTask(tEvent * event, tTask * task, uint32_t state) {
+    tEventWaitListRemove(task->waitEvent, task);
+    if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+        tTimeTaskTimeoutCancel(task);
+    }
+    task->state = (task->state & ~TINYOS_TASK_WAIT_MASK) | (state << 16);
+    task->waitEvent = event;
+    tEventWaitListAdd(event, task);
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    // 之前的等待到此结束，之后计入新的事件
+    tTaskWaitStatEnd(task);
+    tTaskWaitStatBegin(task);
+#endif
+}
+
 /**
  * @brief 获取事件的等待任务数量。
  * 
@@ -183,3 +327,114 @@ uint32_t tEventWaitCount(tEvent * event) {
     tTaskExitCritical(status);  // 退出临界区
     return count;  // 返回等待队列中的任务数量
 }
+
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+//检查对象当前是否有资源可取，需在临界区内调用
+//事件标志组无法得知等待者关心的标志，任一标志置位即视为就绪
+static uint32_t tEventIsReady(tEvent * event) {
+    switch (event->type) {
+#if TINYOS_ENABLE_SEM == 1
+        case tEventTypeSem:
+            return (tNodeParent(event, tSem, event))->count > 0;
+#endif
+#if TINYOS_ENABLE_MBOX == 1
+        case tEventTypeMbox:
+            return (tNodeParent(event, tMbox, event))->count > 0;
+#endif
+#if TINYOS_ENABLE_MEMBLOCK == 1
+        case tEventTypeMemBlock:
+    #if TINYOS_MEMBLOCK_USE_LIFO == 1
+            return (tNodeParent(event, tMemBlock, event))->freeCount > 0;
+    #else
+            return tListCount(&((tNodeParent(event, tMemBlock, event))->blockList)) > 0;
+    #endif
+#endif
+#if TINYOS_ENABLE_FLAGGROUP == 1
+        case tEventTypeFlagGroup:
+            return (tNodeParent(event, tFlagGroup, event))->flags != 0;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 同时等待多个对象。
+ * 
+ * 任一对象有资源可取时返回该对象的下标，资源并不在这里取走，调用者需再用对应的NoWaitGet获取，
+ * 被其他任务抢先取走时重新等待即可。对象只在资源被放入且没有任务直接等待它时才唤醒这里的等待者。
+ * 
+ * @param events     对象中的事件控制块数组，支持信号量、邮箱、存储池及事件标志组。
+ * @param count      对象数量，不超过TINYOS_EVENT_MULTI_MAX。
+ * @param index      返回就绪对象的下标。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示有对象就绪，`tErrorTimeOut`表示超时，`tErrorDel`表示*index对应的对象被删除。
+ */
+uint32_t tEventWaitMulti(tEvent ** events, uint32_t count, uint32_t * index, uint32_t waitTicks) {
+    uint32_t i, result;
+    tEvent waiter;
+    tEventMultiNode nodes[TINYOS_EVENT_MULTI_MAX];
+    uint32_t status = tTaskEnterCritical();
+
+    if (count > TINYOS_EVENT_MULTI_MAX) {
+        count = TINYOS_EVENT_MULTI_MAX;
+    }
+    for (i = 0; i < count; i++) {
+        if (tEventIsReady(events[i])) {
+            *index = i;
+            tTaskExitCritical(status);
+            return tErrorNoError;
+        }
+    }
+
+    // 在每个对象上挂一个结点，任意一个被触发时唤醒阻塞在waiter上的当前任务
+    tEventInit(&waiter, tEventTypeMulti);
+    for (i = 0; i < count; i++) {
+        nodes[i].waiter = &waiter;
+        tListAddLast(&(events[i]->multiList), &(nodes[i].node));
+    }
+    tEventWait(&waiter, curTask, (void *)0, tEventTypeMulti, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    // 唤醒后结点仍挂在各对象上，取下后waiter才能失效
+    status = tTaskEnterCritical();
+    for (i = 0; i < count; i++) {
+        tListRemove(&(events[i]->multiList), &(nodes[i].node));
+        if (events[i] == (tEvent *)curTask->eventMsg) {
+            *index = i;
+        }
+    }
+    result = curTask->waitEventResult;
+    tTaskExitCritical(status);
+    return result;
+}
+
+/**
+ * @brief 唤醒所有通过tEventWaitMulti等待该对象的任务。
+ * 
+ * 由各对象在资源被放入且没有直接等待的任务时调用，也在删除对象时调用，需在临界区内调用。
+ * 
+ * @param event     指向事件对象的指针。
+ * @param result    传给等待任务的结果。
+ * 
+ * @return uint32_t 1表示唤醒了比当前任务优先级更高的任务。
+ */
+uint32_t tEventMultiWakeUp(tEvent * event, uint32_t result) {
+    uint32_t i, sched = 0;
+    tNode * node = tListFirst(&(event->multiList));
+
+    for (i = tListCount(&(event->multiList)); i > 0; i--) {
+        tEventMultiNode * multiNode = tNodeParent(node, tEventMultiNode, node);
+        // 同一任务的其他结点可能已唤醒过它，此时waiter上没有任务
+        tTask * task = tEventWakeUp(multiNode->waiter, (void *)event, result);
+        if (task && (task->prio < curTask->prio)) {
+            sched = 1;
+        }
+        node = node->nextNode;
+    }
+    return sched;
+}
+#endif
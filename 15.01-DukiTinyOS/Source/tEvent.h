@@ -9,13 +9,66 @@ typedef enum _tEventType {
 	tEventTypeMemBlock,
 	tEventTypeFlagGroup,
 	tEventTypeMutex,
+	tEventTypeHeap,
+	tEventTypeQueue,
+	tEventTypeStream,
+	tEventTypeMulti,
+	tEventTypeRwLock,
+	tEventTypeCond,
+	tEventTypeBarrier,
+	tEventTypeTopic,
+	tEventTypePrioQueue,
+	tEventTypeMsgCall,
+	tEventTypeMsgReply,
+	tEventTypeMsgReceive,
+	tEventTypeCount,
 }tEventType;
 
 typedef struct _tEvent {
 	tEventType type;
 	tList waitList;
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+	//等待队列按优先级排序，位图记录有哪些优先级的任务在等待，
+	//waitTail记录每个优先级最后一个等待任务的结点，插入时O(1)定位
+	tBitMap waitBitMap;
+	tNode * waitTail[TINYOS_PRIO_COUNT];
+#endif
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+	tList multiList;                 //通过tEventWaitMulti等待该对象的结点(tEventMultiNode)
+#endif
+#if TINYOS_ENABLE_REGISTRY == 1
+	tObject object;                  //对象登记表结点，由具体对象的初始化函数登记
+	tEventStat stat;
+#endif
 }tEvent;
 
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+//tEventWaitMulti为每个被等待的对象准备一个结点，挂在对象的multiList上，任务本身阻塞在临时事件waiter上
+typedef struct _tEventMultiNode {
+	tNode node;
+	tEvent * waiter;
+}tEventMultiNode;
+#endif
+
+//静态定义事件类对象时tEvent部分的初始值，与tEventInit的结果相同；name为登记表中的名称，
+//登记本身由tStaticInit在内核初始化时完成
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+#define TINYOS_EVENT_MULTI_INITIALIZER(event)   .multiList = TINYOS_LIST_INITIALIZER((event).multiList),
+#else
+#define TINYOS_EVENT_MULTI_INITIALIZER(event)
+#endif
+#if TINYOS_ENABLE_REGISTRY == 1
+#define TINYOS_EVENT_OBJECT_INITIALIZER(name)   .object = {{0, 0}, (name), tObjectTypeEvent},
+#else
+#define TINYOS_EVENT_OBJECT_INITIALIZER(name)
+#endif
+#define TINYOS_EVENT_INITIALIZER(event, eventType, name) { \
+	.type = (eventType), \
+	.waitList = TINYOS_LIST_INITIALIZER((event).waitList), \
+	TINYOS_EVENT_MULTI_INITIALIZER(event) \
+	TINYOS_EVENT_OBJECT_INITIALIZER(name) \
+}
+
 void tEventInit(tEvent * event,tEventType type);
 void tEventWait(tEvent * event, tTask * task, void * msg, uint32_t state, uint32_t timeout);
 tTask * tEventWakeUp(tEvent * event, void * msg, uint32_t result);
@@ -24,6 +77,21 @@ uint32_t tEventRemoveAll(tEvent * event, void * msg, uint32_t result);
 uint32_t tEventWaitCount(tEvent * event);
 
 tTask * tEventWakeUpTask(tEvent * event, tTask * task, void * msg, uint32_t result);
+void tEventWakeUpTaskLocked(tEvent * event, tTask * task, void * msg, uint32_t result);
+void tEventTaskSetPrio(tTask * task, uint32_t prio);
+void tEventMoveTask(tEvent * event, tTask * task, uint32_t state);
+
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+uint32_t tEventWaitMulti(tEvent ** events, uint32_t count, uint32_t * index, uint32_t waitTicks);
+uint32_t tEventMultiWakeUp(tEvent * event, uint32_t result);
+#else
+//未开启多事件等待时没有需要唤醒的任务；用函数而不是宏，作为语句调用时不产生无效果表达式的警告
+static __inline uint32_t tEventMultiWakeUp(tEvent * event, uint32_t result) {
+    (void)event;
+    (void)result;
+    return 0;
+}
+#endif
 #endif
 
 
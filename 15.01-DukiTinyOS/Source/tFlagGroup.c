@@ -11,7 +11,10 @@
  */
 void tFlagGroupInit(tFlagGroup *flagGroup, uint32_t flags) {
     tEventInit(&flagGroup->event, tEventTypeFlagGroup);  // 初始化事件对象，指定为标志组类型
+    tRegistryAdd(&flagGroup->event.object, tObjectTypeEvent);
     flagGroup->flags = flags;  // 设置初始的标志值
+    flagGroup->setWaitMask = 0;
+    flagGroup->clearWaitMask = 0;
 }
 
 /**
@@ -83,6 +86,11 @@ uint32_t tFlagGroupWait(tFlagGroup *flagGroup, uint32_t waitType, uint32_t reque
         // 当前任务等待标志类型和事件标志
         curTask->waitFlagsType = waitType;
         curTask->eventFlags = requestFlag;
+        if (waitType & TFLAGGROUP_SET) {
+            flagGroup->setWaitMask |= requestFlag;
+        } else {
+            flagGroup->clearWaitMask |= requestFlag;
+        }
         
         // 当前任务进入等待状态，等待旗标组的事件，最多等待waitTicks个时钟周期
         tEventWait(&flagGroup->event, curTask, (void *)0, tEventTypeFlagGroup, waitTicks);
@@ -136,21 +144,16 @@ uint32_t tFlagGroupNoWaitGet(tFlagGroup *flagGroup, uint32_t waitType, uint32_t
     return tErrorNoError;  // 返回成功
 }
 
-/**
- * @brief 通知标志组标志状态变化。
- * 
- * 该函数会通知标志组某一标志被设置或清除，并唤醒所有等待该标志的任务。
- * 
- * @param flagGroup   指向标志组的指针。
- * @param isSet       标志操作类型，`1`表示设置标志，`0`表示清除标志。
- * @param flag        要设置或清除的标志位。
- */
-void tFlagGroupNotify(tFlagGroup *flagGroup, uint8_t isSet, uint32_t flag) {
+//设置或清除标志并唤醒满足条件的任务，需在临界区内调用，返回1表示有任务被唤醒
+static uint32_t tFlagGroupUpdate(tFlagGroup *flagGroup, uint8_t isSet, uint32_t flag) {
     tList *waitList;   // 等待列表，用于存储所有等待该标志的任务
     tNode *node;       // 用于遍历等待列表的节点
-    uint32_t sched = 0; // 任务调度标志，标志是否需要调度任务
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，禁止任务调度，以保证线程安全
-    
+    tNode *nextNode;
+    uint32_t sched = 0;
+    uint32_t oldFlags = flagGroup->flags;
+    uint32_t changed;
+    uint32_t setWaitMask = 0, clearWaitMask = 0;
+
     // 根据isSet的值，设置或清除标志
     if (isSet) {
         // 设置标志
@@ -159,42 +162,93 @@ void tFlagGroupNotify(tFlagGroup *flagGroup, uint8_t isSet, uint32_t flag) {
         // 清除标志
         flagGroup->flags &= ~flag;
     }
-    
-    // 获取等待列表，该列表存储了所有等待该标志的任务
-    waitList = &flagGroup->event.waitList;
-
-    // 遍历等待列表中的所有任务
-    for (node = waitList->headNode.nextNode; node != &(waitList->headNode); node = node->nextNode) {
-        uint32_t result;  
-        tTask *task = tNodeParent(node, tTask, linkNode);  // 获取当前任务对象
-        uint32_t flags = task->eventFlags;  // 当前任务的事件标志
-        
-        // 检查并消耗标志
-        result = tFlagGroupCheckAndConsume(flagGroup, task->waitFlagsType, &flags);
-        
-        // 如果标志检查和消耗成功
-        if (result == tErrorNoError) {
-            // 更新任务的事件标志
-            task->eventFlags = flags;
-            
-            // 唤醒任务，并标记任务为就绪状态
-            tEventWakeUpTask(&flagGroup->event, task, (void *)0, tErrorNoError);
-            
-            // 标记需要调度任务
-            sched = 1;
+
+    // 置位只可能满足等待置位的任务，清零只可能满足等待清零的任务，
+    // 实际变化的位不在对应等待者关心的范围内时，没有任务的条件会因此改变，无需遍历等待队列
+    changed = isSet ? ((flagGroup->flags & ~oldFlags) & flagGroup->setWaitMask)
+                    : ((oldFlags & ~flagGroup->flags) & flagGroup->clearWaitMask);
+    if (changed) {
+        // 获取等待列表，该列表存储了所有等待该标志的任务
+        waitList = &flagGroup->event.waitList;
+
+        // 遍历等待列表中的所有任务，任务被唤醒后linkNode会挂到就绪队列，需先取出下一结点
+        // 满足条件的任务在同一临界区内批量转为就绪，由调用者统一调度一次
+        for (node = waitList->headNode.nextNode; node != &(waitList->headNode); node = nextNode) {
+            uint32_t result;
+            tTask *task = tNodeParent(node, tTask, linkNode);  // 获取当前任务对象
+            uint32_t flags = task->eventFlags;  // 当前任务的事件标志
+            nextNode = node->nextNode;
+
+            // 检查并消耗标志
+            result = tFlagGroupCheckAndConsume(flagGroup, task->waitFlagsType, &flags);
+
+            // 如果标志检查和消耗成功
+            if (result == tErrorNoError) {
+                // 更新任务的事件标志
+                task->eventFlags = flags;
+
+                // 唤醒任务，并标记任务为就绪状态
+                tEventWakeUpTaskLocked(&flagGroup->event, task, (void *)0, tErrorNoError);
+
+                // 标记需要调度任务
+                sched = 1;
+            } else if (task->waitFlagsType & TFLAGGROUP_SET) {
+                setWaitMask |= task->eventFlags;
+            } else {
+                clearWaitMask |= task->eventFlags;
+            }
         }
+
+        // 按仍在等待的任务重新计算，去掉已唤醒、超时或删除的任务留下的位
+        flagGroup->setWaitMask = setWaitMask;
+        flagGroup->clearWaitMask = clearWaitMask;
     }
 
+    // 直接等待的任务消耗后仍有标志置位时，唤醒同时等待多个对象的任务
+    if (isSet && flagGroup->flags) {
+        sched |= tEventMultiWakeUp(&flagGroup->event, tErrorNoError);
+    }
+    return sched;
+}
+
+/**
+ * @brief 通知标志组标志状态变化。
+ * 
+ * 该函数会通知标志组某一标志被设置或清除，并唤醒所有等待该标志的任务。
+ * 
+ * @param flagGroup   指向标志组的指针。
+ * @param isSet       标志操作类型，`1`表示设置标志，`0`表示清除标志。
+ * @param flag        要设置或清除的标志位。
+ */
+void tFlagGroupNotify(tFlagGroup *flagGroup, uint8_t isSet, uint32_t flag) {
+    uint32_t sched; // 任务调度标志，标志是否需要调度任务
+    uint32_t status = tTaskEnterCritical();  // 进入临界区，禁止任务调度，以保证线程安全
+
+    sched = tFlagGroupUpdate(flagGroup, isSet, flag);
+
+    tTaskExitCritical(status);
     // 如果有任务被唤醒，进行任务调度
     if (sched) {
-        // 退出临界区，允许任务调度
-        tTaskExitCritical(status);
-        
-        // 调度任务
         tTaskSched();
-    } else {
-        // 无任务需要调度，直接退出临界区
-        tTaskExitCritical(status);
+    }
+}
+
+/**
+ * @brief 在中断服务函数中设置或清除标志，唤醒任务后只标记需要调度，由tIntExit统一触发。
+ * 
+ * @param flagGroup   指向标志组的指针。
+ * @param isSet       标志操作类型，`1`表示设置标志，`0`表示清除标志。
+ * @param flag        要设置或清除的标志位。
+ */
+void tFlagGroupNotifyFromISR(tFlagGroup *flagGroup, uint8_t isSet, uint32_t flag) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tFlagGroupUpdate(flagGroup, isSet, flag);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
     }
 }
 
@@ -212,6 +266,7 @@ uint32_t tFlagGroupDestory(tFlagGroup *flagGroup) {
 
     // 删除标志组上的所有等待任务，并返回删除的任务数量
     uint32_t count = tEventRemoveAll(&flagGroup->event, (void *)0, tErrorDel);  // 删除所有等待任务
+    tRegistryRemove(&flagGroup->event.object);
     tTaskExitCritical(status);  // 退出临界区
 
     if (count > 0) {  // 如果有任务被删除
@@ -6,6 +6,10 @@
 typedef struct _tFlagGroup {
 	tEvent event;
 	uint32_t flags;
+	//等待者关心的标志位的并集，按等待置位/清零分别记录，变化的位与之无交集时无需遍历等待队列
+	//任务超时或被删除后不立即去除，下次遍历时重新计算
+	uint32_t setWaitMask;
+	uint32_t clearWaitMask;
 }tFlagGroup;
 
 typedef struct _tFlagGroupInfo {
@@ -35,6 +39,7 @@ uint32_t tFlagGroupWait(tFlagGroup * flagGroup, uint32_t waitType, uint32_t requ
 uint32_t tFlagGroupNoWaitGet(tFlagGroup * flagGroup, uint32_t waitType, uint32_t requestFlag, uint32_t *resultFlag, uint32_t waitTicks);
 
 void tFlagGroupNotify(tFlagGroup * flagGroup, uint8_t isSet, uint32_t flag);
+void tFlagGroupNotifyFromISR(tFlagGroup * flagGroup, uint8_t isSet, uint32_t flag);
 
 uint32_t tFlagGroupDestory(tFlagGroup * flagGroup);
 
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include "tFormat.h"
+
+#define TFORMAT_FLAG_LEFT   0x01    //'-'，左对齐
+#define TFORMAT_FLAG_ZERO   0x02    //'0'，数字前补0
+#define TFORMAT_FLAG_PLUS   0x04    //'+'，正数也输出符号
+
+typedef struct _tFormatOut {
+    tFormatPut put;
+    void * ctx;
+    uint32_t count;
+}tFormatOut;
+
+static const uint32_t tFormatPow10[TFORMAT_FRAC_MAX + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+static void tFormatEmit(tFormatOut * out, const char * s, uint32_t len) {
+    if (len > 0) {
+        out->put(out->ctx, s, len);
+        out->count += len;
+    }
+}
+
+//输出n个填充字符，每次最多8个
+static void tFormatPad(tFormatOut * out, char c, int32_t n) {
+    static const char spaces[8] = {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+    static const char zeros[8] = {'0', '0', '0', '0', '0', '0', '0', '0'};
+
+    while (n > 0) {
+        uint32_t len = (n > 8) ? 8 : (uint32_t)n;
+
+        tFormatEmit(out, (c == '0') ? zeros : spaces, len);
+        n -= (int32_t)len;
+    }
+}
+
+//按宽度及标志输出一个字段：sign为符号(0表示没有)，body为已生成的数字或字符串
+static void tFormatField(tFormatOut * out, char sign, const char * body, uint32_t len, int32_t width, uint32_t flags) {
+    int32_t pad = width - (int32_t)len - (sign ? 1 : 0);
+
+    if (!(flags & TFORMAT_FLAG_LEFT) && !(flags & TFORMAT_FLAG_ZERO)) {
+        tFormatPad(out, ' ', pad);
+    }
+    if (sign) {
+        tFormatEmit(out, &sign, 1);
+    }
+    if (!(flags & TFORMAT_FLAG_LEFT) && (flags & TFORMAT_FLAG_ZERO)) {
+        tFormatPad(out, '0', pad);
+    }
+    tFormatEmit(out, body, len);
+    if (flags & TFORMAT_FLAG_LEFT) {
+        tFormatPad(out, ' ', pad);
+    }
+}
+
+//从end向前写入value的minDigits位以上的数字，返回数字的起始位置
+static char * tFormatUnsigned(char * end, uint32_t value, uint32_t base, uint32_t minDigits, const char * digits) {
+    char * p = end;
+
+    while ((value != 0) || (minDigits > 0)) {
+        *--p = digits[value % base];
+        value /= base;
+        if (minDigits > 0) {
+            minDigits--;
+        }
+    }
+    return p;
+}
+
+//整数转换的最少位数：未给精度时为1，超过数字区的精度截为TFORMAT_NUM_MAX，与%f截断精度相同
+static uint32_t tFormatIntPrec(int32_t prec) {
+    if (prec < 0) {
+        return 1;
+    }
+    return (prec > TFORMAT_NUM_MAX) ? TFORMAT_NUM_MAX : (uint32_t)prec;
+}
+
+//从end向前写入3个字符的文字，返回起始位置
+static char * tFormatWord(char * end, const char * word) {
+    end[-3] = word[0];
+    end[-2] = word[1];
+    end[-1] = word[2];
+    return end - 3;
+}
+
+//定点输出浮点数，返回数字的起始位置；非数及超出范围时返回相应的文字
+static char * tFormatFixed(char * end, float value, uint32_t prec, char * sign) {
+    static const char digits[] = "0123456789";
+    uint32_t ip, frac, scale = tFormatPow10[prec];
+    char * p = end;
+
+    if (value != value) {
+        return tFormatWord(end, "nan");
+    }
+    if (value < 0.0f) {
+        *sign = '-';
+        value = -value;
+    }
+    if (value >= 4294967296.0f) {
+        return tFormatWord(end, (value > 3.4028235e38f) ? "inf" : "ovf");
+    }
+    ip = (uint32_t)value;
+    frac = (uint32_t)((value - (float)ip) * (float)scale + 0.5f);
+    if (frac >= scale) {
+        frac -= scale;
+        ip++;
+    }
+    if (prec > 0) {
+        p = tFormatUnsigned(p, frac, 10, prec, digits);
+        *--p = '.';
+    }
+    return tFormatUnsigned(p, ip, 10, 1, digits);
+}
+
+/**
+ * @brief 按格式串格式化输出，参数由va_list给出。
+ *
+ * @param put  输出函数，普通字符整段输出，每个转换说明的结果一次或几次输出。
+ * @param ctx  输出函数的参数。
+ * @param fmt  格式串。
+ * @param ap   参数。
+ *
+ * @return uint32_t 输出的字符数。
+ */
+uint32_t tVFormat(tFormatPut put, void * ctx, const char * fmt, va_list ap) {
+    static const char lower[] = "0123456789abcdef";
+    static const char upper[] = "0123456789ABCDEF";
+    tFormatOut out;
+    char num[TFORMAT_NUM_MAX];
+    char * end = num + sizeof(num);
+
+    out.put = put;
+    out.ctx = ctx;
+    out.count = 0;
+    while (*fmt != '\0') {
+        const char * start = fmt;
+        uint32_t flags = 0;
+        int32_t width = 0;
+        int32_t prec = -1;
+        char sign = 0;
+        char * p;
+
+        // 到下一个%为止的普通字符整段输出
+        while ((*fmt != '\0') && (*fmt != '%')) {
+            fmt++;
+        }
+        tFormatEmit(&out, start, (uint32_t)(fmt - start));
+        if (*fmt == '\0') {
+            break;
+        }
+        fmt++;
+
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                flags |= TFORMAT_FLAG_LEFT;
+            } else if (*fmt == '0') {
+                flags |= TFORMAT_FLAG_ZERO;
+            } else if (*fmt == '+') {
+                flags |= TFORMAT_FLAG_PLUS;
+            } else {
+                break;
+            }
+        }
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= TFORMAT_FLAG_LEFT;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while ((*fmt >= '0') && (*fmt <= '9')) {
+                width = width * 10 + (*fmt++ - '0');
+            }
+        }
+        if (*fmt == '.') {
+            fmt++;
+            prec = 0;
+            if (*fmt == '*') {
+                prec = va_arg(ap, int);
+                fmt++;
+            } else {
+                while ((*fmt >= '0') && (*fmt <= '9')) {
+                    prec = prec * 10 + (*fmt++ - '0');
+                }
+            }
+        }
+        while ((*fmt == 'l') || (*fmt == 'h') || (*fmt == 'z')) {
+            fmt++;
+        }
+
+        switch (*fmt) {
+            case 'd': case 'i': {
+                int32_t v = va_arg(ap, int);
+                // 先转为无符号再取负，INT32_MIN不溢出
+                uint32_t u = (uint32_t)v;
+
+                if (v < 0) {
+                    sign = '-';
+                    u = 0u - u;
+                } else if (flags & TFORMAT_FLAG_PLUS) {
+                    sign = '+';
+                }
+                p = tFormatUnsigned(end, u, 10, tFormatIntPrec(prec), lower);
+                tFormatField(&out, sign, p, (uint32_t)(end - p), width, flags);
+                break;
+            }
+            case 'u':
+                p = tFormatUnsigned(end, va_arg(ap, unsigned int), 10, tFormatIntPrec(prec), lower);
+                tFormatField(&out, 0, p, (uint32_t)(end - p), width, flags);
+                break;
+            case 'x': case 'X':
+                p = tFormatUnsigned(end, va_arg(ap, unsigned int), 16, tFormatIntPrec(prec),
+                                    (*fmt == 'x') ? lower : upper);
+                tFormatField(&out, 0, p, (uint32_t)(end - p), width, flags);
+                break;
+            case 'p':
+                p = tFormatUnsigned(end, (uint32_t)(uintptr_t)va_arg(ap, void *), 16, 8, lower);
+                *--p = 'x';
+                *--p = '0';
+                tFormatField(&out, 0, p, (uint32_t)(end - p), width, flags);
+                break;
+            case 'c':
+                num[0] = (char)va_arg(ap, int);
+                tFormatField(&out, 0, num, 1, width, flags & ~TFORMAT_FLAG_ZERO);
+                break;
+            case 's': {
+                const char * s = va_arg(ap, const char *);
+                uint32_t len = 0;
+
+                if (s == (const char *)0) {
+                    s = "(null)";
+                }
+                while ((s[len] != '\0') && ((prec < 0) || (len < (uint32_t)prec))) {
+                    len++;
+                }
+                tFormatField(&out, 0, s, len, width, flags & ~TFORMAT_FLAG_ZERO);
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                // 可变参数中的float已提升为double，转回单精度后只用单精度及整数运算
+                float v = (float)va_arg(ap, double);
+
+                if (prec < 0) {
+                    prec = 6;
+                } else if (prec > TFORMAT_FRAC_MAX) {
+                    prec = TFORMAT_FRAC_MAX;
+                }
+                p = tFormatFixed(end, v, (uint32_t)prec, &sign);
+                if ((sign == 0) && (flags & TFORMAT_FLAG_PLUS)) {
+                    sign = '+';
+                }
+                tFormatField(&out, sign, p, (uint32_t)(end - p), width, flags);
+                break;
+            }
+            case '%':
+                tFormatEmit(&out, "%", 1);
+                break;
+            case '\0':
+                return out.count;
+            default:
+                // 不支持的转换说明只输出转换字符
+                tFormatEmit(&out, fmt, 1);
+                break;
+        }
+        fmt++;
+    }
+    return out.count;
+}
+
+/**
+ * @brief 按格式串格式化输出。
+ *
+ * @return uint32_t 输出的字符数。
+ */
+uint32_t tFormat(tFormatPut put, void * ctx, const char * fmt, ...) {
+    va_list ap;
+    uint32_t count;
+
+    va_start(ap, fmt);
+    count = tVFormat(put, ctx, fmt, ap);
+    va_end(ap);
+    return count;
+}
+
+static void tFormatStdout(void * ctx, const char * s, uint32_t len) {
+    (void)ctx;
+    fwrite(s, 1, len, stdout);
+}
+
+/**
+ * @brief 格式化输出到stdout，目标板上经fputc进入串口的行缓冲，用于代替带%f的printf。
+ *
+ * @return uint32_t 输出的字符数。
+ */
+uint32_t tPrintf(const char * fmt, ...) {
+    va_list ap;
+    uint32_t count;
+
+    va_start(ap, fmt);
+    count = tVFormat(tFormatStdout, (void *)0, fmt, ap);
+    va_end(ap);
+    return count;
+}
@@ -0,0 +1,24 @@
+#ifndef __TFORMAT_H
+#define __TFORMAT_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+// 只用整数运算的格式化输出，代替内核及调试输出中的printf：格式串中的普通字符整段交给输出函数，
+// 不复制到行缓冲；每个数字在不超过TFORMAT_NUM_MAX字节的数字区中生成后一次输出，不使用堆
+// 支持%d %i %u %x %X %c %s %p %%，标志'-'、'0'、'+'，宽度及精度(可为*)，长度修饰符l、h、z忽略(参数均按32位)
+// 整数的精度最多TFORMAT_NUM_MAX位，更大的精度按TFORMAT_NUM_MAX输出
+// %f按定点输出：精度最多TFORMAT_FRAC_MAX位(默认6位)，浮点值按单精度换算为整数部分与小数部分，
+// 有效数字约7位，末位四舍五入，与printf在恰为一半或超出单精度的位上可能差1；整数部分超过32位时输出"ovf"，
+// %e、%g按%f处理。
+// 格式串中没有%f时编译器不会链接libc的浮点格式化，printf中的%f都应改用这里的函数
+#define TFORMAT_FRAC_MAX    6
+#define TFORMAT_NUM_MAX     20
+
+// 输出函数：s为len个字符，不以0结尾；可以直接写入发送环形缓冲区、日志缓冲区等
+typedef void (*tFormatPut)(void * ctx, const char * s, uint32_t len);
+
+uint32_t tVFormat(tFormatPut put, void * ctx, const char * fmt, va_list ap);
+uint32_t tFormat(tFormatPut put, void * ctx, const char * fmt, ...);
+uint32_t tPrintf(const char * fmt, ...);    //输出到stdout，与printf的去向相同
+#endif
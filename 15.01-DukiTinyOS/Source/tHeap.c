@@ -0,0 +1,397 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_HEAP == 1
+#if TINYOS_BITMAP_USE_CLZ == 1
+#include "tPort.h"
+#endif
+
+#define BLOCK_FREE          (1 << 0)    //本块空闲
+#define BLOCK_PREV_FREE     (1 << 1)    //前一块空闲
+#define BLOCK_FLAGS         (BLOCK_FREE | BLOCK_PREV_FREE)
+
+#define BLOCK_HEADER_SIZE   ((uint32_t)(uintptr_t)&(((tHeapBlock *)0)->nextFree))     //块头占用的大小，经uintptr_t转换，64位主机上不截断
+#define BLOCK_SIZE_MIN      (sizeof(tHeapBlock) - BLOCK_HEADER_SIZE)      //数据区至少能放下空闲链表指针
+#define BLOCK_SIZE_MAX      ((uint32_t)1 << TINYOS_HEAP_FL_INDEX_MAX)
+#define SMALL_BLOCK_SIZE    ((uint32_t)1 << TINYOS_HEAP_FL_SHIFT)
+
+#define blockSize(block)     ((block)->size & ~BLOCK_FLAGS)
+#define blockToMem(block)    ((void *)((uint8_t *)(block) + BLOCK_HEADER_SIZE))
+#define blockFromMem(mem)    ((tHeapBlock *)((uint8_t *)(mem) - BLOCK_HEADER_SIZE))
+#define blockNext(block)     ((tHeapBlock *)((uint8_t *)blockToMem(block) + blockSize(block)))
+
+// 最低的为1的位
+static uint32_t tHeapFfs(uint32_t word) {
+#if TINYOS_BITMAP_USE_CLZ == 1
+	return tPortCtz(word);
+#else
+	uint32_t bit = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+// 最高的为1的位
+static uint32_t tHeapFls(uint32_t word) {
+#if TINYOS_BITMAP_USE_CLZ == 1
+	return 31 - tPortClz(word);
+#else
+	uint32_t bit = 0;
+	while (word >>= 1) {
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+// 计算大小所在的一级、二级序号，小块在一级0中按对齐大小线性分段
+static void tHeapMapping(uint32_t size, uint32_t * fl, uint32_t * sl) {
+	if (size < SMALL_BLOCK_SIZE) {
+		*fl = 0;
+		*sl = size / (SMALL_BLOCK_SIZE / TINYOS_HEAP_SL_COUNT);
+	} else {
+		uint32_t f = tHeapFls(size);
+		*sl = (size >> (f - TINYOS_HEAP_SL_LOG2)) ^ TINYOS_HEAP_SL_COUNT;
+		*fl = f - (TINYOS_HEAP_FL_SHIFT - 1);
+	}
+}
+
+// 查找能满足size的非空空闲链表：先把size向上取整到所在分段的上界，保证该段中任一块都足够大
+static tHeapBlock * tHeapSearch(tHeap * heap, uint32_t size, uint32_t * fl, uint32_t * sl) {
+	uint32_t slMap, flMap;
+	if (size >= SMALL_BLOCK_SIZE) {
+		size += (1 << (tHeapFls(size) - TINYOS_HEAP_SL_LOG2)) - 1;
+	}
+	tHeapMapping(size, fl, sl);
+	if (*fl >= TINYOS_HEAP_FL_COUNT) {
+		return (tHeapBlock *)0;
+	}
+	
+	slMap = heap->slBitmap[*fl] & (~0U << *sl);
+	if (!slMap) {
+		// 本组没有合适的段，到更大的组中找
+		flMap = (*fl + 1 < 32) ? (heap->flBitmap & (~0U << (*fl + 1))) : 0;
+		if (!flMap) {
+			return (tHeapBlock *)0;
+		}
+		*fl = tHeapFfs(flMap);
+		slMap = heap->slBitmap[*fl];
+	}
+	*sl = tHeapFfs(slMap);
+	return heap->freeList[*fl][*sl];
+}
+
+static void tHeapRemoveFree(tHeap * heap, tHeapBlock * block, uint32_t fl, uint32_t sl) {
+	if (block->nextFree) {
+		block->nextFree->prevFree = block->prevFree;
+	}
+	if (block->prevFree) {
+		block->prevFree->nextFree = block->nextFree;
+	} else {
+		heap->freeList[fl][sl] = block->nextFree;
+		if (!block->nextFree) {
+			heap->slBitmap[fl] &= ~(1U << sl);
+			if (!heap->slBitmap[fl]) {
+				heap->flBitmap &= ~(1U << fl);
+			}
+		}
+	}
+	heap->freeSize -= blockSize(block);
+	heap->freeCount--;
+}
+
+static void tHeapRemove(tHeap * heap, tHeapBlock * block) {
+	uint32_t fl, sl;
+	tHeapMapping(blockSize(block), &fl, &sl);
+	tHeapRemoveFree(heap, block, fl, sl);
+}
+
+static void tHeapInsert(tHeap * heap, tHeapBlock * block) {
+	uint32_t fl, sl;
+	tHeapMapping(blockSize(block), &fl, &sl);
+	block->prevFree = (tHeapBlock *)0;
+	block->nextFree = heap->freeList[fl][sl];
+	if (block->nextFree) {
+		block->nextFree->prevFree = block;
+	}
+	heap->freeList[fl][sl] = block;
+	heap->flBitmap |= 1U << fl;
+	heap->slBitmap[fl] |= 1U << sl;
+	heap->freeSize += blockSize(block);
+	heap->freeCount++;
+}
+
+// 设置块的空闲标志，同时维护后一块的前块空闲标志
+static void tHeapMarkFree(tHeapBlock * block) {
+	tHeapBlock * next = blockNext(block);
+	block->size |= BLOCK_FREE;
+	next->size |= BLOCK_PREV_FREE;
+	next->prevPhys = block;
+}
+
+static void tHeapMarkUsed(tHeapBlock * block) {
+	tHeapBlock * next = blockNext(block);
+	block->size &= ~BLOCK_FREE;
+	next->size &= ~BLOCK_PREV_FREE;
+}
+
+// 从堆中分配size字节，失败返回0，需在临界区内调用
+static void * tHeapAllocBlock(tHeap * heap, uint32_t size) {
+	uint32_t fl, sl, remain;
+	tHeapBlock * block;
+	
+	if ((size == 0) || (size > BLOCK_SIZE_MAX)) {
+		return (void *)0;
+	}
+	size = (size + TINYOS_HEAP_ALIGN - 1) & ~(TINYOS_HEAP_ALIGN - 1);
+	if (size < BLOCK_SIZE_MIN) {
+		size = BLOCK_SIZE_MIN;
+	}
+	
+	block = tHeapSearch(heap, size, &fl, &sl);
+	if (!block) {
+		return (void *)0;
+	}
+	tHeapRemoveFree(heap, block, fl, sl);
+	
+	// 剩余部分足够构成一个块时拆分出来放回空闲链表
+	remain = blockSize(block) - size;
+	if (remain >= BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN) {
+		tHeapBlock * rest = (tHeapBlock *)((uint8_t *)blockToMem(block) + size);
+		rest->size = remain - BLOCK_HEADER_SIZE;
+		rest->prevPhys = block;
+		block->size = size | (block->size & BLOCK_FLAGS);
+		tHeapMarkFree(rest);
+		tHeapInsert(heap, rest);
+	}
+	
+	tHeapMarkUsed(block);
+	heap->usedCount++;
+	if (heap->freeSize < heap->minFreeSize) {
+		heap->minFreeSize = heap->freeSize;
+	}
+	return blockToMem(block);
+}
+
+// 释放内存并与物理上相邻的空闲块合并，需在临界区内调用
+static void tHeapFreeBlock(tHeap * heap, void * mem) {
+	tHeapBlock * block = blockFromMem(mem);
+	tHeapBlock * next = blockNext(block);
+	
+	heap->usedCount--;
+	if (block->size & BLOCK_PREV_FREE) {
+		tHeapBlock * prev = block->prevPhys;
+		tHeapRemove(heap, prev);
+		prev->size += BLOCK_HEADER_SIZE + blockSize(block);
+		block = prev;
+	}
+	if (next->size & BLOCK_FREE) {
+		tHeapRemove(heap, next);
+		block->size += BLOCK_HEADER_SIZE + blockSize(next);
+	}
+	tHeapMarkFree(block);
+	tHeapInsert(heap, block);
+}
+
+/**
+ * @brief 初始化堆。
+ * 
+ * 整块内存初始化为一个空闲块，末尾保留一个大小为0、标记为已分配的块头作为哨兵，合并时不会越界。
+ * 
+ * @param heap      指向堆结构体的指针。
+ * @param memStart  堆内存起始地址，会向上按8字节对齐。
+ * @param memSize   堆内存大小，单个空闲块不能超过2^TINYOS_HEAP_FL_INDEX_MAX字节。
+ * 
+ * @return void
+ */
+void tHeapInit(tHeap * heap, uint8_t * memStart, uint32_t memSize) {
+	uint32_t i, j;
+	uint8_t * start = (uint8_t *)(((uintptr_t)memStart + TINYOS_HEAP_ALIGN - 1) & ~(uintptr_t)(TINYOS_HEAP_ALIGN - 1));
+	tHeapBlock * block;
+	tHeapBlock * sentinel;
+	
+	tEventInit(&heap->event, tEventTypeHeap);
+	tRegistryAdd(&heap->event.object, tObjectTypeEvent);
+	heap->flBitmap = 0;
+	for (i = 0; i < TINYOS_HEAP_FL_COUNT; i++) {
+		heap->slBitmap[i] = 0;
+		for (j = 0; j < TINYOS_HEAP_SL_COUNT; j++) {
+			heap->freeList[i][j] = (tHeapBlock *)0;
+		}
+	}
+	heap->freeSize = 0;
+	heap->usedCount = 0;
+	heap->freeCount = 0;
+	
+	memSize -= start - memStart;
+	memSize &= ~(TINYOS_HEAP_ALIGN - 1);
+	if (memSize > BLOCK_SIZE_MAX) {
+		memSize = BLOCK_SIZE_MAX;
+	}
+	heap->memStart = start;
+	heap->memSize = memSize;
+	if (memSize < 2 * BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN) {
+		heap->minFreeSize = 0;
+		return;
+	}
+	
+	block = (tHeapBlock *)start;
+	block->prevPhys = (tHeapBlock *)0;
+	block->size = memSize - 2 * BLOCK_HEADER_SIZE;
+	sentinel = blockNext(block);
+	sentinel->size = 0;
+	tHeapMarkFree(block);
+	tHeapInsert(heap, block);
+	heap->minFreeSize = heap->freeSize;
+}
+
+/**
+ * @brief 非阻塞式分配内存。
+ * 
+ * @param heap  指向堆结构体的指针。
+ * @param size  需要的字节数。
+ * 
+ * @return void* 分配到的内存，按8字节对齐；空间不足时返回0。
+ */
+void * tHeapAlloc(tHeap * heap, uint32_t size) {
+	void * mem;
+	uint32_t status = tTaskEnterCritical();
+	
+	mem = tHeapAllocBlock(heap, size);
+	
+	tTaskExitCritical(status);
+	return mem;
+}
+
+/**
+ * @brief 阻塞式分配内存。
+ * 
+ * 空间不足时当前任务进入等待，请求的大小暂存在eventMsg中。有内存释放时按等待顺序依次尝试满足等待任务。
+ * 
+ * @param heap       指向堆结构体的指针。
+ * @param size       需要的字节数。
+ * @param mem        用于返回分配到的内存。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示堆被销毁。
+ */
+uint32_t tHeapWait(tHeap * heap, uint32_t size, void ** mem, uint32_t waitTicks) {
+	uint32_t status = tTaskEnterCritical();
+	
+	*mem = tHeapAllocBlock(heap, size);
+	if (*mem) {
+		tTaskExitCritical(status);
+		return tErrorNoError;
+	}
+	
+	tEventWait(&heap->event, curTask, (void *)(uintptr_t)size, tEventTypeHeap, waitTicks);
+	tTaskExitCritical(status);
+	
+	tTaskSched();
+	
+	*mem = (curTask->waitEventResult == tErrorNoError) ? curTask->eventMsg : (void *)0;
+	return curTask->waitEventResult;
+}
+
+/**
+ * @brief 释放内存。
+ * 
+ * 释放后按等待顺序尝试满足等待的任务，队首任务的请求仍不能满足时停止，避免大的请求一直得不到分配。
+ * 
+ * @param heap  指向堆结构体的指针。
+ * @param mem   tHeapAlloc或tHeapWait分配的内存。
+ * 
+ * @return void
+ */
+void tHeapFree(tHeap * heap, void * mem) {
+	tNode * node;
+	uint32_t sched = 0;
+	uint32_t status = tTaskEnterCritical();
+	
+	tHeapFreeBlock(heap, mem);
+	
+	while ((node = tListFirst(&heap->event.waitList)) != (tNode *)0) {
+		tTask * task = tNodeParent(node, tTask, linkNode);
+		void * taskMem = tHeapAllocBlock(heap, (uint32_t)(uintptr_t)task->eventMsg);
+		if (!taskMem) {
+			break;
+		}
+		tEventWakeUpTask(&heap->event, task, taskMem, tErrorNoError);
+		if (task->prio < curTask->prio) {
+			sched = 1;
+		}
+	}
+	
+	tTaskExitCritical(status);
+	if (sched) {
+		tTaskSched();
+	}
+}
+
+/**
+ * @brief 获取堆的状态信息。
+ * 
+ * 最大空闲块在最高的非空一级分组的最高非空分段中，只需遍历这一条链表。
+ * 分配时请求向上取整到所在分段的上界，只有不超过该块所在分段下界的请求一定能找到它，
+ * 因此单次能分配的最大大小把最大空闲块向下取整到分段下界。
+ * 
+ * @param heap  指向堆结构体的指针。
+ * @param info  用于存放堆信息的结构体指针。
+ * 
+ * @return void
+ */
+void tHeapGetInfo(tHeap * heap, tHeapInfo * info) {
+	uint32_t largest = 0;
+	uint32_t largestAlloc;
+	uint32_t status = tTaskEnterCritical();
+	
+	if (heap->flBitmap) {
+		uint32_t fl = tHeapFls(heap->flBitmap);
+		uint32_t sl = tHeapFls(heap->slBitmap[fl]);
+		tHeapBlock * block;
+		for (block = heap->freeList[fl][sl]; block; block = block->nextFree) {
+			if (blockSize(block) > largest) {
+				largest = blockSize(block);
+			}
+		}
+	}
+	
+	largestAlloc = largest;
+	if (largestAlloc >= SMALL_BLOCK_SIZE) {
+		largestAlloc &= ~((1U << (tHeapFls(largestAlloc) - TINYOS_HEAP_SL_LOG2)) - 1);
+	}
+	
+	info->totalSize = heap->memSize;
+	info->freeSize = heap->freeSize;
+	info->minFreeSize = heap->minFreeSize;
+	info->largestFreeBlock = largest;
+	info->largestAlloc = largestAlloc;
+	info->fragmentation = heap->freeSize ? (100 - (uint32_t)((uint64_t)largest * 100 / heap->freeSize)) : 0;
+	info->usedCount = heap->usedCount;
+	info->freeCount = heap->freeCount;
+	info->taskCount = tEventWaitCount(&heap->event);
+	
+	tTaskExitCritical(status);
+}
+
+/**
+ * @brief 销毁堆，唤醒所有等待分配的任务。
+ * 
+ * @param heap  指向堆结构体的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tHeapDestroy(tHeap * heap) {
+	uint32_t status = tTaskEnterCritical();
+	uint32_t count = tEventRemoveAll(&heap->event, (void *)0, tErrorDel);
+	tRegistryRemove(&heap->event.object);
+	tTaskExitCritical(status);
+	
+	if (count > 0) {
+		tTaskSched();
+	}
+	return count;
+}
+#endif
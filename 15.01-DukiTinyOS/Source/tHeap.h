@@ -0,0 +1,57 @@
+#ifndef __THEAP_H
+#define __THEAP_H
+#include "tEvent.h"
+
+// 两级分离适配(TLSF)堆
+// 一级按块大小的最高位分组，二级把每组等分为TINYOS_HEAP_SL_COUNT段，每段一条空闲链表，
+// 两级位图记录哪些链表非空，分配和释放都只需常数次位运算，与堆中块的数量无关
+#define TINYOS_HEAP_ALIGN_LOG2     3
+#define TINYOS_HEAP_ALIGN          (1 << TINYOS_HEAP_ALIGN_LOG2)   //分配的地址及大小按8字节对齐
+#define TINYOS_HEAP_SL_LOG2        3
+#define TINYOS_HEAP_SL_COUNT       (1 << TINYOS_HEAP_SL_LOG2)
+#define TINYOS_HEAP_FL_SHIFT       (TINYOS_HEAP_SL_LOG2 + TINYOS_HEAP_ALIGN_LOG2)
+#define TINYOS_HEAP_FL_COUNT       (TINYOS_HEAP_FL_INDEX_MAX - TINYOS_HEAP_FL_SHIFT + 1)
+
+// 块头，空闲块在数据区的开头再存放空闲链表的前后指针
+typedef struct _tHeapBlock {
+	struct _tHeapBlock * prevPhys;   //物理上相邻的前一块
+	uint32_t size;                   //数据区大小，低两位为标志
+	struct _tHeapBlock * nextFree;   //以下两项只在空闲块中有效
+	struct _tHeapBlock * prevFree;
+}tHeapBlock;
+
+typedef struct _tHeap {
+	tEvent event;                    //等待分配的任务
+	
+	uint8_t * memStart;
+	uint32_t memSize;
+	
+	uint32_t flBitmap;
+	uint32_t slBitmap[TINYOS_HEAP_FL_COUNT];
+	tHeapBlock * freeList[TINYOS_HEAP_FL_COUNT][TINYOS_HEAP_SL_COUNT];
+	
+	uint32_t freeSize;               //空闲块数据区的总大小
+	uint32_t minFreeSize;            //freeSize曾经到达的最小值
+	uint32_t usedCount;              //已分配的块数
+	uint32_t freeCount;              //空闲块数
+}tHeap;
+
+typedef struct _tHeapInfo {
+	uint32_t totalSize;              //可分配的总大小
+	uint32_t freeSize;               //空闲总大小
+	uint32_t minFreeSize;            //历史最小空闲大小
+	uint32_t largestFreeBlock;       //最大空闲块的数据区大小，分配请求按分段向上取整，申请这么大仍可能失败
+	uint32_t largestAlloc;           //单次一定能分配的最大大小，即最大空闲块向下取整到所在分段的下界
+	uint32_t fragmentation;          //碎片率(%)，100 * (1 - largestFreeBlock / freeSize)，只反映空闲块的分散程度
+	uint32_t usedCount;
+	uint32_t freeCount;
+	uint32_t taskCount;              //等待分配的任务数
+}tHeapInfo;
+
+void tHeapInit(tHeap * heap, uint8_t * memStart, uint32_t memSize);
+void * tHeapAlloc(tHeap * heap, uint32_t size);
+uint32_t tHeapWait(tHeap * heap, uint32_t size, void ** mem, uint32_t waitTicks);
+void tHeapFree(tHeap * heap, void * mem);
+void tHeapGetInfo(tHeap * heap, tHeapInfo * info);
+uint32_t tHeapDestroy(tHeap * heap);
+#endif
@@ -12,4 +12,11 @@ void tHooksTaskSwitch(tTask * from, tTask * to) {
 
 void tHooksTaskInit(tTask * task) {
 }
+
+void tHooksStackOverflow(tTask * task) {
+}
+
+//高优先级任务在互斥量上等待超过TINYOS_MUTEX_ALERT_US后调用，此时已获得互斥量或已超时
+void tHooksMutexWait(tMutex * mutex, tTask * task, uint32_t waitCycles) {
+}
 #endif
\ No newline at end of file
@@ -1,9 +1,134 @@
 #ifndef __THOOKS_H
 #define __THOOKS_H
 
+// 编译期钩子分发：每个钩子点有一张处理函数表，表由各模块的登记宏拼接而成，
+// 登记宏形如THOOKS_xxx_<模块>(X)，模块开启时展开为X(处理函数)，关闭时为空。
+// 内核在钩子点调用tHooksRunxxx，逐个直接调用表中的函数：不经过函数指针，static __inline的处理函数就地展开，
+// 表为空时tHooksRunxxx是空的内联函数，不产生任何代码。
+// 表中顺序即调用顺序：内核模块在前，应用钩子(TINYOS_ENABLE_HOOKS，tHooks.c中的空实现)其次，用户登记的最后。
+// 用户模块在tConfig.h中定义TINYOS_HOOKS_USER_xxx(X)登记自己的处理函数，例如
+//   #define TINYOS_HOOKS_USER_TASK_SWITCH(X)    X(myRuntimeSwitch) X(myStackCheck)
+// 用户处理函数按钩子的原型自动声明为外部函数，需要就地展开时改在TINYOS_HOOKS_USER_HEADER指定的头文件中
+// 定义为static __inline，并在表中登记同名函数
+
+#ifdef TINYOS_HOOKS_USER_HEADER
+#include TINYOS_HOOKS_USER_HEADER
+#endif
+
+#ifndef TINYOS_HOOKS_USER_CPU_IDLE
+#define TINYOS_HOOKS_USER_CPU_IDLE(X)
+#endif
+#ifndef TINYOS_HOOKS_USER_SYSTICK
+#define TINYOS_HOOKS_USER_SYSTICK(X)
+#endif
+#ifndef TINYOS_HOOKS_USER_TASK_SWITCH
+#define TINYOS_HOOKS_USER_TASK_SWITCH(X)
+#endif
+#ifndef TINYOS_HOOKS_USER_TASK_INIT
+#define TINYOS_HOOKS_USER_TASK_INIT(X)
+#endif
+#ifndef TINYOS_HOOKS_USER_STACK_OVERFLOW
+#define TINYOS_HOOKS_USER_STACK_OVERFLOW(X)
+#endif
+#ifndef TINYOS_HOOKS_USER_MUTEX_WAIT
+#define TINYOS_HOOKS_USER_MUTEX_WAIT(X)
+#endif
+
+// 各模块的登记
+#if TINYOS_ENABLE_TRACE == 1
+#define THOOKS_TASK_SWITCH_TRACE(X)         X(tTraceHookTaskSwitch)
+#else
+#define THOOKS_TASK_SWITCH_TRACE(X)
+#endif
+
+#if TINYOS_ENABLE_HOOKS == 1
+#define THOOKS_CPU_IDLE_APP(X)              X(tHooksCpuIdle)
+#define THOOKS_SYSTICK_APP(X)               X(tHooksSysTick)
+#define THOOKS_TASK_SWITCH_APP(X)           X(tHooksTaskSwitch)
+#define THOOKS_TASK_INIT_APP(X)             X(tHooksTaskInit)
+#define THOOKS_STACK_OVERFLOW_APP(X)        X(tHooksStackOverflow)
+#define THOOKS_MUTEX_WAIT_APP(X)            X(tHooksMutexWait)
+#else
+#define THOOKS_CPU_IDLE_APP(X)
+#define THOOKS_SYSTICK_APP(X)
+#define THOOKS_TASK_SWITCH_APP(X)
+#define THOOKS_TASK_INIT_APP(X)
+#define THOOKS_STACK_OVERFLOW_APP(X)
+#define THOOKS_MUTEX_WAIT_APP(X)
+#endif
+
+// 各钩子点的处理函数表
+#define THOOKS_CPU_IDLE_LIST(X)             THOOKS_CPU_IDLE_APP(X) TINYOS_HOOKS_USER_CPU_IDLE(X)
+#define THOOKS_SYSTICK_LIST(X)              THOOKS_SYSTICK_APP(X) TINYOS_HOOKS_USER_SYSTICK(X)
+#define THOOKS_TASK_SWITCH_LIST(X)          THOOKS_TASK_SWITCH_TRACE(X) THOOKS_TASK_SWITCH_APP(X) TINYOS_HOOKS_USER_TASK_SWITCH(X)
+#define THOOKS_TASK_INIT_LIST(X)            THOOKS_TASK_INIT_APP(X) TINYOS_HOOKS_USER_TASK_INIT(X)
+#define THOOKS_STACK_OVERFLOW_LIST(X)       THOOKS_STACK_OVERFLOW_APP(X) TINYOS_HOOKS_USER_STACK_OVERFLOW(X)
+#define THOOKS_MUTEX_WAIT_LIST(X)           THOOKS_MUTEX_WAIT_APP(X) TINYOS_HOOKS_USER_MUTEX_WAIT(X)
+
+// 应用钩子，TINYOS_ENABLE_HOOKS开启时由tHooks.c提供
 void tHooksCpuIdle(void);
-void tHooksSysTick(void); 
+void tHooksSysTick(void);
 void tHooksTaskSwitch(tTask * from, tTask * to);
 void tHooksTaskInit(tTask * task);
+void tHooksStackOverflow(tTask * task);
+void tHooksMutexWait(tMutex * mutex, tTask * task, uint32_t waitCycles);
+
+// 用户处理函数的声明
+#define THOOKS_DECLARE_CPU_IDLE(fn)         void fn(void);
+#define THOOKS_DECLARE_SYSTICK(fn)          void fn(void);
+#define THOOKS_DECLARE_TASK_SWITCH(fn)      void fn(tTask * from, tTask * to);
+#define THOOKS_DECLARE_TASK(fn)             void fn(tTask * task);
+#define THOOKS_DECLARE_MUTEX_WAIT(fn)       void fn(tMutex * mutex, tTask * task, uint32_t waitCycles);
+#ifndef TINYOS_HOOKS_USER_HEADER
+TINYOS_HOOKS_USER_CPU_IDLE(THOOKS_DECLARE_CPU_IDLE)
+TINYOS_HOOKS_USER_SYSTICK(THOOKS_DECLARE_SYSTICK)
+TINYOS_HOOKS_USER_TASK_SWITCH(THOOKS_DECLARE_TASK_SWITCH)
+TINYOS_HOOKS_USER_TASK_INIT(THOOKS_DECLARE_TASK)
+TINYOS_HOOKS_USER_STACK_OVERFLOW(THOOKS_DECLARE_TASK)
+TINYOS_HOOKS_USER_MUTEX_WAIT(THOOKS_DECLARE_MUTEX_WAIT)
+#endif
+
+// 分发：表中每一项展开为一次直接调用，实参为tHooksRunxxx的形参
+#define THOOKS_CALL_VOID(fn)                fn();
+#define THOOKS_CALL_TASK_SWITCH(fn)         fn(from, to);
+#define THOOKS_CALL_TASK(fn)                fn(task);
+#define THOOKS_CALL_MUTEX_WAIT(fn)          fn(mutex, task, waitCycles);
+
+//空闲任务每轮调用
+static __inline void tHooksRunCpuIdle(void) {
+	THOOKS_CPU_IDLE_LIST(THOOKS_CALL_VOID)
+}
+
+//SysTick处理末尾、调度之前调用，已退出临界区
+static __inline void tHooksRunSysTick(void) {
+	THOOKS_SYSTICK_LIST(THOOKS_CALL_VOID)
+}
+
+//确定切换到to之后、触发PendSV之前调用，在临界区内
+static __inline void tHooksRunTaskSwitch(tTask * from, tTask * to) {
+	(void)from;
+	(void)to;
+	THOOKS_TASK_SWITCH_LIST(THOOKS_CALL_TASK_SWITCH)
+}
+
+//任务加入就绪表之后调用
+static __inline void tHooksRunTaskInit(tTask * task) {
+	(void)task;
+	THOOKS_TASK_INIT_LIST(THOOKS_CALL_TASK)
+}
+
+//检测到栈溢出、停机之前调用
+static __inline void tHooksRunStackOverflow(tTask * task) {
+	(void)task;
+	THOOKS_STACK_OVERFLOW_LIST(THOOKS_CALL_TASK)
+}
+
+//高优先级任务在互斥量上等待超过TINYOS_MUTEX_ALERT_US后调用
+static __inline void tHooksRunMutexWait(tMutex * mutex, tTask * task, uint32_t waitCycles) {
+	(void)mutex;
+	(void)task;
+	(void)waitCycles;
+	THOOKS_MUTEX_WAIT_LIST(THOOKS_CALL_MUTEX_WAIT)
+}
 
 #endif
@@ -0,0 +1,222 @@
+#include "tinyOS.h"
+#include "stm32f4xx.h"
+
+#if TINYOS_ENABLE_HRTIMER == 1
+
+// 按到期时刻从早到晚排序的定时队列
+static tList tHrTimerList;
+
+/**
+ * @brief 初始化高精度定时器模块
+ * 
+ * TIM5挂在APB1上，APB1分频不为1时定时器时钟为PCLK1的两倍，据此设置预分频得到1MHz计数。
+ * 计数器自由运行不再重装，通道1的比较匹配用于产生到期中断。中断优先级不高于TINYOS_MAX_SYSCALL_PRIO，
+ * 回调函数中才能调用内核API。
+ * 
+ * @return void
+ */
+void tHrTimerModuleInit (void)
+{
+    uint32_t timClk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+    {
+        timClk *= 2;
+    }
+
+    tListInit(&tHrTimerList);
+
+    __HAL_RCC_TIM5_CLK_ENABLE();
+    TIM5->CR1 = 0;
+    TIM5->PSC = timClk / 1000000 - 1;
+    TIM5->ARR = 0xFFFFFFFF;
+    TIM5->CCMR1 = 0;                    // 通道1为输出比较冻结模式，只用于产生中断
+    TIM5->DIER = 0;
+    TIM5->EGR = TIM_EGR_UG;             // 装载预分频值
+    TIM5->SR = 0;
+
+    NVIC_SetPriority(TIM5_IRQn, TINYOS_MAX_SYSCALL_PRIO);
+    NVIC_EnableIRQ(TIM5_IRQn);
+
+    TIM5->CR1 = TIM_CR1_CEN;
+}
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+/**
+ * @brief 定时器时钟改变后重设预分频，保持1MHz计数，在调频的临界区内调用
+ * 
+ * 预分频只在更新事件时装载，由软件产生更新事件使其立即生效；更新事件会清零计数器，随即写回原值，
+ * 期间丢失不到1us。URS置位时软件更新事件不置更新标志，比较匹配及到期时刻不受影响。
+ * 
+ * @return void
+ */
+void tHrTimerClockChanged (void)
+{
+    uint32_t cnt = TIM5->CNT;
+
+    TIM5->PSC = tClockTimerFreq() / 1000000 - 1;
+    TIM5->CR1 |= TIM_CR1_URS;
+    TIM5->EGR = TIM_EGR_UG;
+    TIM5->CNT = cnt;
+    TIM5->CR1 &= ~TIM_CR1_URS;
+}
+#endif
+
+/**
+ * @brief 获取高精度时基的当前计数值，单位us，约71分钟回绕一次
+ * 
+ * @return uint32_t 当前计数值
+ */
+uint32_t tHrTimerGetCounter (void)
+{
+    return TIM5->CNT;
+}
+
+// 按到期时刻插入定时队列，用差值比较，计数回绕后仍然正确，需在临界区内调用
+static void tHrTimerInsert (tHrTimer * timer)
+{
+    tNode * node;
+    tNode * preNode = &(tHrTimerList.headNode);
+    for (node = tHrTimerList.headNode.nextNode; node != &(tHrTimerList.headNode); node = node->nextNode)
+    {
+        tHrTimer * t = tNodeParent(node, tHrTimer, linkNode);
+        if ((int32_t)(t->expire - timer->expire) > 0)
+        {
+            break;
+        }
+        preNode = node;
+    }
+    tListInsertAfter(&tHrTimerList, preNode, &(timer->linkNode));
+    timer->active = 1;
+}
+
+// 将比较寄存器设置为队首定时器的到期时刻，需在临界区内调用
+static void tHrTimerProgram (void)
+{
+    tNode * node = tListFirst(&tHrTimerList);
+    tHrTimer * timer;
+
+    if (node == (tNode *)0)
+    {
+        TIM5->DIER &= ~TIM_DIER_CC1IE;
+        return;
+    }
+
+    timer = tNodeParent(node, tHrTimer, linkNode);
+    TIM5->CCR1 = timer->expire;
+    TIM5->SR = ~TIM_SR_CC1IF;
+    TIM5->DIER |= TIM_DIER_CC1IE;
+
+    // 写入比较值时到期时刻可能已经过去，比较匹配不会再发生，软件产生一次比较事件
+    if ((int32_t)(timer->expire - TIM5->CNT) <= 0)
+    {
+        TIM5->EGR = TIM_EGR_CC1G;
+    }
+}
+
+/**
+ * @brief 初始化高精度定时器
+ * 
+ * @param timer     定时器
+ * @param timerFunc 到期回调函数，在中断中执行
+ * @param arg       传递给回调函数的参数
+ * 
+ * @return void
+ */
+void tHrTimerInit (tHrTimer * timer, void (*timerFunc) (void * arg), void * arg)
+{
+    tNodeInit(&timer->linkNode);
+    timer->expire = 0;
+    timer->period = 0;
+    timer->timerFunc = timerFunc;
+    timer->arg = arg;
+    timer->active = 0;
+}
+
+/**
+ * @brief 启动高精度定时器，已启动的定时器会按新的参数重新开始
+ * 
+ * @param timer     定时器
+ * @param delayUs   从现在起到第一次到期的微秒数
+ * @param periodUs  之后的周期，单位us，为0时只触发一次；周期定时按计划的到期时刻累加，不会累积误差
+ * 
+ * @return void
+ */
+void tHrTimerStart (tHrTimer * timer, uint32_t delayUs, uint32_t periodUs)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    if (timer->active)
+    {
+        tListRemove(&tHrTimerList, &timer->linkNode);
+    }
+    timer->expire = TIM5->CNT + delayUs;
+    timer->period = periodUs;
+    tHrTimerInsert(timer);
+    tHrTimerProgram();
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 停止高精度定时器
+ * 
+ * @param timer     定时器
+ * 
+ * @return void
+ */
+void tHrTimerStop (tHrTimer * timer)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    if (timer->active)
+    {
+        tListRemove(&tHrTimerList, &timer->linkNode);
+        timer->active = 0;
+        tHrTimerProgram();
+    }
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief TIM5中断服务函数，依次处理所有已到期的定时器，再装载下一个到期时刻
+ * 
+ * @return void
+ */
+void TIM5_IRQHandler (void)
+{
+    tNode * node;
+    uint32_t status;
+
+    tIntEnter();
+    status = tTaskEnterCritical();
+    TIM5->SR = ~TIM_SR_CC1IF;
+
+    while ((node = tListFirst(&tHrTimerList)) != (tNode *)0)
+    {
+        tHrTimer * timer = tNodeParent(node, tHrTimer, linkNode);
+        if ((int32_t)(timer->expire - TIM5->CNT) > 0)
+        {
+            break;
+        }
+
+        tListRemove(&tHrTimerList, node);
+        timer->active = 0;
+        if (timer->period > 0)
+        {
+            timer->expire += timer->period;
+            tHrTimerInsert(timer);
+        }
+
+        // 回调中可以重新启动或停止定时器，此时不持有临界区
+        tTaskExitCritical(status);
+        tTraceRecord(tTraceEventTimerFire, timer, 1);
+        timer->timerFunc(timer->arg);
+        status = tTaskEnterCritical();
+    }
+
+    tHrTimerProgram();
+    tTaskExitCritical(status);
+    tIntExit();
+}
+#endif
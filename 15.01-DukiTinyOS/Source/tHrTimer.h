@@ -0,0 +1,28 @@
+#ifndef THRTIMER_H
+#define THRTIMER_H
+
+#include <stdint.h>
+#include "tLib.h"
+
+// 高精度定时器
+// 使用TIM5作为1MHz自由运行的32位时基，定时器按到期时刻排序，比较寄存器只装载最近的到期时刻，
+// 到期时在TIM5中断中直接调用回调函数，回调中只能使用FromISR结尾的内核API
+typedef struct _tHrTimer
+{
+    tNode linkNode;
+    uint32_t expire;                // 到期时刻，单位us(TIM5计数值)
+    uint32_t period;                // 周期，单位us，为0时只触发一次
+    void (*timerFunc) (void * arg);
+    void * arg;
+    uint32_t active;                // 是否在定时队列中
+}tHrTimer;
+
+void tHrTimerModuleInit (void);
+uint32_t tHrTimerGetCounter (void);
+void tHrTimerInit (tHrTimer * timer, void (*timerFunc) (void * arg), void * arg);
+void tHrTimerStart (tHrTimer * timer, uint32_t delayUs, uint32_t periodUs);
+void tHrTimerStop (tHrTimer * timer);
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+void tHrTimerClockChanged (void);
+#endif
+#endif
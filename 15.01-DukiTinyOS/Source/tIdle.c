@@ -0,0 +1,101 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_IDLE_JOB == 1
+static tList tIdleJobList;
+//本轮尚未被调用的作业数，减到0时开始新的一轮
+static uint32_t tIdleJobRoundLeft;
+//本轮中是否有作业还有剩余工作
+static uint32_t tIdleJobRoundBusy;
+
+/**
+ * @brief 初始化空闲作业表，在tTinyOSInit中调用。
+ * 
+ * @return void
+ */
+void tIdleJobModuleInit(void) {
+    tListInit(&tIdleJobList);
+    tIdleJobRoundLeft = 0;
+    tIdleJobRoundBusy = 0;
+}
+
+/**
+ * @brief 注册空闲作业，可在任务中调用。
+ * 
+ * @param job       指向空闲作业的指针，注销前需保持有效。
+ * @param func      作业函数，不能阻塞，每次调用的执行时间应尽量短。
+ * @param arg       传给作业函数的参数。
+ * 
+ * @return void
+ */
+void tIdleJobRegister(tIdleJob * job, uint32_t (*func) (void * arg), void * arg) {
+    uint32_t status;
+
+    tNodeInit(&job->node);
+    job->func = func;
+    job->arg = arg;
+    job->runCount = 0;
+
+    status = tTaskEnterCritical();
+    tListAddLast(&tIdleJobList, &job->node);
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 注销空闲作业，可在作业函数中注销自身。
+ * 
+ * @param job       指向空闲作业的指针。
+ * 
+ * @return void
+ */
+void tIdleJobUnregister(tIdleJob * job) {
+    uint32_t status = tTaskEnterCritical();
+
+    tListRemove(&tIdleJobList, &job->node);
+    if (tIdleJobRoundLeft > tListCount(&tIdleJobList)) {
+        tIdleJobRoundLeft = tListCount(&tIdleJobList);
+    }
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 调用下一个空闲作业，只在空闲任务中调用。
+ * 
+ * @return 1表示仍有作业有剩余工作，空闲任务不应休眠
+ */
+uint32_t tIdleJobRun(void) {
+    tNode * node;
+    tIdleJob * job;
+    uint32_t busy = 1;
+    uint32_t status = tTaskEnterCritical();
+
+    if (tListCount(&tIdleJobList) == 0) {
+        tTaskExitCritical(status);
+        return 0;
+    }
+
+    if (tIdleJobRoundLeft == 0) {
+        tIdleJobRoundLeft = tListCount(&tIdleJobList);
+        tIdleJobRoundBusy = 0;
+    }
+    tIdleJobRoundLeft--;
+
+    // 取出队首作业放到队尾，实现轮流调用
+    node = tListRemoveFirst(&tIdleJobList);
+    tListAddLast(&tIdleJobList, node);
+    job = tNodeParent(node, tIdleJob, node);
+    job->runCount++;
+    tTaskExitCritical(status);
+
+    if (job->func(job->arg)) {
+        tIdleJobRoundBusy = 1;
+    }
+
+    // 一轮结束且所有作业都无事可做时允许休眠
+    status = tTaskEnterCritical();
+    if ((tIdleJobRoundLeft == 0) && !tIdleJobRoundBusy) {
+        busy = 0;
+    }
+    tTaskExitCritical(status);
+    return busy;
+}
+#endif
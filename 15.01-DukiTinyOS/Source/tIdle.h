@@ -0,0 +1,19 @@
+#ifndef __TIDLE_H
+#define __TIDLE_H
+
+#include "tLib.h"
+
+// 空闲作业：只在没有其它任务就绪时由空闲任务调用，每次调用只做一小段有限的工作后返回
+// 空闲任务每轮只调用一个作业，轮流进行；所有作业都说明暂时无事可做时，空闲任务才进入低功耗休眠
+typedef struct _tIdleJob {
+	tNode node;
+	uint32_t (*func) (void * arg);   //返回1表示还有剩余工作，0表示暂时无事可做
+	void * arg;
+	uint32_t runCount;
+}tIdleJob;
+
+void tIdleJobModuleInit(void);
+void tIdleJobRegister(tIdleJob * job, uint32_t (*func) (void * arg), void * arg);
+void tIdleJobUnregister(tIdleJob * job);
+uint32_t tIdleJobRun(void);
+#endif
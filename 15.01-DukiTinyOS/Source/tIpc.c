@@ -0,0 +1,223 @@
+#include <string.h>
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_IPC == 1
+
+#if (TINYOS_IPC_MSG_SLOTS & (TINYOS_IPC_MSG_SLOTS - 1)) != 0
+#error "TINYOS_IPC_MSG_SLOTS must be a power of 2"
+#endif
+#if (TINYOS_IPC_BYTE_SIZE & (TINYOS_IPC_BYTE_SIZE - 1)) != 0
+#error "TINYOS_IPC_BYTE_SIZE must be a power of 2"
+#endif
+
+/**
+ * @brief 清空共享通道的两个发件区，由先启动的一侧在另一侧开始访问之前调用一次。
+ *
+ * @param shared  共享内存中的通道。
+ *
+ * @return void
+ */
+void tIpcSharedInit(tIpcShared * shared) {
+    memset(shared, 0, sizeof(*shared));
+    __DMB();
+}
+
+/**
+ * @brief 初始化本侧的端点。
+ *
+ * @param ep           指向端点的指针。
+ * @param shared       共享内存中的通道，两侧为同一地址。
+ * @param side         本侧的侧号，0或1，两侧不同。
+ * @param rxMbox       接收消息的邮箱，为0时不接收消息。
+ * @param releaseMbox  接收对端归还的缓冲区的邮箱，为0时丢弃。
+ * @param rxStream     接收字节流的字节流缓冲区，为0时不接收字节。
+ * @param doorbell     通知对端的函数，如触发对端的中断；为0时对端只能轮询。
+ * @param doorbellArg  门铃函数的参数。
+ *
+ * @return void
+ */
+void tIpcInit(tIpcEndpoint * ep, tIpcShared * shared, uint32_t side, tMbox * rxMbox, tMbox * releaseMbox,
+              tStream * rxStream, void (*doorbell)(void * arg), void * doorbellArg) {
+    ep->shared = shared;
+    ep->side = side & 1;
+    ep->rxMbox = rxMbox;
+    ep->releaseMbox = releaseMbox;
+    ep->rxStream = rxStream;
+    ep->doorbell = doorbell;
+    ep->doorbellArg = doorbellArg;
+    ep->txFull = 0;
+    ep->rxMsgs = 0;
+    ep->rxBytes = 0;
+}
+
+static void tIpcRing(tIpcEndpoint * ep) {
+    if (ep->doorbell) {
+        ep->doorbell(ep->doorbellArg);
+    }
+}
+
+//写入一个消息，本侧可能有多个任务或中断发送，同一侧的生产者之间用临界区互斥，返回0成功
+static uint32_t tIpcPushMsg(tIpcEndpoint * ep, tIpcMsgRing * ring, void * msg) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t head = ring->head;
+
+    if (head - ring->tail >= TINYOS_IPC_MSG_SLOTS) {
+        ep->txFull++;
+        tTaskExitCritical(status);
+        return tErrorResourceFull;
+    }
+    ring->slot[head & (TINYOS_IPC_MSG_SLOTS - 1)] = msg;
+    // 消息写完后再发布写索引
+    __DMB();
+    ring->head = head + 1;
+    tTaskExitCritical(status);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 发送一个消息给对端，只传递指针，不复制缓冲区，可在中断中调用。
+ *
+ * @param ep   本侧的端点。
+ * @param msg  消息，一般为共享内存中的缓冲区，对端tIpcRelease后经归还邮箱回到本侧。
+ *
+ * @return uint32_t  tErrorNoError成功，tErrorResourceFull对端尚未取走TINYOS_IPC_MSG_SLOTS个消息。
+ */
+uint32_t tIpcSend(tIpcEndpoint * ep, void * msg) {
+    uint32_t err = tIpcPushMsg(ep, &ep->shared->outbox[ep->side].msg, msg);
+
+    if (err == tErrorNoError) {
+        tIpcRing(ep);
+    }
+    return err;
+}
+
+/**
+ * @brief 归还对端发来的消息缓冲区，之后本侧不能再访问该缓冲区。
+ *
+ * 本地邮箱满时留在共享队列中的消息在这里继续转入，接收任务每处理完一个消息归还一次即可。
+ *
+ * @param ep   本侧的端点。
+ * @param msg  从rxMbox收到的消息。
+ *
+ * @return uint32_t  tErrorNoError成功，tErrorResourceFull归还队列已满。
+ */
+uint32_t tIpcRelease(tIpcEndpoint * ep, void * msg) {
+    uint32_t err = tIpcPushMsg(ep, &ep->shared->outbox[ep->side].release, msg);
+
+    if (err == tErrorNoError) {
+        tIpcRing(ep);
+    }
+    tIpcPoll(ep);
+    return err;
+}
+
+/**
+ * @brief 向对端的字节流写入数据，复制到共享队列，可在中断中调用。
+ *
+ * @param ep    本侧的端点。
+ * @param data  要写入的数据。
+ * @param len   字节数。
+ *
+ * @return uint32_t  实际写入的字节数，共享队列空间不足时少于len。
+ */
+uint32_t tIpcWrite(tIpcEndpoint * ep, const void * data, uint32_t len) {
+    tIpcByteRing * ring = &ep->shared->outbox[ep->side].bytes;
+    const uint8_t * src = (const uint8_t *)data;
+    uint32_t status = tTaskEnterCritical();
+    uint32_t head = ring->head;
+    uint32_t space = TINYOS_IPC_BYTE_SIZE - (head - ring->tail);
+    uint32_t offset = head & (TINYOS_IPC_BYTE_SIZE - 1);
+    uint32_t first;
+
+    if (len > space) {
+        ep->txFull++;
+        len = space;
+    }
+    // 回绕处分两段复制
+    first = TINYOS_IPC_BYTE_SIZE - offset;
+    first = (len < first) ? len : first;
+    memcpy(&ring->data[offset], src, first);
+    memcpy(&ring->data[0], src + first, len - first);
+    __DMB();
+    ring->head = head + len;
+    tTaskExitCritical(status);
+
+    if (len > 0) {
+        tIpcRing(ep);
+    }
+    return len;
+}
+
+//把对端消息队列中的消息转入本地邮箱，邮箱满时停止，其余的留在共享队列中
+static void tIpcDrainMsg(tIpcMsgRing * ring, tMbox * mbox, uint32_t * count) {
+    uint32_t tail = ring->tail;
+
+    // 先读索引再读消息
+    __DMB();
+    while (tail != ring->head) {
+        void * msg = ring->slot[tail & (TINYOS_IPC_MSG_SLOTS - 1)];
+
+        if (mbox) {
+            if (tMboxNotifyFromISR(mbox, msg, tMboxSendNormal) != tErrorNoError) {
+                break;
+            }
+            if (count) {
+                (*count)++;
+            }
+        }
+        tail++;
+    }
+    // 消息取走后再释放空间
+    __DMB();
+    ring->tail = tail;
+}
+
+//把对端字节队列中的数据转入本地字节流，字节流满时其余的留在共享队列中
+static void tIpcDrainBytes(tIpcEndpoint * ep, tIpcByteRing * ring) {
+    uint32_t tail = ring->tail;
+    uint32_t count;
+
+    __DMB();
+    count = ring->head - tail;
+    while (count > 0) {
+        uint32_t offset = tail & (TINYOS_IPC_BYTE_SIZE - 1);
+        uint32_t chunk = TINYOS_IPC_BYTE_SIZE - offset;
+        uint32_t done;
+
+        chunk = (count < chunk) ? count : chunk;
+        done = tStreamWriteFromISR(ep->rxStream, &ring->data[offset], chunk);
+        tail += done;
+        count -= done;
+        ep->rxBytes += done;
+        if (done < chunk) {
+            break;
+        }
+    }
+    __DMB();
+    ring->tail = tail;
+}
+
+/**
+ * @brief 把对端发来的消息、归还的缓冲区及字节转入本地的邮箱及字节流，唤醒在上面等待的任务。
+ *
+ * 在门铃中断中调用，也可在任务中调用(如本地字节流被读出之后)；本侧的多个调用者之间用临界区互斥，
+ * 共享队列的读索引只由这里修改。
+ *
+ * @param ep  本侧的端点。
+ *
+ * @return void
+ */
+void tIpcPoll(tIpcEndpoint * ep) {
+    tIpcOutbox * in = &ep->shared->outbox[ep->side ^ 1];
+    uint32_t status = tTaskEnterCritical();
+
+    tIpcDrainMsg(&in->msg, ep->rxMbox, &ep->rxMsgs);
+    tIpcDrainMsg(&in->release, ep->releaseMbox, (uint32_t *)0);
+    if (ep->rxStream) {
+        tIpcDrainBytes(ep, &in->bytes);
+    }
+    tTaskExitCritical(status);
+}
+
+#endif
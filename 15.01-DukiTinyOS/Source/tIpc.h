@@ -0,0 +1,60 @@
+#ifndef __TIPC_H
+#define __TIPC_H
+
+#include "tMbox.h"
+#include "tStream.h"
+
+// 处理器间通道：两个处理器(如STM32H7的M7与M4核)各运行一份tinyOS，经共享内存中的tIpcShared交换数据。
+// 每侧有一个发件区，其中的消息队列、归还队列及字节队列都是单生产者/单消费者的环形队列，只由本侧写入、对端读取，
+// 索引自由递增，用内存屏障保证数据先于索引可见，两核之间不需要锁；写入后调用门铃函数通知对端
+// (如H7的硬件信号量释放中断、SEV或外部中断)，对端在门铃中断中调用tIpcPoll，把收到的消息及字节转入本地的
+// 邮箱及字节流，之后按普通的tMboxWait/tStreamRead接收，任务不需要知道数据来自另一个处理器。
+// 消息为指针，只传递不复制：缓冲区应位于两核地址相同的共享内存中，接收方用完后tIpcRelease归还，
+// 发送方的归还邮箱收到后即可重用，日志、遥测数据可以在控制核上填好后整块交给另一核处理。
+// tIpcShared及消息缓冲区须放在不经数据缓存的区域(CM7用MPU设为Non-cacheable、Shareable)，内核不做缓存维护
+typedef struct _tIpcMsgRing {
+	volatile uint32_t head;                     //写索引，只由发送侧修改
+	volatile uint32_t tail;                     //读索引，只由接收侧修改
+	void * volatile slot[TINYOS_IPC_MSG_SLOTS];
+}tIpcMsgRing;
+
+typedef struct _tIpcByteRing {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint8_t data[TINYOS_IPC_BYTE_SIZE];
+}tIpcByteRing;
+
+// 一侧的发件区
+typedef struct _tIpcOutbox {
+	tIpcMsgRing msg;                            //发给对端的消息
+	tIpcMsgRing release;                        //归还对端发来的消息
+	tIpcByteRing bytes;                         //发给对端的字节流
+}tIpcOutbox;
+
+// 共享内存中的通道，由先启动的一侧在另一侧启动前tIpcSharedInit
+typedef struct _tIpcShared {
+	tIpcOutbox outbox[2];                       //按侧号(0/1)索引
+}tIpcShared;
+
+// 一侧的端点，位于本侧的内存中
+typedef struct _tIpcEndpoint {
+	tIpcShared * shared;
+	uint32_t side;                              //本侧的侧号
+	tMbox * rxMbox;                             //收到的消息，可为0
+	tMbox * releaseMbox;                        //对端归还的消息缓冲区，可为0(丢弃)
+	tStream * rxStream;                         //收到的字节流，可为0
+	void (*doorbell)(void * arg);               //通知对端，在临界区外调用
+	void * doorbellArg;
+	uint32_t txFull;                            //队列满而发送失败的次数
+	uint32_t rxMsgs;                            //转入邮箱的消息数
+	uint32_t rxBytes;                           //转入字节流的字节数
+}tIpcEndpoint;
+
+void tIpcSharedInit(tIpcShared * shared);
+void tIpcInit(tIpcEndpoint * ep, tIpcShared * shared, uint32_t side, tMbox * rxMbox, tMbox * releaseMbox,
+		tStream * rxStream, void (*doorbell)(void * arg), void * doorbellArg);
+uint32_t tIpcSend(tIpcEndpoint * ep, void * msg);
+uint32_t tIpcRelease(tIpcEndpoint * ep, void * msg);
+uint32_t tIpcWrite(tIpcEndpoint * ep, const void * data, uint32_t len);
+void tIpcPoll(tIpcEndpoint * ep);
+#endif
@@ -0,0 +1,100 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_IRQ_THREAD == 1
+/**
+ * @brief 初始化中断线程。
+ * 
+ * @param thread    指向中断线程的指针。
+ * @param task      绑定的任务，应为较高优先级的任务。
+ * @param irq       绑定的IRQn，ack为0时用于屏蔽及重新开启该中断；在已有的中断服务函数中调用tIrqThreadDispatch
+ *                  且外设标志已由其清除时可为-1。
+ * @param ack       在中断中清除外设中断标志的函数，为0时按irq屏蔽中断，由任务清除标志后再次等待时开启。
+ * 
+ * @return void
+ */
+void tIrqThreadInit(tIrqThread * thread, tTask * task, int32_t irq, void (*ack)(void)) {
+    thread->task = task;
+    thread->irq = irq;
+    thread->ack = ack;
+    thread->pending = 0;
+    thread->count = 0;
+}
+
+/**
+ * @brief 中断线程的上半部，由TINYOS_IRQ_THREAD_HANDLER定义的向量或中断服务函数调用。
+ * 
+ * 清除或屏蔽中断源，等待中的任务直接加入就绪表，由tTaskSchedPreempt决定是否立即切换，不需要tIntEnter/tIntExit。
+ * 
+ * @param thread    指向中断线程的指针。
+ * 
+ * @return void
+ */
+TINYOS_FAST_CODE void tIrqThreadDispatch(tIrqThread * thread) {
+    tTask * task = thread->task;
+    uint32_t status;
+
+    if (thread->ack != (void (*)(void))0) {
+        thread->ack();
+    }
+#ifndef TINYOS_PORT_POSIX
+    else if (thread->irq >= 0) {
+        NVIC_DisableIRQ((IRQn_Type)thread->irq);
+    }
+#endif
+
+    status = tTaskEnterCritical();
+    thread->pending++;
+    thread->count++;
+    if (task->state & TINYOS_TASK_STATE_IRQ_WAIT) {
+        task->state &= ~TINYOS_TASK_STATE_IRQ_WAIT;
+        if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+            tTimeTaskTimeoutCancel(task);
+        }
+        tTaskSchedRdy(task);
+        tTaskSchedPreempt(task);
+    }
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 绑定的任务等待中断，即驱动的下半部在每次处理完后调用。
+ * 
+ * 屏蔽模式下先清除NVIC中的挂起位再开启中断：屏蔽期间外设仍保持请求时会立即再次挂起，已由下半部处理的请求不会重复进入。
+ * 
+ * @param thread     指向中断线程的指针。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  上次取走至今的中断次数，超时返回0。
+ */
+uint32_t tIrqThreadWait(tIrqThread * thread, uint32_t waitTicks) {
+    uint32_t pending;
+    uint32_t status;
+
+#ifndef TINYOS_PORT_POSIX
+    if ((thread->ack == (void (*)(void))0) && (thread->irq >= 0)) {
+        NVIC_ClearPendingIRQ((IRQn_Type)thread->irq);
+        NVIC_EnableIRQ((IRQn_Type)thread->irq);
+    }
+#endif
+
+    status = tTaskEnterCritical();
+    if (thread->pending == 0) {
+        curTask->state |= TINYOS_TASK_STATE_IRQ_WAIT;
+        tTaskSchedUnRdy(curTask);
+        if (waitTicks) {
+            tTimeTaskTimeoutStart(curTask, waitTicks);
+        }
+        tTaskExitCritical(status);
+
+        tTaskSched();
+
+        // 超时唤醒时超时处理已清除等待标志
+        status = tTaskEnterCritical();
+    }
+    pending = thread->pending;
+    thread->pending = 0;
+    tTaskExitCritical(status);
+    return pending;
+}
+#endif
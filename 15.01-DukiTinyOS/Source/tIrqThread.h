@@ -0,0 +1,30 @@
+#ifndef __TIRQTHREAD_H
+#define __TIRQTHREAD_H
+#include <stdint.h>
+
+struct _tTask;
+
+// 中断线程：中断与一个任务绑定，中断服务函数直接把等待中的任务加入就绪表，
+// 比已选定的下一任务优先级高时直接作为nextTask挂起PendSV，不经过事件对象的等待队列，也不查找就绪位图；
+// 驱动的下半部在任务中按任务优先级执行
+typedef struct _tIrqThread {
+	struct _tTask * task;            //绑定的任务，只有它可以调用tIrqThreadWait
+	int32_t irq;                     //IRQn，为负数时不操作NVIC
+	void (*ack)(void);               //中断中清除外设中断标志，为0时在NVIC中屏蔽该中断，直到任务再次等待
+	volatile uint32_t pending;       //尚未被任务取走的中断次数
+	uint32_t count;                  //累计中断次数
+}tIrqThread;
+
+/**
+ * TINYOS_IRQ_THREAD_HANDLER（handler：中断向量名，thread：中断线程）
+ * 定义直接放入向量表的中断服务函数，例如TINYOS_IRQ_THREAD_HANDLER(EXTI2_IRQHandler, imuThread)
+ */
+#define TINYOS_IRQ_THREAD_HANDLER(handler, thread) \
+	void handler(void) { \
+		tIrqThreadDispatch(&(thread)); \
+	}
+
+void tIrqThreadInit(tIrqThread * thread, struct _tTask * task, int32_t irq, void (*ack)(void));
+void tIrqThreadDispatch(tIrqThread * thread);
+uint32_t tIrqThreadWait(tIrqThread * thread, uint32_t waitTicks);
+#endif
@@ -0,0 +1,173 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_JOB == 1
+static tList tJobReadyList[TINYOS_PRIO_COUNT];
+static tBitMap tJobReadyBitmap;
+static tTask tJobTask;
+static tTaskStack tJobTaskStack[TINYOS_JOBTASK_STACK_SIZE];
+//分派任务没有作业可执行时不在就绪队列中
+static uint32_t tJobTaskIdle;
+
+//修改分派任务的优先级，就绪时需调整其在就绪表中的位置，需在临界区内调用
+static void tJobTaskSetPrio(uint32_t prio) {
+    if (tJobTask.prio == prio) {
+        return;
+    }
+    if (!tJobTaskIdle) {
+        tTaskSchedUnRdy(&tJobTask);
+    }
+    tJobTask.prio = prio;
+#if TINYOS_ENABLE_MUTEX == 1
+    tJobTask.basePrio = prio;
+#endif
+    if (!tJobTaskIdle) {
+        tTaskSchedRdy(&tJobTask);
+    }
+}
+
+/**
+ * @brief 初始化作业。
+ * 
+ * @param job       指向作业的指针。
+ * @param func      作业函数，执行时不能阻塞。
+ * @param arg       传给作业函数的参数。
+ * @param prio      优先级，与任务优先级使用同一范围。
+ * 
+ * @return void
+ */
+void tJobInit(tJob * job, void (*func) (void * arg), void * arg, uint32_t prio) {
+    tNodeInit(&job->node);
+    job->func = func;
+    job->arg = arg;
+    job->prio = prio;
+    job->pending = 0;
+    job->runCount = 0;
+}
+
+//投递的公共部分，需在临界区内调用，返回1表示需要调度
+static uint32_t tJobReady(tJob * job) {
+    if (job->pending) {
+        return 0;
+    }
+    job->pending = 1;
+    tListAddLast(&tJobReadyList[job->prio], &job->node);
+    tBitMapSet(&tJobReadyBitmap, job->prio);
+
+    if (tJobTaskIdle) {
+        tJobTask.prio = job->prio;
+#if TINYOS_ENABLE_MUTEX == 1
+        tJobTask.basePrio = job->prio;
+#endif
+        tJobTaskIdle = 0;
+        tJobTask.state &= ~TINYOS_TASK_STATE_SUSPEND;
+        tTaskSchedRdy(&tJobTask);
+    } else if (job->prio < tJobTask.prio) {
+        tJobTaskSetPrio(job->prio);
+    } else {
+        return 0;
+    }
+    return tJobTask.prio < curTask->prio;
+}
+
+/**
+ * @brief 投递作业，作业已在就绪队列中时不重复加入。
+ * 
+ * @param job       指向作业的指针。
+ * 
+ * @return void
+ */
+void tJobPost(tJob * job) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tJobReady(job);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 在中断服务函数中投递作业，由tIntExit统一调度。
+ * 
+ * @param job       指向作业的指针。
+ * 
+ * @return void
+ */
+void tJobPostFromISR(tJob * job) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tJobReady(job);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+}
+
+/**
+ * @brief 可直接作为软定时器回调的投递函数，arg为要投递的作业。
+ * 
+ * @return void
+ */
+void tJobPostCallback(void * job) {
+    tJobPost((tJob *)job);
+}
+
+//作业分派任务：每次取优先级最高的作业运行至完成，期间优先级更高的任务照常抢占
+static void tJobTaskEntry(void * param) {
+    for (;;) {
+        tJob * job;
+        uint32_t prio;
+        uint32_t status = tTaskEnterCritical();
+
+        prio = tBitMapGetFirstSet(&tJobReadyBitmap);
+        if (prio >= tBitMapPosCount()) {
+            // 没有作业，退出就绪队列，下次投递时恢复
+            tJobTaskIdle = 1;
+            tJobTask.state |= TINYOS_TASK_STATE_SUSPEND;
+            tTaskSchedUnRdy(&tJobTask);
+            tTaskExitCritical(status);
+            tTaskSched();
+            continue;
+        }
+
+        // 降到下一个作业的优先级后，可能有更高优先级的任务需要先运行
+        if (prio != tJobTask.prio) {
+            tJobTaskSetPrio(prio);
+            tTaskExitCritical(status);
+            tTaskSched();
+            continue;
+        }
+
+        job = tNodeParent(tListRemoveFirst(&tJobReadyList[prio]), tJob, node);
+        if (tListCount(&tJobReadyList[prio]) == 0) {
+            tBitMapClear(&tJobReadyBitmap, prio);
+        }
+        job->pending = 0;
+        job->runCount++;
+        tTaskExitCritical(status);
+
+        job->func(job->arg);
+    }
+}
+
+/**
+ * @brief 初始化作业模块并创建作业分派任务，在空闲任务中与tTimerInitTask一同调用。
+ * 
+ * @return void
+ */
+void tJobInitTask(void) {
+    uint32_t i;
+
+    for (i = 0; i < TINYOS_PRIO_COUNT; i++) {
+        tListInit(&tJobReadyList[i]);
+    }
+    tBitMapInit(&tJobReadyBitmap);
+
+    tTaskInit(&tJobTask, tJobTaskEntry, (void *)0, TINYOS_PRIO_COUNT - 2, tJobTaskStack, sizeof(tJobTaskStack));
+    tJobTaskIdle = 0;
+}
+#endif
@@ -0,0 +1,23 @@
+#ifndef __TJOB_H
+#define __TJOB_H
+
+#include "tLib.h"
+
+// 运行至完成的作业：不能在函数中途阻塞，所有作业共用作业分派任务的一个栈
+// 分派任务的优先级随就绪作业中最高的优先级变化，与普通任务在同一优先级位图中竞争；
+// 作业之间不互相抢占，正在运行的作业完成后才切换到更高优先级的作业
+typedef struct _tJob {
+	tNode node;                      //挂在对应优先级的就绪作业队列中
+	void (*func) (void * arg);
+	void * arg;
+	uint32_t prio;
+	uint32_t pending;                //1表示已在就绪队列中，重复投递只执行一次
+	uint32_t runCount;
+}tJob;
+
+void tJobInit(tJob * job, void (*func) (void * arg), void * arg, uint32_t prio);
+void tJobPost(tJob * job);
+void tJobPostFromISR(tJob * job);
+void tJobPostCallback(void * job);
+void tJobInitTask(void);
+#endif
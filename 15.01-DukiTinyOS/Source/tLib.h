@@ -2,9 +2,22 @@
 #define __TLIB_H
 
 #include <stdint.h>
+#include "tConfig.h"
+
+//两级位图：每个组字管理32个优先级，组位图记录哪些组字非空
+#define TBITMAP_GROUP_COUNT ((TINYOS_PRIO_COUNT + 31) / 32)
+
+#if TBITMAP_GROUP_COUNT > 32
+#error "TINYOS_PRIO_COUNT must be less than or equal to 1024"
+#endif
 
 typedef struct _tBitMap {
+#if TBITMAP_GROUP_COUNT > 1
+	uint32_t groupMap;                       //组位图，第i位为1表示bitMap[i]非0
+	uint32_t bitMap[TBITMAP_GROUP_COUNT];
+#else
 	uint32_t bitMap;
+#endif
 }tBitMap;
 
 void tBitMapInit(tBitMap* bitMap);
@@ -12,6 +25,8 @@ uint32_t tBitMapPosCount(void);
 void tBitMapSet(tBitMap* bitMap,uint32_t pos);//对应位置1
 void tBitMapClear(tBitMap* bitMap,uint32_t pos);//对应位置0
 uint32_t tBitMapGetFirstSet(tBitMap* bitMap);//获取第一个为1的位
+uint32_t tBitMapGetFirstSetMasked(tBitMap* bitMap,tBitMap* mask);//获取同时在mask中为1的第一个位
+uint32_t tBitMapGetLastSetUpTo(tBitMap* bitMap,uint32_t pos);//获取序号不大于pos的最后一个为1的位
 
 //定义结点
 typedef struct _tNode {
@@ -24,8 +39,15 @@ typedef struct _tList {
 	uint32_t nodeCount;
 }tList;
 
+//静态定义时的初始值，与tNodeInit/tListInit的结果相同：结点及空链表的头结点指向自身
+#define TINYOS_NODE_INITIALIZER(node)   {&(node), &(node)}
+#define TINYOS_LIST_INITIALIZER(list)   {TINYOS_NODE_INITIALIZER((list).headNode), 0}
+
 //链表相关函数
-#define tNodeParent(node, parent, name) (parent *)((uint32_t)node - (uint32_t)&((parent *)0)->name) //?
+#define tNodeParent(node, parent, name) (parent *)((uintptr_t)node - (uintptr_t)&((parent *)0)->name) //?
+#if TINYOS_ENABLE_LIST_INLINE == 1
+#include "tListInline.h"
+#else
 void tNodeInit(tNode * node) ;
 void tListInit(tList * list) ;
 uint32_t tListCount(tList * list) ;
@@ -39,5 +61,9 @@ void tListAddLast(tList * list, tNode * node) ;
 tNode * tListRemoveFirst(tList * list) ;
 void tListInsertAfter(tList * list, tNode * nodeAfter, tNode * nodeToInsert) ;
 void tListRemove(tList * list,tNode * node);
+//不维护nodeCount的结点摘除/插入，仅用于结点在同一链表内移动位置(结点数不变)的场合
+void tNodeUnlink(tNode * node);
+void tNodeLinkAfter(tNode * nodeAfter, tNode * nodeToInsert);
+#endif
 #endif
 
@@ -1,5 +1,8 @@
 #include "tLib.h"
 
+//启用内联链表时所有函数由tListInline.h提供
+#if TINYOS_ENABLE_LIST_INLINE == 0
+
 /**
  * @brief 初始化链表结点
  * 
@@ -234,3 +237,37 @@ void tListRemove(tList * list, tNode * node) {
     node->preNode->nextNode = node->nextNode; // 将上一个结点的后指针指向当前结点的后结点
     list->nodeCount--;                         // 减少结点计数
 }
+
+/**
+ * @brief 摘除结点，不维护结点计数
+ * 
+ * 与tListRemove相同，但不修改nodeCount，用于结点在同一链表内移动位置的场合，
+ * 需与tNodeLinkAfter配对使用。
+ * 
+ * @param node 要摘除的结点
+ * 
+ * @return void
+ */
+void tNodeUnlink(tNode * node) {
+    node->nextNode->preNode = node->preNode;
+    node->preNode->nextNode = node->nextNode;
+}
+
+/**
+ * @brief 在指定结点后插入结点，不维护结点计数
+ * 
+ * 与tListInsertAfter相同，但不修改nodeCount，只能用于插入先前由tNodeUnlink从同一链表摘除的结点。
+ * 
+ * @param nodeAfter 插入位置的参考结点
+ * @param nodeToInsert 要插入的结点
+ * 
+ * @return void
+ */
+void tNodeLinkAfter(tNode * nodeAfter, tNode * nodeToInsert) {
+    nodeToInsert->nextNode = nodeAfter->nextNode;
+    nodeToInsert->preNode = nodeAfter;
+
+    nodeAfter->nextNode = nodeToInsert;
+    nodeToInsert->nextNode->preNode = nodeToInsert;
+}
+#endif
@@ -0,0 +1,130 @@
+#ifndef __TLISTINLINE_H
+#define __TLISTINLINE_H
+
+/**
+ * 链表操作的内联实现，TINYOS_ENABLE_LIST_INLINE为1时由tLib.h包含，替代tList.c中的同名函数。
+ * 就绪队列、事件等待队列和延时队列的操作都在临界区和节拍中断内，内联后省去函数调用和参数搬运的开销，
+ * 代价是代码体积增大。接口和行为与tList.c完全一致，调用者无需修改。
+ */
+
+static __inline void tNodeInit(tNode * node) {
+    node->preNode = node;
+    node->nextNode = node;
+}
+
+static __inline void tListInit(tList * list) {
+    list->headNode.nextNode = &(list->headNode);
+    list->headNode.preNode = &(list->headNode);
+    list->nodeCount = 0;
+}
+
+static __inline uint32_t tListCount(tList * list) {
+    return list->nodeCount;
+}
+
+static __inline tNode * tListFirst(tList * list) {
+    tNode * node = (tNode *)0;
+    if (list->nodeCount != 0) {
+        node = list->headNode.nextNode;
+    }
+    return node;
+}
+
+static __inline tNode * tListLast(tList * list) {
+    tNode * node = (tNode *)0;
+    if (list->nodeCount != 0) {
+        node = list->headNode.preNode;
+    }
+    return node;
+}
+
+static __inline tNode * tListPre(tList * list, tNode * node) {
+    if (node->preNode == node) {
+        return (tNode *)0;
+    }
+    return node->preNode;
+}
+
+static __inline tNode * tListNext(tList * list, tNode * node) {
+    if (node->nextNode == node) {
+        return (tNode *)0;
+    }
+    return node->nextNode;
+}
+
+static __inline void tListRemoveAll(tList * list) {
+    uint32_t i;
+    tNode * nextNode = list->headNode.nextNode;
+
+    for (i = list->nodeCount; i > 0; i--) {
+        tNode * curNode = nextNode;
+        nextNode = nextNode->nextNode;
+
+        curNode->nextNode = curNode;
+        curNode->preNode = curNode;
+    }
+
+    list->headNode.nextNode = &(list->headNode);
+    list->headNode.preNode = &(list->headNode);
+    list->nodeCount = 0;
+}
+
+static __inline void tListAddFirst(tList * list, tNode * node) {
+    node->nextNode = list->headNode.nextNode;
+    node->preNode = &(list->headNode);
+
+    list->headNode.nextNode->preNode = node;
+    list->headNode.nextNode = node;
+    list->nodeCount++;
+}
+
+static __inline void tListAddLast(tList * list, tNode * node) {
+    node->nextNode = &(list->headNode);
+    node->preNode = list->headNode.preNode;
+
+    list->headNode.preNode->nextNode = node;
+    list->headNode.preNode = node;
+    list->nodeCount++;
+}
+
+static __inline tNode * tListRemoveFirst(tList * list) {
+    tNode * node = (tNode *)0;
+    if (list->nodeCount != 0) {
+        node = list->headNode.nextNode;
+
+        node->nextNode->preNode = &(list->headNode);
+        list->headNode.nextNode = node->nextNode;
+        list->nodeCount--;
+    }
+    return node;
+}
+
+static __inline void tListInsertAfter(tList * list, tNode * nodeAfter, tNode * nodeToInsert) {
+    nodeToInsert->nextNode = nodeAfter->nextNode;
+    nodeToInsert->preNode = nodeAfter;
+
+    nodeAfter->nextNode = nodeToInsert;
+    nodeToInsert->nextNode->preNode = nodeToInsert;
+    list->nodeCount++;
+}
+
+static __inline void tListRemove(tList * list, tNode * node) {
+    node->nextNode->preNode = node->preNode;
+    node->preNode->nextNode = node->nextNode;
+    list->nodeCount--;
+}
+
+static __inline void tNodeUnlink(tNode * node) {
+    node->nextNode->preNode = node->preNode;
+    node->preNode->nextNode = node->nextNode;
+}
+
+static __inline void tNodeLinkAfter(tNode * nodeAfter, tNode * nodeToInsert) {
+    nodeToInsert->nextNode = nodeAfter->nextNode;
+    nodeToInsert->preNode = nodeAfter;
+
+    nodeAfter->nextNode = nodeToInsert;
+    nodeToInsert->nextNode->preNode = nodeToInsert;
+}
+
+#endif
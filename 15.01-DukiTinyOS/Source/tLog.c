@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <string.h>
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_LOG == 1
+
+#if (TINYOS_LOG_BUFFER_SIZE & (TINYOS_LOG_BUFFER_SIZE - 1)) != 0
+#error "TINYOS_LOG_BUFFER_SIZE must be a power of 2"
+#endif
+
+static tLogRecord logBuffer[TINYOS_LOG_BUFFER_SIZE];
+static volatile uint32_t logWriteIndex;     // 下一条待分配的位置，只增不减
+static volatile uint32_t logReadIndex;      // 下一条待输出的位置，只由输出方修改
+static volatile uint32_t logDropped;
+
+static tTask logTask;
+static tTaskStack logTaskStack[TINYOS_LOG_STACK_SIZE];
+
+static const char logLevelName[] = "DIWE";
+
+// 初始化日志缓冲区，并启动时间戳所用的周期计数器
+void tLogInit (void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TINYOS_LOG_BUFFER_SIZE; i++)
+    {
+        logBuffer[i].info = 0;
+    }
+    logWriteIndex = 0;
+    logReadIndex = 0;
+    logDropped = 0;
+
+    tCycleCounterInit();
+}
+
+// 写入一条日志记录，由tLogDebug等宏调用，可在任务及中断中调用
+// 与tTraceWrite相同，用LDREX/STREX无锁地分配位置，不关中断；缓冲区满时丢弃新记录
+TINYOS_FAST_CODE void tLogWrite (uint32_t info, const char * fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    uint32_t index;
+    tLogRecord * record;
+
+    do
+    {
+        index = __LDREXW((uint32_t *)&logWriteIndex);
+        if (index - logReadIndex >= TINYOS_LOG_BUFFER_SIZE)
+        {
+            __CLREX();
+            logDropped++;
+            return;
+        }
+    } while (__STREXW(index + 1, (uint32_t *)&logWriteIndex) != 0);
+
+    record = &logBuffer[index & (TINYOS_LOG_BUFFER_SIZE - 1)];
+    record->timestamp = tCycleCounterGet();
+    record->fmt = fmt;
+    record->args[0] = a0;
+    record->args[1] = a1;
+    record->args[2] = a2;
+    record->args[3] = a3;
+    record->info = ((uint32_t)TINYOS_LOG_SYNC << 24) | info;
+}
+
+// 将已完整写入的记录原样交给output输出，由主机解码，最多输出maxCount条，返回实际输出的条数
+// 与tLogPrint一样只允许在一个低优先级任务中调用
+uint32_t tLogDrain (void (*output)(const uint8_t * data, uint32_t len), uint32_t maxCount)
+{
+    uint32_t count = 0;
+
+    while ((count < maxCount) && (logReadIndex != logWriteIndex))
+    {
+        tLogRecord * record = &logBuffer[logReadIndex & (TINYOS_LOG_BUFFER_SIZE - 1)];
+
+        // 位置已分配但写入者被打断，尚未写完，下次再输出
+        if (record->info == 0)
+        {
+            break;
+        }
+
+        output((const uint8_t *)record, sizeof(tLogRecord));
+        record->info = 0;
+        logReadIndex++;
+        count++;
+    }
+
+    return count;
+}
+
+// 按格式串输出一条记录：逐个转换说明单独调用tPrintf，浮点参数按位还原，长度修饰符忽略；
+// 不调用带%f的printf，目标板上不链接libc的浮点格式化
+static void tLogFormat (const tLogRecord * record)
+{
+    const char * p = record->fmt;
+    uint32_t argc = (record->info >> 8) & 0xFF;
+    uint32_t argIndex = 0;
+    char spec[16];
+    uint32_t len;
+
+    tPrintf("[%10lu] %c ", (unsigned long)record->timestamp, logLevelName[(record->info >> 16) & 0x3]);
+
+    while (*p != '\0')
+    {
+        uint32_t arg;
+
+        if (*p != '%')
+        {
+            putchar(*p++);
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+
+        // 复制标志、宽度及精度，直到转换字符
+        len = 0;
+        spec[len++] = *p++;
+        while ((*p != '\0') && (strchr("diouxXcsfFeEgGp", *p) == 0))
+        {
+            if ((*p != 'l') && (*p != 'h') && (len < sizeof(spec) - 2))
+            {
+                spec[len++] = *p;
+            }
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        spec[len++] = *p;
+        spec[len] = '\0';
+
+        arg = (argIndex < argc) ? record->args[argIndex] : 0;
+        argIndex++;
+        switch (*p++)
+        {
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+            {
+                union
+                {
+                    uint32_t u;
+                    float f;
+                } v;
+
+                v.u = arg;
+                tPrintf(spec, (double)v.f);
+                break;
+            }
+            case 's':
+                tPrintf(spec, (const char *)(uintptr_t)arg);
+                break;
+            case 'p':
+                tPrintf("0x%08lx", (unsigned long)arg);
+                break;
+            case 'd': case 'i': case 'c':
+                tPrintf(spec, (int)arg);
+                break;
+            default:
+                tPrintf(spec, (unsigned int)arg);
+                break;
+        }
+    }
+    putchar('\n');
+}
+
+// 在目标上格式化输出已完整写入的记录，最多输出maxCount条，返回实际输出的条数
+uint32_t tLogPrint (uint32_t maxCount)
+{
+    uint32_t count = 0;
+
+    while ((count < maxCount) && (logReadIndex != logWriteIndex))
+    {
+        tLogRecord * record = &logBuffer[logReadIndex & (TINYOS_LOG_BUFFER_SIZE - 1)];
+
+        if (record->info == 0)
+        {
+            break;
+        }
+
+        tLogFormat(record);
+        record->info = 0;
+        logReadIndex++;
+        count++;
+    }
+
+    return count;
+}
+
+// 查询日志缓冲区状态
+void tLogGetInfo (tLogInfo * info)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    info->size = TINYOS_LOG_BUFFER_SIZE;
+    info->pending = logWriteIndex - logReadIndex;
+    info->dropped = logDropped;
+
+    tTaskExitCritical(status);
+}
+
+#if TINYOS_LOG_OUTPUT_RAW == 1
+static void tLogStdoutOutput (const uint8_t * data, uint32_t len)
+{
+    fwrite(data, 1, len, stdout);
+}
+#endif
+
+// 日志任务：每TINYOS_LOG_PERIOD_TICKS个节拍取出缓冲区中的记录，格式化后经printf输出，或原样输出(stdout或RTT日志通道)由主机解码
+static void tLogTaskEntry (void * param)
+{
+    for (;;)
+    {
+#if TINYOS_LOG_OUTPUT_RAW == 2
+        while (tLogDrain(tRttLogOutput, TINYOS_LOG_BUFFER_SIZE) > 0)
+#elif TINYOS_LOG_OUTPUT_RAW == 1
+        while (tLogDrain(tLogStdoutOutput, TINYOS_LOG_BUFFER_SIZE) > 0)
+#else
+        while (tLogPrint(TINYOS_LOG_BUFFER_SIZE) > 0)
+#endif
+        {
+            ;
+        }
+        tTaskDelay(TINYOS_LOG_PERIOD_TICKS);
+    }
+}
+
+// 创建日志任务，在空闲任务中与其它内核任务一同创建
+void tLogInitTask (void)
+{
+#if TINYOS_LOG_PRIO >= (TINYOS_PRIO_COUNT - 1)
+    #error "TINYOS_LOG_PRIO must be higher than the idle task"
+#endif
+    tTaskInit(&logTask, tLogTaskEntry, (void *)0, TINYOS_LOG_PRIO, logTaskStack, sizeof(logTaskStack));
+    tObjectSetName(&logTask.object, "log");
+}
+
+#endif
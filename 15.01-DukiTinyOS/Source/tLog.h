@@ -0,0 +1,99 @@
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <stdint.h>
+#include "tConfig.h"
+
+// 二进制日志：调用处只记录格式串地址与原始参数，格式化推迟到低优先级的日志任务或主机上进行
+// 格式串必须为字符串常量，参数最多TINYOS_LOG_ARGS_MAX个，均按32位保存：
+// 整数直接传入，浮点数需用tLogFloat()转换，%s只能指向常量字符串
+// 低于TINYOS_LOG_LEVEL的调用在编译时去掉，参数不会被求值
+
+#define TINYOS_LOG_LEVEL_DEBUG      0
+#define TINYOS_LOG_LEVEL_INFO       1
+#define TINYOS_LOG_LEVEL_WARN       2
+#define TINYOS_LOG_LEVEL_ERROR      3
+
+#define TINYOS_LOG_ARGS_MAX         4
+
+// 日志记录的帧同步字节，位于每条记录最后一个字的最高字节
+#define TINYOS_LOG_SYNC             0x5A
+
+// 一条日志记录，共28字节，按小端顺序原样输出：
+// [0..3] CYCCNT时间戳  [4..7] 格式串地址  [8..23] 参数  [24] 保留  [25] 参数个数  [26] 级别  [27] 同步字节0x5A
+typedef struct _tLogRecord
+{
+    uint32_t timestamp;
+    const char * fmt;
+    uint32_t args[TINYOS_LOG_ARGS_MAX];
+    // 参数个数、级别与同步字节合并为一个字，最后写入，非0表示记录已完整
+    volatile uint32_t info;
+}tLogRecord;
+
+// 日志缓冲区状态信息
+typedef struct _tLogInfo
+{
+    // 缓冲区容量（记录数）
+    uint32_t size;
+
+    // 等待输出的记录数
+    uint32_t pending;
+
+    // 缓冲区满而丢弃的记录数
+    uint32_t dropped;
+}tLogInfo;
+
+// 浮点参数按位保存，格式化时按%f/%e/%g还原
+static __inline uint32_t tLogFloat (float value)
+{
+    union
+    {
+        float f;
+        uint32_t u;
+    } v;
+
+    v.f = value;
+    return v.u;
+}
+
+// 统计格式串之后的参数个数，并把参数补足为TINYOS_LOG_ARGS_MAX个；超过4个(8个以内)时展开为未定义的标识符，编译报错
+#define tLogArgc(...)                           tLogArgc_(__VA_ARGS__, tLogTooManyArgs, tLogTooManyArgs, tLogTooManyArgs, tLogTooManyArgs, 4, 3, 2, 1, 0, 0)
+#define tLogArgc_(fmt, a, b, c, d, e, f, g, h, n, ...)  n
+#define tLogArgs(...)                           tLogArgs_(__VA_ARGS__, 0, 0, 0, 0, 0)
+#define tLogArgs_(fmt, a, b, c, d, ...)         (fmt), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+
+#define tLogLevelWrite(level, ...)  \
+    tLogWrite(((uint32_t)(level) << 16) | ((uint32_t)tLogArgc(__VA_ARGS__) << 8), tLogArgs(__VA_ARGS__))
+
+#if (TINYOS_ENABLE_LOG == 1) && (TINYOS_LOG_LEVEL <= TINYOS_LOG_LEVEL_DEBUG)
+#define tLogDebug(...)              tLogLevelWrite(TINYOS_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define tLogDebug(...)              ((void)0)
+#endif
+
+#if (TINYOS_ENABLE_LOG == 1) && (TINYOS_LOG_LEVEL <= TINYOS_LOG_LEVEL_INFO)
+#define tLogInfo(...)               tLogLevelWrite(TINYOS_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define tLogInfo(...)               ((void)0)
+#endif
+
+#if (TINYOS_ENABLE_LOG == 1) && (TINYOS_LOG_LEVEL <= TINYOS_LOG_LEVEL_WARN)
+#define tLogWarn(...)               tLogLevelWrite(TINYOS_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define tLogWarn(...)               ((void)0)
+#endif
+
+#if (TINYOS_ENABLE_LOG == 1) && (TINYOS_LOG_LEVEL <= TINYOS_LOG_LEVEL_ERROR)
+#define tLogError(...)              tLogLevelWrite(TINYOS_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define tLogError(...)              ((void)0)
+#endif
+
+void tLogInit (void);
+void tLogWrite (uint32_t info, const char * fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+uint32_t tLogDrain (void (*output)(const uint8_t * data, uint32_t len), uint32_t maxCount);
+uint32_t tLogPrint (uint32_t maxCount);
+void tLogGetInfo (tLogInfo * info);
+void tLogInitTask (void);
+
+#endif /* TLOG_H */
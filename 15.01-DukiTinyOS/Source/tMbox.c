@@ -14,14 +14,63 @@
  */
 void tMboxInit(tMbox * mbox, void ** msgBuffer, uint32_t maxCount) {
     tEventInit(&mbox->event, tEventTypeMbox);  // 初始化事件为邮箱类型
+    tRegistryAdd(&mbox->event.object, tObjectTypeEvent);
 
     mbox->msgBuffer = msgBuffer;    // 设置消息缓冲区
     mbox->maxCount = maxCount;      // 设置最大消息容量
     mbox->count = 0;                // 初始化当前消息数
     mbox->read = 0;                 // 初始化读取指针
     mbox->write = 0;                // 初始化写入指针
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    mbox->latest = 0;
+#endif
 }
 
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+/**
+ * @brief 以最新值模式初始化邮箱。
+ * 
+ * 邮箱只保存最近一次发送的消息，发送总是成功并覆盖旧消息，不会积压过时的数据；读取不取走消息，
+ * 多个读者都得到最新的消息，只在第一次发送前阻塞。适合只关心最新样本的消费者，
+ * 例如控制回路读取姿态、遥测读取遥控输入。消息是指针，发送者应交替写入两个缓冲区或使用tSeqLock，
+ * 不要改写读者可能仍在使用的数据。
+ * 
+ * @param mbox        指向要初始化的邮箱结构体的指针。
+ * 
+ * @return void
+ */
+void tMboxInitLatest(tMbox * mbox) {
+    tMboxInit(mbox, &mbox->latestMsg, 1);
+    mbox->latest = 1;
+    mbox->version = 0;
+    mbox->latestMsg = (void *)0;
+}
+
+/**
+ * @brief 不阻塞地读取最新值模式邮箱中的消息。
+ * 
+ * @param mbox        指向邮箱结构体的指针。
+ * @param msg         用于存放最新消息的指针。
+ * @param version     不为0时存放已发送的次数，与上次读取的值相同说明没有新消息。
+ * 
+ * @return uint32_t   `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示还没有发送过消息。
+ */
+uint32_t tMboxGetLatest(tMbox * mbox, void ** msg, uint32_t * version) {
+    uint32_t err = tErrorResourceUnavaliable;
+    uint32_t status = tTaskEnterCritical();
+
+    if (mbox->count > 0) {
+        *msg = mbox->latestMsg;
+        err = tErrorNoError;
+    }
+    if (version) {
+        *version = mbox->version;
+    }
+    tTaskExitCritical(status);
+    return err;
+}
+#endif
+
 /**
  * @brief 阻塞式获取邮箱消息。
  * 
@@ -35,7 +84,15 @@ void tMboxInit(tMbox * mbox, void ** msgBuffer, uint32_t maxCount) {
  */
 uint32_t tMboxWait(tMbox * mbox, void ** msg, uint32_t waitTicks) {
     uint32_t status = tTaskEnterCritical();   // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventMboxWait, mbox, 0);
 
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    if (mbox->latest && (mbox->count > 0)) {  // 最新值模式读取不取走消息
+        *msg = mbox->latestMsg;
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+#endif
     if (mbox->count > 0) {  // 如果邮箱中有消息
         --mbox->count;   // 消息数减一
         *msg = mbox->msgBuffer[mbox->read++];  // 获取消息并更新读取指针
@@ -56,6 +113,77 @@ uint32_t tMboxWait(tMbox * mbox, void ** msg, uint32_t waitTicks) {
     }
 }
 
+//从邮箱中取出最多max条消息，需在临界区内调用
+static uint32_t tMboxTake(tMbox * mbox, void ** msgs, uint32_t max) {
+    uint32_t n = 0;
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    if (mbox->latest) {  // 最新值模式只有一条消息，读取不取走
+        if ((max > 0) && (mbox->count > 0)) {
+            msgs[n++] = mbox->latestMsg;
+        }
+        return n;
+    }
+#endif
+    while ((n < max) && (mbox->count > 0)) {
+        --mbox->count;
+        msgs[n++] = mbox->msgBuffer[mbox->read++];
+        if (mbox->read >= mbox->maxCount) {
+            mbox->read = 0;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief 批量获取邮箱消息。
+ * 
+ * 邮箱为空时阻塞等待第一条消息，之后在同一临界区内取走邮箱中已有的消息，最多max条，
+ * 适合一次唤醒处理一批消息的消费者。
+ * 
+ * @param mbox        指向邮箱结构体的指针。
+ * @param msgs        用于存放消息的数组。
+ * @param max         最多获取的消息数。
+ * @param waitTicks   等待的时间(以滴答为单位)，为0时一直等待。
+ * 
+ * @return uint32_t   获取到的消息数，超时或邮箱被删除时为0。
+ */
+uint32_t tMboxWaitN(tMbox * mbox, void ** msgs, uint32_t max, uint32_t waitTicks) {
+    uint32_t n;
+    uint32_t status;
+
+    if (max == 0) {
+        return 0;
+    }
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    if (mbox->latest) {  // 唤醒时得到的即是唯一的最新消息
+        max = 1;
+    }
+#endif
+
+    status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventMboxWait, mbox, max);
+
+    n = tMboxTake(mbox, msgs, max);
+    if (n == 0) {
+        tEventWait(&mbox->event, curTask, (void *)0, tEventTypeMbox, waitTicks);
+        tTaskExitCritical(status);
+
+        tTaskSched();
+
+        if (curTask->waitEventResult != tErrorNoError) {
+            return 0;
+        }
+
+        // 唤醒时直接得到一条消息，其余的从邮箱中取
+        status = tTaskEnterCritical();
+        msgs[0] = curTask->eventMsg;
+        n = 1 + tMboxTake(mbox, msgs + 1, max - 1);
+    }
+
+    tTaskExitCritical(status);
+    return n;
+}
+
 /**
  * @brief 非阻塞式获取邮箱消息。
  * 
@@ -69,6 +197,13 @@ uint32_t tMboxWait(tMbox * mbox, void ** msg, uint32_t waitTicks) {
 uint32_t tMboxNoWaitGet(tMbox * mbox, void ** msg) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    if (mbox->latest && (mbox->count > 0)) {  // 最新值模式读取不取走消息
+        *msg = mbox->latestMsg;
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+#endif
     if (mbox->count > 0) {  // 如果邮箱中有消息
         --mbox->count;  // 消息数减一
         *msg = mbox->msgBuffer[mbox->read++];  // 获取消息并更新读取指针
@@ -83,6 +218,49 @@ uint32_t tMboxNoWaitGet(tMbox * mbox, void ** msg) {
     }
 }
 
+//发送消息的公共部分，需在临界区内调用，唤醒了更高优先级的任务时将*sched置1
+static uint32_t tMboxPost(tMbox * mbox, void * msg, uint32_t notifyOption, uint32_t * sched) {
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+    if (mbox->latest) {
+        // 覆盖旧消息，等待第一条消息的任务全部唤醒并得到它，同时等待多个对象的任务一并唤醒
+        mbox->latestMsg = msg;
+        mbox->count = 1;
+        mbox->version++;
+        *sched = (tEventRemoveAll(&mbox->event, msg, tErrorNoError) > 0);
+        return tErrorNoError;
+    }
+#endif
+    // 如果有任务在等待邮箱
+    if (tEventWaitCount(&mbox->event) > 0) {
+        tTask * task = tEventWakeUp(&mbox->event, (void *)msg, tErrorNoError);  // 唤醒任务并传递消息
+        *sched = (task->prio < curTask->prio);
+        return tErrorNoError;
+    }
+
+    // 如果没有任务等待，检查邮箱是否已满
+    if (mbox->count >= mbox->maxCount) {
+        return tErrorResourceFull;  // 返回邮箱已满错误
+    }
+
+    // 根据 notifyOption 决定是将消息插入邮箱的头部还是尾部
+    if (notifyOption & tMboxSendFront) {
+        if (mbox->read <= 0) {
+            mbox->read = mbox->maxCount - 1;  // 如果读取指针为0，回绕到最后一个位置
+        } else {
+            --mbox->read;  // 向前移动读取指针
+        }
+        mbox->msgBuffer[mbox->read] = msg;  // 插入消息到头部
+    } else {
+        mbox->msgBuffer[mbox->write++] = msg;  // 插入消息到尾部并更新写入指针
+        if (mbox->write >= mbox->maxCount) {  // 如果写入指针越界，则回绕
+            mbox->write = 0;
+        }
+    }
+    mbox->count++;  // 增加消息计数
+    *sched = tEventMultiWakeUp(&mbox->event, tErrorNoError);
+    return tErrorNoError;
+}
+
 /**
  * @brief 通知邮箱中的等待任务并释放邮箱资源。
  * 
@@ -95,41 +273,69 @@ uint32_t tMboxNoWaitGet(tMbox * mbox, void ** msg) {
  * @return uint32_t   返回操作结果，`tErrorNoError` 表示成功，`tErrorResourceFull` 表示邮箱已满。
  */
 uint32_t tMboxNotify(tMbox * mbox, void * msg, uint32_t notifyOption) {
+    uint32_t err, sched = 0;
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventMboxNotify, mbox, 0);
 
-    // 如果有任务在等待邮箱
-    if (tEventWaitCount(&mbox->event) > 0) {
-        tTask * task = tEventWakeUp(&mbox->event, (void *)msg, tErrorNoError);  // 唤醒任务并传递消息
-        if (task->prio < curTask->prio) {  // 如果唤醒的任务优先级更高，则进行任务调度
-            tTaskExitCritical(status);  // 退出临界区
-            tTaskSched();  // 调度任务
-        }
-    } else {
-        // 如果没有任务等待，检查邮箱是否已满
-        if (mbox->count >= mbox->maxCount) {
-            tTaskExitCritical(status);  // 退出临界区
-            return tErrorResourceFull;  // 返回邮箱已满错误
-        }
+    err = tMboxPost(mbox, msg, notifyOption, &sched);
 
-        // 根据 notifyOption 决定是将消息插入邮箱的头部还是尾部
-        if (notifyOption & tMboxSendFront) {
-            if (mbox->read <= 0) {
-                mbox->read = mbox->maxCount - 1;  // 如果读取指针为0，回绕到最后一个位置
-            } else {
-                --mbox->read;  // 向前移动读取指针
-            }
-            mbox->msgBuffer[mbox->read] = msg;  // 插入消息到头部
-        } else {
-            mbox->msgBuffer[mbox->write++] = msg;  // 插入消息到尾部并更新写入指针
-            if (mbox->write >= mbox->maxCount) {  // 如果写入指针越界，则回绕
-                mbox->write = 0;
-            }
+    tTaskExitCritical(status);  // 退出临界区
+    if (sched) {  // 如果唤醒的任务优先级更高，则进行任务调度
+        tTaskSched();
+    }
+    return err;
+}
+
+/**
+ * @brief 批量发送消息。
+ * 
+ * 在同一个临界区内依次发送，等待的任务各得到一条消息，其余消息放入邮箱；全部发送后最多调度一次。
+ * 
+ * @param mbox        指向邮箱结构体的指针。
+ * @param msgs        要发送的消息数组。
+ * @param n           消息数。
+ * 
+ * @return uint32_t   实际发送的消息数，邮箱满时少于n。
+ */
+uint32_t tMboxNotifyN(tMbox * mbox, void ** msgs, uint32_t n) {
+    uint32_t i, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventMboxNotify, mbox, n);
+
+    for (i = 0; i < n; i++) {
+        uint32_t woken = 0;
+        if (tMboxPost(mbox, msgs[i], tMboxSendNormal, &woken) != tErrorNoError) {
+            break;
         }
-        mbox->count++;  // 增加消息计数
+        sched |= woken;
     }
 
-    tTaskExitCritical(status);  // 退出临界区
-    return tErrorNoError;  // 返回成功
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return i;
+}
+
+/**
+ * @brief 在中断服务函数中向邮箱发送消息。
+ * 
+ * 与tMboxNotify相同，但不立即调度，只标记需要调度，退出最外层中断(tIntExit)时统一触发一次PendSV。
+ * 
+ * @return uint32_t   返回操作结果，`tErrorNoError` 表示成功，`tErrorResourceFull` 表示邮箱已满。
+ */
+uint32_t tMboxNotifyFromISR(tMbox * mbox, void * msg, uint32_t notifyOption) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventMboxNotify, mbox, 1);
+
+    err = tMboxPost(mbox, msg, notifyOption, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return err;
 }
 
 /**
@@ -166,6 +372,7 @@ uint32_t tMboxDestory(tMbox * mbox) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
     uint32_t count = tEventRemoveAll(&mbox->event, (void *)0, tErrorDel);  // 删除所有等待任务
+    tRegistryRemove(&mbox->event.object);
     tTaskExitCritical(status);  // 退出临界区
 
     if (count > 0) {  // 如果有任务被删除
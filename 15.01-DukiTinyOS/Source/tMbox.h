@@ -2,6 +2,7 @@
 #define __TMBOX_H
 
 #include "tEvent.h"
+#include "tStatic.h"
 
 #define tMboxSendNormal 0x00
 #define tMboxSendFront  0x01
@@ -12,6 +13,11 @@ typedef struct _tMbox {
 	uint32_t write;
 	uint32_t maxCount;
 	void ** msgBuffer;//消息缓冲队列
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+	uint32_t latest;//1：最新值模式，msgBuffer指向latestMsg
+	uint32_t version;//最新值模式下已发送的次数，读者可据此判断是否有新值
+	void * latestMsg;
+#endif
 }tMbox;
 
 //邮箱信息
@@ -21,10 +27,42 @@ typedef struct _tMboxInfo {
 	uint32_t taskCount;
 }tMboxInfo;
 
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+//编译时定义邮箱及其可存放size个消息的缓冲区(mbox_buffer)，不需要调用tMboxInit；size为0时编译报错
+#define TINYOS_MBOX_DEFINE(mbox, size) \
+	TINYOS_STATIC_ASSERT(mbox##_size, (size) > 0); \
+	static void * mbox##_buffer[size]; \
+	tMbox mbox = { \
+		.event = TINYOS_EVENT_INITIALIZER(mbox.event, tEventTypeMbox, #mbox), \
+		.maxCount = (size), \
+		.msgBuffer = mbox##_buffer, \
+	}; \
+	TINYOS_STATIC_REGISTER(mbox, mbox.event.object)
+
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+//编译时定义最新值模式的邮箱，不需要调用tMboxInitLatest
+#define TINYOS_MBOX_LATEST_DEFINE(mbox) \
+	tMbox mbox = { \
+		.event = TINYOS_EVENT_INITIALIZER(mbox.event, tEventTypeMbox, #mbox), \
+		.maxCount = 1, \
+		.msgBuffer = &mbox.latestMsg, \
+		.latest = 1, \
+	}; \
+	TINYOS_STATIC_REGISTER(mbox, mbox.event.object)
+#endif
+#endif
+
 void tMboxInit(tMbox * mbox,void ** msgBuffer,uint32_t maxCount);
+#if TINYOS_ENABLE_MBOX_LATEST == 1
+void tMboxInitLatest(tMbox * mbox);
+uint32_t tMboxGetLatest(tMbox * mbox, void ** msg, uint32_t * version);
+#endif
 uint32_t tMboxWait(tMbox * mbox, void ** msg, uint32_t waitTicks);
 uint32_t tMboxNoWaitGet(tMbox * mbox, void ** msg);
 uint32_t tMboxNotify(tMbox * mbox, void * msg, uint32_t notifyOption);
+uint32_t tMboxNotifyFromISR(tMbox * mbox, void * msg, uint32_t notifyOption);
+uint32_t tMboxWaitN(tMbox * mbox, void ** msgs, uint32_t max, uint32_t waitTicks);
+uint32_t tMboxNotifyN(tMbox * mbox, void ** msgs, uint32_t n);
 void tMboxFlush(tMbox * mbox);
 uint32_t tMboxDestory(tMbox * mbox);
 void tMboxGetInfo(tMbox * mbox, tMboxInfo * info);
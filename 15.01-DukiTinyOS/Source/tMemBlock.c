@@ -1,10 +1,88 @@
 #include "tinyOS.h"
 
 #if TINYOS_ENABLE_MEMBLOCK == 1
+#if TINYOS_MEMBLOCK_USE_LIFO == 1
+// 取出一个空闲块，优先取最近释放的块(仍在总线/ART缓存中)，没有时从未分配过的区域中取，需在临界区内调用
+static uint8_t * tMemBlockTake(tMemBlock * memBlock) {
+    uint8_t * mem = (uint8_t *)0;
+    if (memBlock->freeList) {
+        mem = (uint8_t *)memBlock->freeList;
+        memBlock->freeList = *(void **)mem;
+        memBlock->freeCount--;
+    } else if (memBlock->unusedStart < (uint8_t *)memBlock->memStart + memBlock->blockSize * memBlock->maxCount) {
+        mem = memBlock->unusedStart;
+        memBlock->unusedStart += memBlock->blockSize;
+        memBlock->freeCount--;
+    }
+    return mem;
+}
+
+// 将空闲块压入链表头，需在临界区内调用
+static void tMemBlockPut(tMemBlock * memBlock, uint8_t * mem) {
+    *(void **)mem = memBlock->freeList;
+    memBlock->freeList = mem;
+    memBlock->freeCount++;
+}
+
+#define tMemBlockFreeCount(memBlock)    ((memBlock)->freeCount)
+#define TMEMBLOCK_SIZE_MIN              sizeof(void *)
+#else
+#define tMemBlockTake(memBlock)         ((uint8_t *)tListRemoveFirst(&(memBlock)->blockList))
+#define tMemBlockPut(memBlock, mem)     tListAddLast(&(memBlock)->blockList, (tNode *)(mem))
+#define tMemBlockFreeCount(memBlock)    tListCount(&(memBlock)->blockList)
+#define TMEMBLOCK_SIZE_MIN              sizeof(tNode)
+#endif
+
+#if TINYOS_MEMBLOCK_DEBUG == 1
+#define TMEMBLOCK_POISON                0xA5
+
+// 空闲块除链表指针外的部分填充为固定值
+static void tMemBlockPoison(tMemBlock * memBlock, uint8_t * mem) {
+    uint32_t i;
+    for (i = TMEMBLOCK_SIZE_MIN; i < memBlock->blockSize; i++) {
+        mem[i] = TMEMBLOCK_POISON;
+    }
+}
+
+// 分配时检查填充值，被改写说明块在释放后仍被使用
+static void tMemBlockPoisonCheck(tMemBlock * memBlock, uint8_t * mem) {
+    uint32_t i;
+    for (i = TMEMBLOCK_SIZE_MIN; i < memBlock->blockSize; i++) {
+        if (mem[i] != TMEMBLOCK_POISON) {
+            memBlock->poisonErrorCount++;
+            memBlock->poisonErrorBlock = mem;
+            return;
+        }
+    }
+}
+#endif
+
+// 从池中取出一个块并更新统计数据，需在临界区内调用，调用者需保证池非空
+static uint8_t * tMemBlockGet(tMemBlock * memBlock) {
+    uint8_t * mem = tMemBlockTake(memBlock);
+    uint32_t used = memBlock->maxCount - tMemBlockFreeCount(memBlock);
+    if (used > memBlock->maxUsedCount) {
+        memBlock->maxUsedCount = used;
+    }
+#if TINYOS_MEMBLOCK_DEBUG == 1
+    tMemBlockPoisonCheck(memBlock, mem);
+#endif
+    return mem;
+}
+
+// 将块放回池中，需在临界区内调用
+static void tMemBlockFree(tMemBlock * memBlock, uint8_t * mem) {
+#if TINYOS_MEMBLOCK_DEBUG == 1
+    tMemBlockPoison(memBlock, mem);
+#endif
+    tMemBlockPut(memBlock, mem);
+}
+
 /**
  * @brief 初始化内存块。
  * 
  * 该函数用于初始化内存块，将内存块的相关信息进行设置，并将内存块划分为多个内存块单元。
+ * 使用LIFO单向链表时不逐块链接，初始化时间与块数无关。
  * 
  * @param memBlock   指向要初始化的内存块结构体的指针。
  * @param memStart   指向内存起始地址的指针。
@@ -15,18 +93,41 @@
  */
 void tMemBlockInit(tMemBlock * memBlock, uint8_t * memStart, uint32_t blockSize, uint32_t blockCnt) {
     uint8_t * memBlockStart = (uint8_t *) memStart;   // 初始化内存块起始地址
+#if TINYOS_MEMBLOCK_USE_LIFO == 0
     uint8_t * memBlockEnd = (uint8_t *)(memBlockStart + blockCnt * blockSize);  // 计算内存块的结束地址
+#endif
     
-    if (blockSize < sizeof(tNode)) {  // 确保每个内存块的大小大于 tNode 类型的大小
+    if (blockSize < TMEMBLOCK_SIZE_MIN) {  // 确保每个内存块能放下链表指针
         return;  // 如果内存块大小不够，直接返回
     }
 
     tEventInit(&memBlock->event, tEventTypeMemBlock);  // 初始化事件，设置为内存块事件类型
+    tRegistryAdd(&memBlock->event.object, tObjectTypeEvent);
     
     memBlock->memStart = memBlockStart;  // 设置内存块起始地址
     memBlock->maxCount = blockCnt;  // 设置最大内存块数
     memBlock->blockSize = blockSize;  // 设置每个内存块的大小
+    memBlock->maxUsedCount = 0;
+    memBlock->waitCount = 0;
+    memBlock->totalWaitUs = 0;
+    memBlock->maxWaitUs = 0;
+#if TINYOS_MEMBLOCK_DEBUG == 1
+    memBlock->poisonErrorCount = 0;
+    memBlock->poisonErrorBlock = (uint8_t *)0;
+    {
+        // 调试模式下整个池先填充，从未分配过的块同样可以检查
+        uint32_t i;
+        for (i = 0; i < blockSize * blockCnt; i++) {
+            memStart[i] = TMEMBLOCK_POISON;
+        }
+    }
+#endif
     
+#if TINYOS_MEMBLOCK_USE_LIFO == 1
+    memBlock->freeList = (void *)0;
+    memBlock->unusedStart = memBlockStart;
+    memBlock->freeCount = blockCnt;
+#else
     tListInit(&memBlock->blockList);  // 初始化内存块的链表
     
     while (memBlockStart < memBlockEnd) {  // 遍历每个内存块
@@ -35,6 +136,7 @@ void tMemBlockInit(tMemBlock * memBlock, uint8_t * memStart, uint32_t blockSize,
         
         memBlockStart += blockSize;  // 移动到下一个内存块的位置
     }
+#endif
 }
 
 /**
@@ -51,17 +153,30 @@ void tMemBlockInit(tMemBlock * memBlock, uint8_t * memStart, uint32_t blockSize,
 uint32_t tMemBlockWait(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitTicks) {
     uint32_t status = tTaskEnterCritical();   // 进入临界区，保护共享资源
 
-    if (tListCount(&memBlock->blockList) > 0) {  // 如果有可用的内存块
-        *mem = (uint8_t *) tListRemoveFirst(&memBlock->blockList);  // 从链表中移除并返回内存块
+    if (tMemBlockFreeCount(memBlock) > 0) {  // 如果有可用的内存块
+        *mem = tMemBlockGet(memBlock);  // 从空闲链表中取出内存块
         tTaskExitCritical(status);  // 退出临界区
         return tErrorNoError;  // 返回成功
     } else {
+        uint32_t waitUs;
+        uint64_t waitStart = tTimeGetMicros();
+        
         // 如果内存池为空，任务等待内存块事件
+        memBlock->waitCount++;
         tEventWait(&memBlock->event, curTask, (void *)0, tEventTypeMemBlock, waitTicks);
         tTaskExitCritical(status);  // 退出临界区
 
         tTaskSched();  // 调度任务
 
+        // 统计等待时长
+        waitUs = (uint32_t)(tTimeGetMicros() - waitStart);
+        status = tTaskEnterCritical();
+        memBlock->totalWaitUs += waitUs;
+        if (waitUs > memBlock->maxWaitUs) {
+            memBlock->maxWaitUs = waitUs;
+        }
+        tTaskExitCritical(status);
+
         *mem = (uint8_t *) curTask->eventMsg;  // 获取当前任务的事件消息（即分配的内存块）
         return curTask->waitEventResult;  // 返回等待的结果
     }
@@ -80,8 +195,8 @@ uint32_t tMemBlockWait(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitTicks)
 uint32_t tMemBlockNoWaitGet(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitTicks) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-    if (tListCount(&memBlock->blockList) > 0) {  // 如果有可用的内存块
-        *mem = (uint8_t *) tListRemoveFirst(&memBlock->blockList);  // 从链表中移除并返回内存块
+    if (tMemBlockFreeCount(memBlock) > 0) {  // 如果有可用的内存块
+        *mem = tMemBlockGet(memBlock);  // 从空闲链表中取出内存块
         tTaskExitCritical(status);  // 退出临界区
         return tErrorNoError;  // 返回成功
     } else {
@@ -90,6 +205,17 @@ uint32_t tMemBlockNoWaitGet(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitT
     }
 }
 
+//释放内存块的公共部分，需在临界区内调用，返回1表示唤醒了比当前任务优先级更高的任务
+static uint32_t tMemBlockRelease(tMemBlock * memBlock, uint8_t *mem) {
+    if (tEventWaitCount(&memBlock->event) > 0) {  // 如果有任务在等待内存块
+        tTask * task = tEventWakeUp(&memBlock->event, (void *)mem, tErrorNoError);  // 唤醒任务并传递内存块
+        return task->prio < curTask->prio;
+    }
+
+    tMemBlockFree(memBlock, mem);  // 如果没有任务等待，将内存块插入池中
+    return tEventMultiWakeUp(&memBlock->event, tErrorNoError);
+}
+
 /**
  * @brief 通知内存块池中的等待任务。
  * 
@@ -101,22 +227,36 @@ uint32_t tMemBlockNoWaitGet(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitT
  * @return uint32_t  返回操作结果，`tErrorNoError` 表示成功。
  */
 uint32_t tMemBlockNotify(tMemBlock * memBlock, uint8_t *mem) {
+    uint32_t sched;
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-    if (tEventWaitCount(&memBlock->event) > 0) {  // 如果有任务在等待内存块
-        tTask * task = tEventWakeUp(&memBlock->event, (void *)mem, tErrorNoError);  // 唤醒任务并传递内存块
-        if (task->prio < curTask->prio) {  // 如果唤醒的任务优先级更高，则进行任务调度
-            tTaskExitCritical(status);  // 退出临界区
-            tTaskSched();  // 调度任务
-        }
-    } else {
-        tListAddLast(&memBlock->blockList, (tNode*)mem);  // 如果没有任务等待，将内存块插入池中
-    }
+    sched = tMemBlockRelease(memBlock, mem);
 
     tTaskExitCritical(status);  // 退出临界区
+    if (sched) {  // 如果唤醒的任务优先级更高，则进行任务调度
+        tTaskSched();
+    }
     return tErrorNoError;  // 返回成功
 }
 
+/**
+ * @brief 在中断服务函数中释放内存块，唤醒任务后只标记需要调度，由tIntExit统一触发。
+ * 
+ * @return uint32_t  返回操作结果，`tErrorNoError` 表示成功。
+ */
+uint32_t tMemBlockNotifyFromISR(tMemBlock * memBlock, uint8_t *mem) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tMemBlockRelease(memBlock, mem);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return tErrorNoError;
+}
+
 /**
  * @brief 获取内存块池的当前状态信息。
  * 
@@ -130,10 +270,19 @@ uint32_t tMemBlockNotify(tMemBlock * memBlock, uint8_t *mem) {
 void tMemBlockGetInfo(tMemBlock * memBlock, tMemBlockInfo * info) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
-    info->count = tListCount(&memBlock->blockList);  // 获取当前可用内存块数
+    info->count = tMemBlockFreeCount(memBlock);  // 获取当前可用内存块数
     info->maxCount = memBlock->maxCount;  // 获取最大内存块数
     info->taskCount = tEventWaitCount(&memBlock->event);  // 获取等待任务数
     info->blockSize = memBlock->blockSize;  // 获取内存块大小
+    info->maxUsedCount = memBlock->maxUsedCount;
+    info->waitCount = memBlock->waitCount;
+    info->totalWaitUs = memBlock->totalWaitUs;
+    info->maxWaitUs = memBlock->maxWaitUs;
+#if TINYOS_MEMBLOCK_DEBUG == 1
+    info->poisonErrorCount = memBlock->poisonErrorCount;
+#else
+    info->poisonErrorCount = 0;
+#endif
     
     tTaskExitCritical(status);  // 退出临界区
 }
@@ -151,6 +300,7 @@ uint32_t tMemBlockDestory(tMemBlock * memBlock) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
     uint32_t count = tEventRemoveAll(&memBlock->event, (void *)0, tErrorDel);  // 删除所有等待任务
+    tRegistryRemove(&memBlock->event.object);
     tTaskExitCritical(status);  // 退出临界区
 
     if (count > 0) {  // 如果有任务被删除
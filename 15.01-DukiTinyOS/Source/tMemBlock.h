@@ -12,7 +12,23 @@ typedef struct _tMemBlock {
 	
 	uint32_t maxCount;//存储块的最大数量
 	
+#if TINYOS_MEMBLOCK_USE_LIFO == 1
+	void * freeList;//释放的存储块组成的单向链表，块的第一个字存放下一块的地址
+	uint8_t * unusedStart;//从未分配过的存储块起始地址，初始化时不逐块链接，首次分配时依次取出
+	uint32_t freeCount;//空闲的存储块数量
+#else
 	tList blockList;
+#endif
+	
+	//统计数据
+	uint32_t maxUsedCount;//同时被占用的块数的最大值
+	uint32_t waitCount;//因池空而等待的次数
+	uint64_t totalWaitUs;//等待的总时长
+	uint32_t maxWaitUs;//单次等待的最长时长
+#if TINYOS_MEMBLOCK_DEBUG == 1
+	uint32_t poisonErrorCount;//分配时发现填充值被改写的次数
+	uint8_t * poisonErrorBlock;//最近一次被改写的块
+#endif
 	
 }tMemBlock;
 
@@ -21,6 +37,11 @@ typedef struct _tMemBlockInfo {
 	uint32_t maxCount;
 	uint32_t blockSize;
 	uint32_t taskCount;
+	uint32_t maxUsedCount;
+	uint32_t waitCount;
+	uint64_t totalWaitUs;
+	uint32_t maxWaitUs;
+	uint32_t poisonErrorCount;
 }tMemBlockInfo;
 void tMemBlockInit(tMemBlock * memBlock, uint8_t * memStart, uint32_t blockSize, uint32_t blockCnt);
 
@@ -29,6 +50,7 @@ uint32_t tMemBlockWait(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitTicks)
 uint32_t tMemBlockNoWaitGet(tMemBlock * memBlock, uint8_t ** mem, uint32_t waitTicks);
 
 uint32_t tMemBlockNotify(tMemBlock * memBlock, uint8_t *mem);
+uint32_t tMemBlockNotifyFromISR(tMemBlock * memBlock, uint8_t *mem);
 
 void tMemBlockGetInfo(tMemBlock * memBlock, tMemBlockInfo * info);
 
@@ -0,0 +1,272 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_MSG_CALL == 1
+/**
+ * @brief 初始化同步消息通道并绑定服务者。
+ *
+ * @param channel   指向通道的指针。
+ * @param server    服务者任务，只有它能接收并继承客户的优先级；删除服务者前应先删除通道。
+ *
+ * @return void
+ */
+void tMsgChannelInit(tMsgChannel * channel, tTask * server) {
+    uint32_t status;
+
+    tEventInit(&channel->event, tEventTypeMsgCall);
+    tEventInit(&channel->replyEvent, tEventTypeMsgReply);
+    tEventInit(&channel->serverEvent, tEventTypeMsgReceive);
+    tRegistryAdd(&channel->event.object, tObjectTypeEvent);
+    channel->server = server;
+    channel->callCount = 0;
+    channel->replyCount = 0;
+
+    status = tTaskEnterCritical();
+    tListAddLast(&server->serverChannelList, &channel->serverNode);
+    tTaskExitCritical(status);
+}
+
+//等待队列中的最高优先级，没有等待者时返回TINYOS_PRIO_COUNT
+static uint32_t tMsgCallWaiterPrio(tEvent * event) {
+    uint32_t prio = TINYOS_PRIO_COUNT;
+    tNode * node;
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+    if ((node = tListFirst(&event->waitList)) != (tNode *)0) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        prio = task->prio;
+    }
+#else
+    for (node = event->waitList.headNode.nextNode; node != &(event->waitList.headNode); node = node->nextNode) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        if (task->prio < prio) {
+            prio = task->prio;
+        }
+    }
+#endif
+    return prio;
+}
+
+/**
+ * @brief 计算任务作为服务者应继承的优先级。
+ *
+ * 取其绑定的各通道上排队及等待回复的客户中的最高优先级，没有客户时返回TINYOS_PRIO_COUNT，需在临界区内调用。
+ *
+ * @param task 服务者任务。
+ *
+ * @return uint32_t 继承的优先级。
+ */
+uint32_t tMsgCallTaskPrio(tTask * task) {
+    uint32_t prio = TINYOS_PRIO_COUNT;
+    tNode * node;
+
+    for (node = task->serverChannelList.headNode.nextNode; node != &(task->serverChannelList.headNode); node = node->nextNode) {
+        tMsgChannel * channel = tNodeParent(node, tMsgChannel, serverNode);
+        uint32_t waiterPrio = tMsgCallWaiterPrio(&channel->event);
+        uint32_t servingPrio = tMsgCallWaiterPrio(&channel->replyEvent);
+        if (waiterPrio < prio) {
+            prio = waiterPrio;
+        }
+        if (servingPrio < prio) {
+            prio = servingPrio;
+        }
+    }
+    return prio;
+}
+
+/**
+ * @brief 获取阻塞在通道上的客户所等待的服务者，用于沿阻塞链传递继承的优先级，需在临界区内调用。
+ *
+ * @param event 客户正在等待的事件。
+ *
+ * @return tTask* 服务者，不是通道的客户事件时返回0。
+ */
+tTask * tMsgCallServer(tEvent * event) {
+    tMsgChannel * channel;
+
+    if (event->type == tEventTypeMsgCall) {
+        channel = tNodeParent(event, tMsgChannel, event);
+    } else if (event->type == tEventTypeMsgReply) {
+        channel = tNodeParent(event, tMsgChannel, replyEvent);
+    } else {
+        return (tTask *)0;
+    }
+    return channel->server;
+}
+
+//取出优先级最高的客户，同优先级先来先服务，需在临界区内调用，队列不能为空
+static tTask * tMsgCallPickClient(tMsgChannel * channel) {
+    tNode * node = tListFirst(&channel->event.waitList);
+    tTask * client = tNodeParent(node, tTask, linkNode);
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 0
+    for (node = node->nextNode; node != &(channel->event.waitList.headNode); node = node->nextNode) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        if (task->prio < client->prio) {
+            client = task;
+        }
+    }
+#endif
+    return client;
+}
+
+/**
+ * @brief 向服务者发出同步调用，阻塞直到收到回复。
+ *
+ * 排队及等待回复期间服务者继承调用者的优先级。超时只在服务者接收之前计算，接收后一直等待回复。
+ *
+ * @param channel    指向通道的指针。
+ * @param request    请求，服务者由tMsgCallReceive得到。
+ * @param reply      存放回复，可为0。
+ * @param waitTicks  等待服务者接收的最大节拍数，为0时一直等待。
+ *
+ * @return uint32_t  `tErrorNoError`表示已收到回复，`tErrorTimeOut`表示超时未被接收，`tErrorDel`表示通道被删除，
+ *                   `tErrorParam`表示服务者调用自己的通道。
+ */
+uint32_t tMsgCall(tMsgChannel * channel, void * request, void ** reply, uint32_t waitTicks) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (channel->server == curTask) {
+        tTaskExitCritical(status);
+        return tErrorParam;
+    }
+
+    tEventWait(&channel->event, curTask, request, tEventTypeMsgCall, waitTicks);
+    if (tEventWaitCount(&channel->serverEvent) > 0) {
+        tEventWakeUp(&channel->serverEvent, (void *)0, tErrorNoError);
+    }
+    // 服务者继承调用者的优先级，若它正阻塞在互斥量或其它通道上，沿链继续提升
+    tMutexTaskUpdatePrio(channel->server);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    if (curTask->waitEventResult != tErrorNoError) {
+        // 超时或通道被删除，不再排队，服务者继承的优先级可能需要降低
+        status = tTaskEnterCritical();
+        tMutexTaskUpdatePrio(channel->server);
+        tTaskExitCritical(status);
+    } else if (reply != (void **)0) {
+        *reply = curTask->eventMsg;
+    }
+    return curTask->waitEventResult;
+}
+
+/**
+ * @brief 服务者接收优先级最高的调用，没有调用时阻塞等待。
+ *
+ * 接收后客户转为等待回复，仍计入服务者继承的优先级，直到tMsgReply。
+ * 被客户唤醒后若该客户已超时离开则继续等待，超时重新开始计算。
+ *
+ * @param channel    指向通道的指针。
+ * @param request    存放客户的请求。
+ * @param client     存放客户任务，回复时传给tMsgReply。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ *
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示通道被删除，`tErrorOwner`表示当前任务不是服务者。
+ */
+uint32_t tMsgCallReceive(tMsgChannel * channel, void ** request, tTask ** client, uint32_t waitTicks) {
+    tTask * task;
+    uint32_t status = tTaskEnterCritical();
+
+    if (channel->server != curTask) {
+        tTaskExitCritical(status);
+        return tErrorOwner;
+    }
+
+    while (tListCount(&channel->event.waitList) == 0) {
+        tEventWait(&channel->serverEvent, curTask, (void *)0, tEventTypeMsgReceive, waitTicks);
+        tTaskExitCritical(status);
+
+        tTaskSched();
+
+        if (curTask->waitEventResult != tErrorNoError) {
+            return curTask->waitEventResult;
+        }
+        status = tTaskEnterCritical();
+    }
+
+    task = tMsgCallPickClient(channel);
+    *request = task->eventMsg;
+    *client = task;
+    tEventMoveTask(&channel->replyEvent, task, tEventTypeMsgReply);
+    channel->callCount++;
+
+    tTaskExitCritical(status);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 回复已接收的调用，唤醒客户并按剩余的客户重新计算服务者的优先级。
+ *
+ * @param channel   指向通道的指针。
+ * @param client    tMsgCallReceive得到的客户。
+ * @param reply     回复，客户由tMsgCall得到。
+ *
+ * @return uint32_t `tErrorNoError`表示成功，`tErrorParam`表示该客户不在等待本通道的回复。
+ */
+uint32_t tMsgReply(tMsgChannel * channel, tTask * client, void * reply) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    if (client->waitEvent != &channel->replyEvent) {
+        tTaskExitCritical(status);
+        return tErrorParam;
+    }
+
+    tEventWakeUpTask(&channel->replyEvent, client, reply, tErrorNoError);
+    channel->replyCount++;
+    tMutexTaskUpdatePrio(channel->server);
+    sched = (client->prio < curTask->prio);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return tErrorNoError;
+}
+
+/**
+ * @brief 获取通道的状态信息。
+ *
+ * @param channel   指向通道的指针。
+ * @param info      用于存放通道信息的结构体指针。
+ *
+ * @return void
+ */
+void tMsgChannelGetInfo(tMsgChannel * channel, tMsgChannelInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->server = channel->server;
+    info->serverPrio = channel->server->prio;
+    info->basePrio = channel->server->basePrio;
+    info->pendingCount = tEventWaitCount(&channel->event);
+    info->servingCount = tEventWaitCount(&channel->replyEvent);
+    info->callCount = channel->callCount;
+    info->replyCount = channel->replyCount;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除通道，排队及等待回复的客户和等待中的服务者都以`tErrorDel`返回，服务者不再继承它们的优先级。
+ *
+ * @param channel   指向通道的指针。
+ *
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tMsgChannelDestroy(tMsgChannel * channel) {
+    uint32_t count;
+    uint32_t status = tTaskEnterCritical();
+
+    count = tEventRemoveAll(&channel->event, (void *)0, tErrorDel);
+    count += tEventRemoveAll(&channel->replyEvent, (void *)0, tErrorDel);
+    count += tEventRemoveAll(&channel->serverEvent, (void *)0, tErrorDel);
+    tListRemove(&channel->server->serverChannelList, &channel->serverNode);
+    tMutexTaskUpdatePrio(channel->server);
+    tRegistryRemove(&channel->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,40 @@
+#ifndef __TMSGCALL_H
+#define __TMSGCALL_H
+
+#include "tEvent.h"
+
+// 同步消息调用：客户以tMsgCall发出请求后一直阻塞，直到服务者tMsgCallReceive接收并以tMsgReply回复，与互斥量保护的共享服务不同，
+// 服务代码只在服务者自己的上下文中运行；客户排队及等待回复期间，服务者继承其中最高的优先级，回复后按剩余的客户重新计算，
+// 与所持有的互斥量一起由tMutexTaskUpdatePrio统一计算，并沿"服务者又在调用别的通道或等待互斥量"的链继续传递
+// 请求与回复都是指针，通常指向客户栈上的结构体，客户在回复前不会返回，服务者可以直接读写
+typedef struct _tMsgChannel {
+	tEvent event;                    //已发出调用、等待服务者接收的客户(tEventTypeMsgCall)
+	tEvent replyEvent;               //已被接收、等待回复的客户(tEventTypeMsgReply)
+	tEvent serverEvent;              //没有客户时等待的服务者(tEventTypeMsgReceive)
+	tTask * server;                  //绑定的服务者，只有它能接收
+	tNode serverNode;                //挂在服务者的serverChannelList中
+	uint32_t callCount;              //已接收的调用次数
+	uint32_t replyCount;
+}tMsgChannel;
+
+typedef struct _tMsgChannelInfo {
+	tTask * server;
+	uint32_t serverPrio;             //服务者当前的(含继承的)优先级
+	uint32_t basePrio;
+	uint32_t pendingCount;           //等待接收的客户数
+	uint32_t servingCount;           //已接收未回复的客户数
+	uint32_t callCount;
+	uint32_t replyCount;
+}tMsgChannelInfo;
+
+void tMsgChannelInit(tMsgChannel * channel, tTask * server);
+uint32_t tMsgCall(tMsgChannel * channel, void * request, void ** reply, uint32_t waitTicks);
+uint32_t tMsgCallReceive(tMsgChannel * channel, void ** request, tTask ** client, uint32_t waitTicks);
+uint32_t tMsgReply(tMsgChannel * channel, tTask * client, void * reply);
+void tMsgChannelGetInfo(tMsgChannel * channel, tMsgChannelInfo * info);
+uint32_t tMsgChannelDestroy(tMsgChannel * channel);
+
+// 供tMutex.c计算继承优先级，需在临界区内调用
+uint32_t tMsgCallTaskPrio(tTask * task);
+tTask * tMsgCallServer(tEvent * event);
+#endif
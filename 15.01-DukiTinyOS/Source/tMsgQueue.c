@@ -0,0 +1,115 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_MSGQUEUE == 1
+#define msgToHeader(msg)    ((tMsgHeader *)((uint8_t *)(msg) - sizeof(tMsgHeader)))
+#define headerToMsg(header) ((void *)((uint8_t *)(header) + sizeof(tMsgHeader)))
+
+/**
+ * @brief 初始化零拷贝消息队列。
+ * 
+ * @param queue      指向消息队列的指针。
+ * @param poolMem    存储池内存，大小至少为tMsgBlockSize(msgSize) * msgCount。
+ * @param msgSize    每条消息的最大字节数。
+ * @param msgCount   存储池中消息缓冲区的数量。
+ * @param msgBuffer  邮箱的指针缓冲区。
+ * @param maxCount   邮箱最多可以暂存的消息数。
+ * 
+ * @return void
+ */
+void tMsgQueueInit(tMsgQueue * queue, uint8_t * poolMem, uint32_t msgSize, uint32_t msgCount,
+		void ** msgBuffer, uint32_t maxCount) {
+    tMemBlockInit(&queue->pool, poolMem, tMsgBlockSize(msgSize), msgCount);
+    tMboxInit(&queue->mbox, msgBuffer, maxCount);
+}
+
+/**
+ * @brief 分配一个消息缓冲区，引用计数为1。
+ * 
+ * @param queue      指向消息队列的指针。
+ * @param waitTicks  存储池为空时最大等待的节拍数，为0时一直等待。
+ * 
+ * @return void*     消息缓冲区，超时或队列被删除时返回0。
+ */
+void * tMsgAlloc(tMsgQueue * queue, uint32_t waitTicks) {
+    uint8_t * mem;
+    tMsgHeader * header;
+
+    if (tMemBlockWait(&queue->pool, &mem, waitTicks) != tErrorNoError) {
+        return (void *)0;
+    }
+    header = (tMsgHeader *)mem;
+    header->owner = queue;
+    header->refCount = 1;
+    return headerToMsg(header);
+}
+
+/**
+ * @brief 发送消息，只传递指针。
+ * 
+ * 发送后接收者持有发送者的这一份引用；发送给多个队列前应先调用tMsgRetain增加相应的引用。
+ * 消息可以发送给任何一个tMsgQueue，不必是分配它的队列。
+ * 
+ * @param queue      目标队列。
+ * @param msg        tMsgAlloc分配的消息。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceFull`表示队列已满，此时消息仍由调用者持有。
+ */
+uint32_t tMsgSend(tMsgQueue * queue, void * msg) {
+    return tMboxNotify(&queue->mbox, msg, tMboxSendNormal);
+}
+
+/**
+ * @brief 在中断服务函数中发送消息。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceFull`表示队列已满。
+ */
+uint32_t tMsgSendFromISR(tMsgQueue * queue, void * msg) {
+    return tMboxNotifyFromISR(&queue->mbox, msg, tMboxSendNormal);
+}
+
+/**
+ * @brief 接收消息，处理完毕后需调用tMsgRelease。
+ * 
+ * @param queue      指向消息队列的指针。
+ * @param msg        用于返回消息。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时。
+ */
+uint32_t tMsgReceive(tMsgQueue * queue, void ** msg, uint32_t waitTicks) {
+    return tMboxWait(&queue->mbox, msg, waitTicks);
+}
+
+/**
+ * @brief 增加消息的引用计数，用于同一消息交给多个消费者。
+ * 
+ * @param msg        消息。
+ * @param count      增加的引用数。
+ * 
+ * @return void
+ */
+void tMsgRetain(void * msg, uint32_t count) {
+    uint32_t status = tTaskEnterCritical();
+    msgToHeader(msg)->refCount += count;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 释放一份引用，最后一份引用释放时缓冲区归还所属队列的存储池。
+ * 
+ * @param msg        消息。
+ * 
+ * @return void
+ */
+void tMsgRelease(void * msg) {
+    tMsgHeader * header = msgToHeader(msg);
+    uint32_t refCount;
+    uint32_t status = tTaskEnterCritical();
+    refCount = --header->refCount;
+    tTaskExitCritical(status);
+
+    if (refCount == 0) {
+        tMemBlockNotify(&header->owner->pool, (uint8_t *)header);
+    }
+}
+#endif
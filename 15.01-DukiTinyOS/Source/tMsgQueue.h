@@ -0,0 +1,30 @@
+#ifndef __TMSGQUEUE_H
+#define __TMSGQUEUE_H
+#include "tMbox.h"
+#include "tMemBlock.h"
+
+// 零拷贝消息队列
+// 消息缓冲区从队列自带的存储池中分配，发送和接收只传递指针；每个缓冲区前有一个消息头记录引用计数和所属的队列，
+// 一帧数据可以增加引用后同时发送给多个消费者(可以是其它队列)，最后一个消费者释放时才归还存储池
+typedef struct _tMsgHeader {
+	struct _tMsgQueue * owner;       //缓冲区所属的队列
+	uint32_t refCount;
+}tMsgHeader;
+
+typedef struct _tMsgQueue {
+	tMemBlock pool;
+	tMbox mbox;
+}tMsgQueue;
+
+// 存储池中每个块的大小，msgSize为用户数据的大小
+#define tMsgBlockSize(msgSize)      ((sizeof(tMsgHeader) + (msgSize) + 7) & ~7)
+
+void tMsgQueueInit(tMsgQueue * queue, uint8_t * poolMem, uint32_t msgSize, uint32_t msgCount,
+		void ** msgBuffer, uint32_t maxCount);
+void * tMsgAlloc(tMsgQueue * queue, uint32_t waitTicks);
+uint32_t tMsgSend(tMsgQueue * queue, void * msg);
+uint32_t tMsgSendFromISR(tMsgQueue * queue, void * msg);
+uint32_t tMsgReceive(tMsgQueue * queue, void ** msg, uint32_t waitTicks);
+void tMsgRetain(void * msg, uint32_t count);
+void tMsgRelease(void * msg);
+#endif
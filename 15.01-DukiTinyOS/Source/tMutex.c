@@ -1,4 +1,6 @@
+#include <string.h>
 #include "tinyOS.h"
+#include "tPort.h"
 
 #if TINYOS_ENABLE_MUTEX == 1
 /**
@@ -10,10 +12,289 @@
  */
 void tMutexInit(tMutex * mutex) {
     tEventInit(&mutex->event,tEventTypeMutex);  // 初始化事件控制块，类型为互斥量
+    tRegistryAdd(&mutex->event.object, tObjectTypeEvent);
     mutex->lockedCount = (uint32_t)0;            // 锁定计数器初始为0
     mutex->owner = (tTask *)0;                   // 初始没有任务持有锁
     mutex->ownerOriginalPrio = TINYOS_PRIO_COUNT; // 初始化为最低优先级
+    mutex->ceilingPrio = TINYOS_PRIO_COUNT;       // 默认使用优先级继承
+    tNodeInit(&(mutex->ownerNode));               // 未挂入任何任务的持有列表
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    memset(&mutex->stat, 0, sizeof(mutex->stat));
+    mutex->inheriting = 0;
+#endif
+}
+
+/**
+ * @brief 以优先级天花板协议初始化互斥量
+ * 
+ * @param mutex 指向互斥量的指针
+ * @param ceilingPrio 优先级天花板，应不低于所有会使用该互斥量的任务的优先级
+ * 
+ * 拥有者锁定时立即提升到天花板优先级，单核上其它使用者在此期间无法运行，
+ * 因而不会在互斥量上发生竞争，释放时也只需恢复一次优先级。
+ */
+void tMutexInitCeiling(tMutex * mutex, uint32_t ceilingPrio) {
+    tMutexInit(mutex);
+    mutex->ceilingPrio = ceilingPrio;
+}
+
+//修改任务优先级，就绪的任务需要调整其在就绪表中的位置，需在临界区内调用
+static void tMutexTaskSetPrio(tTask * task, uint32_t prio) {
+    if (task->state == TINYOS_TASK_STATE_RDY) {
+        tTaskSchedUnRdy(task);
+        task->prio = prio;
+        tTaskSchedRdy(task);
+    } else {
+        tEventTaskSetPrio(task, prio);
+    }
+}
+
+//获取互斥量等待队列中的最高优先级，没有等待者时返回TINYOS_PRIO_COUNT
+static uint32_t tMutexWaiterPrio(tMutex * mutex) {
+    uint32_t prio = TINYOS_PRIO_COUNT;
+    tNode * node;
+#if TINYOS_ENABLE_EVENT_PRIO_WAIT == 1
+    // 等待队列按优先级排序，队首即为最高优先级
+    if ((node = tListFirst(&(mutex->event.waitList))) != (tNode *)0) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        prio = task->prio;
+    }
+#else
+    for (node = mutex->event.waitList.headNode.nextNode; node != &(mutex->event.waitList.headNode); node = node->nextNode) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        if (task->prio < prio) {
+            prio = task->prio;
+        }
+    }
+#endif
+    return prio;
+}
+
+//任务的有效基础优先级：运行预算用完的任务以TINYOS_BUDGET_BG_PRIO为基础，持有互斥量期间的继承仍在其上生效
+static uint32_t tMutexBasePrio(tTask * task) {
+#if TINYOS_ENABLE_BUDGET == 1
+    if (task->budgetExhausted && (task->basePrio < TINYOS_BUDGET_BG_PRIO)) {
+        return TINYOS_BUDGET_BG_PRIO;
+    }
+#endif
+    return task->basePrio;
+}
+
+//计算任务应有的优先级：有效基础优先级、所持有的每个互斥量的天花板及其等待者优先级中的最高者，
+//开启同步消息调用时还包括作为服务者时各通道上客户的优先级
+static uint32_t tMutexTaskCalcPrio(tTask * task) {
+    uint32_t prio = tMutexBasePrio(task);
+    tNode * node;
+    for (node = task->heldMutexList.headNode.nextNode; node != &(task->heldMutexList.headNode); node = node->nextNode) {
+        tMutex * mutex = tNodeParent(node, tMutex, ownerNode);
+        uint32_t waiterPrio = tMutexWaiterPrio(mutex);
+        if (mutex->ceilingPrio < prio) {
+            prio = mutex->ceilingPrio;
+        }
+        if (waiterPrio < prio) {
+            prio = waiterPrio;
+        }
+    }
+#if TINYOS_ENABLE_MSG_CALL == 1
+    {
+        uint32_t callPrio = tMsgCallTaskPrio(task);
+        if (callPrio < prio) {
+            prio = callPrio;
+        }
+    }
+#endif
+    return prio;
+}
+
+/**
+ * @brief 重新计算任务的优先级
+ * 
+ * @param task 任务，为0时不做处理
+ * 
+ * 若该任务正阻塞在另一个互斥量(或同步消息通道)上，则沿拥有者(服务者)链继续传递，
+ * 最多传递TINYOS_MUTEX_CHAIN_MAX层，保证每次调整的时间有界(链上出现环即为死锁)，需在临界区内调用。
+ */
+void tMutexTaskUpdatePrio(tTask * task) {
+    uint32_t depth;
+    for (depth = 0; (task != (tTask *)0) && (depth < TINYOS_MUTEX_CHAIN_MAX); depth++) {
+        tMutex * mutex;
+        uint32_t prio = tMutexTaskCalcPrio(task);
+        if (prio == task->prio) {
+            break;
+        }
+        tMutexTaskSetPrio(task, prio);
+
+        if (task->waitEvent == (tEvent *)0) {
+            break;
+        }
+        if (task->waitEvent->type == tEventTypeMutex) {
+            mutex = tNodeParent(task->waitEvent, tMutex, event);
+            task = mutex->owner;
+        } else {
+#if TINYOS_ENABLE_MSG_CALL == 1
+            task = tMsgCallServer(task->waitEvent);
+#else
+            break;
+#endif
+        }
+    }
+}
+
+//ownerNode不在链表中时指向自身
+#define tMutexOwnerLinked(mutex)    ((mutex)->ownerNode.nextNode != &((mutex)->ownerNode))
+
+//将互斥量挂入拥有者的持有列表，快速路径获得的互斥量在出现等待者时才补挂，需在临界区内调用
+static void tMutexLinkOwner(tMutex * mutex) {
+    if (!tMutexOwnerLinked(mutex)) {
+        tListAddLast(&(mutex->owner->heldMutexList), &(mutex->ownerNode));
+    }
+}
+
+//将互斥量从拥有者的持有列表中摘下，需在临界区内调用
+static void tMutexUnlinkOwner(tMutex * mutex, tTask * owner) {
+    if (tMutexOwnerLinked(mutex)) {
+        tListRemove(&(owner->heldMutexList), &(mutex->ownerNode));
+        tNodeInit(&(mutex->ownerNode));
+    }
+}
+
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+//记录一次获得，由新的拥有者或在临界区内调用
+static void tMutexStatLock(tMutex * mutex) {
+    mutex->stat.lockCount++;
+    mutex->lockStamp = tCycleCounterGet();
+}
+
+//记录一次释放的持有时长，start为获得的时间
+static void tMutexStatRelease(tMutex * mutex, uint32_t start) {
+    uint32_t cycles = tCycleCounterGet() - start;
+
+    mutex->stat.holdCount++;
+    mutex->stat.holdTotalCycles += cycles;
+    if (cycles > mutex->stat.holdMaxCycles) {
+        mutex->stat.holdMaxCycles = cycles;
+    }
+}
+
+//等待者或拥有者变化后调用：上次更新至今的时长按原来的状态计入，再按当前的等待者判断拥有者是否在继承优先级，需在临界区内调用
+static void tMutexStatInherit(tMutex * mutex) {
+    uint32_t now = tCycleCounterGet();
+
+    if (mutex->inheriting) {
+        mutex->stat.inheritCycles += now - mutex->inheritStamp;
+    }
+    mutex->inheritStamp = now;
+    mutex->inheriting = (mutex->owner != (tTask *)0) && (tMutexWaiterPrio(mutex) < tMutexBasePrio(mutex->owner));
+}
+
+//记录一次阻塞等待，高优先级任务等待过久时调用告警钩子，在任务中调用
+static void tMutexStatWait(tMutex * mutex, uint32_t start) {
+    uint32_t cycles = tCycleCounterGet() - start;
+    uint32_t alert = (curTask->basePrio <= TINYOS_MUTEX_ALERT_PRIO)
+                     && (cycles > TINYOS_MUTEX_ALERT_US * (SystemCoreClock / 1000000));
+    uint32_t status = tTaskEnterCritical();
+
+    if (cycles > mutex->stat.waitMaxCycles) {
+        mutex->stat.waitMaxCycles = cycles;
+    }
+    if (alert) {
+        mutex->stat.alertCount++;
+    }
+    tTaskExitCritical(status);
+
+    if (alert) {
+        tHooksRunMutexWait(mutex, curTask, cycles);
+    }
+}
+#else
+#define tMutexStatLock(mutex)
+#define tMutexStatRelease(mutex, start)
+#define tMutexStatInherit(mutex)
+#endif
+
+//task成为互斥量的拥有者，加入其持有的互斥量列表，天花板模式下立即提升其优先级
+static void tMutexSetOwner(tMutex * mutex, tTask * task) {
+    mutex->lockedCount++;        // 锁定计数器++
+    tMutexStatLock(mutex);
+    mutex->owner = task;         // 成为拥有者
+    task->ownedMutexCount++;
+    mutex->ownerOriginalPrio = task->basePrio; // 记录原优先级
+    tMutexLinkOwner(mutex);
+    tMutexTaskUpdatePrio(task);
+}
+
+//拥有者释放互斥量，从其持有列表中移除并重新计算优先级
+static void tMutexClearOwner(tMutex * mutex) {
+    tTask * owner = mutex->owner;
+    tMutexUnlinkOwner(mutex, owner);
+    mutex->owner = (tTask *)0;
+    owner->ownedMutexCount--;
+    tMutexTaskUpdatePrio(owner);
+}
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+//无竞争时用LDREX/STREX占有owner(按指针宽度，见tPortLdrexPtr)，不关中断，嵌套锁定只有拥有者自己修改lockedCount，也不需要临界区
+//此时不挂入持有列表：没有等待者的互斥量不影响拥有者的优先级，等待者到来时由tMutexLinkOwner补挂
+//其它任务据owner判断互斥量是否空闲，lockedCount只由拥有者读写
+//天花板模式需在锁定时立即提升优先级，不走快速路径
+static uint32_t tMutexFastLock(tMutex * mutex) {
+    tTask * owner;
+
+    if (mutex->ceilingPrio != TINYOS_PRIO_COUNT) {
+        return 0;
+    }
+
+    do {
+        owner = (tTask *)tPortLdrexPtr((void * volatile *)&mutex->owner);
+        if (owner == curTask) {
+            __CLREX();
+            mutex->lockedCount++;
+            return 1;
+        }
+        if (owner != (tTask *)0) {
+            __CLREX();
+            return 0;
+        }
+    } while (tPortStrexPtr(curTask, (void * volatile *)&mutex->owner) != 0);
+
+    mutex->ownerOriginalPrio = curTask->basePrio;
+    mutex->lockedCount = 1;
+    // 只有拥有者自己修改，节拍中断中的运行预算据此判断是否持有互斥量
+    curTask->ownedMutexCount++;
+    tMutexStatLock(mutex);
+    return 1;
+}
+
+//拥有者释放：嵌套时只减少计数；最后一次释放时若没有等待者且未挂入持有列表(未被等待过，优先级未受影响)，
+//直接清除owner，否则返回0由临界区内的完整流程交给等待者并重新计算优先级
+static uint32_t tMutexFastUnlock(tMutex * mutex) {
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    // 释放后其它任务可能立即获得并改写lockStamp，先取出
+    uint32_t lockStamp = mutex->lockStamp;
+#endif
+
+    if ((mutex->owner != curTask) || (mutex->lockedCount == 0)) {
+        return 0;
+    }
+    if (mutex->lockedCount > 1) {
+        mutex->lockedCount--;
+        return 1;
+    }
+
+    mutex->lockedCount = 0;
+    do {
+        (void)tPortLdrexPtr((void * volatile *)&mutex->owner);
+        if (tMutexOwnerLinked(mutex) || (tListCount(&(mutex->event.waitList)) > 0)) {
+            __CLREX();
+            mutex->lockedCount = 1;
+            return 0;
+        }
+    } while (tPortStrexPtr((void *)0, (void * volatile *)&mutex->owner) != 0);
+    curTask->ownedMutexCount--;
+    tMutexStatRelease(mutex, lockStamp);
+    return 1;
 }
+#endif
 
 /**
  * @brief 请求互斥量
@@ -31,13 +312,24 @@ void tMutexInit(tMutex * mutex) {
  * @return tErrorResourceUnavaliable 获取互斥量失败
  */
 uint32_t tMutexWait (tMutex * mutex, uint32_t waitTicks) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    uint32_t status;
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    uint32_t waitStart;
+#endif
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tMutexFastLock(mutex)) {
+        tTraceRecord(tTraceEventMutexWait, mutex, 0);
+        return tErrorNoError;
+    }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventMutexWait, mutex, 0);
 
     // 1.互斥量未锁定，当前任务直接锁定
-    if(mutex->lockedCount <= 0) {
-        mutex->lockedCount++;        // 锁定计数器++
-        mutex->owner = curTask;      // 当前任务成为拥有者
-        mutex->ownerOriginalPrio = curTask->prio; // 记录当前任务的原优先级
+    if(mutex->owner == (tTask *)0) {
+        tMutexSetOwner(mutex, curTask); // 当前任务成为拥有者
         
         tTaskExitCritical(status);  // 退出临界区
         return tErrorNoError;       // 成功获取锁
@@ -52,22 +344,34 @@ uint32_t tMutexWait (tMutex * mutex, uint32_t waitTicks) {
 
     // 3. 低优先级任务请求信号量，但高优先级任务正在锁定
     // 4. 高优先级任务请求信号量，但低优先级任务正在锁定，为了避免优先级反转，将低优先级任务的优先级暂时升到与高优先级任务一致
-    if(curTask->prio < mutex->owner->prio) {
-        if(mutex->owner->state == TINYOS_TASK_STATE_RDY) {
-            tTaskSchedUnRdy(mutex->owner);   // 将拥有锁的任务从就绪队列移除
-            mutex->owner->prio = curTask->prio; // 提升拥有者优先级
-            tTaskSchedRdy(mutex->owner);     // 将拥有者任务重新加入就绪队列
-        } else {
-            mutex->owner->prio = curTask->prio; // 任务不在就绪队列中，只需修改优先级
-        }
-    }
-
     // 请求互斥量，等待中
     tEventWait(&mutex->event, curTask, (void*)0, tEventTypeMutex, waitTicks);
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    mutex->stat.contendCount++;
+    waitStart = tCycleCounterGet();
+#endif
+
+    // 按等待者重新计算拥有者的优先级，拥有者经快速路径获得时先挂入其持有列表，若拥有者也在等待其它互斥量，沿链继续提升
+    tMutexLinkOwner(mutex);
+    tMutexTaskUpdatePrio(mutex->owner);
+    tMutexStatInherit(mutex);
     
     tTaskExitCritical(status);  // 退出临界区
     
     tTaskSched();  // 调度任务
+
+    if (curTask->waitEventResult != tErrorNoError) {
+        // 超时或互斥量被删除，不再等待，拥有者继承的优先级可能需要降低
+        status = tTaskEnterCritical();
+        if (mutex->owner != (tTask *)0) {
+            tMutexTaskUpdatePrio(mutex->owner);
+            tMutexStatInherit(mutex);
+        }
+        tTaskExitCritical(status);
+    }
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    tMutexStatWait(mutex, waitStart);
+#endif
     
     return curTask->waitEventResult; // 返回当前任务的等待结果
 }
@@ -83,13 +387,19 @@ uint32_t tMutexWait (tMutex * mutex, uint32_t waitTicks) {
  * @return tErrorResourceUnavaliable 获取互斥量失败
  */
 uint32_t tMutexNoWaitGet (tMutex * mutex) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    uint32_t status;
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tMutexFastLock(mutex)) {
+        return tErrorNoError;
+    }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
     // 1. 互斥量未锁定，当前任务直接锁定
-    if(mutex->lockedCount <= 0) {
-        mutex->lockedCount++;        // 锁定计数器++
-        mutex->owner = curTask;      // 当前任务成为拥有者
-        mutex->ownerOriginalPrio = curTask->prio; // 记录当前任务的原优先级
+    if(mutex->owner == (tTask *)0) {
+        tMutexSetOwner(mutex, curTask); // 当前任务成为拥有者
         
         tTaskExitCritical(status);  // 退出临界区
         return tErrorNoError;       // 成功获取锁
@@ -117,16 +427,28 @@ uint32_t tMutexNoWaitGet (tMutex * mutex) {
  * 1. 没有任务锁定，则直接返回；
  * 2. 不是拥有者调用释放，认为是非法操作；
  * 3. 锁定计数器大于1，说明任务进行了嵌套锁定，只需减少计数器；
- * 4. 恢复优先级，检查优先级是否比当前任务高，若是则进行重调度。
+ * 4. 唤醒等待的最高优先级任务并交给它；
+ * 5. 按仍持有的其它互斥量重新计算优先级，检查新拥有者优先级是否比当前任务高，若是则进行重调度。
  * 
  * @return tErrorNoError 成功释放互斥量
  * @return tErrorOwner 非法释放
  */
 uint32_t tMutexNotify (tMutex * mutex) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTask * task = (tTask *)0;
+    uint32_t status;
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tMutexFastUnlock(mutex)) {
+        tTraceRecord(tTraceEventMutexNotify, mutex, 0);
+        return tErrorNoError;
+    }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventMutexNotify, mutex, 0);
     
     // 1. 没有任务锁定，则直接返回
-    if (mutex->lockedCount <= 0) {
+    if (mutex->owner == (tTask *)0) {
         tTaskExitCritical(status);  // 退出临界区
         return tErrorNoError;  // 没有任务锁定，直接返回
     }
@@ -143,39 +465,59 @@ uint32_t tMutexNotify (tMutex * mutex) {
         return tErrorNoError;  // 锁定计数器大于1，直接返回
     }
 
-    // 4. 恢复优先级，检查优先级是否比当前任务高，若是则进行重调度
-    if (curTask->prio != mutex->ownerOriginalPrio) {
-        // 若当前任务在就绪队列中，则要先下车再上车
-        if (curTask->state == TINYOS_TASK_STATE_RDY) {
-            tTaskSchedUnRdy(mutex->owner);  // 从就绪队列移除
-            curTask->prio = mutex->ownerOriginalPrio;  // 恢复原优先级
-            tTaskSchedRdy(mutex->owner);  // 重新加入就绪队列
-        } else {
-            // 否则直接修改优先级
-            curTask->prio = mutex->ownerOriginalPrio;
-        }
-    }
-
-    // 如果有任务在等待，则唤醒任务并进行调度
+    // 4. 如果有任务在等待，则唤醒任务，由其锁定互斥量
+    tMutexStatRelease(mutex, mutex->lockStamp);
+    tMutexUnlinkOwner(mutex, curTask);
+    mutex->owner = (tTask *)0;
+    curTask->ownedMutexCount--;
     if (tEventWaitCount(&mutex->event) > 0) {
-        tTask * task = tEventWakeUp(&mutex->event, (void *)0, tErrorNoError);  // 唤醒一个等待任务
+        task = tEventWakeUp(&mutex->event, (void *)0, tErrorNoError);  // 唤醒一个等待任务
 
         // 新任务锁定互斥量
-        mutex->owner = task;
-        mutex->ownerOriginalPrio = task->prio;
-        mutex->lockedCount++;
-
-        // 如果新任务优先级比当前任务低，进行任务调度
-        if (task->prio < curTask->prio) {
-            tTaskExitCritical(status);  // 退出临界区
-            tTaskSched();  // 调度任务
-        }
+        tMutexSetOwner(mutex, task);
     }
+    tMutexStatInherit(mutex);
+
+    // 5. 按仍持有的互斥量重新计算优先级，而不是直接恢复到原优先级
+    tMutexTaskUpdatePrio(curTask);
 
     tTaskExitCritical(status);  // 退出临界区
+
+    // 如果新任务优先级比当前任务高，进行任务调度
+    if ((task != (tTask *)0) && (task->prio < curTask->prio)) {
+        tTaskSched();  // 调度任务
+    }
     return tErrorNoError;  // 成功释放互斥量
 }
 
+/**
+ * @brief 将正在等待其它事件的任务交给互斥量
+ * 
+ * @param mutex 指向互斥量的指针
+ * @param task 正在等待事件的任务
+ * 
+ * 由条件变量唤醒等待者时调用：互斥量空闲时任务直接获得互斥量并就绪；
+ * 否则任务不被唤醒，而是转入互斥量的等待队列，由拥有者释放时交给它，需在临界区内调用。
+ * 
+ * @return 唤醒了比当前任务优先级更高的任务时返回1
+ */
+uint32_t tMutexRequeueTask(tMutex * mutex, tTask * task) {
+    if (mutex->owner == (tTask *)0) {
+        tEventWakeUpTask(task->waitEvent, task, (void *)0, tErrorNoError);
+        tMutexSetOwner(mutex, task);
+        return task->prio < curTask->prio;
+    }
+
+    tEventMoveTask(&mutex->event, task, tEventTypeMutex);
+    tMutexLinkOwner(mutex);
+    tMutexTaskUpdatePrio(mutex->owner);
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    mutex->stat.contendCount++;
+#endif
+    tMutexStatInherit(mutex);
+    return 0;
+}
+
 /**
  * @brief 获取互斥量信息
  * 
@@ -218,25 +560,19 @@ void tMutexGetInfo (tMutex * mutex, tMutexInfo * info) {
 uint32_t tMutexDestroy (tMutex * mutex) {
     uint32_t count = 0;
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tRegistryRemove(&mutex->event.object);
 
     // 判断是否有任务锁定该互斥量
-    if (mutex->lockedCount > 0) {
-        // 判断是否发生了优先级继承，如果有则恢复原优先级
-        if (mutex->ownerOriginalPrio != mutex->owner->prio) {
-            if (mutex->owner->state == TINYOS_TASK_STATE_RDY) {
-                // 任务处于就绪状态时，更改任务在就绪表中的位置
-                tTaskSchedUnRdy(mutex->owner);  // 从就绪队列移除
-                mutex->owner->prio = mutex->ownerOriginalPrio;  // 恢复原优先级
-                tTaskSchedRdy(mutex->owner);  // 重新加入就绪队列
-            } else {
-                // 其它状态下只需要恢复优先级
-                mutex->owner->prio = mutex->ownerOriginalPrio;
-            }
-        }
-
+    if (mutex->owner != (tTask *)0) {
         // 清空事件控制块中的任务
         count = tEventRemoveAll(&mutex->event, (void *)0, tErrorDel);
 
+        // 拥有者不再持有该互斥量，按其它仍持有的互斥量重新计算优先级
+        tMutexStatRelease(mutex, mutex->lockStamp);
+        tMutexClearOwner(mutex);
+        mutex->lockedCount = 0;
+        tMutexStatInherit(mutex);
+
         // 清空过程中可能有任务就绪，执行一次调度
         if (count > 0) {
             tTaskSched();  // 调度任务
@@ -246,4 +582,35 @@ uint32_t tMutexDestroy (tMutex * mutex) {
     tTaskExitCritical(status);  // 退出临界区
     return count;  // 返回清除的等待任务数
 }
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+/**
+ * @brief 读取互斥量的锁定统计
+ * 
+ * @param mutex 指向互斥量的指针
+ * @param stat 存放统计信息的结构体
+ * 
+ * 正在进行的继承时长先计入再读出；正在持有的这一次在释放时才计入持有时长。
+ */
+void tMutexGetStat (tMutex * mutex, tMutexStat * stat) {
+    uint32_t status = tTaskEnterCritical();
+
+    tMutexStatInherit(mutex);
+    *stat = mutex->stat;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 清除互斥量的锁定统计
+ * 
+ * @param mutex 指向互斥量的指针
+ */
+void tMutexResetStat (tMutex * mutex) {
+    uint32_t status = tTaskEnterCritical();
+
+    memset(&mutex->stat, 0, sizeof(mutex->stat));
+    mutex->inheritStamp = tCycleCounterGet();
+    tTaskExitCritical(status);
+}
+#endif
+
 #endif
@@ -1,6 +1,19 @@
 #ifndef __TMUTEX_H
 #define __TMUTEX_H
 #include "tEvent.h"
+#include "tStatic.h"
+
+// 互斥量的锁定统计，时长单位为CPU周期
+typedef struct _tMutexStat {
+    uint32_t lockCount;  // 获得次数，嵌套锁定不计
+    uint32_t contendCount;  // 请求时已被其它任务持有而阻塞等待的次数
+    uint32_t holdCount;  // 已释放的次数，与holdTotalCycles对应
+    uint32_t holdMaxCycles;  // 单次持有的最长时长
+    uint64_t holdTotalCycles;
+    uint32_t waitMaxCycles;  // 单次阻塞等待的最长时长，含超时的等待
+    uint32_t alertCount;  // 优先级数值不大于TINYOS_MUTEX_ALERT_PRIO的任务等待超过TINYOS_MUTEX_ALERT_US的次数
+    uint64_t inheritCycles;  // 拥有者因该互斥量的等待者而被提升优先级的累计时长
+} tMutexStat;
 
 // 互斥量结构体，包含事件控制块、锁定计数器、拥有者及优先级信息
 typedef struct _tMutex {
@@ -8,6 +21,14 @@ typedef struct _tMutex {
     uint32_t lockedCount;  // 锁定计数器
     tTask *owner;  // 当前互斥量拥有者
     uint32_t ownerOriginalPrio;  // 拥有者原始优先级
+    uint32_t ceilingPrio;  // 优先级天花板，为TINYOS_PRIO_COUNT时使用优先级继承
+    tNode ownerNode;  // 挂在拥有者的持有互斥量列表中，经快速路径获得且无人等待时不挂入
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    tMutexStat stat;  // 锁定统计
+    uint32_t lockStamp;  // 本次获得的时间
+    uint32_t inheritStamp;  // 上次更新继承状态的时间
+    uint32_t inheriting;  // 1：拥有者正继承该互斥量的等待者的优先级
+#endif
 } tMutex;
 
 // 互斥量信息结构体，包含任务数量、拥有者信息等
@@ -19,12 +40,34 @@ typedef struct _tMutexInfo {
     uint32_t lockedCount;  // 锁定次数
 } tMutexInfo;
 
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+/**
+ * TINYOS_MUTEX_DEFINE（mutex：互斥量名称）
+ * 编译时定义并初始化使用优先级继承的互斥量，不需要调用tMutexInit
+ */
+#define TINYOS_MUTEX_DEFINE(mutex) \
+    tMutex mutex = { \
+        .event = TINYOS_EVENT_INITIALIZER(mutex.event, tEventTypeMutex, #mutex), \
+        .ownerOriginalPrio = TINYOS_PRIO_COUNT, \
+        .ceilingPrio = TINYOS_PRIO_COUNT, \
+        .ownerNode = TINYOS_NODE_INITIALIZER(mutex.ownerNode), \
+    }; \
+    TINYOS_STATIC_REGISTER(mutex, mutex.event.object)
+#endif
+
 /**
  * tMutexInit（mutex：互斥量指针） 
  * 初始化互斥量，设置事件、锁定计数器、拥有者等信息
  */
 void tMutexInit(tMutex *mutex);
 
+/**
+ * tMutexInitCeiling（mutex：互斥量指针，ceilingPrio：优先级天花板） 
+ * 以立即优先级天花板协议初始化互斥量，锁定时拥有者的优先级立即提升到ceilingPrio
+ * ceilingPrio应不低于所有会使用该互斥量的任务的优先级
+ */
+void tMutexInitCeiling(tMutex *mutex, uint32_t ceilingPrio);
+
 /**
  * tMutexWait（mutex：互斥量指针，waitTicks：等待时间） 
  * 请求互斥量，处理等待和优先级继承
@@ -63,4 +106,32 @@ void tMutexGetInfo(tMutex *mutex, tMutexInfo *info);
  */
 uint32_t tMutexDestroy(tMutex *mutex);
 
+/**
+ * tMutexRequeueTask（mutex：互斥量指针，task：正在等待其它事件的任务） 
+ * 互斥量空闲时唤醒任务并使其成为拥有者，否则将任务转到互斥量的等待队列并按其优先级提升拥有者，需在临界区内调用
+ * 
+ * @return 唤醒了比当前任务优先级更高的任务时返回1
+ */
+uint32_t tMutexRequeueTask(tMutex *mutex, tTask *task);
+
+/**
+ * tMutexTaskUpdatePrio（task：任务指针） 
+ * 按基础优先级(运行预算用完时为后台优先级)、持有的互斥量及作为服务者的同步消息通道重新计算任务的优先级，并沿阻塞链传递，需在临界区内调用
+ */
+void tMutexTaskUpdatePrio(tTask *task);
+
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+/**
+ * tMutexGetStat（mutex：互斥量指针，stat：统计信息指针） 
+ * 读取互斥量的锁定统计，正在持有及正在继承的时长在释放或继承结束时才计入
+ */
+void tMutexGetStat(tMutex *mutex, tMutexStat *stat);
+
+/**
+ * tMutexResetStat（mutex：互斥量指针） 
+ * 清除互斥量的锁定统计
+ */
+void tMutexResetStat(tMutex *mutex);
+#endif
+
 #endif
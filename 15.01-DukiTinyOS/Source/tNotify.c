@@ -0,0 +1,275 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+//条件编译
+#if TINYOS_ENABLE_NOTIFY == 1
+/*
+ * 任务通知直接保存在任务控制块中，发送方只需修改通知值并在接收任务等待时将其就绪，
+ * 不经过tEvent的等待队列，适用于只有一个接收任务的场合(如中断向某个任务传递数据就绪)
+ */
+
+//发送通知的公共部分，需在临界区内调用，返回1表示唤醒了比当前任务优先级更高的任务
+//tTaskGroupNotify在一个临界区内对多个任务调用
+uint32_t tTaskNotifyPost(tTask * task, uint32_t value, tNotifyAction action) {
+    uint8_t prevState = task->notifyState;
+
+    switch (action) {
+        case tNotifyActionSetBits:
+            task->notifyValue |= value;
+            break;
+        case tNotifyActionIncrement:
+            task->notifyValue++;
+            break;
+        case tNotifyActionOverwrite:
+            task->notifyValue = value;
+            break;
+        default:
+            break;
+    }
+    task->notifyState = TINYOS_NOTIFY_STATE_RECEIVED;
+
+    if (prevState != TINYOS_NOTIFY_STATE_WAITING) {
+        return 0;
+    }
+
+    // 接收任务正在等待，从超时队列(若有超时)移出并加入就绪队列
+    task->state &= ~TINYOS_TASK_STATE_NOTIFY_WAIT;
+    if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+        tTimeTaskTimeoutCancel(task);
+    }
+    tTaskSchedRdy(task);
+    return task->prio < curTask->prio;
+}
+
+/**
+ * @brief 向任务发送通知。
+ * 
+ * @param task      接收通知的任务。
+ * @param value     通知值，其含义由action决定。
+ * @param action    对接收任务通知值的操作。
+ * 
+ * @return void
+ */
+void tTaskNotify(tTask * task, uint32_t value, tNotifyAction action) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tTaskNotifyPost(task, value, action);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+/*
+ * 中断中发送通知不进入临界区：通知值及接收状态用LDREX/STREX修改，接收任务正在等待时把它压入待就绪链表，
+ * 挂起PendSV，由PendSV在选择切入任务前统一加入就绪表。任务代码在临界区内读写这两个字段，
+ * 期间可调用内核API的中断被屏蔽；PendSV优先级最低，压入链表后任务代码运行前必然已经处理过。
+ */
+static tTask * volatile tTaskIsrReadyHead;
+
+//压入待就绪链表，中断可以嵌套，后进先出
+static void tTaskIsrReadyPush(tTask * task) {
+#ifdef TINYOS_PORT_POSIX
+    //仿真中只有节拍一个“中断”，不会嵌套，指针也不是32位
+    task->isrReadyNext = tTaskIsrReadyHead;
+    tTaskIsrReadyHead = task;
+#else
+    tTask * head;
+
+    do {
+        head = (tTask *)__LDREXW((volatile uint32_t *)&tTaskIsrReadyHead);
+        task->isrReadyNext = head;
+    } while (__STREXW((uint32_t)task, (volatile uint32_t *)&tTaskIsrReadyHead) != 0);
+#endif
+}
+
+/**
+ * @brief 在中断服务函数中向任务发送通知，不关中断，唤醒的任务由PendSV加入就绪表。
+ * 
+ * @return void
+ */
+void tTaskNotifyFromISR(tTask * task, uint32_t value, tNotifyAction action) {
+    uint32_t old, next;
+
+    if (action != tNotifyActionNone) {
+        do {
+            old = __LDREXW((volatile uint32_t *)&task->notifyValue);
+            switch (action) {
+                case tNotifyActionSetBits:
+                    next = old | value;
+                    break;
+                case tNotifyActionIncrement:
+                    next = old + 1;
+                    break;
+                default:
+                    next = value;
+                    break;
+            }
+        } while (__STREXW(next, (volatile uint32_t *)&task->notifyValue) != 0);
+    }
+
+    // 只有把等待改为已收到的一方负责入队，同一次等待不会入队两次
+    do {
+        old = __LDREXW((volatile uint32_t *)&task->notifyState);
+    } while (__STREXW(TINYOS_NOTIFY_STATE_RECEIVED, (volatile uint32_t *)&task->notifyState) != 0);
+
+    if (old == TINYOS_NOTIFY_STATE_WAITING) {
+        tTaskIsrReadyPush(task);
+        tTaskSwitch();
+    }
+}
+
+/**
+ * @brief 把待就绪链表中的任务加入就绪表并重新调度，由PendSV在比较curTask与nextTask之前调用
+ * 
+ * 期间已超时唤醒的任务(超时处理已清除等待标志)不再处理。
+ * 
+ * @return void
+ */
+void tTaskIsrReadyDrain(void) {
+    tTask * task;
+    uint32_t status;
+
+    if (tTaskIsrReadyHead == (tTask *)0) {
+        return;
+    }
+
+    status = tTaskEnterCritical();
+    task = tTaskIsrReadyHead;
+    tTaskIsrReadyHead = (tTask *)0;
+    while (task != (tTask *)0) {
+        tTask * next = task->isrReadyNext;
+
+        if (task->state & TINYOS_TASK_STATE_NOTIFY_WAIT) {
+            task->state &= ~TINYOS_TASK_STATE_NOTIFY_WAIT;
+            if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+                tTimeTaskTimeoutCancel(task);
+            }
+            tTaskSchedRdy(task);
+        }
+        task = next;
+    }
+    tTaskExitCritical(status);
+
+    // 更新nextTask，其中重新挂起的PendSV由调用者清除
+    tTaskSched();
+}
+#else
+/**
+ * @brief 在中断服务函数中向任务发送通知，唤醒任务后只标记需要调度，由tIntExit统一触发。
+ * 
+ * @return void
+ */
+void tTaskNotifyFromISR(tTask * task, uint32_t value, tNotifyAction action) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+
+    sched = tTaskNotifyPost(task, value, action);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+}
+#endif
+
+//以计数信号量的方式使用通知：通知值加1
+void tTaskNotifyGive(tTask * task) {
+    tTaskNotify(task, 0, tNotifyActionIncrement);
+}
+
+void tTaskNotifyGiveFromISR(tTask * task) {
+    tTaskNotifyFromISR(task, 0, tNotifyActionIncrement);
+}
+
+/**
+ * @brief 当前任务等待通知。
+ * 
+ * @param clearOnEntry  开始等待前(尚未收到通知时)需要清除的通知值位。
+ * @param clearOnExit   收到通知后需要清除的通知值位。
+ * @param value         用于返回通知值(清除前)，可为NULL。
+ * @param waitTicks     最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t     `tErrorNoError`表示收到通知，`tErrorTimeOut`表示等待超时。
+ */
+uint32_t tTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t * value, uint32_t waitTicks) {
+    uint32_t err = tErrorNoError;
+    uint32_t status = tTaskEnterCritical();
+
+    if (curTask->notifyState != TINYOS_NOTIFY_STATE_RECEIVED) {
+        // 尚未收到通知，挂起当前任务
+        curTask->notifyValue &= ~clearOnEntry;
+        curTask->notifyState = TINYOS_NOTIFY_STATE_WAITING;
+        curTask->state |= TINYOS_TASK_STATE_NOTIFY_WAIT;
+        tTaskSchedUnRdy(curTask);
+        if (waitTicks) {
+            tTimeTaskTimeoutStart(curTask, waitTicks);
+        }
+        tTaskExitCritical(status);
+
+        tTaskSched();
+
+        status = tTaskEnterCritical();
+    }
+
+    if (value) {
+        *value = curTask->notifyValue;
+    }
+
+    if (curTask->notifyState != TINYOS_NOTIFY_STATE_RECEIVED) {
+        // 由超时队列超时唤醒
+        curTask->state &= ~TINYOS_TASK_STATE_NOTIFY_WAIT;
+        err = tErrorTimeOut;
+    } else {
+        curTask->notifyValue &= ~clearOnExit;
+    }
+    curTask->notifyState = TINYOS_NOTIFY_STATE_NONE;
+
+    tTaskExitCritical(status);
+    return err;
+}
+
+/**
+ * @brief 以计数信号量的方式等待通知。
+ * 
+ * @param clearOnExit   为1时收到通知后将通知值清零(二值信号量)，为0时减1(计数信号量)。
+ * @param waitTicks     最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t     收到通知前的通知值，超时返回0。
+ */
+uint32_t tTaskNotifyTake(uint8_t clearOnExit, uint32_t waitTicks) {
+    uint32_t value;
+    uint32_t status = tTaskEnterCritical();
+
+    if (curTask->notifyValue == 0) {
+        curTask->notifyState = TINYOS_NOTIFY_STATE_WAITING;
+        curTask->state |= TINYOS_TASK_STATE_NOTIFY_WAIT;
+        tTaskSchedUnRdy(curTask);
+        if (waitTicks) {
+            tTimeTaskTimeoutStart(curTask, waitTicks);
+        }
+        tTaskExitCritical(status);
+
+        tTaskSched();
+
+        status = tTaskEnterCritical();
+        curTask->state &= ~TINYOS_TASK_STATE_NOTIFY_WAIT;
+    }
+
+    value = curTask->notifyValue;
+    if (value != 0) {
+        if (clearOnExit) {
+            curTask->notifyValue = 0;
+        } else {
+            curTask->notifyValue--;
+        }
+    }
+    curTask->notifyState = TINYOS_NOTIFY_STATE_NONE;
+
+    tTaskExitCritical(status);
+    return value;
+}
+#endif
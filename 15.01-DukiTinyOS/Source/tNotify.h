@@ -0,0 +1,27 @@
+#ifndef __TNOTIFY_H
+#define __TNOTIFY_H
+
+// 任务通知的接收状态
+#define TINYOS_NOTIFY_STATE_NONE        0
+#define TINYOS_NOTIFY_STATE_WAITING     1
+#define TINYOS_NOTIFY_STATE_RECEIVED    2
+
+// 发送通知时对通知值的操作
+typedef enum _tNotifyAction {
+	tNotifyActionNone,          // 不修改通知值，只唤醒任务
+	tNotifyActionSetBits,       // 通知值按位或
+	tNotifyActionIncrement,     // 通知值加1，可作为轻量的计数信号量
+	tNotifyActionOverwrite,     // 直接覆盖通知值
+}tNotifyAction;
+
+void tTaskNotify(tTask * task, uint32_t value, tNotifyAction action);
+uint32_t tTaskNotifyPost(tTask * task, uint32_t value, tNotifyAction action);//需在临界区内调用，返回1表示需要调度
+void tTaskNotifyFromISR(tTask * task, uint32_t value, tNotifyAction action);
+void tTaskNotifyGive(tTask * task);
+void tTaskNotifyGiveFromISR(tTask * task);
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+void tTaskIsrReadyDrain(void);
+#endif
+uint32_t tTaskNotifyTake(uint8_t clearOnExit, uint32_t waitTicks);
+uint32_t tTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t * value, uint32_t waitTicks);
+#endif
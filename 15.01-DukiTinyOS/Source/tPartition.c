@@ -0,0 +1,239 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_PARTITION == 1
+
+#if TINYOS_PARTITION_COUNT >= TINYOS_PARTITION_NONE
+#error "TINYOS_PARTITION_COUNT must be less than 255"
+#endif
+
+static uint8_t tPartitionOfPrio[TINYOS_PRIO_COUNT];        //各优先级所属的分区，TINYOS_PARTITION_NONE为公共优先级
+static tBitMap tPartitionMap[TINYOS_PARTITION_COUNT];      //各分区窗口内可调度的优先级：本分区及公共优先级
+static tBitMap tPartitionCommonMap;                        //不属于任何分区的窗口内可调度的优先级
+static uint32_t tPartitionInited;
+
+static tHrTimer tPartitionTimer;
+static const tPartitionWindow * tPartitionWindows;
+static uint32_t tPartitionWindowCount;
+static uint32_t tPartitionWindowIndex;                     //当前窗口
+static uint32_t tPartitionWindowEnd;                       //当前窗口的结束时刻(TIM5计数值)
+static tPartitionInfo tPartitionStat;
+
+//调度使用的优先级掩码，tTaskHighestReady只在其中查找；为0时未按窗口调度，所有优先级均可调度
+TINYOS_FAST_DATA tBitMap * tPartitionActiveMap;
+
+//未划分前所有优先级均为公共优先级，第一次使用时初始化
+static void tPartitionInitMaps(void) {
+    uint32_t prio;
+
+    if (tPartitionInited) {
+        return;
+    }
+    for (prio = 0; prio < TINYOS_PRIO_COUNT; prio++) {
+        tPartitionOfPrio[prio] = TINYOS_PARTITION_NONE;
+    }
+    tPartitionInited = 1;
+}
+
+//按各优先级所属的分区重建掩码，需在临界区内调用
+static void tPartitionBuildMaps(void) {
+    uint32_t prio, part;
+
+    tBitMapInit(&tPartitionCommonMap);
+    for (part = 0; part < TINYOS_PARTITION_COUNT; part++) {
+        tBitMapInit(&tPartitionMap[part]);
+    }
+    for (prio = 0; prio < TINYOS_PRIO_COUNT; prio++) {
+        part = tPartitionOfPrio[prio];
+        if (part == TINYOS_PARTITION_NONE) {
+            tBitMapSet(&tPartitionCommonMap, prio);
+            for (part = 0; part < TINYOS_PARTITION_COUNT; part++) {
+                tBitMapSet(&tPartitionMap[part], prio);
+            }
+        } else {
+            tBitMapSet(&tPartitionMap[part], prio);
+        }
+    }
+}
+
+//切换到第index个窗口的掩码，需在临界区内调用
+static void tPartitionActivate(uint32_t index) {
+    uint32_t part = tPartitionWindows[index].partition;
+
+    tPartitionWindowIndex = index;
+    tPartitionStat.window = index;
+    tPartitionStat.partition = part;
+    tPartitionActiveMap = (part == TINYOS_PARTITION_NONE) ? &tPartitionCommonMap : &tPartitionMap[part];
+}
+
+//装载当前窗口的结束时刻，已过时立即触发
+static void tPartitionArm(void) {
+    int32_t delay = (int32_t)(tPartitionWindowEnd - tHrTimerGetCounter());
+
+    tHrTimerStart(&tPartitionTimer, (delay > 0) ? (uint32_t)delay : 0, 0);
+}
+
+//TIM5中断中调用：窗口结束，切换到下一个窗口并重新调度
+static void tPartitionTimerFunc(void * arg) {
+    uint32_t latency = tHrTimerGetCounter() - tPartitionWindowEnd;
+    uint32_t index = tPartitionWindowIndex + 1;
+
+    (void)arg;
+    if (latency > tPartitionStat.maxLatencyUs) {
+        tPartitionStat.maxLatencyUs = latency;
+    }
+    if (index >= tPartitionWindowCount) {
+        index = 0;
+        tPartitionStat.frames++;
+    }
+    tPartitionActivate(index);
+    tPartitionWindowEnd += tPartitionWindows[index].durationUs;
+    tPartitionArm();
+    // TIM5中断已调用tIntEnter，在中断退出时切换到新窗口的最高优先级任务
+    tTaskSchedFromISR();
+}
+
+/**
+ * @brief 把优先级prioFirst ~ prioLast划分给分区，应在tPartitionStart之前调用
+ *
+ * 空闲任务的优先级不能划分，始终为公共优先级；已划分给其它分区的优先级不能重复划分。
+ * 按窗口调度期间划分的优先级从下一次调度判断起生效。
+ *
+ * @param partition 分区，0 ~ TINYOS_PARTITION_COUNT - 1，为TINYOS_PARTITION_NONE时恢复为公共优先级
+ * @param prioFirst 第一个优先级
+ * @param prioLast  最后一个优先级，不小于prioFirst
+ *
+ * @return uint32_t tErrorNoError；参数超出范围时返回tErrorParam，与其它分区重叠时返回tErrorOwner
+ */
+uint32_t tPartitionAssign(uint32_t partition, uint32_t prioFirst, uint32_t prioLast) {
+    uint32_t status;
+    uint32_t prio;
+
+    if (((partition >= TINYOS_PARTITION_COUNT) && (partition != TINYOS_PARTITION_NONE))
+        || (prioFirst > prioLast) || (prioLast >= TINYOS_PRIO_COUNT - 1)) {
+        return tErrorParam;
+    }
+
+    status = tTaskEnterCritical();
+    tPartitionInitMaps();
+    if (partition != TINYOS_PARTITION_NONE) {
+        for (prio = prioFirst; prio <= prioLast; prio++) {
+            if ((tPartitionOfPrio[prio] != TINYOS_PARTITION_NONE) && (tPartitionOfPrio[prio] != partition)) {
+                tTaskExitCritical(status);
+                return tErrorOwner;
+            }
+        }
+    }
+    for (prio = prioFirst; prio <= prioLast; prio++) {
+        tPartitionOfPrio[prio] = (uint8_t)partition;
+    }
+    tPartitionBuildMaps();
+    tTaskExitCritical(status);
+    return tErrorNoError;
+}
+
+//调度器启动后立即按新的掩码调度，启动前由tTinyOSStart选择第一个任务
+static void tPartitionResched(void) {
+    if (curTask != (tTask *)0) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 开始按窗口调度，已在调度的表被替换；第一个窗口从现在开始
+ *
+ * @param windows 窗口表，依次组成一个主帧，调度期间不能修改
+ * @param count   窗口数
+ *
+ * @return uint32_t tErrorNoError；表为空、窗口长度为0或分区无效时返回tErrorParam
+ */
+uint32_t tPartitionStart(const tPartitionWindow * windows, uint32_t count) {
+    uint32_t status;
+    uint32_t i, part;
+    uint32_t majorUs = 0;
+
+    if (count == 0) {
+        return tErrorParam;
+    }
+    for (i = 0; i < count; i++) {
+        part = windows[i].partition;
+        if ((windows[i].durationUs == 0) || ((part >= TINYOS_PARTITION_COUNT) && (part != TINYOS_PARTITION_NONE))) {
+            return tErrorParam;
+        }
+        majorUs += windows[i].durationUs;
+    }
+
+    tPartitionStop();
+    status = tTaskEnterCritical();
+    tPartitionInitMaps();
+    tPartitionBuildMaps();
+    tPartitionWindows = windows;
+    tPartitionWindowCount = count;
+    tPartitionStat.running = 1;
+    tPartitionStat.majorUs = majorUs;
+    tPartitionStat.frames = 0;
+    tPartitionStat.maxLatencyUs = 0;
+    for (part = 0; part < TINYOS_PARTITION_COUNT; part++) {
+        tPartitionStat.windowUs[part] = 0;
+    }
+    for (i = 0; i < count; i++) {
+        if (windows[i].partition != TINYOS_PARTITION_NONE) {
+            tPartitionStat.windowUs[windows[i].partition] += windows[i].durationUs;
+        }
+    }
+    tPartitionActivate(0);
+    tPartitionWindowEnd = tHrTimerGetCounter() + windows[0].durationUs;
+    tHrTimerInit(&tPartitionTimer, tPartitionTimerFunc, (void *)0);
+    tPartitionArm();
+    tTaskExitCritical(status);
+    tPartitionResched();
+    return tErrorNoError;
+}
+
+/**
+ * @brief 停止按窗口调度，所有优先级恢复按优先级调度
+ *
+ * @return void
+ */
+void tPartitionStop(void) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (tPartitionWindows != (const tPartitionWindow *)0) {
+        tHrTimerStop(&tPartitionTimer);
+        tPartitionWindows = (const tPartitionWindow *)0;
+        tPartitionStat.running = 0;
+        tPartitionActiveMap = (tBitMap *)0;
+    }
+    tTaskExitCritical(status);
+    tPartitionResched();
+}
+
+/**
+ * @brief 判断优先级在当前窗口内是否可以调度，未按窗口调度时均可调度
+ *
+ * @param prio 优先级
+ *
+ * @return uint32_t 1可以调度，0不可以
+ */
+TINYOS_FAST_CODE uint32_t tPartitionPrioActive(uint32_t prio) {
+    uint32_t part;
+
+    if (tPartitionActiveMap == (tBitMap *)0) {
+        return 1;
+    }
+    part = tPartitionOfPrio[prio];
+    return (part == TINYOS_PARTITION_NONE) || (part == tPartitionStat.partition);
+}
+
+/**
+ * @brief 读取窗口调度的状态及统计
+ *
+ * @param info 统计信息
+ *
+ * @return void
+ */
+void tPartitionGetInfo(tPartitionInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+    *info = tPartitionStat;
+    tTaskExitCritical(status);
+}
+#endif
@@ -0,0 +1,38 @@
+#ifndef __TPARTITION_H
+#define __TPARTITION_H
+
+#include <stdint.h>
+#include "tLib.h"
+
+// 时间分区：把优先级划分给若干分区，主帧由固定长度的窗口组成，每个窗口属于一个分区，主帧结束后从头重复。
+// 窗口内只有该分区的优先级及未划分的公共优先级参与调度，其余分区的任务即使就绪也不运行，
+// 一个分区用满自己的窗口也不会占用其它分区的时间。窗口边界由高精度定时器按主帧起点累加计算，不随中断延迟漂移；
+// 切换窗口只替换调度使用的优先级掩码，tTaskHighestReady多一次按位与，开销固定。
+// 公共优先级(空闲任务、内核服务任务等)在每个窗口都可运行，占用的时间计入当时的窗口，应只放短小的任务；
+// 任务的优先级被跨分区的互斥量提升或被运行预算降级后，按新的优先级所属的分区调度。需开启HRTIMER
+#define TINYOS_PARTITION_COUNT      4       // 分区数
+#define TINYOS_PARTITION_NONE       0xFF    // 窗口不属于任何分区，只运行公共优先级的任务
+
+typedef struct _tPartitionWindow {
+	uint32_t partition;             //所属分区，0 ~ TINYOS_PARTITION_COUNT - 1或TINYOS_PARTITION_NONE
+	uint32_t durationUs;            //窗口长度(us)
+}tPartitionWindow;
+
+typedef struct _tPartitionInfo {
+	uint32_t running;               //是否在按窗口调度
+	uint32_t partition;             //当前窗口所属的分区
+	uint32_t window;                //当前窗口在表中的序号
+	uint32_t majorUs;               //主帧长度(us)
+	uint32_t frames;                //已完成的主帧数
+	uint32_t maxLatencyUs;          //窗口边界到切换的最大延迟
+	uint32_t windowUs[TINYOS_PARTITION_COUNT];  //每个主帧中各分区的窗口总长度(us)
+}tPartitionInfo;
+
+extern tBitMap * tPartitionActiveMap;
+
+uint32_t tPartitionAssign(uint32_t partition, uint32_t prioFirst, uint32_t prioLast);
+uint32_t tPartitionStart(const tPartitionWindow * windows, uint32_t count);
+void tPartitionStop(void);
+uint32_t tPartitionPrioActive(uint32_t prio);
+void tPartitionGetInfo(tPartitionInfo * info);
+#endif
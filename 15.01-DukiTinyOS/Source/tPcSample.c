@@ -0,0 +1,214 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_PC_SAMPLE == 1
+#include "stm32f4xx.h"  // TIM2，主机仿真时由tConfigCheck.h拒绝开启，本文件为空
+
+#if (TINYOS_PC_SAMPLE_HZ < 16) || (TINYOS_PC_SAMPLE_HZ > 100000)
+#error "TINYOS_PC_SAMPLE_HZ must be within 16 ~ 100000"
+#endif
+
+// 硬件压入的栈帧中PC及xPSR的位置(字)，浮点扩展栈帧中位置相同
+#define TPCSAMPLE_FRAME_PC      6
+#define TPCSAMPLE_FRAME_XPSR    7
+
+static uint32_t pcSampleHist[TINYOS_PC_SAMPLE_BUCKETS];
+static volatile uint32_t pcSampleCount;
+static volatile uint32_t pcSampleOutside;
+static volatile uint32_t pcSampleInIrq;
+static uint32_t pcSamplePeriod;         // 平均采样间隔(us)减去抖动范围的一半
+static uint32_t pcSampleDitherMask;     // 抖动范围为0 ~ pcSampleDitherMask(us)
+static uint32_t pcSampleRandom = 0x2545F491u;
+static uint8_t pcSampleRunning;
+
+void tPcSampleIsr(uint32_t * frame);
+
+// 采样入口：取出被打断的上下文使用的栈帧交给tPcSampleIsr，入口处不压栈，MSP即为栈帧
+#if defined(__CC_ARM)
+__asm void TIM2_IRQHandler(void) {
+	IMPORT tPcSampleIsr
+
+	TST LR,#4
+	ITE EQ
+	MRSEQ R0,MSP
+	MRSNE R0,PSP
+	B tPcSampleIsr
+}
+#elif defined(__GNUC__) || defined(__clang__)
+__attribute__((naked)) void TIM2_IRQHandler(void) {
+	__asm volatile (
+	"	.syntax unified					\n"
+	"	tst lr, #4						\n"
+	"	ite eq							\n"
+	"	mrseq r0, msp					\n"
+	"	mrsne r0, psp					\n"
+	"	b tPcSampleIsr					\n"
+	);
+}
+#else
+#error "unsupported compiler"
+#endif
+
+/**
+ * @brief 记录一次采样，由TIM2_IRQHandler调用
+ *
+ * 下一次的间隔在平均值附近随机抖动，采样不会与固定周期的控制回路锁相而总落在同一段代码上。
+ *
+ * @param frame 被打断的上下文的栈帧
+ *
+ * @return void
+ */
+void tPcSampleIsr(uint32_t * frame) {
+    uint32_t index = (frame[TPCSAMPLE_FRAME_PC] - TINYOS_PC_SAMPLE_BASE) >> TINYOS_PC_SAMPLE_SHIFT;
+    uint32_t r = pcSampleRandom;
+
+    TIM2->SR = ~TIM_SR_UIF;
+    if (index < TINYOS_PC_SAMPLE_BUCKETS) {
+        pcSampleHist[index]++;
+    } else {
+        pcSampleOutside++;
+    }
+    // xPSR的异常号不为0：被打断的是中断服务
+    if (frame[TPCSAMPLE_FRAME_XPSR] & 0x1FF) {
+        pcSampleInIrq++;
+    }
+    pcSampleCount++;
+
+    // xorshift32
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    pcSampleRandom = r;
+    // 更新中断刚发生，计数值远小于新的重装值，直接写入ARR在本周期生效
+    TIM2->ARR = pcSamplePeriod + (r & pcSampleDitherMask) - 1;
+}
+
+// TIM2挂在APB1上，APB1分频不为1时定时器时钟为PCLK1的两倍
+static uint32_t tPcSampleTimerClock(void) {
+    uint32_t timClk = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        timClk *= 2;
+    }
+    return timClk;
+}
+
+/**
+ * @brief 开始采样，直方图从上次停止处继续累加，需要时先调用tPcSampleReset
+ *
+ * TIM2按1MHz计数，平均间隔为1000000 / TINYOS_PC_SAMPLE_HZ微秒，抖动范围为其1/4以内最大的2的幂。
+ *
+ * @return void
+ */
+void tPcSampleStart(void) {
+    uint32_t period = 1000000u / TINYOS_PC_SAMPLE_HZ;
+    uint32_t dither = 1;
+
+    while ((dither << 1) <= (period >> 2)) {
+        dither <<= 1;
+    }
+    pcSampleDitherMask = dither - 1;
+    pcSamplePeriod = period - (dither >> 1);
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    TIM2->CR1 = 0;
+    TIM2->PSC = tPcSampleTimerClock() / 1000000 - 1;
+    TIM2->ARR = pcSamplePeriod - 1;
+    TIM2->CNT = 0;
+    TIM2->EGR = TIM_EGR_UG;             // 装载预分频值
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(TIM2_IRQn, TINYOS_PC_SAMPLE_IRQ_PRIO);
+    NVIC_EnableIRQ(TIM2_IRQn);
+
+    pcSampleRunning = 1;
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+/**
+ * @brief 停止采样，直方图保留，可以之后再输出
+ *
+ * @return void
+ */
+void tPcSampleStop(void) {
+    TIM2->CR1 = 0;
+    TIM2->DIER = 0;
+    NVIC_DisableIRQ(TIM2_IRQn);
+    pcSampleRunning = 0;
+}
+
+/**
+ * @brief 清零直方图及计数，采样中调用时与采样中断之间不同步，清零期间的几次采样可能丢失
+ *
+ * @return void
+ */
+void tPcSampleReset(void) {
+    uint32_t i;
+
+    for (i = 0; i < TINYOS_PC_SAMPLE_BUCKETS; i++) {
+        pcSampleHist[i] = 0;
+    }
+    pcSampleCount = 0;
+    pcSampleOutside = 0;
+    pcSampleInIrq = 0;
+}
+
+/**
+ * @brief 获取采样的计数
+ *
+ * @param info 采样的计数
+ *
+ * @return void
+ */
+void tPcSampleGetInfo(tPcSampleInfo * info) {
+    info->running = pcSampleRunning;
+    info->samples = pcSampleCount;
+    info->outside = pcSampleOutside;
+    info->inIrq = pcSampleInIrq;
+}
+
+/**
+ * @brief 按文本输出直方图，供Tools/pcprofile.py解析，采样中也可调用
+ *
+ * 第一行为"PCS,起始地址(十六进制),组宽位数,组数,采样频率,采样总数,范围外次数,中断中次数"，
+ * 之后每个非0的组一行"PCB,组号,次数"，最后一行为"PCE"。
+ *
+ * @param put 输出函数
+ * @param ctx 输出函数的参数
+ *
+ * @return uint32_t 输出的非0组数
+ */
+uint32_t tPcSampleDump(tFormatPut put, void * ctx) {
+    uint32_t i, count, lines = 0;
+
+    tFormat(put, ctx, "PCS,%x,%u,%u,%u,%u,%u,%u\r\n", (unsigned)TINYOS_PC_SAMPLE_BASE, (unsigned)TINYOS_PC_SAMPLE_SHIFT,
+            (unsigned)TINYOS_PC_SAMPLE_BUCKETS, (unsigned)TINYOS_PC_SAMPLE_HZ, (unsigned)pcSampleCount,
+            (unsigned)pcSampleOutside, (unsigned)pcSampleInIrq);
+    for (i = 0; i < TINYOS_PC_SAMPLE_BUCKETS; i++) {
+        count = pcSampleHist[i];
+        if (count != 0) {
+            tFormat(put, ctx, "PCB,%u,%u\r\n", (unsigned)i, (unsigned)count);
+            lines++;
+        }
+    }
+    tFormat(put, ctx, "PCE\r\n");
+    return lines;
+}
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+/**
+ * @brief 定时器时钟改变后重设预分频，保持1MHz计数及采样频率，在调频的临界区内调用
+ *
+ * 预分频在下一次更新事件(即下一次采样)时装载，期间的一个间隔按原来的计数速率。
+ *
+ * @return void
+ */
+void tPcSampleClockChanged(void) {
+    if (pcSampleRunning) {
+        TIM2->PSC = tClockTimerFreq() / 1000000 - 1;
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __TPCSAMPLE_H
+#define __TPCSAMPLE_H
+
+#include <stdint.h>
+#include "tFormat.h"
+
+// 统计采样剖析：TIM2以TINYOS_PC_SAMPLE_HZ(每次加随机抖动)中断，取出硬件压栈的被打断处PC，
+// 按(PC - TINYOS_PC_SAMPLE_BASE) >> TINYOS_PC_SAMPLE_SHIFT计入直方图，不在范围内的(如在RAM中执行的代码)只计数。
+// 中断优先级高于内核临界区，任务、内核、HAL、libm及其它中断中的代码都能采到，得到整个固件的平坦剖析；
+// 使用PRIMASK实现临界区(TINYOS_CRITICAL_USE_BASEPRI为0)时临界区内的采样推迟到临界区结束处。
+// 中断中只做一次除法外的几次整数运算及计数，不调用内核API。
+// tPcSampleDump按文本输出直方图，输出函数可以写串口、RTT或日志缓冲区，主机上用Tools/pcprofile.py
+// 结合同一次编译的axf/elf或map文件把各组地址还原为函数并排序
+typedef struct _tPcSampleInfo {
+	uint32_t running;                //是否正在采样
+	uint32_t samples;                //采样总数
+	uint32_t outside;                //PC不在直方图范围内的次数
+	uint32_t inIrq;                  //打断的是中断服务(含PendSV、SysTick)的次数
+}tPcSampleInfo;
+
+void tPcSampleStart(void);
+void tPcSampleStop(void);
+void tPcSampleReset(void);
+void tPcSampleGetInfo(tPcSampleInfo * info);
+uint32_t tPcSampleDump(tFormatPut put, void * ctx);
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+void tPcSampleClockChanged(void);
+#endif
+#endif
@@ -0,0 +1,139 @@
+#ifndef __TPORT_H
+#define __TPORT_H
+
+#include <stdint.h>
+#include "tConfig.h"
+
+// 移植层接口，内核中与处理器相关的部分都经由这里：
+//   上下文切换：PendSV_Handler、tTaskStackInit、tTaskRunFirst、tTaskSwitch
+//   临界区：tTaskEnterCritical、tTaskExitCritical
+//   以上由Port/ARM_CMx/tPortCpu.c实现，按TINYOS_PORT_CORE只编译其中一个，每个文件同时包含ARMCC与GCC/Clang两种写法
+//   节拍定时器、DWT周期计数、MPU栈保护、空闲休眠(tPortIdle)：各Cortex-M内核相同，由Source/tCpu.c实现
+//   前导/末尾零计数：tPortClz、tPortCtz，见下文
+//   指针的独占访问：tPortLdrexPtr、tPortStrexPtr，见下文
+//   数据缓存维护及热点代码/数据的放置：tPortDCacheClean、tPortDCacheInvalidate、TINYOS_FAST_CODE、TINYOS_FAST_DATA
+// 在主机上仿真运行时编译选项中定义TINYOS_PORT_POSIX，以上全部由Port/Posix提供
+#ifdef TINYOS_PORT_POSIX
+#include "tPortPosix.h"
+#else
+#include TINYOS_PORT_DEVICE_HEADER
+
+#if TINYOS_PORT_CORE == 0
+// ARMv6-M没有BASEPRI、DWT周期计数器及LDREX/STREX，MPU区域最小256字节
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+#error "Cortex-M0 has no BASEPRI, set TINYOS_CRITICAL_USE_BASEPRI to 0"
+#endif
+#if (TINYOS_ENABLE_PROFILING == 1) || (TINYOS_ENABLE_CPUUSAGE_STATE == 1) || (TINYOS_ENABLE_TRACE == 1) || (TINYOS_ENABLE_LOG == 1) || (TINYOS_ENABLE_BENCHMARK != 0) || (TINYOS_ENABLE_CRIT_PROFILE == 1) || (TINYOS_ENABLE_IRQ_STAT == 1) || (TINYOS_ENABLE_MUTEX_STAT == 1) || (TINYOS_ENABLE_TICK_OVERRUN == 1)
+#error "Cortex-M0 has no DWT cycle counter"
+#endif
+#if (TINYOS_ENABLE_SLAB == 1) || (TINYOS_ENABLE_WORKQUEUE == 1) || (TINYOS_ENABLE_ATOMIC_FASTPATH == 1) || (TINYOS_ENABLE_LOG == 1) || (TINYOS_ENABLE_ISR_READY_QUEUE == 1)
+#error "Cortex-M0 has no LDREX/STREX required by the lock-free slab, work queue, log, atomic fast paths and ISR ready queue"
+#endif
+#if TINYOS_ENABLE_STACK_GUARD == 1
+#error "TINYOS_ENABLE_STACK_GUARD requires an ARMv7-M MPU"
+#endif
+#if TINYOS_ENABLE_USER_MODE == 1
+#error "TINYOS_ENABLE_USER_MODE requires an ARMv7-M MPU"
+#endif
+#endif
+#endif
+
+#if (TINYOS_PORT_CORE == 0) && !defined(TINYOS_PORT_POSIX)
+/**
+ * @brief 前导零个数，M0没有CLZ指令，二分查找
+ *
+ * @param word 待查找的字
+ *
+ * @return uint32_t 最高的1之前0的个数，word为0时返回32
+ */
+static __inline uint32_t tPortClz(uint32_t word) {
+    uint32_t n = 0;
+
+    if (word == 0) {
+        return 32;
+    }
+    if ((word & 0xFFFF0000) == 0) {
+        n += 16;
+        word <<= 16;
+    }
+    if ((word & 0xFF000000) == 0) {
+        n += 8;
+        word <<= 8;
+    }
+    if ((word & 0xF0000000) == 0) {
+        n += 4;
+        word <<= 4;
+    }
+    if ((word & 0xC0000000) == 0) {
+        n += 2;
+        word <<= 2;
+    }
+    if ((word & 0x80000000) == 0) {
+        n += 1;
+    }
+    return n;
+}
+
+// 只保留最低的1后，其序号即为31减前导零个数
+#define tPortCtz(word)      (31 - tPortClz((word) & (0 - (word))))
+#else
+#define tPortClz(word)      __CLZ(word)
+#define tPortCtz(word)      __CLZ(__RBIT(word))
+#endif
+
+#ifndef TINYOS_PORT_POSIX
+//对指针做LDREX/STREX：目标板上指针为32位，直接按字访问；主机仿真在64位主机上指针为64位，
+//由tPortPosix.h按指针宽度提供，不需要-m32
+#define tPortLdrexPtr(addr)             ((void *)__LDREXW((volatile uint32_t *)(addr)))
+#define tPortStrexPtr(value, addr)      __STREXW((uint32_t)(value), (volatile uint32_t *)(addr))
+#endif
+
+#if (TINYOS_PORT_CORE == 7) && !defined(TINYOS_PORT_POSIX)
+//带数据缓存的内核上，DMA收发的缓冲区在启动传输前清除、传输完成后作废对应的缓存行
+void tPortDCacheClean(void * addr, uint32_t size);
+void tPortDCacheInvalidate(void * addr, uint32_t size);
+#else
+//没有数据缓存，DMA与CPU看到的内存总是一致的
+#define tPortDCacheClean(addr, size)
+#define tPortDCacheInvalidate(addr, size)
+#endif
+
+//按缓存行对齐，DMA缓冲区不与其它变量共用缓存行，作废时不会丢掉相邻变量的修改
+#define TINYOS_CACHE_ALIGNED    __attribute__((aligned(TINYOS_CACHE_LINE_SIZE)))
+
+//内核热点路径的放置：调度、节拍及PendSV标记为TINYOS_FAST_CODE，就绪位图、就绪表及当前任务指针标记为TINYOS_FAST_DATA，
+//由分散加载文件(或链接脚本)把两个段放到零等待的存储器中，例如M7的ITCM/DTCM：
+//    RW_ITCM 0x00000000 0x4000 { *(.ramfunc) *(.emb_text) }
+//    RW_DTCM 0x20000000 0x10000 { *(.dtcm) }
+//ARMCC的嵌入汇编函数(PendSV_Handler)固定位于.emb_text段，不受段属性影响，需像上面一样单独放置
+#if TINYOS_ENABLE_FAST_SECTIONS == 1
+#define TINYOS_FAST_CODE        __attribute__((section(TINYOS_FAST_CODE_SECTION)))
+#define TINYOS_FAST_DATA        __attribute__((section(TINYOS_FAST_DATA_SECTION)))
+#else
+#define TINYOS_FAST_CODE
+#define TINYOS_FAST_DATA
+#endif
+
+//调用者的返回地址(Thumb代码最低位为1)，临界区统计据此区分调用位置，可用fromelf/addr2line查到所在函数
+#if defined(__CC_ARM)
+#define TINYOS_RETURN_ADDRESS()         ((void *)__return_address())
+#else
+#define TINYOS_RETURN_ADDRESS()         __builtin_return_address(0)
+#endif
+
+//按段收集的静态描述符：TINYOS_SECTION_ENTRY把变量放入名为sec的段并防止被链接器删除，
+//TINYOS_SECTION_BEGIN/END为段的起止地址，由链接器生成(armlink的sec$$Base/sec$$Limit，GNU ld的__start_sec/__stop_sec)，
+//sec须是合法的C标识符；段为空时两个地址都为0。指定按指针对齐，编译器不会为较大的变量提高对齐而在段中留下空隙
+#define TINYOS_SECTION_ENTRY(sec)       __attribute__((used, section(#sec), aligned(sizeof(void *))))
+#if defined(__CC_ARM) || defined(__ARMCC_VERSION)
+#define TINYOS_SECTION_BEGIN(sec)       sec##$$Base
+#define TINYOS_SECTION_END(sec)         sec##$$Limit
+#else
+#define TINYOS_SECTION_BEGIN(sec)       __start_##sec
+#define TINYOS_SECTION_END(sec)         __stop_##sec
+#endif
+#define TINYOS_SECTION_DECLARE(type, sec) \
+    extern type TINYOS_SECTION_BEGIN(sec)[] __attribute__((weak)); \
+    extern type TINYOS_SECTION_END(sec)[] __attribute__((weak))
+
+#endif
@@ -0,0 +1,340 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_POWER == 1
+
+// RTC分频：ck_apre = RTCCLK / 8，亚秒计数每个约244us，ck_spre为1Hz；日历只用于测量STOP经过的时间
+#define TPOWER_RTC_PREDIV_A     7
+#define TPOWER_RTC_SUB_HZ       (TINYOS_POWER_RTC_HZ / (TPOWER_RTC_PREDIV_A + 1))
+#define TPOWER_RTC_PREDIV_S     (TPOWER_RTC_SUB_HZ - 1)
+#define TPOWER_RTC_DAY          (86400UL * TPOWER_RTC_SUB_HZ)
+// 唤醒定时器以RTCCLK/16计数，最多65536个计数(LSE时32s)
+#define TPOWER_WAKEUP_HZ        (TINYOS_POWER_RTC_HZ / 16)
+#define TPOWER_WAKEUP_MAX       65536UL
+// 等待LSE起振的次数，每次100us；晶振未起振时不使用STOP
+#define TPOWER_LSE_TIMEOUT      30000
+
+void SystemClock_Config(void);
+
+static uint32_t powerConstraint[tPowerModeCount];   // 禁止进入各模式(及更深模式)的约束数
+static uint32_t powerEnterCount[tPowerModeCount];
+static uint64_t powerTicks[tPowerModeCount];
+static uint64_t powerStartTicks;                    // 开始统计时的节拍数
+static uint32_t powerRemainder;                     // STOP经过时间中不足一个节拍的部分(亚秒计数 * 1000)
+static uint8_t powerRtcReady;                       // RTC时钟已起振，可以使用STOP
+
+//关闭RTC写保护
+static void tPowerRtcUnlock(void) {
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+//清除唤醒标志，INIT位保持不变，其余标志写1不受影响
+static void tPowerWakeupClearFlag(void) {
+    RTC->ISR = (~(RTC_ISR_WUTF | RTC_ISR_INIT) & 0x0000FFFF) | (RTC->ISR & RTC_ISR_INIT);
+    EXTI->PR = EXTI_PR_PR22;
+}
+
+/**
+ * @brief 初始化RTC及唤醒定时器，在系统时钟配置完成之后调用。
+ *
+ * RTC的时钟源只能在备份域复位后选择一次，已选择了其它时钟源时先复位备份域。
+ *
+ * @return void
+ */
+void tPowerInit(void) {
+    uint32_t rtcsel, i;
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    PWR->CR |= PWR_CR_DBP;
+#if TINYOS_POWER_RTC_LSE == 1
+    rtcsel = RCC_BDCR_RTCSEL_0;
+#else
+    rtcsel = RCC_BDCR_RTCSEL_1;
+#endif
+    if ((RCC->BDCR & RCC_BDCR_RTCSEL) && ((RCC->BDCR & RCC_BDCR_RTCSEL) != rtcsel)) {
+        RCC->BDCR |= RCC_BDCR_BDRST;
+        RCC->BDCR &= ~RCC_BDCR_BDRST;
+    }
+
+#if TINYOS_POWER_RTC_LSE == 1
+    RCC->BDCR |= RCC_BDCR_LSEON;
+    for (i = 0; (i < TPOWER_LSE_TIMEOUT) && !(RCC->BDCR & RCC_BDCR_LSERDY); i++) {
+        tDelayUs(100);
+    }
+    powerRtcReady = (RCC->BDCR & RCC_BDCR_LSERDY) ? 1 : 0;
+#else
+    RCC->CSR |= RCC_CSR_LSION;
+    for (i = 0; (i < TPOWER_LSE_TIMEOUT) && !(RCC->CSR & RCC_CSR_LSIRDY); i++) {
+        tDelayUs(100);
+    }
+    powerRtcReady = (RCC->CSR & RCC_CSR_LSIRDY) ? 1 : 0;
+#endif
+
+    if (powerRtcReady) {
+        RCC->BDCR |= rtcsel | RCC_BDCR_RTCEN;
+
+        tPowerRtcUnlock();
+        RTC->ISR |= RTC_ISR_INIT;
+        while (!(RTC->ISR & RTC_ISR_INITF)) {
+        }
+        // 预分频需分两次写入
+        RTC->PRER = TPOWER_RTC_PREDIV_S;
+        RTC->PRER |= (uint32_t)TPOWER_RTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos;
+        RTC->TR = 0;
+        // 直接读计数器，不等待影子寄存器同步，STOP唤醒后可立即读取
+        RTC->CR = RTC_CR_BYPSHAD;
+        RTC->ISR &= ~RTC_ISR_INIT;
+        RTC->WPR = 0xFF;
+
+        // 唤醒定时器经EXTI22上升沿产生中断，STOP中也能唤醒
+        EXTI->IMR |= EXTI_IMR_MR22;
+        EXTI->RTSR |= EXTI_RTSR_TR22;
+        tPowerWakeupClearFlag();
+        NVIC_SetPriority(RTC_WKUP_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+        NVIC_EnableIRQ(RTC_WKUP_IRQn);
+    }
+
+#if TINYOS_POWER_DEBUG_STOP == 1
+    DBGMCU->CR |= DBGMCU_CR_DBG_STOP;
+#endif
+    powerStartTicks = tTimeGetTicks64();
+}
+
+/**
+ * @brief 登记一个约束，禁止进入mode及更深的休眠模式，可多次登记，由tPowerConstraintClear逐次解除。
+ *
+ * 驱动在外设工作期间登记，例如串口DMA发送期间禁止STOP；可在中断中调用。
+ *
+ * @param mode 禁止的最浅模式，tPowerModeSleep表示空闲时不休眠。
+ *
+ * @return void
+ */
+void tPowerConstraintSet(tPowerMode mode) {
+    uint32_t status;
+
+    if ((mode <= tPowerModeRun) || (mode >= tPowerModeCount)) {
+        return;
+    }
+    status = tTaskEnterCritical();
+    powerConstraint[mode]++;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 解除一次tPowerConstraintSet登记的约束。
+ *
+ * @param mode 与登记时相同的模式。
+ *
+ * @return void
+ */
+void tPowerConstraintClear(tPowerMode mode) {
+    uint32_t status;
+
+    if ((mode <= tPowerModeRun) || (mode >= tPowerModeCount)) {
+        return;
+    }
+    status = tTaskEnterCritical();
+    if (powerConstraint[mode] > 0) {
+        powerConstraint[mode]--;
+    }
+    tTaskExitCritical(status);
+}
+
+//按约束得到允许的最深模式，需在临界区内调用
+static tPowerMode tPowerDeepestLocked(void) {
+    uint32_t mode;
+
+    for (mode = tPowerModeSleep; mode < tPowerModeCount; mode++) {
+        if (powerConstraint[mode] > 0) {
+            break;
+        }
+    }
+    if ((mode == tPowerModeCount) && !powerRtcReady) {
+        mode = tPowerModeStop;
+    }
+    return (tPowerMode)(mode - 1);
+}
+
+/**
+ * @brief 获取当前约束下允许的最深休眠模式。
+ *
+ * @return tPowerMode
+ */
+tPowerMode tPowerDeepestMode(void) {
+    tPowerMode mode;
+    uint32_t status = tTaskEnterCritical();
+
+    mode = tPowerDeepestLocked();
+    tTaskExitCritical(status);
+    return mode;
+}
+
+//读取RTC日历的当日时刻，单位为亚秒计数；直接读计数器时亚秒前后两次相同才说明读到的时分秒一致
+static uint32_t tPowerRtcNow(void) {
+    uint32_t ss, tr, sec;
+
+    do {
+        ss = RTC->SSR;
+        tr = RTC->TR;
+    } while (ss != RTC->SSR);
+
+    sec = (((tr >> 20) & 0x3) * 10 + ((tr >> 16) & 0xF)) * 3600
+        + (((tr >> 12) & 0x7) * 10 + ((tr >> 8) & 0xF)) * 60
+        + (((tr >> 4) & 0x7) * 10 + (tr & 0xF));
+    return sec * TPOWER_RTC_SUB_HZ + (TPOWER_RTC_PREDIV_S - (ss & RTC_SSR_SS));
+}
+
+//重新装载唤醒定时器，counts个RTCCLK/16周期后唤醒
+static void tPowerWakeupStart(uint32_t counts) {
+    tPowerRtcUnlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    while (!(RTC->ISR & RTC_ISR_WUTWF)) {
+    }
+    tPowerWakeupClearFlag();
+    RTC->WUTR = counts - 1;
+    // WUCKSEL为0，RTCCLK/16
+    RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUTE | RTC_CR_WUTIE;
+    RTC->WPR = 0xFF;
+}
+
+static void tPowerWakeupStop(void) {
+    tPowerRtcUnlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    RTC->WPR = 0xFF;
+    tPowerWakeupClearFlag();
+    NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+}
+
+//RTC唤醒中断，只清除标志，唤醒后的处理在空闲任务中完成
+void RTC_WKUP_IRQHandler(void) {
+    tIrqStatEnter();
+    tPowerWakeupClearFlag();
+    tIrqStatExit();
+}
+
+/**
+ * @brief 进入STOP模式，需在临界区内调用，返回前退出临界区。
+ *
+ * 少休眠一个节拍，留出唤醒及恢复时钟的时间，不足一个节拍的部分由SysTick正常计时；
+ * 醒来后按RTC日历测得的经过时间补偿节拍，不足一个节拍的余数计入下一次。
+ *
+ * @param sleepTicks 可休眠的节拍数。
+ * @param status     进入临界区时的状态。
+ *
+ * @return void
+ */
+static void tPowerStop(uint32_t sleepTicks, uint32_t status) {
+    uint32_t counts, start, total, elapsed, i;
+
+    counts = (uint32_t)((uint64_t)(sleepTicks - 1) * TINYOS_SYSTICK_MS * TPOWER_WAKEUP_HZ / 1000);
+    if (counts > TPOWER_WAKEUP_MAX) {
+        counts = TPOWER_WAKEUP_MAX;
+    }
+    if (counts < 2) {
+        tTaskExitCritical(status);
+        return;
+    }
+
+    // 停止SysTick，若此时节拍中断已挂起则放弃本次休眠
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        tTaskExitCritical(status);
+        return;
+    }
+
+    tPowerWakeupStart(counts);
+    start = tPowerRtcNow();
+
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+    // BASEPRI屏蔽的中断不能唤醒，休眠期间改用PRIMASK屏蔽，唤醒的中断在退出临界区后进入
+    __disable_irq();
+    __set_BASEPRI(0);
+#endif
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+    // 唤醒后以HSI运行，恢复PLL；HAL配置时钟时会按1ms重新装载SysTick，之后改回内核节拍
+    TINYOS_POWER_RESTORE_CLOCK();
+#if TINYOS_CRITICAL_USE_BASEPRI == 1
+    __set_BASEPRI(TINYOS_MAX_SYSCALL_PRIO << (8 - __NVIC_PRIO_BITS));
+    __enable_irq();
+#endif
+
+    total = ((tPowerRtcNow() + TPOWER_RTC_DAY - start) % TPOWER_RTC_DAY) * 1000 + powerRemainder;
+    elapsed = total / (TPOWER_RTC_SUB_HZ * TINYOS_SYSTICK_MS);
+    powerRemainder = total % (TPOWER_RTC_SUB_HZ * TINYOS_SYSTICK_MS);
+
+    tPowerWakeupStop();
+    tSysTickRestart();
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+
+    for (i = 0; i < elapsed; i++) {
+        HAL_IncTick();
+    }
+    tTaskSystemTickCatchUp(elapsed);
+    powerEnterCount[tPowerModeStop]++;
+    powerTicks[tPowerModeStop] += elapsed;
+    tTaskExitCritical(status);
+
+    // 补偿过程中可能有任务就绪
+    tTaskSched();
+}
+
+/**
+ * @brief 空闲任务每轮循环最后调用，按约束及下一个到期时间选择休眠模式。
+ *
+ * @return void
+ */
+void tPowerIdle(void) {
+    tPowerMode mode;
+    uint32_t sleepTicks, before, elapsed;
+    uint32_t status = tTaskEnterCritical();
+
+    mode = tPowerDeepestLocked();
+    sleepTicks = tTaskSleepTicksGet();
+    // 没有任何到期时间时休眠到唤醒定时器的最长时间
+    if ((mode == tPowerModeStop) && (sleepTicks >= TINYOS_POWER_STOP_MIN_TICKS)) {
+        tPowerStop(sleepTicks, status);
+        return;
+    }
+    tTaskExitCritical(status);
+
+    if (mode >= tPowerModeSleep) {
+        before = tTaskTickGet();
+        tTicklessIdle();
+        elapsed = tTaskTickGet() - before;
+        if (elapsed > 0) {
+            status = tTaskEnterCritical();
+            powerEnterCount[tPowerModeSleep]++;
+            powerTicks[tPowerModeSleep] += elapsed;
+            tTaskExitCritical(status);
+        }
+    }
+}
+
+/**
+ * @brief 获取各休眠模式的统计。
+ *
+ * @param stat 存放统计的结构体。
+ *
+ * @return void
+ */
+void tPowerGetStat(tPowerStat * stat) {
+    uint32_t mode;
+    uint64_t total = tTimeGetTicks64();
+    uint32_t status = tTaskEnterCritical();
+
+    total -= powerStartTicks;
+    for (mode = 0; mode < tPowerModeCount; mode++) {
+        stat->enterCount[mode] = powerEnterCount[mode];
+        stat->ticks[mode] = powerTicks[mode];
+        stat->constraint[mode] = powerConstraint[mode];
+        if (mode != tPowerModeRun) {
+            total -= powerTicks[mode];
+        }
+    }
+    stat->ticks[tPowerModeRun] = total;
+    stat->deepest = tPowerDeepestLocked();
+    tTaskExitCritical(status);
+}
+#endif
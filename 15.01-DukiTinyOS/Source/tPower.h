@@ -0,0 +1,41 @@
+#ifndef __TPOWER_H
+#define __TPOWER_H
+#include <stdint.h>
+
+// 低功耗管理：空闲任务按下一个内核到期时间及驱动登记的约束选择最深的休眠模式。
+// 可休眠的时间较短或有驱动禁止STOP时按低功耗空闲(tTicklessIdle)停止SysTick后WFI；
+// 足够长时进入STOP模式，由RTC唤醒定时器在下一个到期时间前唤醒，也可由任一开启的EXTI中断(如接收机)提前唤醒，
+// 醒来后恢复系统时钟，按RTC日历计时的实际经过时间补偿内核节拍。
+// STOP期间所有外设时钟停止：PWM、串口DMA、I2C等进行中的传输需由驱动用tPowerConstraintSet禁止；
+// 需开启TINYOS_ENABLE_TICKLESS，只支持STM32F4
+#define TINYOS_POWER_STOP_MIN_TICKS 20      // 可休眠的节拍数不小于该值时才进入STOP，需大于唤醒及恢复时钟的耗时
+#define TINYOS_POWER_RTC_LSE        1       // RTC时钟源，1：外部32.768kHz晶振，0：内部LSI(约32kHz，误差较大)
+#define TINYOS_POWER_RTC_HZ         32768   // RTC时钟频率，使用LSI时按实测修改
+#define TINYOS_POWER_DEBUG_STOP     0       // 1：STOP期间保持调试连接，功耗较高，只用于调试
+
+// STOP唤醒后恢复系统时钟，默认重新执行CubeMX生成的时钟配置
+#define TINYOS_POWER_RESTORE_CLOCK() SystemClock_Config()
+
+// 休眠模式，按深度递增
+typedef enum _tPowerMode {
+	tPowerModeRun = 0,              //不休眠，空闲任务循环等待
+	tPowerModeSleep,                //停止SysTick后WFI，外设正常运行
+	tPowerModeStop,                 //STOP模式，内核及外设时钟停止，主调压器转为低功耗
+	tPowerModeCount,
+}tPowerMode;
+
+// 各模式的统计，时间以节拍计；运行时间为开机至今的节拍数减去休眠的节拍数
+typedef struct _tPowerStat {
+	uint32_t enterCount[tPowerModeCount];   //进入各休眠模式的次数
+	uint64_t ticks[tPowerModeCount];        //各休眠模式中经过的节拍数，[tPowerModeRun]为未休眠的节拍数
+	uint32_t constraint[tPowerModeCount];   //当前禁止进入各模式的约束数
+	tPowerMode deepest;                     //当前允许的最深模式
+}tPowerStat;
+
+void tPowerInit(void);
+void tPowerConstraintSet(tPowerMode mode);
+void tPowerConstraintClear(tPowerMode mode);
+tPowerMode tPowerDeepestMode(void);
+void tPowerIdle(void);
+void tPowerGetStat(tPowerStat * stat);
+#endif
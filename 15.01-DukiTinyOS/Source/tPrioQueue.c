@@ -0,0 +1,224 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_PRIO_QUEUE == 1
+/**
+ * @brief 初始化优先级消息队列。
+ *
+ * @param queue     指向队列的指针。
+ * @param buffer    消息缓冲区，至少TINYOS_PRIO_QUEUE_LEVELS * depth个指针。
+ * @param depth     每个优先级可容纳的消息数，不超过65535。
+ *
+ * @return void
+ */
+void tPrioQueueInit(tPrioQueue * queue, void ** buffer, uint32_t depth) {
+    uint32_t i;
+
+    tEventInit(&queue->event, tEventTypePrioQueue);
+    tRegistryAdd(&queue->event.object, tObjectTypeEvent);
+    queue->buffer = buffer;
+    queue->depth = depth;
+    queue->readyMap = 0;
+    queue->count = 0;
+    queue->peakCount = 0;
+    queue->fullCount = 0;
+    for (i = 0; i < TINYOS_PRIO_QUEUE_LEVELS; i++) {
+        queue->read[i] = 0;
+        queue->levelCount[i] = 0;
+    }
+}
+
+//发送的公共部分，需在临界区内调用，唤醒了更高优先级的任务时将*sched置1
+//队列为空时才会有接收者等待，消息直接交给等待最久的接收者
+static uint32_t tPrioQueuePost(tPrioQueue * queue, void * msg, uint32_t prio, uint32_t * sched) {
+    uint32_t write;
+
+    if (prio >= TINYOS_PRIO_QUEUE_LEVELS) {
+        return tErrorParam;
+    }
+    if (tEventWaitCount(&queue->event) > 0) {
+        tTask * task = tEventWakeUp(&queue->event, msg, tErrorNoError);
+        *sched = (task->prio < curTask->prio);
+        return tErrorNoError;
+    }
+
+    if (queue->levelCount[prio] >= queue->depth) {
+        queue->fullCount++;
+        return tErrorResourceFull;
+    }
+    write = queue->read[prio] + queue->levelCount[prio];
+    if (write >= queue->depth) {
+        write -= queue->depth;
+    }
+    queue->buffer[prio * queue->depth + write] = msg;
+    queue->levelCount[prio]++;
+    queue->readyMap |= 1u << prio;
+    if (++queue->count > queue->peakCount) {
+        queue->peakCount = queue->count;
+    }
+    return tErrorNoError;
+}
+
+//取出最高优先级中最早的消息，需在临界区内调用，队列不能为空
+static void * tPrioQueueFetch(tPrioQueue * queue) {
+    uint32_t prio = tPortCtz(queue->readyMap);
+    void * msg = queue->buffer[prio * queue->depth + queue->read[prio]];
+
+    if (++queue->read[prio] >= queue->depth) {
+        queue->read[prio] = 0;
+    }
+    if (--queue->levelCount[prio] == 0) {
+        queue->readyMap &= ~(1u << prio);
+    }
+    queue->count--;
+    return msg;
+}
+
+/**
+ * @brief 按优先级发送消息，不等待。
+ *
+ * 同一优先级内先进先出；有接收者等待时直接交给它。
+ *
+ * @param queue     指向队列的指针。
+ * @param msg       要发送的消息。
+ * @param prio      消息的优先级，0最高，小于TINYOS_PRIO_QUEUE_LEVELS。
+ *
+ * @return uint32_t `tErrorNoError`表示成功，`tErrorResourceFull`表示该优先级已满，`tErrorParam`表示优先级超出范围。
+ */
+uint32_t tPrioQueueSend(tPrioQueue * queue, void * msg, uint32_t prio) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    err = tPrioQueuePost(queue, msg, prio, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return err;
+}
+
+/**
+ * @brief 在中断服务函数中按优先级发送消息，唤醒任务后由tIntExit统一调度。
+ *
+ * @return uint32_t 同tPrioQueueSend。
+ */
+uint32_t tPrioQueueSendFromISR(tPrioQueue * queue, void * msg, uint32_t prio) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    err = tPrioQueuePost(queue, msg, prio, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return err;
+}
+
+/**
+ * @brief 阻塞式接收优先级最高的消息。
+ *
+ * @param queue      指向队列的指针。
+ * @param msg        存放接收到的消息。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ *
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示队列被删除。
+ */
+uint32_t tPrioQueueReceive(tPrioQueue * queue, void ** msg, uint32_t waitTicks) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (queue->count > 0) {
+        *msg = tPrioQueueFetch(queue);
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+
+    tEventWait(&queue->event, curTask, (void *)0, tEventTypePrioQueue, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    *msg = curTask->eventMsg;
+    return curTask->waitEventResult;
+}
+
+/**
+ * @brief 非阻塞式接收优先级最高的消息。
+ *
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示队列为空。
+ */
+uint32_t tPrioQueueTryReceive(tPrioQueue * queue, void ** msg) {
+    uint32_t err = tErrorResourceUnavaliable;
+    uint32_t status = tTaskEnterCritical();
+
+    if (queue->count > 0) {
+        *msg = tPrioQueueFetch(queue);
+        err = tErrorNoError;
+    }
+
+    tTaskExitCritical(status);
+    return err;
+}
+
+/**
+ * @brief 清空队列中的所有消息。
+ *
+ * @param queue     指向队列的指针。
+ *
+ * @return void
+ */
+void tPrioQueueFlush(tPrioQueue * queue) {
+    uint32_t i;
+    uint32_t status = tTaskEnterCritical();
+
+    for (i = 0; i < TINYOS_PRIO_QUEUE_LEVELS; i++) {
+        queue->read[i] = 0;
+        queue->levelCount[i] = 0;
+    }
+    queue->readyMap = 0;
+    queue->count = 0;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 获取队列的状态信息。
+ *
+ * @param queue     指向队列的指针。
+ * @param info      用于存放队列信息的结构体指针。
+ *
+ * @return void
+ */
+void tPrioQueueGetInfo(tPrioQueue * queue, tPrioQueueInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->count = queue->count;
+    info->depth = queue->depth;
+    info->readyMap = queue->readyMap;
+    info->taskCount = tEventWaitCount(&queue->event);
+    info->peakCount = queue->peakCount;
+    info->fullCount = queue->fullCount;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除队列，唤醒所有等待的任务。
+ *
+ * @param queue     指向队列的指针。
+ *
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tPrioQueueDestroy(tPrioQueue * queue) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&queue->event, (void *)0, tErrorDel);
+    tRegistryRemove(&queue->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
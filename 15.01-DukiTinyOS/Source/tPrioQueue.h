@@ -0,0 +1,38 @@
+#ifndef __TPRIOQUEUE_H
+#define __TPRIOQUEUE_H
+
+#include "tEvent.h"
+
+// 按优先级投递的消息队列：每个优先级一个子环形缓冲区，位图记录哪些级非空，接收总是取最高优先级中最早的消息，
+// 发送与接收都是O(1)；每级容量独立，大量低优先级消息积压时高优先级的消息(如解锁、失控保护命令)仍能发出并最先送达
+// 消息是指针，与邮箱相同；等待的接收者直接得到消息，不经过缓冲区
+typedef struct _tPrioQueue {
+	tEvent event;                    //队列空时等待的接收者
+	void ** buffer;                  //TINYOS_PRIO_QUEUE_LEVELS * depth个消息，第i级的子缓冲区从buffer + i * depth开始
+	uint32_t depth;                  //每级可容纳的消息数
+	uint32_t readyMap;               //第i位为1表示第i级非空，位0为最高优先级
+	uint32_t count;
+	uint32_t peakCount;              //队列中曾同时存在的最大消息数
+	uint32_t fullCount;              //所在级已满而被拒绝的发送次数
+	uint16_t read[TINYOS_PRIO_QUEUE_LEVELS];
+	uint16_t levelCount[TINYOS_PRIO_QUEUE_LEVELS];
+}tPrioQueue;
+
+typedef struct _tPrioQueueInfo {
+	uint32_t count;
+	uint32_t depth;
+	uint32_t readyMap;
+	uint32_t taskCount;
+	uint32_t peakCount;
+	uint32_t fullCount;
+}tPrioQueueInfo;
+
+void tPrioQueueInit(tPrioQueue * queue, void ** buffer, uint32_t depth);
+uint32_t tPrioQueueSend(tPrioQueue * queue, void * msg, uint32_t prio);
+uint32_t tPrioQueueSendFromISR(tPrioQueue * queue, void * msg, uint32_t prio);
+uint32_t tPrioQueueReceive(tPrioQueue * queue, void ** msg, uint32_t waitTicks);
+uint32_t tPrioQueueTryReceive(tPrioQueue * queue, void ** msg);
+void tPrioQueueFlush(tPrioQueue * queue);
+void tPrioQueueGetInfo(tPrioQueue * queue, tPrioQueueInfo * info);
+uint32_t tPrioQueueDestroy(tPrioQueue * queue);
+#endif
@@ -0,0 +1,409 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_PROFILING == 1
+
+static tProfileStat profileStat[tProfilePathCount];
+
+uint32_t tProfilePendSVStart;
+
+// 初始化统计数据并启动周期计数器
+void tProfileInit (void)
+{
+    uint32_t i;
+
+    for (i = 0; i < tProfilePathCount; i++)
+    {
+        tProfileReset((tProfilePath)i);
+    }
+
+    tCycleCounterInit();
+}
+
+// 记录一次测量结果
+void tProfileRecord (tProfilePath path, uint32_t cycles)
+{
+    uint32_t bin;
+    tProfileStat * stat = &profileStat[path];
+    uint32_t status = tTaskEnterCritical();
+
+    stat->count++;
+    stat->totalCycles += cycles;
+    if (cycles < stat->minCycles)
+    {
+        stat->minCycles = cycles;
+    }
+    if (cycles > stat->maxCycles)
+    {
+        stat->maxCycles = cycles;
+    }
+
+    // 组号为cycles的有效位数，即floor(log2(cycles)) + 1
+    bin = 32 - tPortClz(cycles);
+    if (bin >= TINYOS_PROFILE_HIST_BINS)
+    {
+        bin = TINYOS_PROFILE_HIST_BINS - 1;
+    }
+    stat->hist[bin]++;
+
+    tTaskExitCritical(status);
+}
+
+// 由PendSV在恢复下一任务的上下文后调用
+void tProfilePendSVExit (void)
+{
+    tProfileRecord(tProfilePathPendSV, tCycleCounterGet() - tProfilePendSVStart);
+}
+
+// 查询某一路径的统计信息
+void tProfileGetInfo (tProfilePath path, tProfileInfo * info)
+{
+    uint32_t i;
+    tProfileStat * stat = &profileStat[path];
+    uint32_t status = tTaskEnterCritical();
+
+    info->count = stat->count;
+    info->minCycles = (stat->count > 0) ? stat->minCycles : 0;
+    info->maxCycles = stat->maxCycles;
+    info->avgCycles = (stat->count > 0) ? (uint32_t)(stat->totalCycles / stat->count) : 0;
+    for (i = 0; i < TINYOS_PROFILE_HIST_BINS; i++)
+    {
+        info->hist[i] = stat->hist[i];
+    }
+
+    tTaskExitCritical(status);
+}
+
+// 清除某一路径的统计信息
+void tProfileReset (tProfilePath path)
+{
+    uint32_t i;
+    tProfileStat * stat = &profileStat[path];
+    uint32_t status = tTaskEnterCritical();
+
+    stat->count = 0;
+    stat->minCycles = 0xFFFFFFFF;
+    stat->maxCycles = 0;
+    stat->totalCycles = 0;
+    for (i = 0; i < TINYOS_PROFILE_HIST_BINS; i++)
+    {
+        stat->hist[i] = 0;
+    }
+
+    tTaskExitCritical(status);
+}
+
+#endif
+
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+/*
+ * 临界区时长统计：最外层的tTaskEnterCritical记录调用位置及CYCCNT，对应的tTaskExitCritical在恢复屏蔽前计算时长。
+ * 两者都在中断已屏蔽时调用，同一时刻只有一个最外层临界区，用全局变量即可，本身不能再进入临界区。
+ * 表中保留最长时长最大的TINYOS_CRIT_PROFILE_SITES个调用位置，表满且不超过表中最小值时只比较一次即返回。
+ */
+static tCritSite critSites[TINYOS_CRIT_PROFILE_SITES];
+static uint32_t critSiteCount;
+static uint32_t critMinMax;         // 表满时表中最小的最长时长，更短的不必查表
+static void * critSite;
+static uint32_t critStart;
+
+// 由移植层在最外层进入临界区、已屏蔽中断后调用
+void tCritProfileEnter (void * site)
+{
+    critSite = site;
+    critStart = tCycleCounterGet();
+}
+
+// 由移植层在最外层退出临界区、恢复屏蔽之前调用
+void tCritProfileExit (void)
+{
+    uint32_t i, min;
+    uint32_t cycles = tCycleCounterGet() - critStart;
+    void * site = critSite;
+    tCritSite * slot = (tCritSite *)0;
+
+    // 直接以0恢复屏蔽而没有对应的进入时不统计
+    if (site == (void *)0)
+    {
+        return;
+    }
+    critSite = (void *)0;
+    if ((critSiteCount == TINYOS_CRIT_PROFILE_SITES) && (cycles <= critMinMax))
+    {
+        // 不会进入表中；即使是表中已有的位置也不计次数，省去查表
+        return;
+    }
+
+    for (i = 0; i < critSiteCount; i++)
+    {
+        if (critSites[i].site == site)
+        {
+            slot = &critSites[i];
+            break;
+        }
+    }
+    if (slot == (tCritSite *)0)
+    {
+        if (critSiteCount < TINYOS_CRIT_PROFILE_SITES)
+        {
+            slot = &critSites[critSiteCount++];
+        }
+        else
+        {
+            // 替换最长时长最小的位置
+            slot = &critSites[0];
+            for (i = 1; i < critSiteCount; i++)
+            {
+                if (critSites[i].maxCycles < slot->maxCycles)
+                {
+                    slot = &critSites[i];
+                }
+            }
+        }
+        slot->site = site;
+        slot->count = 0;
+        slot->maxCycles = 0;
+        slot->totalCycles = 0;
+    }
+
+    slot->count++;
+    slot->totalCycles += cycles;
+    if (cycles > slot->maxCycles)
+    {
+        slot->maxCycles = cycles;
+    }
+
+    if (critSiteCount == TINYOS_CRIT_PROFILE_SITES)
+    {
+        min = critSites[0].maxCycles;
+        for (i = 1; i < critSiteCount; i++)
+        {
+            if (critSites[i].maxCycles < min)
+            {
+                min = critSites[i].maxCycles;
+            }
+        }
+        critMinMax = min;
+    }
+}
+
+/**
+ * @brief 按最长屏蔽时长从大到小取出统计的调用位置
+ * 
+ * @param sites 存放结果的数组
+ * @param max   数组的元素个数
+ * 
+ * @return uint32_t 取出的位置数
+ */
+uint32_t tCritProfileGet (tCritSite * sites, uint32_t max)
+{
+    uint32_t i, j, n;
+    tCritSite tmp;
+    tCritSite copy[TINYOS_CRIT_PROFILE_SITES];
+    uint32_t status = tTaskEnterCritical();
+
+    n = critSiteCount;
+    for (i = 0; i < n; i++)
+    {
+        copy[i] = critSites[i];
+    }
+    tTaskExitCritical(status);
+
+    // 位置数很少，插入排序
+    for (i = 1; i < n; i++)
+    {
+        tmp = copy[i];
+        for (j = i; (j > 0) && (copy[j - 1].maxCycles < tmp.maxCycles); j--)
+        {
+            copy[j] = copy[j - 1];
+        }
+        copy[j] = tmp;
+    }
+
+    if (n > max)
+    {
+        n = max;
+    }
+    for (i = 0; i < n; i++)
+    {
+        sites[i] = copy[i];
+    }
+    return n;
+}
+
+// 清除统计
+void tCritProfileReset (void)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    critSiteCount = 0;
+    critMinMax = 0;
+    tTaskExitCritical(status);
+}
+
+#endif
+
+#if TINYOS_ENABLE_IRQ_STAT == 1
+/*
+ * 中断耗时统计：中断服务函数在入口调用tIrqStatEnter、返回前调用tIrqStatExit，异常号由IPSR得到。
+ * 每次进入或退出时把上一时刻至今的周期数计入当时正在执行的那一层，被嵌套的中断打断的时间因此不计入外层，
+ * 各层本次已执行的周期数保存在irqRun中，退出时合计为本次的执行时间。
+ * 所有中断的周期数另外累计在irqCycles中，tTaskRunTimeUpdate据此从任务的运行时间中扣除。
+ */
+static tIrqStat irqStats[TINYOS_IRQ_STAT_COUNT];
+static uint8_t irqStack[TINYOS_IRQ_STAT_DEPTH];    // 各层的异常号
+static uint32_t irqRun[TINYOS_IRQ_STAT_DEPTH];     // 各层本次已执行的周期数
+static uint32_t irqDepth;
+static uint32_t irqLast;            // 上一次进入或退出的时间
+static uint32_t irqCycles;          // 所有中断累计的周期数，允许回绕
+static uint64_t irqResetTicks;      // 上次清除统计时的节拍数
+
+// 把上一时刻至今的周期数计入当前层，需在临界区内调用
+static void irqStatCharge (uint32_t now)
+{
+    uint32_t level;
+    uint32_t cycles = now - irqLast;
+
+    irqLast = now;
+    if (irqDepth == 0)
+    {
+        return;
+    }
+    level = (irqDepth > TINYOS_IRQ_STAT_DEPTH) ? TINYOS_IRQ_STAT_DEPTH - 1 : irqDepth - 1;
+    irqRun[level] += cycles;
+    irqCycles += cycles;
+}
+
+// 在中断服务函数入口调用，只能用于优先级不高于TINYOS_MAX_SYSCALL_PRIO的中断
+void tIrqStatEnter (void)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    irqStatCharge(tCycleCounterGet());
+    if (irqDepth < TINYOS_IRQ_STAT_DEPTH)
+    {
+        irqStack[irqDepth] = (uint8_t)__get_IPSR();
+        irqRun[irqDepth] = 0;
+    }
+    irqDepth++;
+    tTaskExitCritical(status);
+}
+
+// 在中断服务函数返回前调用，与tIrqStatEnter成对使用
+void tIrqStatExit (void)
+{
+    uint32_t exception, cycles;
+    tIrqStat * stat;
+    uint32_t status = tTaskEnterCritical();
+
+    if (irqDepth == 0)
+    {
+        tTaskExitCritical(status);
+        return;
+    }
+    irqStatCharge(tCycleCounterGet());
+    irqDepth--;
+    if (irqDepth < TINYOS_IRQ_STAT_DEPTH)
+    {
+        exception = irqStack[irqDepth];
+        cycles = irqRun[irqDepth];
+        if (exception < TINYOS_IRQ_STAT_COUNT)
+        {
+            stat = &irqStats[exception];
+            stat->count++;
+            stat->totalCycles += cycles;
+            if (cycles > stat->maxCycles)
+            {
+                stat->maxCycles = cycles;
+            }
+        }
+    }
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 所有中断累计执行的周期数，含正在执行的中断至今的部分
+ * 
+ * @return uint32_t 累计周期数，按32位回绕，两次读取之差即为其间中断占用的周期数
+ */
+uint32_t tIrqStatCycles (void)
+{
+    uint32_t cycles;
+    uint32_t status = tTaskEnterCritical();
+
+    irqStatCharge(tCycleCounterGet());
+    cycles = irqCycles;
+    tTaskExitCritical(status);
+    return cycles;
+}
+
+/**
+ * @brief 按累计周期数从大到小取出执行过的中断
+ * 
+ * @param stats    存放结果的数组
+ * @param max      数组的元素个数
+ * @param windowUs 不为0时返回上次清除统计至今的微秒数，用于计算各中断的负荷
+ * 
+ * @return uint32_t 取出的中断数
+ */
+uint32_t tIrqStatGet (tIrqStat * stats, uint32_t max, uint64_t * windowUs)
+{
+    uint32_t i, j, n = 0;
+    tIrqStat stat;
+
+    for (i = 0; i < TINYOS_IRQ_STAT_COUNT; i++)
+    {
+        uint32_t status = tTaskEnterCritical();
+
+        stat = irqStats[i];
+        tTaskExitCritical(status);
+        if (stat.count == 0)
+        {
+            continue;
+        }
+        stat.exception = i;
+
+        // 按累计周期数插入，数组满时丢弃最小的
+        for (j = n; (j > 0) && (stats[j - 1].totalCycles < stat.totalCycles); j--)
+        {
+            if (j < max)
+            {
+                stats[j] = stats[j - 1];
+            }
+        }
+        if (j < max)
+        {
+            stats[j] = stat;
+            if (n < max)
+            {
+                n++;
+            }
+        }
+    }
+
+    if (windowUs != (uint64_t *)0)
+    {
+        // 统计时长只需节拍精度，按节拍数换算
+        *windowUs = (tTimeGetTicks64() - irqResetTicks) * (TINYOS_SYSTICK_MS * 1000);
+    }
+    return n;
+}
+
+// 清除各中断的统计，不影响正在执行的中断的嵌套记录
+void tIrqStatReset (void)
+{
+    uint32_t i;
+    uint32_t status;
+
+    for (i = 0; i < TINYOS_IRQ_STAT_COUNT; i++)
+    {
+        status = tTaskEnterCritical();
+        irqStats[i].count = 0;
+        irqStats[i].maxCycles = 0;
+        irqStats[i].totalCycles = 0;
+        tTaskExitCritical(status);
+    }
+    irqResetTicks = tTimeGetTicks64();
+}
+
+#endif
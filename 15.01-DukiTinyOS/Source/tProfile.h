@@ -0,0 +1,89 @@
+#ifndef TPROFILE_H
+#define TPROFILE_H
+
+#include <stdint.h>
+
+// 直方图分组数，第i组统计周期数在[2^(i-1), 2^i)内的次数，最后一组统计所有更长的情况
+#define TINYOS_PROFILE_HIST_BINS    20
+
+// 被测量的内核路径
+typedef enum _tProfilePath
+{
+    tProfilePathSched = 0,          // tTaskSched()执行时间
+    tProfilePathPendSV,             // PendSV上下文切换执行时间
+    tProfilePathSysTick,            // SysTick中断处理执行时间
+    tProfilePathSysTickLatency,     // SysTick计数到期至进入中断服务的延迟
+    tProfilePathTimerTick,          // 定时器模块每个节拍的处理时间(含硬定时器回调)
+    tProfilePathCount
+}tProfilePath;
+
+// 单个路径的统计数据，单位为CPU周期
+typedef struct _tProfileStat
+{
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t hist[TINYOS_PROFILE_HIST_BINS];
+}tProfileStat;
+
+// 统计信息查询结构
+typedef struct _tProfileInfo
+{
+    // 测量次数
+    uint32_t count;
+
+    // 最小、平均、最大周期数
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+
+    // log2直方图
+    uint32_t hist[TINYOS_PROFILE_HIST_BINS];
+}tProfileInfo;
+
+// 临界区统计中的一个调用位置，单位为CPU周期
+typedef struct _tCritSite
+{
+    void * site;                    // 最外层tTaskEnterCritical的返回地址
+    uint32_t count;                 // 进入表以来的次数，表满后只计超过表中最小值的几次
+    uint32_t maxCycles;             // 最长的屏蔽时长
+    uint64_t totalCycles;           // 与count对应的总时长
+}tCritSite;
+
+// 一个中断的统计，单位为CPU周期，只计中断自身执行的时间，嵌套其中的更高优先级中断不计入
+typedef struct _tIrqStat
+{
+    uint32_t exception;             // 异常号，外设中断为IRQn + 16
+    uint32_t count;                 // 执行次数
+    uint32_t maxCycles;             // 单次最长
+    uint64_t totalCycles;
+}tIrqStat;
+
+// PendSV入口时间戳，由Port/ARM_CMx/tPortCpu.c中的汇编代码写入
+extern uint32_t tProfilePendSVStart;
+
+void tProfileInit (void);
+void tProfileRecord (tProfilePath path, uint32_t cycles);
+void tProfilePendSVExit (void);
+void tProfileGetInfo (tProfilePath path, tProfileInfo * info);
+void tProfileReset (tProfilePath path);
+
+void tCritProfileEnter (void * site);
+void tCritProfileExit (void);
+uint32_t tCritProfileGet (tCritSite * sites, uint32_t max);
+void tCritProfileReset (void);
+
+// 中断服务函数入口及返回前调用，未开启统计时不产生代码
+#if TINYOS_ENABLE_IRQ_STAT == 1
+void tIrqStatEnter (void);
+void tIrqStatExit (void);
+#else
+#define tIrqStatEnter()     ((void)0)
+#define tIrqStatExit()      ((void)0)
+#endif
+uint32_t tIrqStatCycles (void);
+uint32_t tIrqStatGet (tIrqStat * stats, uint32_t max, uint64_t * windowUs);
+void tIrqStatReset (void);
+
+#endif /* TPROFILE_H */
@@ -0,0 +1,236 @@
+#include <string.h>
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_QUEUE == 1
+/**
+ * @brief 初始化定长消息队列。
+ * 
+ * @param queue     指向队列的指针。
+ * @param buffer    环形缓冲区，大小至少为itemSize * maxCount字节。
+ * @param itemSize  每条消息的字节数。
+ * @param maxCount  队列可容纳的消息数。
+ * 
+ * @return void
+ */
+void tQueueInit(tQueue * queue, void * buffer, uint32_t itemSize, uint32_t maxCount) {
+    tEventInit(&queue->event, tEventTypeQueue);
+    tRegistryAdd(&queue->event.object, tObjectTypeEvent);
+    queue->buffer = (uint8_t *)buffer;
+    queue->itemSize = itemSize;
+    queue->maxCount = maxCount;
+    queue->count = 0;
+    queue->peakCount = 0;
+    queue->read = 0;
+    queue->write = 0;
+}
+
+// 消息复制到队尾
+static void tQueuePush(tQueue * queue, const void * item) {
+    memcpy(queue->buffer + queue->write * queue->itemSize, item, queue->itemSize);
+    if (++queue->write >= queue->maxCount) {
+        queue->write = 0;
+    }
+    if (++queue->count > queue->peakCount) {
+        queue->peakCount = queue->count;
+    }
+}
+
+// 从队首复制出消息
+static void tQueuePop(tQueue * queue, void * item) {
+    memcpy(item, queue->buffer + queue->read * queue->itemSize, queue->itemSize);
+    if (++queue->read >= queue->maxCount) {
+        queue->read = 0;
+    }
+    queue->count--;
+}
+
+//发送的公共部分，需在临界区内调用，唤醒了更高优先级的任务时将*sched置1
+//队列为空时等待的一定是接收者，消息直接复制到其接收缓冲区(eventMsg)中
+static uint32_t tQueuePost(tQueue * queue, const void * item, uint32_t * sched) {
+    if ((queue->count == 0) && (tEventWaitCount(&queue->event) > 0)) {
+        tNode * node = tListFirst(&queue->event.waitList);
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        memcpy(task->eventMsg, item, queue->itemSize);
+        tEventWakeUpTask(&queue->event, task, task->eventMsg, tErrorNoError);
+        *sched = (task->prio < curTask->prio);
+        return tErrorNoError;
+    }
+
+    if (queue->count >= queue->maxCount) {
+        return tErrorResourceFull;
+    }
+    tQueuePush(queue, item);
+    return tErrorNoError;
+}
+
+//接收的公共部分，需在临界区内调用
+//取走一条消息后，若有发送者因队列满而等待，将其消息(eventMsg指向发送者的数据)移入队列并唤醒它
+static uint32_t tQueueFetch(tQueue * queue, void * item, uint32_t * sched) {
+    if (queue->count == 0) {
+        return tErrorResourceUnavaliable;
+    }
+    tQueuePop(queue, item);
+
+    if (tEventWaitCount(&queue->event) > 0) {
+        tNode * node = tListFirst(&queue->event.waitList);
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        tQueuePush(queue, task->eventMsg);
+        tEventWakeUpTask(&queue->event, task, task->eventMsg, tErrorNoError);
+        *sched = (task->prio < curTask->prio);
+    }
+    return tErrorNoError;
+}
+
+/**
+ * @brief 阻塞式发送消息。
+ * 
+ * 队列满时当前任务等待，接收者取走消息后直接从发送者的数据中复制，等待期间item必须保持有效。
+ * 
+ * @param queue      指向队列的指针。
+ * @param item       要发送的消息，复制itemSize字节。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示队列被删除。
+ */
+uint32_t tQueueSend(tQueue * queue, const void * item, uint32_t waitTicks) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    if (tQueuePost(queue, item, &sched) == tErrorNoError) {
+        tTaskExitCritical(status);
+        if (sched) {
+            tTaskSched();
+        }
+        return tErrorNoError;
+    }
+
+    tEventWait(&queue->event, curTask, (void *)item, tEventTypeQueue, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+    return curTask->waitEventResult;
+}
+
+/**
+ * @brief 非阻塞式发送消息。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceFull`表示队列已满。
+ */
+uint32_t tQueueTrySend(tQueue * queue, const void * item) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    err = tQueuePost(queue, item, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return err;
+}
+
+/**
+ * @brief 在中断服务函数中发送消息，不阻塞，唤醒任务后由tIntExit统一调度。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceFull`表示队列已满。
+ */
+uint32_t tQueueSendFromISR(tQueue * queue, const void * item) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    err = tQueuePost(queue, item, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return err;
+}
+
+/**
+ * @brief 阻塞式接收消息。
+ * 
+ * 队列为空时当前任务等待，发送者直接把消息复制到item中。
+ * 
+ * @param queue      指向队列的指针。
+ * @param item       接收缓冲区，至少itemSize字节。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示队列被删除。
+ */
+uint32_t tQueueReceive(tQueue * queue, void * item, uint32_t waitTicks) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    if (tQueueFetch(queue, item, &sched) == tErrorNoError) {
+        tTaskExitCritical(status);
+        if (sched) {
+            tTaskSched();
+        }
+        return tErrorNoError;
+    }
+
+    tEventWait(&queue->event, curTask, item, tEventTypeQueue, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+    return curTask->waitEventResult;
+}
+
+/**
+ * @brief 非阻塞式接收消息。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示队列为空。
+ */
+uint32_t tQueueTryReceive(tQueue * queue, void * item) {
+    uint32_t err, sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    err = tQueueFetch(queue, item, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return err;
+}
+
+/**
+ * @brief 获取队列的状态信息。
+ * 
+ * @param queue     指向队列的指针。
+ * @param info      用于存放队列信息的结构体指针。
+ * 
+ * @return void
+ */
+void tQueueGetInfo(tQueue * queue, tQueueInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->count = queue->count;
+    info->maxCount = queue->maxCount;
+    info->itemSize = queue->itemSize;
+    info->taskCount = tEventWaitCount(&queue->event);
+    info->peakCount = queue->peakCount;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除队列，唤醒所有等待的任务。
+ * 
+ * @param queue     指向队列的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tQueueDestroy(tQueue * queue) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&queue->event, (void *)0, tErrorDel);
+    tRegistryRemove(&queue->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,34 @@
+#ifndef __TQUEUE_H
+#define __TQUEUE_H
+
+#include "tEvent.h"
+
+// 定长消息队列，消息按值复制到调用者提供的环形缓冲区中，适合传感器采样等小数据
+typedef struct _tQueue {
+	tEvent event;                    //队列空时等待的接收者，或队列满时等待的发送者
+	uint8_t * buffer;                //大小为itemSize * maxCount
+	uint32_t itemSize;
+	uint32_t maxCount;
+	uint32_t count;
+	uint32_t peakCount;              //队列中曾同时存在的最大消息数
+	uint32_t read;
+	uint32_t write;
+}tQueue;
+
+typedef struct _tQueueInfo {
+	uint32_t count;
+	uint32_t maxCount;
+	uint32_t itemSize;
+	uint32_t taskCount;
+	uint32_t peakCount;
+}tQueueInfo;
+
+void tQueueInit(tQueue * queue, void * buffer, uint32_t itemSize, uint32_t maxCount);
+uint32_t tQueueSend(tQueue * queue, const void * item, uint32_t waitTicks);
+uint32_t tQueueTrySend(tQueue * queue, const void * item);
+uint32_t tQueueSendFromISR(tQueue * queue, const void * item);
+uint32_t tQueueReceive(tQueue * queue, void * item, uint32_t waitTicks);
+uint32_t tQueueTryReceive(tQueue * queue, void * item);
+void tQueueGetInfo(tQueue * queue, tQueueInfo * info);
+uint32_t tQueueDestroy(tQueue * queue);
+#endif
@@ -0,0 +1,94 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_REGISTRY == 1
+static tList tRegistryList;
+
+/**
+ * @brief 初始化对象登记表，在tTinyOSInit中最先调用，之后初始化的任务及内核对象都会登记。
+ *
+ * @return void
+ */
+void tRegistryInit(void) {
+    tListInit(&tRegistryList);
+}
+
+/**
+ * @brief 登记对象，由各对象的初始化函数调用。
+ *
+ * @param object    对象内嵌的登记结点。
+ * @param type      对象类别。
+ *
+ * @return void
+ */
+void tRegistryAdd(tObject * object, tObjectType type) {
+    uint32_t status;
+
+    tNodeInit(&object->node);
+    object->name = (const char *)0;
+    object->type = type;
+
+    status = tTaskEnterCritical();
+    tListAddLast(&tRegistryList, &object->node);
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 注销对象，由各对象的删除函数调用，重复调用不产生影响。
+ *
+ * @param object    对象内嵌的登记结点。
+ *
+ * @return void
+ */
+void tRegistryRemove(tObject * object) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (object->node.nextNode != &object->node) {
+        tListRemove(&tRegistryList, &object->node);
+        tNodeInit(&object->node);
+    }
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 按登记顺序取第index个对象。
+ *
+ * 需在临界区内调用，并在同一临界区内读取对象的状态；退出临界区后对象可能已被删除。
+ *
+ * @param index     序号，从0开始。
+ *
+ * @return tObject* 对象的登记结点，超出登记的对象数时返回0。
+ */
+tObject * tRegistryAt(uint32_t index) {
+    tNode * node;
+
+    if (index >= tListCount(&tRegistryList)) {
+        return (tObject *)0;
+    }
+    for (node = tListFirst(&tRegistryList); index > 0; index--) {
+        node = tListNext(&tRegistryList, node);
+    }
+    return tNodeParent(node, tObject, node);
+}
+
+/**
+ * @brief 登记的对象总数。
+ *
+ * @return uint32_t 对象数。
+ */
+uint32_t tRegistryCount(void) {
+    return tListCount(&tRegistryList);
+}
+
+/**
+ * @brief 设置对象的名称，仅供调试输出。
+ *
+ * @param object    对象内嵌的登记结点，如&task.object、&sem.event.object。
+ * @param name      名称，需一直有效，一般为字符串常量。
+ *
+ * @return void
+ */
+void tObjectSetName(tObject * object, const char * name) {
+    object->name = name;
+}
+#endif
@@ -0,0 +1,47 @@
+#ifndef __TREGISTRY_H
+#define __TREGISTRY_H
+
+#include "tLib.h"
+#include "tConfig.h"
+
+// 内核对象登记表：任务、事件类对象(信号量、邮箱、互斥量等)及软定时器在初始化时挂入同一链表，删除时摘下，
+// 供命令行等调试工具在运行时遍历；登记结点嵌在对象内部，不另外分配内存
+// 对象在删除之前不能再次初始化，否则会重复挂入链表；tEventWaitMulti内部使用的临时事件不登记
+typedef enum _tObjectType {
+	tObjectTypeTask,
+	tObjectTypeEvent,
+	tObjectTypeTimer,
+}tObjectType;
+
+typedef struct _tObject {
+	tNode node;
+	const char * name;      //调试用的名称，未设置时为0
+	uint32_t type;          //tObjectType
+}tObject;
+
+// 事件类对象的运行统计，由tEvent在等待/唤醒时维护
+typedef struct _tEventStat {
+	uint32_t waitCount;     //任务阻塞等待的次数，即请求时资源不可用(发生竞争)的次数
+	uint32_t wakeCount;     //等待的任务被唤醒并得到资源的次数
+	uint32_t timeoutCount;  //等待超时的次数
+	uint32_t maxWaiters;    //等待队列曾达到的最大长度
+#if TINYOS_ENABLE_WAIT_STAT == 1
+	uint64_t waitUs;        //任务在该对象上累计的阻塞时间(us)
+	uint32_t maxWaitUs;     //单次阻塞的最长时间(us)
+#endif
+}tEventStat;
+
+#if TINYOS_ENABLE_REGISTRY == 1
+void tRegistryInit(void);
+void tRegistryAdd(tObject * object, tObjectType type);
+void tRegistryRemove(tObject * object);
+tObject * tRegistryAt(uint32_t index);
+uint32_t tRegistryCount(void);
+void tObjectSetName(tObject * object, const char * name);
+#else
+#define tRegistryAdd(object, type)
+#define tRegistryRemove(object)
+#define tObjectSetName(object, name)
+#endif
+
+#endif
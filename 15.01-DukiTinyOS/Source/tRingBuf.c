@@ -0,0 +1,169 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_RINGBUF == 1
+/**
+ * @brief 初始化环形缓冲区。
+ * 
+ * @param ringBuf   指向环形缓冲区的指针。
+ * @param buffer    存储区。
+ * @param size      存储区大小，必须为2的幂。
+ * 
+ * @return void
+ */
+void tRingBufInit(tRingBuf * ringBuf, uint8_t * buffer, uint32_t size) {
+    ringBuf->buffer = buffer;
+    ringBuf->size = size;
+    ringBuf->head = 0;
+    ringBuf->tail = 0;
+    ringBuf->notifyTask = (tTask *)0;
+    ringBuf->threshold = 0;
+}
+
+/**
+ * @brief 获取缓冲区中的数据字节数，生产者和消费者都可调用。
+ */
+uint32_t tRingBufCount(tRingBuf * ringBuf) {
+    return ringBuf->head - ringBuf->tail;
+}
+
+/**
+ * @brief 获取缓冲区的剩余空间，生产者和消费者都可调用。
+ */
+uint32_t tRingBufFree(tRingBuf * ringBuf) {
+    return ringBuf->size - (ringBuf->head - ringBuf->tail);
+}
+
+#if TINYOS_ENABLE_NOTIFY == 1
+// 数据量从阈值以下增加到阈值时通知消费者，只在跨过阈值时通知一次
+static void tRingBufCheckNotify(tRingBuf * ringBuf, uint32_t before, uint32_t after) {
+    if (ringBuf->notifyTask && (before < ringBuf->threshold) && (after >= ringBuf->threshold)) {
+        tTaskNotifyGiveFromISR(ringBuf->notifyTask);
+    }
+}
+#else
+#define tRingBufCheckNotify(ringBuf, before, after)
+#endif
+
+/**
+ * @brief 写入数据，只能由生产者调用。
+ * 
+ * @param ringBuf   指向环形缓冲区的指针。
+ * @param data      要写入的数据。
+ * @param len       字节数。
+ * 
+ * @return uint32_t 实际写入的字节数，空间不足时少于len。
+ */
+uint32_t tRingBufPut(tRingBuf * ringBuf, const uint8_t * data, uint32_t len) {
+    uint32_t i;
+    uint32_t head = ringBuf->head;
+    uint32_t used = head - ringBuf->tail;
+    uint32_t space = ringBuf->size - used;
+    uint32_t mask = ringBuf->size - 1;
+
+    if (len > space) {
+        len = space;
+    }
+    for (i = 0; i < len; i++) {
+        ringBuf->buffer[(head + i) & mask] = data[i];
+    }
+    // 数据写完后再发布写索引
+    __DMB();
+    ringBuf->head = head + len;
+
+    tRingBufCheckNotify(ringBuf, used, used + len);
+    return len;
+}
+
+/**
+ * @brief 写入一个字节，只能由生产者调用，用于串口接收中断等逐字节的场合。
+ * 
+ * @return uint32_t 1表示写入成功，0表示缓冲区已满。
+ */
+uint32_t tRingBufPutByte(tRingBuf * ringBuf, uint8_t data) {
+    uint32_t head = ringBuf->head;
+    uint32_t used = head - ringBuf->tail;
+
+    if (used >= ringBuf->size) {
+        return 0;
+    }
+    ringBuf->buffer[head & (ringBuf->size - 1)] = data;
+    __DMB();
+    ringBuf->head = head + 1;
+
+    tRingBufCheckNotify(ringBuf, used, used + 1);
+    return 1;
+}
+
+/**
+ * @brief 读取数据，只能由消费者调用。
+ * 
+ * @param ringBuf   指向环形缓冲区的指针。
+ * @param data      接收缓冲区。
+ * @param len       最多读取的字节数。
+ * 
+ * @return uint32_t 实际读取的字节数。
+ */
+uint32_t tRingBufGet(tRingBuf * ringBuf, uint8_t * data, uint32_t len) {
+    uint32_t i;
+    uint32_t tail = ringBuf->tail;
+    uint32_t count = ringBuf->head - tail;
+    uint32_t mask = ringBuf->size - 1;
+
+    // 先读索引再读数据
+    __DMB();
+    if (len > count) {
+        len = count;
+    }
+    for (i = 0; i < len; i++) {
+        data[i] = ringBuf->buffer[(tail + i) & mask];
+    }
+    // 数据读完后再释放空间
+    __DMB();
+    ringBuf->tail = tail + len;
+    return len;
+}
+
+#if TINYOS_ENABLE_NOTIFY == 1
+/**
+ * @brief 设置数据到达通知，由消费者在开始接收前调用。
+ * 
+ * @param ringBuf   指向环形缓冲区的指针。
+ * @param task      消费者任务，为0时取消通知。
+ * @param threshold 数据达到该字节数时通知，为1时每次有数据都通知。
+ * 
+ * @return void
+ */
+void tRingBufSetNotify(tRingBuf * ringBuf, tTask * task, uint32_t threshold) {
+    ringBuf->threshold = threshold ? threshold : 1;
+    ringBuf->notifyTask = task;
+}
+
+/**
+ * @brief 生产者在数据流空闲(如串口IDLE中断)时调用，缓冲区中有数据但未达到阈值时也通知消费者。
+ * 
+ * @return void
+ */
+void tRingBufNotifyFromISR(tRingBuf * ringBuf) {
+    uint32_t count = ringBuf->head - ringBuf->tail;
+    if (ringBuf->notifyTask && (count > 0) && (count < ringBuf->threshold)) {
+        tTaskNotifyGiveFromISR(ringBuf->notifyTask);
+    }
+}
+
+/**
+ * @brief 消费者等待数据达到阈值或空闲通知。
+ * 
+ * @param ringBuf   指向环形缓冲区的指针。
+ * @param waitTicks 最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t 当前缓冲区中的数据字节数，超时且无数据时为0。
+ */
+uint32_t tRingBufWait(tRingBuf * ringBuf, uint32_t waitTicks) {
+    if (tRingBufCount(ringBuf) < ringBuf->threshold) {
+        tTaskNotifyTake(1, waitTicks);
+    }
+    return tRingBufCount(ringBuf);
+}
+#endif
+#endif
@@ -0,0 +1,31 @@
+#ifndef __TRINGBUF_H
+#define __TRINGBUF_H
+
+#include <stdint.h>
+
+// 单生产者/单消费者无锁字节环形缓冲区
+// 写索引只由生产者修改，读索引只由消费者修改，两者都是自由递增的计数，用内存屏障保证数据先于索引可见，
+// 不需要临界区；生产者可以在任何优先级的中断中，但唤醒消费者的通知只能在允许调用内核API的中断中使用
+struct _tTask;
+
+typedef struct _tRingBuf {
+	uint8_t * buffer;
+	uint32_t size;                   //必须为2的幂
+	volatile uint32_t head;          //写索引
+	volatile uint32_t tail;          //读索引
+	
+	struct _tTask * notifyTask;      //等待数据的消费者任务
+	uint32_t threshold;              //缓冲区中的数据达到该字节数时通知消费者
+}tRingBuf;
+
+void tRingBufInit(tRingBuf * ringBuf, uint8_t * buffer, uint32_t size);
+uint32_t tRingBufPut(tRingBuf * ringBuf, const uint8_t * data, uint32_t len);
+uint32_t tRingBufPutByte(tRingBuf * ringBuf, uint8_t data);
+uint32_t tRingBufGet(tRingBuf * ringBuf, uint8_t * data, uint32_t len);
+uint32_t tRingBufCount(tRingBuf * ringBuf);
+uint32_t tRingBufFree(tRingBuf * ringBuf);
+
+void tRingBufSetNotify(tRingBuf * ringBuf, struct _tTask * task, uint32_t threshold);
+void tRingBufNotifyFromISR(tRingBuf * ringBuf);
+uint32_t tRingBufWait(tRingBuf * ringBuf, uint32_t waitTicks);
+#endif
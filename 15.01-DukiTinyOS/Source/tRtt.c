@@ -0,0 +1,193 @@
+#include <string.h>
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_RTT == 1
+
+static char rttConsoleBuffer[TINYOS_RTT_CONSOLE_SIZE];
+static char rttLogBuffer[TINYOS_RTT_LOG_SIZE];
+static char rttTraceBuffer[TINYOS_RTT_TRACE_SIZE];
+static char rttDownBuffer[TINYOS_RTT_DOWN_SIZE];
+static uint32_t rttDropped[TINYOS_RTT_UP_COUNT];
+
+// 除标识外都在编译时初始化，tRttInit之前的写入(如启动早期的printf)也会保留，调试器连接后读出
+tRttControl _SEGGER_RTT = {
+	{0},
+	TINYOS_RTT_UP_COUNT,
+	TINYOS_RTT_DOWN_COUNT,
+	{
+		{"Terminal", rttConsoleBuffer, TINYOS_RTT_CONSOLE_SIZE, 0, 0, TINYOS_RTT_MODE_TRIM},
+		{"Log", rttLogBuffer, TINYOS_RTT_LOG_SIZE, 0, 0, TINYOS_RTT_MODE_SKIP},
+		{"Trace", rttTraceBuffer, TINYOS_RTT_TRACE_SIZE, 0, 0, TINYOS_RTT_MODE_SKIP},
+	},
+	{
+		{"Terminal", rttDownBuffer, TINYOS_RTT_DOWN_SIZE, 0, 0, TINYOS_RTT_MODE_SKIP},
+	},
+};
+
+#if (TINYOS_ENABLE_TRACE == 1) && (TINYOS_ENABLE_IDLE_JOB == 1)
+static tIdleJob rttTraceJob;
+
+// 空闲时把跟踪记录转入RTT跟踪通道，每次最多转16条
+static uint32_t tRttTraceJob(void * arg) {
+    return tTraceDrain(tRttTraceOutput, 16) > 0;
+}
+#endif
+
+/**
+ * @brief 写入控制块的标识，之后调试器才能找到控制块；由tTinyOSInit在空闲作业表初始化之后调用
+ *
+ * 标识在运行时逐段写入，Flash中的初始化数据里不出现完整的标识，避免调试器扫描到错误的位置。
+ * 同时开启TINYOS_ENABLE_TRACE及TINYOS_ENABLE_IDLE_JOB时登记空闲作业，跟踪记录在空闲时转入通道2。
+ *
+ * @return void
+ */
+void tRttInit(void) {
+    static const char id[] = "RTT";
+
+    memcpy(&_SEGGER_RTT.acID[7], id, sizeof(id));
+    __DMB();
+    memcpy(&_SEGGER_RTT.acID[0], "SEGGER", 6);
+    __DMB();
+    _SEGGER_RTT.acID[6] = ' ';
+
+#if (TINYOS_ENABLE_TRACE == 1) && (TINYOS_ENABLE_IDLE_JOB == 1)
+    tIdleJobRegister(&rttTraceJob, tRttTraceJob, (void *)0);
+#endif
+}
+
+/**
+ * @brief 写入上行通道，可在任务及中断中调用，不等待调试器读取
+ *
+ * 缓冲区放不下时按通道的方式截断或整段丢弃，丢弃的字节数计入统计。
+ *
+ * @param channel 上行通道号
+ * @param data    数据
+ * @param len     字节数
+ *
+ * @return uint32_t 实际写入的字节数
+ */
+uint32_t tRttWrite(uint32_t channel, const void * data, uint32_t len) {
+    tRttBuffer * up = &_SEGGER_RTT.aUp[channel];
+    const char * src = (const char *)data;
+    uint32_t wr, rd, avail, first;
+    uint32_t status = tTaskEnterCritical();
+
+    wr = up->WrOff;
+    rd = up->RdOff;
+    // 读写位置相同表示空，写位置始终留出1字节不追上读位置
+    avail = (rd > wr) ? (rd - wr - 1) : (up->SizeOfBuffer - wr + rd - 1);
+    if (len > avail) {
+        rttDropped[channel] += ((up->Flags & TINYOS_RTT_MODE_MASK) == TINYOS_RTT_MODE_TRIM) ? (len - avail) : len;
+        if ((up->Flags & TINYOS_RTT_MODE_MASK) != TINYOS_RTT_MODE_TRIM) {
+            tTaskExitCritical(status);
+            return 0;
+        }
+        len = avail;
+    }
+
+    first = up->SizeOfBuffer - wr;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(up->pBuffer + wr, src, first);
+    memcpy(up->pBuffer, src + first, len - first);
+    wr += len;
+    if (wr >= up->SizeOfBuffer) {
+        wr -= up->SizeOfBuffer;
+    }
+    // 数据写完后才更新写位置，调试器不会读到未写完的数据
+    __DMB();
+    up->WrOff = wr;
+
+    tTaskExitCritical(status);
+    return len;
+}
+
+/**
+ * @brief 读取下行通道中调试器写入的数据，每个下行通道只允许一个读取者，不需要临界区
+ *
+ * @param channel 下行通道号
+ * @param buf     存放数据的缓冲区
+ * @param size    缓冲区字节数
+ *
+ * @return uint32_t 读到的字节数，没有数据时为0
+ */
+uint32_t tRttRead(uint32_t channel, void * buf, uint32_t size) {
+    tRttBuffer * down = &_SEGGER_RTT.aDown[channel];
+    char * dst = (char *)buf;
+    uint32_t rd = down->RdOff;
+    uint32_t wr = down->WrOff;
+    uint32_t count = 0;
+
+    while ((rd != wr) && (count < size)) {
+        dst[count++] = down->pBuffer[rd++];
+        if (rd >= down->SizeOfBuffer) {
+            rd = 0;
+        }
+    }
+    if (count > 0) {
+        __DMB();
+        down->RdOff = rd;
+    }
+    return count;
+}
+
+/**
+ * @brief 查询上行通道的状态
+ *
+ * @param channel 上行通道号
+ * @param info    通道的状态信息
+ *
+ * @return void
+ */
+void tRttGetInfo(uint32_t channel, tRttInfo * info) {
+    tRttBuffer * up = &_SEGGER_RTT.aUp[channel];
+    uint32_t status = tTaskEnterCritical();
+    uint32_t wr = up->WrOff;
+    uint32_t rd = up->RdOff;
+
+    info->size = up->SizeOfBuffer;
+    info->pending = (wr >= rd) ? (wr - rd) : (up->SizeOfBuffer - rd + wr);
+    info->dropped = rttDropped[channel];
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 日志记录的输出函数，传给tLogDrain，写入通道1
+ *
+ * @param data 记录
+ * @param len  字节数
+ *
+ * @return void
+ */
+void tRttLogOutput(const uint8_t * data, uint32_t len) {
+    tRttWrite(TINYOS_RTT_CH_LOG, data, len);
+}
+
+/**
+ * @brief 跟踪记录的输出函数，传给tTraceDrain，写入通道2
+ *
+ * @param data 记录
+ * @param len  字节数
+ *
+ * @return void
+ */
+void tRttTraceOutput(const uint8_t * data, uint32_t len) {
+    tRttWrite(TINYOS_RTT_CH_TRACE, data, len);
+}
+
+/**
+ * @brief tFormat的输出函数，写入控制台通道，用于tPcSampleDump等文本输出
+ *
+ * @param ctx 未使用
+ * @param s   字符串
+ * @param len 字节数
+ *
+ * @return void
+ */
+void tRttFormatPut(void * ctx, const char * s, uint32_t len) {
+    tRttWrite(TINYOS_RTT_CH_CONSOLE, s, len);
+}
+
+#endif
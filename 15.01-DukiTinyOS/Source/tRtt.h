@@ -0,0 +1,58 @@
+#ifndef __TRTT_H
+#define __TRTT_H
+
+#include <stdint.h>
+#include "tConfig.h"
+
+// SEGGER RTT：RAM中的一个控制块及若干环形缓冲区，调试器(J-Link、OpenOCD、pyOCD等)经SWD在后台读写，
+// 目标板一侧写入只拷贝数据并更新写位置，不占用外设也不等待传输，没有连接调试器时写满后丢弃或截断。
+// 控制块的布局与SEGGER RTT相同，主机按标识"SEGGER RTT"在RAM中搜索或按符号_SEGGER_RTT定位，可直接使用现有工具。
+// 上行通道：0 控制台(printf及命令行输出，缓冲区不足时截断)，1 二进制日志记录，2 内核跟踪记录(整条写不下时丢弃整条)；
+// 下行通道：0 命令行输入，命令任务每TINYOS_RTT_POLL_TICKS个节拍轮询一次。
+// 写入在临界区内拷贝，可在任务及优先级不高于TINYOS_MAX_SYSCALL_PRIO的中断中调用
+#define TINYOS_RTT_CH_CONSOLE       0
+#define TINYOS_RTT_CH_LOG           1
+#define TINYOS_RTT_CH_TRACE         2
+#define TINYOS_RTT_UP_COUNT         3
+#define TINYOS_RTT_DOWN_COUNT       1
+
+// 缓冲区满时的写入方式，由Flags的低2位指定
+#define TINYOS_RTT_MODE_SKIP        0       //放不下时整段丢弃
+#define TINYOS_RTT_MODE_TRIM        1       //放不下时写入能放下的部分
+#define TINYOS_RTT_MODE_MASK        3
+
+// 一个通道的缓冲区描述，WrOff由写入方修改，RdOff由读取方修改
+typedef struct _tRttBuffer {
+	const char * sName;
+	char * pBuffer;
+	uint32_t SizeOfBuffer;
+	volatile uint32_t WrOff;
+	volatile uint32_t RdOff;
+	uint32_t Flags;
+}tRttBuffer;
+
+typedef struct _tRttControl {
+	char acID[16];                   //"SEGGER RTT"，由tRttInit在运行时写入，Flash中的初始值里不出现该标识
+	int32_t MaxNumUpBuffers;
+	int32_t MaxNumDownBuffers;
+	tRttBuffer aUp[TINYOS_RTT_UP_COUNT];
+	tRttBuffer aDown[TINYOS_RTT_DOWN_COUNT];
+}tRttControl;
+
+// 上行通道的状态信息
+typedef struct _tRttInfo {
+	uint32_t size;                   //缓冲区字节数，可用容量少1字节
+	uint32_t pending;                //尚未被调试器读走的字节数
+	uint32_t dropped;                //缓冲区不足而丢弃的字节数
+}tRttInfo;
+
+extern tRttControl _SEGGER_RTT;
+
+void tRttInit(void);
+uint32_t tRttWrite(uint32_t channel, const void * data, uint32_t len);
+uint32_t tRttRead(uint32_t channel, void * buf, uint32_t size);
+void tRttGetInfo(uint32_t channel, tRttInfo * info);
+void tRttLogOutput(const uint8_t * data, uint32_t len);
+void tRttTraceOutput(const uint8_t * data, uint32_t len);
+void tRttFormatPut(void * ctx, const char * s, uint32_t len);
+#endif
@@ -0,0 +1,207 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_RWLOCK == 1
+/**
+ * @brief 初始化读写锁。
+ * 
+ * @param rwLock    指向读写锁的指针。
+ * 
+ * @return void
+ */
+void tRwLockInit(tRwLock * rwLock) {
+    tEventInit(&rwLock->event, tEventTypeRwLock);
+    tRegistryAdd(&rwLock->event.object, tObjectTypeEvent);
+    tMutexInit(&rwLock->writeMutex);
+    rwLock->readerCount = 0;
+}
+
+/**
+ * @brief 获取读锁。
+ * 
+ * 没有写者时只增加读者计数；有写者持有或正在等待时，经由互斥量排队，写者释放后再进入。
+ * 
+ * @param rwLock     指向读写锁的指针。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示读写锁被删除。
+ */
+uint32_t tRwLockReadWait(tRwLock * rwLock, uint32_t waitTicks) {
+    uint32_t err;
+    uint32_t status = tTaskEnterCritical();
+
+    if (rwLock->writeMutex.owner == (tTask *)0) {
+        rwLock->readerCount++;
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+    tTaskExitCritical(status);
+
+    // 写者在场，阻塞在互斥量上，同时使写者继承当前任务的优先级
+    err = tMutexWait(&rwLock->writeMutex, waitTicks);
+    if (err != tErrorNoError) {
+        return err;
+    }
+    status = tTaskEnterCritical();
+    rwLock->readerCount++;
+    tTaskExitCritical(status);
+
+    tMutexNotify(&rwLock->writeMutex);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 获取读锁，写者持有或正在等待时立即返回。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示有写者。
+ */
+uint32_t tRwLockReadNoWaitGet(tRwLock * rwLock) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (rwLock->writeMutex.owner == (tTask *)0) {
+        rwLock->readerCount++;
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+    tTaskExitCritical(status);
+    return tErrorResourceUnavaliable;
+}
+
+/**
+ * @brief 释放读锁，最后一个读者退出时唤醒等待的写者。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorOwner`表示没有读者持有读锁。
+ */
+uint32_t tRwLockReadNotify(tRwLock * rwLock) {
+    tTask * task = (tTask *)0;
+    uint32_t status = tTaskEnterCritical();
+
+    if (rwLock->readerCount == 0) {
+        tTaskExitCritical(status);
+        return tErrorOwner;
+    }
+
+    if ((--rwLock->readerCount == 0) && (tEventWaitCount(&rwLock->event) > 0)) {
+        task = tEventWakeUp(&rwLock->event, (void *)0, tErrorNoError);
+    }
+    tTaskExitCritical(status);
+
+    if ((task != (tTask *)0) && (task->prio < curTask->prio)) {
+        tTaskSched();
+    }
+    return tErrorNoError;
+}
+
+/**
+ * @brief 获取写锁。
+ * 
+ * 先锁定互斥量挡住新的读者及其它写者，再等待已持有读锁的读者全部退出，两段等待共用waitTicks。
+ * 
+ * @param rwLock     指向读写锁的指针。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorTimeOut`表示超时，`tErrorDel`表示读写锁被删除。
+ */
+uint32_t tRwLockWriteWait(tRwLock * rwLock, uint32_t waitTicks) {
+    uint32_t err, status;
+    uint32_t startTick = tTaskTickGet();
+
+    err = tMutexWait(&rwLock->writeMutex, waitTicks);
+    if (err != tErrorNoError) {
+        return err;
+    }
+
+    status = tTaskEnterCritical();
+    if (rwLock->readerCount == 0) {
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+
+    if (waitTicks) {
+        uint32_t elapsed = tTaskTickGet() - startTick;
+        if (elapsed >= waitTicks) {
+            tTaskExitCritical(status);
+            tMutexNotify(&rwLock->writeMutex);
+            return tErrorTimeOut;
+        }
+        waitTicks -= elapsed;
+    }
+    // 只有互斥量的拥有者会在这里等待，最后一个读者退出时唤醒
+    tEventWait(&rwLock->event, curTask, (void *)0, tEventTypeRwLock, waitTicks);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+    err = curTask->waitEventResult;
+    if (err == tErrorTimeOut) {
+        tMutexNotify(&rwLock->writeMutex);
+    }
+    return err;
+}
+
+/**
+ * @brief 获取写锁，有读者或其它写者时立即返回。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示读写锁被占用。
+ */
+uint32_t tRwLockWriteNoWaitGet(tRwLock * rwLock) {
+    uint32_t status = tTaskEnterCritical();
+
+    if ((rwLock->readerCount == 0) && (tMutexNoWaitGet(&rwLock->writeMutex) == tErrorNoError)) {
+        tTaskExitCritical(status);
+        return tErrorNoError;
+    }
+    tTaskExitCritical(status);
+    return tErrorResourceUnavaliable;
+}
+
+/**
+ * @brief 释放写锁，由排在互斥量上的第一个读者或写者继续。
+ * 
+ * @return uint32_t  `tErrorNoError`表示成功，`tErrorOwner`表示当前任务不持有写锁。
+ */
+uint32_t tRwLockWriteNotify(tRwLock * rwLock) {
+    return tMutexNotify(&rwLock->writeMutex);
+}
+
+/**
+ * @brief 获取读写锁的状态信息。
+ * 
+ * @param rwLock    指向读写锁的指针。
+ * @param info      用于存放读写锁信息的结构体指针。
+ * 
+ * @return void
+ */
+void tRwLockGetInfo(tRwLock * rwLock, tRwLockInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->readerCount = rwLock->readerCount;
+    info->writer = rwLock->writeMutex.owner;
+    info->taskCount = tEventWaitCount(&rwLock->event) + tEventWaitCount(&rwLock->writeMutex.event);
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除读写锁，唤醒所有等待的任务。
+ * 
+ * @param rwLock    指向读写锁的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tRwLockDestroy(tRwLock * rwLock) {
+    uint32_t count;
+    uint32_t status = tTaskEnterCritical();
+
+    count = tEventRemoveAll(&rwLock->event, (void *)0, tErrorDel);
+    tRegistryRemove(&rwLock->event.object);
+    count += tMutexDestroy(&rwLock->writeMutex);
+    rwLock->readerCount = 0;
+
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,29 @@
+#ifndef __TRWLOCK_H
+#define __TRWLOCK_H
+#include "tMutex.h"
+
+// 读写锁：多个读者可同时持有，写者独占
+// 写者先锁定内部互斥量，再等待已有的读者全部退出；写者持有或等待期间新的读者阻塞在互斥量上，
+// 因此写者优先，且阻塞的读者/写者通过互斥量的优先级继承提升写者的优先级
+typedef struct _tRwLock {
+	tEvent event;                    //写者等待读者退出
+	tMutex writeMutex;
+	uint32_t readerCount;            //当前持有读锁的任务数
+}tRwLock;
+
+typedef struct _tRwLockInfo {
+	uint32_t readerCount;
+	tTask * writer;                  //持有或正在获取写锁的任务
+	uint32_t taskCount;              //等待的读者及写者数量
+}tRwLockInfo;
+
+void tRwLockInit(tRwLock * rwLock);
+uint32_t tRwLockReadWait(tRwLock * rwLock, uint32_t waitTicks);
+uint32_t tRwLockReadNoWaitGet(tRwLock * rwLock);
+uint32_t tRwLockReadNotify(tRwLock * rwLock);
+uint32_t tRwLockWriteWait(tRwLock * rwLock, uint32_t waitTicks);
+uint32_t tRwLockWriteNoWaitGet(tRwLock * rwLock);
+uint32_t tRwLockWriteNotify(tRwLock * rwLock);
+void tRwLockGetInfo(tRwLock * rwLock, tRwLockInfo * info);
+uint32_t tRwLockDestroy(tRwLock * rwLock);
+#endif
@@ -1,8 +1,45 @@
 #include "tSem.h"
 #include "tinyOS.h"
+#include "tPort.h"
 
 //条件编译
 #if TINYOS_ENABLE_SEM == 1
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+//计数大于0时用LDREX/STREX直接减一，不关中断；两者之间发生中断或任务切换时STREX失败，重新读取
+//count大于0时等待队列必然为空，直接取走不会越过等待者
+static uint32_t tSemFastTake(tSem * sem) {
+    uint32_t count;
+
+    do {
+        count = __LDREXW((uint32_t *)&sem->count);
+        if (count == 0) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(count - 1, (uint32_t *)&sem->count) != 0);
+    return 1;
+}
+
+//没有等待者且未到上限时直接加一；需要唤醒任务(包括tEventWaitMulti的等待者)或限幅时返回0，由临界区内的完整流程处理
+//等待者只能在临界区内加入，加入前必然打断了LDREX/STREX之间，因此在两者之间检查等待队列即可
+static uint32_t tSemFastGive(tSem * sem) {
+    uint32_t count;
+
+    do {
+        count = __LDREXW((uint32_t *)&sem->count);
+        if ((tListCount(&sem->event.waitList) > 0)
+#if TINYOS_ENABLE_EVENT_MULTI == 1
+            || (tListCount(&sem->event.multiList) > 0)
+#endif
+            || ((sem->maxCount != 0) && (count >= sem->maxCount))) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(count + 1, (uint32_t *)&sem->count) != 0);
+    return 1;
+}
+#endif
+
 /**
  * @brief 初始化信号量。
  * 
@@ -16,6 +53,7 @@
  */
 void tSemInit(tSem * sem, uint32_t startCount, uint32_t maxCount) {
     tEventInit(&sem->event, tEventTypeSem);  // 初始化信号量的事件为信号量类型
+    tRegistryAdd(&sem->event.object, tObjectTypeEvent);
     sem->maxCount = maxCount;  // 设置信号量的最大计数
     if (maxCount == 0) {
         sem->count = startCount;  // 如果没有最大计数，则信号量计数为初始计数
@@ -35,7 +73,17 @@ void tSemInit(tSem * sem, uint32_t startCount, uint32_t maxCount) {
  * @return uint32_t   返回操作结果，`tErrorNoError` 表示成功，`tErrorResourceUnavaliable` 表示资源不可用。
  */
 uint32_t tSemWait(tSem * sem, uint32_t waitTicks) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    uint32_t status;
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tSemFastTake(sem)) {
+        tTraceRecord(tTraceEventSemWait, sem, 0);
+        return tErrorNoError;
+    }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventSemWait, sem, 0);
 
     if (sem->count > 0) {  // 如果信号量有资源
         --sem->count;  // 资源计数减一，表示资源被分配出去
@@ -62,7 +110,15 @@ uint32_t tSemWait(tSem * sem, uint32_t waitTicks) {
  * @return uint32_t   返回操作结果，`tErrorNoError` 表示成功，`tErrorResourceUnavaliable` 表示资源不可用。
  */
 uint32_t tSemNoWaitGet(tSem * sem) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    uint32_t status;
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tSemFastTake(sem)) {
+        return tErrorNoError;
+    }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
     if (sem->count > 0) {  // 如果信号量有资源
         --sem->count;  // 资源计数减一，表示资源被分配出去
@@ -74,6 +130,56 @@ uint32_t tSemNoWaitGet(tSem * sem) {
     }
 }
 
+//释放信号量的公共部分，需在临界区内调用，返回1表示唤醒了比当前任务优先级更高的任务
+static uint32_t tSemRelease(tSem * sem) {
+    if (tEventWaitCount(&sem->event) > 0) {  // 如果有任务在等待该信号量
+        tTask * task = tEventWakeUp(&sem->event, (void *)0, tErrorNoError);  // 唤醒一个等待任务，并传递信号量
+        return task->prio < curTask->prio;
+    }
+
+    ++sem->count;  // 如果没有任务在等待，增加信号量计数
+    if ((sem->maxCount != 0) && (sem->count > sem->maxCount)) {  // 如果信号量计数超过最大值，则限制为最大值
+        sem->count = sem->maxCount;
+    }
+    return tEventMultiWakeUp(&sem->event, tErrorNoError);
+}
+
+//一次释放n个资源：依次交给最多n个等待任务，剩余的计入count，需在临界区内调用
+//返回1表示唤醒了比当前任务优先级更高的任务
+static uint32_t tSemReleaseN(tSem * sem, uint32_t n) {
+    uint32_t sched = 0;
+    tNode * node;
+
+    while ((n > 0) && ((node = tListFirst(&sem->event.waitList)) != (tNode *)0)) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        tEventWakeUpTaskLocked(&sem->event, task, (void *)0, tErrorNoError);
+        sched |= (task->prio < curTask->prio);
+        n--;
+    }
+
+    if (n > 0) {
+        sem->count += n;
+        if ((sem->maxCount != 0) && (sem->count > sem->maxCount)) {
+            sem->count = sem->maxCount;
+        }
+        sched |= tEventMultiWakeUp(&sem->event, tErrorNoError);
+    }
+    return sched;
+}
+
+//唤醒所有等待任务，计数不变，需在临界区内调用
+static uint32_t tSemReleaseAll(tSem * sem) {
+    uint32_t sched = 0;
+    tNode * node;
+
+    while ((node = tListFirst(&sem->event.waitList)) != (tNode *)0) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        tEventWakeUpTaskLocked(&sem->event, task, (void *)0, tErrorNoError);
+        sched |= (task->prio < curTask->prio);
+    }
+    return sched;
+}
+
 /**
  * @brief 通知信号量释放资源。
  * 
@@ -84,22 +190,142 @@ uint32_t tSemNoWaitGet(tSem * sem) {
  * @return void
  */
 void tSemNotify(tSem * sem) {
-    uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    uint32_t sched;
+    uint32_t status;
 
-    if (tEventWaitCount(&sem->event) > 0) {  // 如果有任务在等待该信号量
-        tTask * task = tEventWakeUp(&sem->event, (void *)0, tErrorNoError);  // 唤醒一个等待任务，并传递信号量
-        if (task->prio < curTask->prio) {  // 如果唤醒的任务优先级更高，则调度任务
-            tTaskExitCritical(status);  // 退出临界区
-            tTaskSched();  // 调度任务
-        }
-    } else {
-        ++sem->count;  // 如果没有任务在等待，增加信号量计数
-        if ((sem->maxCount != 0) && (sem->count > sem->maxCount)) {  // 如果信号量计数超过最大值，则限制为最大值
-            sem->count = sem->maxCount;
-        }
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tSemFastGive(sem)) {
+        tTraceRecord(tTraceEventSemNotify, sem, 0);
+        return;
     }
+#endif
+
+    status = tTaskEnterCritical();  // 进入临界区，保护共享资源
+    tTraceRecord(tTraceEventSemNotify, sem, 0);
+
+    sched = tSemRelease(sem);
 
     tTaskExitCritical(status);  // 退出临界区
+    if (sched) {  // 如果唤醒的任务优先级更高，则调度任务
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 在中断服务函数中释放信号量。
+ * 
+ * 与tSemNotify相同，但不立即调度，只标记需要调度，退出最外层中断(tIntExit)时统一触发一次PendSV。
+ * 
+ * @param sem         指向信号量结构体的指针。
+ * 
+ * @return void
+ */
+void tSemNotifyFromISR(tSem * sem) {
+    uint32_t sched;
+    uint32_t status;
+
+#if TINYOS_ENABLE_ATOMIC_FASTPATH == 1
+    if (tSemFastGive(sem)) {
+        tTraceRecord(tTraceEventSemNotify, sem, 1);
+        return;
+    }
+#endif
+
+    status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventSemNotify, sem, 1);
+
+    sched = tSemRelease(sem);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+}
+
+/**
+ * @brief 一次释放n个资源。
+ * 
+ * 最多唤醒n个等待任务，每个任务获得一个资源，剩余的增加到信号量计数，所有任务在同一临界区内就绪，只调度一次。
+ * 
+ * @param sem         指向信号量结构体的指针。
+ * @param n           释放的资源数。
+ * 
+ * @return void
+ */
+void tSemNotifyN(tSem * sem, uint32_t n) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventSemNotify, sem, 0);
+
+    sched = tSemReleaseN(sem, n);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 在中断服务函数中一次释放n个资源，如DMA完成时归还一批缓冲区。
+ * 
+ * @param sem         指向信号量结构体的指针。
+ * @param n           释放的资源数。
+ * 
+ * @return void
+ */
+void tSemNotifyNFromISR(tSem * sem, uint32_t n) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventSemNotify, sem, 1);
+
+    sched = tSemReleaseN(sem, n);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+}
+
+/**
+ * @brief 唤醒所有等待的任务，信号量计数不变。
+ * 
+ * 用于"一帧数据就绪"一类需要通知所有等待者的事件，没有等待者时不产生任何效果。
+ * 
+ * @param sem         指向信号量结构体的指针。
+ * 
+ * @return void
+ */
+void tSemBroadcast(tSem * sem) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventSemNotify, sem, 0);
+
+    sched = tSemReleaseAll(sem);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 在中断服务函数中唤醒所有等待的任务，信号量计数不变。
+ * 
+ * @param sem         指向信号量结构体的指针。
+ * 
+ * @return void
+ */
+void tSemBroadcastFromISR(tSem * sem) {
+    uint32_t sched;
+    uint32_t status = tTaskEnterCritical();
+    tTraceRecord(tTraceEventSemNotify, sem, 1);
+
+    sched = tSemReleaseAll(sem);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
 }
 
 /**
@@ -135,6 +361,7 @@ uint32_t tSemDestory(tSem * sem) {
     uint32_t status = tTaskEnterCritical();  // 进入临界区，保护共享资源
 
     uint32_t count = tEventRemoveAll(&sem->event, (void *)0, tErrorDel);  // 删除所有等待任务
+    tRegistryRemove(&sem->event.object);
     sem->count = 0;  // 将信号量计数设置为0
     tTaskExitCritical(status);  // 退出临界区
 
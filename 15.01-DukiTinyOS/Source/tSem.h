@@ -2,6 +2,7 @@
 #define __TSEM_H
 
 #include "tEvent.h"
+#include "tStatic.h"
 
 typedef struct _tSem {
 	tEvent event;
@@ -16,10 +17,27 @@ typedef struct _tSemInfo {
 	uint32_t taskCount;
 }tSemInfo;
 
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+//编译时定义并初始化信号量，不需要调用tSemInit；参数同tSemInit，初始计数超过最大计数(不为0时)在编译时报错
+#define TINYOS_SEM_DEFINE(sem, initCount, limit) \
+	TINYOS_STATIC_ASSERT(sem##_count, ((limit) == 0) || ((initCount) <= (limit))); \
+	tSem sem = { \
+		.event = TINYOS_EVENT_INITIALIZER(sem.event, tEventTypeSem, #sem), \
+		.count = (initCount), \
+		.maxCount = (limit), \
+	}; \
+	TINYOS_STATIC_REGISTER(sem, sem.event.object)
+#endif
+
 void tSemInit(tSem * sem, uint32_t startCount, uint32_t maxCount);
 uint32_t tSemWait(tSem * sem, uint32_t waitTicks);
 uint32_t tSemNoWaitGet(tSem * sem);
 void tSemNotify(tSem * sem);
+void tSemNotifyFromISR(tSem * sem);
+void tSemNotifyN(tSem * sem, uint32_t n);
+void tSemNotifyNFromISR(tSem * sem, uint32_t n);
+void tSemBroadcast(tSem * sem);
+void tSemBroadcastFromISR(tSem * sem);
 void tSemGetInfo(tSem * sem, tSemInfo * info);
 uint32_t tSemDestory(tSem * sem);
 #endif
@@ -0,0 +1,72 @@
+#include <string.h>
+#include "tSeqLock.h"
+
+/**
+ * @brief 初始化双缓冲顺序锁。
+ * 
+ * @param latch     指向双缓冲顺序锁的指针。
+ * @param copy0     第一份数据，初始内容即为读者最初读到的值。
+ * @param copy1     第二份数据，初始化时从copy0复制。
+ * @param size      数据的字节数。
+ * 
+ * @return void
+ */
+void tSeqLatchInit(tSeqLatch * latch, void * copy0, void * copy1, uint32_t size) {
+    tSeqLockInit(&latch->lock);
+    latch->copy[0] = copy0;
+    latch->copy[1] = copy1;
+    latch->size = size;
+    memcpy(copy1, copy0, size);
+}
+
+/**
+ * @brief 写入新数据，只允许一个写者。
+ * 
+ * 序号为奇数时读者读第二份，此时写第一份；序号回到偶数后读者读第一份，再写第二份。
+ * 
+ * @param latch     指向双缓冲顺序锁的指针。
+ * @param data      新数据。
+ * 
+ * @return void
+ */
+void tSeqLatchWrite(tSeqLatch * latch, const void * data) {
+    tSeqLockWriteBegin(&latch->lock);
+    memcpy(latch->copy[0], data, latch->size);
+    tSeqLockWriteEnd(&latch->lock);
+    memcpy(latch->copy[1], data, latch->size);
+}
+
+/**
+ * @brief 读取一份一致的数据快照，可在任务或中断中调用。
+ * 
+ * 只有写者在复制期间恰好完成了半次更新时才重试，读者优先级高于写者时不会重试。
+ * 
+ * @param latch     指向双缓冲顺序锁的指针。
+ * @param data      用于存放快照的缓冲区。
+ * 
+ * @return void
+ */
+void tSeqLatchRead(tSeqLatch * latch, void * data) {
+    (void)tSeqLatchReadSeq(latch, data);
+}
+
+/**
+ * @brief 读取一份一致的数据快照，并返回快照对应的序号。
+ * 
+ * 序号右移一位即为快照之前完成的写入次数，读者保存后与tSeqLatchCount比较即可知道是否有新数据。
+ * 
+ * @param latch     指向双缓冲顺序锁的指针。
+ * @param data      用于存放快照的缓冲区。
+ * 
+ * @return uint32_t 快照对应的序号。
+ */
+uint32_t tSeqLatchReadSeq(tSeqLatch * latch, void * data) {
+    uint32_t seq;
+    do {
+        seq = latch->lock.seq;
+        __DMB();
+        memcpy(data, latch->copy[seq & 1], latch->size);
+        __DMB();
+    } while (latch->lock.seq != seq);
+    return seq;
+}
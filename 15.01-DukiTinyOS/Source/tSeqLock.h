@@ -0,0 +1,58 @@
+#ifndef __TSEQLOCK_H
+#define __TSEQLOCK_H
+
+#include <stdint.h>
+#include "tPort.h"
+
+// 顺序锁：单个写者在更新前后各递增一次序号，读者复制数据后检查序号，期间有写入则重试，
+// 读写双方都不进入临界区也不阻塞
+typedef struct _tSeqLock {
+	volatile uint32_t seq;           //奇数表示正在写入
+}tSeqLock;
+
+// 双缓冲顺序锁：写者交替更新两份数据，读者总能读到其中未在写入的一份，
+// 即使写者在写入中途被读者抢占，读者也无需等待，适合写者优先级低于读者的场合
+typedef struct _tSeqLatch {
+	tSeqLock lock;
+	void * copy[2];
+	uint32_t size;
+}tSeqLatch;
+
+static __inline void tSeqLockInit(tSeqLock * lock) {
+    lock->seq = 0;
+}
+
+static __inline void tSeqLockWriteBegin(tSeqLock * lock) {
+    lock->seq++;
+    __DMB();
+}
+
+static __inline void tSeqLockWriteEnd(tSeqLock * lock) {
+    __DMB();
+    lock->seq++;
+}
+
+// 开始读取，返回的序号交给tSeqLockReadRetry检查
+// 写者正在写入时返回的是奇数，读取必然会重试，因此读者的优先级不能高于写者，否则应使用tSeqLatch
+static __inline uint32_t tSeqLockReadBegin(tSeqLock * lock) {
+    uint32_t seq = lock->seq;
+    __DMB();
+    return seq;
+}
+
+// 读取期间有写入发生时返回1，需重新读取
+static __inline uint32_t tSeqLockReadRetry(tSeqLock * lock, uint32_t seq) {
+    __DMB();
+    return (seq & 1) || (lock->seq != seq);
+}
+
+// 已完成的写入次数，写入进行中时不计入，读者不进入临界区也不复制数据即可判断是否有新数据
+static __inline uint32_t tSeqLatchCount(tSeqLatch * latch) {
+    return latch->lock.seq >> 1;
+}
+
+void tSeqLatchInit(tSeqLatch * latch, void * copy0, void * copy1, uint32_t size);
+void tSeqLatchWrite(tSeqLatch * latch, const void * data);
+void tSeqLatchRead(tSeqLatch * latch, void * data);
+uint32_t tSeqLatchReadSeq(tSeqLatch * latch, void * data);
+#endif
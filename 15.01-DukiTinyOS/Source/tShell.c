@@ -0,0 +1,565 @@
+#include <stdio.h>
+#include <string.h>
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_SHELL == 1
+static tTask tShellTask;
+static tTaskStack tShellTaskStack[TINYOS_SHELL_STACK_SIZE];
+static tSem tShellLineSem;
+
+//接收中的命令行，收到完整的一行后置tShellLineReady，命令处理完之前丢弃新的输入
+static char tShellLine[TINYOS_SHELL_LINE_MAX];
+static uint32_t tShellLineLen;
+static volatile uint8_t tShellLineReady;
+static volatile uint8_t tShellStarted;
+
+//一个登记对象在临界区内读出的快照，退出临界区后再输出
+typedef struct _tShellItem {
+    const char * name;
+    void * addr;
+    uint32_t type;
+    uint32_t kind;              //任务为优先级，事件为tEventType，定时器为tTimerState
+    uint32_t state;
+    uint32_t waiters;
+    uint32_t period;
+    tEventStat stat;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    uint64_t runCycles;
+#endif
+}tShellItem;
+
+static const char * const tShellEventTypeName[] = {
+    "unknown", "sem", "mbox", "memblock", "flaggroup", "mutex", "heap",
+    "queue", "stream", "multi", "rwlock", "cond", "barrier", "topic",
+    "prioqueue", "msgcall", "msgreply", "msgrecv",
+};
+
+static const char * const tShellTimerStateName[] = {
+    "created", "started", "running", "stopped", "destroyed",
+};
+
+//把一个字节加入命令行，返回1表示收到了完整的一行
+static uint32_t tShellInputChar(uint8_t ch) {
+    if (!tShellStarted || tShellLineReady) {
+        return 0;
+    }
+
+    if ((ch == '\r') || (ch == '\n')) {
+        if (tShellLineLen > 0) {
+            tShellLine[tShellLineLen] = '\0';
+            tShellLineReady = 1;
+            return 1;
+        }
+    } else if ((ch == '\b') || (ch == 0x7F)) {
+        if (tShellLineLen > 0) {
+            tShellLineLen--;
+        }
+    } else if (tShellLineLen < TINYOS_SHELL_LINE_MAX - 1) {
+        tShellLine[tShellLineLen++] = (char)ch;
+    }
+    return 0;
+}
+
+/**
+ * @brief 接收一个字节，在串口接收中断中调用。
+ *
+ * @param ch 收到的字节，回车或换行结束一行，退格删除上一个字符。
+ *
+ * @return void
+ */
+void tShellInputFromISR(uint8_t ch) {
+    if (tShellInputChar(ch)) {
+        tSemNotifyFromISR(&tShellLineSem);
+    }
+}
+
+//在临界区内读出第index个登记对象，已超出登记的对象数时返回0
+static uint32_t tShellGetItem(uint32_t index, tShellItem * item) {
+    tObject * object;
+    uint32_t status = tTaskEnterCritical();
+
+    object = tRegistryAt(index);
+    if (object == (tObject *)0) {
+        tTaskExitCritical(status);
+        return 0;
+    }
+
+    memset(item, 0, sizeof(tShellItem));
+    item->name = object->name;
+    item->type = object->type;
+    switch (object->type) {
+        case tObjectTypeTask: {
+            tTask * task = tNodeParent(object, tTask, object);
+            item->addr = task;
+            item->kind = task->prio;
+            item->state = task->state;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+            item->runCycles = task->runCycles;
+#endif
+            break;
+        }
+        case tObjectTypeEvent: {
+            tEvent * event = tNodeParent(object, tEvent, object);
+            item->addr = event;
+            item->kind = event->type;
+            item->waiters = tListCount(&event->waitList);
+            item->stat = event->stat;
+            break;
+        }
+        case tObjectTypeTimer: {
+            tTimer * timer = tNodeParent(object, tTimer, object);
+            item->addr = timer;
+            item->kind = timer->state;
+            item->state = timer->config;
+            item->period = timer->durationTicks;
+            break;
+        }
+        default:
+            break;
+    }
+
+    tTaskExitCritical(status);
+    return 1;
+}
+
+static const char * tShellTaskStateName(tShellItem * item) {
+    if (item->addr == (void *)curTask) {
+        return "run";
+    } else if (item->state & TINYOS_TASK_STATE_SUSPEND) {
+        return "suspend";
+    } else if (item->state & TINYOS_TASK_WAIT_MASK) {
+        return "wait";
+    } else if (item->state & TINYOS_TASK_STATE_NOTIFY_WAIT) {
+        return "notify";
+    } else if (item->state & TINYOS_TASK_STATE_IRQ_WAIT) {
+        return "irq";
+    } else if (item->state & TINYOS_TASK_STATE_DELAYED) {
+        return "delay";
+    }
+    return "ready";
+}
+
+static void tShellPrintName(tShellItem * item) {
+    printf("%-12s %08lx ", item->name ? item->name : "-", (unsigned long)(uintptr_t)item->addr);
+}
+
+//任务列表，CPU占用为统计开始以来各任务运行周期数的占比
+static void tShellCmdTasks(void) {
+    tShellItem item;
+    tTaskInfo info;
+    uint32_t i;
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    uint64_t total = 0;
+
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        if (item.type == tObjectTypeTask) {
+            total += item.runCycles;
+        }
+    }
+#endif
+
+    printf("name         addr     prio state   stack  free   cpu%%\r\n");
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        if (item.type != tObjectTypeTask) {
+            continue;
+        }
+        // 栈剩余空间需要扫描整个栈，不在上面的临界区内统计
+        tTaskGetInfo((tTask *)item.addr, &info);
+        tShellPrintName(&item);
+        printf("%-4lu %-7s %-6lu %-6lu ", (unsigned long)item.kind, tShellTaskStateName(&item),
+               (unsigned long)info.stackSize, (unsigned long)info.stackFree);
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+        if (total > 0) {
+            uint32_t permille = (uint32_t)(item.runCycles * 1000 / total);
+            printf("%lu.%lu\r\n", (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+        } else {
+            printf("-\r\n");
+        }
+#else
+        printf("-\r\n");
+#endif
+    }
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    tPrintf("cpu usage %.1f%%\r\n", tCpuUsageGet());
+#endif
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+    {
+        uint32_t missed;
+        uint32_t overruns = tTaskTickOverrunGet(&missed);
+
+        printf("tick overruns %lu, %lu ticks caught up\r\n", (unsigned long)overruns, (unsigned long)missed);
+    }
+#endif
+}
+
+//事件类对象列表，waits为阻塞等待的次数，即发生竞争的次数，wait(ms)为任务在其上累计的阻塞时间
+static void tShellCmdObjects(void) {
+    tShellItem item;
+    uint32_t i;
+
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    printf("name         addr     type      waiters waits    wakeups  timeouts maxq     wait(ms) max(us)\r\n");
+#else
+    printf("name         addr     type      waiters waits    wakeups  timeouts maxq\r\n");
+#endif
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        if (item.type != tObjectTypeEvent) {
+            continue;
+        }
+        tShellPrintName(&item);
+        printf("%-9s %-7lu %-8lu %-8lu %-8lu ",
+               (item.kind < sizeof(tShellEventTypeName) / sizeof(tShellEventTypeName[0])) ? tShellEventTypeName[item.kind] : "?",
+               (unsigned long)item.waiters, (unsigned long)item.stat.waitCount, (unsigned long)item.stat.wakeCount,
+               (unsigned long)item.stat.timeoutCount);
+#if TINYOS_ENABLE_WAIT_STAT == 1
+        printf("%-8lu %-8lu %lu\r\n", (unsigned long)item.stat.maxWaiters,
+               (unsigned long)(item.stat.waitUs / 1000), (unsigned long)item.stat.maxWaitUs);
+#else
+        printf("%lu\r\n", (unsigned long)item.stat.maxWaiters);
+#endif
+    }
+}
+
+#if TINYOS_ENABLE_WAIT_STAT == 1
+static const char * const tShellWaitReasonName[] = {
+    "delay", "suspend", "notify", "irq",
+};
+
+static const char * tShellWaitReason(uint32_t reason) {
+    if (reason < TINYOS_WAIT_EVENT_TYPES) {
+        return tShellEventTypeName[reason];
+    }
+    return tShellWaitReasonName[reason - TINYOS_WAIT_EVENT_TYPES];
+}
+
+//各任务按阻塞原因累计的阻塞时间(上次输出以来)及其中最长的一次，之后清零
+static void tShellCmdWait(void) {
+    tShellItem item;
+    tTaskInfo info;
+    uint32_t i, reason;
+
+    printf("name         addr     reason    wait(ms)\r\n");
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        if (item.type != tObjectTypeTask) {
+            continue;
+        }
+        tTaskGetInfo((tTask *)item.addr, &info);
+        tTaskWaitStatReset((tTask *)item.addr);
+        tShellPrintName(&item);
+        if (info.maxWaitUs == 0) {
+            printf("-\r\n");
+            continue;
+        }
+        printf("max %luus on %s\r\n", (unsigned long)info.maxWaitUs, tShellWaitReason(info.maxWaitReason));
+        for (reason = 0; reason < TINYOS_WAIT_REASON_COUNT; reason++) {
+            if (info.waitUs[reason] != 0) {
+                printf("%22s%-9s %lu\r\n", "", tShellWaitReason(reason), (unsigned long)(info.waitUs[reason] / 1000));
+            }
+        }
+    }
+}
+#endif
+
+static void tShellCmdTimers(void) {
+    tShellItem item;
+    uint32_t i;
+
+    printf("name         addr     state     type period\r\n");
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        if (item.type != tObjectTypeTimer) {
+            continue;
+        }
+        tShellPrintName(&item);
+        printf("%-9s %-4s %lu\r\n",
+               (item.kind < sizeof(tShellTimerStateName) / sizeof(tShellTimerStateName[0])) ? tShellTimerStateName[item.kind] : "?",
+               (item.state & TIMER_CONFIG_TYPE_HARD) ? "hard" : "soft", (unsigned long)item.period);
+    }
+}
+
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+//互斥量的锁定统计，时长单位为us，inherit为拥有者继承等待者优先级的累计时长
+static void tShellCmdMutex(void) {
+    tShellItem item;
+    tMutexStat stat;
+    uint32_t i;
+    uint32_t perUs = SystemCoreClock / 1000000;
+
+    printf("name         addr     locks    contend  hold-max hold-avg wait-max inherit  alerts\r\n");
+    for (i = 0; tShellGetItem(i, &item); i++) {
+        tEvent * event = (tEvent *)item.addr;
+
+        if ((item.type != tObjectTypeEvent) || (item.kind != tEventTypeMutex)) {
+            continue;
+        }
+        tMutexGetStat(tNodeParent(event, tMutex, event), &stat);
+        tShellPrintName(&item);
+        printf("%-8lu %-8lu %-8lu %-8lu %-8lu %-8lu %lu\r\n", (unsigned long)stat.lockCount, (unsigned long)stat.contendCount,
+               (unsigned long)(stat.holdMaxCycles / perUs),
+               (unsigned long)((stat.holdCount > 0) ? (stat.holdTotalCycles / stat.holdCount / perUs) : 0),
+               (unsigned long)(stat.waitMaxCycles / perUs), (unsigned long)(stat.inheritCycles / perUs),
+               (unsigned long)stat.alertCount);
+    }
+}
+#endif
+
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+//屏蔽中断最久的调用位置，地址为tTaskEnterCritical的返回地址，最低位为Thumb标志
+static void tShellCmdCritical(void) {
+    tCritSite sites[TINYOS_CRIT_PROFILE_SITES];
+    uint32_t i, n = tCritProfileGet(sites, TINYOS_CRIT_PROFILE_SITES);
+    uint32_t perUs = SystemCoreClock / 1000000;
+
+    printf("site       count    max(cyc) max(us)  avg(cyc)\r\n");
+    for (i = 0; i < n; i++) {
+        printf("%08lx   %-8lu %-8lu %-8lu %lu\r\n", (unsigned long)(uintptr_t)sites[i].site, (unsigned long)sites[i].count,
+               (unsigned long)sites[i].maxCycles, (unsigned long)(sites[i].maxCycles / perUs),
+               (unsigned long)(sites[i].totalCycles / sites[i].count));
+    }
+    tCritProfileReset();
+}
+#endif
+
+#if TINYOS_ENABLE_IRQ_STAT == 1
+static void tShellCmdIrq(void) {
+    tIrqStat stats[16];
+    uint64_t windowUs, windowCycles;
+    uint32_t i, load, n = tIrqStatGet(stats, sizeof(stats) / sizeof(stats[0]), &windowUs);
+    uint32_t perUs = SystemCoreClock / 1000000;
+
+    // 负荷为中断自身执行时间占统计时长的千分比；外设中断另列IRQn，系统异常为负数
+    windowCycles = windowUs * perUs;
+    printf("exc  irq  count    max(us)  avg(cyc) load\r\n");
+    for (i = 0; i < n; i++) {
+        load = (windowCycles > 0) ? (uint32_t)(stats[i].totalCycles * 1000 / windowCycles) : 0;
+        printf("%-4lu %-4ld %-8lu %-8lu %-8lu %lu.%lu%%\r\n", (unsigned long)stats[i].exception,
+               (long)stats[i].exception - 16, (unsigned long)stats[i].count,
+               (unsigned long)(stats[i].maxCycles / perUs),
+               (unsigned long)(stats[i].totalCycles / stats[i].count), (unsigned long)(load / 10), (unsigned long)(load % 10));
+    }
+    tIrqStatReset();
+}
+#endif
+
+#if TINYOS_ENABLE_PC_SAMPLE == 1
+static void tShellPut(void * ctx, const char * s, uint32_t len) {
+    (void)ctx;
+    fwrite(s, 1, len, stdout);
+}
+
+// 第一次执行时开始采样，之后每次输出直方图并清零，两次执行之间即为一个剖析窗口
+static void tShellCmdPcSample(void) {
+    tPcSampleInfo info;
+
+    tPcSampleGetInfo(&info);
+    if (!info.running) {
+        tPcSampleReset();
+        tPcSampleStart();
+        printf("sampling at %luHz\r\n", (unsigned long)TINYOS_PC_SAMPLE_HZ);
+        return;
+    }
+    (void)tPcSampleDump(tShellPut, (void *)0);
+    tPcSampleReset();
+}
+#endif
+
+#if TINYOS_ENABLE_POWER == 1
+static void tShellCmdPower(void) {
+    static const char * const names[tPowerModeCount] = {"run", "sleep", "stop"};
+    tPowerStat stat;
+    uint64_t total = 0;
+    uint32_t i, share;
+
+    tPowerGetStat(&stat);
+    for (i = 0; i < tPowerModeCount; i++) {
+        total += stat.ticks[i];
+    }
+    printf("mode   enter    time(ms)     share  constraint\r\n");
+    for (i = 0; i < tPowerModeCount; i++) {
+        share = (total > 0) ? (uint32_t)(stat.ticks[i] * 1000 / total) : 0;
+        printf("%-6s %-8lu %-12lu %lu.%lu%%  %lu\r\n", names[i], (unsigned long)stat.enterCount[i],
+               (unsigned long)(stat.ticks[i] * TINYOS_SYSTICK_MS), (unsigned long)(share / 10), (unsigned long)(share % 10),
+               (unsigned long)stat.constraint[i]);
+    }
+    printf("deepest allowed: %s\r\n", names[stat.deepest]);
+}
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+static void tShellCmdClock(void) {
+    tClockStat stat;
+    uint64_t total = 0;
+    uint32_t i, share;
+
+    tClockGetStat(&stat);
+    for (i = 0; i < TINYOS_CLOCK_LEVEL_COUNT; i++) {
+        total += stat.ticks[i];
+    }
+    printf("level  hclk(MHz)  time(ms)     share\r\n");
+    for (i = 0; i < TINYOS_CLOCK_LEVEL_COUNT; i++) {
+        share = (total > 0) ? (uint32_t)(stat.ticks[i] * 1000 / total) : 0;
+        printf("%c%-5lu %-10lu %-12lu %lu.%lu%%\r\n", (i == stat.level) ? '*' : ' ', (unsigned long)i,
+               (unsigned long)((stat.hclk << stat.level >> i) / 1000000), (unsigned long)(stat.ticks[i] * TINYOS_SYSTICK_MS),
+               (unsigned long)(share / 10), (unsigned long)(share % 10));
+    }
+    printf("switches %lu, deferred %lu, boost %lu, hold %lu\r\n", (unsigned long)stat.switchCount,
+           (unsigned long)stat.deferCount, (unsigned long)stat.boost, (unsigned long)stat.hold);
+}
+#endif
+
+#if TINYOS_ENABLE_PARTITION == 1
+static void tShellCmdPartition(void) {
+    tPartitionInfo info;
+    uint32_t i, share;
+
+    tPartitionGetInfo(&info);
+    if (!info.running) {
+        printf("not running\r\n");
+        return;
+    }
+    printf("part   window(us)   share\r\n");
+    for (i = 0; i < TINYOS_PARTITION_COUNT; i++) {
+        share = (uint32_t)((uint64_t)info.windowUs[i] * 1000 / info.majorUs);
+        printf("%c%-5lu %-12lu %lu.%lu%%\r\n", (i == info.partition) ? '*' : ' ', (unsigned long)i,
+               (unsigned long)info.windowUs[i], (unsigned long)(share / 10), (unsigned long)(share % 10));
+    }
+    printf("major frame %luus, frames %lu, window %lu, max switch latency %luus\r\n", (unsigned long)info.majorUs,
+           (unsigned long)info.frames, (unsigned long)info.window, (unsigned long)info.maxLatencyUs);
+}
+#endif
+
+static void tShellCmdHelp(void);
+
+//tShellAddCmd追加的命令，按登记的逆序排列
+static tShellCmd * tShellCmdList;
+
+static const tShellCmd tShellCmdTable[] = {
+    {"ps",    tShellCmdTasks,   "list tasks"},
+    {"obj",   tShellCmdObjects, "list semaphores, mailboxes, mutexes and other event objects"},
+    {"timer", tShellCmdTimers,  "list software timers"},
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    {"wait",  tShellCmdWait,    "blocked time of each task by reason since the last reset, then reset"},
+#endif
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    {"mutex", tShellCmdMutex,   "lock count, contention, hold and wait time of each mutex"},
+#endif
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+    {"crit",  tShellCmdCritical, "longest interrupt-masked sections by call site, then reset"},
+#endif
+#if TINYOS_ENABLE_POWER == 1
+    {"power", tShellCmdPower,   "time spent in each sleep mode and the active driver constraints"},
+#endif
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+    {"clock", tShellCmdClock,   "current HCLK, time spent at each clock level and the boost/hold requests"},
+#endif
+#if TINYOS_ENABLE_PARTITION == 1
+    {"part",  tShellCmdPartition, "time window of each partition in the major frame and the current window"},
+#endif
+#if TINYOS_ENABLE_IRQ_STAT == 1
+    {"irq",   tShellCmdIrq,     "execution time and load of each interrupt since the last reset, then reset"},
+#endif
+#if TINYOS_ENABLE_PC_SAMPLE == 1
+    {"pcs",   tShellCmdPcSample, "start PC sampling, later dump the histogram for Tools/pcprofile.py and reset"},
+#endif
+    {"help",  tShellCmdHelp,    "show this list"},
+};
+
+static void tShellCmdHelp(void) {
+    tShellCmd * cmd;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(tShellCmdTable) / sizeof(tShellCmdTable[0]); i++) {
+        printf("%-6s %s\r\n", tShellCmdTable[i].name, tShellCmdTable[i].help);
+    }
+    for (cmd = tShellCmdList; cmd != (tShellCmd *)0; cmd = cmd->next) {
+        printf("%-6s %s\r\n", cmd->name, cmd->help);
+    }
+    printf("%lu objects registered\r\n", (unsigned long)tRegistryCount());
+}
+
+static void tShellExec(const char * line) {
+    tShellCmd * cmd;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(tShellCmdTable) / sizeof(tShellCmdTable[0]); i++) {
+        if (strcmp(line, tShellCmdTable[i].name) == 0) {
+            tShellCmdTable[i].func();
+            return;
+        }
+    }
+    for (cmd = tShellCmdList; cmd != (tShellCmd *)0; cmd = cmd->next) {
+        if (strcmp(line, cmd->name) == 0) {
+            cmd->func();
+            return;
+        }
+    }
+    printf("unknown command '%s'\r\n", line);
+    tShellCmdHelp();
+}
+
+//等待完整的一行；开启RTT时调试器写入下行通道没有中断，等待超时后轮询，与串口的输入拼在同一行中
+static void tShellWaitLine(void) {
+#if TINYOS_ENABLE_RTT == 1
+    uint8_t ch;
+    uint32_t status;
+    uint32_t ready;
+
+    while (tSemWait(&tShellLineSem, TINYOS_RTT_POLL_TICKS) != tErrorNoError) {
+        while (!tShellLineReady && (tRttRead(TINYOS_RTT_CH_CONSOLE, &ch, 1) > 0)) {
+            // 与串口接收中断互斥地修改命令行
+            status = tTaskEnterCritical();
+            ready = tShellInputChar(ch);
+            tTaskExitCritical(status);
+            if (ready) {
+                tSemNotify(&tShellLineSem);
+            }
+        }
+    }
+#else
+    tSemWait(&tShellLineSem, 0);
+#endif
+}
+
+static void tShellTaskEntry(void * param) {
+    for (;;) {
+        tShellWaitLine();
+
+        printf("> %s\r\n", tShellLine);
+        tShellExec(tShellLine);
+
+        tShellLineLen = 0;
+        tShellLineReady = 0;
+    }
+}
+
+/**
+ * @brief 创建命令任务，在空闲任务中与其它内核任务一同创建。
+ *
+ * @return void
+ */
+void tShellInitTask(void) {
+#if TINYOS_SHELL_PRIO >= (TINYOS_PRIO_COUNT - 1)
+    #error "TINYOS_SHELL_PRIO must be higher than the idle task"
+#endif
+    tSemInit(&tShellLineSem, 0, 1);
+    tObjectSetName(&tShellLineSem.event.object, "shell.line");
+    tTaskInit(&tShellTask, tShellTaskEntry, (void *)0, TINYOS_SHELL_PRIO, tShellTaskStack, sizeof(tShellTaskStack));
+    tObjectSetName(&tShellTask.object, "shell");
+    tShellStarted = 1;
+}
+
+/**
+ * @brief 追加一条命令，可在命令任务创建前后的任意时刻调用，不能在中断中调用
+ *
+ * @param cmd 命令，名称不能与已有命令重复，由调用者静态分配
+ *
+ * @return void
+ */
+void tShellAddCmd(tShellCmd * cmd) {
+    uint32_t status = tTaskEnterCritical();
+
+    cmd->next = tShellCmdList;
+    tShellCmdList = cmd;
+    tTaskExitCritical(status);
+}
+#endif
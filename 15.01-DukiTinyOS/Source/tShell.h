@@ -0,0 +1,23 @@
+#ifndef __TSHELL_H
+#define __TSHELL_H
+
+#include <stdint.h>
+
+// 串口调试命令行：串口接收中断逐字节送入，收到回车/换行后由优先级为TINYOS_SHELL_PRIO的命令任务解析执行，
+// 输出经printf重定向到MySerial；命令任务只在其它任务都不就绪时运行，不影响实时任务
+// 开启RTT时调试器写入RTT下行通道0的字符同样作为输入，MySerial的MYSERIAL_STDIO_RTT为1时输出也经RTT，不占用串口
+// 命令：ps(任务)、obj(事件类对象)、timer(软定时器)、help，驱动及应用可用tShellAddCmd追加命令
+
+// 一条命令，追加的命令由调用者静态分配，登记后不能释放
+typedef struct _tShellCmd {
+    const char * name;
+    void (*func) (void);
+    const char * help;
+    struct _tShellCmd * next;   //追加命令的链表，内置命令不使用
+}tShellCmd;
+
+void tShellInitTask(void);
+void tShellInputFromISR(uint8_t ch);
+void tShellAddCmd(tShellCmd * cmd);
+
+#endif
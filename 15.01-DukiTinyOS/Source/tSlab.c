@@ -0,0 +1,166 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_SLAB == 1
+// 无锁加减计数
+static uint32_t tSlabAtomicAdd(volatile uint32_t * value, int32_t delta) {
+	uint32_t newValue;
+	do {
+		newValue = __LDREXW((uint32_t *)value) + delta;
+	} while (__STREXW(newValue, (uint32_t *)value) != 0);
+	return newValue;
+}
+
+// 空闲栈出栈
+// 读出next到写回栈顶之间若被中断打断(中断中可能取走并放回同一块)，异常返回会清除独占监视器，
+// STREX失败后重新读取，因此不存在ABA问题
+static void * tSlabPop(tSlabClass * slabClass) {
+	tSlabNode * head;
+	do {
+		head = (tSlabNode *)__LDREXW((uint32_t *)&slabClass->freeHead);
+		if (head == (tSlabNode *)0) {
+			__CLREX();
+			return (void *)0;
+		}
+	} while (__STREXW((uint32_t)head->next, (uint32_t *)&slabClass->freeHead) != 0);
+	
+	{
+		uint32_t count = tSlabAtomicAdd(&slabClass->freeCount, -1);
+		if (count < slabClass->minFreeCount) {
+			slabClass->minFreeCount = count;
+		}
+	}
+	return head;
+}
+
+// 空闲栈入栈
+static void tSlabPush(tSlabClass * slabClass, void * mem) {
+	tSlabNode * block = (tSlabNode *)mem;
+	do {
+		block->next = (tSlabNode *)__LDREXW((uint32_t *)&slabClass->freeHead);
+	} while (__STREXW((uint32_t)block, (uint32_t *)&slabClass->freeHead) != 0);
+	tSlabAtomicAdd(&slabClass->freeCount, 1);
+}
+
+/**
+ * @brief 初始化分级分配器。
+ * 
+ * @param slab  指向分级分配器的指针。
+ * 
+ * @return void
+ */
+void tSlabInit(tSlab * slab) {
+	slab->classCount = 0;
+	slab->failCount = 0;
+}
+
+/**
+ * @brief 添加一级存储池。
+ * 
+ * 存储池需已由tMemBlockInit初始化，其中空闲的块全部转入本级的无锁空闲栈，此后只能通过tSlab分配和释放，
+ * 不能再直接调用tMemBlockWait/tMemBlockNotify。应在启动多任务前调用。
+ * 
+ * @param slab      指向分级分配器的指针。
+ * @param memBlock  已初始化的存储池。
+ * 
+ * @return uint32_t `tErrorNoError`表示成功，`tErrorResourceFull`表示级数已达TINYOS_SLAB_CLASS_MAX。
+ */
+uint32_t tSlabAddClass(tSlab * slab, tMemBlock * memBlock) {
+	uint32_t i;
+	uint8_t * mem;
+	tSlabClass * slabClass;
+	uint32_t status;
+	
+	if (slab->classCount >= TINYOS_SLAB_CLASS_MAX) {
+		return tErrorResourceFull;
+	}
+	
+	status = tTaskEnterCritical();
+	
+	// 按块大小插入，保持从小到大的顺序
+	for (i = slab->classCount; (i > 0) && (slab->slabClass[i - 1].memBlock->blockSize > memBlock->blockSize); i--) {
+		slab->slabClass[i] = slab->slabClass[i - 1];
+	}
+	slabClass = &slab->slabClass[i];
+	slabClass->memBlock = memBlock;
+	slabClass->memEnd = (uint8_t *)memBlock->memStart + memBlock->blockSize * memBlock->maxCount;
+	slabClass->freeHead = (tSlabNode *)0;
+	slabClass->freeCount = 0;
+	while (tMemBlockNoWaitGet(memBlock, &mem, 0) == tErrorNoError) {
+		tSlabPush(slabClass, mem);
+	}
+	slabClass->minFreeCount = slabClass->freeCount;
+	slab->classCount++;
+	
+	tTaskExitCritical(status);
+	return tErrorNoError;
+}
+
+/**
+ * @brief 分配内存，不会阻塞，可在中断中调用。
+ * 
+ * 从块大小不小于size的最小一级开始分配，该级已空时依次尝试更大的一级。
+ * 
+ * @param slab  指向分级分配器的指针。
+ * @param size  需要的字节数。
+ * 
+ * @return void* 分配到的内存，所有级都没有合适的空闲块时返回0。
+ */
+void * tSlabAlloc(tSlab * slab, uint32_t size) {
+	uint32_t i;
+	for (i = 0; i < slab->classCount; i++) {
+		tSlabClass * slabClass = &slab->slabClass[i];
+		if (slabClass->memBlock->blockSize >= size) {
+			void * mem = tSlabPop(slabClass);
+			if (mem) {
+				return mem;
+			}
+		}
+	}
+	tSlabAtomicAdd(&slab->failCount, 1);
+	return (void *)0;
+}
+
+/**
+ * @brief 释放内存，可在中断中调用。
+ * 
+ * 根据地址范围找到所属的一级，放回其空闲栈。
+ * 
+ * @param slab  指向分级分配器的指针。
+ * @param mem   tSlabAlloc分配的内存。
+ * 
+ * @return void
+ */
+void tSlabFree(tSlab * slab, void * mem) {
+	uint32_t i;
+	for (i = 0; i < slab->classCount; i++) {
+		tSlabClass * slabClass = &slab->slabClass[i];
+		if (((uint8_t *)mem >= (uint8_t *)slabClass->memBlock->memStart) && ((uint8_t *)mem < slabClass->memEnd)) {
+			tSlabPush(slabClass, mem);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief 获取某一级的状态信息。
+ * 
+ * @param slab   指向分级分配器的指针。
+ * @param index  级序号，0为块最小的一级。
+ * @param info   用于存放状态信息的结构体指针。
+ * 
+ * @return uint32_t `tErrorNoError`表示成功，`tErrorResourceUnavaliable`表示序号无效。
+ */
+uint32_t tSlabGetClassInfo(tSlab * slab, uint32_t index, tSlabClassInfo * info) {
+	tSlabClass * slabClass;
+	if (index >= slab->classCount) {
+		return tErrorResourceUnavaliable;
+	}
+	slabClass = &slab->slabClass[index];
+	info->blockSize = slabClass->memBlock->blockSize;
+	info->maxCount = slabClass->memBlock->maxCount;
+	info->freeCount = slabClass->freeCount;
+	info->minFreeCount = slabClass->minFreeCount;
+	return tErrorNoError;
+}
+#endif
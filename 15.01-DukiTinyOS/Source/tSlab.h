@@ -0,0 +1,38 @@
+#ifndef __TSLAB_H
+#define __TSLAB_H
+#include "tMemBlock.h"
+
+// 多尺寸分级内存分配器
+// 由若干个块大小递增的tMemBlock存储池组成，按请求的大小从能满足的最小一级中分配，
+// 每一级的空闲块组成单向链表栈，用LDREX/STREX无锁地出入栈，任务和任何优先级的中断中都可调用，不关中断
+typedef struct _tSlabNode {
+	struct _tSlabNode * next;
+}tSlabNode;
+
+typedef struct _tSlabClass {
+	tMemBlock * memBlock;            //提供存储空间的存储池，记录块大小和地址范围
+	uint8_t * memEnd;
+	tSlabNode * volatile freeHead;
+	volatile uint32_t freeCount;
+	volatile uint32_t minFreeCount;  //freeCount曾经到达的最小值
+}tSlabClass;
+
+typedef struct _tSlab {
+	uint32_t classCount;
+	tSlabClass slabClass[TINYOS_SLAB_CLASS_MAX];    //按块大小从小到大排列
+	volatile uint32_t failCount;     //分配失败次数
+}tSlab;
+
+typedef struct _tSlabClassInfo {
+	uint32_t blockSize;
+	uint32_t maxCount;
+	uint32_t freeCount;
+	uint32_t minFreeCount;
+}tSlabClassInfo;
+
+void tSlabInit(tSlab * slab);
+uint32_t tSlabAddClass(tSlab * slab, tMemBlock * memBlock);
+void * tSlabAlloc(tSlab * slab, uint32_t size);
+void tSlabFree(tSlab * slab, void * mem);
+uint32_t tSlabGetClassInfo(tSlab * slab, uint32_t index, tSlabClassInfo * info);
+#endif
@@ -0,0 +1,44 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+
+TINYOS_SECTION_DECLARE(const tStaticTask, tinyos_task);
+#if TINYOS_ENABLE_REGISTRY == 1
+TINYOS_SECTION_DECLARE(tObject * const, tinyos_object);
+#endif
+
+/**
+ * @brief 登记静态定义的内核对象，由tTinyOSInit在登记表初始化后调用。
+ *
+ * 对象本身在编译时已初始化完成，这里只把收集在tinyos_object段中的登记结点挂入登记表，
+ * 未开启登记表时没有需要做的工作。
+ *
+ * @return void
+ */
+void tStaticInit(void) {
+#if TINYOS_ENABLE_REGISTRY == 1
+    tObject * const * object;
+
+    for (object = TINYOS_SECTION_BEGIN(tinyos_object); object < TINYOS_SECTION_END(tinyos_object); object++) {
+        tRegistryAdd(*object, (tObjectType)(*object)->type);
+    }
+#endif
+}
+
+/**
+ * @brief 创建TINYOS_TASK_DEFINE定义的任务，由tTinyOSStart在选出第一个任务之前调用。
+ *
+ * 初始上下文的格式由移植层决定，仍在这里经tTaskInit构造，栈填充、加入就绪表等与动态创建的任务相同。
+ *
+ * @return void
+ */
+void tStaticStart(void) {
+    const tStaticTask * desc;
+
+    for (desc = TINYOS_SECTION_BEGIN(tinyos_task); desc < TINYOS_SECTION_END(tinyos_task); desc++) {
+        tTaskInit(desc->task, desc->entry, desc->param, desc->prio, desc->stack, desc->stackSize);
+        tObjectSetName(&desc->task->object, desc->name);
+    }
+}
+
+#endif
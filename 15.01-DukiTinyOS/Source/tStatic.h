@@ -0,0 +1,57 @@
+#ifndef __TSTATIC_H
+#define __TSTATIC_H
+
+#include <stdint.h>
+#include "tConfig.h"
+#include "tPort.h"
+#include "tRegistry.h"
+
+// 静态定义的内核对象：TINYOS_SEM_DEFINE、TINYOS_MBOX_DEFINE、TINYOS_MUTEX_DEFINE在编译时给出初始化完成的对象，
+// 链表头指向自身，放在.data段中由启动代码复制，不再调用tXxxInit；参数不合理时在编译时报错。
+// TINYOS_TASK_DEFINE定义任务及其栈，描述符收集在tinyos_task段中，tTinyOSStart在选出第一个任务前逐个创建；
+// 开启登记表时，静态对象的登记结点收集在tinyos_object段中，由tTinyOSInit统一登记。
+// 宏只能用在文件作用域，定义的对象是全局的，其它文件用extern声明后使用
+
+//编译时检查，cond为0时数组长度为负而报错，tag用于区分同一文件中的多个检查
+#define TINYOS_STATIC_ASSERT(tag, cond) typedef char tStaticAssert_##tag[(cond) ? 1 : -1]
+
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+
+#define TINYOS_STATIC_STACK_MIN     64      //TINYOS_TASK_DEFINE允许的最小栈(字)，需容纳初始上下文及异常压栈
+
+//TINYOS_TASK_DEFINE生成的任务描述符
+struct _tTask;
+typedef struct _tStaticTask {
+	struct _tTask * task;
+	void (*entry)(void *);
+	void * param;
+	uint32_t prio;
+	uint32_t * stack;
+	uint32_t stackSize;             //字节数
+	const char * name;
+}tStaticTask;
+
+#if TINYOS_ENABLE_REGISTRY == 1
+#define TINYOS_STATIC_REGISTER(name, obj) \
+	static tObject * const name##_object TINYOS_SECTION_ENTRY(tinyos_object) = &(obj)
+#else
+#define TINYOS_STATIC_REGISTER(name, obj) typedef char tStaticRegister_##name
+#endif
+
+//定义任务task及stackWords字的栈，优先级prio，tTinyOSStart时以param为参数创建，名称即task；
+//entry需在此之前声明；优先级超出范围或栈小于TINYOS_STATIC_STACK_MIN时编译报错
+#define TINYOS_TASK_DEFINE(task, entry, param, prio, stackWords) \
+	TINYOS_STATIC_ASSERT(task##_prio, (prio) < TINYOS_PRIO_COUNT); \
+	TINYOS_STATIC_ASSERT(task##_stackSize, (stackWords) >= TINYOS_STATIC_STACK_MIN); \
+	tTask task; \
+	static tTaskStack task##_stack[stackWords]; \
+	static const tStaticTask task##_static TINYOS_SECTION_ENTRY(tinyos_task) = { \
+		&task, entry, (void *)(param), (prio), task##_stack, sizeof(task##_stack), #task \
+	}
+
+void tStaticInit(void);
+void tStaticStart(void);
+
+#endif
+
+#endif
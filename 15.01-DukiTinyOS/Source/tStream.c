@@ -0,0 +1,270 @@
+#include <string.h>
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_STREAM == 1
+/**
+ * @brief 初始化字节流缓冲区。
+ * 
+ * @param stream        指向字节流的指针。
+ * @param buffer        存储区。
+ * @param size          存储区字节数。
+ * @param triggerLevel  读者被唤醒所需的最少字节数，超出范围时限制到1~size。
+ * 
+ * @return void
+ */
+void tStreamInit(tStream * stream, uint8_t * buffer, uint32_t size, uint32_t triggerLevel) {
+    tEventInit(&stream->event, tEventTypeStream);
+    tRegistryAdd(&stream->event.object, tObjectTypeEvent);
+    stream->buffer = buffer;
+    stream->size = size;
+    stream->count = 0;
+    stream->read = 0;
+    stream->write = 0;
+    tStreamSetTrigger(stream, triggerLevel);
+}
+
+/**
+ * @brief 修改触发字节数，对之后的读写生效。
+ * 
+ * @return void
+ */
+void tStreamSetTrigger(tStream * stream, uint32_t triggerLevel) {
+    if (triggerLevel == 0) {
+        triggerLevel = 1;
+    } else if (triggerLevel > stream->size) {
+        triggerLevel = stream->size;
+    }
+    stream->triggerLevel = triggerLevel;
+}
+
+//写入尽可能多的数据，回绕处最多分两段memcpy，需在临界区内调用，返回写入的字节数
+static uint32_t tStreamPush(tStream * stream, const uint8_t * data, uint32_t len) {
+    uint32_t span;
+    uint32_t space = stream->size - stream->count;
+
+    if (len > space) {
+        len = space;
+    }
+    span = stream->size - stream->write;
+    if (span > len) {
+        span = len;
+    }
+    memcpy(stream->buffer + stream->write, data, span);
+    memcpy(stream->buffer, data + span, len - span);
+
+    stream->write += len;
+    if (stream->write >= stream->size) {
+        stream->write -= stream->size;
+    }
+    stream->count += len;
+    return len;
+}
+
+//读出尽可能多的数据，需在临界区内调用，返回读出的字节数
+static uint32_t tStreamPop(tStream * stream, uint8_t * data, uint32_t len) {
+    uint32_t span;
+
+    if (len > stream->count) {
+        len = stream->count;
+    }
+    span = stream->size - stream->read;
+    if (span > len) {
+        span = len;
+    }
+    memcpy(data, stream->buffer + stream->read, span);
+    memcpy(data + span, stream->buffer, len - span);
+
+    stream->read += len;
+    if (stream->read >= stream->size) {
+        stream->read -= stream->size;
+    }
+    stream->count -= len;
+    return len;
+}
+
+//等待的读者和写者共用一个等待队列，eventMsg分别指向read和write字段作为标记
+#define tStreamReaderTag(stream)    ((void *)&(stream)->read)
+#define tStreamWriterTag(stream)    ((void *)&(stream)->write)
+
+//唤醒第一个带有指定标记的等待任务，被唤醒的任务回到自己的读写循环中复制数据
+//需在临界区内调用，唤醒了更高优先级的任务时返回1
+static uint32_t tStreamWakeUp(tStream * stream, void * tag) {
+    uint32_t i;
+    tNode * node = tListFirst(&stream->event.waitList);
+
+    for (i = tListCount(&stream->event.waitList); i > 0; i--) {
+        tTask * task = tNodeParent(node, tTask, linkNode);
+        if (task->eventMsg == tag) {
+            tEventWakeUpTask(&stream->event, task, (void *)0, tErrorNoError);
+            return (task->prio < curTask->prio);
+        }
+        node = node->nextNode;
+    }
+    return 0;
+}
+
+//写入的公共部分，需在临界区内调用，数据量达到触发字节数时唤醒一个读者
+static uint32_t tStreamPost(tStream * stream, const uint8_t * data, uint32_t len, uint32_t * sched) {
+    len = tStreamPush(stream, data, len);
+    if ((len > 0) && (stream->count >= stream->triggerLevel)) {
+        *sched |= tStreamWakeUp(stream, tStreamReaderTag(stream));
+    }
+    return len;
+}
+
+//读出的公共部分，需在临界区内调用，腾出空间后唤醒一个写者
+static uint32_t tStreamFetch(tStream * stream, uint8_t * data, uint32_t len, uint32_t * sched) {
+    len = tStreamPop(stream, data, len);
+    if (len > 0) {
+        *sched |= tStreamWakeUp(stream, tStreamWriterTag(stream));
+    }
+    return len;
+}
+
+/**
+ * @brief 写入数据，空间不足时等待读者取走数据后继续写入。
+ * 
+ * @param stream     指向字节流的指针。
+ * @param data       要写入的数据。
+ * @param len        字节数。
+ * @param waitTicks  每次等待的最大节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  实际写入的字节数，超时或字节流被删除时少于len。
+ */
+uint32_t tStreamWrite(tStream * stream, const void * data, uint32_t len, uint32_t waitTicks) {
+    const uint8_t * src = (const uint8_t *)data;
+    uint32_t done = 0;
+
+    for (;;) {
+        uint32_t sched = 0;
+        uint32_t status = tTaskEnterCritical();
+
+        done += tStreamPost(stream, src + done, len - done, &sched);
+        if (done >= len) {
+            tTaskExitCritical(status);
+            if (sched) {
+                tTaskSched();
+            }
+            return done;
+        }
+
+        tEventWait(&stream->event, curTask, tStreamWriterTag(stream), tEventTypeStream, waitTicks);
+        tTaskExitCritical(status);
+
+        tTaskSched();
+        if (curTask->waitEventResult != tErrorNoError) {
+            return done;
+        }
+    }
+}
+
+/**
+ * @brief 在中断服务函数中写入数据，不阻塞，唤醒任务后由tIntExit统一调度。
+ * 
+ * @return uint32_t  实际写入的字节数，空间不足时少于len。
+ */
+uint32_t tStreamWriteFromISR(tStream * stream, const void * data, uint32_t len) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    len = tStreamPost(stream, (const uint8_t *)data, len, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return len;
+}
+
+/**
+ * @brief 读取数据。
+ * 
+ * 数据量低于触发字节数时等待，达到后一次复制出最多len字节；超时后返回已有的数据。
+ * 
+ * @param stream     指向字节流的指针。
+ * @param data       接收缓冲区。
+ * @param len        最多读取的字节数。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ * 
+ * @return uint32_t  实际读取的字节数，字节流被删除时为0。
+ */
+uint32_t tStreamRead(tStream * stream, void * data, uint32_t len, uint32_t waitTicks) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    if (stream->count < stream->triggerLevel) {
+        tEventWait(&stream->event, curTask, tStreamReaderTag(stream), tEventTypeStream, waitTicks);
+        tTaskExitCritical(status);
+
+        tTaskSched();
+        if (curTask->waitEventResult == tErrorDel) {
+            return 0;
+        }
+        status = tTaskEnterCritical();
+    }
+
+    len = tStreamFetch(stream, (uint8_t *)data, len, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSched();
+    }
+    return len;
+}
+
+/**
+ * @brief 在中断服务函数中读取数据，不阻塞，不检查触发字节数，适合串口发送中断等取数据的场合。
+ * 
+ * @return uint32_t  实际读取的字节数。
+ */
+uint32_t tStreamReadFromISR(tStream * stream, void * data, uint32_t len) {
+    uint32_t sched = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    len = tStreamFetch(stream, (uint8_t *)data, len, &sched);
+
+    tTaskExitCritical(status);
+    if (sched) {
+        tTaskSchedFromISR();
+    }
+    return len;
+}
+
+/**
+ * @brief 获取字节流的状态信息。
+ * 
+ * @param stream    指向字节流的指针。
+ * @param info      用于存放字节流信息的结构体指针。
+ * 
+ * @return void
+ */
+void tStreamGetInfo(tStream * stream, tStreamInfo * info) {
+    uint32_t status = tTaskEnterCritical();
+
+    info->count = stream->count;
+    info->size = stream->size;
+    info->triggerLevel = stream->triggerLevel;
+    info->taskCount = tEventWaitCount(&stream->event);
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 删除字节流，唤醒所有等待的任务。
+ * 
+ * @param stream    指向字节流的指针。
+ * 
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tStreamDestroy(tStream * stream) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&stream->event, (void *)0, tErrorDel);
+    tRegistryRemove(&stream->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
@@ -0,0 +1,33 @@
+#ifndef __TSTREAM_H
+#define __TSTREAM_H
+
+#include "tEvent.h"
+
+// 字节流缓冲区，读写按连续的内存段整块复制，读者在数据量达到触发字节数后才被唤醒
+// 读者只在数据量低于触发字节数时等待，写者只在缓冲区满时等待，两者不会同时在等待队列中
+typedef struct _tStream {
+	tEvent event;
+	uint8_t * buffer;
+	uint32_t size;
+	uint32_t count;
+	uint32_t read;
+	uint32_t write;
+	uint32_t triggerLevel;           //读者被唤醒所需的最少字节数，范围为1~size
+}tStream;
+
+typedef struct _tStreamInfo {
+	uint32_t count;
+	uint32_t size;
+	uint32_t triggerLevel;
+	uint32_t taskCount;
+}tStreamInfo;
+
+void tStreamInit(tStream * stream, uint8_t * buffer, uint32_t size, uint32_t triggerLevel);
+void tStreamSetTrigger(tStream * stream, uint32_t triggerLevel);
+uint32_t tStreamWrite(tStream * stream, const void * data, uint32_t len, uint32_t waitTicks);
+uint32_t tStreamWriteFromISR(tStream * stream, const void * data, uint32_t len);
+uint32_t tStreamRead(tStream * stream, void * data, uint32_t len, uint32_t waitTicks);
+uint32_t tStreamReadFromISR(tStream * stream, void * data, uint32_t len);
+void tStreamGetInfo(tStream * stream, tStreamInfo * info);
+uint32_t tStreamDestroy(tStream * stream);
+#endif
@@ -0,0 +1,182 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_SUPERVISOR == 1
+//被监督的任务列表
+static tList tSupervisorList;
+static void (*tSupervisorMissHook) (tTask * task);
+//看门狗窗口长度及剩余节拍，0表示未启动看门狗
+static uint32_t tSupervisorWindow;
+static uint32_t tSupervisorWindowLeft;
+
+//任务的释放状态
+#define TSUPERVISOR_IDLE        0       //尚未登记释放时刻
+#define TSUPERVISOR_ARMED       1       //已释放，等待完成
+#define TSUPERVISOR_MISSED      2       //本次释放已报告错过截止时间
+
+/**
+ * @brief 初始化监督模块，由tTinyOSInit调用
+ * 
+ * @return void
+ */
+void tSupervisorInit(void) {
+    tListInit(&tSupervisorList);
+    tSupervisorMissHook = (void (*)(tTask *))0;
+    tSupervisorWindow = 0;
+    tSupervisorWindowLeft = 0;
+}
+
+//错过截止时间或未按时报到，需在临界区内调用
+static void tSupervisorMiss(tTask * task) {
+    task->deadlineMissCount++;
+    if (tSupervisorMissHook) {
+        tSupervisorMissHook(task);
+    }
+}
+
+/**
+ * @brief 将周期任务加入监督
+ * 
+ * @param task 任务控制块，需以tTaskDelayUntil实现周期。
+ * @param deadline 从释放时刻起到完成(再次调用tTaskDelayUntil)的截止时间(节拍)。
+ * @param critical 1表示关键任务，看门狗窗口内未完成过一个周期时不喂狗。
+ * 
+ * @return void
+ */
+void tTaskSupervise(tTask * task, uint32_t deadline, uint32_t critical) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (task->superNode.nextNode == &(task->superNode)) {
+        tListAddLast(&tSupervisorList, &(task->superNode));
+    }
+    task->superDeadline = deadline;
+    task->superCritical = (uint8_t)critical;
+    task->superState = TSUPERVISOR_IDLE;
+    task->superCheckedIn = 0;
+
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 将任务移出监督，删除任务时在临界区内调用
+ * 
+ * @param task 任务控制块。
+ * 
+ * @return void
+ */
+void tSupervisorRemove(tTask * task) {
+    if (task->superNode.nextNode != &(task->superNode)) {
+        tListRemove(&tSupervisorList, &(task->superNode));
+        tNodeInit(&(task->superNode));
+    }
+}
+
+/**
+ * @brief 设置错过截止时间时调用的钩子函数，在节拍中断或任务中调用，不能阻塞
+ * 
+ * 可在钩子中执行失效保护(如停止电机)，看门狗窗口内关键任务未报到时也会以该任务调用钩子。
+ * 
+ * @param hook 钩子函数，参数为出错的任务。
+ * 
+ * @return void
+ */
+void tSupervisorSetMissHook(void (*hook) (tTask * task)) {
+    uint32_t status = tTaskEnterCritical();
+    tSupervisorMissHook = hook;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 启动独立看门狗(IWDG)，此后只在每个窗口内所有关键任务都完成过一个周期时喂狗
+ * 
+ * IWDG时钟为LSI(约32kHz)，64分频后每计数约2ms，超时时间最大约8s；启动后不能停止。
+ * 
+ * @param windowTicks 检查窗口(节拍)，应小于超时时间。
+ * @param timeoutMs 看门狗超时时间(毫秒)。
+ * 
+ * @return void
+ */
+void tSupervisorWatchdogStart(uint32_t windowTicks, uint32_t timeoutMs) {
+    uint32_t reload = timeoutMs / 2;
+    uint32_t status;
+
+    if (reload > 0xFFF) {
+        reload = 0xFFF;
+    }
+    IWDG->KR = 0x5555;              //解除PR、RLR写保护
+    IWDG->PR = 4;                   //64分频
+    IWDG->RLR = reload;
+    IWDG->KR = 0xCCCC;              //启动
+    IWDG->KR = 0xAAAA;
+
+    status = tTaskEnterCritical();
+    tSupervisorWindow = windowTicks;
+    tSupervisorWindowLeft = windowTicks;
+    tTaskExitCritical(status);
+}
+
+/**
+ * @brief 周期任务完成一个周期，由tTaskDelayUntil在临界区内调用
+ * 
+ * @param task 完成的任务。
+ * @param release 本周期的释放时刻。
+ * @param nextRelease 下一次的释放时刻。
+ * 
+ * @return void
+ */
+void tSupervisorComplete(tTask * task, uint32_t release, uint32_t nextRelease) {
+    if (task->superNode.nextNode == &(task->superNode)) {
+        return;
+    }
+    // 节拍中断尚未发现时在这里报告
+    if ((task->superState == TSUPERVISOR_ARMED) && ((tTaskTickGet() - release) > task->superDeadline)) {
+        tSupervisorMiss(task);
+    }
+    task->superCheckedIn = 1;
+    task->superRelease = nextRelease;
+    task->superState = TSUPERVISOR_ARMED;
+}
+
+/**
+ * @brief 监督模块的节拍处理，在节拍中断的临界区内调用
+ * 
+ * @return void
+ */
+void tSupervisorTick(void) {
+    uint32_t i;
+    uint32_t allCheckedIn = 1;
+    uint32_t windowEnd = 0;
+    uint32_t count = tListCount(&tSupervisorList);
+    tNode * node = tListFirst(&tSupervisorList);
+    uint32_t now = tTaskTickGet();
+
+    if ((tSupervisorWindow != 0) && (--tSupervisorWindowLeft == 0)) {
+        tSupervisorWindowLeft = tSupervisorWindow;
+        windowEnd = 1;
+    }
+
+    for (i = 0; i < count; i++) {
+        tTask * task = tNodeParent(node, tTask, superNode);
+        node = tListNext(&tSupervisorList, node);
+
+        // 释放时刻可能在将来(任务提前完成)，用有符号差值判断
+        if ((task->superState == TSUPERVISOR_ARMED)
+            && ((int32_t)(now - task->superRelease) > (int32_t)task->superDeadline)) {
+            task->superState = TSUPERVISOR_MISSED;
+            tSupervisorMiss(task);
+        }
+
+        if (windowEnd && task->superCritical) {
+            if (!task->superCheckedIn) {
+                allCheckedIn = 0;
+                tSupervisorMiss(task);
+            }
+            task->superCheckedIn = 0;
+        }
+    }
+
+    if (windowEnd && allCheckedIn) {
+        IWDG->KR = 0xAAAA;
+    }
+}
+#endif
@@ -0,0 +1,19 @@
+#ifndef __TSUPERVISOR_H
+#define __TSUPERVISOR_H
+
+#include "tLib.h"
+
+// 周期任务监督：任务每次调用tTaskDelayUntil视为完成本周期并登记下一次释放时刻，
+// 释放后超过截止时间仍未完成即为错过截止时间，由节拍中断检查，每次释放最多报告一次；
+// 关键任务还需在每个看门狗窗口内至少完成一次，全部完成才喂狗，否则调用钩子并让IWDG复位
+struct _tTask;
+
+void tSupervisorInit(void);
+void tTaskSupervise(struct _tTask * task, uint32_t deadline, uint32_t critical);
+void tSupervisorSetMissHook(void (*hook) (struct _tTask * task));
+void tSupervisorWatchdogStart(uint32_t windowTicks, uint32_t timeoutMs);
+
+void tSupervisorRemove(struct _tTask * task);
+void tSupervisorComplete(struct _tTask * task, uint32_t release, uint32_t nextRelease);
+void tSupervisorTick(void);
+#endif
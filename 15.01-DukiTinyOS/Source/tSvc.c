@@ -0,0 +1,235 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_USER_MODE == 1
+
+#if (4 + TINYOS_USER_REGION_MAX) > 7
+#error "TINYOS_USER_REGION_MAX must not exceed 2, MPU region 7 is the stack guard"
+#endif
+
+// 硬件压入的栈帧中各寄存器的位置(字)
+#define TSVC_FRAME_R0       0
+#define TSVC_FRAME_LR       5
+#define TSVC_FRAME_PC       6
+#define TSVC_FRAME_XPSR     7
+// xPSR中的IT/ICI位，SVC位于IT块中时不能带入内核函数
+#define TSVC_XPSR_IT_MASK   0x0600FC00UL
+
+#define TSVC_MPU_REGION_FLASH   0
+#define TSVC_MPU_REGION_STACK   4
+
+typedef void (*tSvcFunc)(void);
+
+#define TSVC_TABLE(fn, ret, params) (tSvcFunc)fn,
+static const tSvcFunc tSvcTable[tSvcIdCount] = {
+    TINYOS_SVC_LIST(TSVC_TABLE)
+};
+
+static uint8_t svcUserRegionsLoaded;    // MPU中装载的是非特权任务的区域，切换到特权任务时需要关闭
+static uint32_t svcFaultCount;
+
+void tSvcReturn(void);
+void tSvcDispatch(uint32_t * frame, uint32_t excReturn);
+
+// SVC入口：取出调用者使用的栈帧，连同EXC_RETURN交给tSvcDispatch，后者返回时直接异常返回；
+// 返回桩：内核函数返回到这里，再次进入SVC恢复调用者的返回地址
+#if defined(__CC_ARM)
+__asm void SVC_Handler(void) {
+	IMPORT tSvcDispatch
+
+	TST LR,#4
+	ITE EQ
+	MRSEQ R0,MSP
+	MRSNE R0,PSP
+	MOV R1,LR
+	B tSvcDispatch
+}
+
+__asm void tSvcReturn(void) {
+	SVC #TINYOS_SVC_RETURN
+}
+#elif defined(__GNUC__) || defined(__clang__)
+__attribute__((naked)) void SVC_Handler(void) {
+	__asm volatile (
+	"	.syntax unified					\n"
+	"	tst lr, #4						\n"
+	"	ite eq							\n"
+	"	mrseq r0, msp					\n"
+	"	mrsne r0, psp					\n"
+	"	mov r1, lr						\n"
+	"	b tSvcDispatch					\n"
+	);
+}
+
+__attribute__((naked)) void tSvcReturn(void) {
+	__asm volatile ("	svc %0	\n" :: "i"(TINYOS_SVC_RETURN));
+}
+
+// 桩函数只有一条SVC指令，返回时LR已由返回桩恢复
+#define TSVC_STUB_DEFINE(fn, ret, params) \
+	__attribute__((naked)) ret fn##User params { \
+		__asm volatile ("	svc %0	\n	bx lr	\n" :: "i"(tSvcId_##fn)); \
+	}
+TINYOS_SVC_LIST(TSVC_STUB_DEFINE)
+#else
+#error "unsupported compiler"
+#endif
+
+/**
+ * @brief 系统调用分派，由SVC_Handler调用，返回后直接异常返回
+ *
+ * SVC指令之前的半字为其编号。调用时把调用者的返回地址及LR保存到任务中，栈帧的返回地址改为内核函数、
+ * LR改为返回桩，线程模式切换为特权；R0 ~ R3及栈中的参数保持不动，由内核函数直接使用。
+ * 返回桩的SVC恢复保存的返回地址及LR，非特权任务回到非特权模式，内核函数的返回值仍在栈帧的R0中。
+ * 只接受任务的调用，中断或调度器启动前调用、以及正在系统调用中再次调用时返回TINYOS_SVC_ERROR。
+ *
+ * @param frame 调用者的栈帧
+ * @param excReturn SVC异常的EXC_RETURN
+ *
+ * @return void
+ */
+void tSvcDispatch(uint32_t * frame, uint32_t excReturn) {
+    uint32_t num = ((const uint8_t *)frame[TSVC_FRAME_PC])[-2];
+    tTask * task = curTask;
+
+    if (num == TINYOS_SVC_RETURN) {
+        if ((task != (tTask *)0) && task->svcActive) {
+            frame[TSVC_FRAME_PC] = task->svcPc;
+            frame[TSVC_FRAME_LR] = task->svcLr;
+            task->svcActive = 0;
+            if (task->userMode) {
+                __set_CONTROL(__get_CONTROL() | CONTROL_nPRIV_Msk);
+            }
+        }
+        return;
+    }
+
+    // EXC_RETURN的bit3、bit2均为1：返回线程模式且使用PSP，即由任务调用
+    if ((num >= tSvcIdCount) || ((excReturn & 0xC) != 0xC) || (task == (tTask *)0) || task->svcActive) {
+        frame[TSVC_FRAME_R0] = TINYOS_SVC_ERROR;
+        return;
+    }
+    task->svcPc = frame[TSVC_FRAME_PC];
+    task->svcLr = frame[TSVC_FRAME_LR];
+    task->svcActive = 1;
+    frame[TSVC_FRAME_LR] = (uint32_t)tSvcReturn;
+    frame[TSVC_FRAME_PC] = (uint32_t)tSvcTable[num] & ~1UL;
+    frame[TSVC_FRAME_XPSR] &= ~TSVC_XPSR_IT_MASK;
+    __set_CONTROL(__get_CONTROL() & ~CONTROL_nPRIV_Msk);
+}
+
+/**
+ * @brief 设置Flash区域并开启MPU及MemManage异常，由tTinyOSInit在启动调度前调用
+ *
+ * 未被区域覆盖的地址特权代码按默认存储映射访问，非特权代码不能访问；Flash对特权代码保持可写，不影响Flash编程。
+ *
+ * @return void
+ */
+void tSvcInit(void) {
+    MPU->RBAR = TINYOS_USER_FLASH_BASE | MPU_RBAR_VALID_Msk | TSVC_MPU_REGION_FLASH;
+    MPU->RASR = (2UL << MPU_RASR_AP_Pos) | (1UL << MPU_RASR_C_Pos)
+              | ((TINYOS_USER_FLASH_SIZE_LOG2 - 1) << MPU_RASR_SIZE_Pos) | MPU_RASR_ENABLE_Msk;
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    __DSB();
+    __ISB();
+}
+
+/**
+ * @brief 把任务设为非特权模式，需在任务第一次运行之前调用
+ *
+ * 任务栈作为区域4，大小需为2的幂(不小于32字节)，起始地址按大小对齐，可用TINYOS_MPU_ALIGN定义；
+ * regions中的数据区依次作为区域5、6，数组需一直有效。
+ *
+ * @param task 任务
+ * @param regions 数据区，可为0
+ * @param count 数据区个数，不超过TINYOS_USER_REGION_MAX
+ *
+ * @return tErrorNoError成功，tErrorParam栈不满足MPU区域的要求或数据区过多
+ */
+uint32_t tTaskSetUserMode(tTask * task, const tMpuRegion * regions, uint32_t count) {
+    uint32_t size = task->stackSize;
+    uint32_t log2 = 31 - __CLZ(size);
+
+    if ((size < 32) || (size & (size - 1)) || ((uint32_t)task->stackBase & (size - 1))
+        || (count > TINYOS_USER_REGION_MAX)) {
+        return tErrorParam;
+    }
+
+    task->mpuStackRbar = (uint32_t)task->stackBase;
+    task->mpuStackRasr = TINYOS_MPU_ATTR_RW | ((log2 - 1) << MPU_RASR_SIZE_Pos) | MPU_RASR_ENABLE_Msk;
+    task->mpuRegions = regions;
+    task->mpuRegionCount = count;
+    task->userMode = 1;
+    return tErrorNoError;
+}
+
+/**
+ * @brief 由PendSV在curTask更新为切入的任务后调用，装载其MPU区域并设置线程模式的特权级
+ *
+ * 正在系统调用中阻塞的任务仍以特权方式恢复；前后两个任务都是特权任务时不访问MPU。
+ *
+ * @return void
+ */
+void tSvcSwitchIn(void) {
+    tTask * task = curTask;
+    uint32_t i;
+
+    if (task->userMode) {
+        MPU->RBAR = task->mpuStackRbar | MPU_RBAR_VALID_Msk | TSVC_MPU_REGION_STACK;
+        MPU->RASR = task->mpuStackRasr;
+        for (i = 0; i < TINYOS_USER_REGION_MAX; i++) {
+            if (i < task->mpuRegionCount) {
+                MPU->RBAR = task->mpuRegions[i].rbar | MPU_RBAR_VALID_Msk | (TSVC_MPU_REGION_STACK + 1 + i);
+                MPU->RASR = task->mpuRegions[i].rasr;
+            } else {
+                MPU->RBAR = MPU_RBAR_VALID_Msk | (TSVC_MPU_REGION_STACK + 1 + i);
+                MPU->RASR = 0;
+            }
+        }
+        svcUserRegionsLoaded = 1;
+    } else if (svcUserRegionsLoaded) {
+        for (i = 0; i <= TINYOS_USER_REGION_MAX; i++) {
+            MPU->RBAR = MPU_RBAR_VALID_Msk | (TSVC_MPU_REGION_STACK + i);
+            MPU->RASR = 0;
+        }
+        svcUserRegionsLoaded = 0;
+    }
+
+    if (task->userMode && !task->svcActive) {
+        __set_CONTROL(__get_CONTROL() | CONTROL_nPRIV_Msk);
+    } else {
+        __set_CONTROL(__get_CONTROL() & ~CONTROL_nPRIV_Msk);
+    }
+    __DSB();
+}
+
+/**
+ * @brief MemManage异常中调用，判断是否为非特权任务的越权访问，是则删除该任务
+ *
+ * 异常直接来自线程模式(没有其它活动的异常)、且当前任务以非特权方式运行时才处理；
+ * 删除后挂起的PendSV在异常返回前切换到其它任务，不会再执行出错的指令。
+ *
+ * @return uint32_t 1已处理，异常可以返回；0不是非特权任务引起的
+ */
+uint32_t tSvcFault(void) {
+    tTask * task = curTask;
+
+    if ((task == (tTask *)0) || !task->userMode || task->svcActive || !(SCB->ICSR & SCB_ICSR_RETTOBASE_Msk)) {
+        return 0;
+    }
+    SCB->CFSR = SCB_CFSR_MEMFAULTSR_Msk;
+    svcFaultCount++;
+    tTaskForceDelete(task);
+    return 1;
+}
+
+/**
+ * @brief 获取因越权访问而被删除的非特权任务数
+ *
+ * @return uint32_t 任务数
+ */
+uint32_t tSvcFaultCount(void) {
+    return svcFaultCount;
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef __TSVC_H
+#define __TSVC_H
+#include <stdint.h>
+
+// 非特权任务模式：tTaskSetUserMode指定的任务以非特权方式运行，只能访问MPU区域允许的存储：
+//   区域0：Flash，非特权只读、可执行；区域4：任务自己的栈；区域5 ~ 4+TINYOS_USER_REGION_MAX：任务指定的数据区；
+//   区域7：栈底保护区(TINYOS_ENABLE_STACK_GUARD)
+// 内核数据、其它任务的栈及外设只有特权代码可以访问，非特权任务越权访问时触发MemManage，由tSvcFault删除该任务，其它任务继续运行。
+// 非特权任务经系统调用使用内核：xxxUser桩函数只有一条SVC指令，SVC中断按编号查表，把栈帧中的返回地址改为内核函数、
+// LR改为返回桩，并把线程模式临时切换为特权；异常返回后内核函数直接在任务栈上运行，参数仍在R0 ~ R3及栈中，不做复制，
+// 可以阻塞等待；内核函数返回到返回桩，其中的SVC恢复原来的返回地址及LR并回到非特权模式。每次调用两次异常，约几十个周期。
+// 内核对象及输出参数的指针由调用者保证有效，内核不检查是否在任务的区域内；
+// 需开启TINYOS_ENABLE_TASK_DELETE，不支持Cortex-M0
+#define TINYOS_USER_FLASH_BASE      0x08000000  // 非特权任务可执行的Flash区域
+#define TINYOS_USER_FLASH_SIZE_LOG2 19          // Flash区域为2的该次幂字节，STM32F401RE为512KB
+#define TINYOS_USER_REGION_MAX      2           // 每个任务可指定的数据区个数，区域号从5开始，不超过6
+
+#define TINYOS_SVC_RETURN           0xFF        // 返回桩使用的SVC编号
+#define TINYOS_SVC_ERROR            0xFFFFFFFFUL // 编号无效或不是在任务中调用时的返回值
+
+// MPU区域属性(RASR中的XN、AP及存储类型)：SRAM按普通存储、可共享、写通，数据区不可执行
+#define TINYOS_MPU_ATTR_RW          ((1UL << 28) | (3UL << 24) | (1UL << 18) | (1UL << 17))    // 特权及非特权读写
+#define TINYOS_MPU_ATTR_RO          ((1UL << 28) | (2UL << 24) | (1UL << 18) | (1UL << 17))    // 非特权只读
+
+// 按区域大小对齐，栈及数据区的起始地址需为其大小(2的幂，不小于32字节)的整数倍
+#define TINYOS_MPU_ALIGN(bytes)     __attribute__((aligned(bytes)))
+
+// 数据区：base按2的sizeLog2次幂对齐，attr为TINYOS_MPU_ATTR_xxx
+#define TINYOS_MPU_REGION(base, sizeLog2, attr) {(uint32_t)(base), (attr) | ((uint32_t)((sizeLog2) - 1) << 1) | 1UL}
+
+typedef struct _tMpuRegion {
+	uint32_t rbar;                  //基地址
+	uint32_t rasr;                  //属性、大小及使能位
+}tMpuRegion;
+
+#if TINYOS_ENABLE_USER_MODE == 1
+// 系统调用表：函数名、返回类型、参数表，桩函数为函数名加User，参数不超过4个(ARMCC的__svc只用R0 ~ R3传参)
+#define TSVC_LIST_TASK(X) \
+	X(tTaskDelay, void, (uint32_t delay)) \
+	X(tTaskYield, void, (void)) \
+	X(tTaskTickGet, uint32_t, (void)) \
+	X(tTaskDeleteSelf, void, (void))
+
+#if TINYOS_ENABLE_SEM == 1
+#define TSVC_LIST_SEM(X) \
+	X(tSemWait, uint32_t, (tSem * sem, uint32_t waitTicks)) \
+	X(tSemNoWaitGet, uint32_t, (tSem * sem)) \
+	X(tSemNotify, void, (tSem * sem))
+#else
+#define TSVC_LIST_SEM(X)
+#endif
+
+#if TINYOS_ENABLE_MBOX == 1
+#define TSVC_LIST_MBOX(X) \
+	X(tMboxWait, uint32_t, (tMbox * mbox, void ** msg, uint32_t waitTicks)) \
+	X(tMboxNoWaitGet, uint32_t, (tMbox * mbox, void ** msg)) \
+	X(tMboxNotify, uint32_t, (tMbox * mbox, void * msg, uint32_t notifyOption))
+#else
+#define TSVC_LIST_MBOX(X)
+#endif
+
+#if TINYOS_ENABLE_MUTEX == 1
+#define TSVC_LIST_MUTEX(X) \
+	X(tMutexWait, uint32_t, (tMutex * mutex, uint32_t waitTicks)) \
+	X(tMutexNoWaitGet, uint32_t, (tMutex * mutex)) \
+	X(tMutexNotify, uint32_t, (tMutex * mutex))
+#else
+#define TSVC_LIST_MUTEX(X)
+#endif
+
+#if TINYOS_ENABLE_FLAGGROUP == 1
+#define TSVC_LIST_FLAGGROUP(X) \
+	X(tFlagGroupNotify, void, (tFlagGroup * flagGroup, uint8_t isSet, uint32_t flag))
+#else
+#define TSVC_LIST_FLAGGROUP(X)
+#endif
+
+#if TINYOS_ENABLE_NOTIFY == 1
+#define TSVC_LIST_NOTIFY(X) \
+	X(tTaskNotify, void, (tTask * task, uint32_t value, tNotifyAction action)) \
+	X(tTaskNotifyTake, uint32_t, (uint8_t clearOnExit, uint32_t waitTicks)) \
+	X(tTaskNotifyWait, uint32_t, (uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t * value, uint32_t waitTicks))
+#else
+#define TSVC_LIST_NOTIFY(X)
+#endif
+
+#define TINYOS_SVC_LIST(X) TSVC_LIST_TASK(X) TSVC_LIST_SEM(X) TSVC_LIST_MBOX(X) TSVC_LIST_MUTEX(X) \
+	TSVC_LIST_FLAGGROUP(X) TSVC_LIST_NOTIFY(X)
+
+#define TSVC_ID(fn, ret, params) tSvcId_##fn,
+typedef enum _tSvcId {
+	TINYOS_SVC_LIST(TSVC_ID)
+	tSvcIdCount,
+}tSvcId;
+
+// 桩函数：ARMCC由__svc直接生成SVC指令，其余编译器由tSvc.c定义
+#if defined(__CC_ARM)
+#define TSVC_STUB_DECLARE(fn, ret, params) __svc(tSvcId_##fn) ret fn##User params;
+#else
+#define TSVC_STUB_DECLARE(fn, ret, params) ret fn##User params;
+#endif
+TINYOS_SVC_LIST(TSVC_STUB_DECLARE)
+
+void tSvcInit(void);
+uint32_t tTaskSetUserMode(tTask * task, const tMpuRegion * regions, uint32_t count);
+void tSvcSwitchIn(void);
+uint32_t tSvcFault(void);
+uint32_t tSvcFaultCount(void);
+#endif
+#endif
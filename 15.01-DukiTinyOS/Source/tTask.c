@@ -1,4 +1,13 @@
 #include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+static void tTaskStackMonitorAdd(tTask * task);
+static void tTaskStackMonitorRemove(tTask * task);
+#endif
+#if TINYOS_ENABLE_BUDGET == 1
+static void tTaskBudgetRemove(tTask * task);
+#endif
 
 /**
  * @brief 定义任务初始化函数
@@ -10,76 +19,196 @@
  * @param param 任务的入口函数参数。
  * @param prio 任务的优先级。
  * @param tTaskStack 任务堆栈指针，用于保存任务的上下文信息。
+ * @param stackSize 任务堆栈的字节数，传入sizeof(栈数组)。
  * 
  * @return void
  */
-void tTaskInit(tTask *task, void(*entry)(void *), void * param, uint32_t prio, tTaskStack * stack, tTaskStack stackSize) {
+void tTaskInit(tTask *task, void(*entry)(void *), void * param, uint32_t prio, tTaskStack * stack, uint32_t stackSize) {
 	  //现在传入的是堆栈底
 	  tTaskStack * stackTop;  //栈顶
 	  task->stackBase = stack;
 	  task->stackSize = stackSize;
-	  memset(stack,0,stackSize);
+#if (TINYOS_ENABLE_STACK_FILL == 1) || (TINYOS_ENABLE_STACK_MONITOR == 1)
+	  // 统计栈剩余空间需要整个栈都填充
+	  memset(stack,TINYOS_TASK_STACK_FILL_BYTE,stackSize);
+#elif TINYOS_ENABLE_STACK_CHECK == 1
+	  // 只填充切换时检查的栈底保护字
+	  memset(stack,TINYOS_TASK_STACK_FILL_BYTE,TINYOS_STACK_CANARY_WORDS * sizeof(tTaskStack));
+#endif
 	
-	  //栈顶指针等于栈底+栈单元个数
+	  //栈顶指针等于栈底+栈单元个数，初始上下文的格式与处理器相关，由移植层构造
 	  stackTop = stack + stackSize / (sizeof(tTaskStack));
-	
-    // 设置xpsr寄存器，第24位置1进入Thumb模式
-    *(--stackTop) = (unsigned long)(1 << 24); 
-
-    // 设置PC寄存器（程序计数器），即任务入口地址
-    *(--stackTop) = (unsigned long)entry;     
-
-    // 设置LR寄存器（链接寄存器），即任务返回地址
-    *(--stackTop) = (unsigned long)0xFFFFFFFD;      
-
-    // 设置其他寄存器的初始值
-    *(--stackTop) = (unsigned long)0x12;      // R12寄存器
-    *(--stackTop) = (unsigned long)0x3;       // R3寄存器
-    *(--stackTop) = (unsigned long)0x2;       // R2寄存器
-    *(--stackTop) = (unsigned long)0x1;       // R1寄存器
-    *(--stackTop) = (unsigned long)param;     // 任务的入口函数参数
-
-    // 设置其他寄存器的初始值
-    *(--stackTop) = (unsigned long)0x11;      // R11寄存器
-    *(--stackTop) = (unsigned long)0x10;      // R10寄存器
-    *(--stackTop) = (unsigned long)0x9;       // R9寄存器
-    *(--stackTop) = (unsigned long)0x8;       // R8寄存器
-    *(--stackTop) = (unsigned long)0x7;       // R7寄存器
-    *(--stackTop) = (unsigned long)0x6;       // R6寄存器
-    *(--stackTop) = (unsigned long)0x5;       // R5寄存器
-    *(--stackTop) = (unsigned long)0x4;       // R4寄存器
-
-    // 设置任务的堆栈指针
-    task->stack = stackTop;
+    task->stack = tTaskStackInit(stackTop, entry, param);
 
     // 初始化任务的延时、优先级、状态等字段
     task->delayTicks = 0;
     task->prio = prio;
     task->state = TINYOS_TASK_STATE_RDY;
 
-    // 初始化时间片
+#if TINYOS_ENABLE_SLICE == 1
+    // 初始化时间片，默认长度为TINYOS_SLICE_MAX，可由tTaskSetSlice修改
+    task->sliceMax = TINYOS_SLICE_MAX;
     task->slice = TINYOS_SLICE_MAX; 
+#endif
 
+#if TINYOS_ENABLE_SUSPEND == 1
     // 初始化挂起计数
     task->suspendCount = 0;
+#endif
+
+#if TINYOS_ENABLE_PREEMPT_THRESHOLD == 1
+    // 抢占阈值默认等于优先级，即普通的抢占式调度
+    task->preemptThreshold = prio;
+#endif
+
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    // 默认不受监督
+    tNodeInit(&(task->superNode));
+    task->deadlineMissCount = 0;
+#endif
 
+#if TINYOS_ENABLE_BUDGET == 1
+    // 默认不限制运行时间
+    tNodeInit(&(task->budgetNode));
+    task->budget = 0;
+    task->budgetExhausted = 0;
+#endif
+
+#if TINYOS_ENABLE_EDF == 1
+    // 截止时间默认为当前时刻，需在加入就绪队列前设置
+    task->deadline = tTaskTickGet();
+#endif
+
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+    // 清除周期任务统计
+    task->overrunCount = 0;
+    task->maxJitterCycles = 0;
+#endif
+
+#if TINYOS_ENABLE_TASK_DELETE == 1
     // 清除清理回调函数及其参数
     task->clean = (void (*)(void *))0;
     task->cleanParam = (void *)0;
     task->requestDeleteFlag = 0;
+#endif
+
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    // 清除运行时间统计
+    task->runCycles = 0;
+#endif
+
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    // 清除阻塞时间统计
+    task->waitReason = TINYOS_WAIT_REASON_NONE;
+    task->waitStatEvent = (struct _tEvent *)0;
+    tTaskWaitStatReset(task);
+#endif
+
+#if TINYOS_ENABLE_MUTEX == 1
+    // 初始化原优先级及持有的互斥量列表
+    task->basePrio = prio;
+    tListInit(&(task->heldMutexList));
+    task->ownedMutexCount = 0;
+#endif
+
+#if TINYOS_ENABLE_MSG_CALL == 1
+    tListInit(&(task->serverChannelList));
+#endif
+
+#if TINYOS_ENABLE_NOTIFY == 1
+    // 清除任务通知
+    task->notifyValue = 0;
+    task->notifyState = 0;
+#endif
+
+#if TINYOS_ENABLE_USER_MODE == 1
+    // 默认为特权任务，由tTaskSetUserMode设置
+    task->userMode = 0;
+    task->svcActive = 0;
+    task->mpuRegions = (const tMpuRegion *)0;
+    task->mpuRegionCount = 0;
+#endif
 
     // 初始化延时队列和优先级队列
     tNodeInit(&(task->delayNode)); // 延时队列
     tNodeInit(&(task->linkNode));  // 优先级队列
 
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+    // 加入栈水位监视列表，第一轮扫描完成前剩余空间按整个栈计
+    task->stackFreeWords = stackSize / sizeof(tTaskStack);
+    task->stackScanPos = 0;
+    tNodeInit(&(task->stackMonitorNode));
+    tTaskStackMonitorAdd(task);
+#endif
+
+    // 登记到对象表，供调试工具遍历
+    tRegistryAdd(&task->object, tObjectTypeTask);
+
     // 将任务加入就绪队列
     tTaskSchedRdy(task);
-#if TINYOS_ENABLE_HOOKS == 1
-		tHooksTaskInit(task);
+    tHooksRunTaskInit(task);
+
+}
+
+#if TINYOS_ENABLE_SLICE == 1
+/**
+ * @brief 设置任务的时间片长度
+ * 
+ * @param task 任务控制块。
+ * @param slice 时间片长度(节拍数)，最大65535，0表示该任务不参与同优先级间的时间片轮转。
+ * 
+ * @return void
+ */
+void tTaskSetSlice(tTask * task, uint32_t slice) {
+    uint32_t status = tTaskEnterCritical();
+
+    if (slice > 0xFFFF) {
+        slice = 0xFFFF;
+    }
+
+    task->sliceMax = slice;
+    task->slice = slice;
+
+    tTaskExitCritical(status);
+}
+#endif
+
+#if TINYOS_ENABLE_PREEMPT_THRESHOLD == 1
+/**
+ * @brief 设置任务的抢占阈值
+ * 
+ * 任务运行期间，只有优先级数值小于threshold的任务能抢占它，优先级介于两者之间的任务要等它阻塞后才能运行。
+ * 一组相互协作的任务把阈值设为组内最高优先级，组内就不再相互抢占；阈值不会使同优先级任务间的时间片轮转生效。
+ * 
+ * @param task 任务控制块。
+ * @param threshold 抢占阈值，大于任务优先级时按优先级处理。
+ * 
+ * @return void
+ */
+void tTaskSetPreemptThreshold(tTask * task, uint32_t threshold) {
+    uint32_t status = tTaskEnterCritical();
+
+#if TINYOS_ENABLE_MUTEX == 1
+    // 与原优先级比较，不受互斥量优先级继承的影响
+    if (threshold > task->basePrio) {
+        threshold = task->basePrio;
+    }
+#else
+    if (threshold > task->prio) {
+        threshold = task->prio;
+    }
 #endif
+    task->preemptThreshold = threshold;
 
+    tTaskExitCritical(status);
+    // 提高阈值后被挡住的任务可能可以运行了
+    if (curTask != (tTask *)0) {
+        tTaskSched();
+    }
 }
+#endif
 
+#if TINYOS_ENABLE_SUSPEND == 1
 /**
  * @brief 挂起任务
  * 
@@ -91,24 +220,39 @@ void tTaskInit(tTask *task, void(*entry)(void *), void * param, uint32_t prio, t
  */
 void tTaskSuspend(tTask * task) {
     uint32_t status = tTaskEnterCritical();
-    
-    // 如果任务没有处于延时状态，则进行挂起
-    if (!(task->state & TINYOS_TASK_STATE_DELAYED)) {
-        // 增加挂起计数
-        if (++task->suspendCount <= 1) {
-            // 设置任务为挂起状态
-            task->state |= TINYOS_TASK_STATE_SUSPEND;
-            // 从就绪队列移除任务
-            tTaskSchedUnRdy(task);
-            // 如果挂起的是当前任务，退出临界区并调度
-            if (task == curTask) {
-                tTaskExitCritical(status);
-                tTaskSched();
-            }
-        }
-    }
-    
+    uint32_t sched = tTaskSuspendLocked(task);
+
     tTaskExitCritical(status);
+    // 如果挂起的是当前任务，退出临界区后调度
+    if (sched) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 挂起任务的公共部分，需在临界区内调用，tTaskGroupSuspend在一个临界区内对多个任务调用
+ * 
+ * @param task 需要挂起的任务控制块。
+ * 
+ * @return uint32_t 1表示挂起的是当前任务，退出临界区后需要调度
+ */
+uint32_t tTaskSuspendLocked(tTask * task) {
+    // 如果任务处于延时或超时等待状态，则不挂起
+    if (task->state & (TINYOS_TASK_STATE_DELAYED | TINYOS_TASK_STATE_TIMEOUT)) {
+        return 0;
+    }
+    // 增加挂起计数，计数为8位，达到上限后不再增加
+    if (task->suspendCount < 0xFF) {
+        task->suspendCount++;
+    }
+    if (task->suspendCount > 1) {
+        return 0;
+    }
+    // 设置任务为挂起状态
+    task->state |= TINYOS_TASK_STATE_SUSPEND;
+    // 从就绪队列移除任务
+    tTaskSchedUnRdy(task);
+    return task == curTask;
 }
 
 /**
@@ -122,24 +266,40 @@ void tTaskSuspend(tTask * task) {
  */
 void tTaskWakeUp(tTask * task) {
     uint32_t status = tTaskEnterCritical();
-    
-    // 如果任务处于挂起状态，则唤醒它
-    if (task->state & TINYOS_TASK_STATE_SUSPEND) {
-        // 减少挂起计数
-        if (--task->suspendCount == 0) {
-            // 清除挂起状态
-            task->state &= ~(TINYOS_TASK_STATE_SUSPEND);
-            // 将任务加入就绪队列
-            tTaskSchedRdy(task);
-            // 退出临界区并调度
-            tTaskExitCritical(status);
-            tTaskSched();
-        }
-    }
-    
+    uint32_t sched = tTaskWakeUpLocked(task);
+
     tTaskExitCritical(status);
+    // 任务重新就绪，退出临界区后调度
+    if (sched) {
+        tTaskSched();
+    }
 }
 
+/**
+ * @brief 唤醒任务的公共部分，需在临界区内调用，tTaskGroupResume在一个临界区内对多个任务调用
+ * 
+ * @param task 需要唤醒的任务控制块。
+ * 
+ * @return uint32_t 1表示任务已重新加入就绪队列，退出临界区后需要调度
+ */
+uint32_t tTaskWakeUpLocked(tTask * task) {
+    // 如果任务不处于挂起状态，则不处理
+    if (!(task->state & TINYOS_TASK_STATE_SUSPEND)) {
+        return 0;
+    }
+    // 减少挂起计数
+    if (--task->suspendCount != 0) {
+        return 0;
+    }
+    // 清除挂起状态
+    task->state &= ~(TINYOS_TASK_STATE_SUSPEND);
+    // 将任务加入就绪队列
+    tTaskSchedRdy(task);
+    return 1;
+}
+#endif
+
+#if TINYOS_ENABLE_TASK_DELETE == 1
 /**
  * @brief 设置任务删除回调函数
  * 
@@ -167,14 +327,38 @@ void tTaskSetCleanCallFunc(tTask * task, void (*clean) (void * param), void * pa
  */
 void tTaskForceDelete(tTask * task) {
     uint32_t status = tTaskEnterCritical();
+    // 处于延时、挂起或等待状态的任务不在就绪队列中
+    uint32_t blocked = task->state & (TINYOS_TASK_STATE_DELAYED | TINYOS_TASK_STATE_SUSPEND
+                                      | TINYOS_TASK_STATE_NOTIFY_WAIT | TINYOS_TASK_STATE_IRQ_WAIT
+                                      | TINYOS_TASK_WAIT_MASK);
     
+    // 正在等待事件的任务需从事件的等待队列中移除，否则其linkNode仍挂在等待队列上
+    if (task->waitEvent) {
+        tEventRemoveTask(task, (void *)0, tErrorDel);
+    }
+
     // 如果任务处于延时状态，则从延时队列中移除
     if (task->state & TINYOS_TASK_STATE_DELAYED) {
         tTimeTaskRemove(task);
-    } else if (!(task->state & TINYOS_TASK_STATE_SUSPEND)) {
-        // 如果任务没有被挂起，则从调度队列中移除
+    } else if (task->state & TINYOS_TASK_STATE_TIMEOUT) {
+        // 等待事件或通知时带有超时，从超时队列中移除
+        tTimeTaskTimeoutCancel(task);
+    }
+    if (!blocked) {
+        // 就绪的任务从调度队列中移除
         tTaskSchedRemove(task);
     }
+    task->state |= TINYOS_TASK_STATE_DESTORYED;
+    tRegistryRemove(&task->object);
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+    tTaskStackMonitorRemove(task);
+#endif
+#if TINYOS_ENABLE_BUDGET == 1
+    tTaskBudgetRemove(task);
+#endif
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    tSupervisorRemove(task);
+#endif
     
     // 执行任务的清理函数
     if (task->clean) {
@@ -239,6 +423,17 @@ void tTaskDeleteSelf(void) {
     
     // 从调度队列中移除当前任务
     tTaskSchedRemove(curTask);
+    curTask->state |= TINYOS_TASK_STATE_DESTORYED;
+    tRegistryRemove(&curTask->object);
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+    tTaskStackMonitorRemove(curTask);
+#endif
+#if TINYOS_ENABLE_BUDGET == 1
+    tTaskBudgetRemove(curTask);
+#endif
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    tSupervisorRemove(curTask);
+#endif
     
     // 执行当前任务的清理函数
     if (curTask->clean) {
@@ -248,7 +443,9 @@ void tTaskDeleteSelf(void) {
     tTaskExitCritical(status);
     tTaskSched();
 }
+#endif
 
+#if TINYOS_ENABLE_TASK_INFO == 1
 /**
  * @brief 查询任务信息
  * 
@@ -263,19 +460,547 @@ void tTaskGetInfo(tTask * task, tTaskInfo * info) {
     uint32_t status = tTaskEnterCritical();
     
     // 获取任务的相关信息
-    info->delayTicks = task->delayTicks;
+    info->delayTicks = tTimeTaskGetDelay(task);
     info->prio = task->prio;
-    info->slice = task->slice;
     info->state = task->state;
+#if TINYOS_ENABLE_SLICE == 1
+    info->slice = task->slice;
+#else
+    info->slice = 0;
+#endif
+#if TINYOS_ENABLE_SUSPEND == 1
     info->suspendCount = task->suspendCount;
+#else
+    info->suspendCount = 0;
+#endif
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+    info->overrunCount = task->overrunCount;
+    info->maxJitterCycles = task->maxJitterCycles;
+#else
+    info->overrunCount = 0;
+    info->maxJitterCycles = 0;
+#endif
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    info->deadlineMissCount = task->deadlineMissCount;
+#endif
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+    // 先将当前任务已运行的时间计入，再读取
+    tTaskRunTimeUpdate();
+    info->runCycles = task->runCycles;
+#endif
+#if TINYOS_ENABLE_WAIT_STAT == 1
+    {
+        uint32_t i;
+        for (i = 0; i < TINYOS_WAIT_REASON_COUNT; i++) {
+            info->waitUs[i] = task->waitUs[i];
+        }
+        info->maxWaitUs = task->maxWaitUs;
+        info->maxWaitReason = task->maxWaitReason;
+    }
+#endif
     
 	  info->stackSize = task->stackSize;
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+	  // 直接使用空闲任务扫描得到的水位
+	  info->stackFree = task->stackFreeWords * sizeof(tTaskStack);
+#elif TINYOS_ENABLE_STACK_FILL == 0
+	  // 栈未填充，无法统计
+	  info->stackFree = 0;
+#else
 	  info->stackFree = 0;
 	  
 	  tTaskStack *stackEnd = task->stackBase;
-	  while((*stackEnd++) == 0 && (stackEnd <= task->stackBase + task->stackSize / sizeof(tTaskStack))) {
+#if TINYOS_ENABLE_STACK_GUARD == 1
+	  // 保护区不可读，按未使用计
+	  while (stackEnd < (tTaskStack *)tTaskStackGuardEnd(task)) {
+			stackEnd++;
+			info->stackFree++;
+		}
+#endif
+	  while((*stackEnd++) == TINYOS_TASK_STACK_FILL && (stackEnd <= task->stackBase + task->stackSize / sizeof(tTaskStack))) {
 			info->stackFree++;
 		}
 	  info->stackFree *= sizeof(tTaskStack);//单位数转化为字节数
+#endif
+    tTaskExitCritical(status);
+}
+#endif
+
+#if TINYOS_ENABLE_WAIT_STAT == 1
+/**
+ * @brief 开始统计一次阻塞，由tTaskSchedUnRdy在临界区内调用
+ * 
+ * 阻塞原因取自任务状态，调用前应已设置好等待的状态位及等待的事件。状态中没有阻塞位(如修改优先级时
+ * 临时移出就绪队列)或已在统计中时不做处理。
+ * 
+ * @param task 离开就绪队列的任务
+ * 
+ * @return void
+ */
+void tTaskWaitStatBegin(tTask * task) {
+    uint32_t state = task->state;
+    uint8_t reason;
+
+    if (task->waitReason != TINYOS_WAIT_REASON_NONE) {
+        return;
+    }
+    task->waitStatEvent = (struct _tEvent *)0;
+    if (state & TINYOS_TASK_WAIT_MASK) {
+        reason = (uint8_t)((state >> 16) & 0xff);
+        if (reason >= TINYOS_WAIT_EVENT_TYPES) {
+            reason = 0;
+        }
+        task->waitStatEvent = task->waitEvent;
+    } else if (state & TINYOS_TASK_STATE_NOTIFY_WAIT) {
+        reason = TINYOS_WAIT_REASON_NOTIFY;
+    } else if (state & TINYOS_TASK_STATE_IRQ_WAIT) {
+        reason = TINYOS_WAIT_REASON_IRQ;
+    } else if (state & TINYOS_TASK_STATE_SUSPEND) {
+        reason = TINYOS_WAIT_REASON_SUSPEND;
+    } else if (state & TINYOS_TASK_STATE_DELAYED) {
+        reason = TINYOS_WAIT_REASON_DELAY;
+    } else {
+        return;
+    }
+    task->waitReason = reason;
+    task->waitStart = tTimeGetMicros();
+}
+
+/**
+ * @brief 结束统计一次阻塞，由tTaskSchedRdy在临界区内调用
+ * 
+ * 阻塞时间计入任务对应原因的累计值；等待的是事件且开启了对象登记表时同时计入该事件。
+ * 
+ * @param task 重新就绪的任务
+ * 
+ * @return void
+ */
+void tTaskWaitStatEnd(tTask * task) {
+    uint64_t us;
+    uint32_t us32;
+    uint8_t reason = task->waitReason;
+
+    if (reason == TINYOS_WAIT_REASON_NONE) {
+        return;
+    }
+    us = tTimeGetMicros() - task->waitStart;
+    us32 = (us > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)us;
+    task->waitReason = TINYOS_WAIT_REASON_NONE;
+
+    task->waitUs[reason] += us;
+    if (us32 > task->maxWaitUs) {
+        task->maxWaitUs = us32;
+        task->maxWaitReason = reason;
+    }
+#if TINYOS_ENABLE_REGISTRY == 1
+    if (task->waitStatEvent) {
+        task->waitStatEvent->stat.waitUs += us;
+        if (us32 > task->waitStatEvent->stat.maxWaitUs) {
+            task->waitStatEvent->stat.maxWaitUs = us32;
+        }
+    }
+#endif
+    task->waitStatEvent = (struct _tEvent *)0;
+}
+
+/**
+ * @brief 清零任务的阻塞时间统计，正在进行的一次阻塞仍从其开始时刻计
+ * 
+ * @param task 任务控制块
+ * 
+ * @return void
+ */
+void tTaskWaitStatReset(tTask * task) {
+    uint32_t i;
+    uint32_t status = tTaskEnterCritical();
+
+    for (i = 0; i < TINYOS_WAIT_REASON_COUNT; i++) {
+        task->waitUs[i] = 0;
+    }
+    task->maxWaitUs = 0;
+    task->maxWaitReason = 0;
+    tTaskExitCritical(status);
+}
+#endif
+
+#if (TINYOS_ENABLE_STACK_CHECK == 1) || (TINYOS_ENABLE_STACK_GUARD == 1)
+/**
+ * @brief 任务栈溢出处理
+ * 
+ * 由PendSV检查到切出任务的栈越界或MemManage异常时调用。栈溢出后被改写的数据不可信，
+ * 调用钩子函数后关中断停机，便于调试器查看溢出的任务。
+ * 
+ * @param task 栈溢出的任务
+ * 
+ * @return void
+ */
+void tTaskStackOverflow(tTask * task) {
+    tHooksRunStackOverflow(task);
+    __disable_irq();
+    for (;;) {
+    }
+}
+#endif
+
+#if TINYOS_ENABLE_BUDGET == 1
+//运行预算：设置了预算的任务挂在同一列表中，节拍中断把这一节拍计入当前任务，
+//预算用完的任务降到TINYOS_BUDGET_BG_PRIO运行，直到下一个周期开始时恢复；
+//降级作为有效基础优先级的一部分，开启互斥量时由tMutexTaskUpdatePrio与继承的优先级一起计算，
+//降级期间锁定、释放互斥量不会恢复原优先级，恢复时也不会覆盖正在继承的优先级
+static tList tTaskBudgetList;
+
+/**
+ * @brief 初始化运行预算列表，由tTinyOSInit调用
+ * 
+ * @return void
+ */
+void tTaskBudgetInit(void) {
+    tListInit(&tTaskBudgetList);
+}
+
+//按budgetExhausted重新计算预算任务的优先级，需在临界区内调用
+static void tTaskBudgetUpdatePrio(tTask * task) {
+#if TINYOS_ENABLE_MUTEX == 1
+    tMutexTaskUpdatePrio(task);
+#else
+    uint32_t prio = (task->budgetExhausted && (task->basePrio < TINYOS_BUDGET_BG_PRIO))
+                    ? TINYOS_BUDGET_BG_PRIO : task->basePrio;
+
+    if (prio == task->prio) {
+        return;
+    }
+    if (task->state == TINYOS_TASK_STATE_RDY) {
+        tTaskSchedUnRdy(task);
+        task->prio = prio;
+        tTaskSchedRdy(task);
+    } else {
+        tEventTaskSetPrio(task, prio);
+    }
+#endif
+}
+
+//移出预算列表，被降级的任务恢复原优先级，需在临界区内调用
+static void tTaskBudgetRemove(tTask * task) {
+    if (task->budgetNode.nextNode != &(task->budgetNode)) {
+        tListRemove(&tTaskBudgetList, &(task->budgetNode));
+        tNodeInit(&(task->budgetNode));
+    }
+    if (task->budgetExhausted) {
+        task->budgetExhausted = 0;
+        tTaskBudgetUpdatePrio(task);
+    }
+    task->budget = 0;
+}
+
+/**
+ * @brief 设置任务的运行预算
+ * 
+ * 任务每period个节拍内最多以原优先级运行budget个节拍，超出后降到TINYOS_BUDGET_BG_PRIO，
+ * 下一个周期开始时恢复。运行时间按节拍中断时正在运行的任务计，精度为一个节拍。
+ * 
+ * @param task 任务控制块。
+ * @param budget 每周期的运行节拍数，0表示取消限制。
+ * @param period 补充周期(节拍)。
+ * 
+ * @return void
+ */
+void tTaskSetBudget(tTask * task, uint32_t budget, uint32_t period) {
+    uint32_t status = tTaskEnterCritical();
+
+    tTaskBudgetRemove(task);
+    if ((budget != 0) && (period != 0)) {
+        task->budget = budget;
+        task->budgetLeft = budget;
+        task->budgetPeriod = period;
+        task->budgetPeriodLeft = period;
+        tListAddLast(&tTaskBudgetList, &(task->budgetNode));
+    }
+
+    tTaskExitCritical(status);
+    if (curTask != (tTask *)0) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 运行预算的节拍处理，在节拍中断的临界区内调用
+ * 
+ * 持有互斥量的任务暂不降级，避免其它任务因等待该互斥量而被拖住，释放后的下一个节拍再降级；
+ * 按ownedMutexCount判断，快速路径获得、尚未挂入持有列表的互斥量同样计入。
+ * 
+ * @return void
+ */
+void tTaskBudgetTick(void) {
+    uint32_t i;
+    uint32_t count = tListCount(&tTaskBudgetList);
+    tNode * node = tListFirst(&tTaskBudgetList);
+
+    for (i = 0; i < count; i++) {
+        tTask * task = tNodeParent(node, tTask, budgetNode);
+        node = tListNext(&tTaskBudgetList, node);
+
+        if ((task == curTask) && (task->state == TINYOS_TASK_STATE_RDY) && !task->budgetExhausted) {
+            if (task->budgetLeft > 0) {
+                task->budgetLeft--;
+            }
+            if ((task->budgetLeft == 0)
+#if TINYOS_ENABLE_MUTEX == 1
+                && (task->ownedMutexCount == 0)
+#endif
+#if TINYOS_ENABLE_MSG_CALL == 1
+                && (tMsgCallTaskPrio(task) == TINYOS_PRIO_COUNT)
+#endif
+                && (task->basePrio < TINYOS_BUDGET_BG_PRIO)) {
+                task->budgetExhausted = 1;
+                tTaskBudgetUpdatePrio(task);
+            }
+        }
+
+        if (--task->budgetPeriodLeft == 0) {
+            task->budgetPeriodLeft = task->budgetPeriod;
+            task->budgetLeft = task->budget;
+            if (task->budgetExhausted) {
+                task->budgetExhausted = 0;
+                // 重新计算而不是直接写回，降级期间锁定的互斥量继承来的优先级仍然保留
+                tTaskBudgetUpdatePrio(task);
+            }
+        }
+    }
+}
+#endif
+
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+//栈水位监视：所有任务挂在同一列表中，空闲任务每次只扫描队首任务的TINYOS_STACK_MONITOR_CHUNK个字，
+//一轮从栈底扫描到已知水位，遇到被改写的字即更新水位，随后轮到下一个任务
+static tList tTaskStackList;
+
+/**
+ * @brief 初始化栈水位监视列表，由tTinyOSInit调用
+ * 
+ * @return void
+ */
+void tTaskStackMonitorInit(void) {
+    tListInit(&tTaskStackList);
+}
+
+//加入监视列表
+static void tTaskStackMonitorAdd(tTask * task) {
+    uint32_t status = tTaskEnterCritical();
+    tListAddLast(&tTaskStackList, &(task->stackMonitorNode));
+    tTaskExitCritical(status);
+}
+
+//移出监视列表，需在临界区内调用
+static void tTaskStackMonitorRemove(tTask * task) {
+    if (task->stackMonitorNode.nextNode != &(task->stackMonitorNode)) {
+        tListRemove(&tTaskStackList, &(task->stackMonitorNode));
+        tNodeInit(&(task->stackMonitorNode));
+    }
+}
+
+/**
+ * @brief 扫描一段任务栈，在空闲任务的每次循环中调用
+ * 
+ * 每次临界区内最多检查TINYOS_STACK_MONITOR_CHUNK个字，中断延迟有固定上限。
+ * 
+ * @return void
+ */
+void tTaskStackMonitorStep(void) {
+    tTask * task;
+    uint32_t end;
+    uint32_t pos;
+    uint32_t status = tTaskEnterCritical();
+
+    if (tListCount(&tTaskStackList) == 0) {
+        tTaskExitCritical(status);
+        return;
+    }
+
+    task = tNodeParent(tListFirst(&tTaskStackList), tTask, stackMonitorNode);
+#if TINYOS_ENABLE_STACK_GUARD == 1
+    // 保护区不可读，跳过
+    pos = (tTaskStackGuardEnd(task) - (uint32_t)task->stackBase) / sizeof(tTaskStack);
+    if (task->stackScanPos < pos) {
+        task->stackScanPos = pos;
+    }
+#endif
+    end = task->stackScanPos + TINYOS_STACK_MONITOR_CHUNK;
+    if (end > task->stackFreeWords) {
+        end = task->stackFreeWords;
+    }
+    for (pos = task->stackScanPos; pos < end; pos++) {
+        if (task->stackBase[pos] != TINYOS_TASK_STACK_FILL) {
+            task->stackFreeWords = pos;
+            break;
+        }
+    }
+
+    if (pos >= task->stackFreeWords) {
+        // 本轮扫描完成，从栈底重新开始并轮到下一个任务
+        task->stackScanPos = 0;
+        tListAddLast(&tTaskStackList, tListRemoveFirst(&tTaskStackList));
+    } else {
+        task->stackScanPos = pos;
+    }
     tTaskExitCritical(status);
 }
+#endif
+
+#if TINYOS_ENABLE_TASK_POOL == 1
+//动态任务池：TCB及两种规格的栈都以空闲链表管理，空闲TCB通过linkNode挂在链表上，
+//空闲栈的第一个字存放下一个空闲栈的地址
+static tTask tTaskPoolTcb[TINYOS_TASK_POOL_COUNT];
+static tTaskStack tTaskPoolSmallStack[TINYOS_TASK_POOL_SMALL_COUNT][TINYOS_TASK_POOL_SMALL_STACK / sizeof(tTaskStack)];
+static tTaskStack tTaskPoolLargeStack[TINYOS_TASK_POOL_LARGE_COUNT][TINYOS_TASK_POOL_LARGE_STACK / sizeof(tTaskStack)];
+static tList tTaskPoolFreeList;
+static tTaskStack * tTaskPoolSmallFree;
+static tTaskStack * tTaskPoolLargeFree;
+//已删除自身、等待回收的任务，其栈在切换出去之前仍在使用，由下一次tTaskCreate回收
+static tList tTaskPoolZombieList;
+
+/**
+ * @brief 初始化动态任务池，由tTinyOSInit调用
+ * 
+ * @return void
+ */
+void tTaskPoolInit(void) {
+    uint32_t i;
+
+    tListInit(&tTaskPoolFreeList);
+    tListInit(&tTaskPoolZombieList);
+    for (i = 0; i < TINYOS_TASK_POOL_COUNT; i++) {
+        tNodeInit(&(tTaskPoolTcb[i].linkNode));
+        tListAddLast(&tTaskPoolFreeList, &(tTaskPoolTcb[i].linkNode));
+    }
+
+    tTaskPoolSmallFree = (tTaskStack *)0;
+    for (i = 0; i < TINYOS_TASK_POOL_SMALL_COUNT; i++) {
+        tTaskPoolSmallStack[i][0] = (tTaskStack)tTaskPoolSmallFree;
+        tTaskPoolSmallFree = tTaskPoolSmallStack[i];
+    }
+    tTaskPoolLargeFree = (tTaskStack *)0;
+    for (i = 0; i < TINYOS_TASK_POOL_LARGE_COUNT; i++) {
+        tTaskPoolLargeStack[i][0] = (tTaskStack)tTaskPoolLargeFree;
+        tTaskPoolLargeFree = tTaskPoolLargeStack[i];
+    }
+}
+
+//判断任务是否来自任务池
+static uint32_t tTaskPoolOwns(tTask * task) {
+    return (task >= &tTaskPoolTcb[0]) && (task < &tTaskPoolTcb[TINYOS_TASK_POOL_COUNT]);
+}
+
+//归还任务的TCB及栈，需在临界区内调用
+static void tTaskPoolRelease(tTask * task) {
+    tTaskStack * stack = task->stackBase;
+
+    if (task->stackSize == TINYOS_TASK_POOL_SMALL_STACK) {
+        stack[0] = (tTaskStack)tTaskPoolSmallFree;
+        tTaskPoolSmallFree = stack;
+    } else {
+        stack[0] = (tTaskStack)tTaskPoolLargeFree;
+        tTaskPoolLargeFree = stack;
+    }
+    tListAddLast(&tTaskPoolFreeList, &(task->linkNode));
+}
+
+/**
+ * @brief 从任务池中创建任务
+ * 
+ * 按stackBytes选择能容纳它的最小规格的栈，两种规格都不够或已用完时创建失败。
+ * 
+ * @param entry 任务的入口函数
+ * @param param 任务的入口函数参数
+ * @param prio 任务的优先级
+ * @param stackBytes 需要的栈字节数
+ * 
+ * @return tTask* 创建的任务，失败时返回0
+ */
+tTask * tTaskCreate(void (*entry)(void *), void * param, uint32_t prio, uint32_t stackBytes) {
+    tNode * node;
+    tTask * task;
+    tTaskStack * stack = (tTaskStack *)0;
+    uint32_t stackSize = 0;
+    uint32_t status = tTaskEnterCritical();
+
+    // 先回收已删除自身的任务，调用者正在运行，这些任务的栈已不再使用
+    while ((node = tListRemoveFirst(&tTaskPoolZombieList)) != (tNode *)0) {
+        tTaskPoolRelease(tNodeParent(node, tTask, linkNode));
+    }
+
+    if (tListCount(&tTaskPoolFreeList) == 0) {
+        tTaskExitCritical(status);
+        return (tTask *)0;
+    }
+    if ((stackBytes <= TINYOS_TASK_POOL_SMALL_STACK) && tTaskPoolSmallFree) {
+        stack = tTaskPoolSmallFree;
+        tTaskPoolSmallFree = (tTaskStack *)stack[0];
+        stackSize = TINYOS_TASK_POOL_SMALL_STACK;
+    } else if ((stackBytes <= TINYOS_TASK_POOL_LARGE_STACK) && tTaskPoolLargeFree) {
+        stack = tTaskPoolLargeFree;
+        tTaskPoolLargeFree = (tTaskStack *)stack[0];
+        stackSize = TINYOS_TASK_POOL_LARGE_STACK;
+    }
+    if (stack == (tTaskStack *)0) {
+        tTaskExitCritical(status);
+        return (tTask *)0;
+    }
+
+    node = tListRemoveFirst(&tTaskPoolFreeList);
+    task = tNodeParent(node, tTask, linkNode);
+    tTaskInit(task, entry, param, prio, stack, stackSize);
+
+    tTaskExitCritical(status);
+    // 在tTinyOSStart之前创建时只加入就绪队列
+    if (curTask != (tTask *)0) {
+        tTaskSched();
+    }
+    return task;
+}
+
+/**
+ * @brief 删除由tTaskCreate创建的任务并回收其TCB及栈
+ * 
+ * 删除其它任务时立即回收；删除自身时先挂入待回收列表，切换出去后由下一次tTaskCreate回收。
+ * 非任务池中的任务按tTaskForceDelete/tTaskDeleteSelf处理，不回收。
+ * 
+ * @param task 任务控制块
+ * 
+ * @return void
+ */
+void tTaskDestroy(tTask * task) {
+    uint32_t status;
+
+    if (task == curTask) {
+        status = tTaskEnterCritical();
+        tTaskSchedRemove(curTask);
+        if (curTask->clean) {
+            curTask->clean(curTask->cleanParam);
+        }
+        curTask->state |= TINYOS_TASK_STATE_DESTORYED;
+        tRegistryRemove(&curTask->object);
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+        tTaskStackMonitorRemove(curTask);
+#endif
+#if TINYOS_ENABLE_BUDGET == 1
+        tTaskBudgetRemove(curTask);
+#endif
+#if TINYOS_ENABLE_SUPERVISOR == 1
+        tSupervisorRemove(curTask);
+#endif
+        if (tTaskPoolOwns(curTask)) {
+            tListAddLast(&tTaskPoolZombieList, &(curTask->linkNode));
+        }
+        tTaskExitCritical(status);
+        tTaskSched();
+        return;
+    }
+
+    tTaskForceDelete(task);
+    if (tTaskPoolOwns(task)) {
+        status = tTaskEnterCritical();
+        tTaskPoolRelease(task);
+        tTaskExitCritical(status);
+    }
+}
+#endif
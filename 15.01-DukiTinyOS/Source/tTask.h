@@ -1,44 +1,184 @@
 #ifndef __TTASK_H
 #define __TTASK_H
+#include "tRegistry.h"
 
 #define TINYOS_TASK_STATE_RDY      0
 #define TINYOS_TASK_STATE_DESTORYED  (1 << 1) //删除状态
 #define TINYOS_TASK_STATE_DELAYED    (1 << 2)
 #define TINYOS_TASK_STATE_SUSPEND    (1 << 3) //挂起状态
+#define TINYOS_TASK_STATE_NOTIFY_WAIT (1 << 4) //等待任务通知
+#define TINYOS_TASK_STATE_TIMEOUT    (1 << 5) //等待事件/通知时处于超时队列中
+#define TINYOS_TASK_STATE_IRQ_WAIT   (1 << 6) //等待中断线程
 #define TINYOS_TASK_WAIT_MASK        (0xff << 16) //事件相关的类型应在高16位
 
+#if TINYOS_ENABLE_WAIT_STAT == 1
+//阻塞时间按原因分类：0 ~ TINYOS_WAIT_EVENT_TYPES-1为等待的事件类型(tEventType)，之后为不经过事件的阻塞
+#define TINYOS_WAIT_EVENT_TYPES      18      //tEventType的个数，tEvent.c中编译时检查
+#define TINYOS_WAIT_REASON_DELAY     (TINYOS_WAIT_EVENT_TYPES + 0)
+#define TINYOS_WAIT_REASON_SUSPEND   (TINYOS_WAIT_EVENT_TYPES + 1)
+#define TINYOS_WAIT_REASON_NOTIFY    (TINYOS_WAIT_EVENT_TYPES + 2)
+#define TINYOS_WAIT_REASON_IRQ       (TINYOS_WAIT_EVENT_TYPES + 3)
+#define TINYOS_WAIT_REASON_COUNT     (TINYOS_WAIT_EVENT_TYPES + 4)
+#define TINYOS_WAIT_REASON_NONE      0xFF    //未在阻塞
+#endif
+
+//任务栈初始化时的填充值，统计栈剩余空间时以仍为该值的字作为未使用
+#define TINYOS_TASK_STACK_FILL_BYTE  0xA5
+#define TINYOS_TASK_STACK_FILL       0xA5A5A5A5
+
+#if TINYOS_ENABLE_STACK_GUARD == 1
+//MPU保护区：栈底向上对齐到32字节处的32字节，任务运行期间连内核也不能读写
+#define TINYOS_STACK_GUARD_SIZE      32
+#define tTaskStackGuardEnd(task)     ((((uint32_t)(task)->stackBase + 31) & ~31u) + TINYOS_STACK_GUARD_SIZE)
+#endif
+
 struct _tEvent;
 typedef uint32_t tTaskStack;
 
+//优先级不超过256级时用8位存放
+#if TINYOS_PRIO_COUNT <= 256
+typedef uint8_t tTaskPrio;
+#else
+typedef uint16_t tTaskPrio;
+#endif
+
+//stack、stackBase分别位于第0、1个字，PendSV按固定偏移访问
+//调度器、节拍处理及PendSV每次都要访问的字段集中放在前面，较少使用的字段放在后面
 typedef struct _tTask {
 	tTaskStack* stack;
 	tTaskStack * stackBase;
-	tTaskStack stackSize;
 	
-	uint32_t delayTicks;//添加软定时器
-	uint32_t prio;//添加优先级字段
-	tNode delayNode; //为了方便加入延时队列
-	uint32_t state;//指示状态
+	tTaskPrio prio;//添加优先级字段
+#if TINYOS_ENABLE_SUSPEND == 1
+	uint8_t suspendCount;//挂起计数器
+#endif
+#if TINYOS_ENABLE_SLICE == 1
+	uint16_t slice;//时间片
+#endif
+	uint32_t state;//指示状态，高16位为等待的事件类型
 	tNode linkNode;
-	uint32_t slice;//时间片
-	uint32_t suspendCount;//挂起计数器
-	
-	//删除部分字段
-	void (*clean) (void * param);
-	void * cleanParam;
+	tNode delayNode; //为了方便加入延时队列，等待超时时用于挂入超时队列(两者互斥)
+	uint32_t delayTicks;//添加软定时器
+#if TINYOS_ENABLE_SLICE == 1
+	uint16_t sliceMax;//时间片长度，0表示不做时间片轮转
+#endif
+#if TINYOS_ENABLE_TASK_DELETE == 1
 	uint8_t requestDeleteFlag;
+#endif
+#if TINYOS_ENABLE_PREEMPT_THRESHOLD == 1
+	tTaskPrio preemptThreshold;//运行时只有优先级高于该值的任务能抢占，等于prio时不起作用
+#endif
 	
 	//事件控制块部分字段
 	struct _tEvent * waitEvent;
 	void * eventMsg;
 	uint32_t waitEventResult;
 	
+	uint32_t stackSize;//字节数
+	
+#if TINYOS_ENABLE_TASK_DELETE == 1
+	//删除部分字段
+	void (*clean) (void * param);
+	void * cleanParam;
+#endif
+	
+#if TINYOS_ENABLE_FLAGGROUP == 1
 	//事件标志组字段
 	uint32_t waitFlagsType;
 	uint32_t eventFlags;
+#endif
 	
+#if TINYOS_ENABLE_EDF == 1
+	uint32_t deadline;//绝对截止时间(节拍)，优先级为TINYOS_EDF_PRIO时按其调度
+#endif
+	
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+	//周期任务统计字段，由tTaskDelayUntil维护
+	uint32_t overrunCount;//错过释放时刻的次数
+	uint32_t maxJitterCycles;//释放时刻到任务实际运行的最大延迟(CPU周期)
+#endif
+	
+#if TINYOS_ENABLE_MUTEX == 1
+	//互斥量优先级继承字段
+	tTaskPrio basePrio;//不含继承的原优先级
+	tList heldMutexList;//当前持有的互斥量，快速路径获得的在出现等待者时才挂入
+	uint32_t ownedMutexCount;//当前持有的互斥量数，含快速路径获得、未挂入持有列表的
+#endif
+
+#if TINYOS_ENABLE_MSG_CALL == 1
+	tList serverChannelList;//作为服务者绑定的同步消息通道，客户的优先级计入继承
+#endif
+
+#if TINYOS_ENABLE_NOTIFY == 1
+	//任务通知字段
+	uint32_t notifyValue;
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+	uint32_t notifyState;//中断中用LDREX/STREX修改，等待->已收到的转换只发生一次，决定由谁入队
+	struct _tTask * isrReadyNext;//待就绪链表中的下一个任务
+#else
+	uint8_t notifyState;
+#endif
+#endif
+
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+	//栈水位监视字段，由空闲任务分段扫描维护
+	tNode stackMonitorNode;
+	uint32_t stackFreeWords;//已知的最大使用深度对应的剩余字数
+	uint32_t stackScanPos;//本轮扫描的下一个位置(字)
+#endif
+
+#if TINYOS_ENABLE_SUPERVISOR == 1
+	//周期任务监督字段
+	tNode superNode;
+	uint32_t superDeadline;//释放后到完成的截止时间(节拍)
+	uint32_t superRelease;//当前周期的释放时刻
+	uint32_t deadlineMissCount;
+	uint8_t superState;
+	uint8_t superCritical;
+	uint8_t superCheckedIn;//本看门狗窗口内是否完成过一个周期
+#endif
+
+#if TINYOS_ENABLE_BUDGET == 1
+	//运行预算字段
+	tNode budgetNode;
+	uint32_t budget;//每周期允许以原优先级运行的节拍数，0表示不限制
+	uint32_t budgetLeft;
+	uint32_t budgetPeriod;
+	uint32_t budgetPeriodLeft;
+	uint8_t budgetExhausted;
+#endif
+
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+	//任务累计运行的CPU周期数
+	uint64_t runCycles;
+#endif
+#if TINYOS_ENABLE_WAIT_STAT == 1
+	//阻塞时间统计，从离开就绪队列到重新就绪，不含就绪后等待调度的时间
+	uint64_t waitStart;//本次阻塞开始的时刻(us)
+	struct _tEvent * waitStatEvent;//本次阻塞等待的事件，不经过事件时为0
+	uint64_t waitUs[TINYOS_WAIT_REASON_COUNT];//各原因累计的阻塞时间(us)
+	uint32_t maxWaitUs;//单次阻塞的最长时间(us)
+	uint8_t maxWaitReason;
+	uint8_t waitReason;//本次阻塞的原因，TINYOS_WAIT_REASON_NONE表示未在阻塞
+#endif
+#if TINYOS_ENABLE_REGISTRY == 1
+	tObject object;//对象登记表结点
+#endif
+
+#if TINYOS_ENABLE_USER_MODE == 1
+	//非特权任务字段
+	uint8_t userMode;//以非特权方式运行
+	uint8_t svcActive;//正在系统调用中，以特权方式运行
+	uint32_t svcPc;//系统调用的返回地址
+	uint32_t svcLr;
+	uint32_t mpuStackRbar;//栈区域
+	uint32_t mpuStackRasr;
+	const struct _tMpuRegion * mpuRegions;//数据区
+	uint32_t mpuRegionCount;
+#endif
 }tTask;
 
+//未编译进的功能对应的字段为0
 typedef struct _tTaskInfo {
 	uint32_t delayTicks;
 	uint32_t prio;
@@ -46,24 +186,82 @@ typedef struct _tTaskInfo {
 	uint32_t slice;
 	uint32_t suspendCount;
 	
-	tTaskStack stackSize;
-	tTaskStack stackFree;
+	uint32_t stackSize;//字节数
+	uint32_t stackFree;//字节数，栈未填充时为0
+	
+	uint32_t overrunCount;
+	uint32_t maxJitterCycles;
+#if TINYOS_ENABLE_SUPERVISOR == 1
+	uint32_t deadlineMissCount;
+#endif
+	
+#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
+	uint64_t runCycles;
+#endif
+#if TINYOS_ENABLE_WAIT_STAT == 1
+	uint64_t waitUs[TINYOS_WAIT_REASON_COUNT];//各原因累计的阻塞时间(us)，正在进行的一次阻塞不计入
+	uint32_t maxWaitUs;
+	uint32_t maxWaitReason;
+#endif
 }tTaskInfo;
 
-void tTaskInit(tTask *tTask, void(*entry)(void *), void * param, uint32_t prio, tTaskStack * stack, tTaskStack stackSize);
+void tTaskInit(tTask *tTask, void(*entry)(void *), void * param, uint32_t prio, tTaskStack * stack, uint32_t stackSize);
+#if TINYOS_ENABLE_SLICE == 1
+void tTaskSetSlice(tTask * task, uint32_t slice);
+#endif
+#if TINYOS_ENABLE_PREEMPT_THRESHOLD == 1
+void tTaskSetPreemptThreshold(tTask * task, uint32_t threshold);
+#endif
 
+#if TINYOS_ENABLE_SUSPEND == 1
 //挂起函数
 void tTaskSuspend(tTask * task) ;
 void tTaskWakeUp(tTask * task) ;
+uint32_t tTaskSuspendLocked(tTask * task);//需在临界区内调用，返回1表示需要调度
+uint32_t tTaskWakeUpLocked(tTask * task);
+#endif
+#if TINYOS_ENABLE_TASK_DELETE == 1
 //删除函数
 void tTaskSetCleanCallFunc(tTask * task, void (*clean) (void * param), void * param);
 void tTaskForceDelete(tTask * task);
 void tTaskRequestDelete(tTask * task);
 uint8_t tTaskIsRequestedDeleted(void);
 void tTaskDeleteSelf(void);
+#endif
+#if TINYOS_ENABLE_TASK_INFO == 1
 //任务状态查询
 void tTaskGetInfo(tTask * task,tTaskInfo * info);
 #endif
+#if TINYOS_ENABLE_WAIT_STAT == 1
+//阻塞时间统计
+void tTaskWaitStatReset(tTask * task);
+#endif
+
+#if (TINYOS_ENABLE_STACK_CHECK == 1) || (TINYOS_ENABLE_STACK_GUARD == 1)
+//栈溢出处理，不返回
+void tTaskStackOverflow(tTask * task);
+#endif
+
+#if TINYOS_ENABLE_BUDGET == 1
+//运行预算
+void tTaskBudgetInit(void);
+void tTaskSetBudget(tTask * task, uint32_t budget, uint32_t period);
+void tTaskBudgetTick(void);
+#endif
+
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+//栈水位监视
+void tTaskStackMonitorInit(void);
+void tTaskStackMonitorStep(void);
+#endif
+
+#if TINYOS_ENABLE_TASK_POOL == 1
+//动态任务池
+void tTaskPoolInit(void);
+tTask * tTaskCreate(void (*entry)(void *), void * param, uint32_t prio, uint32_t stackBytes);
+void tTaskDestroy(tTask * task);
+#endif
+#endif
 
 
 
@@ -0,0 +1,178 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_TASK_GROUP == 1
+
+/**
+ * @brief 初始化任务组
+ * 
+ * @param group 任务组
+ * @param buffer 成员表，至少maxCount项
+ * @param maxCount 最多的成员数
+ * 
+ * @return void
+ */
+void tTaskGroupInit(tTaskGroup * group, tTask ** buffer, uint32_t maxCount) {
+	group->tasks = buffer;
+	group->count = 0;
+	group->maxCount = maxCount;
+}
+
+/**
+ * @brief 把任务加入任务组，不改变任务的状态
+ * 
+ * @param group 任务组
+ * @param task 任务
+ * 
+ * @return uint32_t tErrorNoError，tErrorResourceFull成员表已满，tErrorParam已是成员
+ */
+uint32_t tTaskGroupAdd(tTaskGroup * group, tTask * task) {
+	uint32_t err = tErrorNoError;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		if (group->tasks[i] == task) {
+			err = tErrorParam;
+			break;
+		}
+	}
+	if (err == tErrorNoError) {
+		if (group->count < group->maxCount) {
+			group->tasks[group->count++] = task;
+		} else {
+			err = tErrorResourceFull;
+		}
+	}
+
+	tTaskExitCritical(status);
+	return err;
+}
+
+/**
+ * @brief 把任务移出任务组，不改变任务的状态，组挂起期间移出的任务需另行用tTaskWakeUp恢复
+ * 
+ * @param group 任务组
+ * @param task 任务
+ * 
+ * @return uint32_t tErrorNoError，tErrorParam不是成员
+ */
+uint32_t tTaskGroupRemove(tTaskGroup * group, tTask * task) {
+	uint32_t err = tErrorParam;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		if (group->tasks[i] == task) {
+			// 用最后一个成员填补空位，成员顺序不影响组操作的结果
+			group->tasks[i] = group->tasks[--group->count];
+			err = tErrorNoError;
+			break;
+		}
+	}
+
+	tTaskExitCritical(status);
+	return err;
+}
+
+/**
+ * @brief 在一个临界区内挂起全组任务，最后最多调度一次
+ * 
+ * 每个成员与tTaskSuspend相同：延时或超时等待中的任务不挂起，其余挂起计数加1。
+ * 调用者自己在组内时，其余成员都挂起之后才切换出去。
+ * 
+ * @param group 任务组
+ * 
+ * @return void
+ */
+void tTaskGroupSuspend(tTaskGroup * group) {
+	uint32_t sched = 0;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		sched |= tTaskSuspendLocked(group->tasks[i]);
+	}
+
+	tTaskExitCritical(status);
+	if (sched) {
+		tTaskSched();
+	}
+}
+
+/**
+ * @brief 在一个临界区内恢复全组任务，全部加入就绪表后调度一次，由优先级最高的成员先运行
+ * 
+ * 每个成员与tTaskWakeUp相同：挂起计数减1，减到0时就绪。
+ * 
+ * @param group 任务组
+ * 
+ * @return void
+ */
+void tTaskGroupResume(tTaskGroup * group) {
+	uint32_t sched = 0;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		sched |= tTaskWakeUpLocked(group->tasks[i]);
+	}
+
+	tTaskExitCritical(status);
+	if (sched) {
+		tTaskSched();
+	}
+}
+
+#if TINYOS_ENABLE_NOTIFY == 1
+/**
+ * @brief 向全组任务发送同一个通知，所有等待中的成员在同一临界区内就绪，最后最多调度一次
+ * 
+ * @param group 任务组
+ * @param value 通知值，其含义由action决定
+ * @param action 对各成员通知值的操作
+ * 
+ * @return void
+ */
+void tTaskGroupNotify(tTaskGroup * group, uint32_t value, tNotifyAction action) {
+	uint32_t sched = 0;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		sched |= tTaskNotifyPost(group->tasks[i], value, action);
+	}
+
+	tTaskExitCritical(status);
+	if (sched) {
+		tTaskSched();
+	}
+}
+
+/**
+ * @brief 在中断服务函数中向全组任务发送通知，唤醒任务后只标记需要调度，由tIntExit统一触发
+ * 
+ * 开启TINYOS_ENABLE_ISR_READY_QUEUE时同样在临界区内完成，不经过待就绪链表。
+ * 
+ * @param group 任务组
+ * @param value 通知值，其含义由action决定
+ * @param action 对各成员通知值的操作
+ * 
+ * @return void
+ */
+void tTaskGroupNotifyFromISR(tTaskGroup * group, uint32_t value, tNotifyAction action) {
+	uint32_t sched = 0;
+	uint32_t i;
+	uint32_t status = tTaskEnterCritical();
+
+	for (i = 0; i < group->count; i++) {
+		sched |= tTaskNotifyPost(group->tasks[i], value, action);
+	}
+
+	tTaskExitCritical(status);
+	if (sched) {
+		tTaskSchedFromISR();
+	}
+}
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __TTASKGROUP_H
+#define __TTASKGROUP_H
+
+#include "tTask.h"
+#include "tNotify.h"
+
+// 任务组：把解锁/上锁等模式切换时要一起挂起、恢复或通知的任务(日志、遥测、电机输出等)登记在一起，
+// 对全组的操作在一个临界区内完成，就绪表及位图一次改完，最后最多调度一次：
+// 其它任务看不到只切换了一半的组，高优先级成员也不会在其余成员处理完之前抢先运行
+// 成员表由调用者提供，与邮箱的缓冲区相同；一个任务可以属于多个组，挂起计数照常累加
+typedef struct _tTaskGroup {
+	tTask ** tasks;                  //成员表，前count项有效
+	uint32_t count;
+	uint32_t maxCount;
+}tTaskGroup;
+
+void tTaskGroupInit(tTaskGroup * group, tTask ** buffer, uint32_t maxCount);
+uint32_t tTaskGroupAdd(tTaskGroup * group, tTask * task);
+uint32_t tTaskGroupRemove(tTaskGroup * group, tTask * task);
+void tTaskGroupSuspend(tTaskGroup * group);
+void tTaskGroupResume(tTaskGroup * group);
+#if TINYOS_ENABLE_NOTIFY == 1
+void tTaskGroupNotify(tTaskGroup * group, uint32_t value, tNotifyAction action);
+void tTaskGroupNotifyFromISR(tTaskGroup * group, uint32_t value, tNotifyAction action);
+#endif
+#endif
@@ -25,3 +25,61 @@ void tTaskDelay(uint32_t delay) {
     // 调用任务调度器，检查是否需要切换任务
     tTaskSched();
 }
+
+/**
+ * @brief 周期任务延时函数，使当前任务在绝对的节拍边界上周期性地释放。
+ * 
+ * 与tTaskDelay不同，下一次释放时刻由上一次的释放时刻加周期得到，任务本身的执行时间不会累积到周期中。
+ * 若本周期的释放时刻已经错过，则记录一次超时，不再延时，并将释放时刻对齐到已经过去的最近一个周期边界，
+ * 保持原有的相位。每次释放后统计从释放时刻到任务实际恢复运行的延迟。
+ * 
+ * @param lastWakeTick 上一次的释放时刻，首次调用前应初始化为tTaskTickGet()，由本函数更新。
+ * @param period 周期，单位为时钟滴答（ticks）。
+ * 
+ * @return uint32_t tErrorNoError表示按时释放，tErrorTimeOut表示错过了释放时刻。
+ */
+uint32_t tTaskDelayUntil(uint32_t * lastWakeTick, uint32_t period) {
+    uint32_t elapsed;
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+    uint32_t jitter;
+#endif
+    uint32_t status = tTaskEnterCritical();
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    uint32_t release = *lastWakeTick;
+#endif
+
+    elapsed = tTaskTickGet() - *lastWakeTick;
+    if (elapsed >= period) {
+        // 已经错过了释放时刻，跳过错过的周期
+        *lastWakeTick += (elapsed / period) * period;
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+        curTask->overrunCount++;
+#endif
+#if TINYOS_ENABLE_SUPERVISOR == 1
+        tSupervisorComplete(curTask, release, *lastWakeTick);
+#endif
+        tTaskExitCritical(status);
+        return tErrorTimeOut;
+    }
+
+    *lastWakeTick += period;
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    tSupervisorComplete(curTask, release, *lastWakeTick);
+#endif
+    tTimeTaskWait(curTask, period - elapsed);
+    tTaskSchedUnRdy(curTask);
+    tTaskExitCritical(status);
+
+    tTaskSched();
+
+#if TINYOS_ENABLE_PERIOD_STAT == 1
+    // 释放时刻位于节拍边界，延迟为经过的整节拍数加本节拍内已经过的周期数
+    status = tTaskEnterCritical();
+    jitter = tSysTickCyclesSince(*lastWakeTick);
+    if (jitter > curTask->maxJitterCycles) {
+        curTask->maxJitterCycles = jitter;
+    }
+    tTaskExitCritical(status);
+#endif
+    return tErrorNoError;
+}
@@ -3,11 +3,61 @@
 #if TINYOS_ENABLE_TIMER == 1
 
 static tList tTimerHardList;
-static tList tTimerSoftList;
-static tSem tTimerProtectSem;
-static tSem tTimerTickSem;
+static tList tTimerGroupList;           // 所有的定时器组，节拍处理时逐组检查队首
+static tTimerGroup tTimerDefaultGroup;
 
-void tTimerInit (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks,
+// 定时队列按到期时刻从早到晚排序，节拍处理只需检查队首，不再逐个递减计数
+// 用差值比较，节拍计数回绕后仍然正确
+// 允许偏差的定时器若在[baseTick, baseTick + slackTicks]内已有其它定时器到期，则与其对齐在同一节拍触发
+static void tTimerListInsert (tList * timerList, tTimer * timer)
+{
+	tNode * node;
+	tNode * preNode = &(timerList->headNode);
+	
+	timer->expireTick = timer->baseTick;
+	if (timer->slackTicks > 0)
+	{
+		for (node = timerList->headNode.nextNode; node != &(timerList->headNode); node = node->nextNode)
+		{
+			tTimer * t = tNodeParent(node, tTimer, linkNode);
+			int32_t diff = (int32_t)(t->expireTick - timer->baseTick);
+			if (diff > (int32_t)timer->slackTicks)
+			{
+				break;
+			}
+			if (diff >= 0)
+			{
+				timer->expireTick = t->expireTick;
+				break;
+			}
+		}
+	}
+	
+	for (node = timerList->headNode.nextNode; node != &(timerList->headNode); node = node->nextNode)
+	{
+		tTimer * t = tNodeParent(node, tTimer, linkNode);
+		if ((int32_t)(t->expireTick - timer->expireTick) > 0)
+		{
+			break;
+		}
+		preNode = node;
+	}
+	tListInsertAfter(timerList, preNode, &timer->linkNode);
+}
+
+#if TINYOS_TIMER_POOL_SIZE > 0
+static tTimer tTimerPool[TINYOS_TIMER_POOL_SIZE];
+static tList tTimerPoolList;            // 空闲的池定时器，借用linkNode
+
+// 把池定时器放回空闲队列，需在临界区内调用；不在登记表中，不需要移除
+static void tTimerPoolFree (tTimer * timer)
+{
+	timer->state = tTimerDestroyed;
+	tListAddLast(&tTimerPoolList, &timer->linkNode);
+}
+#endif
+
+static void tTimerSetup (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks,
 		void (*timerFunc) (void * arg), void * arg, uint32_t config)
 {
 	tNodeInit(&timer->linkNode);
@@ -16,17 +66,57 @@ void tTimerInit (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks,
 	timer->timerFunc = timerFunc;
 	timer->arg = arg;
 	timer->config = config;
+	timer->group = &tTimerDefaultGroup;
+	timer->baseTick = 0;
+	timer->expireTick = 0;
+	timer->slackTicks = 0;
 	
-	if (delayTicks == 0)
+	timer->state = tTimerCreated;
+}
+
+void tTimerInit (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks,
+		void (*timerFunc) (void * arg), void * arg, uint32_t config)
+{
+	tTimerSetup(timer, delayTicks, durationTicks, timerFunc, arg, config);
+	tRegistryAdd(&timer->object, tObjectTypeTimer);
+}
+
+// 初始化允许偏差的定时器，每次到期可以在计划时刻之后slackTicks个节拍内的任意时刻触发，
+// 以便与其它定时器合并到同一节拍，减少定时器任务及低功耗模式下CPU的唤醒次数
+void tTimerInitWithSlack (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks, uint32_t slackTicks,
+		void (*timerFunc) (void * arg), void * arg, uint32_t config)
+{
+	tTimerInit(timer, delayTicks, durationTicks, timerFunc, arg, config);
+	timer->slackTicks = slackTicks;
+}
+
+// 指定软定时器所在的组，需在启动前调用；group为0时回到默认组
+void tTimerSetGroup (tTimer * timer, tTimerGroup * group)
+{
+	if ((timer->state == tTimerCreated) || (timer->state == tTimerStopped))
+	{
+		timer->group = group ? group : &tTimerDefaultGroup;
+	}
+}
+
+// 获取组的软定时器队列锁；定时器任务执行回调期间已持有本组的protectSem，
+// 回调中启动、停止本组的定时器时不再等待，否则定时器任务会一直等待自己，返回是否需要释放
+static uint32_t tTimerGroupLock (tTimerGroup * group)
+{
+	if (curTask == &group->task)
 	{
-		timer->delayTicks = durationTicks;
+		return 0;
 	}
-	else
+	tSemWait(&group->protectSem, 0);
+	return 1;
+}
+
+static void tTimerGroupUnlock (tTimerGroup * group, uint32_t locked)
+{
+	if (locked)
 	{
-		timer->delayTicks = timer->startDelayTicks;
+		tSemNotify(&group->protectSem);
 	}
-	
-	timer->state = tTimerCreated;
 }
 
 void tTimerStart (tTimer * timer)
@@ -35,22 +125,31 @@ void tTimerStart (tTimer * timer)
 	{
 		case tTimerCreated:
 		case tTimerStopped:
-			timer->delayTicks = timer->startDelayTicks ? timer->startDelayTicks : timer->durationTicks;
+		{
+			uint32_t status;
+			uint32_t delayTicks = timer->startDelayTicks ? timer->startDelayTicks : timer->durationTicks;
 			timer->state = tTimerStarted;
 		
 			if (timer->config & TIMER_CONFIG_TYPE_HARD)
 			{
-				uint32_t status = tTaskEnterCritical();
-				tListAddFirst(&tTimerHardList, &timer->linkNode);
+				status = tTaskEnterCritical();
+				timer->baseTick = tTaskTickGet() + delayTicks;
+				tTimerListInsert(&tTimerHardList, timer);
 				tTaskExitCritical(status);
 			}
 			else
 			{
-				tSemWait(&tTimerProtectSem, 0);
-				tListAddLast(&tTimerSoftList, &timer->linkNode);
-				tSemNotify(&tTimerProtectSem);
+				// 软定时器队列由定时器任务处理，节拍中断也会读取队首，修改时同样需要屏蔽中断
+				tTimerGroup * group = timer->group;
+				uint32_t locked = tTimerGroupLock(group);
+				status = tTaskEnterCritical();
+				timer->baseTick = tTaskTickGet() + delayTicks;
+				tTimerListInsert(&group->softList, timer);
+				tTaskExitCritical(status);
+				tTimerGroupUnlock(group, locked);
 			}
 			break;
+		}
 		default:
 		
 			break;
@@ -63,9 +162,11 @@ void tTimerStop (tTimer * timer)
 	{
 		case tTimerStarted:
 		case tTimerRunning:
+		{
+			uint32_t status;
 			if (timer->config & TIMER_CONFIG_TYPE_HARD)
 			{
-				uint32_t status = tTaskEnterCritical();
+				status = tTaskEnterCritical();
 				
 				tListRemove(&tTimerHardList, &timer->linkNode);
 				
@@ -73,76 +174,197 @@ void tTimerStop (tTimer * timer)
 			}
 			else
 			{
-				tSemWait(&tTimerProtectSem, 0);
-				tListRemove(&tTimerSoftList, &timer->linkNode);
-				tSemNotify(&tTimerProtectSem);
+				tTimerGroup * group = timer->group;
+				uint32_t locked = tTimerGroupLock(group);
+				status = tTaskEnterCritical();
+				tListRemove(&group->softList, &timer->linkNode);
+				tTaskExitCritical(status);
+				tTimerGroupUnlock(group, locked);
 			}
+			timer->state = tTimerStopped;
 			break;
+		}
 		default:
 			break;
 	}
 }
 
-static void tTimerCallFuncList (tList * timerList)
+// 依次处理队首所有已到期的定时器，需在临界区内调用，回调执行期间不持有临界区
+// 周期定时器在计划的到期时刻(而非对齐后实际触发的时刻)上加周期后重新插入，处理推迟时不会累积误差；
+// 若已错过了若干个周期，则跳过这些周期，保持原有的相位
+static uint32_t tTimerCallFuncList (tList * timerList, uint32_t status)
 {
 	tNode * node;
-	for (node = timerList->headNode.nextNode; node != &(timerList->headNode); node = node->nextNode)
+	uint32_t now = tTaskTickGet();
+	while ((node = tListFirst(timerList)) != (tNode *)0)
 	{
 		tTimer * timer = tNodeParent(node, tTimer, linkNode);
-		if ((timer->delayTicks == 0) || (--timer->delayTicks == 0))
+		if ((int32_t)(now - timer->expireTick) < 0)
 		{
-			timer->state = tTimerRunning;
-			timer->timerFunc(timer->arg);
-			timer->state = tTimerStarted;
-			
-			if (timer->durationTicks > 0)
-			{
-				timer->delayTicks = timer->durationTicks;
-			}
-			else
+			break;
+		}
+		
+		tListRemove(timerList, node);
+		if (timer->durationTicks > 0)
+		{
+			timer->baseTick += timer->durationTicks;
+			if ((int32_t)(now - timer->baseTick) >= 0)
 			{
-				tListRemove(timerList, &timer->linkNode);
-				timer->state = tTimerStopped;
+				timer->baseTick += ((now - timer->baseTick) / timer->durationTicks + 1) * timer->durationTicks;
 			}
+			tTimerListInsert(timerList, timer);
+			timer->state = tTimerRunning;
+		}
+		else
+		{
+			// 单次定时器已经移出队列，回调中可以重新启动它；软定时器的回调在定时器任务中执行，
+			// 启动本组的定时器时不再获取定时器任务已持有的protectSem，见tTimerGroupLock
+			timer->state = tTimerStopped;
+		}
+		
+		tTaskExitCritical(status);
+		tTraceRecord(tTraceEventTimerFire, timer, 0);
+		timer->timerFunc(timer->arg);
+		status = tTaskEnterCritical();
+		if (timer->state == tTimerRunning)
+		{
+			timer->state = tTimerStarted;
+		}
+#if TINYOS_TIMER_POOL_SIZE > 0
+		else if ((timer->config & TIMER_CONFIG_POOL) && (timer->state == tTimerStopped))
+		{
+			// 回调中没有重新启动的池定时器触发后自动归还
+			tTimerPoolFree(timer);
+		}
+#endif
+	}
+	return status;
+}
+
+#if TINYOS_ENABLE_TICKLESS == 1
+static uint32_t tTimerListNextTicks (tList * timerList, uint32_t ticks)
+{
+	tNode * node = tListFirst(timerList);
+	if (node != (tNode *)0)
+	{
+		tTimer * timer = tNodeParent(node, tTimer, linkNode);
+		int32_t left = (int32_t)(timer->expireTick - tTaskTickGet());
+		if (left < 0)
+		{
+			left = 0;
+		}
+		if ((uint32_t)left < ticks)
+		{
+			ticks = (uint32_t)left;
 		}
 	}
+	return ticks;
+}
+
+// 获取硬定时器及各组软定时器中最近一次到期还需的节拍数，没有运行的定时器时返回0xFFFFFFFF
+uint32_t tTimerModuleNextTicks (void)
+{
+	tNode * node;
+	uint32_t ticks = tTimerListNextTicks(&tTimerHardList, 0xFFFFFFFF);
+	for (node = tTimerGroupList.headNode.nextNode; node != &(tTimerGroupList.headNode); node = node->nextNode)
+	{
+		ticks = tTimerListNextTicks(&(tNodeParent(node, tTimerGroup, linkNode))->softList, ticks);
+	}
+	return ticks;
 }
+#endif
 
-static tTask tTimeTask;
 static tTaskStack tTimerTaskStack[TINYOS_TIMERTASK_STACK_SIZE];
 
 static void tTimerSoftTask (void * param)
 {
+	tTimerGroup * group = (tTimerGroup *)param;
+	uint32_t status;
 	for (;;)
 	{
-		tSemWait(&tTimerTickSem, 0);
+		tSemWait(&group->tickSem, 0);
 		
-		tSemWait(&tTimerProtectSem, 0);
+		tSemWait(&group->protectSem, 0);
 		
-		tTimerCallFuncList(&tTimerSoftList);
+		status = tTaskEnterCritical();
+		status = tTimerCallFuncList(&group->softList, status);
+		tTaskExitCritical(status);
 		
-		tSemNotify(&tTimerProtectSem);
+		tSemNotify(&group->protectSem);
 		
 	}
 }
 
+// 初始化定时器组的队列及信号量并加入定时器组队列
+static void tTimerGroupSetup (tTimerGroup * group)
+{
+	uint32_t status;
+	tListInit(&group->softList);
+	tSemInit(&group->protectSem, 1, 1);
+	// 最大计数为1，定时器任务处理之前的多次唤醒合并为一次
+	tSemInit(&group->tickSem, 0, 1);
+	tNodeInit(&group->linkNode);
+	status = tTaskEnterCritical();
+	tListAddLast(&tTimerGroupList, &group->linkNode);
+	tTaskExitCritical(status);
+}
+
 void tTimerModuleTickNotify (void)
 {
+	tNode * node;
+	tNode * group;
 	uint32_t status = tTaskEnterCritical();
+#if TINYOS_ENABLE_PROFILING == 1
+	uint32_t profileStart = tCycleCounterGet();
+#endif
 	
-	tTimerCallFuncList(&tTimerHardList);
+	status = tTimerCallFuncList(&tTimerHardList, status);
 	
+#if TINYOS_ENABLE_PROFILING == 1
+	tProfileRecord(tProfilePathTimerTick, tCycleCounterGet() - profileStart);
+#endif
 	tTaskExitCritical(status);
 	
-	tSemNotify(&tTimerTickSem);
+	// 只有软定时器队首已经到期时才唤醒该组的定时器任务，同一节拍内到期的多个定时器由它一次处理完
+	// 定时器组创建后不会移除，遍历组队列不需要一直屏蔽中断
+	for (group = tTimerGroupList.headNode.nextNode; group != &(tTimerGroupList.headNode); group = group->nextNode)
+	{
+		tTimerGroup * timerGroup = tNodeParent(group, tTimerGroup, linkNode);
+		uint32_t wakeSoftTask = 0;
+		
+		status = tTaskEnterCritical();
+		if ((node = tListFirst(&timerGroup->softList)) != (tNode *)0)
+		{
+			tTimer * timer = tNodeParent(node, tTimer, linkNode);
+			wakeSoftTask = ((int32_t)(tTaskTickGet() - timer->expireTick) >= 0);
+		}
+		tTaskExitCritical(status);
+		
+		if (wakeSoftTask)
+		{
+			tSemNotify(&timerGroup->tickSem);
+		}
+	}
 }
 
 void tTimerModuleInit (void)
 {
 	tListInit(&tTimerHardList);
-	tListInit(&tTimerSoftList);
-	tSemInit(&tTimerProtectSem, 1, 1);
-	tSemInit(&tTimerTickSem, 0, 0);
+	tListInit(&tTimerGroupList);
+#if TINYOS_TIMER_POOL_SIZE > 0
+	{
+		uint32_t i;
+		tListInit(&tTimerPoolList);
+		for (i = 0; i < TINYOS_TIMER_POOL_SIZE; i++)
+		{
+			tNodeInit(&tTimerPool[i].linkNode);
+			tTimerPoolFree(&tTimerPool[i]);
+		}
+	}
+#endif
+	tTimerGroupSetup(&tTimerDefaultGroup);
+	tObjectSetName(&tTimerDefaultGroup.protectSem.event.object, "timer.lock");
+	tObjectSetName(&tTimerDefaultGroup.tickSem.event.object, "timer.tick");
 }
 
 //负责对定时器任务进行初始化
@@ -151,15 +373,94 @@ void tTimerInitTask(void)
 	#if TINYOS_TIMERTASK_PRIO >= (TINYOS_PRIO_COUNT - 1)
 		#error "The proprity of timer tasker must be greater then (TINYOS_PRO_COUNT - 1)"
 	#endif
-		tTaskInit(&tTimeTask, tTimerSoftTask, (void *)0, TINYOS_TIMERTASK_PRIO, tTimerTaskStack,TINYOS_TIMERTASK_STACK_SIZE);
+		tTaskInit(&tTimerDefaultGroup.task, tTimerSoftTask, &tTimerDefaultGroup, TINYOS_TIMERTASK_PRIO, tTimerTaskStack,sizeof(tTimerTaskStack));
+		tObjectSetName(&tTimerDefaultGroup.task.object, "timer");
+}
+
+/**
+ * @brief 创建一个定时器组及其定时器任务。
+ * 
+ * 在tTimerModuleInit之后调用，之后可用tTimerSetGroup把软定时器放入该组。
+ * 
+ * @param group       定时器组。
+ * @param prio        本组定时器任务的优先级，回调在该优先级下执行。
+ * @param stack       定时器任务的栈，按本组回调的需要确定大小。
+ * @param stackSize   栈的字节数。
+ * @param name        定时器任务的名称，可为0。
+ * 
+ * @return void
+ */
+void tTimerGroupInit (tTimerGroup * group, uint32_t prio, tTaskStack * stack, uint32_t stackSize, const char * name)
+{
+	tTimerGroupSetup(group);
+	tTaskInit(&group->task, tTimerSoftTask, group, prio, stack, stackSize);
+	if (name)
+	{
+		tObjectSetName(&group->task.object, name);
+	}
 }
 
 void tTimerDestroy (tTimer * timer)
 {
     tTimerStop(timer);
+#if TINYOS_TIMER_POOL_SIZE > 0
+    if (timer->config & TIMER_CONFIG_POOL)
+    {
+        // 触发前取消的池定时器，归还到定时器池；已触发并回收的不重复归还
+        uint32_t status = tTaskEnterCritical();
+        if (timer->state != tTimerDestroyed)
+        {
+            tTimerPoolFree(timer);
+        }
+        tTaskExitCritical(status);
+        return;
+    }
+#endif
     timer->state = tTimerDestroyed;
+    tRegistryRemove(&timer->object);
+}
+
+#if TINYOS_TIMER_POOL_SIZE > 0
+/**
+ * @brief 从定时器池中取出一个单次软定时器并启动，触发后自动归还。
+ * 
+ * 用于协议重试、按键消抖等大量短时的超时，不需要为每个超时静态定义定时器。
+ * 回调返回后定时器即被回收，此后不能再使用返回的指针；需要在触发前取消时调用tTimerDestroy，
+ * 取消与触发可能同时发生时应由回调的参数判断超时是否仍然有效。回调中可以再次tTimerStart它，此时不会回收。
+ * 
+ * @param ticks       延时的节拍数，为0时按1个节拍。
+ * @param timerFunc   定时回调函数，在默认组的定时器任务中执行。
+ * @param arg         传给回调函数的参数。
+ * 
+ * @return tTimer *   启动的定时器，定时器池已空时返回0。
+ */
+tTimer * tTimerCreateOneShot (uint32_t ticks, void (*timerFunc) (void * arg), void * arg)
+{
+    tTimer * timer = (tTimer *)0;
+    tNode * node;
+    uint32_t status = tTaskEnterCritical();
+
+    if ((node = tListRemoveFirst(&tTimerPoolList)) != (tNode *)0)
+    {
+        timer = tNodeParent(node, tTimer, linkNode);
+    }
+    tTaskExitCritical(status);
+
+    if (timer)
+    {
+        tTimerSetup(timer, ticks ? ticks : 1, 0, timerFunc, arg, TIMER_CONFIG_TYPE_SOFT | TIMER_CONFIG_POOL);
+        tTimerStart(timer);
+    }
+    return timer;
 }
 
+// 获取定时器池中空闲的定时器数
+uint32_t tTimerPoolFreeCount (void)
+{
+    return tListCount(&tTimerPoolList);
+}
+#endif
+
 void tTimerGetInfo (tTimer * timer, tTimerInfo * info)
 {
     uint32_t status = tTaskEnterCritical();
@@ -169,6 +470,7 @@ void tTimerGetInfo (tTimer * timer, tTimerInfo * info)
     info->timerFunc = timer->timerFunc;
     info->arg = timer->arg;
     info->config = timer->config;
+    info->slackTicks = timer->slackTicks;
     info->state = timer->state;
 
     tTaskExitCritical(status);
@@ -2,6 +2,8 @@
 #define	TTIMER_H
 
 #include "tEvent.h"
+#include "tSem.h"
+#include "tTask.h"
 
 typedef enum _tTimerState
 {
@@ -12,17 +14,35 @@ typedef enum _tTimerState
 	tTimerDestroyed
 }tTimerState;
 
+// 定时器组：每组有独立的软定时器队列、保护信号量及定时器任务，组间互不阻塞；
+// 耗时的后台回调放在低优先级的组中，不会推迟高优先级组中对延迟敏感的回调。
+// 未指定组的软定时器在默认组中执行，其任务优先级为TINYOS_TIMERTASK_PRIO
+typedef struct _tTimerGroup
+{
+	tNode linkNode;                 // 定时器组队列结点
+	tList softList;                 // 本组的软定时器队列，按到期时刻排序
+	tSem protectSem;                // 保护软定时器队列
+	tSem tickSem;                   // 队首到期时唤醒本组的定时器任务
+	tTask task;
+}tTimerGroup;
+
 typedef struct _tTimer
 {
 	tNode linkNode;
 	uint32_t startDelayTicks;
 	uint32_t durationTicks;
-	uint32_t delayTicks;
+	uint32_t baseTick;              // 计划的到期时刻(节拍)
+	uint32_t expireTick;            // 实际到期的时刻，允许偏差时可能晚于baseTick
+	uint32_t slackTicks;            // 允许推迟触发的节拍数
 	void (*timerFunc) (void * arg);
 	void * arg;
 	uint32_t config;
+	tTimerGroup * group;            // 软定时器所在的组
 	
 	tTimerState state;
+#if TINYOS_ENABLE_REGISTRY == 1
+	tObject object;                 // 对象登记表结点
+#endif
 }tTimer;
 
 // 软定时器状态信息
@@ -43,15 +63,22 @@ typedef struct _tTimerInfo
     // 定时器配置参数
     uint32_t config;
 
+    // 允许推迟触发的节拍数
+    uint32_t slackTicks;
+
     // 定时器状态
     tTimerState state;
 }tTimerInfo;
 
 #define	TIMER_CONFIG_TYPE_HARD		(1 << 0)
 #define	TIMER_CONFIG_TYPE_SOFT		(0 << 0)
+#define	TIMER_CONFIG_POOL			(1 << 1)	// 取自定时器池，由tTimerCreateOneShot设置
 
 void tTimerInit (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks,
 		void (*timerFunc) (void * arg), void * arg, uint32_t config);
+void tTimerInitWithSlack (tTimer * timer, uint32_t delayTicks, uint32_t durationTicks, uint32_t slackTicks,
+		void (*timerFunc) (void * arg), void * arg, uint32_t config);
+void tTimerSetGroup (tTimer * timer, tTimerGroup * group);
 void tTimerStart (tTimer * timer);
 void tTimerStop (tTimer * timer);
 void tTimerModuleTickNotify (void);
@@ -59,4 +86,10 @@ void tTimerModuleInit (void);
 void tTimerDestroy (tTimer * timer);
 void tTimerGetInfo (tTimer * timer, tTimerInfo * info);
 void tTimerInitTask(void);
+void tTimerGroupInit (tTimerGroup * group, uint32_t prio, tTaskStack * stack, uint32_t stackSize, const char * name);
+uint32_t tTimerModuleNextTicks (void);
+#if TINYOS_TIMER_POOL_SIZE > 0
+tTimer * tTimerCreateOneShot (uint32_t ticks, void (*timerFunc) (void * arg), void * arg);
+uint32_t tTimerPoolFreeCount (void);
+#endif
 #endif
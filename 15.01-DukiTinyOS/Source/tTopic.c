@@ -0,0 +1,156 @@
+#include "tinyOS.h"
+
+#if TINYOS_ENABLE_TOPIC == 1
+/**
+ * @brief 初始化主题，代替TINYOS_TOPIC_DEFINE用于运行时创建的主题。
+ *
+ * @param topic   指向主题的指针。
+ * @param copy0   第一份数据，初始内容即为订阅者在第一次发布前读到的值。
+ * @param copy1   第二份数据，大小与copy0相同。
+ * @param size    数据的字节数。
+ *
+ * @return void
+ */
+void tTopicInit(tTopic * topic, void * copy0, void * copy1, uint32_t size) {
+    tEventInit(&topic->event, tEventTypeTopic);
+    tRegistryAdd(&topic->event.object, tObjectTypeEvent);
+    tSeqLatchInit(&topic->latch, copy0, copy1, size);
+}
+
+//唤醒所有等待新数据的订阅者，返回是否需要调度
+static uint32_t tTopicWakeAll(tTopic * topic) {
+    uint32_t count;
+    uint32_t status = tTaskEnterCritical();
+
+    count = tEventRemoveAll(&topic->event, (void *)0, tErrorNoError);
+    tTaskExitCritical(status);
+    return count;
+}
+
+/**
+ * @brief 发布新数据，在任务中调用，只允许一个发布者。
+ *
+ * 数据写入两份副本后代数加1，之后读取的订阅者都能看到；有订阅者在tTopicWait中等待时一次全部唤醒。
+ *
+ * @param topic  指向主题的指针。
+ * @param data   新数据，字节数为主题的大小。
+ *
+ * @return void
+ */
+void tTopicPublish(tTopic * topic, const void * data) {
+    tSeqLatchWrite(&topic->latch, data);
+    if (tTopicWakeAll(topic) > 0) {
+        tTaskSched();
+    }
+}
+
+/**
+ * @brief 在中断中发布新数据，同tTopicPublish。
+ *
+ * @param topic  指向主题的指针。
+ * @param data   新数据。
+ *
+ * @return void
+ */
+void tTopicPublishFromISR(tTopic * topic, const void * data) {
+    tSeqLatchWrite(&topic->latch, data);
+    if (tTopicWakeAll(topic) > 0) {
+        tTaskSchedFromISR();
+    }
+}
+
+/**
+ * @brief 订阅主题。
+ *
+ * 订阅前已有发布时，最近一次发布的数据对新订阅者也算作新数据，第一次tTopicCopyNew或tTopicWait即可取得。
+ *
+ * @param sub    订阅者。
+ * @param topic  指向主题的指针。
+ *
+ * @return void
+ */
+void tTopicSubscribe(tTopicSub * sub, tTopic * topic) {
+    sub->topic = topic;
+    sub->generation = 0;
+}
+
+/**
+ * @brief 读取主题的最新数据，不论是否读过，可在任务或中断中调用。
+ *
+ * @param sub    订阅者。
+ * @param data   用于存放数据的缓冲区。
+ *
+ * @return void
+ */
+void tTopicCopy(tTopicSub * sub, void * data) {
+    sub->generation = tSeqLatchReadSeq(&sub->topic->latch, data) >> 1;
+}
+
+/**
+ * @brief 有新数据时才读取，可在任务或中断中调用。
+ *
+ * 没有新的发布时只读一次序号，不复制数据，高速回路中可以每个周期调用。
+ *
+ * @param sub    订阅者。
+ * @param data   用于存放数据的缓冲区，没有新数据时不修改。
+ *
+ * @return uint32_t  1表示读到了新数据，0表示上次读取之后没有新的发布。
+ */
+uint32_t tTopicCopyNew(tTopicSub * sub, void * data) {
+    if (!tTopicUpdated(sub)) {
+        return 0;
+    }
+    tTopicCopy(sub, data);
+    return 1;
+}
+
+/**
+ * @brief 等待新数据并读取。
+ *
+ * 上次读取之后已有新的发布时立即读取返回，否则等待下一次发布；发布比读取快时只读到最新的一次。
+ *
+ * @param sub        订阅者。
+ * @param data       用于存放数据的缓冲区，超时时不修改。
+ * @param waitTicks  最大等待的节拍数，为0时一直等待。
+ *
+ * @return uint32_t  `tErrorNoError`表示读到了新数据，`tErrorTimeOut`表示超时，`tErrorDel`表示主题被删除。
+ */
+uint32_t tTopicWait(tTopicSub * sub, void * data, uint32_t waitTicks) {
+    uint32_t status = tTaskEnterCritical();
+
+    // 检查代数与进入等待队列在同一临界区内，发布者完成写入后才检查等待队列，不会漏掉唤醒
+    if (!tTopicUpdated(sub)) {
+        tEventWait(&sub->topic->event, curTask, (void *)0, tEventTypeTopic, waitTicks);
+        tTaskExitCritical(status);
+
+        tTaskSched();
+        if (curTask->waitEventResult != tErrorNoError) {
+            return curTask->waitEventResult;
+        }
+    } else {
+        tTaskExitCritical(status);
+    }
+
+    tTopicCopy(sub, data);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 删除主题，唤醒所有等待的订阅者，之后不能再发布。
+ *
+ * @param topic  指向主题的指针。
+ *
+ * @return uint32_t 被唤醒的任务数量。
+ */
+uint32_t tTopicDestroy(tTopic * topic) {
+    uint32_t status = tTaskEnterCritical();
+    uint32_t count = tEventRemoveAll(&topic->event, (void *)0, tErrorDel);
+    tRegistryRemove(&topic->event.object);
+    tTaskExitCritical(status);
+
+    if (count > 0) {
+        tTaskSched();
+    }
+    return count;
+}
+#endif
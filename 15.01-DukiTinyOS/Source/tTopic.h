@@ -0,0 +1,59 @@
+#ifndef __TTOPIC_H
+#define __TTOPIC_H
+
+#include "tEvent.h"
+#include "tSeqLock.h"
+#include "tStatic.h"
+
+// 发布/订阅主题：每个主题是一份定长数据，发布者写入主题的双缓冲顺序锁，订阅者记下自己读到的代数(发布次数)，
+// 代数变化时才复制，没有新数据时不复制也不进入临界区；一次发布可以被任意多个订阅者读取，
+// 不论有几个订阅者，发布只写两份数据。读端不加锁，订阅者优先级高于发布者时也不会等待或重试，
+// 只有需要阻塞等待新数据时才经过事件等待队列，没有任务等待时发布不调度。
+// 每个主题只允许一个发布者(同一任务或同一中断)，订阅者的个数不限且发布者不需要知道
+typedef struct _tTopic {
+	tEvent event;                    //等待新数据的订阅者
+	tSeqLatch latch;                 //数据的两份副本
+}tTopic;
+
+// 订阅者，位于订阅一方，每个读者一个
+typedef struct _tTopicSub {
+	tTopic * topic;
+	uint32_t generation;             //上次读到的代数，0表示尚未读过
+}tTopicSub;
+
+// 编译时定义主题topic，数据类型为type，两份副本在同一文件中静态分配，初始全为0且代数为0(尚未发布)，
+// 不需要调用tTopicInit；开启TINYOS_ENABLE_STATIC_OBJECT时由tStaticInit登记，否则不在登记表中。
+// 其它文件用TINYOS_TOPIC_DECLARE声明后订阅
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+#define TINYOS_TOPIC_REGISTER(topic)   TINYOS_STATIC_REGISTER(topic, topic.event.object)
+#else
+#define TINYOS_TOPIC_REGISTER(topic)   typedef char tTopicRegister_##topic
+#endif
+#define TINYOS_TOPIC_DEFINE(topic, type) \
+	static type topic##_copy[2]; \
+	tTopic topic = { \
+		.event = TINYOS_EVENT_INITIALIZER(topic.event, tEventTypeTopic, #topic), \
+		.latch = {{0}, {&topic##_copy[0], &topic##_copy[1]}, sizeof(type)}, \
+	}; \
+	TINYOS_TOPIC_REGISTER(topic)
+#define TINYOS_TOPIC_DECLARE(topic)   extern tTopic topic
+
+// 主题已发布的次数
+static __inline uint32_t tTopicGeneration(tTopic * topic) {
+	return tSeqLatchCount(&topic->latch);
+}
+
+// 订阅者上次读取之后是否有新的发布，只读一次序号
+static __inline uint32_t tTopicUpdated(tTopicSub * sub) {
+	return tSeqLatchCount(&sub->topic->latch) != sub->generation;
+}
+
+void tTopicInit(tTopic * topic, void * copy0, void * copy1, uint32_t size);
+void tTopicPublish(tTopic * topic, const void * data);
+void tTopicPublishFromISR(tTopic * topic, const void * data);
+void tTopicSubscribe(tTopicSub * sub, tTopic * topic);
+void tTopicCopy(tTopicSub * sub, void * data);
+uint32_t tTopicCopyNew(tTopicSub * sub, void * data);
+uint32_t tTopicWait(tTopicSub * sub, void * data, uint32_t waitTicks);
+uint32_t tTopicDestroy(tTopic * topic);
+#endif
@@ -0,0 +1,121 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_TRACE == 1
+
+#if (TINYOS_TRACE_BUFFER_SIZE & (TINYOS_TRACE_BUFFER_SIZE - 1)) != 0
+#error "TINYOS_TRACE_BUFFER_SIZE must be a power of 2"
+#endif
+
+static tTraceRecord traceBuffer[TINYOS_TRACE_BUFFER_SIZE];
+static volatile uint32_t traceWriteIndex;   // 下一条待分配的位置，只增不减
+static volatile uint32_t traceReadIndex;    // 下一条待输出的位置，只由输出方修改
+static volatile uint32_t traceDropped;
+
+// 初始化跟踪缓冲区，并启动时间戳所用的周期计数器
+void tTraceInit (void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TINYOS_TRACE_BUFFER_SIZE; i++)
+    {
+        traceBuffer[i].info = 0;
+    }
+    traceWriteIndex = 0;
+    traceReadIndex = 0;
+    traceDropped = 0;
+
+    tCycleCounterInit();
+}
+
+// 写入一条跟踪记录，可在任务及中断中调用
+// 用LDREX/STREX无锁地分配位置，不关中断；缓冲区满时丢弃新记录
+void tTraceWrite (tTraceEvent event, void * obj, uint32_t param)
+{
+    uint32_t index;
+    tTraceRecord * record;
+
+    do
+    {
+        index = __LDREXW((uint32_t *)&traceWriteIndex);
+        if (index - traceReadIndex >= TINYOS_TRACE_BUFFER_SIZE)
+        {
+            __CLREX();
+            traceDropped++;
+            return;
+        }
+    } while (__STREXW(index + 1, (uint32_t *)&traceWriteIndex) != 0);
+
+    record = &traceBuffer[index & (TINYOS_TRACE_BUFFER_SIZE - 1)];
+    record->timestamp = tCycleCounterGet();
+    record->obj = (uint32_t)obj;
+    record->info = ((uint32_t)TINYOS_TRACE_SYNC << 24) | ((uint32_t)event << 16) | (param & 0xFFFF);
+}
+
+// 中断服务函数入口/出口处调用，记录当前的中断号
+void tTraceIsrEnter (void)
+{
+    tTraceWrite(tTraceEventIsrEnter, (void *)0, __get_IPSR());
+}
+
+void tTraceIsrExit (void)
+{
+    tTraceWrite(tTraceEventIsrExit, (void *)0, __get_IPSR());
+}
+
+// 将已完整写入的记录交给output输出，最多输出maxCount条，返回实际输出的条数
+// 只允许在一个低优先级任务（如空闲任务的钩子）中调用
+uint32_t tTraceDrain (void (*output)(const uint8_t * data, uint32_t len), uint32_t maxCount)
+{
+    uint32_t count = 0;
+
+    while ((count < maxCount) && (traceReadIndex != traceWriteIndex))
+    {
+        tTraceRecord * record = &traceBuffer[traceReadIndex & (TINYOS_TRACE_BUFFER_SIZE - 1)];
+
+        // 位置已分配但写入者被打断，尚未写完，下次再输出
+        if (record->info == 0)
+        {
+            break;
+        }
+
+        output((const uint8_t *)record, sizeof(tTraceRecord));
+        record->info = 0;
+        traceReadIndex++;
+        count++;
+    }
+
+    return count;
+}
+
+// 通过ITM激励端口1(SWO)输出，调试器未使能ITM时直接丢弃
+void tTraceItmOutput (const uint8_t * data, uint32_t len)
+{
+    if (((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0) || ((ITM->TER & (1UL << 1)) == 0))
+    {
+        return;
+    }
+
+    while (len-- > 0)
+    {
+        while (ITM->PORT[1].u32 == 0)
+        {
+            ;
+        }
+        ITM->PORT[1].u8 = *data++;
+    }
+}
+
+// 查询跟踪缓冲区状态
+void tTraceGetInfo (tTraceInfo * info)
+{
+    uint32_t status = tTaskEnterCritical();
+
+    info->size = TINYOS_TRACE_BUFFER_SIZE;
+    info->pending = traceWriteIndex - traceReadIndex;
+    info->dropped = traceDropped;
+
+    tTaskExitCritical(status);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TTRACE_H
+#define TTRACE_H
+
+#include <stdint.h>
+
+// 跟踪记录的帧同步字节，位于每条记录的最高字节
+#define TINYOS_TRACE_SYNC           0xA5
+
+// 跟踪事件类型
+typedef enum _tTraceEvent
+{
+    tTraceEventNone = 0,            // 空记录，表示该位置尚未写完
+    tTraceEventTaskSwitchOut,       // obj为切出的任务
+    tTraceEventTaskSwitchIn,        // obj为切入的任务
+    tTraceEventWait,                // obj为事件控制块，param为事件类型
+    tTraceEventWakeUp,              // obj为事件控制块，param为事件类型
+    tTraceEventSemWait,
+    tTraceEventSemNotify,
+    tTraceEventMutexWait,
+    tTraceEventMutexNotify,
+    tTraceEventMboxWait,
+    tTraceEventMboxNotify,
+    tTraceEventTimerFire,           // obj为定时器
+    tTraceEventIsrEnter,            // param为中断号(IPSR)
+    tTraceEventIsrExit,
+    tTraceEventUser,                // 应用自定义事件
+}tTraceEvent;
+
+// 一条跟踪记录，共12字节，按小端顺序原样输出：
+// [0..3] CYCCNT时间戳  [4..7] 对象地址  [8..9] 参数  [10] 事件类型  [11] 同步字节0xA5
+typedef struct _tTraceRecord
+{
+    uint32_t timestamp;
+    uint32_t obj;
+    // 参数、事件类型与同步字节合并为一个字，最后写入，非0表示记录已完整
+    volatile uint32_t info;
+}tTraceRecord;
+
+// 跟踪缓冲区状态信息
+typedef struct _tTraceInfo
+{
+    // 缓冲区容量（记录数）
+    uint32_t size;
+
+    // 等待输出的记录数
+    uint32_t pending;
+
+    // 缓冲区满而丢弃的记录数
+    uint32_t dropped;
+}tTraceInfo;
+
+#if TINYOS_ENABLE_TRACE == 1
+#define tTraceRecord(event, obj, param)     tTraceWrite((event), (void *)(obj), (param))
+#else
+#define tTraceRecord(event, obj, param)     ((void)0)
+#endif
+
+void tTraceInit (void);
+void tTraceWrite (tTraceEvent event, void * obj, uint32_t param);
+
+#if TINYOS_ENABLE_TRACE == 1
+//登记在任务切换钩子上(见tHooks.h)，记录切出及切入的任务
+static __inline void tTraceHookTaskSwitch(tTask * from, tTask * to) {
+    tTraceWrite(tTraceEventTaskSwitchOut, from, from->prio);
+    tTraceWrite(tTraceEventTaskSwitchIn, to, to->prio);
+}
+#endif
+void tTraceIsrEnter (void);
+void tTraceIsrExit (void);
+uint32_t tTraceDrain (void (*output)(const uint8_t * data, uint32_t len), uint32_t maxCount);
+void tTraceItmOutput (const uint8_t * data, uint32_t len);
+void tTraceGetInfo (tTraceInfo * info);
+
+#endif /* TTRACE_H */
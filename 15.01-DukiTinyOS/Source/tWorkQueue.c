@@ -0,0 +1,173 @@
+#include "tinyOS.h"
+#include "tPort.h"
+
+#if TINYOS_ENABLE_WORKQUEUE == 1
+#if (TINYOS_WORKQ_SIZE & (TINYOS_WORKQ_SIZE - 1)) != 0
+#error "TINYOS_WORKQ_SIZE must be a power of 2"
+#endif
+
+tWorkQueue tSysWorkQueue;
+static tWorkItem tSysWorkItems[TINYOS_WORKQ_SIZE];
+static tTask tSysWorkTask;
+static tTaskStack tSysWorkTaskStack[TINYOS_WORKQ_STACK_SIZE];
+
+/**
+ * @brief 初始化工作队列。
+ * 
+ * @param wq        指向工作队列的指针。
+ * @param items     存放工作的槽位数组。
+ * @param size      槽位数，必须为2的幂。
+ * 
+ * @return void
+ */
+void tWorkQueueInit(tWorkQueue * wq, tWorkItem * items, uint32_t size) {
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        items[i].seq = i;
+    }
+    wq->items = items;
+    wq->size = size;
+    wq->writeIndex = 0;
+    wq->readIndex = 0;
+    wq->dropped = 0;
+    tSemInit(&wq->sem, 0, size);
+}
+
+//丢弃计数在任务及中断中都会修改，用LDREX/STREX加一
+static void tWorkDropped(tWorkQueue * wq) {
+    uint32_t dropped;
+
+    do {
+        dropped = __LDREXW((uint32_t *)&wq->dropped) + 1;
+    } while (__STREXW(dropped, (uint32_t *)&wq->dropped) != 0);
+}
+
+//占用一个槽位并写入，返回0表示队列已满
+//槽位序号比写序号小时其中的工作尚未被取走；比写序号大时说明读出writeIndex之后，
+//中断中的提交已占用并写入了同一槽位，writeIndex已经前进，重新读取即可
+static uint32_t tWorkPut(tWorkQueue * wq, void (*func) (void * arg), void * arg) {
+    uint32_t index;
+    int32_t diff;
+    tWorkItem * item;
+
+    for (;;) {
+        index = __LDREXW((uint32_t *)&wq->writeIndex);
+        item = &wq->items[index & (wq->size - 1)];
+        diff = (int32_t)(item->seq - index);
+        if (diff < 0) {
+            __CLREX();
+            tWorkDropped(wq);
+            return 0;
+        }
+        if (diff > 0) {
+            __CLREX();
+            continue;
+        }
+        if (__STREXW(index + 1, (uint32_t *)&wq->writeIndex) == 0) {
+            break;
+        }
+    }
+
+    item->func = func;
+    item->arg = arg;
+    __DMB();
+    item->seq = index + 1;
+    return 1;
+}
+
+/**
+ * @brief 在任务中提交工作。
+ * 
+ * @param wq        指向工作队列的指针。
+ * @param func      在工作任务中执行的函数。
+ * @param arg       传给func的参数。
+ * 
+ * @return tErrorNoError表示已提交，tErrorResourceFull表示队列已满
+ */
+uint32_t tWorkSubmit(tWorkQueue * wq, void (*func) (void * arg), void * arg) {
+    if (!tWorkPut(wq, func, arg)) {
+        return tErrorResourceFull;
+    }
+    tSemNotify(&wq->sem);
+    return tErrorNoError;
+}
+
+/**
+ * @brief 在中断服务函数或硬定时器回调中提交工作，由tIntExit统一调度。
+ * 
+ * @param wq        指向工作队列的指针。
+ * @param func      在工作任务中执行的函数。
+ * @param arg       传给func的参数。
+ * 
+ * @return tErrorNoError表示已提交，tErrorResourceFull表示队列已满
+ */
+uint32_t tWorkSubmitFromISR(tWorkQueue * wq, void (*func) (void * arg), void * arg) {
+    if (!tWorkPut(wq, func, arg)) {
+        return tErrorResourceFull;
+    }
+    tSemNotifyFromISR(&wq->sem);
+    return tErrorNoError;
+}
+
+//工作任务：每取得一个信号量计数就取出一个工作执行
+//槽位的写入顺序可能与占用顺序不同：低优先级任务占用槽位后被中断打断，中断写入后一个槽位并唤醒了工作任务，
+//此时队首尚未写完，工作任务保留已取得的计数，延时一个节拍后重试
+static void tWorkTaskEntry(void * param) {
+    tWorkQueue * wq = (tWorkQueue *)param;
+
+    for (;;) {
+        uint32_t index;
+        tWorkItem * item;
+        void (*func) (void * arg);
+        void * arg;
+
+        tSemWait(&wq->sem, 0);
+
+        for (;;) {
+            index = __LDREXW((uint32_t *)&wq->readIndex);
+            item = &wq->items[index & (wq->size - 1)];
+            if (item->seq != index + 1) {
+                __CLREX();
+                tTaskDelay(1);
+                continue;
+            }
+            if (__STREXW(index + 1, (uint32_t *)&wq->readIndex) == 0) {
+                break;
+            }
+        }
+
+        func = item->func;
+        arg = item->arg;
+        __DMB();
+        item->seq = index + wq->size;
+
+        func(arg);
+    }
+}
+
+/**
+ * @brief 为工作队列增加一个工作任务，同一队列的多个工作任务可并行处理。
+ * 
+ * @param wq        指向工作队列的指针。
+ * @param task      工作任务的任务结构。
+ * @param prio      工作任务的优先级。
+ * @param stack     工作任务的栈。
+ * @param size      栈的字节数。
+ * 
+ * @return void
+ */
+void tWorkQueueAddWorker(tWorkQueue * wq, tTask * task, uint32_t prio, uint32_t * stack, uint32_t size) {
+    tTaskInit(task, tWorkTaskEntry, wq, prio, stack, size);
+}
+
+/**
+ * @brief 初始化系统工作队列并创建其工作任务，在空闲任务中与tTimerInitTask一同调用。
+ * 
+ * @return void
+ */
+void tWorkQueueInitTask(void) {
+    tWorkQueueInit(&tSysWorkQueue, tSysWorkItems, TINYOS_WORKQ_SIZE);
+    tWorkQueueAddWorker(&tSysWorkQueue, &tSysWorkTask, TINYOS_WORKQ_PRIO, tSysWorkTaskStack, sizeof(tSysWorkTaskStack));
+}
+#endif
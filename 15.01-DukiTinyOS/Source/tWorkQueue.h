@@ -0,0 +1,32 @@
+#ifndef __TWORKQUEUE_H
+#define __TWORKQUEUE_H
+
+#include "tSem.h"
+
+// 延后处理的工作队列：在中断或硬定时器回调中只提交函数及参数，由工作任务在任务上下文中执行
+// 提交用LDREX/STREX无锁地占用槽位，每个槽位带序号以区分空闲/已写入，写完后通过信号量唤醒一个工作任务；
+// 同一队列可以有多个工作任务，工作函数可以阻塞
+typedef struct _tWorkItem {
+	void (*func) (void * arg);
+	void * arg;
+	volatile uint32_t seq;           //等于写序号时空闲，等于写序号+1时已写入，小于写序号时尚未被取走(队列满)
+}tWorkItem;
+
+typedef struct _tWorkQueue {
+	tWorkItem * items;
+	uint32_t size;                   //必须为2的幂
+	volatile uint32_t writeIndex;
+	volatile uint32_t readIndex;
+	volatile uint32_t dropped;       //队列满时被丢弃的提交次数
+	tSem sem;                        //已写入的工作数
+}tWorkQueue;
+
+void tWorkQueueInit(tWorkQueue * wq, tWorkItem * items, uint32_t size);
+void tWorkQueueAddWorker(tWorkQueue * wq, struct _tTask * task, uint32_t prio, uint32_t * stack, uint32_t size);
+uint32_t tWorkSubmit(tWorkQueue * wq, void (*func) (void * arg), void * arg);
+uint32_t tWorkSubmitFromISR(tWorkQueue * wq, void (*func) (void * arg), void * arg);
+
+// 由tWorkQueueInitTask创建的系统工作队列
+extern tWorkQueue tSysWorkQueue;
+void tWorkQueueInitTask(void);
+#endif
@@ -2,61 +2,195 @@
 #include "tinyOS.h"
 #include "tLib.h"
 #include "tConfig.h"
+#include "tPort.h"
 
-// 定义全局变量
-tTask * curTask ;
-tTask * nextTask;
+// 定义全局变量，调度器热点数据可放入TINYOS_FAST_DATA段
+TINYOS_FAST_DATA tTask * curTask ;
+TINYOS_FAST_DATA tTask * nextTask;
 tTask * idletask;
 
-tBitMap taskPrioBitMap;               // 优先级位图
-tList taskTable[TINYOS_PRIO_COUNT];    // 任务表
+TINYOS_FAST_DATA tBitMap taskPrioBitMap;               // 优先级位图
+TINYOS_FAST_DATA tList taskTable[TINYOS_PRIO_COUNT];    // 任务表
+TINYOS_FAST_DATA static tTask * taskHighestRdy;        // 最高优先级就绪队列的队首任务，随就绪表的修改增量维护
 
-uint8_t schedLockCounter = 0;         // 调度锁计数器
+TINYOS_FAST_DATA uint8_t schedLockCounter = 0;         // 调度锁计数器
+TINYOS_FAST_DATA uint8_t intNestCounter = 0;           // 中断嵌套计数器
+TINYOS_FAST_DATA uint8_t schedPendingFlag = 0;         // 中断中有任务就绪，等待退出中断时调度
 
-tList tTaskDelayedList;                // 延时队列
+uint32_t tTaskSwitchCount = 0;        // PendSV实际完成的任务切换次数
+uint32_t tTaskSwitchSkipCount = 0;    // PendSV发现无需切换而直接返回的次数
 
-#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
-uint32_t idleCount = 0;                // 空闲任务计数器
-uint32_t idleMaxCount = 0;
-uint32_t tickCount = 0;                // 时钟节拍计数
+TINYOS_FAST_DATA tList tTaskDelayedList;                // 延时队列
+tList tTaskTimeoutList;                // 事件/通知等待的超时队列
+
+TINYOS_FAST_DATA uint32_t tickCount = 0;                // 时钟节拍计数
+static uint32_t tickCountHigh = 0;     // 时钟节拍计数的高32位，tickCount回绕时加1
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+static uint32_t tickStep = 1;          // 每次节拍中断推进的节拍数，SysTick周期为其TINYOS_SYSTICK_MS倍
+#define TINYOS_TICK_STEP    tickStep
+#else
+#define TINYOS_TICK_STEP    1
 #endif
 
 #if TINYOS_ENABLE_CPUUSAGE_STATE == 1
 static void initCpuUsageState (void);
 static void checkCpuUsage (void);
-static void cpuUsageSyncWithSysTick (void);
 #endif
 
-//查找最高优先级的就绪任务
-tTask * tTaskHighestReady(void) {
+//某一优先级就绪队列的队首任务，队列为空时返回空指针
+TINYOS_FAST_CODE static tTask * tTaskPrioFirst(uint32_t prio) {
+	tNode *node = tListFirst(&(taskTable[prio]));
+	return (node != (tNode *)0) ? tNodeParent(node, tTask, linkNode) : (tTask *)0;
+}
+
+//最高优先级的队首任务被移走或换位后重新查找，只在这种情况下查位图
+TINYOS_FAST_CODE static void tTaskHighestRefresh(void) {
 	uint32_t highestPrio = tBitMapGetFirstSet(&taskPrioBitMap); //利用优先级位图法找到最高优先级
-	tNode *node = tListFirst(&(taskTable[highestPrio]));        //取出对应优先级就绪队列的第一个任务结点
-	return tNodeParent(node, tTask, linkNode);                  //利用宏由任务结点反向推出任务结构体指针
+	taskHighestRdy = (highestPrio < TINYOS_PRIO_COUNT) ? tTaskPrioFirst(highestPrio) : (tTask *)0;
+}
+
+//某一优先级的队首可能改变(队内换位、重新排序)，是当前的最高优先级时更新缓存
+TINYOS_FAST_CODE static void tTaskHighestPrioChanged(uint32_t prio) {
+	if((taskHighestRdy != (tTask *)0) && (taskHighestRdy->prio == prio)) {
+		taskHighestRdy = tTaskPrioFirst(prio);
+	}
 }
 
-void tTaskSched(void) {
+//查找最高优先级的就绪任务，直接返回就绪表修改时维护好的结果
+TINYOS_FAST_CODE tTask * tTaskHighestReady(void) {
+#if TINYOS_ENABLE_PARTITION == 1
+	//按窗口调度时只在当前窗口的分区及公共优先级中查找，空闲任务为公共优先级，总能找到
+	if(tPartitionActiveMap != (tBitMap *)0) {
+		return tTaskPrioFirst(tBitMapGetFirstSetMasked(&taskPrioBitMap,tPartitionActiveMap));
+	}
+#endif
+	return taskHighestRdy;
+}
+
+TINYOS_FAST_CODE void tTaskSched(void) {
 	tTask *tmpTask;
-	uint32_t status = tTaskEnterCritical();
+	uint32_t status;
+#if TINYOS_ENABLE_PROFILING == 1
+	uint32_t profileStart = tCycleCounterGet();
+#endif
+	status = tTaskEnterCritical();
 	if(schedLockCounter > 0) {
 		tTaskExitCritical(status);
 		return;
 	}
+	//处于中断中，推迟到最外层中断退出时再调度
+	if(intNestCounter > 0) {
+		schedPendingFlag = 1;
+		tTaskExitCritical(status);
+		return;
+	}
 	
 	tmpTask = tTaskHighestReady();
+#if TINYOS_ENABLE_PREEMPT_THRESHOLD == 1
+	//当前任务仍就绪且设置了抢占阈值时，只有优先级高于阈值的任务能抢占；优先级被互斥量提升到阈值之上后阈值不起作用
+	if((tmpTask != curTask) && (curTask != (tTask *)0) && (curTask->state == TINYOS_TASK_STATE_RDY)
+		&& (curTask->preemptThreshold < curTask->prio) && (tmpTask->prio >= curTask->preemptThreshold)
+#if TINYOS_ENABLE_BUDGET == 1
+		//预算用完被降级的任务不受阈值保护
+		&& !curTask->budgetExhausted
+#endif
+#if TINYOS_ENABLE_PARTITION == 1
+		//所属分区的窗口已结束的任务不受阈值保护
+		&& tPartitionPrioActive(curTask->prio)
+#endif
+		) {
+		tmpTask = curTask;
+	}
+#endif
 	if(tmpTask != curTask) {
 		nextTask = tmpTask;
-#if TINYOS_ENABLE_HOOKS == 1		
-		tHooksTaskSwitch(curTask,nextTask);
-#endif
+		tHooksRunTaskSwitch(curTask,nextTask);
 		tTaskSwitch();//参照uc/osII的写法，在tTaskSched调用前退出临界区，在tTaskSwitch调用前不退
 	}
 	
+#if TINYOS_ENABLE_PROFILING == 1
+	//只统计实际执行了调度判断的情况，切换本身的耗时由PendSV统计
+	tProfileRecord(tProfilePathSched,tCycleCounterGet() - profileStart);
+#endif
 	tTaskExitCritical(status);
 }
 
-//延时队列初始化
+#if TINYOS_ENABLE_SLICE == 1
+//协作式优先级：置位的优先级不做时间片轮转，同优先级任务只在阻塞或tTaskYield时切换
+static uint32_t coopPrioMap[(TINYOS_PRIO_COUNT + 31) / 32];
+
+/**
+ * @brief 设置某一优先级为协作式或时间片轮转。
+ * 
+ * 与tTaskSetSlice按任务设置不同，对该优先级当前及以后的所有任务生效，适合只有吞吐要求的后台优先级，
+ * 省去节拍中断引起的同优先级切换。
+ * 
+ * @param prio 优先级。
+ * @param coop 1：协作式，0：时间片轮转(默认)。
+ * 
+ * @return void
+ */
+void tTaskSetPrioCooperative(uint32_t prio, uint32_t coop) {
+	uint32_t status;
+	if(prio >= TINYOS_PRIO_COUNT) {
+		return;
+	}
+	status = tTaskEnterCritical();
+	if(coop) {
+		coopPrioMap[prio / 32] |= (1UL << (prio % 32));
+	} else {
+		coopPrioMap[prio / 32] &= ~(1UL << (prio % 32));
+	}
+	tTaskExitCritical(status);
+}
+#endif
+
+/**
+ * @brief 当前任务主动让出CPU。
+ * 
+ * 把当前任务移到同优先级就绪队列的队尾，同优先级有其它就绪任务时切换到队首的任务，否则直接返回。
+ * 主动让出不受抢占阈值限制；调度上锁或在中断中调用时不做任何处理。
+ * 
+ * @return void
+ */
+void tTaskYield(void) {
+	tTask * tmpTask;
+	uint32_t status = tTaskEnterCritical();
+	tList * list = &(taskTable[curTask->prio]);
+	
+	if((schedLockCounter > 0) || (intNestCounter > 0) || (curTask->state != TINYOS_TASK_STATE_RDY)
+		|| (tListCount(list) < 2)
+#if TINYOS_ENABLE_EDF == 1
+		//EDF优先级按截止时间排序，不能轮转
+		|| (curTask->prio == TINYOS_EDF_PRIO)
+#endif
+		) {
+		tTaskExitCritical(status);
+		return;
+	}
+	
+	//在同一队列内移到队尾，结点数不变
+	tNodeUnlink(&(curTask->linkNode));
+	tNodeLinkAfter(list->headNode.preNode,&(curTask->linkNode));
+	tTaskHighestPrioChanged(curTask->prio);
+#if TINYOS_ENABLE_SLICE == 1
+	curTask->slice = curTask->sliceMax;
+#endif
+	
+	tmpTask = tTaskHighestReady();
+	if(tmpTask != curTask) {
+		nextTask = tmpTask;
+		tHooksRunTaskSwitch(curTask,nextTask);
+		tTaskSwitch();
+	}
+	tTaskExitCritical(status);
+}
+
+//延时队列及超时队列初始化
 void tTaskDelayedInit(void) {
 	tListInit(&(tTaskDelayedList));
+	tListInit(&(tTaskTimeoutList));
 }
 
 //
@@ -68,6 +202,7 @@ void tTaskSchedInit(void) {
 	for(i = 0;i < TINYOS_PRIO_COUNT;i++) {
 		tListInit(&(taskTable[i]));
 	}
+	taskHighestRdy = (tTask *)0;
 	tTaskExitCritical(status);
 }
 
@@ -92,17 +227,124 @@ void tTaskSchedEnable(void) {
 	tTaskExitCritical(status);
 }
 
+//中断服务函数中请求调度，只设置标志，由tIntExit统一处理
+//未调用tIntEnter时直接调度，PendSV优先级最低，会在中断全部退出后执行
+TINYOS_FAST_CODE void tTaskSchedFromISR(void) {
+	uint32_t status = tTaskEnterCritical();
+	if(intNestCounter > 0) {
+		schedPendingFlag = 1;
+		tTaskExitCritical(status);
+		return;
+	}
+	tTaskExitCritical(status);
+	tTaskSched();
+}
+
+#if TINYOS_ENABLE_IRQ_THREAD == 1
+//中断线程唤醒任务后调用：刚加入就绪表的任务只需与已选定的下一任务比较，不查找位图，也不等待tIntExit
+//抢占阈值、EDF及时间分区需要完整的调度判断，退回到tTaskSchedFromISR
+TINYOS_FAST_CODE void tTaskSchedPreempt(tTask * task) {
+#if (TINYOS_ENABLE_PREEMPT_THRESHOLD == 1) || (TINYOS_ENABLE_EDF == 1) || (TINYOS_ENABLE_PARTITION == 1)
+	(void)task;
+	tTaskSchedFromISR();
+#else
+	uint32_t status = tTaskEnterCritical();
+	//调度器启动前nextTask为空，由tTaskRunFirst选出最高优先级任务
+	if((schedLockCounter == 0) && (nextTask != (tTask *)0) && (task->prio < nextTask->prio)) {
+		nextTask = task;
+		tHooksRunTaskSwitch(curTask,nextTask);
+		tTaskSwitch();
+	}
+	tTaskExitCritical(status);
+#endif
+}
+#endif
+
+//进入中断，在调用内核API的中断服务函数开头调用
+TINYOS_FAST_CODE void tIntEnter(void) {
+	uint32_t status = tTaskEnterCritical();
+	if(intNestCounter < 255) {
+		intNestCounter++;
+	}
+	tTaskExitCritical(status);
+}
+
+//退出中断，最外层退出时若有任务就绪，只触发一次调度
+TINYOS_FAST_CODE void tIntExit(void) {
+	uint32_t status = tTaskEnterCritical();
+	if((intNestCounter > 0) && (--intNestCounter == 0) && schedPendingFlag) {
+		schedPendingFlag = 0;
+		tTaskExitCritical(status);
+		tTaskSched();
+		return;
+	}
+	tTaskExitCritical(status);
+}
+
+#if TINYOS_ENABLE_EDF == 1
+//EDF优先级的就绪队列按绝对截止时间排序，队首即截止时间最早的任务，截止时间相同时先来先服务
+static void tTaskEdfInsert(tTask * task) {
+	tNode * node;
+	tNode * preNode = &(taskTable[TINYOS_EDF_PRIO].headNode);
+	for(node = preNode->nextNode;node != &(taskTable[TINYOS_EDF_PRIO].headNode);node = node->nextNode) {
+		tTask * rdyTask = tNodeParent(node,tTask,linkNode);
+		//用差值比较，节拍计数回绕后仍然正确
+		if((int32_t)(rdyTask->deadline - task->deadline) > 0) {
+			break;
+		}
+		preNode = node;
+	}
+	tListInsertAfter(&(taskTable[TINYOS_EDF_PRIO]),preNode,&(task->linkNode));
+}
+
+//设置任务的绝对截止时间(节拍)，只对优先级为TINYOS_EDF_PRIO的任务影响调度
+void tTaskSetDeadline(tTask * task,uint32_t deadline) {
+	uint32_t status = tTaskEnterCritical();
+	task->deadline = deadline;
+	if((task->prio == TINYOS_EDF_PRIO) && (task->state == TINYOS_TASK_STATE_RDY)) {
+		//已在就绪队列中，按新的截止时间重新排序
+		tListRemove(&(taskTable[TINYOS_EDF_PRIO]),&(task->linkNode));
+		tTaskEdfInsert(task);
+		tTaskHighestPrioChanged(TINYOS_EDF_PRIO);
+	}
+	tTaskExitCritical(status);
+	tTaskSched();
+}
+#endif
+
 //插入就绪队列
-void tTaskSchedRdy(tTask * task) {
-	tListAddFirst(&(taskTable[task->prio]),&(task->linkNode));
+//比缓存的最高优先级低的任务就绪时只有一次比较；同优先级时新任务可能排到队首，取一次队首
+TINYOS_FAST_CODE void tTaskSchedRdy(tTask * task) {
+#if TINYOS_ENABLE_WAIT_STAT == 1
+	tTaskWaitStatEnd(task);
+#endif
+#if TINYOS_ENABLE_EDF == 1
+	if(task->prio == TINYOS_EDF_PRIO) {
+		tTaskEdfInsert(task);
+	} else
+#endif
+	{
+		tListAddFirst(&(taskTable[task->prio]),&(task->linkNode));
+	}
 	tBitMapSet(&taskPrioBitMap,task->prio);
+	if((taskHighestRdy == (tTask *)0) || (task->prio < taskHighestRdy->prio)) {
+		taskHighestRdy = task;
+	} else if(task->prio == taskHighestRdy->prio) {
+		taskHighestRdy = tTaskPrioFirst(task->prio);
+	}
 }
-//将任务设置为非就绪状态
-void tTaskSchedUnRdy(tTask * task) {
+//将任务设置为非就绪状态，移走的不是最高优先级的队首任务时缓存不变
+TINYOS_FAST_CODE void tTaskSchedUnRdy(tTask * task) {
 	tListRemove(&(taskTable[task->prio]),&(task->linkNode));
 	if(tListCount(&taskTable[task->prio]) == 0) {
 		tBitMapClear(&taskPrioBitMap,task->prio);
 	}
+	if(task == taskHighestRdy) {
+		tTaskHighestRefresh();
+	}
+#if TINYOS_ENABLE_WAIT_STAT == 1
+	tTaskWaitStatBegin(task);
+#endif
 }
 
 //从优先级队列移出
@@ -111,59 +353,222 @@ void tTaskSchedRemove(tTask * task) {
 	if(tListCount(&taskTable[task->prio]) == 0) {
 		tBitMapClear(&taskPrioBitMap,task->prio);
 	}
+	if(task == taskHighestRdy) {
+		tTaskHighestRefresh();
+	}
+}
+
+//延时队列与超时队列都按到期时间排序，每个任务的delayTicks保存的是相对前一个任务的差值(delta)，
+//这样每个节拍只需处理队首任务；两者共用delayNode，一个任务同一时刻只会在其中一个队列中
+static void tTimeListInsert(tList * list,tTask * task,uint32_t ticks) {
+	tNode * node;
+	tNode * preNode = &(list->headNode);
+	for(node = list->headNode.nextNode;node != &(list->headNode);node = node->nextNode) {
+		tTask * delayTask = tNodeParent(node,tTask,delayNode);
+		if(ticks < delayTask->delayTicks) {
+			//插入到该任务前面，后者的差值相应减少
+			delayTask->delayTicks -= ticks;
+			break;
+		}
+		ticks -= delayTask->delayTicks;
+		preNode = node;
+	}
+	task->delayTicks = ticks;
+	tListInsertAfter(list,preNode,&(task->delayNode));
+}
+
+//将任务从队列中摘下，剩余的差值累加到后一个任务上，不需要遍历
+static void tTimeListUnlink(tList * list,tTask * task) {
+	tNode * next = task->delayNode.nextNode;
+	if(next != &(list->headNode)) {
+		tTask * nextDelayTask = tNodeParent(next,tTask,delayNode);
+		nextDelayTask->delayTicks += task->delayTicks;
+	}
+	tListRemove(list,&(task->delayNode));
+	task->delayTicks = 0;
+}
+
+//任务到期前剩余的节拍数，需要累加前面所有任务的差值
+static uint32_t tTimeListGetTicks(tList * list,tTask * task) {
+	tNode * node;
+	uint32_t ticks = 0;
+	for(node = list->headNode.nextNode;node != &(list->headNode);node = node->nextNode) {
+		tTask * delayTask = tNodeParent(node,tTask,delayNode);
+		ticks += delayTask->delayTicks;
+		if(node == &(task->delayNode)) {
+			break;
+		}
+	}
+	return ticks;
 }
 
 //任务加入延时队列
 void tTimeTaskWait(tTask * task,uint32_t ticks) {
-	task->delayTicks = ticks;
-	tListAddLast(&tTaskDelayedList,&(task->delayNode));
+	tTimeListInsert(&tTaskDelayedList,task,ticks);
 	task->state |= TINYOS_TASK_STATE_DELAYED;
 }
 
 //任务取消延时状态
 void tTimeTaskWakeUp(tTask * task) {
-	tListRemove(&tTaskDelayedList,&(task->delayNode));
+	tTimeListUnlink(&tTaskDelayedList,task);
 	task->state &= ~TINYOS_TASK_STATE_DELAYED;
 }
 
 //任务移出延时队列
 void tTimeTaskRemove(tTask * task) {
-	tListRemove(&tTaskDelayedList,&(task->delayNode));
+	tTimeListUnlink(&tTaskDelayedList,task);
+}
+
+//等待事件或通知的任务开始超时计时
+void tTimeTaskTimeoutStart(tTask * task,uint32_t ticks) {
+	tTimeListInsert(&tTaskTimeoutList,task,ticks);
+	task->state |= TINYOS_TASK_STATE_TIMEOUT;
+}
+
+//等待的事件或通知在超时前到达，取消超时计时
+void tTimeTaskTimeoutCancel(tTask * task) {
+	tTimeListUnlink(&tTaskTimeoutList,task);
+	task->state &= ~TINYOS_TASK_STATE_TIMEOUT;
+}
+
+//获取任务剩余的延时节拍数，等待超时的任务返回距超时的节拍数
+uint32_t tTimeTaskGetDelay(tTask * task) {
+	if(task->state & TINYOS_TASK_STATE_DELAYED) {
+		return tTimeListGetTicks(&tTaskDelayedList,task);
+	}
+	if(task->state & TINYOS_TASK_STATE_TIMEOUT) {
+		return tTimeListGetTicks(&tTaskTimeoutList,task);
+	}
+	return 0;
 }
 
-#if TINYOS_ENABLE_CPUUSAGE_STATE == 1
 //tickCount初始化
 void tTimeTickInit(void) {
 	tickCount = 0;
+	tickCountHigh = 0;
+}
+
+//获取系统启动以来的节拍数
+uint32_t tTaskTickGet(void) {
+	return tickCount;
+}
+
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+//设置每次节拍中断推进的节拍数，由移植层在SysTick周期改变后的第一个中断中调用
+void tTaskTickStepSet(uint32_t step) {
+	tickStep = (step == 0) ? 1 : step;
+}
+
+//获取每次节拍中断推进的节拍数
+uint32_t tTaskTickStepGet(void) {
+	return tickStep;
 }
 #endif
-void tTaskSystemTickHandler(void) {
-	tNode * node;
+
+//获取系统启动以来的64位节拍数，不会回绕
+uint64_t tTimeGetTicks64(void) {
+	uint64_t ticks;
 	uint32_t status = tTaskEnterCritical();
-	for(node = tTaskDelayedList.headNode.nextNode;node != &(tTaskDelayedList.headNode);node = node->nextNode) {
+	ticks = ((uint64_t)tickCountHigh << 32) | tickCount;
+	tTaskExitCritical(status);
+	return ticks;
+}
+//延时队列和超时队列推进ticks个节拍，唤醒所有到期的任务
+TINYOS_FAST_CODE static void tTimeTaskAdvance(uint32_t ticks) {
+	tNode * node;
+	uint32_t left = ticks;
+	while((node = tListFirst(&tTaskDelayedList)) != (tNode *)0) {
+		tTask * task = tNodeParent(node,tTask,delayNode);
+		if(task->delayTicks > left) {
+			task->delayTicks -= left;
+			break;
+		}
+		left -= task->delayTicks;
+		task->delayTicks = 0;
+		tTimeTaskWakeUp(task);
+		tTaskSchedRdy(task);
+	}
+	
+	//等待超时的任务，事件等待需从事件的等待队列中移除
+	left = ticks;
+	while((node = tListFirst(&tTaskTimeoutList)) != (tNode *)0) {
 		tTask * task = tNodeParent(node,tTask,delayNode);
-		if(--task->delayTicks == 0) {
-			if(task->waitEvent) {
-				tEventRemoveTask(task,(void *)0,tErrorTimeOut);
-			}
-			tTimeTaskWakeUp(task);
-			tTaskSchedRdy(task);
+		if(task->delayTicks > left) {
+			task->delayTicks -= left;
+			break;
 		}
+		left -= task->delayTicks;
+		task->delayTicks = 0;
+		if(task->waitEvent) {
+			tEventRemoveTask(task,(void *)0,tErrorTimeOut);
+		}
+#if TINYOS_ENABLE_ISR_READY_QUEUE == 1
+		//等待通知的任务已超时就绪，同时在中断中收到的通知由PendSV处理时不再重复就绪
+		task->state &= ~TINYOS_TASK_STATE_NOTIFY_WAIT;
+#endif
+#if TINYOS_ENABLE_IRQ_THREAD == 1
+		//超时就绪后到来的中断只计数，不再重复加入就绪表
+		task->state &= ~TINYOS_TASK_STATE_IRQ_WAIT;
+#endif
+		tTimeTaskTimeoutCancel(task);
+		tTaskSchedRdy(task);
+	}
+}
+
+TINYOS_FAST_CODE void tTaskSystemTickHandler(void) {
+	uint32_t status = tTaskEnterCritical();
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+	uint32_t i;
+#endif
+	//只需处理队首的任务，按节拍计的延时及超时与节拍周期无关，周期加长时到期时刻取整到下一个中断
+	tTimeTaskAdvance(TINYOS_TICK_STEP);
+	
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+	for(i = 0; i < tickStep; i++)
+#endif
+	{
+#if TINYOS_ENABLE_SUPERVISOR == 1
+		//检查周期任务的截止时间及看门狗窗口
+		tSupervisorTick();
+#endif
+		
+#if TINYOS_ENABLE_BUDGET == 1
+		//运行预算计入当前任务，用完时降级，周期到达时恢复
+		tTaskBudgetTick();
+#endif
 	}
 	
-	if(--curTask->slice == 0) {
-		if(tListCount(&(taskTable[curTask->prio])) > 0) {
-			tListRemoveFirst(&(taskTable[curTask->prio]));
-			tListAddLast(&(taskTable[curTask->prio]),&(curTask->linkNode));
+#if TINYOS_ENABLE_SLICE == 1
+	//时间片轮转：任务不使用时间片(sliceMax为0)、优先级为协作式或同优先级只有它一个任务时无需处理，
+	//当前任务刚进入等待、尚未切换出去时也不在就绪队列中
+	if((curTask->sliceMax != 0) && (tListCount(&(taskTable[curTask->prio])) > 1)
+		&& (curTask->state == TINYOS_TASK_STATE_RDY)
+		&& !(coopPrioMap[curTask->prio / 32] & (1UL << (curTask->prio % 32)))
+#if TINYOS_ENABLE_EDF == 1
+		//EDF优先级按截止时间排序，不做时间片轮转
+		&& (curTask->prio != TINYOS_EDF_PRIO)
+#endif
+		) {
+		if(curTask->slice <= TINYOS_TICK_STEP) {
+			//在同一队列内移到队尾，结点数不变
+			tNodeUnlink(&(curTask->linkNode));
+			tNodeLinkAfter(taskTable[curTask->prio].headNode.preNode,&(curTask->linkNode));
+			tTaskHighestPrioChanged(curTask->prio);
 			
-			curTask->slice = TINYOS_SLICE_MAX;
+			curTask->slice = curTask->sliceMax;
+		} else {
+			curTask->slice -= TINYOS_TICK_STEP;
 		}
 	}
+#endif
 	
+	  // 节拍计数增加
+    tickCount += TINYOS_TICK_STEP;
+    if(tickCount < TINYOS_TICK_STEP) {
+        tickCountHigh++;
+    }
 	
 #if TINYOS_ENABLE_CPUUSAGE_STATE == 1
-	  // 节拍计数增加
-    tickCount++;
     // 检查cpu使用率
     checkCpuUsage();
 #endif
@@ -173,60 +578,140 @@ void tTaskSystemTickHandler(void) {
     // 通知定时器模块节拍事件
     tTimerModuleTickNotify();
 #endif
-#if TINYOS_ENABLE_HOOKS == 1
-	  tHooksSysTick();
-#endif
+    tHooksRunSysTick();
     // 这个过程中可能有任务延时完毕(delayTicks = 0)，进行一次调度。
     tTaskSched();
 }
 
+#if (TINYOS_ENABLE_TICKLESS == 1) || (TINYOS_ENABLE_TICK_OVERRUN == 1)
+//休眠唤醒或节拍中断丢失后补偿错过的节拍，需在临界区内调用
+void tTaskSystemTickCatchUp(uint32_t ticks) {
+	if(ticks == 0) {
+		return;
+	}
+	tickCount += ticks;
+	if(tickCount < ticks) {
+		tickCountHigh++;
+	}
+	tTimeTaskAdvance(ticks);
+	
+#if TINYOS_ENABLE_TIMER == 1
+	//定时器按到期时刻比较，补偿后通知一次即可处理期间到期的所有定时器
+	tTimerModuleTickNotify();
+#endif
+}
+#endif
+
+#if TINYOS_ENABLE_TICKLESS == 1
+//计算空闲任务可以连续休眠的节拍数，返回0表示不能休眠
+//只有空闲任务就绪时才允许休眠，休眠时长取延时队列、超时队列队首与定时器最近到期时间中的最小值
+uint32_t tTaskSleepTicksGet(void) {
+	tNode * node;
+	uint32_t ticks = 0xFFFFFFFF;
+	
+	if((schedLockCounter > 0) || (tBitMapGetFirstSet(&taskPrioBitMap) < TINYOS_PRIO_COUNT - 1)
+		|| (tListCount(&taskTable[TINYOS_PRIO_COUNT - 1]) > 1)) {
+		return 0;
+	}
+	
+	if((node = tListFirst(&tTaskDelayedList)) != (tNode *)0) {
+		tTask * task = tNodeParent(node,tTask,delayNode);
+		ticks = task->delayTicks;
+	}
+	if((node = tListFirst(&tTaskTimeoutList)) != (tNode *)0) {
+		tTask * task = tNodeParent(node,tTask,delayNode);
+		if(task->delayTicks < ticks) {
+			ticks = task->delayTicks;
+		}
+	}
+	
+#if TINYOS_ENABLE_TIMER == 1
+	{
+		uint32_t timerTicks = tTimerModuleNextTicks();
+		if(timerTicks < ticks) {
+			ticks = timerTicks;
+		}
+	}
+#endif
+	return ticks;
+}
+#endif
+
 #if TINYOS_ENABLE_CPUUSAGE_STATE == 1
 static float cpuUsage;
-//需要保证在一个节拍新开始时空闲计数器开始计数
-uint32_t enableCpuUsageState;
+static uint32_t lastSwitchCycles;      // 上一次计入运行时间时的周期计数
+static uint64_t idleCycles;            // 空闲优先级任务累计运行的周期数
+static uint64_t idleCyclesLast;
+static uint32_t usageCyclesLast;
+static uint32_t usageTickLast;         // 上一次统计时的节拍，节拍步长可变时不一定落在整秒上
+#if TINYOS_ENABLE_IRQ_STAT == 1
+static uint32_t lastIrqCycles;         // 上一次计入运行时间时中断累计的周期数
+#endif
+
 static void initCpuUsageState (void)
 {
-    idleCount = 0;
-    idleMaxCount = 0;
     cpuUsage = 0;
-    enableCpuUsageState = 0;
+    idleCycles = 0;
+    idleCyclesLast = 0;
+    tCycleCounterInit();
+    lastSwitchCycles = tCycleCounterGet();
+    usageCyclesLast = lastSwitchCycles;
+    usageTickLast = 0;
+#if TINYOS_ENABLE_IRQ_STAT == 1
+    lastIrqCycles = tIrqStatCycles();
+#endif
 }
 
-static void checkCpuUsage (void)
+//将上次统计至今的周期数计入当前任务，由PendSV在切换前调用，其它情况需在临界区内调用
+void tTaskRunTimeUpdate (void)
 {
-    // 与空闲任务的cpu统计同步
-    if (enableCpuUsageState == 0)
-    {
-        enableCpuUsageState = 1;
-        tickCount = 0;
-        return;
-    }
+    uint32_t now = tCycleCounterGet();
+    uint32_t cycles = now - lastSwitchCycles;
+#if TINYOS_ENABLE_IRQ_STAT == 1
+    uint32_t irq = tIrqStatCycles() - lastIrqCycles;
+
+    // 其间中断执行的时间不计入被打断的任务，空闲任务也不计，CPU利用率因此包含中断负荷
+    lastIrqCycles += irq;
+    cycles -= (irq < cycles) ? irq : cycles;
+#endif
 
-    if (tickCount == TICKS_PER_SEC)
+    lastSwitchCycles = now;
+    if (curTask == (tTask *)0)
     {
-        // 统计最初1s内的最大计数值
-        idleMaxCount = idleCount;
-        idleCount = 0;
-
-        // 计数完毕，开启调度器，允许切换到其它任务
-        tTaskSchedEnable();
+        // 第一次切换前没有正在运行的任务
+        return;
     }
-    else if (tickCount % TICKS_PER_SEC == 0)
+    curTask->runCycles += cycles;
+    if (curTask->prio == TINYOS_PRIO_COUNT - 1)
     {
-        // 之后每隔1s统计一次，同时计算cpu利用率
-        cpuUsage = 100 - (idleCount * 100.0 / idleMaxCount);
-        idleCount = 0;
+        idleCycles += cycles;
     }
 }
 
-
-static void cpuUsageSyncWithSysTick (void)
+static void checkCpuUsage (void)
 {
-    // 等待与时钟节拍同步
-    while (enableCpuUsageState == 0)
+    uint32_t now, totalCycles;
+
+    if ((tickCount - usageTickLast) < TICKS_PER_SEC)
+    {
+        return;
+    }
+    usageTickLast = tickCount;
+
+    // 每隔1s统计一次，利用率由空闲任务在这段时间内的运行周期数得出，无需启动时标定
+    tTaskRunTimeUpdate();
+    now = tCycleCounterGet();
+    totalCycles = now - usageCyclesLast;
+    if (totalCycles > 0)
     {
-        ;;
+        cpuUsage = 100 - ((idleCycles - idleCyclesLast) * 100.0 / totalCycles);
     }
+    idleCyclesLast = idleCycles;
+    usageCyclesLast = now;
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+    // 在统计周期的边界调频，下一个周期的空闲及总周期数都按新频率计数
+    tClockGovernor(cpuUsage);
+#endif
 }
 
 float tCpuUsageGet (void)
@@ -243,30 +728,122 @@ float tCpuUsageGet (void)
 #endif
 
 void tTinyOSInit(void) {
+#if TINYOS_ENABLE_CRIT_PROFILE == 1
+    // 此前的统计时周期计数器可能尚未启动，重新开始
+    tCycleCounterInit();
+    tCritProfileReset();
+#endif
+#if TINYOS_ENABLE_IRQ_STAT == 1
+    tCycleCounterInit();
+    tIrqStatReset();
+#endif
+#if TINYOS_ENABLE_MUTEX_STAT == 1
+    tCycleCounterInit();
+#endif
+#if TINYOS_ENABLE_PROFILING == 1
+    // 启动周期计数器，后续的调度开销都可以统计到
+    tProfileInit();
+#endif
+#if TINYOS_ENABLE_TRACE == 1
+    // 初始化事件跟踪缓冲区
+    tTraceInit();
+#endif
+#if TINYOS_ENABLE_LOG == 1
+    // 初始化日志缓冲区，之后即可在任务及中断中记录日志
+    tLogInit();
+#endif
+#if TINYOS_ENABLE_REGISTRY == 1
+    // 初始化对象登记表，需在创建任何任务及内核对象之前
+    tRegistryInit();
+#endif
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+    // 登记静态定义的内核对象，对象本身已在编译时初始化
+    tStaticInit();
+#endif
 	    // 优先初始化tinyOS的核心功能
     tTaskSchedInit();
 
     // 初始化延时队列
     tTaskDelayedInit();
 
+#if TINYOS_ENABLE_STACK_MONITOR == 1
+    // 初始化栈水位监视列表，需在创建任何任务之前
+    tTaskStackMonitorInit();
+#endif
+
+#if TINYOS_ENABLE_SUPERVISOR == 1
+    // 初始化周期任务监督
+    tSupervisorInit();
+#endif
+
+#if TINYOS_ENABLE_BUDGET == 1
+    // 初始化运行预算列表
+    tTaskBudgetInit();
+#endif
+
+#if TINYOS_ENABLE_TASK_POOL == 1
+    // 初始化动态任务池
+    tTaskPoolInit();
+#endif
+
+#if TINYOS_ENABLE_IDLE_JOB == 1
+    // 初始化空闲作业表
+    tIdleJobModuleInit();
+#endif
+
+#if TINYOS_ENABLE_RTT == 1
+    // 写入RTT控制块标识，之前写入的内容不会丢失；需在空闲作业表之后，以登记跟踪记录的转出作业
+    tRttInit();
+#endif
+
 #if TINYOS_ENABLE_TIMER == 1
     // 初始化定时器模块
     tTimerModuleInit();
 #endif
+
+#if TINYOS_ENABLE_HRTIMER == 1
+    // 初始化高精度定时器，需在系统时钟配置完成之后
+    tHrTimerModuleInit();
+#endif
+
+#if TINYOS_ENABLE_POWER == 1
+    // 初始化RTC唤醒定时器，需在系统时钟配置完成之后
+    tPowerInit();
+#endif
+
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+    // 以当前的系统时钟为最高频率，需在系统时钟配置完成之后
+    tClockInit();
+#endif
 	
+    // 初始化时钟计数器
+    tTimeTickInit();
     
 #if TINYOS_ENABLE_CPUUSAGE_STATE == 1
-	  // 初始化时钟计数器
-    tTimeTickInit();
     // 初始化cpu统计
     initCpuUsageState();
 #endif
 }
 
 void tTinyOSStart(void) {
+#if TINYOS_ENABLE_STATIC_OBJECT == 1
+    // 创建静态定义的任务，与main中已创建的任务一起参与选择
+    tStaticStart();
+#endif
+
 	    // 这里，不再指定先运行哪个任务，而是自动查找最高优先级的任务运行
     nextTask = tTaskHighestReady();
 
+#if TINYOS_ENABLE_USER_MODE == 1
+    // 设置非特权任务可执行的Flash区域并开启MPU，第一次切换时装载任务的区域
+    tSvcInit();
+#endif
+
+#if TINYOS_ENABLE_STACK_GUARD == 1
+    // 开启MPU，第一次切换时设置保护区
+    tStackGuardInit();
+#endif
+
     // 切换到nextTask， 这个函数永远不会返回
     tTaskRunFirst();
 }
\ No newline at end of file
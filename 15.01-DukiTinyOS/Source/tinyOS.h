@@ -2,17 +2,59 @@
 #define __TINYOS_H
 #include <stdint.h>
 #include "tLib.h"
-#include "tconfig.h"
+#include "tFormat.h"
+#include "tConfig.h"
 #include "tEvent.h"
 #include "tTask.h"
 #include "tSem.h"
 #include "tMbox.h"
 #include "tMemBlock.h"
+#include "tHeap.h"
+#include "tSlab.h"
+#include "tDmaBuf.h"
+#include "tMsgQueue.h"
+#include "tQueue.h"
+#include "tPrioQueue.h"
+#include "tMsgCall.h"
+#include "tRingBuf.h"
+#include "tStream.h"
+#include "tIpc.h"
 #include "tFlagGroup.h"
 #include "tMutex.h"
+#include "tRwLock.h"
+#include "tCond.h"
+#include "tBarrier.h"
+#include "tSeqLock.h"
+#include "tTopic.h"
+#include "tNotify.h"
+#include "tTaskGroup.h"
+#include "tIrqThread.h"
 #include "tTimer.h"
+#include "tHrTimer.h"
+#include "tCyclic.h"
+#include "tPartition.h"
+#include "tJob.h"
+#include "tCoroutine.h"
+#include "tWorkQueue.h"
+#include "tIdle.h"
+#include "tPower.h"
+#include "tClock.h"
+#include "tSupervisor.h"
+#include "tProfile.h"
+#include "tPcSample.h"
+#include "tTrace.h"
 #include "tHooks.h"
+#include "tRtt.h"
+#include "tLog.h"
+#include "tRegistry.h"
+#include "tShell.h"
+#include "tStatic.h"
+#include "tSvc.h"
 #define TICKS_PER_SEC (1000 / TINYOS_SYSTICK_MS)
+//时间换算为节拍数，向上取整，不会比要求的短；节拍单位固定为TINYOS_SYSTICK_MS，参数为常量时在编译期求值
+#define tTimeMsToTicks(ms)          (((uint32_t)(ms) + TINYOS_SYSTICK_MS - 1) / TINYOS_SYSTICK_MS)
+#define tTimeUsToTicks(us)          (((uint32_t)(us) + TINYOS_SYSTICK_MS * 1000 - 1) / (TINYOS_SYSTICK_MS * 1000))
+#define tTimeTicksToMs(ticks)       ((uint32_t)(ticks) * TINYOS_SYSTICK_MS)
 //错误码
 typedef enum _tError {
 	tErrorNoError = 0,
@@ -21,10 +63,16 @@ typedef enum _tError {
 	tErrorDel,
 	tErrorResourceFull,
 	tErrorOwner,
+	tErrorParam,
 }tError;
 
 extern tTask * curTask;
 extern tTask * nextTask;
+extern uint8_t schedLockCounter;
+
+//任务切换统计，由PendSV维护
+extern uint32_t tTaskSwitchCount;
+extern uint32_t tTaskSwitchSkipCount;
 
 uint32_t tTaskEnterCritical(void);
 void tTaskExitCritical(uint32_t status);
@@ -34,27 +82,94 @@ void tTaskDelayedInit(void);
 
 void tTaskSwitch(void);
 void tTaskRunFirst(void);
+tTaskStack * tTaskStackInit(tTaskStack * stackTop, void (*entry)(void *), void * param);
 
 void tTaskSchedInit(void);
 void tTaskSchedDisable(void);
 void tTaskSchedEnable(void);
 void tTaskSched(void);
+void tTaskSchedFromISR(void);
+void tTaskYield(void);
+#if TINYOS_ENABLE_SLICE == 1
+void tTaskSetPrioCooperative(uint32_t prio, uint32_t coop);
+#endif
+#if TINYOS_ENABLE_IRQ_THREAD == 1
+void tTaskSchedPreempt(tTask * task);
+#endif
+
+//中断嵌套管理，调用内核API的中断服务函数首尾调用
+void tIntEnter(void);
+void tIntExit(void);
 
 void tTaskSchedRdy(tTask * task);
+void tTaskSetDeadline(tTask * task,uint32_t deadline);
 void tTaskSchedUnRdy(tTask * task);
 void tTaskSchedRemove(tTask * task);
+#if TINYOS_ENABLE_WAIT_STAT == 1
+void tTaskWaitStatBegin(tTask * task);
+void tTaskWaitStatEnd(tTask * task);
+#endif
 
 void tTimeTaskWait(tTask * task,uint32_t ticks);
 void tTimeTaskWakeUp(tTask * task);
 void tTimeTaskRemove(tTask * task);
+void tTimeTaskTimeoutStart(tTask * task,uint32_t ticks);
+void tTimeTaskTimeoutCancel(tTask * task);
+uint32_t tTimeTaskGetDelay(tTask * task);
 
 void tTaskSystemTickHandler(void);
+uint32_t tTaskTickGet(void);
+uint64_t tTimeGetTicks64(void);
+uint64_t tTimeGetMicros(void);
 void tTaskDelay(uint32_t delay);
+uint32_t tTaskDelayUntil(uint32_t * lastWakeTick, uint32_t period);
 void tSetSysTickPeriod(uint32_t ms);
+#if TINYOS_ENABLE_TICK_SWITCH == 1
+void tTaskTickStepSet(uint32_t step);
+uint32_t tTaskTickStepGet(void);
+#endif
+uint32_t tSysTickCyclesSince(uint32_t tick);
+#if TINYOS_ENABLE_TICK_OVERRUN == 1
+uint32_t tTaskTickOverrunGet(uint32_t * missedTicks);
+#endif
+
+//低功耗空闲相关函数
+uint32_t tTaskSleepTicksGet(void);
+void tTaskSystemTickCatchUp(uint32_t ticks);
+void tTicklessIdle(void);
+void tPortIdle(void);
+
+//低功耗空闲被其它中断提前唤醒时已经经过的节拍数：SysTick从当前节拍的剩余计数加sleepTicks - 1个整节拍开始倒数，
+//剩余计数val中尚未到达的节拍边界数为ceil(val / tickCycles)，其余边界均已经过；未到0时最多经过sleepTicks - 1个，
+//在第一个节拍边界之前唤醒时为0
+static __inline uint32_t tTicklessElapsedTicks(uint32_t sleepTicks, uint32_t tickCycles, uint32_t val) {
+    uint32_t pending = (val + tickCycles - 1) / tickCycles;
+
+    if (pending >= sleepTicks) {
+        return 0;
+    }
+    return (pending == 0) ? (sleepTicks - 1) : (sleepTicks - pending);
+}
+#if TINYOS_ENABLE_POWER == 1
+void tSysTickRestart(void);
+#endif
+#if TINYOS_ENABLE_CLOCK_SCALE == 1
+void tSysTickRescale(uint32_t oldClock);
+#endif
+
+//MPU栈保护区
+void tStackGuardInit(void);
 
 void tInitApp(void);
 
-//返回CPU利用率
+//DWT周期计数器
+void tCycleCounterInit(void);
+uint32_t tCycleCounterGet(void);
+void tDelayCycles(uint32_t cycles);
+void tDelayUs(uint32_t us);
+
+//任务运行时间统计及CPU利用率
+void tTaskRunTimeUpdate(void);
 float tCpuUsageGet(void);
 
 //启动函数
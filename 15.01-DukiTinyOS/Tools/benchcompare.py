@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# 跨版本基准对比：合并Benchmarks/KernelCompare.c在各章节快照上的输出(ITM或串口的捕获，每个文件一次运行，
+# 以#VERSION行区分版本)，按版本列出切换、信号量、节拍开销的周期数及内核对象的字节数，并标出相对上一版本的变化
+# 用法：python3 benchcompare.py 4.03.txt 8.03.txt 14.01.txt 15.01.txt [--stat min] [--threshold 10] [--csv]
+# 快照在Keil的Cortex-M3模拟器上运行，15.01在F401上运行(Flash等待周期)，两者的周期数只在各自之内可比
+
+import argparse
+import re
+import sys
+
+VERSION_RE = re.compile(r"#VERSION,(\d+)")
+CLOCK_RE = re.compile(r"#CLOCK,(\d+)")
+BENCH_RE = re.compile(r"^BENCH,([^,]+),(\d+),(\d+),(\d+),(\d+)")
+SIZE_RE = re.compile(r"^SIZE,([^,]+),(\d+)")
+STAT_COLUMN = {"min": 1, "avg": 2, "max": 3}
+
+
+def version_name(number):
+    """快照编号转换为目录名中的写法，1401 -> 14.01"""
+    return "%d.%02d" % (number // 100, number % 100)
+
+
+def parse_capture(path, stat):
+    """返回(版本编号, 时钟, {测试项: 周期数}, {对象: 字节数})；测试项与对象保持输出的顺序"""
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+    version = None
+    clock = 0
+    bench = {}
+    sizes = {}
+    for line in text.splitlines():
+        line = line.strip()
+        m = VERSION_RE.search(line)
+        if m:
+            if version is not None and version != int(m.group(1)):
+                raise ValueError("%s contains runs of different versions" % path)
+            version = int(m.group(1))
+            continue
+        m = CLOCK_RE.search(line)
+        if m:
+            clock = int(m.group(1))
+            continue
+        m = BENCH_RE.match(line)
+        if m:
+            bench[m.group(1)] = int(m.group(2 + STAT_COLUMN[stat]))
+            continue
+        m = SIZE_RE.match(line)
+        if m:
+            sizes[m.group(1)] = int(m.group(2))
+    if version is None:
+        raise ValueError("no #VERSION line in %s" % path)
+    return version, clock, bench, sizes
+
+
+def merge_keys(runs, index):
+    """各次运行中出现过的键，按首次出现的顺序"""
+    keys = []
+    for run in runs:
+        for key in run[index]:
+            if key not in keys:
+                keys.append(key)
+    return keys
+
+
+def cell(value, previous, threshold):
+    """数值及相对上一个有数据的版本的变化，超过阈值时标出百分比"""
+    if value is None:
+        return "-"
+    if previous is None or previous == 0:
+        return str(value)
+    change = 100.0 * (value - previous) / previous
+    if abs(change) < threshold:
+        return str(value)
+    return "%d(%+.0f%%)" % (value, change)
+
+
+def print_table(title, keys, runs, index, threshold, csv):
+    versions = [version_name(run[0]) for run in runs]
+    if csv:
+        print("%s,%s" % (title, ",".join(versions)))
+    else:
+        print("%-22s %s" % (title, " ".join("%12s" % v for v in versions)))
+    for key in keys:
+        cells = []
+        previous = None
+        for run in runs:
+            value = run[index].get(key)
+            if csv:
+                cells.append("" if value is None else str(value))
+            else:
+                cells.append(cell(value, previous, threshold))
+            if value is not None:
+                previous = value
+        if csv:
+            print("%s,%s" % (key, ",".join(cells)))
+        else:
+            print("%-22s %s" % (key, " ".join("%12s" % c for c in cells)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare KernelCompare.c results across kernel snapshots")
+    parser.add_argument("captures", nargs="+", help="one capture file per snapshot run")
+    parser.add_argument("--stat", choices=sorted(STAT_COLUMN), default="avg", help="which cycle column to compare")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="mark changes against the previous version at or above this percentage")
+    parser.add_argument("--csv", action="store_true", help="print plain CSV without change marks")
+    opts = parser.parse_args()
+
+    runs = [parse_capture(path, opts.stat) for path in opts.captures]
+    runs.sort(key=lambda run: run[0])
+    seen = set()
+    for run in runs:
+        if run[0] in seen:
+            sys.exit("version %s appears more than once" % version_name(run[0]))
+        seen.add(run[0])
+
+    if not opts.csv:
+        print("# %s cycles, changes of %.0f%% or more against the previous version in parentheses"
+              % (opts.stat, opts.threshold))
+        print("# clock: %s" % ", ".join("%s %d Hz" % (version_name(r[0]), r[1]) for r in runs))
+    print_table("cycles", merge_keys(runs, 2), runs, 2, opts.threshold, opts.csv)
+    print()
+    print_table("bytes", merge_keys(runs, 3), runs, 3, opts.threshold, opts.csv)
+
+
+if __name__ == "__main__":
+    main()
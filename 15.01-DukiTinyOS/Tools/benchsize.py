@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# 代码大小统计：从armlink生成的.map文件(MDK-ARM/QuadrotorAircraft/QuadrotorAircraft.map，需在链接选项中勾选
+# Image Map及Symbols)中取出各估计器、PID及混控所在目标文件的大小，以及被测函数本身的大小，按CSV输出，
+# 与Benchmarks/EstimatorBench.c输出的周期数及栈深度对照；开关FPU各链接一次即可比较软件浮点的代码代价
+# 用法：python3 benchsize.py QuadrotorAircraft.map [--all]
+
+import argparse
+import re
+import sys
+
+# Benchmarks/EstimatorBench.c中各测试项涉及的目标文件及函数
+OBJECTS = ["madgwick.o", "mymadgwick.o", "mahony.o", "attitudeekf.o", "complementary.o",
+           "attitudeestimator.o", "gyropreint.o", "pid.o", "mixer.o"]
+SYMBOLS = ["MadgwickAHRSupdateIMU", "merge", "Mahony_UpdateIMU", "AttitudeEstimator_UpdateIMU",
+           "PIDAttitude_Calc", "PIDAxis3_Calc", "Mixer_Mix", "Mixer_Output", "GyroPreint_Push"]
+
+# Image component sizes中的一行：Code (inc. data) RO Data RW Data ZI Data Debug Object Name
+COMPONENT_RE = re.compile(r"^\s*(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\S+\.o)\s*$")
+# Image Symbol Table中的一行：名称 地址 类型 大小 所在段
+SYMBOL_RE = re.compile(r"^\s*(\S+)\s+0x[0-9a-fA-F]+\s+(Thumb Code|ARM Code)\s+(\d+)\s+(\S+)")
+
+
+def parse(text):
+    """返回({目标文件: (code, ro, rw, zi)}, {函数: 字节数})"""
+    objects = {}
+    symbols = {}
+    section = None
+    for line in text.splitlines():
+        if "Image component sizes" in line:
+            section = "component"
+            continue
+        if "Image Symbol Table" in line:
+            section = "symbol"
+            continue
+        if section == "component":
+            m = COMPONENT_RE.match(line)
+            if m:
+                # 先出现的为工程自身的目标文件，库成员在之后的表中，同名的只取第一次
+                objects.setdefault(m.group(7).lower(),
+                                   (int(m.group(1)), int(m.group(3)), int(m.group(4)), int(m.group(5))))
+        elif section == "symbol":
+            m = SYMBOL_RE.match(line)
+            if m:
+                symbols.setdefault(m.group(1), int(m.group(3)))
+    return objects, symbols
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("map")
+    parser.add_argument("--all", action="store_true", help="输出所有目标文件而不只是被测的")
+    args = parser.parse_args()
+
+    with open(args.map, encoding="latin-1") as f:
+        objects, symbols = parse(f.read())
+    if not objects:
+        sys.exit("%s: no Image component sizes table (enable the Image Map in the linker listing)" % args.map)
+
+    print("#FLASH,object,code_bytes,ro_bytes,rw_bytes,zi_bytes")
+    for name in (sorted(objects) if args.all else OBJECTS):
+        if name in objects:
+            code, ro, rw, zi = objects[name]
+            print("FLASH,%s,%d,%d,%d,%d" % (name, code, ro, rw, zi))
+    print("#SYMBOL,function,bytes")
+    for name in SYMBOLS:
+        if name in symbols:
+            print("SYMBOL,%s,%d" % (name, symbols[name]))
+    print("#END")
+
+
+if __name__ == "__main__":
+    main()
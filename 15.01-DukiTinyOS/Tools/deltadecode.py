@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# 紧凑遥测解码：从串口抓包中找出ANO_TELEMETRY_COMPACT为1时发送的用户自定义帧，还原为原来的字段，按CSV输出
+# 用法：python3 deltadecode.py capture.bin [--raw]
+# 帧格式见Attitude/Anonymity.h，残差编码及预测器与Attitude/DeltaCodec.c相同；混有的普通匿名帧及其它数据会被跳过
+
+import argparse
+import sys
+
+ID_BASE = 0xF1
+KEY_FLAG = 0x80
+SEQ_MASK = 0x7F
+
+PREDICT_PREVIOUS = 0
+PREDICT_LINEAR = 1
+
+# 按流序号排列：名称、字段名、预测器、放大倍数
+STREAMS = [
+    ("sensor", ["ax", "ay", "az", "gx", "gy", "gz"], PREDICT_PREVIOUS, 1000),
+    ("attitude", ["roll", "pitch", "yaw"], PREDICT_LINEAR, 100),
+    ("quaternion", ["q0", "q1", "q2", "q3"], PREDICT_LINEAR, 10000),
+]
+
+
+def wrap32(value):
+    value &= 0xFFFFFFFF
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+def get_varint(data, pos):
+    """读取一个zigzag变长整数，返回(值, 新位置)，数据不完整时返回None"""
+    result = 0
+    for n in range(5):
+        if pos + n >= len(data):
+            return None
+        result |= (data[pos + n] & 0x7F) << (7 * n)
+        if not data[pos + n] & 0x80:
+            return (result >> 1) ^ -(result & 1), pos + n + 1
+    return None
+
+
+class Codec:
+    """与DeltaCodec相同的解码状态"""
+
+    def __init__(self, channels, predictor):
+        self.channels = channels
+        self.predictor = predictor
+        self.prev = [0] * channels
+        self.prev2 = [0] * channels
+        self.history = 0
+
+    def predict(self, i):
+        if self.history == 0:
+            return 0
+        if self.predictor == PREDICT_LINEAR and self.history >= 2:
+            return wrap32(2 * self.prev[i] - self.prev2[i])
+        return self.prev[i]
+
+    def decode(self, data):
+        values = []
+        pos = 0
+        for i in range(self.channels):
+            item = get_varint(data, pos)
+            if item is None:
+                return None
+            residual, pos = item
+            values.append(wrap32(residual + self.predict(i)))
+        if pos != len(data):
+            return None
+        self.prev2 = self.prev
+        self.prev = values
+        self.history = min(self.history + 1, 2)
+        return values
+
+
+def frames(data):
+    """逐个取出校验正确的匿名帧(功能字, 数据)"""
+    i = 0
+    while i + 6 <= len(data):
+        if data[i] != 0xAA or data[i + 1] != 0xFF:
+            i += 1
+            continue
+        length = data[i + 3]
+        end = i + 4 + length
+        if end + 2 > len(data):
+            break
+        sumcheck = addcheck = 0
+        for b in data[i:end]:
+            sumcheck = (sumcheck + b) & 0xFF
+            addcheck = (addcheck + sumcheck) & 0xFF
+        if sumcheck != data[end] or addcheck != data[end + 1]:
+            i += 1
+            continue
+        yield data[i + 2], data[i + 4:end]
+        i = end + 2
+
+
+def decode(data, raw):
+    codecs = [Codec(len(fields), predictor) for _, fields, predictor, _ in STREAMS]
+    expect = [None] * len(STREAMS)
+    lost = [0] * len(STREAMS)
+    print("stream,seq," + ",".join("f%d" % i for i in range(max(len(s[1]) for s in STREAMS))))
+    for fid, payload in frames(data):
+        stream = fid - ID_BASE
+        if not 0 <= stream < len(STREAMS) or len(payload) < 1:
+            continue
+        name, fields, _, scale = STREAMS[stream]
+        codec = codecs[stream]
+        flags = payload[0]
+        seq = flags & SEQ_MASK
+        if flags & KEY_FLAG:
+            codec.history = 0
+        elif expect[stream] is None or seq != expect[stream] or codec.history == 0:
+            # 序号不连续，预测状态已失效，等待下一个关键帧
+            codec.history = 0
+            expect[stream] = None
+            lost[stream] += 1
+            continue
+        values = codec.decode(payload[1:])
+        if values is None:
+            codec.history = 0
+            expect[stream] = None
+            lost[stream] += 1
+            continue
+        expect[stream] = (seq + 1) & SEQ_MASK
+        if raw:
+            text = ["%d" % v for v in values]
+        else:
+            text = ["%g" % (v / scale) for v in values]
+        print("%s,%d,%s" % (name, seq, ",".join(text)))
+    for (name, _, _, _), count in zip(STREAMS, lost):
+        if count:
+            sys.stderr.write("%s: %d frames skipped waiting for a key frame\n" % (name, count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode compact ANO telemetry frames")
+    parser.add_argument("capture", nargs="?", help="raw serial capture, stdin if omitted")
+    parser.add_argument("--raw", action="store_true", help="print scaled integers as sent instead of physical units")
+    opts = parser.parse_args()
+
+    if opts.capture:
+        with open(opts.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(data, opts.raw)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+# PC采样剖析的符号化：解析Source/tPcSample.c中tPcSampleDump输出的直方图(命令行pcs命令、串口或RTT的捕获)，
+# 按同一次编译的axf/elf文件的符号表，或armlink/GNU ld的map文件，把各组地址还原为函数，按采样数排序输出平坦剖析
+# 用法：python3 pcprofile.py QuadrotorAircraft.axf capture.txt [--top 40] [--by object]
+#       python3 pcprofile.py QuadrotorAircraft.map capture.txt   (map文件需在链接选项中勾选Symbols)
+# 一组覆盖的地址跨越多个函数时按重叠的字节数分摊；捕获中有多次输出时累加
+
+import argparse
+import bisect
+import re
+import struct
+import sys
+
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+# armlink的Image Symbol Table中的一行：名称 地址 类型 大小 所在目标文件(段)
+ARMLINK_RE = re.compile(r"^\s*(\S+)\s+0x([0-9a-fA-F]+)\s+(?:Thumb Code|ARM Code)\s+(\d+)\s+([^(\s]+)")
+# GNU ld map中的输入段：[段名] 地址 大小 目标文件；段名过长时单独占一行
+GNU_SECTION_RE = re.compile(r"^\s*(\.\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)\s*$")
+GNU_SYMBOL_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$")
+
+DUMP_HEAD_RE = re.compile(r"PCS,([0-9a-fA-F]+),(\d+),(\d+),(\d+),(\d+),(\d+),(\d+)")
+DUMP_BUCKET_RE = re.compile(r"PCB,(\d+),(\d+)")
+
+
+def load_elf(path, data):
+    """ELF32符号表中的函数，返回[(起始, 结束, 名称, 目标文件)]"""
+    if data[4] != 1 or data[5] != 1:
+        raise ValueError("%s is not a little-endian ELF32 file" % path)
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+    sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+    symbols = []
+    for sh in sections:
+        if sh[1] != SHT_SYMTAB:
+            continue
+        strtab = sections[sh[6]]
+        for off in range(sh[4], sh[4] + sh[5], 16):
+            name, value, size, info, _, shndx = struct.unpack_from("<IIIBBH", data, off)
+            if (info & 0xF) != STT_FUNC or size == 0:
+                continue
+            start = strtab[4] + name
+            label = data[start:data.index(b"\0", start)].decode("utf-8", "replace")
+            # Thumb函数的地址最低位为1
+            symbols.append((value & ~1, (value & ~1) + size, label, ""))
+    return symbols
+
+
+def load_map(text):
+    """armlink或GNU ld的map文件中的函数，返回[(起始, 结束, 名称, 目标文件)]"""
+    symbols = []
+    for line in text.splitlines():
+        m = ARMLINK_RE.match(line)
+        if m:
+            start = int(m.group(2), 16) & ~1
+            symbols.append((start, start + int(m.group(3)), m.group(1), m.group(4)))
+    if symbols:
+        return symbols
+
+    # GNU ld：段内的各符号延续到下一个符号或段尾
+    pending = None
+    section = None
+    names = []
+
+    def flush():
+        if section is None:
+            return
+        base, end, obj = section
+        names.sort()
+        for i, (addr, name) in enumerate(names):
+            stop = names[i + 1][0] if i + 1 < len(names) else end
+            if stop > addr:
+                symbols.append((addr, stop, name, obj))
+
+    for line in text.splitlines():
+        m = GNU_SYMBOL_RE.match(line)
+        if m and section is not None:
+            addr = int(m.group(1), 16)
+            if section[0] <= addr < section[1]:
+                names.append((addr, m.group(2)))
+            continue
+        m = GNU_SECTION_RE.match(line)
+        if m and (m.group(1) or pending) and (m.group(1) or pending).startswith(".text"):
+            flush()
+            base = int(m.group(2), 16)
+            section = (base, base + int(m.group(3), 16), m.group(4).split("/")[-1])
+            names = []
+            pending = None
+            continue
+        stripped = line.strip()
+        pending = stripped if stripped.startswith(".") and " " not in stripped else None
+    flush()
+    return symbols
+
+
+def load_symbols(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] == b"\x7fELF":
+        symbols = load_elf(path, data)
+    else:
+        symbols = load_map(data.decode("utf-8", "replace"))
+    if not symbols:
+        raise ValueError("no function symbols found in %s" % path)
+    symbols.sort()
+    return symbols
+
+
+def parse_dump(text):
+    """累加捕获中的所有直方图，返回(起始地址, 组宽位数, 采样频率, 采样总数, 范围外, 中断中, {组号: 次数})"""
+    head = None
+    totals = [0, 0, 0]
+    buckets = {}
+    for line in text.splitlines():
+        m = DUMP_HEAD_RE.search(line)
+        if m:
+            fields = (int(m.group(1), 16), int(m.group(2)), int(m.group(3)), int(m.group(4)))
+            if head is not None and head != fields:
+                raise ValueError("dumps in the capture use different settings")
+            head = fields
+            for i in range(3):
+                totals[i] += int(m.group(5 + i))
+            continue
+        m = DUMP_BUCKET_RE.search(line)
+        if m and head is not None:
+            index = int(m.group(1))
+            buckets[index] = buckets.get(index, 0) + int(m.group(2))
+    if head is None:
+        raise ValueError("no PCS header found in the capture")
+    return head[0], head[1], head[3], totals[0], totals[1], totals[2], buckets
+
+
+def attribute(symbols, base, shift, buckets, by_object):
+    """按重叠字节数把各组的次数分摊到函数(或目标文件)上"""
+    starts = [s[0] for s in symbols]
+    result = {}
+    width = 1 << shift
+    for index, count in buckets.items():
+        lo = base + (index << shift)
+        hi = lo + width
+        covered = 0
+        i = max(bisect.bisect_right(starts, lo) - 1, 0)
+        while i < len(symbols) and symbols[i][0] < hi:
+            start, end, name, obj = symbols[i]
+            overlap = min(end, hi) - max(start, lo)
+            if overlap > 0:
+                key = (obj or "?") if by_object else name
+                result[key] = result.get(key, 0) + count * overlap / width
+                covered += overlap
+            i += 1
+        if covered < width:
+            result["<unknown>"] = result.get("<unknown>", 0) + count * (width - covered) / width
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="symbolize tPcSample histograms into a flat profile")
+    parser.add_argument("image", help="axf/elf image or armlink/GNU ld map file of the sampled firmware")
+    parser.add_argument("capture", nargs="?", help="text capture containing tPcSampleDump output, stdin if omitted")
+    parser.add_argument("--top", type=int, default=40, help="number of rows to print, 0 for all")
+    parser.add_argument("--by", choices=["function", "object"], default="function",
+                        help="group by function or by object file (object needs a map file)")
+    opts = parser.parse_args()
+
+    symbols = load_symbols(opts.image)
+    if opts.capture:
+        with open(opts.capture, "r", errors="replace") as f:
+            text = f.read()
+    else:
+        text = sys.stdin.read()
+    base, shift, hz, samples, outside, in_irq, buckets = parse_dump(text)
+    if samples == 0:
+        print("no samples")
+        return
+
+    profile = attribute(symbols, base, shift, buckets, opts.by == "object")
+    if outside:
+        profile["<outside histogram>"] = outside
+    print("%d samples (%.1f s at %d Hz), %.1f%% in interrupt handlers" %
+          (samples, samples / float(hz), hz, 100.0 * in_irq / samples))
+    rows = sorted(profile.items(), key=lambda kv: -kv[1])
+    if opts.top > 0:
+        rows = rows[:opts.top]
+    cumulative = 0.0
+    print("%10s %7s %7s  %s" % ("samples", "self", "cum", opts.by))
+    for name, count in rows:
+        cumulative += count
+        print("%10.1f %6.2f%% %6.2f%%  %s" % (count, 100.0 * count / samples, 100.0 * cumulative / samples, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# tLog二进制日志解码：从固件的axf(ELF)文件中按地址取出格式串，还原TINYOS_LOG_OUTPUT_RAW为1时日志任务输出的记录
+# 用法：python3 tlogdecode.py QuadrotorAircraft.axf capture.bin [--clock 84000000]
+# TINYOS_LOG_OUTPUT_RAW为2时记录写入RTT通道1，用JLinkRTTLogger等工具把该通道保存为文件即可作为capture.bin
+# 记录格式见Source/tLog.h：7个小端字，最后一个字的最高字节为同步字节0x5A，输入中混有的其它数据会被跳过
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SYNC = 0x5A
+RECORD_SIZE = 28
+ARGS_MAX = 4
+LEVEL_NAME = "DIWE"
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# C的转换说明：标志、宽度、精度、长度修饰符及转换字符
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z|j|t|L)?([diouxXcsfFeEgGp%])")
+
+
+class Image:
+    """ELF文件中占用地址空间且有内容的段，用于按地址读取常量字符串"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s is not a little-endian ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset, size) = struct.unpack_from("<IIIIII", data, shoff + i * shentsize)
+            if (flags & SHF_ALLOC) and stype != SHT_NOBITS and size > 0:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string(self, addr):
+        for base, content in self.sections:
+            if base <= addr < base + len(content):
+                end = content.find(b"\0", addr - base)
+                if end < 0:
+                    end = len(content)
+                return content[addr - base:end].decode("utf-8", "replace")
+        return None
+
+
+def format_record(image, fmt, args, argc):
+    out = []
+    pos = 0
+    index = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        arg = args[index] if index < argc else 0
+        index += 1
+        spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+        if conv in "fFeEgG":
+            out.append((spec + conv) % struct.unpack("<f", struct.pack("<I", arg))[0])
+        elif conv in "di":
+            out.append((spec + "d") % struct.unpack("<i", struct.pack("<I", arg))[0])
+        elif conv == "u":
+            out.append((spec + "d") % arg)
+        elif conv == "c":
+            out.append(chr(arg & 0xFF))
+        elif conv == "s":
+            s = image.string(arg)
+            out.append((spec + "s") % (s if s is not None else "<0x%08x>" % arg))
+        elif conv == "p":
+            out.append("0x%08x" % arg)
+        else:
+            out.append((spec + conv) % arg)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode(image, data, clock):
+    i = 0
+    while i + RECORD_SIZE <= len(data):
+        words = struct.unpack_from("<7I", data, i)
+        info = words[6]
+        level = (info >> 16) & 0xFF
+        argc = (info >> 8) & 0xFF
+        fmt = image.string(words[1]) if (info >> 24) == LOG_SYNC and (info & 0xFF) == 0 else None
+        if fmt is None or level > 3 or argc > ARGS_MAX:
+            i += 1
+            continue
+        if clock:
+            stamp = "%12.6f" % (words[0] / clock)
+        else:
+            stamp = "%10u" % words[0]
+        print("[%s] %s %s" % (stamp, LEVEL_NAME[level], format_record(image, fmt, words[2:6], argc)))
+        i += RECORD_SIZE
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode tLog binary records")
+    parser.add_argument("axf", help="firmware image the capture was taken from")
+    parser.add_argument("capture", nargs="?", help="raw serial capture, stdin if omitted")
+    parser.add_argument("--clock", type=float, default=0, help="core clock in Hz, prints timestamps in seconds")
+    opts = parser.parse_args()
+
+    image = Image(opts.axf)
+    if opts.capture:
+        with open(opts.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(image, data, opts.clock)
+
+
+if __name__ == "__main__":
+    main()